@@ -12,6 +12,18 @@
 #ifndef Osi2API_HPP
 # define Osi2API_HPP
 
+/*! \brief Mark an implementation class that no class derives from
+
+  Expands to \c final when the compiler knows it, so that calls made
+  through a pointer to the implementation class can be bound directly.
+  Empty otherwise.
+*/
+#if __cplusplus >= 201103L
+# define OSI2_FINAL final
+#else
+# define OSI2_FINAL
+#endif
+
 /*! \brief Identification namespace for OSI2.
 
   All APIs and their implementations should be defined within the Osi2
@@ -52,6 +64,9 @@ protected:
 
 private:
 
+    /// The control API maintains the identification information
+    friend class ControlAPI ;
+
     /*! \brief API object identification information
 
       This is a generic pointer which a control API implementation can
@@ -66,6 +81,31 @@ private:
 
 } ;
 
+/*! \brief Checked conversion of an API object to a particular API or
+	   implementation class
+    \relates API
+
+  Returns \p obj as a \p T, or null if \p obj isn't one. The check is a
+  \c dynamic_cast and costs what that costs; do it once, outside the loop,
+  and keep the result.
+
+  Converting to an implementation class (Osi1API_ClpHeavy, for example)
+  requires that the client link with the library that defines it. Calls
+  made through the result go straight to the implementation, without
+  passing through the API's virtual functions, when the class is marked
+  #OSI2_FINAL (or the call is qualified with the class name).
+*/
+template <class T>
+inline T *api_cast (API *obj)
+{ return (dynamic_cast<T *>(obj)) ; }
+
+/*! \brief Checked conversion of a const API object
+    \relates API
+*/
+template <class T>
+inline const T *api_cast (const API *obj)
+{ return (dynamic_cast<const T *>(obj)) ; }
+
 } // end namespace Osi2
 
 #endif
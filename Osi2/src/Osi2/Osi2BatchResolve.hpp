@@ -0,0 +1,243 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2BatchResolve.hpp
+    \brief Re-solve one model under a batch of right-hand sides or
+	   objectives.
+
+  See Osi1API::resolveBatch and ProbMgmtAPI::resolveBatch.
+*/
+
+#ifndef Osi2BatchResolve_HPP
+#define Osi2BatchResolve_HPP
+
+#include <cstring>
+#include <vector>
+
+#include "CoinWarmStart.hpp"
+
+namespace Osi2 {
+
+/*! \brief What each variant of a batch replaces
+
+  Variants are given as one dense column-major block: variant \c v is
+  entries <tt>v*len</tt> to <tt>(v+1)*len-1</tt>, where \c len is the
+  number of rows for #BatchRhs and of columns for #BatchObjective.
+*/
+enum BatchKind {
+    /// The right-hand side of every row (see rhsToRowBounds)
+    BatchRhs = 0,
+    /// The objective coefficient of every column
+    BatchObjective
+} ;
+
+/*! \brief The results of a batch resolve, as dense column blocks
+
+  One entry per variant in #status_, #objValue_ and #iterations_. The
+  primal solution of variant \c v is #numCols_ entries from
+  #colSolution(v); its row duals, if asked for, #numRows_ entries from
+  #rowPrice(v). Status codes are those of ProbMgmtAPI::initialSolve: 0
+  optimal, 1 primal infeasible, 2 dual infeasible, 3 stopped on a limit,
+  4 stopped on errors (or abandoned).
+
+  The vectors are reused from batch to batch and only grow.
+*/
+struct BatchResult {
+
+    /// Constructor; empty
+    BatchResult ()
+      : numVariants_(0),
+        numCols_(0),
+        numRows_(0)
+    { }
+
+    /// Size the result for a batch, clearing what was there
+    inline void reset (int numVariants, int numCols, int numRows,
+                       bool withDuals) {
+        numVariants_ = numVariants ;
+        numCols_ = numCols ;
+        numRows_ = numRows ;
+        status_.assign(numVariants, 4) ;
+        objValue_.assign(numVariants, 0.0) ;
+        iterations_.assign(numVariants, 0) ;
+        colSolution_.assign(static_cast<size_t>(numVariants)*numCols, 0.0) ;
+        if (withDuals)
+            rowPrice_.assign(static_cast<size_t>(numVariants)*numRows, 0.0) ;
+        else
+            rowPrice_.clear() ;
+    }
+
+    /// The primal solution of variant \p v
+    inline const double *colSolution (int v) const {
+        return (colSolution_.empty() ? 0 :
+                &colSolution_[static_cast<size_t>(v)*numCols_]) ;
+    }
+
+    /// The row duals of variant \p v; null if they weren't asked for
+    inline const double *rowPrice (int v) const {
+        return (rowPrice_.empty() ? 0 :
+                &rowPrice_[static_cast<size_t>(v)*numRows_]) ;
+    }
+
+    /// Variants in the batch
+    int numVariants_ ;
+    /// Columns in the problem
+    int numCols_ ;
+    /// Rows in the problem
+    int numRows_ ;
+    /// Outcome of each solve
+    std::vector<int> status_ ;
+    /// Objective value of each solve
+    std::vector<double> objValue_ ;
+    /// Iterations of each solve
+    std::vector<int> iterations_ ;
+    /// Primal solutions, column by column
+    std::vector<double> colSolution_ ;
+    /// Row duals, column by column; empty unless asked for
+    std::vector<double> rowPrice_ ;
+} ;
+
+/*! \brief Row bounds that give each row the right-hand side in \p rhs
+
+  As OsiSolverInterface has it: an equality row gets both bounds, a
+  \f$\leq\f$ row its upper bound and a \f$\geq\f$ row its lower bound; a
+  ranged row's upper bound becomes the right-hand side and it keeps its
+  range; a free row is left as it is. A bound is infinite if its
+  magnitude is at least \p infinity.
+*/
+inline void rhsToRowBounds (int numRows, const double *rowLower,
+                            const double *rowUpper, const double *rhs,
+                            double infinity, double *newLower,
+                            double *newUpper)
+{
+    for (int i = 0 ; i < numRows ; i++) {
+        const bool hasLower = (rowLower[i] > -infinity) ;
+        const bool hasUpper = (rowUpper[i] < infinity) ;
+        newLower[i] = rowLower[i] ;
+        newUpper[i] = rowUpper[i] ;
+        if (hasLower && hasUpper) {
+            newLower[i] = rhs[i]-(rowUpper[i]-rowLower[i]) ;
+            newUpper[i] = rhs[i] ;
+        } else if (hasUpper) {
+            newUpper[i] = rhs[i] ;
+        } else if (hasLower) {
+            newLower[i] = rhs[i] ;
+        }
+    }
+}
+
+/*! \brief Status code for the last solve of \p obj
+
+  The codes of BatchResult, from the Osi1API status queries.
+*/
+template <class T>
+inline int batchStatusOf (const T *obj)
+{
+    if (obj->isProvenOptimal()) return (0) ;
+    if (obj->isProvenPrimalInfeasible()) return (1) ;
+    if (obj->isProvenDualInfeasible()) return (2) ;
+    if (obj->isAbandoned()) return (4) ;
+    return (3) ;
+}
+
+/*! \brief Resolve \p obj under each variant in turn
+
+  The work of Osi1API::resolveBatch, for any API with its methods. Each
+  variant is solved with \c resolve from the basis the one before it
+  finished with, or from the last optimal basis if the one before didn't
+  reach optimality, and its results copied straight into \p results. The
+  solver keeps the same matrix throughout, so one that can keep its
+  factorization across resolves does. The model's own right-hand side or
+  objective is put back at the end; the basis is left as the last solve
+  left it.
+
+  \returns the number of variants solved to optimality, or -1 if \p
+  variants is null or \p numVariants negative
+*/
+template <class T>
+int resolveBatchOf (T *obj, BatchKind kind, int numVariants,
+                    const double *variants, BatchResult &results,
+                    bool withDuals)
+{
+    const int numCols = obj->getNumCols() ;
+    const int numRows = obj->getNumRows() ;
+    results.reset((numVariants < 0) ? 0 : numVariants, numCols, numRows,
+                  withDuals) ;
+    if (variants == 0 || numVariants < 0) return (-1) ;
+    /*
+      Keep what the variants replace. For right-hand sides, the row bounds
+      go in one call, as (lower, upper) pairs over every row.
+    */
+    const size_t len = (kind == BatchRhs) ? numRows : numCols ;
+    std::vector<double> saved ;
+    std::vector<int> rows ;
+    std::vector<double> pairs ;
+    if (kind == BatchRhs) {
+        rows.resize(numRows) ;
+        for (int i = 0 ; i < numRows ; i++) rows[i] = i ;
+        pairs.resize(2*static_cast<size_t>(numRows)) ;
+        for (int i = 0 ; i < numRows ; i++) {
+            pairs[2*i] = obj->getRowLower()[i] ;
+            pairs[2*i+1] = obj->getRowUpper()[i] ;
+        }
+        saved = pairs ;
+    } else if (numCols > 0) {
+        saved.assign(obj->getObjCoefficients(),
+                     obj->getObjCoefficients()+numCols) ;
+    }
+    const double infinity = obj->getInfinity() ;
+    CoinWarmStart *lastOptimal = 0 ;
+    bool prevOptimal = true ;
+    int numOptimal = 0 ;
+    for (int v = 0 ; v < numVariants ; v++) {
+        const double *variant = variants+v*len ;
+        if (kind == BatchRhs) {
+            if (numRows > 0) {
+                for (int i = 0 ; i < numRows ; i++) {
+                    rhsToRowBounds(1, &saved[2*i], &saved[2*i+1], variant+i,
+                                   infinity, &pairs[2*i], &pairs[2*i+1]) ;
+                }
+                obj->setRowSetBounds(&rows[0], &rows[0]+numRows, &pairs[0]) ;
+            }
+        } else if (numCols > 0) {
+            obj->setObjective(variant) ;
+        }
+        if (!prevOptimal && lastOptimal != 0) obj->setWarmStart(lastOptimal) ;
+        obj->resolve() ;
+        const int status = batchStatusOf(obj) ;
+        results.status_[v] = status ;
+        results.objValue_[v] = obj->getObjValue() ;
+        results.iterations_[v] = obj->getIterationCount() ;
+        const double *x = obj->getColSolution() ;
+        if (x != 0 && numCols > 0)
+            std::memcpy(&results.colSolution_[static_cast<size_t>(v)*numCols],
+                        x, numCols*sizeof(double)) ;
+        const double *y = withDuals ? obj->getRowPrice() : 0 ;
+        if (y != 0 && numRows > 0)
+            std::memcpy(&results.rowPrice_[static_cast<size_t>(v)*numRows],
+                        y, numRows*sizeof(double)) ;
+        prevOptimal = (status == 0) ;
+        if (prevOptimal) {
+            numOptimal++ ;
+            if (v < numVariants-1) {
+                delete lastOptimal ;
+                lastOptimal = obj->getWarmStart() ;
+            }
+        }
+    }
+    delete lastOptimal ;
+    if (kind == BatchRhs) {
+        if (numRows > 0)
+            obj->setRowSetBounds(&rows[0], &rows[0]+numRows, &saved[0]) ;
+    } else if (numCols > 0) {
+        obj->setObjective(&saved[0]) ;
+    }
+    return (numOptimal) ;
+}
+
+}  // end namespace Osi2
+
+#endif
@@ -16,11 +16,57 @@
 # define Osi2ControlAPI_HPP
 
 #include <string>
+#include <vector>
+#include <ostream>
 
 #include "Osi2API.hpp"
+#include "Osi2ApiTraits.hpp"
+#include "Osi2PerfStats.hpp"
+#include "Osi2Plugin.hpp"
+#include "Osi2MemAccount.hpp"
+#include "Osi2ModelCache.hpp"
+#include "Osi2Presolve.hpp"
+#include "Osi2SolveFuture.hpp"
+#include "Osi2ScenarioRunner.hpp"
+#include "Osi2SolveHistory.hpp"
+#include "Osi2StrongBranch.hpp"
+#include "Osi2Threads.hpp"
+#include "Osi2WarmStartCache.hpp"
 
 namespace Osi2 {
 
+/*! \brief One entrant in a race; see ControlAPI::race
+
+  Times are in seconds. For an entrant still running when the race ended,
+  they run to the end of the race.
+*/
+struct RaceEntry {
+    /// What became of an entrant
+    enum Outcome {
+        /// No ProbMgmt object could be had from the library
+        NotRun = 0,
+        /// The problem could not be read
+        ReadFailed,
+        /// Read, but not solved because the race was already won
+        Withdrawn,
+        /// Solved; the solve status is in #status_
+        Solved,
+        /// Still running when the race ended
+        Abandoned
+    } ;
+
+    /// Short name of the plugin library
+    std::string shortName_ ;
+    /// What became of the entrant
+    Outcome outcome_ ;
+    /// Solve status, if #outcome_ is Solved
+    int status_ ;
+    /// Time to read the problem
+    double readTime_ ;
+    /// Time to solve it
+    double solveTime_ ;
+} ;
+
 /*! \brief Osi2 ControlAPI virtual base class
 
   This abstract class defines the Osi2 control interface, including loading and
@@ -73,6 +119,18 @@ public:
     virtual int load(const std::string &shortName,
                      const std::string &libName, const std::string *dirName) = 0 ;
 
+    /*! \brief Load the specified plugin library in worker processes
+
+      As the three-parameter #load, but the library is loaded by a pool of
+      \p numWorkers worker processes (one per processor if \p numWorkers is
+      0) rather than by this process. Objects requested with this
+      library's short name are created in a worker and reached through a
+      proxy, so a crash in the plugin or its solver costs only the worker.
+    */
+    virtual int loadHosted(const std::string &shortName,
+                           const std::string &libName,
+                           const std::string *dirName, int numWorkers) = 0 ;
+
     /*! \brief Unload the specified library.
 
       Unloads the specified library. The return value will be 0 if all went
@@ -117,6 +175,697 @@ public:
     */
     virtual int destroyObject(API *&obj) = 0 ;
 
+    /*! \brief Create several objects of the specified API
+
+      As #createObject, for \p count objects at once; for example, one for
+      each worker in a pool of threads. The plugin library is chosen once,
+      and the plugin may build the objects together. If \p shortName isn't
+      given and \p count is more than 1, a library that declares its objects
+      thread-safe is preferred. On return \p objs holds
+      the objects created. With NUMA placement on, load and solve object
+      \c i on node #getNumaNode(i) (see #setNumaPlacement).
+
+      \returns:
+        -1: fewer than \p count objects were created
+         0: all the objects were created
+    */
+    virtual int createObjects(std::vector<API *> &objs,
+                              const std::string &apiName, int count,
+                              const std::string *shortName = 0) = 0 ;
+
+    /*! \brief Destroy several objects
+
+      As #destroyObject, for each object in \p objs. If all are destroyed,
+      \p objs is emptied.
+    */
+    virtual int destroyObjects(std::vector<API *> &objs) = 0 ;
+
+    /*! \brief Find the library best suited to a request
+
+      Chooses, from what the loaded libraries declared when they registered
+      \p apiName, one whose objects can solve the problem classes and have
+      the properties asked for in \p need, preferring the cheapest by the
+      libraries' cost hints. No object is created. On success \p shortName
+      is the library's short name, ready for #createObject.
+
+      \returns:
+        -1: no library qualifies
+         0: \p shortName names the library chosen
+    */
+    virtual int selectLibrary(std::string &shortName,
+                              const std::string &apiName,
+                              const PluginCaps &need) = 0 ;
+
+    /*! \brief Create an object and convert it to the type wanted
+
+      As #createObject, but \p obj is a pointer to \p T, an API class or
+      a plugin's implementation class. If the object created isn't a \p T
+      (see api_cast) it's destroyed and the call fails.
+
+      \returns:
+        -1: error, or the object created was not a \p T
+      as #createObject otherwise
+    */
+    template <class T>
+    inline int createObject (T *&obj, const std::string &apiName,
+                             const std::string *shortName = 0) {
+        obj = 0 ;
+        API *apiObj = 0 ;
+        int retval = createObject(apiObj, apiName, shortName) ;
+        if (retval < 0) return (retval) ;
+        obj = api_cast<T>(apiObj) ;
+        if (obj == 0) {
+            destroyObject(apiObj) ;
+            return (-1) ;
+        }
+        return (retval) ;
+    }
+
+    /*! \brief Create an object of API class \p T
+
+      As the previous method, with the API name taken from
+      <tt>ApiTraits<T></tt>; \p T must be an API class with traits (see
+      #OSI2_API_TRAITS), e.g. ProbMgmtAPI or Osi1API.
+    */
+    template <class T>
+    inline int createObject (T *&obj, const std::string *shortName = 0) {
+        return (createObject(obj, std::string(ApiTraits<T>::name()),
+                             shortName)) ;
+    }
+
+    /*! \brief Destroy an object created by the typed #createObject
+
+      \p obj is set to null if the object is destroyed.
+    */
+    template <class T>
+    inline int destroyObject (T *&obj) {
+        API *apiObj = obj ;
+        int retval = destroyObject(apiObj) ;
+        if (apiObj == 0) obj = 0 ;
+        return (retval) ;
+    }
+
+    //@}
+
+    /*! \name Racing
+        \brief Solve one problem with several solvers; the fastest wins.
+
+      Which solver is fastest varies from problem to problem. A race gives
+      the problem to all of them and takes the first good answer.
+    */
+    //@{
+
+    /*! \brief Race the plugin libraries in \p shortNames on one problem
+
+      A ProbMgmt object is created from each library, and each reads the
+      problem in file \p path and solves it (ProbMgmtAPI::initialSolve) in
+      a thread of its own. The first to finish with solve status 0 (optimal)
+      wins: the race ends and \p winner holds its object, to be destroyed
+      by the client (#destroyObject). \p entries holds one RaceEntry for
+      each library, in the order of \p shortNames.
+
+      When the race ends, entrants still running are told to stop, through
+      a CancelToken (ProbMgmtAPI::setCancelToken); an entrant that can't
+      stop part way through runs on. Either way they're abandoned, and their
+      objects are destroyed when they finish: at the next race, when a library is unloaded, or when
+      the control API object is destroyed, at the latest. Each of those
+      waits for any abandoned entrants still running. An entrant that
+      finishes reading after the race is won doesn't start its solve.
+
+      \returns:
+        -2: no plugin manager
+        -1: no entrant found an optimal solution; \p winner is null
+        otherwise, the index of the winner in \p entries
+    */
+    virtual int race(API *&winner, std::vector<RaceEntry> &entries,
+                     const std::string &path,
+                     const std::vector<std::string> &shortNames,
+                     bool keepNames = false) = 0 ;
+
+    //@}
+
+    /*! \name Asynchronous Solves
+        \brief Run solves in the background and watch them by SolveFuture.
+
+      The control API keeps a pool of threads for the purpose, started on
+      the first asynchronous solve. One thread can keep any number of solves
+      in flight, and go on loading models while they run. The object must
+      not be used or destroyed until its solve is done (or cancelled).
+    */
+    //@{
+
+    /*! \brief Set the number of solve threads
+
+      0 (the default) means one per processor. Only before the first
+      asynchronous solve; returns -1 if the threads have started, 0
+      otherwise.
+    */
+    virtual int setAsyncThreads(int numThreads) = 0 ;
+
+    /*! \brief Queue \p job for the solve threads
+
+      The control API takes ownership of the job. With NUMA placement
+      (#setNumaPlacement), \p node is the node to run the job on, by
+      preference; -1 means any. Returns an invalid future if \p job is null
+      or the threads can't be started.
+    */
+    virtual SolveFuture submitAsync(AsyncJob *job, int node = -1) = 0 ;
+
+    /*! \brief Call \p obj->initialSolve() in the background
+
+      For any API with an \c initialSolve method (ProbMgmtAPI, Osi1API).
+    */
+    template <class T>
+    inline SolveFuture initialSolveAsync (T *obj, int node = -1) {
+        return (submitAsync((obj == 0) ? 0 : new InitialSolveJob<T>(obj),
+                            node)) ;
+    }
+
+    /*! \brief Call \p obj->resolve() in the background
+
+      For any API with a \c resolve method (Osi1API).
+    */
+    template <class T>
+    inline SolveFuture resolveAsync (T *obj, int node = -1) {
+        return (submitAsync((obj == 0) ? 0 : new ResolveJob<T>(obj), node)) ;
+    }
+
+    //@}
+
+    /*! \name NUMA Placement
+        \brief Keep solves on the node that holds their model.
+
+      On a machine with several NUMA nodes, memory belongs to the node of
+      the thread that first touched it, and a solve on another node pays
+      for every access. With placement on, each race entrant (#race) and
+      each solve thread is pinned to a node, the nodes taken in turn: an
+      entrant reads its problem on its own node, and a job queued for a
+      node (#submitAsync) runs there by preference. A batch of objects
+      (#createObjects) is spread the same way: object \c i belongs to node
+      #getNumaNode(i).
+
+      For data already in place, the NUMA helpers in Osi2Numa.hpp pin a
+      thread (numaBindThread) or move pages (numaMigrate), and
+      ModelSnapshot::replicate makes a node a copy of a shared model of its
+      own. On a machine of one node placement costs nothing and changes
+      nothing.
+    */
+    //@{
+
+    /*! \brief Turn NUMA placement on or off
+
+      The solve threads are placed when they start, so a change after the
+      first asynchronous solve affects only races.
+
+      \returns the number of NUMA nodes, or -1 if the solve threads had
+      already started (the change still applies to races)
+    */
+    virtual int setNumaPlacement(bool on) = 0 ;
+
+    /// True if NUMA placement is on
+    virtual bool getNumaPlacement() const = 0 ;
+
+    /*! \brief Node for the \p ndx'th of a set of workers or objects
+
+      Nodes are taken in turn. Returns -1 if placement is off, which
+      #submitAsync takes to mean any node.
+    */
+    virtual int getNumaNode(int ndx) const = 0 ;
+
+    //@}
+
+    /*! \name Strong Branching
+        \brief Evaluate a batch of branching candidates in parallel.
+    */
+    //@{
+
+    /*! \brief Strong branching on a batch of candidates
+
+      For each candidate, solves the down and up branches (see
+      BranchCandidate) from a hot start, with at most \p iterLimit
+      iterations each, and puts the outcomes in the matching entry of
+      \p results. For an Osi1API object, or any API with the hot start
+      methods.
+
+      The batch is shared out among \p numWorkers objects (0 means one per
+      processor, and there are never more than the candidates): \p obj
+      itself, evaluated in the calling thread, and clones of it
+      (<tt>clone(true)</tt>) run by the solve threads. \p obj is left as it
+      was, hot start iteration limit included. The clones are destroyed
+      (#destroyObject, or \c delete for a clone of an object that didn't
+      come from a plugin) before the call returns. Don't call this from a
+      solve thread.
+
+      \returns 0, or -1 if \p obj is null
+    */
+    template <class T>
+    int strongBranch (T *obj, const std::vector<BranchCandidate> &candidates,
+                      int iterLimit, std::vector<BranchResult> &results,
+                      int numWorkers = 0) {
+        results.assign(candidates.size(), BranchResult()) ;
+        if (obj == 0) return (-1) ;
+        if (candidates.empty()) return (0) ;
+        if (numWorkers <= 0) numWorkers = numProcessors() ;
+        if (numWorkers > static_cast<int>(candidates.size()))
+            numWorkers = static_cast<int>(candidates.size()) ;
+        const int oldLimit = getHotStartIterationLimit(obj) ;
+        /*
+          Clone first, while obj is as the caller left it. Queue the clones'
+          shares, then work on the first share here. A share the threads
+          couldn't take is run here too.
+        */
+        std::vector<T *> clones ;
+        for (int i = 1 ; i < numWorkers ; i++)
+            clones.push_back(obj->clone(true)) ;
+        std::vector<SolveFuture> futures ;
+        for (int i = 1 ; i < numWorkers ; i++)
+            futures.push_back(submitAsync(
+                new StrongBranchJob<T>(clones[i-1], true, candidates,
+                                       results, i, numWorkers, iterLimit))) ;
+        StrongBranchJob<T>(obj, false, candidates, results, 0, numWorkers,
+                           iterLimit).run() ;
+        for (int i = 1 ; i < numWorkers ; i++) {
+            if (futures[i-1].isValid())
+                futures[i-1].wait() ;
+            else
+                StrongBranchJob<T>(clones[i-1], true, candidates, results, i,
+                                   numWorkers, iterLimit).run() ;
+            if (destroyObject(clones[i-1]) < 0 && clones[i-1] != 0)
+                delete clones[i-1] ;
+        }
+        setHotStartIterationLimit(obj, oldLimit) ;
+        return (0) ;
+    }
+
+    //@}
+
+    /*! \name Scenario Analysis
+        \brief Solve many small variants of one large model.
+    */
+    //@{
+
+    /*! \brief Solve each scenario in \p scenarios as a change to \p obj
+
+      Each scenario is a ModelDelta against the model loaded in \p obj,
+      typically a few bounds or right-hand sides. \p obj should hold its
+      base model, solved or not; every scenario is applied to that model
+      and resolved from the basis \p obj has at the call, and the outcome
+      put in the matching entry of \p results, with the primal solution if
+      \p keepSolution is true. For an Osi1API object, or any API with the
+      methods ScenarioJob uses.
+
+      The scenarios are shared out among \p numWorkers worker processes (0
+      means one per processor, and there are never more than the
+      scenarios), forked from this one once \p obj is loaded. A worker
+      shares the parent's memory copy-on-write, so the model and the solver
+      state are neither reloaded nor copied (compare <tt>clone(true)</tt>);
+      only the pages a scenario changes are. The shares of workers that
+      can't be started (always, on Windows) are solved here, one after
+      another, on \p obj. Either way \p obj is left with its model and
+      basis as they were. Don't call this from a solve thread.
+
+      \returns the number of scenarios left ScenarioResult::NotRun because
+      their worker died, or -1 if \p obj is null
+    */
+    template <class T>
+    int runScenarios (T *obj, const std::vector<ModelDelta> &scenarios,
+                      std::vector<ScenarioResult> &results,
+                      int numWorkers = 0, bool keepSolution = false) {
+        results.assign(scenarios.size(), ScenarioResult()) ;
+        if (obj == 0) return (-1) ;
+        if (scenarios.empty()) return (0) ;
+        if (numWorkers <= 0) numWorkers = numProcessors() ;
+        if (numWorkers > static_cast<int>(scenarios.size()))
+            numWorkers = static_cast<int>(scenarios.size()) ;
+        /*
+          Fork them all before solving anything here, so that each starts
+          from obj as the caller left it.
+        */
+        ScenarioWorkers workers(results) ;
+        std::vector<int> notStarted ;
+        for (int i = 0 ; i < numWorkers ; i++) {
+            const int started = workers.fork() ;
+            if (started > 0) {
+                ScenarioJob<T>(obj, scenarios, results, i, numWorkers,
+                               keepSolution, &workers).run() ;
+                workers.exitWorker() ;
+            }
+            if (started < 0) notStarted.push_back(i) ;
+        }
+        workers.collect() ;
+        for (size_t k = 0 ; k < notStarted.size() ; k++)
+            ScenarioJob<T>(obj, scenarios, results, notStarted[k], numWorkers,
+                           keepSolution, 0).run() ;
+        int notRun = 0 ;
+        for (size_t k = 0 ; k < results.size() ; k++) {
+            if (results[k].status_ == ScenarioResult::NotRun) notRun++ ;
+        }
+        return (notRun) ;
+    }
+
+    //@}
+
+    /*! \name Warm Start Cache
+        \brief Start solves from the final basis of a like model solved before.
+
+      With the cache enabled, #initialSolveCached looks up the model by its
+      structure (dimensions and sparsity pattern; see WarmStartCache) and
+      hands the solver the basis a previous solve of such a model finished
+      with. Re-solving a perturbed model, or the same model in a fresh
+      object, then starts warm. Given a directory, the cache keeps its bases
+      there as well and processes can share them.
+    */
+    //@{
+
+    /*! \brief Enable the warm start cache
+
+      With \p dir, bases are kept in that directory as well as in memory.
+      Enabling an enabled cache changes only the directory. Returns 0 on
+      success, -1 if \p dir isn't a directory.
+    */
+    virtual int enableWarmStartCache(const std::string *dir = 0) = 0 ;
+
+    /// Disable the warm start cache and forget the bases held in memory
+    virtual void disableWarmStartCache() = 0 ;
+
+    /// The warm start cache; null unless enabled
+    virtual WarmStartCache *getWarmStartCache() = 0 ;
+
+    /*! \brief Solve \p obj, warm started from the cache
+
+      Falls back on a plain \c initialSolve when the cache is disabled. For
+      any API WarmStartCache::initialSolve accepts (Osi1API). Returns 1 if
+      the solve was warm started, 0 if it wasn't.
+    */
+    template <class T>
+    inline int initialSolveCached (T *obj) {
+        WarmStartCache *cache = getWarmStartCache() ;
+        if (cache == 0) {
+            obj->initialSolve() ;
+            return (0) ;
+        }
+        return (cache->initialSolve(obj)) ;
+    }
+
+    /*! \brief Call #initialSolveCached in the background
+
+      The cache must stay enabled until the solve is done.
+    */
+    template <class T>
+    inline SolveFuture initialSolveCachedAsync (T *obj) {
+        WarmStartCache *cache = getWarmStartCache() ;
+        if (obj == 0) return (submitAsync(0)) ;
+        if (cache == 0) return (submitAsync(new InitialSolveJob<T>(obj))) ;
+        return (submitAsync(new CachedSolveJob<T>(cache, obj))) ;
+    }
+
+    /*! \brief As #initialSolveCached, for \p obj loaded from \p model
+
+      The cache key is the model's (SharedModel::getStructureKey), so the
+      matrix isn't hashed again.
+    */
+    template <class T>
+    inline int initialSolveCached (T *obj, const SharedModel &model) {
+        WarmStartCache *cache = getWarmStartCache() ;
+        if (cache == 0 || !model.isValid()) return (initialSolveCached(obj)) ;
+        return (cache->initialSolve(obj, model.getStructureKey())) ;
+    }
+
+    //@}
+
+    /*! \name Model Cache
+        \brief Read each model once, and share it.
+
+      With the cache enabled, #readMpsShared reads a file into a
+      SharedModel only the first time (or the first time since it
+      changed), and any model equal to one already held is dropped for
+      the one held; see ModelCache. Objects are then loaded from the shared
+      model (#loadModel), which costs what the solver's own copy costs and
+      no parse. The model's structural hash is the warm start cache's key,
+      so a solve can go straight to the basis (#initialSolveCached).
+    */
+    //@{
+
+    /// Enable the model cache; enabling it again changes nothing
+    virtual void enableModelCache() = 0 ;
+
+    /*! \brief Disable the model cache
+
+      The cache lets go of its models; handles held elsewhere stay good.
+    */
+    virtual void disableModelCache() = 0 ;
+
+    /// The model cache; null unless enabled
+    virtual ModelCache *getModelCache() = 0 ;
+
+    /*! \brief Load \p obj from the shared \p model
+
+      For any API with the usual CSC \c loadProblem (ProbMgmtAPI, Osi1API;
+      see callLoadMethod). Names and the objective offset aren't loaded.
+
+      \returns the status of the load, or -1 if \p obj is null or
+      \p model holds no model
+    */
+    template <class T>
+    inline int loadModel (T *obj, const SharedModel &model) {
+        if (obj == 0 || !model.isValid()) return (-1) ;
+        return (callLoadMethod(obj, &T::loadProblem, model)) ;
+    }
+
+    /*! \brief Read the MPS file at \p path into \p obj, through the cache
+
+      With the cache disabled, or for a file that uses MPS features the
+      cache's reader doesn't handle, this is \c obj->readMps(path). If
+      \p model isn't null, it's given the shared model loaded (no model if
+      the cache wasn't used).
+
+      \returns 0 on success, otherwise the error of the read or the load
+    */
+    template <class T>
+    int readMpsShared (T *obj, const std::string &path,
+                       SharedModel *model = 0) {
+        if (model != 0) model->reset() ;
+        if (obj == 0) return (-1) ;
+        ModelCache *cache = getModelCache() ;
+        if (cache == 0) return (obj->readMps(path.c_str())) ;
+        SharedModel shared ;
+        std::string error ;
+        const int retval = cache->readMps(path, shared, error) ;
+        if (retval > 0) return (obj->readMps(path.c_str())) ;
+        if (retval < 0) return (retval) ;
+        if (model != 0) *model = shared ;
+        return (loadModel(obj, shared)) ;
+    }
+
+    //@}
+
+    /*! \name Presolve Cache
+        \brief Presolve a model once, however often it's loaded.
+
+      #presolveModel takes fixed columns, emptied rows and singleton rows
+      out of a shared model (see Presolve). With the cache enabled, the
+      reductions are kept, and a later model with the same matrix and the
+      same fixed columns, whatever its objective and other bounds, goes
+      straight to its reduced problem; see PresolveCache.
+      #initialSolvePresolved loads the reduced problem, solves it, and maps
+      the solution back to the full model. The solver's own presolve still
+      runs on the reduced problem unless it's turned off (for Osi1API, the
+      OsiDoPresolveInInitial hint).
+    */
+    //@{
+
+    /// Enable the presolve cache; enabling it again changes nothing
+    virtual void enablePresolveCache() = 0 ;
+
+    /// Disable the presolve cache; handles held elsewhere stay good
+    virtual void disablePresolveCache() = 0 ;
+
+    /// The presolve cache; null unless enabled
+    virtual PresolveCache *getPresolveCache() = 0 ;
+
+    /*! \brief The reduced problem for \p model
+
+      Through the cache if it's enabled, by a fresh Presolve if it isn't.
+
+      \returns as Presolve::reduce: 0 on success, 1 if presolve shows the
+      model infeasible, -1 if \p model holds no model
+    */
+    inline int presolveModel (const SharedModel &model,
+                              PresolvedProblem &problem) {
+        PresolveCache *cache = getPresolveCache() ;
+        if (cache != 0) return (cache->presolve(model, problem)) ;
+        Presolve presolve ;
+        if (Presolve::make(model, presolve) != 0) return (-1) ;
+        return (presolve.reduce(model, problem)) ;
+    }
+
+    /*! \brief Load \p obj with the reduced \p problem
+
+      As #loadModel, for a reduced problem.
+    */
+    template <class T>
+    inline int loadPresolved (T *obj, const PresolvedProblem &problem) {
+        if (obj == 0 || !problem.getPresolve().isValid()) return (-1) ;
+        return (callLoadMethod(obj, &T::loadProblem, problem)) ;
+    }
+
+    /*! \brief Presolve \p model, solve it in \p obj, and postsolve
+
+      For any API with the Osi1API load, solve and solution methods. \p obj
+      is left holding the reduced problem and its solution; \p solution
+      gets the solution of \p model (see PresolvedProblem::postsolve). The
+      outcome of the solve is for \p obj to say (\c isProvenOptimal and
+      the like).
+
+      \returns 0 if the reduced problem was solved; 1 if presolve showed
+      \p model infeasible, and nothing was loaded; -1 for an error (no
+      model, a failed load, buffers too small)
+    */
+    template <class T>
+    int initialSolvePresolved (T *obj, const SharedModel &model,
+                               SolutionView &solution) {
+        if (obj == 0) return (-1) ;
+        PresolvedProblem problem ;
+        const int retval = presolveModel(model, problem) ;
+        if (retval != 0) return (retval) ;
+        if (loadPresolved(obj, problem) != 0) return (-1) ;
+        obj->initialSolve() ;
+        return (problem.postsolve(model, obj, solution)) ;
+    }
+
+    //@}
+
+    /*! \name Adaptive Selection
+        \brief Choose the library that has been fastest on models like this.
+
+      With the solve history enabled, #createObject given the features of
+      the model to be solved picks among the libraries that supply the API
+      by their past solve times on models of the same class
+      (SolveHistory::choose), now and then trying another to keep
+      learning. #initialSolveRecorded solves and adds the time to the
+      history. Given a file, the history persists from run to run.
+    */
+    //@{
+
+    /*! \brief Enable the solve history
+
+      With \p file, the history is read from that file and kept there as
+      well as in memory. Enabling an enabled history changes only the file.
+      Returns 0 on success, -1 if \p file can't be used.
+    */
+    virtual int enableSolveHistory(const std::string *file = 0) = 0 ;
+
+    /// Disable the solve history and forget the records held in memory
+    virtual void disableSolveHistory() = 0 ;
+
+    /// The solve history; null unless enabled
+    virtual SolveHistory *getSolveHistory() = 0 ;
+
+    /*! \brief Create an object to solve a model with \p features
+
+      As #createObject with no library restriction, but the library is
+      chosen by the solve history; without the history, exactly
+      #createObject.
+    */
+    virtual int createObject(API *&obj, const std::string &apiName,
+                             const SolveHistory::Features &features) = 0 ;
+
+    /*! \brief Add a solve by \p obj to the solve history
+
+      \p obj took \p seconds on a model with \p features; \p solved is
+      false if it didn't finish. Returns 0 if the solve was recorded, -1 if
+      the history is disabled or \p obj's library is unknown.
+    */
+    virtual int recordSolve(const API *obj,
+                            const SolveHistory::Features &features,
+                            double seconds, bool solved) = 0 ;
+
+    /*! \brief Solve \p obj and record the time in the solve history
+
+      For any API with \c initialSolve, the proven status queries, and
+      the methods SolveHistory::featuresOf needs (Osi1API). A solve counts
+      as finished if it proves the model optimal, infeasible or unbounded.
+      Returns as #recordSolve.
+    */
+    template <class T>
+    inline int initialSolveRecorded (T *obj) {
+        const SolveHistory::Features features = SolveHistory::featuresOf(obj) ;
+        const uint64_t start = PerfStats::now() ;
+        obj->initialSolve() ;
+        const double seconds = (PerfStats::now()-start)*1.0e-9 ;
+        const bool solved = obj->isProvenOptimal() ||
+                            obj->isProvenPrimalInfeasible() ||
+                            obj->isProvenDualInfeasible() ;
+        return (recordSolve(obj, features, seconds, solved)) ;
+    }
+
+    //@}
+
+    /*! \name Performance Statistics
+        \brief Counts and timings of plugin framework operations
+
+      The plugin manager keeps, for each plugin library, counts, cumulative
+      time, and latency histograms for library load, initialisation and
+      unload, and for object creation and destruction, along with the number
+      of live objects. See PerfStats.
+    */
+    //@{
+
+    /*! \brief Get the current statistics
+
+      One entry per plugin library; libraries known to this ControlAPI object
+      have their short name filled in.
+
+      \returns 0 on success, -2 if the plugin manager can't be found.
+    */
+    virtual int getPerfStats(std::vector<PerfStats::LibStats> &stats) = 0 ;
+
+    /*! \brief Write the current statistics to \p os as JSON
+
+      See PerfStats::writeJSON for the format.
+
+      \returns 0 on success, -2 if the plugin manager can't be found, -1 if
+      the output failed.
+    */
+    virtual int dumpPerfStats(std::ostream &os) = 0 ;
+
+    //@}
+
+    /*! \name Memory Accounting
+        \brief Memory held by plugin libraries and their objects, and limits
+
+      A plugin library reports the memory it and its objects hold (see
+      Osi2PluginMem.hpp) and the plugin manager keeps account (see
+      MemAccount). Over its soft limit, a library is asked for no new
+      objects, so #createObject fails; a library can't go over its hard
+      limit, so whatever the plugin was doing when it reached it (loading a
+      problem, say) fails. Libraries that don't report their memory are
+      charged nothing. Hosted libraries are not accounted for here.
+    */
+    //@{
+
+    /*! \brief Get the memory account of the library known as \p shortName
+
+      \returns 0 on success, -1 if the library isn't known or loaded, -2
+      if the plugin manager can't be found.
+    */
+    virtual int getMemUsage(const std::string &shortName,
+                            MemAccount::Usage &usage) = 0 ;
+
+    /*! \brief Set the memory limits of the library known as \p shortName
+
+      In bytes; 0 for no limit. Returns as #getMemUsage.
+    */
+    virtual int setMemLimits(const std::string &shortName, int64_t softLimit,
+                             int64_t hardLimit) = 0 ;
+
+    /*! \brief Bytes held by \p obj
+
+      \returns the bytes charged to \p obj by its library, or -1 if \p obj
+      didn't come from a library loaded in this process.
+    */
+    virtual int64_t getObjMemUsage(const API *obj) = 0 ;
+
     //@}
 
     /*! \name Control API control methods
@@ -139,6 +888,16 @@ public:
 
     //@}
 
+protected:
+
+    /*! \brief Set the identification information of an API object
+
+      For use by control API implementations to record, in each object they
+      create, whatever they need to destroy it.
+    */
+    static inline void setObjIdentInfo (API *obj, const void *identInfo)
+    { obj->setIdentInfo(identInfo) ; }
+
 } ;
 
 } // namespace Osi2 ;
@@ -15,15 +15,34 @@
 #include "Osi2API.hpp"
 #include "Osi2ControlAPI.hpp"
 #include "Osi2ControlAPI_Imp.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
 
 #include "Osi2nullptr.hpp"
 #include "Osi2PluginManager.hpp"
 #include "Osi2DynamicLibrary.hpp"
 #include "Osi2ObjectAdapter.hpp"
+#include "Osi2MsgGate.hpp"
+#include "Osi2Numa.hpp"
 
+/*
+  Issue a message only if it will print. Arguments shifted into the message
+  are not evaluated otherwise.
+*/
+#define CTRLAPI_MSG(zz_id) \
+    OSI2_MSG_IF(msgEnabled(msgHandler_, ctrlAPIMsgLvl(zz_id))) \
+        msgHandler_->message((zz_id), msgs_)
 
 namespace Osi2 {
 
+ControlAPI_Imp::IdentInfoMap ControlAPI_Imp::identInfoMap_ ;
+
+namespace {
+
+/// Serialises use of ControlAPI_Imp::identInfoMap_
+Mutex identInfoMutex ;
+
+}
+
 /*
   Boilerplate: Constructors, destructors, & such like
 */
@@ -35,13 +54,20 @@ namespace Osi2 {
 */
 ControlAPI_Imp::ControlAPI_Imp ()
     : pluginMgr_(0),
-      logLvl_(7)
+      logLvl_(7),
+      solvePool_(nullptr),
+      numAsyncThreads_(0),
+      numaPlacement_(false),
+      warmStartCache_(nullptr),
+      modelCache_(nullptr),
+      presolveCache_(nullptr),
+      solveHistory_(nullptr)
 {
     knownLibMap_.clear() ;
     msgHandler_ = new CoinMessageHandler() ;
     msgs_ = CtrlAPIMessages() ;
     msgHandler_->setLogLevel(logLvl_) ;
-    msgHandler_->message(CTRLAPI_INIT, msgs_) << "default" << CoinMessageEol ;
+    CTRLAPI_MSG(CTRLAPI_INIT) << "default" << CoinMessageEol ;
 }
 
 /*
@@ -50,9 +76,17 @@ ControlAPI_Imp::ControlAPI_Imp ()
 ControlAPI_Imp::ControlAPI_Imp (const ControlAPI_Imp &rhs)
     : pluginMgr_(rhs.pluginMgr_),
       knownLibMap_(rhs.knownLibMap_),
+      libIDIndex_(rhs.libIDIndex_),
       dfltPluginDir_(rhs.dfltPluginDir_),
       dfltHandler_(rhs.dfltHandler_),
-      logLvl_(rhs.logLvl_)
+      logLvl_(rhs.logLvl_),
+      solvePool_(nullptr),
+      numAsyncThreads_(rhs.numAsyncThreads_),
+      numaPlacement_(rhs.numaPlacement_),
+      warmStartCache_(nullptr),
+      modelCache_(nullptr),
+      presolveCache_(nullptr),
+      solveHistory_(nullptr)
 {
     /*
       If this is our handler, make an independent copy. If it's the client's
@@ -66,7 +100,14 @@ ControlAPI_Imp::ControlAPI_Imp (const ControlAPI_Imp &rhs)
     }
     msgs_ = rhs.msgs_ ;
     msgHandler_->setLogLevel(logLvl_) ;
-    msgHandler_->message(CTRLAPI_INIT, msgs_) << "copy" << CoinMessageEol ;
+    copyWarmStartCache(rhs) ;
+    delete modelCache_ ;
+    modelCache_ = (rhs.modelCache_ == nullptr) ? nullptr : new ModelCache() ;
+    delete presolveCache_ ;
+    presolveCache_ =
+        (rhs.presolveCache_ == nullptr) ? nullptr : new PresolveCache() ;
+    copySolveHistory(rhs) ;
+    CTRLAPI_MSG(CTRLAPI_INIT) << "copy" << CoinMessageEol ;
 }
 
 /*
@@ -79,10 +120,13 @@ ControlAPI_Imp &ControlAPI_Imp::operator= (const ControlAPI_Imp &rhs)
     */
     if (this == &rhs) return (*this) ;
     /*
-      Otherwise, get to it.
+      Otherwise, get to it. Abandoned race entrants belong to us, not to
+      rhs; settle them while we still have our own message handler.
     */
+    reapRaces(true) ;
     pluginMgr_ = rhs.pluginMgr_ ;
     knownLibMap_ = rhs.knownLibMap_ ;
+    libIDIndex_ = rhs.libIDIndex_ ;
     dfltPluginDir_ = rhs.dfltPluginDir_ ;
     /*
       If it's our handler, we need to delete the old and replace with the new.
@@ -101,6 +145,13 @@ ControlAPI_Imp &ControlAPI_Imp::operator= (const ControlAPI_Imp &rhs)
     }
     msgs_ = rhs.msgs_ ;
     msgHandler_->setLogLevel(logLvl_) ;
+    copyWarmStartCache(rhs) ;
+    delete modelCache_ ;
+    modelCache_ = (rhs.modelCache_ == nullptr) ? nullptr : new ModelCache() ;
+    delete presolveCache_ ;
+    presolveCache_ =
+        (rhs.presolveCache_ == nullptr) ? nullptr : new PresolveCache() ;
+    copySolveHistory(rhs) ;
 
     return (*this) ;
 }
@@ -111,7 +162,19 @@ ControlAPI_Imp &ControlAPI_Imp::operator= (const ControlAPI_Imp &rhs)
 */
 ControlAPI_Imp::~ControlAPI_Imp ()
 {
+    reapRaces(true) ;
+    delete solvePool_ ;
+    solvePool_ = nullptr ;
+    delete warmStartCache_ ;
+    warmStartCache_ = nullptr ;
+    delete modelCache_ ;
+    modelCache_ = nullptr ;
+    delete presolveCache_ ;
+    presolveCache_ = nullptr ;
+    delete solveHistory_ ;
+    solveHistory_ = nullptr ;
     knownLibMap_.clear() ;
+    libIDIndex_.clear() ;
     /*
       If this is our handler, delete it. Otherwise it's the client's
       responsibility.
@@ -157,6 +220,11 @@ ControlAPI *ControlAPI_Imp::clone ()
   ControlAPI keeps a map that associates shortName with the libName and
   dirName.
 
+  If the library has a manifest and the plugin manager's lazy loading is
+  enabled, the library isn't actually loaded until an object is requested
+  for one of the APIs named in the manifest (see PluginManager). The short
+  name is associated with the library either way.
+
   Returns:
    -4: no plugin manager
    -3: initFunc failed
@@ -199,23 +267,62 @@ int ControlAPI_Imp::load (const std::string &shortName,
         retval = pluginMgr_->loadOneLib(libName, 0, &uniqueID) ;
     }
     if (retval < 0) {
-        msgHandler_->message(CTRLAPI_LIBLDFAIL, msgs_)
+        CTRLAPI_MSG(CTRLAPI_LIBLDFAIL)
                 << shortName << fullPath << CoinMessageEol ;
         return (retval) ;
     }
     if (retval == 1) {
-        msgHandler_->message(CTRLAPI_UNREG, msgs_)
+        CTRLAPI_MSG(CTRLAPI_UNREG)
                 << fullPath << shortName << CoinMessageEol ;
     }
-    DynLibInfo &info = knownLibMap_[shortName] ;
-    info.fullPath_ = fullPath ;
-    info.uniqueID_ = uniqueID ;
-    msgHandler_->message(CTRLAPI_LIBLDOK, msgs_)
-            << shortName << fullPath << CoinMessageEol ;
+    addKnownLib(shortName, fullPath, uniqueID) ;
+    if (retval == 0 && pluginMgr_->isDeferred(uniqueID)) {
+        CTRLAPI_MSG(CTRLAPI_LIBLDDEFER)
+                << shortName << fullPath << CoinMessageEol ;
+    } else {
+        CTRLAPI_MSG(CTRLAPI_LIBLDOK)
+                << shortName << fullPath << CoinMessageEol ;
+    }
 
     return (retval) ;
 }
 
+/*
+  Hosted load. The workers do the actual loading; the plugin manager in this
+  process never sees the library. The host's address serves as the unique
+  ID, which keeps the short name lookups working.
+*/
+int ControlAPI_Imp::loadHosted (const std::string &shortName,
+                                const std::string &libName,
+                                const std::string *dirName, int numWorkers)
+{
+    if (knownLibMap_.find(shortName) != knownLibMap_.end()) return (1) ;
+    if (!PluginHost::isSupported()) return (-5) ;
+    if (findPluginMgr() == nullptr) return (-4) ;
+
+    std::string fullPath = libName ;
+    if (dirName != nullptr && (*dirName) != "") {
+        char dirSep = CoinFindDirSeparator() ;
+        fullPath = (*dirName) + dirSep + fullPath ;
+    } else {
+        dirName = nullptr ;
+    }
+    PluginHost *host = new PluginHost() ;
+    std::string errStr ;
+    if (host->start(libName, dirName, numWorkers, errStr) < 0) {
+        CTRLAPI_MSG(CTRLAPI_HOSTLDFAIL)
+                << shortName << fullPath << errStr << CoinMessageEol ;
+        delete host ;
+        return (-1) ;
+    }
+    DynLibInfo &info = addKnownLib(shortName, fullPath, host) ;
+    info.host_ = host ;
+    CTRLAPI_MSG(CTRLAPI_HOSTLDOK)
+            << shortName << fullPath << host->getNumWorkers() << CoinMessageEol ;
+
+    return (0) ;
+}
+
 /*
   Determine the default directory and call the base load method.
 
@@ -274,17 +381,34 @@ int ControlAPI_Imp::load (const std::string &shortName)
 int ControlAPI_Imp::unload (const std::string &shortName)
 {
     int retval = -1 ;
+    /*
+      An abandoned race entrant may still be running in this library.
+    */
+    reapRaces(true) ;
     /*
       Look for the map entry in known libraries. Return if we don't find it.
     */
     LibMapType::iterator knownIter = knownLibMap_.find(shortName) ;
     if (knownIter == knownLibMap_.end()) {
-        msgHandler_->message(CTRLAPI_UNREG, msgs_) ;
-        msgHandler_->printing(false) << "" ;
-        msgHandler_->printing(true) << shortName << CoinMessageEol ;
+        if (msgEnabled(msgHandler_, ctrlAPIMsgLvl(CTRLAPI_UNREG))) {
+            msgHandler_->message(CTRLAPI_UNREG, msgs_) ;
+            msgHandler_->printing(false) << "" ;
+            msgHandler_->printing(true) << shortName << CoinMessageEol ;
+        }
         retval = 2 ;
         return (retval) ;
     }
+    /*
+      A hosted library: stop the workers and forget the library.
+    */
+    if (knownIter->second.host_ != nullptr) {
+        const std::string fullPath = knownIter->second.fullPath_ ;
+        delete knownIter->second.host_ ;
+        eraseKnownLib(knownIter) ;
+        CTRLAPI_MSG(CTRLAPI_LIBCLOSEOK)
+                << shortName << fullPath << CoinMessageEol ;
+        return (0) ;
+    }
     /*
       Make sure we can find the plugin manager.
     */
@@ -309,10 +433,10 @@ int ControlAPI_Imp::unload (const std::string &shortName)
         retval = pluginMgr_->unloadOneLib(libName) ;
     }
     if (retval == 0) {
-        msgHandler_->message(CTRLAPI_LIBCLOSEOK, msgs_)
+        CTRLAPI_MSG(CTRLAPI_LIBCLOSEOK)
                 << shortName << fullPath << CoinMessageEol ;
     } else {
-        msgHandler_->message(CTRLAPI_LIBCLOSEFAIL, msgs_)
+        CTRLAPI_MSG(CTRLAPI_LIBCLOSEFAIL)
                 << shortName << fullPath << CoinMessageEol ;
     }
 
@@ -349,41 +473,131 @@ int ControlAPI_Imp::createObject (API *&obj, const std::string &apiName,
       soldier on.
     */
     PluginUniqueID libID = 0 ;
-    bool restricted = false ;
-    std::string forPrinting = "bogus!" ;
-    if (shortName != 0 && (*shortName) != "") {
-        restricted = true ;
-        forPrinting = *shortName ;
-        LibMapType::iterator knownIter = knownLibMap_.find((*shortName)) ;
-        if (knownIter == knownLibMap_.end()) {
-            msgHandler_->message(CTRLAPI_LIBUNREG, msgs_)
-                    << (*shortName) << CoinMessageEol ;
-        } else {
-            libID = knownIter->second.uniqueID_ ;
-        }
-    }
+    PluginHost *host = nullptr ;
+    const bool restricted = resolveShortName(shortName, libID, host) ;
     /*
-      Invoke the plugin manager's createObject method.
+      Invoke the plugin manager's createObject method (or the host's, for a
+      hosted library). If the API name is already known to the plugin
+      manager, use the handle; otherwise use the name and let the plugin
+      manager sort it out (a successful creation will have interned the
+      name). Record the object's identity.
     */
     DummyAdapter dummy ;
-    obj = static_cast<API *>(pluginMgr_->createObject(apiName, libID, dummy)) ;
+    APIHandle api = pluginMgr_->findAPIHandle(apiName) ;
+    if (host != nullptr) {
+        std::string errStr ;
+        obj = host->createObject(apiName, errStr) ;
+        if (obj != nullptr && api < 0) api = pluginMgr_->getAPIHandle(apiName) ;
+    } else if (api >= 0) {
+        obj = static_cast<API *>(pluginMgr_->createObject(api, libID, dummy)) ;
+    } else {
+        obj = static_cast<API *>(pluginMgr_->createObject(apiName,
+                                 libID, dummy)) ;
+        if (obj != nullptr) api = pluginMgr_->findAPIHandle(apiName) ;
+    }
+    const bool withLib = (restricted && libID != 0) ;
     if (obj == nullptr) {
-        msgHandler_->message(CTRLAPI_CREATEFAIL, msgs_) << apiName ;
-        msgHandler_->printing(restricted && libID != 0) << forPrinting ;
-        msgHandler_->printing(true) << CoinMessageEol ;
+        if (msgEnabled(msgHandler_, ctrlAPIMsgLvl(CTRLAPI_CREATEFAIL))) {
+            msgHandler_->message(CTRLAPI_CREATEFAIL, msgs_) << apiName ;
+            msgHandler_->printing(withLib)
+                    << (withLib ? *shortName : apiName) ;
+            msgHandler_->printing(true) << CoinMessageEol ;
+        }
         retval = -1 ;
     } else {
-        APIObjIdentInfo *apiIdent = new APIObjIdentInfo(apiName,libID) ;
-	setIdentInfo(apiIdent) ;
-        msgHandler_->message(CTRLAPI_CREATEOK, msgs_) << apiName ;
-        msgHandler_->printing(restricted && libID != 0) << forPrinting ;
-        msgHandler_->printing(true) << CoinMessageEol ;
+        setObjIdentInfo(obj, internIdentInfo(api, libID, host)) ;
+        if (msgEnabled(msgHandler_, ctrlAPIMsgLvl(CTRLAPI_CREATEOK))) {
+            msgHandler_->message(CTRLAPI_CREATEOK, msgs_) << apiName ;
+            msgHandler_->printing(withLib)
+                    << (withLib ? *shortName : apiName) ;
+            msgHandler_->printing(true) << CoinMessageEol ;
+        }
         retval = (restricted && libID == 0) ? 1 : 0 ;
     }
 
     return (retval) ;
 }
 
+/*
+  Create a batch of objects. Objects in one batch can come from different
+  libraries (the copies of a library pool), so identities are looked up per
+  object, but consecutive objects from the same library share the lookup.
+*/
+int ControlAPI_Imp::createObjects (std::vector<API *> &objs,
+                                   const std::string &apiName, int count,
+                                   const std::string *shortName)
+{
+    objs.clear() ;
+    if (findPluginMgr() == nullptr) return (-2) ;
+    if (count <= 0) return (0) ;
+    PluginUniqueID libID = 0 ;
+    PluginHost *host = nullptr ;
+    const bool restricted = resolveShortName(shortName, libID, host) ;
+    if (!restricted && count > 1) {
+        PluginCaps need = PluginCaps() ;
+        need.props_ = PluginProp_ThreadSafe ;
+        libID = pluginMgr_->selectLib(apiName, need) ;
+    }
+    APIHandle api = -1 ;
+    std::vector<PluginUniqueID> libIDs ;
+    if (host != nullptr) {
+        std::string errStr ;
+        for (int i = 0 ; i < count ; i++) {
+            API *obj = host->createObject(apiName, errStr) ;
+            if (obj == nullptr) break ;
+            objs.push_back(obj) ;
+            libIDs.push_back(libID) ;
+        }
+        if (!objs.empty()) api = pluginMgr_->getAPIHandle(apiName) ;
+    } else {
+        DummyAdapter dummy ;
+        std::vector<void *> raw ;
+        api = pluginMgr_->findAPIHandle(apiName) ;
+        if (api >= 0) {
+            pluginMgr_->createObjects(api, libID, count, raw, libIDs, dummy) ;
+        } else {
+            pluginMgr_->createObjects(apiName, libID, count, raw, libIDs,
+                                      dummy) ;
+            if (!raw.empty()) api = pluginMgr_->findAPIHandle(apiName) ;
+        }
+        for (size_t i = 0 ; i < raw.size() ; i++)
+            objs.push_back(static_cast<API *>(raw[i])) ;
+    }
+    const APIObjIdentInfo *ident = nullptr ;
+    for (size_t i = 0 ; i < objs.size() ; i++) {
+        if (ident == nullptr || ident->libID_ != libIDs[i])
+            ident = internIdentInfo(api, libIDs[i], host) ;
+        setObjIdentInfo(objs[i], ident) ;
+    }
+    const int made = static_cast<int>(objs.size()) ;
+    const bool withLib = (restricted && libID != 0) ;
+    const CtrlAPIMsg msgID =
+        (made == 0) ? CTRLAPI_CREATEFAIL : CTRLAPI_CREATEBATCHOK ;
+    if (msgEnabled(msgHandler_, ctrlAPIMsgLvl(msgID))) {
+        msgHandler_->message(msgID, msgs_) ;
+        if (made > 0) (*msgHandler_) << made << count ;
+        (*msgHandler_) << apiName ;
+        msgHandler_->printing(withLib)
+                << (withLib ? *shortName : apiName) ;
+        msgHandler_->printing(true) << CoinMessageEol ;
+    }
+    if (made < count) return (-1) ;
+    return ((restricted && libID == 0) ? 1 : 0) ;
+}
+
+int ControlAPI_Imp::selectLibrary (std::string &shortName,
+                                   const std::string &apiName,
+                                   const PluginCaps &need)
+{
+    shortName.clear() ;
+    if (findPluginMgr() == nullptr) return (-2) ;
+    PluginUniqueID libID = pluginMgr_->selectLib(apiName, need) ;
+    const std::string *name = (libID == 0) ? nullptr : findShortName(libID) ;
+    if (name == nullptr) return (-1) ;
+    shortName = *name ;
+    return (0) ;
+}
+
 /*
   Invoke the plugin manager's destroyObject method.
 
@@ -407,34 +621,615 @@ int ControlAPI_Imp::destroyObject (API *&obj)
     /*
       Retrieve the identification information.
     */
-    const APIObjIdentInfo *apiIdent =
-        static_cast<const APIObjIdentInfo *>(getIdentInfo()) ;
+    const APIObjIdentInfo *apiIdent = (obj == nullptr) ? nullptr :
+        static_cast<const APIObjIdentInfo *>(obj->getIdentInfo()) ;
     if (apiIdent == nullptr) {
-      msgHandler_->message(CTRLAPI_NOAPIIDENT,msgs_) << CoinMessageEol ;
+      CTRLAPI_MSG(CTRLAPI_NOAPIIDENT) << CoinMessageEol ;
       retval = -3 ;
       return (retval) ;
     }
-    const std::string &apiName = apiIdent->apiName_ ;
+    const std::string &apiName = *apiIdent->apiName_ ;
     const PluginUniqueID &libID = apiIdent->libID_ ;
     /*
-      Invoke the plugin manager's destroyObject.
+      Invoke the plugin manager's destroyObject, or the host's if the object
+      is a proxy.
     */
-    retval = pluginMgr_->destroyObject(apiName,libID,obj) ;
-    if (retval != 0) {
-        msgHandler_->message(CTRLAPI_DESTROYFAIL, msgs_) << apiName ;
-        msgHandler_->printing(libID != 0) << getShortName(libID) ;
+    if (apiIdent->host_ != nullptr) {
+        retval = apiIdent->host_->destroyObject(obj) ;
+    } else {
+        retval = pluginMgr_->destroyObject(apiIdent->api_,libID,obj) ;
+    }
+    /*
+      Report the result. Don't look up the short name unless the message
+      will print.
+    */
+    const CtrlAPIMsg msgID =
+        (retval != 0) ? CTRLAPI_DESTROYFAIL : CTRLAPI_DESTROYOK ;
+    if (msgEnabled(msgHandler_, ctrlAPIMsgLvl(msgID))) {
+        static const std::string unknownLib("<unknown lib ID>") ;
+        const std::string *libName = findShortName(libID) ;
+        if (libName == nullptr) libName = &unknownLib ;
+        msgHandler_->message(msgID, msgs_) << apiName ;
+        msgHandler_->printing(libID != 0) << (*libName) ;
         msgHandler_->printing(true) << CoinMessageEol ;
+    }
+    if (retval != 0) {
         retval = -1 ;
     } else {
-        msgHandler_->message(CTRLAPI_DESTROYOK, msgs_) << apiName ;
-        msgHandler_->printing(libID != 0) << getShortName(libID) ;
-        msgHandler_->printing(true) << CoinMessageEol ;
         retval = (libID == 0) ? 1 : 0 ;
+        obj = nullptr ;
     }
 
     return (retval) ;
 }
 
+/*
+  Check every identity first, so that a stranger in the batch doesn't leave
+  it half destroyed. Proxies go back to their hosts one at a time; runs of
+  objects of the same API go to the plugin manager together.
+*/
+int ControlAPI_Imp::destroyObjects (std::vector<API *> &objs)
+{
+    if (findPluginMgr() == nullptr) return (-2) ;
+    std::vector<const APIObjIdentInfo *> idents(objs.size(), nullptr) ;
+    for (size_t i = 0 ; i < objs.size() ; i++) {
+        if (objs[i] != nullptr)
+            idents[i] = static_cast<const APIObjIdentInfo *>(
+                            objs[i]->getIdentInfo()) ;
+        if (idents[i] == nullptr) {
+            CTRLAPI_MSG(CTRLAPI_NOAPIIDENT) << CoinMessageEol ;
+            return (-3) ;
+        }
+    }
+    const int total = static_cast<int>(objs.size()) ;
+    int destroyed = 0 ;
+    size_t first = 0 ;
+    while (first < objs.size()) {
+        const APIObjIdentInfo *ident = idents[first] ;
+        if (ident->host_ != nullptr) {
+            if (ident->host_->destroyObject(objs[first]) == 0) {
+                objs[first] = nullptr ;
+                destroyed++ ;
+            }
+            first++ ;
+            continue ;
+        }
+        size_t last = first+1 ;
+        while (last < objs.size() && idents[last]->host_ == nullptr &&
+                idents[last]->api_ == ident->api_)
+            last++ ;
+        std::vector<void *> victims ;
+        std::vector<PluginUniqueID> libIDs ;
+        for (size_t i = first ; i < last ; i++) {
+            victims.push_back(objs[i]) ;
+            libIDs.push_back(idents[i]->libID_) ;
+        }
+        pluginMgr_->destroyObjects(ident->api_, victims, libIDs) ;
+        for (size_t i = first ; i < last ; i++) {
+            if (victims[i-first] != nullptr) continue ;
+            objs[i] = nullptr ;
+            destroyed++ ;
+        }
+        first = last ;
+    }
+    /*
+      On failure, report the first object left standing.
+    */
+    if (destroyed < total) {
+        if (msgEnabled(msgHandler_, ctrlAPIMsgLvl(CTRLAPI_DESTROYFAIL))) {
+            size_t i = 0 ;
+            while (objs[i] == nullptr) i++ ;
+            static const std::string unknownLib("<unknown lib ID>") ;
+            const PluginUniqueID libID = idents[i]->libID_ ;
+            const std::string *libName = findShortName(libID) ;
+            if (libName == nullptr) libName = &unknownLib ;
+            msgHandler_->message(CTRLAPI_DESTROYFAIL, msgs_)
+                    << *idents[i]->apiName_ ;
+            msgHandler_->printing(libID != 0) << (*libName) ;
+            msgHandler_->printing(true) << CoinMessageEol ;
+        }
+        return (-1) ;
+    }
+    CTRLAPI_MSG(CTRLAPI_DESTROYBATCHOK) << destroyed << total << CoinMessageEol ;
+    objs.clear() ;
+    return (0) ;
+}
+
+/*
+  Racing. The objects are made here, on the calling thread, since the
+  control API isn't safe for concurrent use; the entrants' threads only read
+  and solve. The race is over when an entrant solves to optimality or all
+  have finished.
+*/
+int ControlAPI_Imp::race (API *&winner, std::vector<RaceEntry> &entries,
+                          const std::string &path,
+                          const std::vector<std::string> &shortNames,
+                          bool keepNames)
+{
+    winner = nullptr ;
+    entries.clear() ;
+    if (findPluginMgr() == nullptr) return (-2) ;
+    reapRaces(false) ;
+    const int numRacers = static_cast<int>(shortNames.size()) ;
+    Race *race = new Race ;
+    race->path_ = path ;
+    race->keepNames_ = keepNames ;
+    race->winner_ = -1 ;
+    race->running_ = 0 ;
+    race->racers_.resize(numRacers) ;
+    const std::string apiName("ProbMgmt") ;
+    for (int i = 0 ; i < numRacers ; i++) {
+        Racer &racer = race->racers_[i] ;
+        racer.race_ = race ;
+        racer.ndx_ = i ;
+        racer.node_ = getNumaNode(i) ;
+        racer.obj_ = nullptr ;
+        racer.started_ = false ;
+        racer.finished_ = false ;
+        racer.read_ = false ;
+        racer.outcome_ = RaceEntry::NotRun ;
+        racer.status_ = -1 ;
+        racer.start_ = 0 ;
+        racer.readEnd_ = 0 ;
+        racer.solveEnd_ = 0 ;
+        if (knownLibMap_.find(shortNames[i]) == knownLibMap_.end()) {
+            CTRLAPI_MSG(CTRLAPI_LIBUNREG) << shortNames[i] << CoinMessageEol ;
+            continue ;
+        }
+        API *obj = nullptr ;
+        if (createObject(obj, apiName, &shortNames[i]) != 0 ||
+                dynamic_cast<ProbMgmtAPI *>(obj) == nullptr) {
+            if (obj != nullptr) destroyObject(obj) ;
+            continue ;
+        }
+        dynamic_cast<ProbMgmtAPI *>(obj)->setCancelToken(race->stop_) ;
+        racer.obj_ = obj ;
+    }
+    /*
+      Start them all together, then wait for a winner or for the field to
+      run out.
+    */
+    const double ticksPerSec = 1.0e9 ;
+    int winnerNdx = -1 ;
+    {
+        ScopedLock lock(race->mutex_) ;
+        for (int i = 0 ; i < numRacers ; i++) {
+            Racer &racer = race->racers_[i] ;
+            if (racer.obj_ == nullptr) continue ;
+            racer.start_ = PerfStats::now() ;
+            if (startThread(racer.thread_, raceMain, &racer)) {
+                racer.started_ = true ;
+                race->running_++ ;
+            }
+        }
+        while (race->winner_ < 0 && race->running_ > 0)
+            race->changed_.wait(race->mutex_) ;
+        winnerNdx = race->winner_ ;
+        race->stop_.cancel() ;
+        const uint64_t end = PerfStats::now() ;
+        entries.resize(numRacers) ;
+        for (int i = 0 ; i < numRacers ; i++) {
+            const Racer &racer = race->racers_[i] ;
+            RaceEntry &entry = entries[i] ;
+            entry.shortName_ = shortNames[i] ;
+            entry.outcome_ = RaceEntry::NotRun ;
+            entry.status_ = -1 ;
+            entry.readTime_ = 0.0 ;
+            entry.solveTime_ = 0.0 ;
+            if (!racer.started_) continue ;
+            if (racer.finished_) {
+                entry.outcome_ = racer.outcome_ ;
+                entry.status_ = racer.status_ ;
+                entry.readTime_ = (racer.readEnd_-racer.start_)/ticksPerSec ;
+                entry.solveTime_ =
+                    (racer.solveEnd_-racer.readEnd_)/ticksPerSec ;
+            } else {
+                entry.outcome_ = RaceEntry::Abandoned ;
+                const uint64_t readEnd = racer.read_ ? racer.readEnd_ : end ;
+                entry.readTime_ = (readEnd-racer.start_)/ticksPerSec ;
+                entry.solveTime_ = (end-readEnd)/ticksPerSec ;
+            }
+        }
+    }
+    /*
+      Settle the finished entrants: the winner's object goes to the client,
+      the others are destroyed. Entrants still running are left to
+      #reapRaces, and the race with them.
+    */
+    bool abandoned = false ;
+    for (int i = 0 ; i < numRacers ; i++) {
+        Racer &racer = race->racers_[i] ;
+        if (entries[i].outcome_ == RaceEntry::Abandoned) {
+            abandoned = true ;
+            continue ;
+        }
+        if (racer.started_) {
+            joinThread(racer.thread_) ;
+            racer.started_ = false ;
+        }
+        if (i == winnerNdx) {
+            winner = racer.obj_ ;
+            racer.obj_ = nullptr ;
+        } else if (racer.obj_ != nullptr) {
+            destroyObject(racer.obj_) ;
+        }
+    }
+    if (abandoned)
+        abandoned_.push_back(race) ;
+    else
+        delete race ;
+
+    if (winnerNdx >= 0) {
+        const RaceEntry &entry = entries[winnerNdx] ;
+        CTRLAPI_MSG(CTRLAPI_RACEWON)
+                << path << entry.shortName_
+                << (entry.readTime_+entry.solveTime_) << (numRacers-1)
+                << CoinMessageEol ;
+    } else {
+        CTRLAPI_MSG(CTRLAPI_RACENOWIN) << path << numRacers << CoinMessageEol ;
+    }
+    return (winnerNdx) ;
+}
+
+/*
+  An entrant. Once the problem is read, look to see if the race is already
+  won; if so, there's no point in solving. A placed entrant is pinned
+  before it reads, so the model it reads is on its node.
+*/
+void *ControlAPI_Imp::raceMain (void *arg)
+{
+    Racer &racer = *static_cast<Racer *>(arg) ;
+    Race &race = *racer.race_ ;
+    if (racer.node_ >= 0) numaBindThread(racer.node_) ;
+    ProbMgmtAPI *probMgmt = dynamic_cast<ProbMgmtAPI *>(racer.obj_) ;
+    const bool read =
+        (probMgmt->readMps(race.path_.c_str(), race.keepNames_) == 0) ;
+    const uint64_t readEnd = PerfStats::now() ;
+    bool withdraw = false ;
+    {
+        ScopedLock lock(race.mutex_) ;
+        racer.read_ = true ;
+        racer.readEnd_ = readEnd ;
+        withdraw = (race.winner_ >= 0) ;
+    }
+    int status = -1 ;
+    if (read && !withdraw) status = probMgmt->initialSolve() ;
+    const uint64_t solveEnd = PerfStats::now() ;
+
+    ScopedLock lock(race.mutex_) ;
+    if (!read) {
+        racer.outcome_ = RaceEntry::ReadFailed ;
+        racer.solveEnd_ = readEnd ;
+    } else if (withdraw) {
+        racer.outcome_ = RaceEntry::Withdrawn ;
+        racer.solveEnd_ = readEnd ;
+    } else {
+        racer.outcome_ = RaceEntry::Solved ;
+        racer.solveEnd_ = solveEnd ;
+        if (status == 0 && race.winner_ < 0) race.winner_ = racer.ndx_ ;
+    }
+    racer.status_ = status ;
+    racer.finished_ = true ;
+    race.running_-- ;
+    race.changed_.wakeAll() ;
+    return (nullptr) ;
+}
+
+void ControlAPI_Imp::reapRaces (bool wait)
+{
+    std::vector<Race *> live ;
+    for (size_t r = 0 ; r < abandoned_.size() ; r++) {
+        Race *race = abandoned_[r] ;
+        bool done = true ;
+        for (size_t i = 0 ; i < race->racers_.size() ; i++) {
+            Racer &racer = race->racers_[i] ;
+            if (!racer.started_) continue ;
+            if (!wait) {
+                ScopedLock lock(race->mutex_) ;
+                if (!racer.finished_) {
+                    done = false ;
+                    continue ;
+                }
+            }
+            joinThread(racer.thread_) ;
+            racer.started_ = false ;
+            if (racer.obj_ != nullptr) destroyObject(racer.obj_) ;
+        }
+        if (done)
+            delete race ;
+        else
+            live.push_back(race) ;
+    }
+    abandoned_.swap(live) ;
+}
+
+int ControlAPI_Imp::setAsyncThreads (int numThreads)
+{
+    if (solvePool_ != nullptr) return (-1) ;
+    numAsyncThreads_ = numThreads ;
+    return (0) ;
+}
+
+/*
+  Start the threads on first use. If none will start, don't keep the pool;
+  the next call will try again.
+*/
+SolveFuture ControlAPI_Imp::submitAsync (AsyncJob *job, int node)
+{
+    if (job == nullptr) return (SolveFuture()) ;
+    if (solvePool_ == nullptr) {
+        SolvePool *pool = new SolvePool ;
+        const int numStarted = pool->start(numAsyncThreads_, numaPlacement_) ;
+        if (numStarted <= 0) {
+            delete pool ;
+            delete job ;
+            CTRLAPI_MSG(CTRLAPI_ASYNCFAIL) << CoinMessageEol ;
+            return (SolveFuture()) ;
+        }
+        solvePool_ = pool ;
+        CTRLAPI_MSG(CTRLAPI_ASYNCSTART) << numStarted << CoinMessageEol ;
+    }
+    return (solvePool_->submit(job, node)) ;
+}
+
+int ControlAPI_Imp::setNumaPlacement (bool on)
+{
+    numaPlacement_ = on ;
+    const int numNodes = NumaTopology::system().getNumNodes() ;
+    if (on) {
+        CTRLAPI_MSG(CTRLAPI_NUMAON) << numNodes << CoinMessageEol ;
+    }
+    return ((solvePool_ != nullptr) ? -1 : numNodes) ;
+}
+
+bool ControlAPI_Imp::getNumaPlacement () const
+{
+    return (numaPlacement_) ;
+}
+
+int ControlAPI_Imp::getNumaNode (int ndx) const
+{
+    if (!numaPlacement_ || ndx < 0) return (-1) ;
+    return (ndx%NumaTopology::system().getNumNodes()) ;
+}
+
+/*
+  Warm start cache. The cache is made on first enable; enabling again just
+  changes the directory. A bad directory leaves the cache as it was.
+*/
+int ControlAPI_Imp::enableWarmStartCache (const std::string *dir)
+{
+    const std::string cacheDir = (dir == nullptr) ? std::string() : *dir ;
+    WarmStartCache *cache = warmStartCache_ ;
+    if (cache == nullptr) cache = new WarmStartCache() ;
+    if (cache->setDirectory(cacheDir) != 0) {
+        if (cache != warmStartCache_) delete cache ;
+        CTRLAPI_MSG(CTRLAPI_WSCACHEBADDIR) << cacheDir << CoinMessageEol ;
+        return (-1) ;
+    }
+    warmStartCache_ = cache ;
+    CTRLAPI_MSG(CTRLAPI_WSCACHEON)
+            << (cacheDir.empty() ? std::string("memory") : cacheDir)
+            << CoinMessageEol ;
+    return (0) ;
+}
+
+void ControlAPI_Imp::disableWarmStartCache ()
+{
+    delete warmStartCache_ ;
+    warmStartCache_ = nullptr ;
+}
+
+WarmStartCache *ControlAPI_Imp::getWarmStartCache ()
+{
+    return (warmStartCache_) ;
+}
+
+/*
+  A copy gets a cache of its own, empty, with the settings of the
+  original's. Bases in the directory are still there to be found.
+*/
+void ControlAPI_Imp::copyWarmStartCache (const ControlAPI_Imp &rhs)
+{
+    delete warmStartCache_ ;
+    warmStartCache_ = nullptr ;
+    if (rhs.warmStartCache_ == nullptr) return ;
+    warmStartCache_ = new WarmStartCache() ;
+    warmStartCache_->setCapacity(rhs.warmStartCache_->getCapacity()) ;
+    warmStartCache_->setDirectory(rhs.warmStartCache_->getDirectory()) ;
+}
+
+void ControlAPI_Imp::enableModelCache ()
+{
+    if (modelCache_ != nullptr) return ;
+    modelCache_ = new ModelCache() ;
+    CTRLAPI_MSG(CTRLAPI_MODELCACHEON) << CoinMessageEol ;
+}
+
+void ControlAPI_Imp::disableModelCache ()
+{
+    delete modelCache_ ;
+    modelCache_ = nullptr ;
+}
+
+ModelCache *ControlAPI_Imp::getModelCache ()
+{
+    return (modelCache_) ;
+}
+
+void ControlAPI_Imp::enablePresolveCache ()
+{
+    if (presolveCache_ != nullptr) return ;
+    presolveCache_ = new PresolveCache() ;
+    CTRLAPI_MSG(CTRLAPI_PRESOLVECACHEON) << CoinMessageEol ;
+}
+
+void ControlAPI_Imp::disablePresolveCache ()
+{
+    delete presolveCache_ ;
+    presolveCache_ = nullptr ;
+}
+
+PresolveCache *ControlAPI_Imp::getPresolveCache ()
+{
+    return (presolveCache_) ;
+}
+
+/*
+  Solve history. As for the warm start cache, the history is made on first
+  enable, and a bad file leaves it as it was.
+*/
+int ControlAPI_Imp::enableSolveHistory (const std::string *file)
+{
+    const std::string path = (file == nullptr) ? std::string() : *file ;
+    SolveHistory *history = solveHistory_ ;
+    if (history == nullptr) history = new SolveHistory() ;
+    if (history->setFile(path) != 0) {
+        if (history != solveHistory_) delete history ;
+        CTRLAPI_MSG(CTRLAPI_HISTORYBADFILE) << path << CoinMessageEol ;
+        return (-1) ;
+    }
+    solveHistory_ = history ;
+    CTRLAPI_MSG(CTRLAPI_HISTORYON)
+            << (path.empty() ? std::string("memory") : path) << CoinMessageEol ;
+    return (0) ;
+}
+
+void ControlAPI_Imp::disableSolveHistory ()
+{
+    delete solveHistory_ ;
+    solveHistory_ = nullptr ;
+}
+
+SolveHistory *ControlAPI_Imp::getSolveHistory ()
+{
+    return (solveHistory_) ;
+}
+
+void ControlAPI_Imp::copySolveHistory (const ControlAPI_Imp &rhs)
+{
+    delete solveHistory_ ;
+    solveHistory_ = nullptr ;
+    if (rhs.solveHistory_ == nullptr) return ;
+    solveHistory_ = new SolveHistory() ;
+    solveHistory_->setExploration(rhs.solveHistory_->getExploration()) ;
+    solveHistory_->setFile(rhs.solveHistory_->getFile()) ;
+}
+
+/*
+  Libraries this object doesn't know by name can't be asked for by name, so
+  they aren't candidates.
+*/
+int ControlAPI_Imp::createObject (API *&obj, const std::string &apiName,
+                                  const SolveHistory::Features &features)
+{
+    obj = nullptr ;
+    if (findPluginMgr() == nullptr) return (-2) ;
+    if (solveHistory_ == nullptr) return (createObject(obj, apiName)) ;
+    std::vector<PluginUniqueID> libIDs ;
+    pluginMgr_->findLibs(apiName, PluginCaps(), libIDs) ;
+    std::vector<std::string> names ;
+    for (size_t i = 0 ; i < libIDs.size() ; i++) {
+        const std::string *name = findShortName(libIDs[i]) ;
+        if (name != nullptr) names.push_back(*name) ;
+    }
+    bool explored = false ;
+    const int pick = solveHistory_->choose(features, names, &explored) ;
+    if (pick < 0) return (createObject(obj, apiName)) ;
+    CTRLAPI_MSG(CTRLAPI_HISTORYPICK)
+            << names[pick] << apiName
+            << (explored ? "to learn" : "fastest so far") << CoinMessageEol ;
+    int retval = createObject(obj, apiName, &names[pick]) ;
+    if (retval < 0) retval = createObject(obj, apiName) ;
+    return (retval) ;
+}
+
+int ControlAPI_Imp::recordSolve (const API *obj,
+                                 const SolveHistory::Features &features,
+                                 double seconds, bool solved)
+{
+    if (solveHistory_ == nullptr) return (-1) ;
+    const APIObjIdentInfo *apiIdent = (obj == nullptr) ? nullptr :
+        static_cast<const APIObjIdentInfo *>(obj->getIdentInfo()) ;
+    if (apiIdent == nullptr) {
+        CTRLAPI_MSG(CTRLAPI_NOAPIIDENT) << CoinMessageEol ;
+        return (-3) ;
+    }
+    const std::string *name = findShortName(apiIdent->libID_) ;
+    if (name == nullptr) return (-1) ;
+    solveHistory_->record(features, *name, seconds, solved) ;
+    return (0) ;
+}
+
+/*
+  Performance statistics. The plugin manager knows libraries only by path;
+  fill in the short names of the ones we know. Ask the plugin manager for
+  the path, rather than using our own record of it, which may lack the
+  directory.
+*/
+int ControlAPI_Imp::getPerfStats (std::vector<PerfStats::LibStats> &stats)
+{
+    if (findPluginMgr() == nullptr) return (-2) ;
+    pluginMgr_->getPerfStats(stats) ;
+    std::map<std::string, std::string> pathToShortName ;
+    for (LibMapType::const_iterator iter = knownLibMap_.begin() ;
+            iter != knownLibMap_.end() ; iter++) {
+        pathToShortName[pluginMgr_->getLibPath(iter->second.uniqueID_)] =
+            iter->first ;
+    }
+    for (size_t i = 0 ; i < stats.size() ; i++) {
+        PerfStats::LibStats &lib = stats[i] ;
+        std::map<std::string, std::string>::const_iterator iter =
+            pathToShortName.find(lib.libPath_) ;
+        if (iter != pathToShortName.end()) lib.shortName_ = iter->second ;
+    }
+    return (0) ;
+}
+
+int ControlAPI_Imp::dumpPerfStats (std::ostream &os)
+{
+    std::vector<PerfStats::LibStats> stats ;
+    int retval = getPerfStats(stats) ;
+    if (retval < 0) return (retval) ;
+    PerfStats::writeJSON(os, stats) ;
+    return (os.good() ? 0 : -1) ;
+}
+
+/*
+  Memory accounting. A hosted library's objects live in the workers, out
+  of reach of this process's plugin manager.
+*/
+int ControlAPI_Imp::getMemUsage (const std::string &shortName,
+                                 MemAccount::Usage &usage)
+{
+    if (findPluginMgr() == nullptr) return (-2) ;
+    LibMapType::const_iterator knownIter = knownLibMap_.find(shortName) ;
+    if (knownIter == knownLibMap_.end() || knownIter->second.host_ != nullptr)
+        return (-1) ;
+    return (pluginMgr_->getMemUsage(knownIter->second.uniqueID_, usage)) ;
+}
+
+int ControlAPI_Imp::setMemLimits (const std::string &shortName,
+                                  int64_t softLimit, int64_t hardLimit)
+{
+    if (findPluginMgr() == nullptr) return (-2) ;
+    LibMapType::const_iterator knownIter = knownLibMap_.find(shortName) ;
+    if (knownIter == knownLibMap_.end() || knownIter->second.host_ != nullptr)
+        return (-1) ;
+    return (pluginMgr_->setMemLimits(knownIter->second.uniqueID_, softLimit,
+                                     hardLimit)) ;
+}
+
+int64_t ControlAPI_Imp::getObjMemUsage (const API *obj)
+{
+    if (obj == nullptr || findPluginMgr() == nullptr) return (-1) ;
+    const APIObjIdentInfo *ident =
+        static_cast<const APIObjIdentInfo *>(obj->getIdentInfo()) ;
+    if (ident == nullptr || ident->host_ != nullptr || ident->libID_ == 0)
+        return (-1) ;
+    return (pluginMgr_->getObjMemUsage(ident->libID_, obj)) ;
+}
+
 /*
   Utility methods
 */
@@ -448,34 +1243,96 @@ PluginManager *ControlAPI_Imp::findPluginMgr()
     if (pluginMgr_ == nullptr)
         pluginMgr_ = &PluginManager::getInstance() ;
 
-    if (pluginMgr_ == nullptr)
-        msgHandler_->message(CTRLAPI_NOPLUGMGR, msgs_) << CoinMessageEol ;
+    if (pluginMgr_ == nullptr) {
+        CTRLAPI_MSG(CTRLAPI_NOPLUGMGR) << CoinMessageEol ;
+    }
 
     return (pluginMgr_) ;
 }
 
-/// Scan the knownLibMap and return the short name.
+/// Look up the short name in the libIDIndex.
 std::string ControlAPI_Imp::getShortName (PluginUniqueID libID)
 {
-  typedef LibMapType::const_iterator LMTI ;
-  for (LMTI iter = knownLibMap_.begin() ;
-       iter != knownLibMap_.end() ; iter++) {
-    const DynLibInfo &dynInfo = iter->second ;
-    if (dynInfo.uniqueID_ == libID) return (iter->first) ;
+  const std::string *shortName = findShortName(libID) ;
+  if (shortName == nullptr) return ("<unknown lib ID>") ;
+  return (*shortName) ;
+}
+
+/*
+  The empty string sorts first, so the lower bound is the library's entry
+  with the least short name, if there is one.
+*/
+const std::string *ControlAPI_Imp::findShortName (PluginUniqueID libID) const
+{
+  LibIDIndex::const_iterator iter =
+      libIDIndex_.lower_bound(std::make_pair(libID, std::string())) ;
+  if (iter == libIDIndex_.end() || iter->first != libID) return (nullptr) ;
+  return (&iter->second) ;
+}
+
+ControlAPI_Imp::DynLibInfo &
+ControlAPI_Imp::addKnownLib (const std::string &shortName,
+                             const std::string &fullPath,
+                             PluginUniqueID uniqueID)
+{
+  DynLibInfo &info = knownLibMap_[shortName] ;
+  libIDIndex_.erase(std::make_pair(info.uniqueID_, shortName)) ;
+  info.fullPath_ = fullPath ;
+  info.uniqueID_ = uniqueID ;
+  libIDIndex_.insert(std::make_pair(uniqueID, shortName)) ;
+  return (info) ;
+}
+
+void ControlAPI_Imp::eraseKnownLib (LibMapType::iterator knownIter)
+{
+  libIDIndex_.erase(std::make_pair(knownIter->second.uniqueID_,
+                                   knownIter->first)) ;
+  knownLibMap_.erase(knownIter) ;
+}
+
+bool ControlAPI_Imp::resolveShortName (const std::string *shortName,
+                                       PluginUniqueID &libID,
+                                       PluginHost *&host)
+{
+  libID = 0 ;
+  host = nullptr ;
+  if (shortName == 0 || shortName->empty()) return (false) ;
+  LibMapType::iterator knownIter = knownLibMap_.find((*shortName)) ;
+  if (knownIter == knownLibMap_.end()) {
+    CTRLAPI_MSG(CTRLAPI_LIBUNREG) << (*shortName) << CoinMessageEol ;
+  } else {
+    libID = knownIter->second.uniqueID_ ;
+    host = knownIter->second.host_ ;
   }
-  return ("<unknown lib ID>") ;
+  return (true) ;
 }
 
-/// Scan the knownLibMap and return the full path.
-std::string ControlAPI_Imp::getFullPath (PluginUniqueID libID)
+/*
+  Look up the identity information block for (api, libID), creating it if
+  this is the first object with that identity. The API name is the plugin
+  manager's interned copy.
+*/
+const ControlAPI_Imp::APIObjIdentInfo *
+ControlAPI_Imp::internIdentInfo (APIHandle api, PluginUniqueID libID,
+                                 PluginHost *host)
 {
-  typedef LibMapType::const_iterator LMTI ;
-  for (LMTI iter = knownLibMap_.begin() ;
-       iter != knownLibMap_.end() ; iter++) {
-    const DynLibInfo &dynInfo = iter->second ;
-    if (dynInfo.uniqueID_ == libID) return (dynInfo.fullPath_) ;
+  ScopedLock lock(identInfoMutex) ;
+  std::pair<APIHandle, PluginUniqueID> key(api, libID) ;
+  IdentInfoMap::iterator iter = identInfoMap_.find(key) ;
+  if (iter == identInfoMap_.end()) {
+    const std::string *apiName = &pluginMgr_->getAPIName(api) ;
+    iter = identInfoMap_.insert(std::make_pair(key,
+                        APIObjIdentInfo(api, apiName, libID, host))).first ;
   }
-  return ("<unknown lib ID>") ;
+  return (&iter->second) ;
+}
+
+/// Look up the short name in the libIDIndex, then the full path.
+std::string ControlAPI_Imp::getFullPath (PluginUniqueID libID)
+{
+  const std::string *shortName = findShortName(libID) ;
+  if (shortName == nullptr) return ("<unknown lib ID>") ;
+  return (knownLibMap_.find(*shortName)->second.fullPath_) ;
 }
 
 } // end namespace Osi2
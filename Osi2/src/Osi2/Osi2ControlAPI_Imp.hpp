@@ -14,7 +14,13 @@
 #ifndef Osi2ControlAPI_Imp_HPP
 # define Osi2ControlAPI_Imp_HPP
 
+#include <set>
+#include <map>
+
+#include "Osi2CancelToken.hpp"
 #include "Osi2PluginManager.hpp"
+#include "Osi2PluginHost.hpp"
+#include "Osi2SolvePool.hpp"
 
 #include "Osi2ControlAPI.hpp"
 #include "Osi2CtrlAPIMessages.hpp"
@@ -77,6 +83,28 @@ public:
     virtual int load(const std::string &shortName,
                      const std::string &libName, const std::string *dirName) ;
 
+    /*! \brief Load the specified plugin library in worker processes
+
+      Starts a PluginHost for library \p libName in directory \p dirName
+      (the plugin manager's default directory if \p dirName is null).
+      Objects requested with restriction to \p shortName are created by the
+      host; unrestricted requests never go to a hosted library. Only
+      ProbMgmtAPI objects can be hosted at present.
+
+      Objects from a hosted library must be destroyed before it is unloaded.
+      The host is shared by all copies of this control API object; unload it
+      through one of them only.
+
+      \returns
+        -5: plugin hosting is not supported on this platform
+        -1: the workers failed to start or to load the library
+         0: the workers are running
+         1: \p shortName is already in use
+    */
+    virtual int loadHosted(const std::string &shortName,
+                           const std::string &libName,
+                           const std::string *dirName, int numWorkers) ;
+
     /*! \brief Unload the specified library.
 
       Unloads the specified library. The return value will be 0 if all went
@@ -121,6 +149,10 @@ public:
     virtual int createObject(API *&obj, const std::string &apiName,
                              const std::string *shortName = 0) ;
 
+    /// The typed createObject and destroyObject of ControlAPI
+    using ControlAPI::createObject ;
+    using ControlAPI::destroyObject ;
+
     /*! \brief Destroy the specified object
 
       In general, invoking delete on the object will work just fine. This method
@@ -135,6 +167,230 @@ public:
     */
     virtual int destroyObject(API *&obj) ;
 
+    /*! \brief Create several objects of the specified API
+
+      As #createObject, for \p count objects at once. The library
+      restriction is resolved once, and the plugin manager creates the
+      objects in one batch (PluginManager::createObjects), so the plugin may
+      build them together. Without a restriction, a batch of more than one
+      goes to a library that declares its objects thread-safe, if there is
+      one. One message reports the batch. For a hosted
+      library the objects are created one at a time. On return \p objs holds
+      the objects created.
+
+      \returns:
+        -2: no plugin manager
+        -1: fewer than \p count objects were created
+         0: all the objects were created
+         1: all the objects were created but the plugin restriction was
+      ignored because it was not recognised
+    */
+    virtual int createObjects(std::vector<API *> &objs,
+                              const std::string &apiName, int count,
+                              const std::string *shortName = 0) ;
+
+    /*! \brief Destroy several objects
+
+      As #destroyObject, for each object in \p objs. Each object destroyed
+      is set to null; if all are destroyed, \p objs is emptied.
+
+      \returns:
+        -3: some object has no identity information; nothing was destroyed
+        -2: no plugin manager
+        -1: some object could not be destroyed
+         0: all the objects were destroyed
+    */
+    virtual int destroyObjects(std::vector<API *> &objs) ;
+
+    /*! \brief Find the library best suited to a request
+
+      See PluginManager::selectLib for the rules. Only libraries loaded in
+      this process are considered; hosted libraries declare nothing.
+
+      \returns:
+        -2: no plugin manager
+        -1: no library qualifies
+         0: \p shortName names the library chosen
+    */
+    virtual int selectLibrary(std::string &shortName,
+                              const std::string &apiName,
+                              const PluginCaps &need) ;
+
+    //@}
+
+    /*! \name Racing */
+    //@{
+
+    /*! \brief Race the plugin libraries in \p shortNames on one problem
+
+      See ControlAPI::race. An unknown short name, or one whose library
+      can't supply a ProbMgmt object, makes an entrant that doesn't run.
+      Objects are created, and abandoned entrants destroyed, on the calling
+      thread; only the reads and solves run in the entrants' threads.
+    */
+    virtual int race(API *&winner, std::vector<RaceEntry> &entries,
+                     const std::string &path,
+                     const std::vector<std::string> &shortNames,
+                     bool keepNames = false) ;
+
+    //@}
+
+    /*! \name Asynchronous Solves
+
+      The solve threads belong to this control API object; a copy starts
+      its own. Destroying the object cancels the solves still waiting and
+      waits for those running.
+    */
+    //@{
+
+    /// Set the number of solve threads; see ControlAPI::setAsyncThreads
+    virtual int setAsyncThreads(int numThreads) ;
+
+    /// Queue \p job for the solve threads; see ControlAPI::submitAsync
+    virtual SolveFuture submitAsync(AsyncJob *job, int node = -1) ;
+
+    //@}
+
+    /*! \name NUMA Placement
+
+      A copy of the object has placement as this one has it.
+    */
+    //@{
+
+    /// Turn NUMA placement on or off; see ControlAPI::setNumaPlacement
+    virtual int setNumaPlacement(bool on) ;
+
+    /// True if NUMA placement is on
+    virtual bool getNumaPlacement() const ;
+
+    /// Node for the \p ndx'th worker; see ControlAPI::getNumaNode
+    virtual int getNumaNode(int ndx) const ;
+
+    //@}
+
+    /*! \name Warm Start Cache
+
+      The cache belongs to this control API object; a copy gets an empty
+      cache with the same settings.
+    */
+    //@{
+
+    /// Enable the cache; see ControlAPI::enableWarmStartCache
+    virtual int enableWarmStartCache(const std::string *dir = 0) ;
+
+    /// Disable the cache; see ControlAPI::disableWarmStartCache
+    virtual void disableWarmStartCache() ;
+
+    /// The cache; see ControlAPI::getWarmStartCache
+    virtual WarmStartCache *getWarmStartCache() ;
+
+    //@}
+
+    /*! \name Model Cache
+
+      The cache belongs to this control API object; a copy gets an empty
+      cache of its own if the original has one.
+    */
+    //@{
+
+    /// Enable the cache; see ControlAPI::enableModelCache
+    virtual void enableModelCache() ;
+
+    /// Disable the cache; see ControlAPI::disableModelCache
+    virtual void disableModelCache() ;
+
+    /// The cache; see ControlAPI::getModelCache
+    virtual ModelCache *getModelCache() ;
+
+    //@}
+
+    /*! \name Presolve Cache
+
+      As for the model cache, the cache belongs to this control API object;
+      a copy gets an empty cache of its own if the original has one.
+    */
+    //@{
+
+    /// Enable the cache; see ControlAPI::enablePresolveCache
+    virtual void enablePresolveCache() ;
+
+    /// Disable the cache; see ControlAPI::disablePresolveCache
+    virtual void disablePresolveCache() ;
+
+    /// The cache; see ControlAPI::getPresolveCache
+    virtual PresolveCache *getPresolveCache() ;
+
+    //@}
+
+    /*! \name Adaptive Selection
+
+      The history belongs to this control API object; a copy gets a history
+      of its own, read again from the original's file if it has one.
+    */
+    //@{
+
+    /// Enable the history; see ControlAPI::enableSolveHistory
+    virtual int enableSolveHistory(const std::string *file = 0) ;
+
+    /// Disable the history; see ControlAPI::disableSolveHistory
+    virtual void disableSolveHistory() ;
+
+    /// The history; see ControlAPI::getSolveHistory
+    virtual SolveHistory *getSolveHistory() ;
+
+    /*! \brief Create an object to solve a model with \p features
+
+      The candidates are the libraries known to this control API that
+      supply \p apiName (PluginManager::findLibs), best declared first. If
+      the library chosen fails to make the object, any library may.
+
+      \returns as #createObject
+    */
+    virtual int createObject(API *&obj, const std::string &apiName,
+                             const SolveHistory::Features &features) ;
+
+    /*! \brief Add a solve by \p obj to the history
+
+      \returns:
+        -3: \p obj has no identity information
+        -1: the history is disabled, or \p obj's library is unknown
+         0: the solve was recorded
+    */
+    virtual int recordSolve(const API *obj,
+                            const SolveHistory::Features &features,
+                            double seconds, bool solved) ;
+
+    //@}
+
+    /*! \name Performance Statistics */
+    //@{
+
+    /*! \brief Get the current statistics
+
+      Short names are filled in by matching the library path against the
+      known libraries.
+    */
+    virtual int getPerfStats(std::vector<PerfStats::LibStats> &stats) ;
+
+    /// Write the current statistics to \p os as JSON
+    virtual int dumpPerfStats(std::ostream &os) ;
+
+    //@}
+
+    /*! \name Memory Accounting */
+    //@{
+
+    /// Get a library's memory account; see ControlAPI::getMemUsage
+    virtual int getMemUsage(const std::string &shortName,
+                            MemAccount::Usage &usage) ;
+
+    /// Set a library's memory limits; see ControlAPI::setMemLimits
+    virtual int setMemLimits(const std::string &shortName, int64_t softLimit,
+                             int64_t hardLimit) ;
+
+    /// Bytes held by an object; see ControlAPI::getObjMemUsage
+    virtual int64_t getObjMemUsage(const API *obj) ;
+
     //@}
 
     /*! \name Control API control methods
@@ -199,16 +455,41 @@ private:
       manage plugin libraries.
     */
     struct DynLibInfo {
+        /// Constructor
+        DynLibInfo () : uniqueID_(0), host_(0) { }
         /// Full path for the library
         std::string fullPath_ ;
-        /// Unique ID for the library
+        /*! \brief Unique ID for the library
+
+          For a hosted library, the address of the host.
+        */
         PluginUniqueID uniqueID_ ;
+        /// Host, if the library is loaded in worker processes
+        PluginHost *host_ ;
     } ;
     /// Map type for knownLibMap_
     typedef std::map<std::string, DynLibInfo> LibMapType ;
     /// Map to associate short names with full paths for plugin libraries
     LibMapType knownLibMap_ ;
 
+    /// Index type for libIDIndex_
+    typedef std::set<std::pair<PluginUniqueID, std::string> > LibIDIndex ;
+    /*! \brief Short names by unique ID
+
+      The same associations as #knownLibMap_, ordered by unique ID, so that
+      #findShortName and #getFullPath need not scan #knownLibMap_. A library
+      known by several short names has an entry for each; the first, in
+      order of short name, is the one reported.
+    */
+    LibIDIndex libIDIndex_ ;
+
+    /// Enter \p shortName in #knownLibMap_ and #libIDIndex_
+    DynLibInfo &addKnownLib(const std::string &shortName,
+                            const std::string &fullPath,
+                            PluginUniqueID uniqueID) ;
+    /// Remove an entry from #knownLibMap_ and #libIDIndex_
+    void eraseKnownLib(LibMapType::iterator knownIter) ;
+
     /// Default plugin library directory
     std::string dfltPluginDir_ ;
 
@@ -225,20 +506,155 @@ private:
 
       This class defines how API object identity information is structured for
       this implementation of the control API.
+
+      Identity information blocks are interned (see #internIdentInfo): there
+      is one block for each distinct (API, library) pair, shared by all
+      objects with that identity, and blocks are never freed. Creating an
+      object of an already seen identity allocates nothing.
     */
     struct APIObjIdentInfo {
       /// Initialising constructor
-      APIObjIdentInfo(std::string apiName, PluginUniqueID libID)
-        : apiName_(apiName),
-	  libID_(libID)
+      APIObjIdentInfo(APIHandle api, const std::string *apiName,
+                      PluginUniqueID libID, PluginHost *host)
+        : api_(api),
+          apiName_(apiName),
+	  libID_(libID),
+	  host_(host)
       {}
 
-      /// API name
-      const std::string apiName_ ;
+      /// API handle
+      const APIHandle api_ ;
+      /// API name; the plugin manager's interned copy
+      const std::string *apiName_ ;
       /// Library unique ID
       const PluginUniqueID libID_ ;
+      /// Host that holds the object, if it's a proxy
+      PluginHost *const host_ ;
     } ;
 
+    /// Map type for interned identity information
+    typedef std::map<std::pair<APIHandle, PluginUniqueID>, APIObjIdentInfo>
+            IdentInfoMap ;
+
+    /*! \brief Get the identity information block for (\p api, \p libID)
+
+      Shared by all ControlAPI_Imp objects, so that an object can be handed
+      to a copy of the control API that created it.
+    */
+    const APIObjIdentInfo *internIdentInfo(APIHandle api,
+                                           PluginUniqueID libID,
+                                           PluginHost *host = 0) ;
+
+    /// Interned identity information; see #internIdentInfo
+    static IdentInfoMap identInfoMap_ ;
+
+    /*! \brief Find the short name for the specified library
+
+      As #getShortName, but returns a pointer to the stored name, or null if
+      the library is unknown.
+    */
+    const std::string *findShortName(PluginUniqueID libID) const ;
+
+    /*! \brief Resolve a restriction to the library known as \p shortName
+
+      Sets \p libID and \p host for the library. Returns true if a
+      restriction was asked for (\p shortName is neither null nor empty),
+      whether or not the library is known; an unknown library rates a
+      warning and leaves \p libID and \p host null.
+    */
+    bool resolveShortName(const std::string *shortName, PluginUniqueID &libID,
+                          PluginHost *&host) ;
+
+    struct Race ;
+
+    /// One entrant in a race, and its thread
+    struct Racer {
+        /// The race
+        Race *race_ ;
+        /// Index in Race::racers_
+        int ndx_ ;
+        /// NUMA node to run on; -1 for anywhere
+        int node_ ;
+        /// The entrant's object; null once destroyed or handed to the winner
+        API *obj_ ;
+        /// True if the thread was started (and has yet to be joined)
+        bool started_ ;
+        ThreadHandle thread_ ;
+        /// Set by the thread once it has finished with the race
+        bool finished_ ;
+        /// Set by the thread once the problem is read
+        bool read_ ;
+        /// Outcome, if #finished_
+        RaceEntry::Outcome outcome_ ;
+        /// Solve status, if Solved
+        int status_ ;
+        /// Times, in PerfStats::now ticks
+        uint64_t start_ ;
+        uint64_t readEnd_ ;
+        uint64_t solveEnd_ ;
+    } ;
+
+    /*! \brief A race and its entrants
+
+      Everything below the mutex is guarded by it. A race outlives the call
+      to #race if some entrant is abandoned; it's kept in #abandoned_ until
+      all its threads are joined.
+    */
+    struct Race {
+        /// The problem
+        std::string path_ ;
+        bool keepNames_ ;
+        /// The entrants; not resized once the threads start
+        std::vector<Racer> racers_ ;
+        Mutex mutex_ ;
+        /// Signalled as each entrant finishes
+        Condition changed_ ;
+        /// Index of the winner; -1 until there is one
+        int winner_ ;
+        /// Entrants still running
+        int running_ ;
+        /// Attached to every entrant; cancelled when the race ends
+        CancelToken stop_ ;
+    } ;
+
+    /// Thread body of an entrant
+    static void *raceMain(void *arg) ;
+
+    /*! \brief Destroy the objects of finished abandoned entrants
+
+      If \p wait, wait for those still running; afterwards #abandoned_ is
+      empty.
+    */
+    void reapRaces(bool wait) ;
+
+    /// Give this object an empty cache with the settings of \p rhs's
+    void copyWarmStartCache(const ControlAPI_Imp &rhs) ;
+
+    /// Give this object a history of its own with the settings of \p rhs's
+    void copySolveHistory(const ControlAPI_Imp &rhs) ;
+
+    /// Races with entrants abandoned while still running
+    std::vector<Race *> abandoned_ ;
+
+    /// Threads for asynchronous solves; null until the first
+    SolvePool *solvePool_ ;
+    /// Number of solve threads to start; 0 for one per processor
+    int numAsyncThreads_ ;
+    /// True to place race entrants and solve threads on NUMA nodes
+    bool numaPlacement_ ;
+
+    /// The warm start cache; null unless enabled
+    WarmStartCache *warmStartCache_ ;
+
+    /// The model cache; null unless enabled
+    ModelCache *modelCache_ ;
+
+    /// The presolve cache; null unless enabled
+    PresolveCache *presolveCache_ ;
+
+    /// The solve history; null unless enabled
+    SolveHistory *solveHistory_ ;
+
 } ;
 
 } // namespace Osi2 ;
@@ -23,13 +23,6 @@ typedef struct {
     */
     int extID_ ;
 
-    /*! Message log level
-
-      Message will print if log level is less than or equal to the current
-      log level.
-    */
-    char logLvl_ ;
-
     /// Message text (may contain format codes).
     const char *text_ ;
 } OneCtrlAPIMessage ;
@@ -39,6 +32,8 @@ typedef struct {
     * Choose a unique ID. Add it to the enum in Osi2CtrlAPIMessages.hpp
     * Choose an external ID number from the appropriate range (information,
       warning, nonfatal or fatal error).
+    * Choose a log level and add the ID to the appropriate case in
+      ctrlAPIMsgLvl (Osi2CtrlAPIMessages.hpp).
     * Define the message in the appropriate place in the list by adding the
       initialisation expression for a OneCtrlAPIMessage structure.
 
@@ -48,46 +43,93 @@ static OneCtrlAPIMessage us_english[] = {
 
     // Information: 0 -- 2999
 
-    { CTRLAPI_INIT, 0000, 7, "Control API constructor (%s)." },
-    { CTRLAPI_LIBLDOK, 0001, 7, "Plugin library \"%s\" (\"%s\") loaded." },
-    { CTRLAPI_LIBCLOSEOK, 0002, 7, "Plugin library \"%s\" (\"%s\") unloaded." },
-    { CTRLAPI_CREATEOK, 0003, 7, "API \"%s\"%?, library \"%s\"%? created." },
-    { CTRLAPI_DESTROYOK, 0004, 7, "API \"%s\"%?, library \"%s\"%? destroyed." },
+    { CTRLAPI_INIT, 0000, "Control API constructor (%s)." },
+    { CTRLAPI_LIBLDOK, 0001, "Plugin library \"%s\" (\"%s\") loaded." },
+    { CTRLAPI_LIBCLOSEOK, 0002, "Plugin library \"%s\" (\"%s\") unloaded." },
+    { CTRLAPI_CREATEOK, 0003, "API \"%s\"%?, library \"%s\"%? created." },
+    { CTRLAPI_DESTROYOK, 0004, "API \"%s\"%?, library \"%s\"%? destroyed." },
+    {
+        CTRLAPI_LIBLDDEFER, 0005,
+        "Plugin library \"%s\" (\"%s\") registered from manifest; load deferred."
+    },
+    {
+        CTRLAPI_HOSTLDOK, 0006,
+        "Plugin library \"%s\" (\"%s\") loaded in %d worker processes."
+    },
+    {
+        CTRLAPI_CREATEBATCHOK, 0007,
+        "Created %d of %d objects of API \"%s\"%?, library \"%s\"%?."
+    },
+    { CTRLAPI_DESTROYBATCHOK, 0010, "Destroyed %d of %d objects." },
+    {
+        CTRLAPI_RACEWON, 0011,
+        "Race on \"%s\": library \"%s\" won in %g s, against %d others."
+    },
+    { CTRLAPI_ASYNCSTART, 0012, "Started %d threads for asynchronous solves." },
+    { CTRLAPI_WSCACHEON, 0013, "Warm start cache enabled (%s)." },
+    { CTRLAPI_HISTORYON, 0014, "Solve history enabled (%s)." },
+    {
+        CTRLAPI_HISTORYPICK, 0015,
+        "Solve history chose library \"%s\" for API \"%s\" (%s)."
+    },
+    { CTRLAPI_NUMAON, 0016, "NUMA placement on, over %d nodes." },
+    { CTRLAPI_MODELCACHEON, 0017, "Model cache enabled." },
+    { CTRLAPI_PRESOLVECACHEON, 0020, "Presolve cache enabled." },
 
     // Warning: 3000 -- 5999
 
-    { CTRLAPI_LIBUNREG, 3000, 4, "Library \"%s\" is not registered." },
+    { CTRLAPI_LIBUNREG, 3000, "Library \"%s\" is not registered." },
     {
-        CTRLAPI_UNREG, 3001, 4,
+        CTRLAPI_UNREG, 3001,
         "%?PluginManager says \"%s\" already loaded but %?\"%s\" is not registered."
     },
+    {
+        CTRLAPI_RACENOWIN, 3002,
+        "Race on \"%s\": none of %d libraries found an optimal solution."
+    },
 
     // Nonfatal Error: 6000 -- 8999
 
     {
-        CTRLAPI_LIBLDFAIL, 6000, 2,
+        CTRLAPI_LIBLDFAIL, 6000,
         "Load failed for plugin library \"%s\" (\"%s\")."
     },
     {
-        CTRLAPI_LIBCLOSEFAIL, 6001, 2,
+        CTRLAPI_LIBCLOSEFAIL, 6001,
         "Load failed for plugin library \"%s\" (\"%s\")."
     },
     {
-        CTRLAPI_CREATEFAIL, 6002, 2,
+        CTRLAPI_CREATEFAIL, 6002,
         "Create failed for API \"%s\"%?, library \"%s\"%?."
     },
     {
-        CTRLAPI_DESTROYFAIL, 6003, 2,
+        CTRLAPI_DESTROYFAIL, 6003,
         "Destroy failed for API \"%s\"%?, library \"%s\"%?."
     },
-    { CTRLAPI_NOAPIIDENT, 6004, 2,
+    { CTRLAPI_NOAPIIDENT, 6004,
         "API object has no identity information!" },
+    {
+        CTRLAPI_HOSTLDFAIL, 6005,
+        "Failed to start workers for plugin library \"%s\" (\"%s\"); %s."
+    },
+    {
+        CTRLAPI_ASYNCFAIL, 6006,
+        "Cannot start threads for asynchronous solves."
+    },
+    {
+        CTRLAPI_WSCACHEBADDIR, 6007,
+        "Warm start cache directory \"%s\" is not a directory."
+    },
+    {
+        CTRLAPI_HISTORYBADFILE, 6008,
+        "Solve history file \"%s\" cannot be used."
+    },
 
     // Fatal Error: 9000 -- 9999
 
-    { CTRLAPI_NOPLUGMGR, 9000, 1, "Cannot find plugin manager!" },
+    { CTRLAPI_NOPLUGMGR, 9000, "Cannot find plugin manager!" },
 
-    { CTRLAPI_DUMMY_END, 9999, 0, "" }
+    { CTRLAPI_DUMMY_END, 9999, "" }
 } ;
 
 /*
@@ -109,7 +151,7 @@ CtrlAPIMessages::CtrlAPIMessages (Language language)
 
     OneCtrlAPIMessage *msg = &us_english[0] ;
     while (msg->intID_ != CTRLAPI_DUMMY_END) {
-        CoinOneMessage tmpMsg(msg->extID_, msg->logLvl_, msg->text_) ;
+        CoinOneMessage tmpMsg(msg->extID_, ctrlAPIMsgLvl(msg->intID_), msg->text_) ;
         addMessage(msg->intID_, tmpMsg) ;
         msg++ ;
     }
@@ -22,7 +22,10 @@ namespace Osi2 {
 enum CtrlAPIMsg {
     CTRLAPI_INIT,
     CTRLAPI_LIBLDOK,
+    CTRLAPI_LIBLDDEFER,
+    CTRLAPI_HOSTLDOK,
     CTRLAPI_LIBLDFAIL,
+    CTRLAPI_HOSTLDFAIL,
     CTRLAPI_LIBCLOSEOK,
     CTRLAPI_LIBCLOSEFAIL,
     CTRLAPI_LIBUNREG,
@@ -31,11 +34,74 @@ enum CtrlAPIMsg {
     CTRLAPI_CREATEOK,
     CTRLAPI_DESTROYFAIL,
     CTRLAPI_DESTROYOK,
+    CTRLAPI_CREATEBATCHOK,
+    CTRLAPI_DESTROYBATCHOK,
+    CTRLAPI_RACEWON,
+    CTRLAPI_RACENOWIN,
+    CTRLAPI_ASYNCSTART,
+    CTRLAPI_ASYNCFAIL,
+    CTRLAPI_WSCACHEON,
+    CTRLAPI_WSCACHEBADDIR,
+    CTRLAPI_HISTORYON,
+    CTRLAPI_HISTORYPICK,
+    CTRLAPI_HISTORYBADFILE,
+    CTRLAPI_NUMAON,
+    CTRLAPI_MODELCACHEON,
+    CTRLAPI_PRESOLVECACHEON,
     CTRLAPI_NOAPIIDENT,
     CTRLAPI_NOPLUGMGR,
     CTRLAPI_DUMMY_END
 };
 
+/*! \brief Log level of a control API message
+
+  A message prints if its log level is less than or equal to the current log
+  level. Kept here, rather than in the message table, so that the level is
+  visible at compile time; see Osi2MsgGate.hpp.
+*/
+inline int ctrlAPIMsgLvl (CtrlAPIMsg msg)
+{
+    switch (msg) {
+    case CTRLAPI_INIT:
+    case CTRLAPI_LIBLDOK:
+    case CTRLAPI_LIBCLOSEOK:
+    case CTRLAPI_CREATEOK:
+    case CTRLAPI_DESTROYOK:
+    case CTRLAPI_LIBLDDEFER:
+    case CTRLAPI_HOSTLDOK:
+    case CTRLAPI_CREATEBATCHOK:
+    case CTRLAPI_DESTROYBATCHOK:
+    case CTRLAPI_HISTORYPICK:
+        return (7) ;
+    case CTRLAPI_RACEWON:
+    case CTRLAPI_ASYNCSTART:
+    case CTRLAPI_WSCACHEON:
+    case CTRLAPI_HISTORYON:
+    case CTRLAPI_NUMAON:
+    case CTRLAPI_MODELCACHEON:
+    case CTRLAPI_PRESOLVECACHEON:
+        return (5) ;
+    case CTRLAPI_LIBUNREG:
+    case CTRLAPI_RACENOWIN:
+    case CTRLAPI_UNREG:
+        return (4) ;
+    case CTRLAPI_LIBLDFAIL:
+    case CTRLAPI_HOSTLDFAIL:
+    case CTRLAPI_LIBCLOSEFAIL:
+    case CTRLAPI_CREATEFAIL:
+    case CTRLAPI_DESTROYFAIL:
+    case CTRLAPI_NOAPIIDENT:
+    case CTRLAPI_ASYNCFAIL:
+    case CTRLAPI_WSCACHEBADDIR:
+    case CTRLAPI_HISTORYBADFILE:
+        return (2) ;
+    case CTRLAPI_NOPLUGMGR:
+        return (1) ;
+    default:
+        return (0) ;
+    }
+}
+
 /*! \brief Osi2::ControlAPI messages
 
   This class holds the array of messages once they are loaded and provides the
@@ -0,0 +1,387 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2CutPool.cpp
+    \brief Method definitions for Osi2::CutPool
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "CoinFinite.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2Kernels.hpp"
+#include "Osi2ModelHash.hpp"
+#include "Osi2CutPool.hpp"
+
+namespace Osi2 {
+
+namespace {
+
+/// Bounds at or beyond this are infinite
+const double cutInfinity = 1.0e30 ;
+
+/// A coefficient and its column, for sorting
+typedef std::pair<int, double> Coeff ;
+
+/// True if \p lb bounds nothing
+inline bool noLower (double lb)
+{
+    return (lb <= -cutInfinity) ;
+}
+
+/// True if \p ub bounds nothing
+inline bool noUpper (double ub)
+{
+    return (ub >= cutInfinity) ;
+}
+
+/// \p a and \p b within \p tol, relative to the larger
+inline bool close (double a, double b, double tol)
+{
+    return (std::fabs(a-b) <=
+            tol*(1.0+std::max(std::fabs(a), std::fabs(b)))) ;
+}
+
+}   // end unnamed file-local namespace
+
+CutPool::CutPool ()
+    : maxAge_(3),
+      tol_(1.0e-9),
+      numPending_(0),
+      inconsistent_(0),
+      infeasible_(0),
+      ineffective_(0),
+      applied_(0),
+      agedOut_(0)
+{ }
+
+CutPool::~CutPool ()
+{ }
+
+void CutPool::setMaxAge (int maxAge)
+{
+    maxAge_ = maxAge ;
+}
+
+int CutPool::getMaxAge () const
+{
+    return (maxAge_) ;
+}
+
+void CutPool::setTolerance (double tol)
+{
+    tol_ = tol ;
+}
+
+double CutPool::getTolerance () const
+{
+    return (tol_) ;
+}
+
+/*
+  Normalise the cut, then look for it among those with the same indices.
+  Scaling by a negative factor turns the bounds around.
+*/
+CutPool::AddResult CutPool::addRow (int len, const int *ind, const double *el,
+                                    double lb, double ub)
+{
+    std::vector<Coeff> coeffs ;
+    coeffs.reserve(len) ;
+    for (int k = 0 ; k < len ; k++) {
+        if (ind[k] < 0) {
+            inconsistent_++ ;
+            return (Inconsistent) ;
+        }
+        if (el[k] == 0.0) continue ;
+        coeffs.push_back(Coeff(ind[k], el[k])) ;
+    }
+    std::sort(coeffs.begin(), coeffs.end()) ;
+    for (size_t k = 1 ; k < coeffs.size() ; k++) {
+        if (coeffs[k].first == coeffs[k-1].first) {
+            inconsistent_++ ;
+            return (Inconsistent) ;
+        }
+    }
+    if (noLower(lb)) lb = -COIN_DBL_MAX ;
+    if (noUpper(ub)) ub = COIN_DBL_MAX ;
+    if (lb > ub+tol_*(1.0+std::fabs(ub))) {
+        infeasible_++ ;
+        return (Infeasible) ;
+    }
+    /*
+      An empty row is 0; it either always holds or never does.
+    */
+    if (coeffs.empty()) {
+        if (lb > tol_ || ub < -tol_) {
+            infeasible_++ ;
+            return (Infeasible) ;
+        }
+        ineffective_++ ;
+        return (Dominated) ;
+    }
+    if (noLower(lb) && noUpper(ub)) {
+        ineffective_++ ;
+        return (Dominated) ;
+    }
+    Cut cut ;
+    const int numCoeffs = static_cast<int>(coeffs.size()) ;
+    cut.ind_.resize(numCoeffs) ;
+    cut.el_.resize(numCoeffs) ;
+    for (int k = 0 ; k < numCoeffs ; k++) {
+        cut.ind_[k] = coeffs[k].first ;
+        cut.el_[k] = coeffs[k].second ;
+    }
+    const double scale = ((cut.el_[0] < 0.0) ? -1.0 : 1.0) /
+                         kernelMaxAbs(numCoeffs, &cut.el_[0]) ;
+    kernelScale(numCoeffs, &cut.el_[0], scale) ;
+    if (scale > 0.0) {
+        cut.lb_ = noLower(lb) ? -COIN_DBL_MAX : lb*scale ;
+        cut.ub_ = noUpper(ub) ? COIN_DBL_MAX : ub*scale ;
+    } else {
+        cut.lb_ = noUpper(ub) ? -COIN_DBL_MAX : ub*scale ;
+        cut.ub_ = noLower(lb) ? COIN_DBL_MAX : lb*scale ;
+    }
+    ModelHash hash ;
+    hash.add(&cut.ind_[0], cut.ind_.size()) ;
+    cut.hash_ = hash.value() ;
+    cut.row_ = -1 ;
+    cut.age_ = 0 ;
+    cut.tightened_ = false ;
+    /*
+      Same indices and the same coefficients is the same row. Compare the
+      bounds.
+    */
+    std::pair<CutIndex::iterator, CutIndex::iterator> range =
+        index_.equal_range(cut.hash_) ;
+    for (CutIndex::iterator it = range.first ; it != range.second ; ++it) {
+        Cut &old = *it->second ;
+        if (old.ind_ != cut.ind_) continue ;
+        size_t k = 0 ;
+        while (k < cut.el_.size() && close(old.el_[k], cut.el_[k], tol_))
+            k++ ;
+        if (k < cut.el_.size()) continue ;
+        const bool looseLower =
+            (cut.lb_ <= old.lb_+tol_*(1.0+std::fabs(old.lb_))) ;
+        const bool looseUpper =
+            (cut.ub_ >= old.ub_-tol_*(1.0+std::fabs(old.ub_))) ;
+        if (looseLower && looseUpper) {
+            ineffective_++ ;
+            return ((close(cut.lb_, old.lb_, tol_) &&
+                     close(cut.ub_, old.ub_, tol_)) ? Duplicate : Dominated) ;
+        }
+        const double newLower = std::max(old.lb_, cut.lb_) ;
+        const double newUpper = std::min(old.ub_, cut.ub_) ;
+        if (newLower > newUpper+tol_*(1.0+std::fabs(newUpper))) {
+            infeasible_++ ;
+            return (Infeasible) ;
+        }
+        old.lb_ = newLower ;
+        old.ub_ = newUpper ;
+        old.age_ = 0 ;
+        if (old.row_ >= 0) old.tightened_ = true ;
+        return (Tightened) ;
+    }
+    CutList::iterator added = cuts_.insert(cuts_.end(), cut) ;
+    index_.insert(CutIndex::value_type(cut.hash_, added)) ;
+    numPending_++ ;
+    return (Added) ;
+}
+
+void CutPool::takeTightened (std::vector<int> &rows,
+                             std::vector<double> &lower,
+                             std::vector<double> &upper)
+{
+    rows.clear() ;
+    lower.clear() ;
+    upper.clear() ;
+    for (CutList::iterator cut = cuts_.begin() ; cut != cuts_.end() ; ++cut) {
+        if (!cut->tightened_) continue ;
+        rows.push_back(cut->row_) ;
+        lower.push_back(cut->lb_) ;
+        upper.push_back(cut->ub_) ;
+        cut->tightened_ = false ;
+    }
+}
+
+/*
+  Cuts are applied in the order they arrived.
+*/
+int CutPool::takePending (int firstRow, std::vector<int> &starts,
+                          std::vector<int> &cols, std::vector<double> &els,
+                          std::vector<double> &lower,
+                          std::vector<double> &upper)
+{
+    starts.clear() ;
+    cols.clear() ;
+    els.clear() ;
+    lower.clear() ;
+    upper.clear() ;
+    if (numPending_ == 0) return (0) ;
+    starts.reserve(numPending_+1) ;
+    lower.reserve(numPending_) ;
+    upper.reserve(numPending_) ;
+    int row = firstRow ;
+    for (CutList::iterator cut = cuts_.begin() ; cut != cuts_.end() ; ++cut) {
+        if (cut->row_ >= 0) continue ;
+        starts.push_back(static_cast<int>(cols.size())) ;
+        cols.insert(cols.end(), cut->ind_.begin(), cut->ind_.end()) ;
+        els.insert(els.end(), cut->el_.begin(), cut->el_.end()) ;
+        lower.push_back(cut->lb_) ;
+        upper.push_back(cut->ub_) ;
+        cut->row_ = row++ ;
+    }
+    starts.push_back(static_cast<int>(cols.size())) ;
+    const int numAdded = numPending_ ;
+    numPending_ = 0 ;
+    applied_ += numAdded ;
+    return (numAdded) ;
+}
+
+/*
+  The activity of each pending cut at x is one sparse dot product.
+*/
+int CutPool::dropSatisfied (const double *colSolution)
+{
+    if (colSolution == 0 || numPending_ == 0) return (0) ;
+    int dropped = 0 ;
+    CutList::iterator cut = cuts_.begin() ;
+    while (cut != cuts_.end()) {
+        CutList::iterator next = cut ;
+        ++next ;
+        if (cut->row_ < 0) {
+            const double act =
+                kernelSparseDot(static_cast<int>(cut->ind_.size()),
+                                &cut->ind_[0], &cut->el_[0], colSolution) ;
+            const bool violated =
+                (!noLower(cut->lb_) &&
+                 act < cut->lb_-tol_*(1.0+std::fabs(cut->lb_))) ||
+                (!noUpper(cut->ub_) &&
+                 act > cut->ub_+tol_*(1.0+std::fabs(cut->ub_))) ;
+            if (!violated) {
+                forget(cut) ;
+                dropped++ ;
+            }
+        }
+        cut = next ;
+    }
+    ineffective_ += dropped ;
+    return (dropped) ;
+}
+
+/*
+  A cut whose row the solver no longer has has been deleted by someone
+  else; it's forgotten without adding it to the victims.
+*/
+void CutPool::takeOld (const double *activity, int numRows,
+                       std::vector<int> &victims)
+{
+    victims.clear() ;
+    if (activity == 0) return ;
+    CutList::iterator cut = cuts_.begin() ;
+    while (cut != cuts_.end()) {
+        CutList::iterator next = cut ;
+        ++next ;
+        if (cut->row_ >= numRows) {
+            forget(cut) ;
+        } else if (cut->row_ >= 0) {
+            const double act = activity[cut->row_] ;
+            const bool slack =
+                (noLower(cut->lb_) ||
+                 act > cut->lb_+tol_*(1.0+std::fabs(cut->lb_))) &&
+                (noUpper(cut->ub_) ||
+                 act < cut->ub_-tol_*(1.0+std::fabs(cut->ub_))) ;
+            cut->age_ = slack ? cut->age_+1 : 0 ;
+            if (cut->age_ > maxAge_) {
+                victims.push_back(cut->row_) ;
+                forget(cut) ;
+            }
+        }
+        cut = next ;
+    }
+    if (victims.empty()) return ;
+    std::sort(victims.begin(), victims.end()) ;
+    agedOut_ += static_cast<int>(victims.size()) ;
+    /*
+      Rows above a deleted row move down one.
+    */
+    for (cut = cuts_.begin() ; cut != cuts_.end() ; ++cut) {
+        if (cut->row_ < 0) continue ;
+        const int below = static_cast<int>(
+            std::lower_bound(victims.begin(), victims.end(), cut->row_) -
+            victims.begin()) ;
+        cut->row_ -= below ;
+    }
+}
+
+void CutPool::forget (CutList::iterator cut)
+{
+    std::pair<CutIndex::iterator, CutIndex::iterator> range =
+        index_.equal_range(cut->hash_) ;
+    for (CutIndex::iterator it = range.first ; it != range.second ; ++it) {
+        if (it->second == cut) {
+            index_.erase(it) ;
+            break ;
+        }
+    }
+    if (cut->row_ < 0) numPending_-- ;
+    cuts_.erase(cut) ;
+}
+
+int CutPool::getNumPending () const
+{
+    return (numPending_) ;
+}
+
+int CutPool::getNumInSolver () const
+{
+    return (static_cast<int>(cuts_.size())-numPending_) ;
+}
+
+void CutPool::clear ()
+{
+    index_.clear() ;
+    cuts_.clear() ;
+    numPending_ = 0 ;
+}
+
+int CutPool::getNumInconsistent () const
+{
+    return (inconsistent_) ;
+}
+
+int CutPool::getNumInfeasible () const
+{
+    return (infeasible_) ;
+}
+
+int CutPool::getNumIneffective () const
+{
+    return (ineffective_) ;
+}
+
+int CutPool::getNumApplied () const
+{
+    return (applied_) ;
+}
+
+int CutPool::getNumAgedOut () const
+{
+    return (agedOut_) ;
+}
+
+void CutPool::resetCounts ()
+{
+    inconsistent_ = 0 ;
+    infeasible_ = 0 ;
+    ineffective_ = 0 ;
+    applied_ = 0 ;
+    agedOut_ = 0 ;
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,292 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2CutPool.hpp
+    \brief A pool of row cuts that weeds out duplicates and ages out slack
+	   cuts.
+
+  See Osi2::CutPool.
+*/
+
+#ifndef Osi2CutPool_HPP
+#define Osi2CutPool_HPP
+
+#include <list>
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+namespace Osi2 {
+
+/*! \brief A pool of row cuts in front of a solver
+
+  Separators put their cuts in the pool (#addRow, #addCut, #addCuts) as
+  they find them; #apply then hands everything new to the solver in one
+  \c addRows call. Each cut is normalised as it comes in (indices sorted,
+  coefficients scaled so the largest is 1 and the first positive) and
+  hashed on its indices, so a cut that's a multiple of one already in the
+  pool, applied or not, is recognised. If its bounds are no tighter it's
+  dropped as ineffective; if they are, the cut in the pool takes the
+  tighter bounds, and #apply passes them on.
+
+  After each solve, #age looks at the row activity of the cuts the pool
+  has applied. A cut that has been slack for more than #getMaxAge solves
+  in a row is deleted from the solver, with those of its kind, in one
+  \c deleteRows call. The pool keeps track of the solver row for each cut
+  it has applied, and assumes it's the only one adding or deleting rows
+  after them.
+
+  The templated methods work on any API with the Osi1API methods named;
+  the cut methods on anything shaped like OsiRowCut and OsiCuts. A pool is
+  not thread-safe, and serves one solver object.
+*/
+class CutPool {
+
+public:
+
+    /// What #addRow did with a cut
+    enum AddResult {
+        /// A new cut, to be applied
+        Added = 0,
+        /// A cut already in the pool took this cut's tighter bounds
+        Tightened,
+        /// The same as a cut in the pool; dropped
+        Duplicate,
+        /// Looser than a cut in the pool; dropped
+        Dominated,
+        /// Can't be satisfied, alone or with a cut in the pool; dropped
+        Infeasible,
+        /// An index repeated or negative; dropped
+        Inconsistent
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; an empty pool
+    CutPool() ;
+    /// Destructor
+    ~CutPool() ;
+    //@}
+
+    /// \name Parameters
+    //@{
+    /// Set the number of solves a cut may stay slack (default 3)
+    void setMaxAge(int maxAge) ;
+    /// The number of solves a cut may stay slack
+    int getMaxAge() const ;
+    /*! \brief Set the tolerance (default 1e-9)
+
+      Normalised coefficients equal within the tolerance are taken as equal;
+      a cut is slack if its activity is inside its bounds by more than the
+      tolerance (relative to the bound).
+    */
+    void setTolerance(double tol) ;
+    /// The tolerance
+    double getTolerance() const ;
+    //@}
+
+    /// \name Adding cuts
+    //@{
+    /*! \brief Add the cut <tt>lb <= sum el[k]*x[ind[k]] <= ub</tt>
+
+      Bounds of magnitude 1e30 or more are infinite.
+    */
+    AddResult addRow(int len, const int *ind, const double *el,
+                     double lb, double ub) ;
+
+    /// Add a cut like OsiRowCut (\c row, \c lb, \c ub)
+    template <class C>
+    inline AddResult addCut (const C &cut) {
+        return (addRow(cut.row().getNumElements(), cut.row().getIndices(),
+                       cut.row().getElements(), cut.lb(), cut.ub())) ;
+    }
+
+    /*! \brief Add the row cuts in a collection like OsiCuts
+
+      \returns the number of cuts added to the pool (AddResult Added)
+    */
+    template <class Cs>
+    inline int addCuts (const Cs &cuts) {
+        int added = 0 ;
+        for (int i = 0 ; i < cuts.sizeRowCuts() ; i++) {
+            if (addCut(cuts.rowCut(i)) == Added) added++ ;
+        }
+        return (added) ;
+    }
+    //@}
+
+    /// \name Working with the solver
+    //@{
+    /*! \brief Give the solver what's new
+
+      New cuts go to the solver in one \c addRows call, after \c
+      setRowBounds for applied cuts whose bounds were tightened.
+
+      \returns the number of rows added
+    */
+    template <class T>
+    int apply (T *obj) {
+        std::vector<int> rows ;
+        std::vector<double> lower, upper ;
+        takeTightened(rows, lower, upper) ;
+        for (size_t k = 0 ; k < rows.size() ; k++)
+            obj->setRowBounds(rows[k], lower[k], upper[k]) ;
+        std::vector<int> starts, cols ;
+        std::vector<double> els ;
+        const int numAdded =
+            takePending(obj->getNumRows(), starts, cols, els, lower, upper) ;
+        if (numAdded > 0)
+            obj->addRows(numAdded, &starts[0], &cols[0], &els[0],
+                         &lower[0], &upper[0]) ;
+        return (numAdded) ;
+    }
+
+    /*! \brief Age the applied cuts, and delete the old ones
+
+      Call after a solve. Cuts slack in the solution get older, cuts tight
+      in it start again from 0, and cuts older than #getMaxAge are deleted
+      from the solver in one \c deleteRows call and forgotten.
+
+      \returns the number of rows deleted
+    */
+    template <class T>
+    int age (T *obj) {
+        std::vector<int> victims ;
+        takeOld(obj->getRowActivity(), obj->getNumRows(), victims) ;
+        if (!victims.empty())
+            obj->deleteRows(static_cast<int>(victims.size()), &victims[0]) ;
+        return (static_cast<int>(victims.size())) ;
+    }
+
+    /*! \brief Drop the pending cuts \p colSolution satisfies
+
+      A cut that doesn't cut off the current solution does nothing for the
+      next solve. Call with the solver's \c getColSolution() before #apply
+      so that only violated cuts (violated by more than the tolerance) go
+      to the solver. Cuts already applied are left alone; the cuts dropped
+      count as ineffective.
+
+      \returns the number of cuts dropped
+    */
+    int dropSatisfied(const double *colSolution) ;
+
+    /// Cuts waiting for #apply
+    int getNumPending() const ;
+    /// Cuts in the solver
+    int getNumInSolver() const ;
+    /// Forget every cut; the solver is left alone
+    void clear() ;
+    //@}
+
+    /*! \name Counts
+        \brief Counted since construction or the last #resetCounts
+    */
+    //@{
+    /// Cuts dropped as Inconsistent
+    int getNumInconsistent() const ;
+    /// Cuts dropped as Infeasible
+    int getNumInfeasible() const ;
+    /// Cuts dropped as Duplicate or Dominated
+    int getNumIneffective() const ;
+    /// Rows added to the solver by #apply
+    int getNumApplied() const ;
+    /// Rows deleted from the solver by #age
+    int getNumAgedOut() const ;
+    /// Set all counts to 0
+    void resetCounts() ;
+    /*! \brief The counts as an applyCuts return code
+
+      For Osi1API::ApplyCutsReturnCode or OsiSolverInterface's; the
+      count of cuts inconsistent with the integer model is always 0.
+    */
+    template <class R>
+    inline R returnCode () const {
+        return (R(inconsistent_, 0, infeasible_, ineffective_, applied_)) ;
+    }
+    //@}
+
+private:
+
+    /// A cut, normalised
+    struct Cut {
+        /// Column indices, ascending
+        std::vector<int> ind_ ;
+        /// Coefficients; the largest magnitude is 1, the first positive
+        std::vector<double> el_ ;
+        /// Lower bound
+        double lb_ ;
+        /// Upper bound
+        double ub_ ;
+        /// Hash of #ind_
+        uint64_t hash_ ;
+        /// Row in the solver; -1 until applied
+        int row_ ;
+        /// Solves in a row the cut has been slack
+        int age_ ;
+        /// Applied, and the bounds have been tightened since
+        bool tightened_ ;
+    } ;
+
+    /// The cuts
+    typedef std::list<Cut> CutList ;
+    /// Cuts by the hash of their indices
+    typedef std::multimap<uint64_t, CutList::iterator> CutIndex ;
+
+    /// Collect applied cuts with new bounds, and mark them done
+    void takeTightened(std::vector<int> &rows, std::vector<double> &lower,
+                       std::vector<double> &upper) ;
+
+    /*! \brief Collect the pending cuts as rows, and mark them applied
+
+      The cuts become solver rows \p firstRow, \p firstRow+1, ...
+      \returns the number of rows
+    */
+    int takePending(int firstRow, std::vector<int> &starts,
+                    std::vector<int> &cols, std::vector<double> &els,
+                    std::vector<double> &lower, std::vector<double> &upper) ;
+
+    /*! \brief Age the applied cuts, given the solver's row activity
+
+      Cuts to be deleted are forgotten and their rows put in \p victims,
+      ascending; the rows of the rest are renumbered to suit.
+    */
+    void takeOld(const double *activity, int numRows,
+                 std::vector<int> &victims) ;
+
+    /// Forget \p cut
+    void forget(CutList::iterator cut) ;
+
+    /// Slack cut lifetime
+    int maxAge_ ;
+    /// Tolerance
+    double tol_ ;
+
+    /// The cuts, oldest first
+    CutList cuts_ ;
+    /// The cuts by hash
+    CutIndex index_ ;
+    /// Cuts waiting to be applied
+    int numPending_ ;
+
+    /// \name Counts
+    //@{
+    int inconsistent_ ;
+    int infeasible_ ;
+    int ineffective_ ;
+    int applied_ ;
+    int agedOut_ ;
+    //@}
+
+    /// Copy constructor (not implemented)
+    CutPool(const CutPool &rhs) ;
+    /// Assignment (not implemented)
+    CutPool &operator=(const CutPool &rhs) ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,122 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2DaemonClient.cpp
+    \brief Method definitions for Osi2::DaemonClient
+*/
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2DaemonClient.hpp"
+#include "Osi2SolverDaemon.hpp"
+#include "Osi2RemoteWire.hpp"
+
+namespace {
+
+/*
+  The daemon has its own working directory, so a relative path must be
+  made absolute here.
+*/
+std::string absolutePath (const std::string &path)
+{
+#   ifndef WIN32
+    if (!path.empty() && path[0] != '/') {
+        std::vector<char> cwd(4096) ;
+        if (::getcwd(&cwd[0], cwd.size()) != nullptr)
+            return (std::string(&cwd[0]) + "/" + path) ;
+    }
+#   endif
+    return (path) ;
+}
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+DaemonClient::DaemonClient ()
+    : sock_(-1)
+{ }
+
+DaemonClient::~DaemonClient ()
+{
+    disconnect() ;
+}
+
+int DaemonClient::connect (const std::string &socketPath,
+                           std::string &errStr)
+{
+    disconnect() ;
+    sock_ = wireConnectLocal(socketPath, errStr) ;
+    return ((sock_ < 0) ? -1 : 0) ;
+}
+
+void DaemonClient::disconnect ()
+{
+    if (sock_ < 0) return ;
+    wireClose(sock_) ;
+    sock_ = -1 ;
+}
+
+int DaemonClient::solve (const std::string &shortName,
+                         const std::string &libName, const std::string &path,
+                         bool keepNames, int &solveStatus, std::string &errStr,
+                         bool *resident)
+{
+    WireWriter(request_).putInt(DaemonSolve).putStr(shortName)
+        .putStr(libName).putStr(absolutePath(path)).putInt(keepNames) ;
+    if (call() < 0) {
+        errStr = "Lost the connection to the solver daemon" ;
+        return (-1) ;
+    }
+    WireReader in(reply_) ;
+    const int64_t status = in.getInt() ;
+    const int64_t solved = in.getInt() ;
+    const bool hit = (in.getInt() != 0) ;
+    const std::string message = in.getStr() ;
+    if (!in.ok()) {
+        errStr = "Malformed reply from the solver daemon" ;
+        return (-1) ;
+    }
+    if (status != 0) {
+        errStr = message ;
+        return (-1) ;
+    }
+    solveStatus = static_cast<int>(solved) ;
+    if (resident != nullptr) *resident = hit ;
+    return (0) ;
+}
+
+int DaemonClient::getStats (int &numJobs, int &numHits, int &numResident)
+{
+    WireWriter(request_).putInt(DaemonStats) ;
+    if (call() < 0) return (-1) ;
+    WireReader in(reply_) ;
+    const int64_t status = in.getInt() ;
+    const int64_t jobs = in.getInt() ;
+    const int64_t hits = in.getInt() ;
+    const int64_t models = in.getInt() ;
+    if (!in.ok() || status != 0) return (-1) ;
+    numJobs = static_cast<int>(jobs) ;
+    numHits = static_cast<int>(hits) ;
+    numResident = static_cast<int>(models) ;
+    return (0) ;
+}
+
+int DaemonClient::call ()
+{
+    if (sock_ < 0) return (-1) ;
+    if (wireSend(sock_, request_) < 0 || wireRecv(sock_, reply_) < 0) {
+        disconnect() ;
+        return (-1) ;
+    }
+    return (0) ;
+}
+
+}  // end namespace Osi2
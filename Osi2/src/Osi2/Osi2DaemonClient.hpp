@@ -0,0 +1,107 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2DaemonClient.hpp
+    \brief Send solver jobs to a solver daemon.
+
+  See Osi2::DaemonClient.
+*/
+
+#ifndef Osi2DaemonClient_HPP
+#define Osi2DaemonClient_HPP
+
+#include <string>
+#include <vector>
+
+namespace Osi2 {
+
+/*! \brief Send solver jobs to a solver daemon
+
+  A client connects to a SolverDaemon over its local socket and hands it
+  jobs, one at a time. The daemon does the loading, reading and solving;
+  the client waits for the result. A connection can carry any number of
+  jobs. Not available on Windows.
+*/
+class DaemonClient {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor
+    DaemonClient() ;
+    /// Destructor; closes the connection
+    ~DaemonClient() ;
+    //@}
+
+    /// \name Connection
+    //@{
+    /*! \brief Connect to the daemon listening on \p socketPath
+
+      Closes any connection already open.
+
+      \return 0 on success; otherwise -1, with the reason in \p errStr.
+    */
+    int connect(const std::string &socketPath, std::string &errStr) ;
+
+    /// Close the connection
+    void disconnect() ;
+
+    /// True if the client is connected
+    inline bool isConnected () const {
+        return (sock_ >= 0) ;
+    }
+    //@}
+
+    /// \name Jobs
+    //@{
+    /*! \brief Solve the model in file \p path
+
+      The daemon reads the model (unless it's still resident from an earlier
+      job) with an object from the plugin library known as \p shortName and
+      solves it. If the daemon doesn't know \p shortName yet, it loads
+      \p libName; if \p libName is empty, it loads the default library for
+      \p shortName (see ControlAPI::load). A relative \p path is taken
+      relative to the client's working directory.
+
+      \return 0 if the model was solved, with the status of the solve in
+      \p solveStatus and, if \p resident isn't null, whether the model was
+      already resident; otherwise -1, with the reason in \p errStr. The
+      connection is closed if the daemon can't be reached.
+    */
+    int solve(const std::string &shortName, const std::string &libName,
+              const std::string &path, bool keepNames, int &solveStatus,
+              std::string &errStr, bool *resident = 0) ;
+
+    /*! \brief The daemon's job counts
+
+      Returns 0 with the jobs run, those that found their model resident,
+      and the models resident now; -1 if the daemon can't be reached.
+    */
+    int getStats(int &numJobs, int &numHits, int &numResident) ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    DaemonClient(const DaemonClient &rhs) ;
+    /// Assignment (not implemented)
+    DaemonClient &operator=(const DaemonClient &rhs) ;
+
+    /// Send #request_ and wait for #reply_; -1 (and disconnect) on failure
+    int call() ;
+
+    /// The connection
+    int sock_ ;
+    /// Message buffers
+    std::vector<char> request_ ;
+    std::vector<char> reply_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,284 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ModelCache.cpp
+    \brief Method definitions for Osi2::SharedModel and Osi2::ModelCache
+*/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2ModelCache.hpp"
+#include "Osi2ModelHash.hpp"
+#include "Osi2MpsReader.hpp"
+
+namespace {
+
+/// Copy \p len entries from \p vals; nothing if \p vals is null
+template <typename T>
+void copyArray (std::vector<T> &vec, const T *vals, size_t len)
+{
+    if (vals == nullptr || len == 0)
+        vec.clear() ;
+    else
+        vec.assign(vals, vals+len) ;
+}
+
+/*
+  The part of the modification time below a second, where the platform
+  keeps it; 0 where it doesn't, which leaves whole seconds.
+*/
+int64_t mtimeNsec (const struct stat &info)
+{
+#if defined(OSI2PLATFORM_MAC) || defined(__APPLE__)
+    return (static_cast<int64_t>(info.st_mtimespec.tv_nsec)) ;
+#elif defined(OSI2PLATFORM_WINDOWS) || defined(WIN32)
+    return (0) ;
+#elif defined(__linux__) || \
+      (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L)
+    return (static_cast<int64_t>(info.st_mtim.tv_nsec)) ;
+#else
+    return (0) ;
+#endif
+}
+
+}  // end file-local namespace
+
+namespace Osi2 {
+
+/*
+  The matrix hash starts from the structural hash and takes the
+  coefficients; the content hash starts from the matrix hash and takes the
+  rest. An absent array hashes as one of no entries, unlike one of zeros.
+*/
+SharedModel SharedModel::make (int numCols, int numRows, const int *start,
+                               const int *index, const double *value,
+                               const double *colLower, const double *colUpper,
+                               const double *obj, const double *rowLower,
+                               const double *rowUpper, const char *integer,
+                               double objOffset)
+{
+    if (numCols < 0) numCols = 0 ;
+    if (numRows < 0) numRows = 0 ;
+    Data *data = new Data ;
+    data->refs_ = 1 ;
+    data->numCols_ = numCols ;
+    data->numRows_ = numRows ;
+    data->start_.assign(numCols+1, 0) ;
+    if (start != nullptr) data->start_.assign(start, start+numCols+1) ;
+    const size_t numElements = data->start_[numCols] ;
+    copyArray(data->index_, index, numElements) ;
+    copyArray(data->value_, value, numElements) ;
+    copyArray(data->colLower_, colLower, numCols) ;
+    copyArray(data->colUpper_, colUpper, numCols) ;
+    copyArray(data->obj_, obj, numCols) ;
+    copyArray(data->rowLower_, rowLower, numRows) ;
+    copyArray(data->rowUpper_, rowUpper, numRows) ;
+    bool anyInteger = false ;
+    for (int j = 0 ; integer != nullptr && j < numCols && !anyInteger ; j++)
+        anyInteger = (integer[j] != 0) ;
+    if (anyInteger) data->integer_.assign(integer, integer+numCols) ;
+    data->objOffset_ = objOffset ;
+
+    data->structureKey_ =
+        ModelHash::structure(numCols, numRows, &data->start_[0], nullptr,
+                             dataOf(data->index_)) ;
+    ModelHash matrixHash ;
+    matrixHash.add(static_cast<int64_t>(data->structureKey_)) ;
+    matrixHash.add(dataOf(data->value_), data->value_.size()) ;
+    data->matrixKey_ = matrixHash.value() ;
+    ModelHash hash ;
+    hash.add(static_cast<int64_t>(data->matrixKey_)) ;
+    hash.add(dataOf(data->colLower_), data->colLower_.size()) ;
+    hash.add(dataOf(data->colUpper_), data->colUpper_.size()) ;
+    hash.add(dataOf(data->obj_), data->obj_.size()) ;
+    hash.add(dataOf(data->rowLower_), data->rowLower_.size()) ;
+    hash.add(dataOf(data->rowUpper_), data->rowUpper_.size()) ;
+    for (size_t j = 0 ; j < data->integer_.size() ; j++) {
+        if (data->integer_[j]) hash.add(static_cast<int64_t>(j)) ;
+    }
+    hash.add(&data->objOffset_, 1) ;
+    data->hash_ = hash.value() ;
+
+    SharedModel model ;
+    model.data_ = data ;
+    return (model) ;
+}
+
+bool SharedModel::equals (const SharedModel &rhs) const
+{
+    if (data_ == rhs.data_) return (true) ;
+    if (data_ == nullptr || rhs.data_ == nullptr) return (false) ;
+    const Data &a = *data_ ;
+    const Data &b = *rhs.data_ ;
+    return (a.hash_ == b.hash_ && a.numCols_ == b.numCols_ &&
+            a.numRows_ == b.numRows_ && a.objOffset_ == b.objOffset_ &&
+            a.start_ == b.start_ && a.index_ == b.index_ &&
+            a.value_ == b.value_ && a.colLower_ == b.colLower_ &&
+            a.colUpper_ == b.colUpper_ && a.obj_ == b.obj_ &&
+            a.rowLower_ == b.rowLower_ && a.rowUpper_ == b.rowUpper_ &&
+            a.integer_ == b.integer_) ;
+}
+
+ModelCache::ModelCache ()
+    : hits_(0),
+      misses_(0)
+{ }
+
+ModelCache::~ModelCache ()
+{ }
+
+/*
+  The file is checked, and read, outside the lock; only the maps are
+  touched under it. A file rewritten within the second it was read keeps
+  its size and whole-second mtime, and a file replaced by a rename can
+  keep both, so the device, inode and fraction of the mtime must match as
+  well.
+*/
+int ModelCache::readMps (const std::string &path, SharedModel &model,
+                         std::string &error)
+{
+    model.reset() ;
+    error.clear() ;
+    struct stat info ;
+    if (::stat(path.c_str(), &info) != 0) {
+        error = "Can't stat " + path + "." ;
+        return (-1) ;
+    }
+    const int64_t size = static_cast<int64_t>(info.st_size) ;
+    const int64_t mtime = static_cast<int64_t>(info.st_mtime) ;
+    const int64_t nsec = mtimeNsec(info) ;
+    const uint64_t device = static_cast<uint64_t>(info.st_dev) ;
+    const uint64_t inode = static_cast<uint64_t>(info.st_ino) ;
+    {
+        ScopedLock lock(mutex_) ;
+        FileMap::const_iterator iter = files_.find(path) ;
+        if (iter != files_.end() && iter->second.size_ == size &&
+                iter->second.mtime_ == mtime &&
+                iter->second.mtimeNsec_ == nsec &&
+                iter->second.device_ == device &&
+                iter->second.inode_ == inode) {
+            hits_++ ;
+            model = iter->second.model_ ;
+            return (0) ;
+        }
+    }
+    MpsReader reader ;
+    const int retval = reader.readFile(path) ;
+    if (retval != 0) {
+        error = reader.getError() ;
+        return (retval) ;
+    }
+    const SharedModel read =
+        SharedModel::make(reader.getNumCols(), reader.getNumRows(),
+                          reader.getStarts(), reader.getIndices(),
+                          reader.getValues(), reader.getColLower(),
+                          reader.getColUpper(), reader.getObjective(),
+                          reader.getRowLower(), reader.getRowUpper(),
+                          reader.getIntegerInfo(), reader.getObjOffset()) ;
+    ScopedLock lock(mutex_) ;
+    bool hit = false ;
+    model = internLocked(read, hit) ;
+    if (hit)
+        hits_++ ;
+    else
+        misses_++ ;
+    FileEntry &entry = files_[path] ;
+    entry.size_ = size ;
+    entry.mtime_ = mtime ;
+    entry.mtimeNsec_ = nsec ;
+    entry.device_ = device ;
+    entry.inode_ = inode ;
+    entry.model_ = model ;
+    return (0) ;
+}
+
+SharedModel ModelCache::intern (const SharedModel &model)
+{
+    if (!model.isValid()) return (model) ;
+    ScopedLock lock(mutex_) ;
+    bool hit = false ;
+    const SharedModel held = internLocked(model, hit) ;
+    if (hit)
+        hits_++ ;
+    else
+        misses_++ ;
+    return (held) ;
+}
+
+SharedModel ModelCache::internLocked (const SharedModel &model, bool &hit)
+{
+    std::pair<HashMap::iterator, HashMap::iterator> range =
+        models_.equal_range(model.getHash()) ;
+    for (HashMap::iterator iter = range.first ; iter != range.second ; iter++) {
+        if (iter->second.equals(model)) {
+            hit = true ;
+            return (iter->second) ;
+        }
+    }
+    hit = false ;
+    models_.insert(HashMap::value_type(model.getHash(), model)) ;
+    return (model) ;
+}
+
+/*
+  Every file entry's model is also in models_, so a model no one else
+  holds has one handle there and one for each file read as it.
+*/
+void ModelCache::trim ()
+{
+    ScopedLock lock(mutex_) ;
+    HashMap::iterator iter = models_.begin() ;
+    while (iter != models_.end()) {
+        const SharedModel &model = iter->second ;
+        int cacheRefs = 1 ;
+        for (FileMap::const_iterator file = files_.begin() ;
+             file != files_.end() ; file++) {
+            if (file->second.model_.sameAs(model)) cacheRefs++ ;
+        }
+        if (model.getUseCount() > cacheRefs) {
+            iter++ ;
+            continue ;
+        }
+        FileMap::iterator file = files_.begin() ;
+        while (file != files_.end()) {
+            if (file->second.model_.sameAs(model))
+                files_.erase(file++) ;
+            else
+                file++ ;
+        }
+        models_.erase(iter++) ;
+    }
+}
+
+void ModelCache::clear ()
+{
+    ScopedLock lock(mutex_) ;
+    files_.clear() ;
+    models_.clear() ;
+}
+
+size_t ModelCache::getNumModels () const
+{
+    ScopedLock lock(mutex_) ;
+    return (models_.size()) ;
+}
+
+size_t ModelCache::getHits () const
+{
+    ScopedLock lock(mutex_) ;
+    return (hits_) ;
+}
+
+size_t ModelCache::getMisses () const
+{
+    ScopedLock lock(mutex_) ;
+    return (misses_) ;
+}
+
+}  // end namespace Osi2
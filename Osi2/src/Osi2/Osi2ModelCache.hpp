@@ -0,0 +1,329 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ModelCache.hpp
+    \brief Models read once and shared, keyed by file and by content.
+
+  See Osi2::ModelCache and ControlAPI::readMpsShared.
+*/
+
+#ifndef Osi2ModelCache_HPP
+#define Osi2ModelCache_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "CoinTypes.hpp"
+
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*! \brief A model, read-only, shared by reference count
+
+  A handle on the arrays of one model: a column-major (CSC) matrix,
+  bounds, objective and integrality, in the form ProbMgmtAPI::loadProblem
+  takes. Copying a handle shares the model; the model goes when the last
+  handle does. Nothing may change the arrays once the model is made, so
+  handles can be used from any number of threads at once.
+
+  Each model carries three hashes: #getHash, of everything in it, which is
+  how ModelCache recognises a model it already has; #getStructureKey, the
+  structural hash of ModelHash::structure that the warm start cache files
+  bases under (WarmStartCache::keyOf); and #getMatrixKey, of the matrix
+  alone, which Presolve keys on.
+*/
+class SharedModel {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; no model
+    SharedModel () : data_(0) { }
+    /// Copy constructor; shares the model
+    SharedModel (const SharedModel &rhs) : data_(rhs.data_) {
+        if (data_ != 0) atomicAdd(&data_->refs_, 1) ;
+    }
+    /// Assignment; shares the model
+    SharedModel &operator= (const SharedModel &rhs) {
+        if (rhs.data_ != 0) atomicAdd(&rhs.data_->refs_, 1) ;
+        release() ;
+        data_ = rhs.data_ ;
+        return (*this) ;
+    }
+    /// Destructor; the last handle deletes the model
+    ~SharedModel () {
+        release() ;
+    }
+    //@}
+
+    /*! \brief Make a model from arrays
+
+      The arrays are copied. \p start has \p numCols+1 entries; \p integer,
+      one char per column, may be null. Null bound and objective arrays
+      stay null, and loading takes the defaults of ProbMgmtAPI::loadProblem.
+    */
+    static SharedModel make(int numCols, int numRows, const int *start,
+                            const int *index, const double *value,
+                            const double *colLower, const double *colUpper,
+                            const double *obj, const double *rowLower,
+                            const double *rowUpper, const char *integer,
+                            double objOffset = 0.0) ;
+
+    /// True if the handle holds a model
+    inline bool isValid () const { return (data_ != 0) ; }
+    /// True if both handles hold the same model (not just an equal one)
+    inline bool sameAs (const SharedModel &rhs) const {
+        return (data_ == rhs.data_) ;
+    }
+    /// Handles on the model, this one included; 0 for no model
+    inline int getUseCount () const {
+        return ((data_ == 0) ? 0 : atomicLoad(&data_->refs_)) ;
+    }
+    /// Drop the model; the handle holds none after
+    void reset () {
+        release() ;
+        data_ = 0 ;
+    }
+
+    /// True if the two models hold the same data
+    bool equals(const SharedModel &rhs) const ;
+
+    /// \name The model
+    //@{
+    inline int getNumCols () const { return (data_->numCols_) ; }
+    inline int getNumRows () const { return (data_->numRows_) ; }
+    inline int getNumElements () const {
+        return (static_cast<int>(data_->index_.size())) ;
+    }
+    /// Column starts; getNumCols()+1 entries
+    inline const int *getStarts () const { return (&data_->start_[0]) ; }
+    inline const int *getIndices () const { return (dataOf(data_->index_)) ; }
+    inline const double *getValues () const {
+        return (dataOf(data_->value_)) ;
+    }
+    inline const double *getColLower () const {
+        return (dataOf(data_->colLower_)) ;
+    }
+    inline const double *getColUpper () const {
+        return (dataOf(data_->colUpper_)) ;
+    }
+    inline const double *getObjective () const {
+        return (dataOf(data_->obj_)) ;
+    }
+    inline const double *getRowLower () const {
+        return (dataOf(data_->rowLower_)) ;
+    }
+    inline const double *getRowUpper () const {
+        return (dataOf(data_->rowUpper_)) ;
+    }
+    /// 1 for each integer column, 0 otherwise; null if there are none
+    inline const char *getIntegerInfo () const {
+        return (dataOf(data_->integer_)) ;
+    }
+    /// The objective offset, as clp keeps it (MpsReader::getObjOffset)
+    inline double getObjOffset () const { return (data_->objOffset_) ; }
+    /// Hash of everything in the model
+    inline uint64_t getHash () const { return (data_->hash_) ; }
+    /// Structural hash; the warm start cache key for the model
+    inline uint64_t getStructureKey () const {
+        return (data_->structureKey_) ;
+    }
+    /// Hash of the matrix (structure and coefficients), not the bounds
+    inline uint64_t getMatrixKey () const { return (data_->matrixKey_) ; }
+    //@}
+
+private:
+
+    /// The model, and its count of handles
+    struct Data {
+        volatile int refs_ ;
+        int numCols_ ;
+        int numRows_ ;
+        std::vector<int> start_ ;
+        std::vector<int> index_ ;
+        std::vector<double> value_ ;
+        std::vector<double> colLower_ ;
+        std::vector<double> colUpper_ ;
+        std::vector<double> obj_ ;
+        std::vector<double> rowLower_ ;
+        std::vector<double> rowUpper_ ;
+        /// Empty if no column is integer
+        std::vector<char> integer_ ;
+        double objOffset_ ;
+        uint64_t hash_ ;
+        uint64_t structureKey_ ;
+        uint64_t matrixKey_ ;
+    } ;
+
+    /// Let go of the model
+    inline void release () {
+        if (data_ != 0 && atomicAdd(&data_->refs_, -1) == 0) delete data_ ;
+    }
+
+    /// The data of a vector; null if it's empty
+    template <typename T>
+    static inline const T *dataOf (const std::vector<T> &vec) {
+        return (vec.empty() ? 0 : &vec[0]) ;
+    }
+
+    /// The model; null for none
+    Data *data_ ;
+
+} ;
+
+/*! \brief A cache of models, shared by everything that loads them
+
+  #readMps reads an MPS file (with MpsReader) into a SharedModel, once:
+  a later read of the same path, while it names the same file (device and
+  inode) with the same size and modification time, returns the model
+  already read. The time is compared to the nanosecond where the platform
+  keeps it, so only a rewrite within one tick of the file system's clock
+  goes unseen. Every model is also filed by the hash of its contents, and
+  a model equal to one already held (another copy of the file, a model
+  built by #intern) is dropped in favour of the one held, so the process
+  keeps one copy of each model. Equal hashes are checked against the
+  data, so a collision costs a comparison and no more.
+
+  Models stay while the cache holds them; #trim lets go of those no one
+  else has a handle on. All methods are thread-safe. Files are read
+  outside the lock, so two threads reading one new file at once may both
+  parse it; the second model is dropped for the first.
+*/
+class ModelCache {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; an empty cache
+    ModelCache() ;
+    /// Destructor; handles given out stay good
+    ~ModelCache() ;
+    //@}
+
+    /*! \brief The model in the MPS file at \p path
+
+      \returns 0 on success, with \p model the model; 1 if the file uses
+      MPS features MpsReader doesn't handle, and -1 for any other error.
+      Either way \p error says what went wrong, and on error \p model holds
+      no model.
+    */
+    int readMps(const std::string &path, SharedModel &model,
+                std::string &error) ;
+
+    /*! \brief The cached model equal to \p model, or \p model itself
+
+      \p model is cached if no equal model is; either way it comes back as
+      the handle to use.
+    */
+    SharedModel intern(const SharedModel &model) ;
+
+    /// Let go of the models no one else has a handle on
+    void trim() ;
+    /// Let go of every model
+    void clear() ;
+    /// Models held
+    size_t getNumModels() const ;
+    /// Reads and interns that found the model held already
+    size_t getHits() const ;
+    /// Reads and interns that didn't
+    size_t getMisses() const ;
+
+private:
+
+    /// Copy constructor (not implemented)
+    ModelCache(const ModelCache &rhs) ;
+    /// Assignment (not implemented)
+    ModelCache &operator=(const ModelCache &rhs) ;
+
+    /// What a path was last read as
+    struct FileEntry {
+        int64_t size_ ;
+        int64_t mtime_ ;
+        /// Fraction of #mtime_, in ns; 0 where the platform doesn't say
+        int64_t mtimeNsec_ ;
+        uint64_t device_ ;
+        uint64_t inode_ ;
+        SharedModel model_ ;
+    } ;
+    typedef std::map<std::string, FileEntry> FileMap ;
+    typedef std::multimap<uint64_t, SharedModel> HashMap ;
+
+    /// #intern with #mutex_ held; \p hit is set if the model was held
+    SharedModel internLocked(const SharedModel &model, bool &hit) ;
+
+    /// Models by the files they were read from
+    FileMap files_ ;
+    /// Models by content hash
+    HashMap models_ ;
+    size_t hits_ ;
+    size_t misses_ ;
+    /// Guards everything
+    mutable Mutex mutex_ ;
+
+} ;
+
+/*! \name Loading a shared model
+
+  Made for ControlAPI::loadModel. A \c loadProblem that returns a status
+  (ProbMgmtAPI) passes it on; one that returns nothing (Osi1API) counts as
+  status 0, and the model's integer columns are marked with \c setInteger.
+  The object copies the arrays, as it would for any load. The model is a
+  SharedModel, or anything with its getters (PresolvedProblem).
+*/
+//@{
+
+/// Load through a loadProblem that returns a status
+template <class T, class B, class M>
+inline int callLoadMethod (T *obj,
+                           int (B::*method)(int, int, const int *, const int *,
+                                            const double *, const double *,
+                                            const double *, const double *,
+                                            const double *, const double *),
+                           const M &model)
+{
+    return ((obj->*method)(model.getNumCols(), model.getNumRows(),
+                           model.getStarts(), model.getIndices(),
+                           model.getValues(), model.getColLower(),
+                           model.getColUpper(), model.getObjective(),
+                           model.getRowLower(), model.getRowUpper())) ;
+}
+
+/// Load through a loadProblem that returns nothing
+template <class T, class B, class M>
+inline int callLoadMethod (T *obj,
+                           void (B::*method)(int, int, const CoinBigIndex *,
+                                             const int *, const double *,
+                                             const double *, const double *,
+                                             const double *, const double *,
+                                             const double *),
+                           const M &model)
+{
+    (obj->*method)(model.getNumCols(), model.getNumRows(), model.getStarts(),
+                   model.getIndices(), model.getValues(), model.getColLower(),
+                   model.getColUpper(), model.getObjective(),
+                   model.getRowLower(), model.getRowUpper()) ;
+    const char *integer = model.getIntegerInfo() ;
+    if (integer != 0) {
+        std::vector<int> cols ;
+        for (int j = 0 ; j < model.getNumCols() ; j++) {
+            if (integer[j]) cols.push_back(j) ;
+        }
+        if (!cols.empty())
+            obj->setInteger(&cols[0], static_cast<int>(cols.size())) ;
+    }
+    return (0) ;
+}
+
+//@}
+
+}  // end namespace Osi2
+
+#endif
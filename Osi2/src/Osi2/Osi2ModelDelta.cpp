@@ -0,0 +1,237 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ModelDelta.cpp
+    \brief Method definitions for Osi2::ModelDelta
+*/
+
+#include <algorithm>
+
+#include "Osi2Config.h"
+#include "Osi2ModelDelta.hpp"
+
+namespace Osi2 {
+
+namespace {
+
+/*! \brief Renumber after the indices \p gone (ascending) are removed
+
+  Each entry of \p map is a current index; entries move down by the
+  number of removed indices below them.
+*/
+void closeUp (std::vector<int> &map, const std::vector<int> &gone)
+{
+    for (size_t k = 0 ; k < map.size() ; k++) {
+        map[k] -= static_cast<int>(
+            std::lower_bound(gone.begin(), gone.end(), map[k]) - gone.begin()) ;
+    }
+}
+
+/// The identity map on \p n indices
+std::vector<int> identity (int n)
+{
+    std::vector<int> map(n) ;
+    for (int i = 0 ; i < n ; i++) map[i] = i ;
+    return (map) ;
+}
+
+}   // end unnamed file-local namespace
+
+ModelDelta::ModelDelta ()
+{ }
+
+ModelDelta::~ModelDelta ()
+{ }
+
+ModelDelta::Edit &ModelDelta::extend (Kind kind)
+{
+    if (edits_.empty() || edits_.back().kind_ != kind) {
+        edits_.push_back(Edit()) ;
+        edits_.back().kind_ = kind ;
+    }
+    return (edits_.back()) ;
+}
+
+void ModelDelta::setRowBounds (int row, double lb, double ub)
+{
+    Edit &edit = extend(RowBounds) ;
+    edit.index_.push_back(row) ;
+    edit.el_.push_back(lb) ;
+    edit.el_.push_back(ub) ;
+}
+
+void ModelDelta::setColBounds (int col, double lb, double ub)
+{
+    Edit &edit = extend(ColBounds) ;
+    edit.index_.push_back(col) ;
+    edit.el_.push_back(lb) ;
+    edit.el_.push_back(ub) ;
+}
+
+void ModelDelta::setObjCoeff (int col, double obj)
+{
+    Edit &edit = extend(ObjCoeffs) ;
+    edit.index_.push_back(col) ;
+    edit.el_.push_back(obj) ;
+}
+
+void ModelDelta::addRows (int num, const int *starts, const int *cols,
+                          const double *els, const double *lb,
+                          const double *ub)
+{
+    addBlock(AddRows, num, starts, cols, els, lb, ub, 0) ;
+}
+
+void ModelDelta::addCols (int num, const int *starts, const int *rows,
+                          const double *els, const double *lb,
+                          const double *ub, const double *obj)
+{
+    addBlock(AddCols, num, starts, rows, els, lb, ub, obj) ;
+}
+
+/*
+  Consecutive blocks of the same kind go in one call; the starts of the
+  block appended are moved up past the one before.
+*/
+void ModelDelta::addBlock (Kind kind, int num, const int *starts,
+                           const int *minor, const double *els,
+                           const double *lb, const double *ub,
+                           const double *obj)
+{
+    if (num <= 0) return ;
+    Edit &edit = extend(kind) ;
+    const int base = static_cast<int>(edit.minor_.size()) ;
+    const int numBefore = static_cast<int>(edit.lb_.size()) ;
+    if (edit.starts_.empty()) edit.starts_.push_back(0) ;
+    for (int i = 0 ; i < num ; i++)
+        edit.starts_.push_back(base+starts[i+1]-starts[0]) ;
+    edit.minor_.insert(edit.minor_.end(), minor+starts[0], minor+starts[num]) ;
+    edit.el_.insert(edit.el_.end(), els+starts[0], els+starts[num]) ;
+    edit.lb_.insert(edit.lb_.end(), lb, lb+num) ;
+    edit.ub_.insert(edit.ub_.end(), ub, ub+num) ;
+    if (kind == AddCols) {
+        if (obj != 0)
+            edit.obj_.insert(edit.obj_.end(), obj, obj+num) ;
+        else
+            edit.obj_.resize(numBefore+num, 0.0) ;
+    }
+}
+
+void ModelDelta::deleteRows (int num, const int *rows)
+{
+    addDelete(DeleteRows, num, rows) ;
+}
+
+void ModelDelta::deleteCols (int num, const int *cols)
+{
+    addDelete(DeleteCols, num, cols) ;
+}
+
+/*
+  Deletions aren't merged: the indices of the second are numbered after
+  the first is made.
+*/
+void ModelDelta::addDelete (Kind kind, int num, const int *index)
+{
+    if (num <= 0) return ;
+    edits_.push_back(Edit()) ;
+    Edit &edit = edits_.back() ;
+    edit.kind_ = kind ;
+    edit.index_.assign(index, index+num) ;
+    std::sort(edit.index_.begin(), edit.index_.end()) ;
+    edit.index_.erase(std::unique(edit.index_.begin(), edit.index_.end()),
+                      edit.index_.end()) ;
+}
+
+int ModelDelta::getNumEdits () const
+{
+    return (static_cast<int>(edits_.size())) ;
+}
+
+bool ModelDelta::empty () const
+{
+    return (edits_.empty()) ;
+}
+
+void ModelDelta::clear ()
+{
+    edits_.clear() ;
+}
+
+/*
+  Work back from the last edit made. rowMap and colMap take an index in
+  the model as it stood after the edit being undone to its index in the
+  model as it will stand when the undo gets that far. They start as the
+  identity. Undoing an add deletes the rows added and closes up; undoing a
+  delete adds the rows back at the end.
+*/
+void ModelDelta::invert (const std::vector<Edit> &raw, int numRows,
+                         int numCols)
+{
+    edits_.clear() ;
+    std::vector<int> rowMap = identity(numRows) ;
+    std::vector<int> colMap = identity(numCols) ;
+    for (size_t r = raw.size() ; r > 0 ; r--) {
+        const Edit &done = raw[r-1] ;
+        const bool rows = (done.kind_ == RowBounds || done.kind_ == AddRows ||
+                           done.kind_ == DeleteRows) ;
+        std::vector<int> &map = rows ? rowMap : colMap ;
+        std::vector<int> &otherMap = rows ? colMap : rowMap ;
+        switch (done.kind_) {
+            case RowBounds:
+            case ColBounds:
+            case ObjCoeffs: {
+                Edit &edit = extend(done.kind_) ;
+                for (size_t k = 0 ; k < done.index_.size() ; k++)
+                    edit.index_.push_back(map[done.index_[k]]) ;
+                edit.el_.insert(edit.el_.end(), done.el_.begin(),
+                                done.el_.end()) ;
+                break ;
+            }
+            case AddRows:
+            case AddCols: {
+                std::vector<int> gone(map.begin()+done.first_,
+                                      map.begin()+done.first_+done.size_) ;
+                addDelete((rows ? DeleteRows : DeleteCols),
+                          static_cast<int>(gone.size()), &gone[0]) ;
+                std::sort(gone.begin(), gone.end()) ;
+                map.resize(done.first_) ;
+                closeUp(map, gone) ;
+                break ;
+            }
+            case DeleteRows:
+            case DeleteCols: {
+                const int num = static_cast<int>(done.index_.size()) ;
+                edits_.push_back(Edit()) ;
+                Edit &edit = edits_.back() ;
+                edit.kind_ = rows ? AddRows : AddCols ;
+                edit.starts_ = done.starts_ ;
+                edit.minor_.reserve(done.minor_.size()) ;
+                for (size_t k = 0 ; k < done.minor_.size() ; k++)
+                    edit.minor_.push_back(otherMap[done.minor_[k]]) ;
+                edit.el_ = done.el_ ;
+                edit.lb_ = done.lb_ ;
+                edit.ub_ = done.ub_ ;
+                edit.obj_ = done.obj_ ;
+                edit.integer_ = done.integer_ ;
+                const int restored = static_cast<int>(map.size()) ;
+                std::vector<int> before(done.size_) ;
+                size_t kept = 0 ;
+                int t = 0 ;
+                for (int i = 0 ; i < done.size_ ; i++) {
+                    if (t < num && done.index_[t] == i)
+                        before[i] = restored+t++ ;
+                    else
+                        before[i] = map[kept++] ;
+                }
+                map.swap(before) ;
+                break ;
+            }
+        }
+    }
+}
+
+}  // end namespace Osi2
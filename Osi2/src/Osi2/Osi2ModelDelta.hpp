@@ -0,0 +1,337 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ModelDelta.hpp
+    \brief A batch of model edits, applied to a live solver object, with
+	   undo.
+
+  See Osi2::ModelDelta.
+*/
+
+#ifndef Osi2ModelDelta_HPP
+#define Osi2ModelDelta_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include "CoinPackedMatrix.hpp"
+
+namespace Osi2 {
+
+/*! \brief A batch of edits to a model, for a live solver object
+
+  Edits (bound and objective changes, rows and columns added and deleted)
+  are recorded against the model as it will stand when the edit before
+  them has been made, then #apply makes them on a solver object with the
+  Osi1API calls for each: \c setRowSetBounds, \c setColSetBounds, \c
+  setObjCoeffSet, \c addRows, \c addCols, \c deleteRows, \c deleteCols.
+  The model is changed in place, so the solver keeps its basis (a
+  basis-oriented solver keeps a valid warm start as long as the rows
+  deleted are loose and the columns nonbasic) and a \c resolve after the
+  batch starts warm. A run of bound or objective edits of one kind is
+  kept as one edit and made in one call.
+
+  Given a second delta, #apply fills it with the undo for the batch: the
+  old values of whatever was changed, and the rows and columns that were
+  deleted. Applying the undo to the solver object puts the model back as
+  it was, except that restored rows and columns come back at the end
+  rather than in their old places (the solver has no way to insert them).
+  Applying the undo's own undo makes the batch again.
+
+  The templated methods work on any API with the Osi1API methods named. A
+  delta is not thread-safe.
+*/
+class ModelDelta {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; an empty batch
+    ModelDelta() ;
+    /// Destructor
+    ~ModelDelta() ;
+    //@}
+
+    /// \name Recording edits
+    //@{
+    /// Set the bounds of a row
+    void setRowBounds(int row, double lb, double ub) ;
+    /// Set the bounds of a column
+    void setColBounds(int col, double lb, double ub) ;
+    /// Set the objective coefficient of a column
+    void setObjCoeff(int col, double obj) ;
+    /*! \brief Add rows, as for \c addRows
+
+      Row \c i of the block is \c cols[k], \c els[k] for \c k from \c
+      starts[i] to \c starts[i+1]-1.
+    */
+    void addRows(int num, const int *starts, const int *cols,
+                 const double *els, const double *lb, const double *ub) ;
+    /*! \brief Add columns, as for \c addCols
+
+      Column \c j of the block is \c rows[k], \c els[k] for \c k from \c
+      starts[j] to \c starts[j+1]-1.
+    */
+    void addCols(int num, const int *starts, const int *rows,
+                 const double *els, const double *lb, const double *ub,
+                 const double *obj) ;
+    /// Delete rows; repeats are ignored
+    void deleteRows(int num, const int *rows) ;
+    /// Delete columns; repeats are ignored
+    void deleteCols(int num, const int *cols) ;
+
+    /// Edits in the batch, after runs of bound and objective edits are merged
+    int getNumEdits() const ;
+    /// True if there are no edits
+    bool empty() const ;
+    /// Forget all the edits
+    void clear() ;
+    //@}
+
+    /// \name Working with the solver
+    //@{
+    /*! \brief Make the edits on the solver object, in order
+
+      If \p undo is given it is cleared and filled with the undo for the
+      batch, to be applied to the object as it stands after this call.
+
+      \returns the number of solver calls made
+    */
+    template <class T>
+    int apply (T *obj, ModelDelta *undo = 0) const {
+        std::vector<Edit> raw ;
+        if (undo != 0) raw.reserve(edits_.size()) ;
+        int calls = 0 ;
+        for (size_t k = 0 ; k < edits_.size() ; k++) {
+            const Edit &edit = edits_[k] ;
+            if (undo != 0) {
+                raw.push_back(Edit()) ;
+                capture(obj, edit, raw.back()) ;
+            }
+            calls += make(obj, edit) ;
+        }
+        if (undo != 0) undo->invert(raw, obj->getNumRows(), obj->getNumCols()) ;
+        return (calls) ;
+    }
+    //@}
+
+private:
+
+    /// Kinds of edit
+    enum Kind {
+        RowBounds = 0,
+        ColBounds,
+        ObjCoeffs,
+        AddRows,
+        AddCols,
+        DeleteRows,
+        DeleteCols
+    } ;
+
+    /*! \brief An edit
+
+      Bound and objective edits use #index_ and #el_ (bounds in lower,
+      upper pairs). Added rows or columns are a block in #starts_, #minor_,
+      #el_, #lb_, #ub_, #obj_ (columns), with #integer_ the positions in
+      the block of integer columns. Deletions use #index_, ascending.
+
+      Captured for undo, an add also records the first new index
+      (#first_) and a delete the block that was deleted and the number of
+      rows or columns before the delete (#size_).
+    */
+    struct Edit {
+        Edit () : kind_(RowBounds), first_(0), size_(0) { }
+        Kind kind_ ;
+        std::vector<int> index_ ;
+        std::vector<int> starts_ ;
+        std::vector<int> minor_ ;
+        std::vector<double> el_ ;
+        std::vector<double> lb_ ;
+        std::vector<double> ub_ ;
+        std::vector<double> obj_ ;
+        std::vector<int> integer_ ;
+        int first_ ;
+        int size_ ;
+    } ;
+
+    /// The edit to add to; a new one unless the last is of kind \p kind
+    Edit &extend(Kind kind) ;
+
+    /// Record a block of rows or columns
+    void addBlock(Kind kind, int num, const int *starts, const int *minor,
+                  const double *els, const double *lb, const double *ub,
+                  const double *obj) ;
+
+    /// Record a deletion
+    void addDelete(Kind kind, int num, const int *index) ;
+
+    /*! \brief Build the undo from what \p raw captured
+
+      \p raw holds one entry per edit made, in the numbering of the model
+      as it stood for that edit; \p numRows and \p numCols are the size
+      of the model after the batch.
+    */
+    void invert(const std::vector<Edit> &raw, int numRows, int numCols) ;
+
+    /// Copy the major vectors \p index of \p mtx into \p into as a block
+    template <class M>
+    static void copyVectors (const M *mtx, const std::vector<int> &index,
+                             Edit &into) {
+        const int *starts = mtx->getVectorStarts() ;
+        const int *lengths = mtx->getVectorLengths() ;
+        const int *minor = mtx->getIndices() ;
+        const double *els = mtx->getElements() ;
+        into.starts_.push_back(0) ;
+        for (size_t k = 0 ; k < index.size() ; k++) {
+            const int first = starts[index[k]] ;
+            const int last = first+lengths[index[k]] ;
+            into.minor_.insert(into.minor_.end(), minor+first, minor+last) ;
+            into.el_.insert(into.el_.end(), els+first, els+last) ;
+            into.starts_.push_back(static_cast<int>(into.minor_.size())) ;
+        }
+    }
+
+    /// Record in \p raw what's needed to undo \p edit
+    template <class T>
+    static void capture (T *obj, const Edit &edit, Edit &raw) {
+        raw.kind_ = edit.kind_ ;
+        const std::vector<int> &index = edit.index_ ;
+        switch (edit.kind_) {
+            case RowBounds:
+            case ColBounds: {
+                const bool rows = (edit.kind_ == RowBounds) ;
+                const double *lb = rows ? obj->getRowLower() : obj->getColLower() ;
+                const double *ub = rows ? obj->getRowUpper() : obj->getColUpper() ;
+                raw.index_ = index ;
+                raw.el_.reserve(2*index.size()) ;
+                for (size_t k = 0 ; k < index.size() ; k++) {
+                    raw.el_.push_back(lb[index[k]]) ;
+                    raw.el_.push_back(ub[index[k]]) ;
+                }
+                break ;
+            }
+            case ObjCoeffs: {
+                const double *obj0 = obj->getObjCoefficients() ;
+                raw.index_ = index ;
+                raw.el_.reserve(index.size()) ;
+                for (size_t k = 0 ; k < index.size() ; k++)
+                    raw.el_.push_back(obj0[index[k]]) ;
+                break ;
+            }
+            case AddRows: {
+                raw.first_ = obj->getNumRows() ;
+                raw.size_ = static_cast<int>(edit.lb_.size()) ;
+                break ;
+            }
+            case AddCols: {
+                raw.first_ = obj->getNumCols() ;
+                raw.size_ = static_cast<int>(edit.lb_.size()) ;
+                break ;
+            }
+            case DeleteRows: {
+                raw.index_ = index ;
+                raw.size_ = obj->getNumRows() ;
+                copyVectors(obj->getMatrixByRow(), index, raw) ;
+                const double *lb = obj->getRowLower() ;
+                const double *ub = obj->getRowUpper() ;
+                for (size_t k = 0 ; k < index.size() ; k++) {
+                    raw.lb_.push_back(lb[index[k]]) ;
+                    raw.ub_.push_back(ub[index[k]]) ;
+                }
+                break ;
+            }
+            case DeleteCols: {
+                raw.index_ = index ;
+                raw.size_ = obj->getNumCols() ;
+                copyVectors(obj->getMatrixByCol(), index, raw) ;
+                const double *lb = obj->getColLower() ;
+                const double *ub = obj->getColUpper() ;
+                const double *obj0 = obj->getObjCoefficients() ;
+                for (size_t k = 0 ; k < index.size() ; k++) {
+                    raw.lb_.push_back(lb[index[k]]) ;
+                    raw.ub_.push_back(ub[index[k]]) ;
+                    raw.obj_.push_back(obj0[index[k]]) ;
+                    if (obj->isInteger(index[k]))
+                        raw.integer_.push_back(static_cast<int>(k)) ;
+                }
+                break ;
+            }
+        }
+    }
+
+    /// Make \p edit on the object; returns the number of calls made
+    template <class T>
+    static int make (T *obj, const Edit &edit) {
+        const int num = static_cast<int>(edit.index_.size()) ;
+        switch (edit.kind_) {
+            case RowBounds: {
+                if (num == 0) return (0) ;
+                obj->setRowSetBounds(&edit.index_[0], &edit.index_[0]+num,
+                                     &edit.el_[0]) ;
+                return (1) ;
+            }
+            case ColBounds: {
+                if (num == 0) return (0) ;
+                obj->setColSetBounds(&edit.index_[0], &edit.index_[0]+num,
+                                     &edit.el_[0]) ;
+                return (1) ;
+            }
+            case ObjCoeffs: {
+                if (num == 0) return (0) ;
+                obj->setObjCoeffSet(&edit.index_[0], &edit.index_[0]+num,
+                                    &edit.el_[0]) ;
+                return (1) ;
+            }
+            case AddRows: {
+                const int numAdded = static_cast<int>(edit.lb_.size()) ;
+                if (numAdded == 0) return (0) ;
+                obj->addRows(numAdded, &edit.starts_[0], data(edit.minor_),
+                             data(edit.el_), &edit.lb_[0], &edit.ub_[0]) ;
+                return (1) ;
+            }
+            case AddCols: {
+                const int numAdded = static_cast<int>(edit.lb_.size()) ;
+                if (numAdded == 0) return (0) ;
+                const int first = obj->getNumCols() ;
+                obj->addCols(numAdded, &edit.starts_[0], data(edit.minor_),
+                             data(edit.el_), &edit.lb_[0], &edit.ub_[0],
+                             &edit.obj_[0]) ;
+                if (edit.integer_.empty()) return (1) ;
+                std::vector<int> integer(edit.integer_) ;
+                for (size_t k = 0 ; k < integer.size() ; k++)
+                    integer[k] += first ;
+                obj->setInteger(&integer[0], static_cast<int>(integer.size())) ;
+                return (2) ;
+            }
+            case DeleteRows: {
+                if (num == 0) return (0) ;
+                obj->deleteRows(num, &edit.index_[0]) ;
+                return (1) ;
+            }
+            case DeleteCols: {
+                if (num == 0) return (0) ;
+                obj->deleteCols(num, &edit.index_[0]) ;
+                return (1) ;
+            }
+        }
+        return (0) ;
+    }
+
+    /// The vector's storage, or null if it's empty
+    template <class V>
+    static inline const typename V::value_type *data (const V &vec) {
+        return (vec.empty() ? 0 : &vec[0]) ;
+    }
+
+    /// The edits, in order
+    std::vector<Edit> edits_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,71 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ModelHash.cpp
+    \brief Method definitions for Osi2::ModelHash
+*/
+
+#include <cstring>
+
+#include "Osi2Config.h"
+#include "Osi2ModelHash.hpp"
+
+namespace Osi2 {
+
+ModelHash::ModelHash ()
+    : state_(0x243f6a8885a308d3ULL),
+      count_(0)
+{ }
+
+void ModelHash::add (int64_t val)
+{
+    mix(static_cast<uint64_t>(val)) ;
+}
+
+/*
+  Two ints to a word, so the common case, a long index array, costs half
+  a mix per entry.
+*/
+void ModelHash::add (const int *vals, size_t len)
+{
+    size_t k = 0 ;
+    for ( ; k+1 < len ; k += 2)
+        mix((static_cast<uint64_t>(static_cast<uint32_t>(vals[k])) << 32) |
+            static_cast<uint32_t>(vals[k+1])) ;
+    if (k < len) mix(static_cast<uint32_t>(vals[k])) ;
+    mix(len) ;
+}
+
+void ModelHash::add (const double *vals, size_t len)
+{
+    for (size_t k = 0 ; k < len ; k++) {
+        const double val = (vals[k] == 0.0) ? 0.0 : vals[k] ;
+        uint64_t bits ;
+        std::memcpy(&bits, &val, sizeof(bits)) ;
+        mix(bits) ;
+    }
+    mix(len) ;
+}
+
+uint64_t ModelHash::value () const
+{
+    return (finalise(state_^count_)) ;
+}
+
+uint64_t ModelHash::structure (int numCols, int numRows, const int *start,
+                               const int *length, const int *index)
+{
+    ModelHash hash ;
+    hash.add(numCols) ;
+    hash.add(numRows) ;
+    for (int j = 0 ; j < numCols ; j++) {
+        const int len = (length == 0) ? start[j+1]-start[j] : length[j] ;
+        hash.add(index+start[j], len) ;
+    }
+    return (hash.value()) ;
+}
+
+}  // end namespace Osi2
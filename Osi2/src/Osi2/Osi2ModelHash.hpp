@@ -0,0 +1,88 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ModelHash.hpp
+    \brief Hashes of problem data, for recognising a model seen before.
+
+  See Osi2::ModelHash.
+*/
+
+#ifndef Osi2ModelHash_HPP
+#define Osi2ModelHash_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Osi2 {
+
+/*! \brief A 64-bit hash of problem data
+
+  Data is added a block at a time, and the hash of everything added is
+  #value. The mix works a word at a time, so hashing a large matrix costs
+  about what reading it costs. The hash doesn't depend on where the data
+  lives or on the platform's byte order, only on the values; +0.0 and -0.0
+  hash alike. It isn't cryptographic: users that can't tolerate a
+  collision must check what they can (dimensions, say) themselves.
+*/
+class ModelHash {
+
+public:
+
+    /// Constructor; the hash of nothing
+    ModelHash() ;
+
+    /// \name Adding data
+    //@{
+    /// Add one integer
+    void add(int64_t val) ;
+    /// Add \p len integers
+    void add(const int *vals, size_t len) ;
+    /// Add \p len doubles
+    void add(const double *vals, size_t len) ;
+    //@}
+
+    /// The hash of everything added so far
+    uint64_t value() const ;
+
+    /*! \brief Hash of the structure of a column-major matrix
+
+      The dimensions and the sparsity pattern: which rows each column has
+      entries in, in the order stored. Coefficients, bounds and objective
+      don't count, so a model with the same matrix pattern and different
+      numbers hashes the same. Columns run from <tt>start[j]</tt> for
+      <tt>length[j]</tt> entries; if \p length is null, to
+      <tt>start[j+1]</tt>.
+    */
+    static uint64_t structure(int numCols, int numRows, const int *start,
+                              const int *length, const int *index) ;
+
+private:
+
+    /// Fold one 64-bit word into the state
+    inline void mix (uint64_t word) {
+        state_ = (state_^finalise(word))*0x9e3779b97f4a7c15ULL ;
+        count_++ ;
+    }
+    /// A full-avalanche mix of one word (the murmur3 finaliser)
+    static inline uint64_t finalise (uint64_t h) {
+        h ^= h >> 33 ;
+        h *= 0xff51afd7ed558ccdULL ;
+        h ^= h >> 33 ;
+        h *= 0xc4ceb9fe1a85ec53ULL ;
+        h ^= h >> 33 ;
+        return (h) ;
+    }
+
+    /// State
+    uint64_t state_ ;
+    /// Words mixed in
+    uint64_t count_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -26,6 +26,10 @@
 #include "OsiSolverParameters.hpp"
 
 #include "Osi2API.hpp"
+#include "Osi2ApiTraits.hpp"
+#include "Osi2BatchResolve.hpp"
+#include "Osi2CancelToken.hpp"
+#include "Osi2SolutionView.hpp"
 
 class CoinPackedMatrix;
 class CoinWarmStart;
@@ -164,6 +168,24 @@ public:
       calling the default constructor Osi1API().
     */
     virtual Osi1API * clone(bool copyData = true) const = 0;
+
+    /*! \brief Clone for a worker that only solves
+
+      Not in OsiSolverInterface. As <tt>clone(true)</tt>, but the clone
+      keeps only what a solve needs: the row and column names go (the name
+      discipline becomes auto) unless \p keepNames is true, and an
+      implementation may leave out whatever it can rebuild on demand.
+    */
+    virtual Osi1API *cloneLean (bool keepNames = false) const
+    {
+      Osi1API *copy = clone(true) ;
+      if (!keepNames) {
+	copy->deleteRowNames(0,copy->getNumRows()) ;
+	copy->deleteColNames(0,copy->getNumCols()) ;
+	copy->setIntParam(OsiNameDiscipline,0) ;
+      }
+      return (copy) ;
+    }
   
     /// Virtual Destructor 
     virtual ~Osi1API () {} ;
@@ -188,6 +210,38 @@ public:
       problem for the first time.
     */
     virtual void resolve() = 0;
+
+    /*! \brief Attach \p token to the object
+
+      Not in OsiSolverInterface. Every solve from now on looks at the
+      token, until another is attached. A solve stopped because the token
+      was cancelled reports isAbandoned(); one stopped by the deadline
+      reports isIterationLimitReached(). Returns true if the object can
+      stop a solve that's running; false (the default) if it can't.
+    */
+    virtual bool setCancelToken (const CancelToken &token) { return (false) ; }
+
+    /*! \brief Resolve under each of a batch of right-hand sides or
+	       objectives
+
+      Not in OsiSolverInterface. \p variants holds \p numVariants
+      right-hand sides or objectives (see BatchKind), end to end; each is
+      solved in turn, warm from the basis of the one before (the last
+      optimal one, if the one before wasn't), and its status, objective,
+      primal solution and, if \p withDuals is true, row duals go in
+      \p results as dense blocks. The problem's own right-hand side or
+      objective is restored at the end.
+
+      The default (resolveBatchOf) makes the changes and calls #resolve;
+      an implementation may keep its factorization from one variant to
+      the next. Returns the number of variants solved to optimality, or -1
+      on bad arguments.
+    */
+    virtual int resolveBatch (BatchKind kind, int numVariants,
+			      const double *variants, BatchResult &results,
+			      bool withDuals = false)
+    { return (resolveBatchOf(this,kind,numVariants,variants,results,
+			     withDuals)) ; }
   //@}
 
   /*! \name Parameter set/get methods
@@ -583,6 +637,18 @@ public:
     */
     virtual int getIterationCount() const = 0;
 
+    /*! \brief Copy the solution into the caller's buffers in one call
+
+      Not in OsiSolverInterface. Fills \p view (see SolutionView) with the
+      column solution, reduced costs, row duals, row activities, objective
+      value and iteration count. Returns 0 on success, -1 if the buffers
+      are too small for the problem.
+    */
+    virtual int getSolutionBundle (SolutionView &view) const
+    { return (view.fill(getNumCols(),getNumRows(),getColSolution(),
+                        getReducedCost(),getRowPrice(),getRowActivity(),
+                        getObjValue(),getIterationCount())) ; }
+
     /** Get as many dual rays as the solver can provide. In case of proven
 	primal infeasibility there should (with high probability) be at least
 	one.
@@ -1366,6 +1432,24 @@ public:
 		        double objSense=0.0, int numberSOS=0,
 		        const CoinSet * setInfo=nullptr) const = 0 ;
 
+    /*! \brief Write the problem to a binary snapshot (see ModelSnapshot).
+
+      Not in OsiSolverInterface. The snapshot holds the matrix, bounds,
+      objective, integrality, names and basis, and can be reloaded with
+      #readSnapshot much faster than a text format can be parsed. Returns
+      0 on success, -1 on error; the default can't write snapshots.
+    */
+    virtual int writeSnapshot (const char *filename) const
+    { return (-1) ; }
+
+    /*! \brief Load a problem from a binary snapshot (see ModelSnapshot).
+
+      Not in OsiSolverInterface. Returns 0 on success, -1 on error; the
+      default can't read snapshots.
+    */
+    virtual int readSnapshot (const char *filename)
+    { return (-1) ; }
+
 /***********************************************************************/
 // Lp files 
 
@@ -1812,6 +1896,31 @@ public:
 					  double effectivenessLb = 0.0) = 0 ;
 };
 
+OSI2_API_TRAITS(Osi1API, "Osi1", ApiID_Osi1)
+
+/*! \name Hot start iteration limit
+    \brief For StrongBranchJob, which can't name OsiMaxNumIterationHotStart
+
+  Found by argument-dependent lookup.
+*/
+//@{
+/*! \brief Get the iteration limit for \c solveFromHotStart
+    \relates Osi1API
+*/
+inline int getHotStartIterationLimit (const Osi1API *osi)
+{
+  int limit = 0 ;
+  osi->getIntParam(OsiMaxNumIterationHotStart,limit) ;
+  return (limit) ;
+}
+
+/*! \brief Set the iteration limit for \c solveFromHotStart
+    \relates Osi1API
+*/
+inline void setHotStartIterationLimit (Osi1API *osi, int limit)
+{ osi->setIntParam(OsiMaxNumIterationHotStart,limit) ; }
+//@}
+
 }  // end namespace Osi2
 
 #endif
@@ -0,0 +1,442 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Presolve.cpp
+    \brief Method definitions for Osi2::Presolve, Osi2::PresolvedProblem
+	   and Osi2::PresolveCache
+*/
+
+#include <cmath>
+#include <cstring>
+
+#include "CoinFinite.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2Kernels.hpp"
+#include "Osi2ModelHash.hpp"
+#include "Osi2Presolve.hpp"
+
+namespace {
+
+/// Bounds at or beyond this are infinite
+const double presolveInfinity = 1.0e30 ;
+
+/// Feasibility tolerance, relative to the bound
+const double presolveTol = 1.0e-9 ;
+
+/// Entry \p k of \p vals, or \p dflt if \p vals is null
+inline double entryOr (const double *vals, int k, double dflt)
+{
+    return ((vals == nullptr) ? dflt : vals[k]) ;
+}
+
+/// Lower bound of column \p j, as ProbMgmtAPI::loadProblem defaults it
+inline double colLowerOf (const Osi2::SharedModel &model, int j)
+{
+    return (entryOr(model.getColLower(), j, 0.0)) ;
+}
+
+inline double colUpperOf (const Osi2::SharedModel &model, int j)
+{
+    return (entryOr(model.getColUpper(), j, COIN_DBL_MAX)) ;
+}
+
+inline double rowLowerOf (const Osi2::SharedModel &model, int i)
+{
+    return (entryOr(model.getRowLower(), i, -COIN_DBL_MAX)) ;
+}
+
+inline double rowUpperOf (const Osi2::SharedModel &model, int i)
+{
+    return (entryOr(model.getRowUpper(), i, COIN_DBL_MAX)) ;
+}
+
+/// True if column \p j of \p model is fixed
+inline bool isFixed (const Osi2::SharedModel &model, int j)
+{
+    const double lb = colLowerOf(model, j) ;
+    return (lb == colUpperOf(model, j) && std::fabs(lb) < presolveInfinity) ;
+}
+
+/// \p a is below \p b by more than the tolerance
+inline bool below (double a, double b)
+{
+    return (a < b-presolveTol*(1.0+std::fabs(b))) ;
+}
+
+/// \p a and \p b within the tolerance
+inline bool atBound (double a, double b)
+{
+    return (std::fabs(a-b) <= presolveTol*(1.0+std::fabs(b))) ;
+}
+
+/// \p count ints of \p a and \p b the same
+inline bool sameInts (const int *a, const int *b, size_t count)
+{
+    return (count == 0 || std::memcmp(a, b, count*sizeof(int)) == 0) ;
+}
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+uint64_t Presolve::keyOf (const SharedModel &model)
+{
+    ModelHash hash ;
+    hash.add(static_cast<int64_t>(model.getMatrixKey())) ;
+    for (int j = 0 ; j < model.getNumCols() ; j++) {
+        if (!isFixed(model, j)) continue ;
+        const double value = colLowerOf(model, j) ;
+        hash.add(static_cast<int64_t>(j)) ;
+        hash.add(&value, 1) ;
+    }
+    return (hash.value()) ;
+}
+
+/*
+  Counting the nonzeros left in each row once the fixed columns are out
+  sorts the rows; a second pass over the kept columns builds the reduced
+  matrix from the entries in kept rows. Explicit zeros are dropped.
+*/
+int Presolve::make (const SharedModel &model, Presolve &presolve)
+{
+    presolve.reset() ;
+    if (!model.isValid()) return (-1) ;
+    const int numCols = model.getNumCols() ;
+    const int numRows = model.getNumRows() ;
+    const int *start = model.getStarts() ;
+    const int *index = model.getIndices() ;
+    const double *value = model.getValues() ;
+    Data *data = new Data ;
+    data->refs_ = 1 ;
+    data->key_ = keyOf(model) ;
+    data->source_ = model ;
+    data->fixedActivity_.assign(numRows, 0.0) ;
+    std::vector<int> colIndex(numCols, -1) ;
+    std::vector<int> count(numRows, 0) ;
+    std::vector<int> lastCol(numRows, -1) ;
+    std::vector<double> lastEl(numRows, 0.0) ;
+    for (int j = 0 ; j < numCols ; j++) {
+        const bool fixed = isFixed(model, j) ;
+        if (fixed) {
+            data->fixedCols_.push_back(j) ;
+            data->fixedValues_.push_back(colLowerOf(model, j)) ;
+        } else {
+            colIndex[j] = static_cast<int>(data->keptCols_.size()) ;
+            data->keptCols_.push_back(j) ;
+        }
+        for (int k = start[j] ; k < start[j+1] ; k++) {
+            const int i = index[k] ;
+            if (value[k] == 0.0) continue ;
+            if (fixed) {
+                data->fixedActivity_[i] += value[k]*colLowerOf(model, j) ;
+            } else {
+                count[i]++ ;
+                lastCol[i] = colIndex[j] ;
+                lastEl[i] = value[k] ;
+            }
+        }
+    }
+    data->rowIndex_.assign(numRows, EmptyRow) ;
+    data->singletonCol_.assign(numRows, -1) ;
+    data->singletonEl_.assign(numRows, 0.0) ;
+    data->numEmpty_ = 0 ;
+    for (int i = 0 ; i < numRows ; i++) {
+        if (count[i] == 0) {
+            data->numEmpty_++ ;
+        } else if (count[i] == 1) {
+            data->rowIndex_[i] = SingletonRow ;
+            data->singletonCol_[i] = lastCol[i] ;
+            data->singletonEl_[i] = lastEl[i] ;
+        } else {
+            data->rowIndex_[i] = static_cast<int>(data->keptRows_.size()) ;
+            data->keptRows_.push_back(i) ;
+        }
+    }
+    const int numKept = static_cast<int>(data->keptCols_.size()) ;
+    data->start_.assign(numKept+1, 0) ;
+    for (int c = 0 ; c < numKept ; c++) {
+        const int j = data->keptCols_[c] ;
+        for (int k = start[j] ; k < start[j+1] ; k++) {
+            const int r = data->rowIndex_[index[k]] ;
+            if (r < 0 || value[k] == 0.0) continue ;
+            data->index_.push_back(r) ;
+            data->value_.push_back(value[k]) ;
+        }
+        data->start_[c+1] = static_cast<int>(data->index_.size()) ;
+    }
+    presolve.data_ = data ;
+    return (0) ;
+}
+
+bool Presolve::suits (const SharedModel &model) const
+{
+    if (data_ == nullptr || !model.isValid()) return (false) ;
+    const SharedModel &source = data_->source_ ;
+    if (source.sameAs(model)) return (true) ;
+    if (keyOf(model) != data_->key_ ||
+            model.getNumCols() != source.getNumCols() ||
+            model.getNumRows() != source.getNumRows() ||
+            model.getNumElements() != source.getNumElements())
+        return (false) ;
+    const size_t numElements = model.getNumElements() ;
+    if (!sameInts(model.getStarts(), source.getStarts(),
+                  model.getNumCols()+1) ||
+            !sameInts(model.getIndices(), source.getIndices(), numElements) ||
+            (numElements > 0 &&
+             std::memcmp(model.getValues(), source.getValues(),
+                         numElements*sizeof(double)) != 0))
+        return (false) ;
+    size_t numFixed = 0 ;
+    for (int j = 0 ; j < model.getNumCols() ; j++) {
+        if (!isFixed(model, j)) continue ;
+        if (numFixed >= data_->fixedCols_.size() ||
+                data_->fixedCols_[numFixed] != j ||
+                data_->fixedValues_[numFixed] != colLowerOf(model, j))
+            return (false) ;
+        numFixed++ ;
+    }
+    return (numFixed == data_->fixedCols_.size()) ;
+}
+
+/*
+  A singleton row a*x[j] in [rl, ru] is x[j] in [rl/a, ru/a], turned round
+  for a negative a, after the fixed columns' part of the row comes out.
+  The tighter of the column's bound and the row's wins, and the row that
+  won is noted for postsolve.
+*/
+int Presolve::reduce (const SharedModel &model,
+                      PresolvedProblem &problem) const
+{
+    problem = PresolvedProblem() ;
+    if (!suits(model)) return (-1) ;
+    const Data &data = *data_ ;
+    problem.presolve_ = *this ;
+    const int numKept = getNumCols() ;
+    const double *obj = model.getObjective() ;
+    problem.colLower_.resize(numKept) ;
+    problem.colUpper_.resize(numKept) ;
+    problem.obj_.resize(numKept) ;
+    problem.lowerRow_.assign(numKept, -1) ;
+    problem.upperRow_.assign(numKept, -1) ;
+    const char *integer = model.getIntegerInfo() ;
+    bool anyInteger = false ;
+    for (int c = 0 ; c < numKept ; c++) {
+        const int j = data.keptCols_[c] ;
+        problem.colLower_[c] = colLowerOf(model, j) ;
+        problem.colUpper_[c] = colUpperOf(model, j) ;
+        problem.obj_[c] = entryOr(obj, j, 0.0) ;
+        if (integer != nullptr && integer[j]) anyInteger = true ;
+    }
+    if (anyInteger) {
+        problem.integer_.resize(numKept) ;
+        for (int c = 0 ; c < numKept ; c++)
+            problem.integer_[c] = integer[data.keptCols_[c]] ;
+    }
+    problem.fixedObj_ = 0.0 ;
+    for (size_t k = 0 ; k < data.fixedCols_.size() ; k++)
+        problem.fixedObj_ +=
+            entryOr(obj, data.fixedCols_[k], 0.0)*data.fixedValues_[k] ;
+
+    problem.rowLower_.resize(getNumRows()) ;
+    problem.rowUpper_.resize(getNumRows()) ;
+    for (int i = 0 ; i < model.getNumRows() ; i++) {
+        const double act = data.fixedActivity_[i] ;
+        const double rl = rowLowerOf(model, i) ;
+        const double ru = rowUpperOf(model, i) ;
+        const bool noLower = (rl <= -presolveInfinity) ;
+        const bool noUpper = (ru >= presolveInfinity) ;
+        const int r = data.rowIndex_[i] ;
+        if (r >= 0) {
+            problem.rowLower_[r] = noLower ? -COIN_DBL_MAX : rl-act ;
+            problem.rowUpper_[r] = noUpper ? COIN_DBL_MAX : ru-act ;
+        } else if (r == EmptyRow) {
+            if ((!noLower && below(act, rl)) || (!noUpper && below(ru, act)))
+                return (1) ;
+        } else {
+            const int c = data.singletonCol_[i] ;
+            const double a = data.singletonEl_[i] ;
+            double lo = noLower ? -COIN_DBL_MAX : (rl-act)/a ;
+            double hi = noUpper ? COIN_DBL_MAX : (ru-act)/a ;
+            if (a < 0.0) {
+                const double swap = lo ;
+                lo = (hi == COIN_DBL_MAX) ? -COIN_DBL_MAX : hi ;
+                hi = (swap == -COIN_DBL_MAX) ? COIN_DBL_MAX : swap ;
+            }
+            if (lo > problem.colLower_[c]) {
+                problem.colLower_[c] = lo ;
+                problem.lowerRow_[c] = i ;
+            }
+            if (hi < problem.colUpper_[c]) {
+                problem.colUpper_[c] = hi ;
+                problem.upperRow_[c] = i ;
+            }
+        }
+    }
+    for (int c = 0 ; c < numKept ; c++) {
+        if (below(problem.colUpper_[c], problem.colLower_[c])) return (1) ;
+    }
+    return (0) ;
+}
+
+/*
+  Fill full-length vectors, then hand them to SolutionView::fill. The duals
+  of singleton rows come first, as the reduced costs of the fixed columns
+  need every dual.
+*/
+int PresolvedProblem::postsolve (const SharedModel &model,
+                                 const double *colSolution,
+                                 const double *reducedCost,
+                                 const double *rowPrice, double objValue,
+                                 int iterationCount,
+                                 SolutionView &solution) const
+{
+    const int numCols = model.getNumCols() ;
+    const int numRows = model.getNumRows() ;
+    if (!presolve_.isValid()) return (-1) ;
+    if (numCols > solution.colCapacity_ || numRows > solution.rowCapacity_)
+        return (solution.fill(numCols, numRows, nullptr, nullptr, nullptr,
+                              nullptr, 0.0, 0)) ;
+    const Presolve::Data &data = *presolve_.data_ ;
+    const int numKept = getNumCols() ;
+    std::vector<double> x(numCols, 0.0) ;
+    std::vector<double> d(numCols, 0.0) ;
+    std::vector<double> y(numRows, 0.0) ;
+    std::vector<double> act(numRows, 0.0) ;
+    for (int c = 0 ; c < numKept ; c++) {
+        const int j = data.keptCols_[c] ;
+        x[j] = entryOr(colSolution, c, 0.0) ;
+        d[j] = entryOr(reducedCost, c, 0.0) ;
+    }
+    for (size_t k = 0 ; k < data.fixedCols_.size() ; k++)
+        x[data.fixedCols_[k]] = data.fixedValues_[k] ;
+    for (int r = 0 ; r < getNumRows() ; r++)
+        y[data.keptRows_[r]] = entryOr(rowPrice, r, 0.0) ;
+    /*
+      A singleton row holding its column at a bound takes the column's
+      reduced cost as its dual: d[j] = d'[j]-a*y[i] with d[j] = 0.
+    */
+    for (int i = 0 ; i < numRows ; i++) {
+        if (data.rowIndex_[i] != Presolve::SingletonRow) continue ;
+        const int c = data.singletonCol_[i] ;
+        const int j = data.keptCols_[c] ;
+        const bool atLower =
+            (lowerRow_[c] == i && atBound(x[j], colLower_[c])) ;
+        const bool atUpper =
+            (upperRow_[c] == i && atBound(x[j], colUpper_[c])) ;
+        if (!(atLower || atUpper) || d[j] == 0.0) continue ;
+        y[i] = d[j]/data.singletonEl_[i] ;
+        d[j] = 0.0 ;
+    }
+    /*
+      The fixed columns' reduced costs, c[j]-sum a[i,j]*y[i].
+    */
+    const int *start = model.getStarts() ;
+    const int *index = model.getIndices() ;
+    const double *value = model.getValues() ;
+    const double *obj = model.getObjective() ;
+    for (size_t k = 0 ; k < data.fixedCols_.size() ; k++) {
+        const int j = data.fixedCols_[k] ;
+        const int len = start[j+1]-start[j] ;
+        d[j] = entryOr(obj, j, 0.0) -
+               ((len > 0) ? kernelSparseDot(len, index+start[j],
+                                            value+start[j], &y[0]) : 0.0) ;
+    }
+    if (numRows > 0)
+        kernelColTimes(numCols, start, index, value, &x[0], numRows, &act[0]) ;
+    return (solution.fill(numCols, numRows, numCols ? &x[0] : nullptr,
+                          numCols ? &d[0] : nullptr,
+                          numRows ? &y[0] : nullptr,
+                          numRows ? &act[0] : nullptr,
+                          objValue+fixedObj_, iterationCount)) ;
+}
+
+PresolveCache::PresolveCache ()
+    : hits_(0),
+      misses_(0)
+{ }
+
+PresolveCache::~PresolveCache ()
+{ }
+
+/*
+  The presolve is made outside the lock. A thread that finds, once it has
+  made one, that another thread got there first takes the other's.
+*/
+int PresolveCache::presolve (const SharedModel &model,
+                             PresolvedProblem &problem)
+{
+    if (!model.isValid()) return (-1) ;
+    const uint64_t key = Presolve::keyOf(model) ;
+    Presolve found ;
+    {
+        ScopedLock lock(mutex_) ;
+        found = findLocked(key, model) ;
+        if (found.isValid()) hits_++ ;
+    }
+    if (!found.isValid()) {
+        Presolve made ;
+        Presolve::make(model, made) ;
+        ScopedLock lock(mutex_) ;
+        misses_++ ;
+        found = findLocked(key, model) ;
+        if (!found.isValid()) {
+            presolves_.insert(PresolveMap::value_type(key, made)) ;
+            found = made ;
+        }
+    }
+    return (found.reduce(model, problem)) ;
+}
+
+Presolve PresolveCache::findLocked (uint64_t key, const SharedModel &model)
+{
+    std::pair<PresolveMap::iterator, PresolveMap::iterator> range =
+        presolves_.equal_range(key) ;
+    for (PresolveMap::iterator iter = range.first ;
+         iter != range.second ; iter++) {
+        if (iter->second.suits(model)) return (iter->second) ;
+    }
+    return (Presolve()) ;
+}
+
+void PresolveCache::trim ()
+{
+    ScopedLock lock(mutex_) ;
+    PresolveMap::iterator iter = presolves_.begin() ;
+    while (iter != presolves_.end()) {
+        if (iter->second.getUseCount() > 1)
+            iter++ ;
+        else
+            presolves_.erase(iter++) ;
+    }
+}
+
+void PresolveCache::clear ()
+{
+    ScopedLock lock(mutex_) ;
+    presolves_.clear() ;
+}
+
+size_t PresolveCache::getNumPresolves () const
+{
+    ScopedLock lock(mutex_) ;
+    return (presolves_.size()) ;
+}
+
+size_t PresolveCache::getHits () const
+{
+    ScopedLock lock(mutex_) ;
+    return (hits_) ;
+}
+
+size_t PresolveCache::getMisses () const
+{
+    ScopedLock lock(mutex_) ;
+    return (misses_) ;
+}
+
+}  // end namespace Osi2
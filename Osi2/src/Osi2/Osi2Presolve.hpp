@@ -0,0 +1,357 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Presolve.hpp
+    \brief A presolve whose reductions and postsolve are kept and reused.
+
+  See Osi2::Presolve, Osi2::PresolveCache and
+  ControlAPI::initialSolvePresolved.
+*/
+
+#ifndef Osi2Presolve_HPP
+#define Osi2Presolve_HPP
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#include "Osi2ModelCache.hpp"
+#include "Osi2SolutionView.hpp"
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+class PresolvedProblem ;
+
+/*! \brief The reductions of a presolve, kept to be applied again
+
+  Presolve takes out of a model:
+  - fixed columns (equal, finite bounds), moving their part of each row
+    activity into the row bounds and their cost into a constant;
+  - rows left empty once the fixed columns are out, which only have to
+    hold at the fixed values;
+  - rows left with one coefficient (singleton rows), which become bounds
+    on their column.
+
+  None of these looks at the objective, and only the fixed columns depend
+  on the bounds; which rows are empty or singletons is a matter of the
+  matrix. So a Presolve made for one model suits every model with the same
+  matrix and the same columns fixed at the same values, whatever the
+  objective and the other bounds (#keyOf). #reduce then gives the reduced
+  problem for such a model in time linear in its rows and columns, the
+  reduced matrix coming from the Presolve, and PresolvedProblem::postsolve
+  maps a solution of it back to the full model, duals and reduced costs
+  included. The mapping is exact: an optimal basic solution of the
+  reduced problem maps to an optimal solution of the full one.
+
+  Like SharedModel, a Presolve is a read-only handle, shared by reference
+  count and safe to use from any number of threads. It holds a handle on
+  the model it was made from, to check models against.
+*/
+class Presolve {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; no presolve
+    Presolve () : data_(0) { }
+    /// Copy constructor; shares the presolve
+    Presolve (const Presolve &rhs) : data_(rhs.data_) {
+        if (data_ != 0) atomicAdd(&data_->refs_, 1) ;
+    }
+    /// Assignment; shares the presolve
+    Presolve &operator= (const Presolve &rhs) {
+        if (rhs.data_ != 0) atomicAdd(&rhs.data_->refs_, 1) ;
+        release() ;
+        data_ = rhs.data_ ;
+        return (*this) ;
+    }
+    /// Destructor; the last handle deletes the presolve
+    ~Presolve () {
+        release() ;
+    }
+    //@}
+
+    /*! \brief Presolve \p model
+
+      \returns 0 on success, -1 if \p model holds no model
+    */
+    static int make(const SharedModel &model, Presolve &presolve) ;
+
+    /*! \brief The key of the presolves that suit \p model
+
+      A hash of the matrix (SharedModel::getMatrixKey) and of the fixed
+      columns and their values. Linear in the columns.
+    */
+    static uint64_t keyOf(const SharedModel &model) ;
+
+    /*! \brief True if this presolve suits \p model
+
+      The key matches, and the matrix and the fixed columns are those of
+      the model the presolve was made from.
+    */
+    bool suits(const SharedModel &model) const ;
+
+    /*! \brief The reduced problem for \p model
+
+      \returns 0 on success; 1 if presolve shows \p model infeasible (a row
+      it took out can't hold, or a column's bounds cross), in which case
+      \p problem isn't to be solved; -1 if the presolve doesn't suit \p
+      model.
+    */
+    int reduce(const SharedModel &model, PresolvedProblem &problem) const ;
+
+    /// True if the handle holds a presolve
+    inline bool isValid () const { return (data_ != 0) ; }
+    /// Handles on the presolve, this one included; 0 for none
+    inline int getUseCount () const {
+        return ((data_ == 0) ? 0 : atomicLoad(&data_->refs_)) ;
+    }
+    /// Drop the presolve; the handle holds none after
+    void reset () {
+        release() ;
+        data_ = 0 ;
+    }
+
+    /// \name What presolve took out
+    //@{
+    /// The key (#keyOf) of the models this presolve suits
+    inline uint64_t getKey () const { return (data_->key_) ; }
+    /// Columns in the reduced problem
+    inline int getNumCols () const {
+        return (static_cast<int>(data_->keptCols_.size())) ;
+    }
+    /// Rows in the reduced problem
+    inline int getNumRows () const {
+        return (static_cast<int>(data_->keptRows_.size())) ;
+    }
+    /// Fixed columns taken out
+    inline int getNumFixed () const {
+        return (static_cast<int>(data_->fixedCols_.size())) ;
+    }
+    /// Rows taken out as empty
+    inline int getNumEmptyRows () const { return (data_->numEmpty_) ; }
+    /// Rows taken out as bounds on their column
+    inline int getNumSingletonRows () const {
+        return (data_->source_.getNumRows()-getNumRows()-getNumEmptyRows()) ;
+    }
+    //@}
+
+private:
+
+    friend class PresolvedProblem ;
+
+    /*! \brief What happened to a row
+
+      Kept rows are numbered from 0 in the reduced problem.
+    */
+    enum RowFate {
+        /// Empty once the fixed columns are out
+        EmptyRow = -1,
+        /// One coefficient left; a bound on its column
+        SingletonRow = -2
+    } ;
+
+    /// The presolve, and its count of handles
+    struct Data {
+        volatile int refs_ ;
+        uint64_t key_ ;
+        /// The model the presolve was made from
+        SharedModel source_ ;
+        /// Original index of each reduced column
+        std::vector<int> keptCols_ ;
+        /// Original index of each reduced row
+        std::vector<int> keptRows_ ;
+        /// Fixed columns, ascending, and their values
+        std::vector<int> fixedCols_ ;
+        std::vector<double> fixedValues_ ;
+        /// For each original row, its reduced index or a RowFate
+        std::vector<int> rowIndex_ ;
+        /// For each original row, the activity of the fixed columns in it
+        std::vector<double> fixedActivity_ ;
+        /// For each singleton row, its reduced column; -1 for other rows
+        std::vector<int> singletonCol_ ;
+        /// For each singleton row, its coefficient
+        std::vector<double> singletonEl_ ;
+        int numEmpty_ ;
+        /// The reduced matrix, column-major
+        std::vector<int> start_ ;
+        std::vector<int> index_ ;
+        std::vector<double> value_ ;
+    } ;
+
+    /// Let go of the presolve
+    inline void release () {
+        if (data_ != 0 && atomicAdd(&data_->refs_, -1) == 0) delete data_ ;
+    }
+
+    /// The presolve; null for none
+    Data *data_ ;
+
+} ;
+
+/*! \brief A reduced problem, and the way back from its solutions
+
+  Made by Presolve::reduce for one model. It has the getters of
+  SharedModel, so it loads like one (ControlAPI::loadPresolved); the
+  matrix belongs to the Presolve, the bounds and objective to the problem.
+*/
+class PresolvedProblem {
+
+public:
+
+    /// Constructor; no problem
+    PresolvedProblem () : fixedObj_(0.0) { }
+
+    /// The presolve this problem came from
+    inline const Presolve &getPresolve () const { return (presolve_) ; }
+
+    /// \name The reduced problem, as SharedModel has it
+    //@{
+    inline int getNumCols () const { return (presolve_.getNumCols()) ; }
+    inline int getNumRows () const { return (presolve_.getNumRows()) ; }
+    inline int getNumElements () const {
+        return (static_cast<int>(presolve_.data_->index_.size())) ;
+    }
+    inline const int *getStarts () const {
+        return (&presolve_.data_->start_[0]) ;
+    }
+    inline const int *getIndices () const {
+        return (dataOf(presolve_.data_->index_)) ;
+    }
+    inline const double *getValues () const {
+        return (dataOf(presolve_.data_->value_)) ;
+    }
+    inline const double *getColLower () const { return (dataOf(colLower_)) ; }
+    inline const double *getColUpper () const { return (dataOf(colUpper_)) ; }
+    inline const double *getObjective () const { return (dataOf(obj_)) ; }
+    inline const double *getRowLower () const { return (dataOf(rowLower_)) ; }
+    inline const double *getRowUpper () const { return (dataOf(rowUpper_)) ; }
+    /// 1 for each integer column, 0 otherwise; null if there are none
+    inline const char *getIntegerInfo () const { return (dataOf(integer_)) ; }
+    /// Cost of the fixed columns, added to the objective by #postsolve
+    inline double getFixedObjective () const { return (fixedObj_) ; }
+    //@}
+
+    /*! \brief Map a solution of the reduced problem back to \p model
+
+      \p model is the model given to Presolve::reduce. The reduced arrays
+      are those of the solver that solved this problem; a null one counts
+      as all zeros. The row activities are worked out from the full
+      matrix, and the objective value is \p objValue plus the cost of the
+      fixed columns. A singleton row gets the dual its column's reduced
+      cost implies if the column sits at the bound the row gave it, 0
+      otherwise.
+
+      \returns 0, or -1 if \p solution's buffers are too small for \p
+      model (as SolutionView::fill)
+    */
+    int postsolve(const SharedModel &model, const double *colSolution,
+                  const double *reducedCost, const double *rowPrice,
+                  double objValue, int iterationCount,
+                  SolutionView &solution) const ;
+
+    /// #postsolve the solution held by \p obj (an Osi1API, say)
+    template <class T>
+    inline int postsolve (const SharedModel &model, const T *obj,
+                          SolutionView &solution) const {
+        return (postsolve(model, obj->getColSolution(), obj->getReducedCost(),
+                          obj->getRowPrice(), obj->getObjValue(),
+                          obj->getIterationCount(), solution)) ;
+    }
+
+private:
+
+    friend class Presolve ;
+
+    /// The data of a vector; null if it's empty
+    template <typename T>
+    static inline const T *dataOf (const std::vector<T> &vec) {
+        return (vec.empty() ? 0 : &vec[0]) ;
+    }
+
+    Presolve presolve_ ;
+    std::vector<double> colLower_ ;
+    std::vector<double> colUpper_ ;
+    std::vector<double> obj_ ;
+    std::vector<double> rowLower_ ;
+    std::vector<double> rowUpper_ ;
+    /// Empty if no column is integer
+    std::vector<char> integer_ ;
+    /*! \brief The singleton rows that gave each reduced column its bounds
+
+      An original row index; -1 where the column keeps its own bound.
+    */
+    std::vector<int> lowerRow_ ;
+    std::vector<int> upperRow_ ;
+    double fixedObj_ ;
+
+} ;
+
+/*! \brief Presolves kept by key, for models loaded over and over
+
+  #presolve finds the presolve that suits a model (Presolve::keyOf and
+  Presolve::suits) or makes one and keeps it, then reduces the model.
+  Loading one base model again and again with a new objective, or new
+  bounds on columns that aren't fixed, presolves it once. All methods
+  are thread-safe; two threads presolving one new model at once may both
+  make the presolve, and the second is dropped. Equal keys are checked
+  against the matrix, so a collision costs a comparison and no more.
+*/
+class PresolveCache {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; an empty cache
+    PresolveCache() ;
+    /// Destructor; handles given out stay good
+    ~PresolveCache() ;
+    //@}
+
+    /*! \brief The reduced problem for \p model
+
+      \returns as Presolve::reduce, or -1 if \p model holds no model
+    */
+    int presolve(const SharedModel &model, PresolvedProblem &problem) ;
+
+    /// Let go of the presolves no one else has a handle on
+    void trim() ;
+    /// Let go of every presolve
+    void clear() ;
+    /// Presolves held
+    size_t getNumPresolves() const ;
+    /// Presolves that found one held
+    size_t getHits() const ;
+    /// Presolves that didn't
+    size_t getMisses() const ;
+
+private:
+
+    /// Copy constructor (not implemented)
+    PresolveCache(const PresolveCache &rhs) ;
+    /// Assignment (not implemented)
+    PresolveCache &operator=(const PresolveCache &rhs) ;
+
+    typedef std::multimap<uint64_t, Presolve> PresolveMap ;
+
+    /// The presolve held under \p key that suits \p model; none if none
+    Presolve findLocked(uint64_t key, const SharedModel &model) ;
+
+    /// Presolves by key
+    PresolveMap presolves_ ;
+    size_t hits_ ;
+    size_t misses_ ;
+    /// Guards everything
+    mutable Mutex mutex_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
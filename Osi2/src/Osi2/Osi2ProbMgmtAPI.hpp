@@ -9,6 +9,9 @@
 #define Osi2ProbMgmtAPI_HPP
 
 #include "Osi2API.hpp"
+#include "Osi2ApiTraits.hpp"
+#include "Osi2BatchResolve.hpp"
+#include "Osi2CancelToken.hpp"
 
 /*! \brief Proof of concept API.
 
@@ -28,11 +31,125 @@ public:
   int readMps(const char *filename, bool keepNames = false,
               bool ignoreErrors = false) = 0 ;
 
-  /// Solve an lp
+  /*! \brief Load a problem from arrays in memory
+
+    The constraint matrix is column-major (CSC): the entries of column \c j
+    are <tt>value[start[j]] .. value[start[j+1]-1]</tt>, in the rows given
+    by the same range of \p index, so \p start has \p numCols+1 entries.
+    Any of the bound and objective arrays can be null: column bounds then
+    default to [0, +inf), the objective to 0, and row bounds to
+    (-inf, +inf). The arrays are passed to the solver as they are; the
+    caller keeps them, and can reuse or free them once this returns.
+
+    \returns 0 on success; -1 if the problem can't be loaded (the default,
+    for implementations that don't support loading from memory).
+  */
+  virtual int loadProblem (int numCols, int numRows, const int *start,
+                           const int *index, const double *value,
+                           const double *colLower, const double *colUpper,
+                           const double *obj, const double *rowLower,
+                           const double *rowUpper)
+  { return (-1) ; }
+
+  /*! \brief As #loadProblem, taking ownership of the arrays
+
+    The arrays must have been allocated with <tt>new[]</tt>. They belong
+    to the object from the call on, whether or not the load succeeds: the
+    object frees them when it's done with them, and the caller's pointers
+    are set to null. This saves the caller keeping buffers it has no
+    further use for. The default loads the problem and then frees the
+    arrays.
+  */
+  virtual int assignProblem (int numCols, int numRows, int *&start,
+                             int *&index, double *&value, double *&colLower,
+                             double *&colUpper, double *&obj,
+                             double *&rowLower, double *&rowUpper)
+  {
+    const int retval = loadProblem(numCols, numRows, start, index, value,
+                                   colLower, colUpper, obj, rowLower,
+                                   rowUpper) ;
+    delete[] start ;
+    start = 0 ;
+    delete[] index ;
+    index = 0 ;
+    delete[] value ;
+    value = 0 ;
+    delete[] colLower ;
+    colLower = 0 ;
+    delete[] colUpper ;
+    colUpper = 0 ;
+    delete[] obj ;
+    obj = 0 ;
+    delete[] rowLower ;
+    rowLower = 0 ;
+    delete[] rowUpper ;
+    rowUpper = 0 ;
+    return (retval) ;
+  }
+
+  /*! \brief Write the problem to a binary snapshot at \p path
+
+    The snapshot (see ModelSnapshot) holds the matrix, bounds, objective
+    and integrality, and the names and basis when the object has them.
+    #readSnapshot loads it back by mapping the file, which is much cheaper
+    than parsing a text format.
+
+    \returns 0 on success; -1 on error (the default, for implementations
+    that don't support snapshots).
+  */
+  virtual int writeSnapshot (const char *path) { return (-1) ; }
+
+  /*! \brief Load the problem in the snapshot at \p path
+
+    Replaces the current problem; a basis in the snapshot becomes the
+    starting basis.
+
+    \returns 0 on success; -1 on error (the default).
+  */
+  virtual int readSnapshot (const char *path) { return (-1) ; }
+
+  /*! \brief Solve an lp
+
+    Returns clp's status codes: 0 optimal, 1 primal infeasible, 2 dual
+    infeasible, 3 stopped on a limit, 4 stopped on errors. A solve stopped
+    by its CancelToken returns 5 if the token was cancelled, 3 if the
+    deadline passed.
+  */
   virtual int initialSolve() = 0 ;
 
+  /*! \brief Re-solve under each of a batch of right-hand sides or
+	     objectives
+
+    The simple form of Osi1API::resolveBatch. \p variants holds
+    \p numVariants right-hand sides or objectives (see BatchKind), end to
+    end. Each is solved in turn, warm from the basis the one before left,
+    and its status (as #initialSolve) goes in \p statuses and its objective
+    in \p objValues, each of \p numVariants entries; if \p colSolutions
+    isn't null, the primal solutions go there, one column block of
+    numCols entries per variant. The problem's own right-hand side or
+    objective is restored at the end. Solve the problem once first.
+
+    \returns the number of variants solved to optimality; -1 on bad
+    arguments or if batches aren't supported (the default).
+  */
+  virtual int resolveBatch (BatchKind kind, int numVariants,
+                            const double *variants, int *statuses,
+                            double *objValues, double *colSolutions = 0)
+  { return (-1) ; }
+
+  /*! \brief Attach \p token to the object
+
+    Every solve from now on looks at the token, until another is attached.
+    Returns true if the object can stop a solve that's running; false if
+    it only looks at the token before a solve starts (the default, for
+    implementations that don't look at all).
+  */
+  virtual bool setCancelToken (const CancelToken &token) { return (false) ; }
+
 } ;
 
+OSI2_API_TRAITS(ProbMgmtAPI, "ProbMgmt", ApiID_ProbMgmt)
+
 }  // end namespace Osi2
 
 #endif
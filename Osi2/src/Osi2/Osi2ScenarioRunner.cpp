@@ -0,0 +1,221 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ScenarioRunner.cpp
+    \brief Method definitions for Osi2::ScenarioWorkers
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <stdint.h>
+
+#ifndef WIN32
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2PluginManager.hpp"
+#include "Osi2ScenarioRunner.hpp"
+
+namespace {
+
+/*
+  A report, as it travels from a worker: this header, then numSol_
+  doubles. Both ends are the same program, so the layout is shared.
+*/
+struct Report {
+    int64_t index_ ;
+    int64_t numSol_ ;
+    double objValue_ ;
+    int32_t status_ ;
+    int32_t iterations_ ;
+} ;
+
+}  // end file-local namespace
+
+namespace Osi2 {
+
+ScenarioWorkers::ScenarioWorkers (std::vector<ScenarioResult> &results)
+    : results_(results),
+      fd_(-1)
+{ }
+
+ScenarioWorkers::~ScenarioWorkers ()
+{
+    if (fd_ < 0 && !pids_.empty()) collect() ;
+}
+
+#ifdef WIN32
+
+int ScenarioWorkers::fork ()
+{
+    return (-1) ;
+}
+
+void ScenarioWorkers::send (size_t) { }
+
+void ScenarioWorkers::exitWorker () { }
+
+int ScenarioWorkers::collect ()
+{
+    return (0) ;
+}
+
+#else
+
+/*
+  The worker closes the read ends of the workers before it; they're no
+  business of its own.
+*/
+int ScenarioWorkers::fork ()
+{
+    int ends[2] ;
+    if (::pipe(ends) != 0) return (-1) ;
+    const int pid = PluginManager::getInstance().forkProcess() ;
+    if (pid < 0) {
+        ::close(ends[0]) ;
+        ::close(ends[1]) ;
+        return (-1) ;
+    }
+    if (pid == 0) {
+        ::close(ends[0]) ;
+        for (size_t i = 0 ; i < fds_.size() ; i++) ::close(fds_[i]) ;
+        fds_.clear() ;
+        pids_.clear() ;
+        fd_ = ends[1] ;
+        return (1) ;
+    }
+    ::close(ends[1]) ;
+    fds_.push_back(ends[0]) ;
+    pids_.push_back(pid) ;
+    return (0) ;
+}
+
+/*
+  A write that fails leaves the parent short of a report; the scenario
+  stays NotRun there. Nothing better to do about it here.
+*/
+void ScenarioWorkers::send (size_t ndx)
+{
+    const ScenarioResult &result = results_[ndx] ;
+    Report report ;
+    std::memset(&report, 0, sizeof(report)) ;
+    report.index_ = static_cast<int64_t>(ndx) ;
+    report.numSol_ = static_cast<int64_t>(result.colSolution_.size()) ;
+    report.objValue_ = result.objValue_ ;
+    report.status_ = static_cast<int32_t>(result.status_) ;
+    report.iterations_ = result.iterations_ ;
+    std::vector<char> buf(sizeof(report)+
+                          result.colSolution_.size()*sizeof(double)) ;
+    std::memcpy(&buf[0], &report, sizeof(report)) ;
+    if (!result.colSolution_.empty())
+        std::memcpy(&buf[sizeof(report)], &result.colSolution_[0],
+                    result.colSolution_.size()*sizeof(double)) ;
+    size_t done = 0 ;
+    while (done < buf.size()) {
+        const ssize_t len = ::write(fd_, &buf[done], buf.size()-done) ;
+        if (len < 0 && errno == EINTR) continue ;
+        if (len <= 0) return ;
+        done += static_cast<size_t>(len) ;
+    }
+}
+
+void ScenarioWorkers::exitWorker ()
+{
+    ::close(fd_) ;
+    ::_exit(0) ;
+}
+
+/*
+  Read from all the workers at once, so that none waits on a full pipe
+  while we read another. Reports are taken apart only once a worker's pipe
+  is closed.
+*/
+int ScenarioWorkers::collect ()
+{
+    const size_t numWorkers = fds_.size() ;
+    std::vector<std::vector<char> > bufs(numWorkers) ;
+    std::vector<struct pollfd> open(numWorkers) ;
+    for (size_t i = 0 ; i < numWorkers ; i++) {
+        open[i].fd = fds_[i] ;
+        open[i].events = POLLIN ;
+        open[i].revents = 0 ;
+    }
+    size_t numOpen = numWorkers ;
+    char chunk[1<<16] ;
+    while (numOpen > 0) {
+        if (::poll(&open[0], numWorkers, -1) < 0) {
+            if (errno == EINTR) continue ;
+            break ;
+        }
+        for (size_t i = 0 ; i < numWorkers ; i++) {
+            if (open[i].fd < 0 || open[i].revents == 0) continue ;
+            const ssize_t len = ::read(open[i].fd, chunk, sizeof(chunk)) ;
+            if (len < 0 && errno == EINTR) continue ;
+            if (len > 0) {
+                bufs[i].insert(bufs[i].end(), chunk, chunk+len) ;
+                continue ;
+            }
+            ::close(open[i].fd) ;
+            open[i].fd = -1 ;
+            numOpen-- ;
+        }
+    }
+    for (size_t i = 0 ; i < numWorkers ; i++) {
+        if (open[i].fd >= 0) ::close(open[i].fd) ;
+    }
+    int failed = 0 ;
+    for (size_t i = 0 ; i < numWorkers ; i++) {
+        unpack(bufs[i]) ;
+        int status = 0 ;
+        pid_t reaped ;
+        do {
+            reaped = ::waitpid(static_cast<pid_t>(pids_[i]), &status, 0) ;
+        } while (reaped < 0 && errno == EINTR) ;
+        if (reaped < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed++ ;
+    }
+    fds_.clear() ;
+    pids_.clear() ;
+    return (failed) ;
+}
+
+#endif
+
+/*
+  A report cut short is dropped, and so is everything after it.
+*/
+void ScenarioWorkers::unpack (const std::vector<char> &buf)
+{
+    size_t pos = 0 ;
+    while (pos+sizeof(Report) <= buf.size()) {
+        Report report ;
+        std::memcpy(&report, &buf[pos], sizeof(report)) ;
+        pos += sizeof(report) ;
+        if (report.index_ < 0 ||
+                report.index_ >= static_cast<int64_t>(results_.size()) ||
+                report.numSol_ < 0 ||
+                static_cast<uint64_t>(report.numSol_) >
+                    (buf.size()-pos)/sizeof(double))
+            return ;
+        ScenarioResult &result = results_[static_cast<size_t>(report.index_)] ;
+        result.status_ = static_cast<ScenarioResult::Status>(report.status_) ;
+        result.objValue_ = report.objValue_ ;
+        result.iterations_ = report.iterations_ ;
+        const size_t numSol = static_cast<size_t>(report.numSol_) ;
+        result.colSolution_.resize(numSol) ;
+        if (numSol > 0)
+            std::memcpy(&result.colSolution_[0], &buf[pos],
+                        numSol*sizeof(double)) ;
+        pos += numSol*sizeof(double) ;
+    }
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,204 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ScenarioRunner.hpp
+    \brief Solve variants of one loaded model in forked worker processes.
+
+  See ControlAPI::runScenarios.
+*/
+
+#ifndef Osi2ScenarioRunner_HPP
+#define Osi2ScenarioRunner_HPP
+
+#include <vector>
+
+#include "CoinWarmStart.hpp"
+
+#include "Osi2ModelDelta.hpp"
+
+namespace Osi2 {
+
+/// What came of solving one scenario
+struct ScenarioResult {
+    /// Outcome of the solve
+    enum Status {
+        /// Proven optimal
+        Optimal = 0,
+        /// Proven primal infeasible, or the dual objective limit was reached
+        Infeasible,
+        /// Stopped for some other reason
+        Stopped,
+        /// Not solved (the worker died before it reported)
+        NotRun
+    } ;
+    /// Constructor
+    ScenarioResult ()
+      : status_(NotRun),
+        objValue_(0.0),
+        iterations_(0)
+    { }
+    /// Outcome of the solve
+    Status status_ ;
+    /// Objective value at the end of the solve
+    double objValue_ ;
+    /// Iterations taken
+    int iterations_ ;
+    /// The primal solution, if asked for; empty otherwise
+    std::vector<double> colSolution_ ;
+} ;
+
+/*! \brief The worker processes of a scenario run
+
+  #fork starts a worker, a copy of the calling process that shares its
+  memory copy-on-write: the solver object, with its model and basis, is the
+  parent's until the worker writes to it, so a worker costs the pages it
+  changes rather than a copy of the model. A worker reports each result
+  with #send and ends with #exitWorker. #collect, in the parent, waits for
+  the workers and puts what they sent in the results.
+
+  The fork goes through PluginManager::forkProcess, so the plugin
+  manager's locks are in a known state on both sides. Not supported on
+  Windows, where #fork always fails.
+*/
+class ScenarioWorkers {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; the workers report into \p results
+    explicit ScenarioWorkers(std::vector<ScenarioResult> &results) ;
+    /// Destructor; collects any workers not yet collected
+    ~ScenarioWorkers() ;
+    //@}
+
+    /*! \brief Start a worker
+
+      \returns 1 in the worker, 0 in the parent, -1 if no worker could be
+      started.
+    */
+    int fork() ;
+
+    /// In a worker: report the result for scenario \p ndx
+    void send(size_t ndx) ;
+
+    /// In a worker: end the process, without running destructors
+    void exitWorker() ;
+
+    /*! \brief In the parent: wait for the workers to finish
+
+      Results come in as the workers send them; a worker that dies leaves
+      the rest of its scenarios NotRun.
+
+      \returns the number of workers that didn't exit normally
+    */
+    int collect() ;
+
+private:
+
+    /// Copy constructor (not implemented)
+    ScenarioWorkers(const ScenarioWorkers &rhs) ;
+    /// Assignment (not implemented)
+    ScenarioWorkers &operator=(const ScenarioWorkers &rhs) ;
+
+    /// Take apart the reports in \p buf
+    void unpack(const std::vector<char> &buf) ;
+
+    /// Where results go
+    std::vector<ScenarioResult> &results_ ;
+    /// In the parent, the read end of each worker's pipe
+    std::vector<int> fds_ ;
+    /// In the parent, each worker's process id
+    std::vector<int> pids_ ;
+    /// In a worker, the write end of its pipe; -1 in the parent
+    int fd_ ;
+
+} ;
+
+/*! \brief Solve a share of the scenarios, one after another, on one object
+
+  Solves scenarios #first_, #first_+#stride_, ... each from the basis the
+  object had at the start: the scenario's delta is applied, the object
+  resolved, and the delta undone. Made by ControlAPI::runScenarios, to run
+  in a worker (which reports each result through #workers_) or, if no
+  worker could be started, in the calling process.
+
+  For any API with the methods ModelDelta uses, \c getWarmStart, \c
+  setWarmStart, \c resolve and the usual status queries (Osi1API).
+*/
+template <class T>
+class ScenarioJob {
+
+public:
+
+    /// Constructor; \p workers is null when run in the calling process
+    ScenarioJob (T *obj, const std::vector<ModelDelta> &scenarios,
+                 std::vector<ScenarioResult> &results, int first, int stride,
+                 bool keepSolution, ScenarioWorkers *workers)
+      : obj_(obj),
+        scenarios_(scenarios),
+        results_(results),
+        first_(first),
+        stride_(stride),
+        keepSolution_(keepSolution),
+        workers_(workers)
+    { }
+
+    /// Solve the share; the object is left with its model and basis as found
+    void run () {
+        CoinWarmStart *basis = obj_->getWarmStart() ;
+        ModelDelta undo ;
+        for (size_t k = first_ ; k < scenarios_.size() ; k += stride_) {
+            if (basis != 0) obj_->setWarmStart(basis) ;
+            scenarios_[k].apply(obj_, &undo) ;
+            obj_->resolve() ;
+            record(results_[k]) ;
+            undo.apply(obj_) ;
+            if (workers_ != 0) workers_->send(k) ;
+        }
+        if (basis != 0) obj_->setWarmStart(basis) ;
+        delete basis ;
+    }
+
+private:
+
+    /// Record the outcome of the last solve
+    void record (ScenarioResult &result) {
+        if (obj_->isProvenOptimal())
+            result.status_ = ScenarioResult::Optimal ;
+        else if (obj_->isProvenPrimalInfeasible() ||
+                 obj_->isDualObjectiveLimitReached())
+            result.status_ = ScenarioResult::Infeasible ;
+        else
+            result.status_ = ScenarioResult::Stopped ;
+        result.objValue_ = obj_->getObjValue() ;
+        result.iterations_ = obj_->getIterationCount() ;
+        if (keepSolution_) {
+            const double *x = obj_->getColSolution() ;
+            if (x != 0) result.colSolution_.assign(x, x+obj_->getNumCols()) ;
+        }
+    }
+
+    /// The object
+    T *obj_ ;
+    /// The scenarios
+    const std::vector<ModelDelta> &scenarios_ ;
+    /// Results for the scenarios; this job fills its share
+    std::vector<ScenarioResult> &results_ ;
+    /// Index of the first scenario for this job
+    size_t first_ ;
+    /// Distance between this job's scenarios
+    size_t stride_ ;
+    /// True to keep the primal solution of each scenario
+    bool keepSolution_ ;
+    /// The workers, when this job runs in one
+    ScenarioWorkers *workers_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
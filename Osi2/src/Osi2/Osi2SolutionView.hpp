@@ -0,0 +1,168 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolutionView.hpp
+    \brief Declarations for Osi2::SolutionView and Osi2::SolutionBuffer.
+
+  A solution taken from a solver in one call (Osi1API::getSolutionBundle)
+  into buffers that belong to the caller.
+*/
+
+#ifndef Osi2SolutionView_HPP
+#define Osi2SolutionView_HPP
+
+#include <cstring>
+#include <vector>
+
+namespace Osi2 {
+
+/*! \brief A solution, copied out of a solver in one call
+
+  Filled by Osi1API::getSolutionBundle. The caller supplies the buffers:
+  column buffers (#colSolution_, #reducedCost_) of at least #colCapacity_
+  entries, row buffers (#rowPrice_, #rowActivity_) of at least
+  #rowCapacity_. A buffer left null is not filled. SolutionBuffer will
+  supply the lot in one block.
+*/
+struct SolutionView {
+
+    /// Default constructor; no buffers
+    SolutionView ()
+      : colSolution_(0),
+        reducedCost_(0),
+        rowPrice_(0),
+        rowActivity_(0),
+        colCapacity_(0),
+        rowCapacity_(0),
+        numCols_(0),
+        numRows_(0),
+        objValue_(0.0),
+        iterationCount_(0)
+    { }
+
+    /*! \brief Copy a solution into the buffers
+
+      Filled in by the solver. The dimensions are always set. If the
+      problem doesn't fit in the buffers, nothing else is and the return
+      is -1; otherwise each buffer given is filled and the return is 0. A
+      null solver array (no solution yet) fills its buffer with zeros.
+    */
+    inline int fill (int numCols, int numRows, const double *colSolution,
+                     const double *reducedCost, const double *rowPrice,
+                     const double *rowActivity, double objValue,
+                     int iterationCount) {
+        numCols_ = numCols ;
+        numRows_ = numRows ;
+        if (numCols > colCapacity_ || numRows > rowCapacity_)
+            return (-1) ;
+        copy(colSolution_, colSolution, numCols) ;
+        copy(reducedCost_, reducedCost, numCols) ;
+        copy(rowPrice_, rowPrice, numRows) ;
+        copy(rowActivity_, rowActivity, numRows) ;
+        objValue_ = objValue ;
+        iterationCount_ = iterationCount ;
+        return (0) ;
+    }
+
+    /*! \name Buffers supplied by the caller */
+    //@{
+    /// Primal column values, \c getColSolution()
+    double *colSolution_ ;
+    /// Reduced costs, \c getReducedCost()
+    double *reducedCost_ ;
+    /// Row duals, \c getRowPrice()
+    double *rowPrice_ ;
+    /// Row activity levels, \c getRowActivity()
+    double *rowActivity_ ;
+    /// Entries available in each column buffer
+    int colCapacity_ ;
+    /// Entries available in each row buffer
+    int rowCapacity_ ;
+    //@}
+
+    /*! \name Filled in by the solver */
+    //@{
+    /// Number of columns in the problem
+    int numCols_ ;
+    /// Number of rows in the problem
+    int numRows_ ;
+    /// Objective value, \c getObjValue()
+    double objValue_ ;
+    /// Iterations of the last solve, \c getIterationCount()
+    int iterationCount_ ;
+    //@}
+
+private:
+
+    /// Copy \p n entries of \p src to \p dst, unless \p dst is null
+    static inline void copy (double *dst, const double *src, int n) {
+        if (dst == 0 || n <= 0) return ;
+        if (src == 0)
+            std::memset(dst, 0, n*sizeof(double)) ;
+        else
+            std::memcpy(dst, src, n*sizeof(double)) ;
+    }
+} ;
+
+/*! \brief Storage for a SolutionView, in one block
+
+  The four vectors are kept end to end in a single block: column
+  solution, reduced costs, row duals, row activities. A transport can send
+  the block (#data, #size) as it stands. The block is reused from call to
+  call and only grows.
+*/
+class SolutionBuffer {
+
+public:
+
+    /// Default constructor; no storage until #view is called
+    SolutionBuffer () { }
+
+    /*! \brief A view with buffers for a problem of the size given
+
+      The view's buffers point into this object's block, and are good
+      until the next call to #view or the object is destroyed.
+    */
+    inline SolutionView &view (int numCols, int numRows) {
+        const size_t need = 2*static_cast<size_t>(numCols) +
+                            2*static_cast<size_t>(numRows) ;
+        if (block_.size() < need) block_.resize(need) ;
+        double *base = block_.empty() ? 0 : &block_[0] ;
+        view_.colCapacity_ = numCols ;
+        view_.rowCapacity_ = numRows ;
+        view_.colSolution_ = base ;
+        view_.reducedCost_ = (base == 0) ? 0 : base+numCols ;
+        view_.rowPrice_ = (base == 0) ? 0 : base+2*numCols ;
+        view_.rowActivity_ = (base == 0) ? 0 : base+2*numCols+numRows ;
+        return (view_) ;
+    }
+
+    /// The view last returned by #view
+    inline const SolutionView &getView () const { return (view_) ; }
+
+    /// The block
+    inline const double *data () const {
+        return (block_.empty() ? 0 : &block_[0]) ;
+    }
+
+    /// Entries in the block, as laid out by the last call to #view
+    inline size_t size () const {
+        return (2*static_cast<size_t>(view_.colCapacity_) +
+                2*static_cast<size_t>(view_.rowCapacity_)) ;
+    }
+
+private:
+
+    /// The block
+    std::vector<double> block_ ;
+
+    /// The view into #block_
+    SolutionView view_ ;
+} ;
+
+}  // end namespace Osi2
+
+#endif
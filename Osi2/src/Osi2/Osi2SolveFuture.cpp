@@ -0,0 +1,108 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolveFuture.cpp
+    \brief Method definitions for Osi2::SolveFuture
+*/
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2SolveFuture.hpp"
+#include "Osi2SolvePool.hpp"
+#include "Osi2PerfStats.hpp"
+
+namespace Osi2 {
+
+SolveFuture::SolveFuture ()
+    : task_(nullptr)
+{ }
+
+SolveFuture::SolveFuture (SolveTask *task)
+    : task_(task)
+{
+    if (task_ != nullptr) task_->retain() ;
+}
+
+SolveFuture::SolveFuture (const SolveFuture &rhs)
+    : task_(rhs.task_)
+{
+    if (task_ != nullptr) task_->retain() ;
+}
+
+SolveFuture &SolveFuture::operator= (const SolveFuture &rhs)
+{
+    if (rhs.task_ != nullptr) rhs.task_->retain() ;
+    if (task_ != nullptr) task_->release() ;
+    task_ = rhs.task_ ;
+    return (*this) ;
+}
+
+SolveFuture::~SolveFuture ()
+{
+    if (task_ != nullptr) task_->release() ;
+}
+
+SolveFuture::State SolveFuture::getState () const
+{
+    if (task_ == nullptr) return (Invalid) ;
+    ScopedLock lock(task_->mutex_) ;
+    return (task_->state_) ;
+}
+
+bool SolveFuture::poll () const
+{
+    const State state = getState() ;
+    return (state == Done || state == Cancelled) ;
+}
+
+/*
+  Wakeups can be spurious, so wait against a deadline.
+*/
+bool SolveFuture::wait (int millisecs) const
+{
+    if (task_ == nullptr) return (false) ;
+    ScopedLock lock(task_->mutex_) ;
+    if (millisecs < 0) {
+        while (task_->state_ == Pending || task_->state_ == Running)
+            task_->changed_.wait(task_->mutex_) ;
+        return (true) ;
+    }
+    const uint64_t ticksPerMillisec = 1000000 ;
+    const uint64_t deadline =
+        PerfStats::now() + static_cast<uint64_t>(millisecs)*ticksPerMillisec ;
+    while (task_->state_ == Pending || task_->state_ == Running) {
+        const uint64_t now = PerfStats::now() ;
+        if (now >= deadline) return (false) ;
+        const uint64_t left =
+            (deadline-now+ticksPerMillisec-1)/ticksPerMillisec ;
+        task_->changed_.waitFor(task_->mutex_, static_cast<int>(left)) ;
+    }
+    return (true) ;
+}
+
+/*
+  The task stays in the pool's queue; the thread that takes it sees that
+  it's been cancelled and lets it go.
+*/
+bool SolveFuture::cancel ()
+{
+    if (task_ == nullptr) return (false) ;
+    ScopedLock lock(task_->mutex_) ;
+    if (task_->state_ == Pending) {
+        task_->state_ = Cancelled ;
+        task_->changed_.wakeAll() ;
+    }
+    return (task_->state_ == Cancelled) ;
+}
+
+int SolveFuture::getStatus () const
+{
+    if (task_ == nullptr) return (-1) ;
+    ScopedLock lock(task_->mutex_) ;
+    return ((task_->state_ == Done) ? task_->status_ : -1) ;
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,172 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolveFuture.hpp
+    \brief Solves run in the background, and the futures to watch them by.
+
+  See Osi2::SolveFuture and ControlAPI::initialSolveAsync.
+*/
+
+#ifndef Osi2SolveFuture_HPP
+#define Osi2SolveFuture_HPP
+
+namespace Osi2 {
+
+struct SolveTask ;
+
+/*! \brief A piece of work for the control API's solve threads
+
+  See ControlAPI::submitAsync. The value returned by #run becomes the
+  status of the job's SolveFuture.
+*/
+class AsyncJob {
+
+public:
+
+    /// Virtual destructor
+    virtual ~AsyncJob() {}
+
+    /// Do the work; returns a status
+    virtual int run() = 0 ;
+
+} ;
+
+/*! \name Solve jobs
+
+  Jobs that call \c initialSolve or \c resolve on an object, for any API
+  that has them. A method that returns a status (ProbMgmtAPI::initialSolve)
+  passes it on; one that returns nothing (Osi1API::initialSolve) counts as
+  status 0. Made by ControlAPI::initialSolveAsync and
+  ControlAPI::resolveAsync.
+*/
+//@{
+
+/// Call a solve method that returns a status
+template <class T, class B>
+inline int callSolveMethod (T *obj, int (B::*method)())
+{
+    return ((obj->*method)()) ;
+}
+
+/// Call a solve method that returns nothing
+template <class T, class B>
+inline int callSolveMethod (T *obj, void (B::*method)())
+{
+    (obj->*method)() ;
+    return (0) ;
+}
+
+/// Call \c initialSolve on an object
+template <class T>
+class InitialSolveJob : public AsyncJob {
+public:
+    explicit InitialSolveJob (T *obj) : obj_(obj) { }
+    int run () { return (callSolveMethod(obj_, &T::initialSolve)) ; }
+private:
+    T *obj_ ;
+} ;
+
+/// Call \c resolve on an object
+template <class T>
+class ResolveJob : public AsyncJob {
+public:
+    explicit ResolveJob (T *obj) : obj_(obj) { }
+    int run () { return (callSolveMethod(obj_, &T::resolve)) ; }
+private:
+    T *obj_ ;
+} ;
+
+//@}
+
+/*! \brief A handle on a job running in the background
+
+  Returned by ControlAPI::submitAsync and friends. Watch the job with
+  #poll or #wait, and collect its status with #getStatus once it's done. A
+  job can be withdrawn with #cancel until it starts. To stop a solve once
+  it's running, attach a CancelToken to its object beforehand
+  (ProbMgmtAPI::setCancelToken, Osi1API::setCancelToken) and cancel that.
+
+  Futures are cheap to copy; all copies refer to the same job. The job's
+  object must outlive the job, but the future can outlive both, and the
+  control API that ran them.
+*/
+class SolveFuture {
+
+public:
+
+    /// Where the job is
+    enum State {
+        /// The future refers to no job
+        Invalid = 0,
+        /// Waiting for a thread
+        Pending,
+        /// Running
+        Running,
+        /// Finished; #getStatus has the status
+        Done,
+        /// Withdrawn before it started
+        Cancelled
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Default constructor; an invalid future
+    SolveFuture() ;
+    /*! \brief Referring to \p task
+
+      For control API implementations. The future takes a reference to the
+      task.
+    */
+    explicit SolveFuture(SolveTask *task) ;
+    /// Copy constructor
+    SolveFuture(const SolveFuture &rhs) ;
+    /// Assignment
+    SolveFuture &operator=(const SolveFuture &rhs) ;
+    /// Destructor
+    ~SolveFuture() ;
+    //@}
+
+    /// \name The job
+    //@{
+    /// True if the future refers to a job
+    inline bool isValid () const {
+        return (task_ != 0) ;
+    }
+
+    /// Where the job is now
+    State getState() const ;
+
+    /// True if the job is done or cancelled; doesn't wait
+    bool poll() const ;
+
+    /*! \brief Wait until the job is done or cancelled
+
+      Waits for no more than \p millisecs milliseconds; a negative value
+      means as long as it takes. Returns true if the job is done or
+      cancelled, false if the time ran out (and for an invalid future).
+    */
+    bool wait(int millisecs = -1) const ;
+
+    /*! \brief Withdraw the job if it hasn't started
+
+      Returns true if the job is cancelled (now, or before).
+    */
+    bool cancel() ;
+
+    /// The status of a job that is Done; -1 otherwise
+    int getStatus() const ;
+    //@}
+
+private:
+
+    /// The job; null for an invalid future
+    SolveTask *task_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
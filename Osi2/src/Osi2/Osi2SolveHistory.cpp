@@ -0,0 +1,247 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolveHistory.cpp
+    \brief Method definitions for Osi2::SolveHistory
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2SolveHistory.hpp"
+
+namespace {
+
+/// The first line of a history file
+const char historyMagic[] = "OSI2HIST 1" ;
+
+/// floor(log2(n)) for n > 0, capped at \p cap; 0 for n <= 0
+uint32_t log2Class (double n, uint32_t cap)
+{
+    uint32_t cls = 0 ;
+    while (n >= 2.0 && cls < cap) {
+        n /= 2.0 ;
+        cls++ ;
+    }
+    return (cls) ;
+}
+
+}  // end file-local namespace
+
+namespace Osi2 {
+
+const int SolveHistory::maxWeight ;
+
+SolveHistory::SolveHistory ()
+    : epsilon_(0.05),
+      rng_(2463534242u),
+      tmpSerial_(0)
+{ }
+
+SolveHistory::~SolveHistory ()
+{ }
+
+/*
+  Five bits each for rows and columns, four for the density, two for
+  integrality.
+*/
+uint32_t SolveHistory::classOf (const Features &features)
+{
+    const double rows = (features.numRows_ > 0) ? features.numRows_ : 0 ;
+    const double cols = (features.numCols_ > 0) ? features.numCols_ : 0 ;
+    const double full = rows*cols ;
+    const double elems = static_cast<double>(features.numElements_) ;
+    const uint32_t sparse =
+        (full > 0 && elems > 0) ? log2Class(full/elems, 15) : 0 ;
+    uint32_t integral = 0 ;
+    if (features.numIntegers_ > 0)
+        integral = (10.0*features.numIntegers_ < cols) ? 1 : 2 ;
+    return ((log2Class(rows, 31) << 11) | (log2Class(cols, 31) << 6) |
+            (sparse << 2) | integral) ;
+}
+
+int SolveHistory::setFile (const std::string &path)
+{
+    EntryMap entries ;
+    int found = 0 ;
+    if (!path.empty()) {
+        found = readFile(path, entries) ;
+        if (found < 0) return (-1) ;
+        if (found == 0) {
+            ScopedLock lock(mutex_) ;
+            entries = entries_ ;
+        }
+        if (!writeFile(path, entries)) return (-1) ;
+    }
+    ScopedLock lock(mutex_) ;
+    path_ = path ;
+    if (found > 0) entries_.swap(entries) ;
+    return (0) ;
+}
+
+std::string SolveHistory::getFile () const
+{
+    ScopedLock lock(mutex_) ;
+    return (path_) ;
+}
+
+void SolveHistory::setExploration (double epsilon)
+{
+    ScopedLock lock(mutex_) ;
+    epsilon_ = (epsilon < 0.0) ? 0.0 : ((epsilon > 1.0) ? 1.0 : epsilon) ;
+}
+
+double SolveHistory::getExploration () const
+{
+    ScopedLock lock(mutex_) ;
+    return (epsilon_) ;
+}
+
+void SolveHistory::setSeed (uint32_t seed)
+{
+    ScopedLock lock(mutex_) ;
+    rng_ = (seed == 0) ? 2463534242u : seed ;
+}
+
+double SolveHistory::uniform ()
+{
+    rng_ ^= rng_ << 13 ;
+    rng_ ^= rng_ >> 17 ;
+    rng_ ^= rng_ << 5 ;
+    return (rng_/4294967296.0) ;
+}
+
+/*
+  Write outside the lock, from a copy; a solve just finished shouldn't wait
+  on another's file.
+*/
+void SolveHistory::record (const Features &features, const std::string &lib,
+                           double seconds, bool solved)
+{
+    if (seconds < 0.0) seconds = 0.0 ;
+    if (!solved) seconds = 10.0*seconds+1.0 ;
+    EntryMap snapshot ;
+    std::string path ;
+    {
+        ScopedLock lock(mutex_) ;
+        Entry &entry = entries_[Key(classOf(features), lib)] ;
+        if (entry.count_ < maxWeight) entry.count_++ ;
+        entry.meanSecs_ += (seconds-entry.meanSecs_)/entry.count_ ;
+        if (path_.empty()) return ;
+        path = path_ ;
+        snapshot = entries_ ;
+    }
+    writeFile(path, snapshot) ;
+}
+
+int SolveHistory::choose (const Features &features,
+                          const std::vector<std::string> &libs,
+                          bool *explored)
+{
+    if (explored != nullptr) *explored = false ;
+    if (libs.empty()) return (-1) ;
+    const uint32_t cls = classOf(features) ;
+    ScopedLock lock(mutex_) ;
+    int best = -1 ;
+    double bestSecs = 0.0 ;
+    for (size_t i = 0 ; i < libs.size() ; i++) {
+        EntryMap::const_iterator iter = entries_.find(Key(cls, libs[i])) ;
+        if (iter == entries_.end()) {
+            if (explored != nullptr) *explored = true ;
+            return (static_cast<int>(i)) ;
+        }
+        if (best < 0 || iter->second.meanSecs_ < bestSecs) {
+            best = static_cast<int>(i) ;
+            bestSecs = iter->second.meanSecs_ ;
+        }
+    }
+    if (libs.size() > 1 && uniform() < epsilon_) {
+        if (explored != nullptr) *explored = true ;
+        return (static_cast<int>(uniform()*libs.size())) ;
+    }
+    return (best) ;
+}
+
+int SolveHistory::getRecord (const Features &features, const std::string &lib,
+                             double &meanSecs) const
+{
+    meanSecs = 0.0 ;
+    ScopedLock lock(mutex_) ;
+    EntryMap::const_iterator iter = entries_.find(Key(classOf(features), lib)) ;
+    if (iter == entries_.end()) return (0) ;
+    meanSecs = iter->second.meanSecs_ ;
+    return (iter->second.count_) ;
+}
+
+void SolveHistory::clear ()
+{
+    ScopedLock lock(mutex_) ;
+    entries_.clear() ;
+}
+
+/*
+  One record per line: class, library, count, mean seconds. An empty file
+  counts as no file; lines that don't parse are skipped.
+*/
+int SolveHistory::readFile (const std::string &path, EntryMap &entries)
+{
+    std::ifstream file(path.c_str()) ;
+    if (!file) return (0) ;
+    std::string line ;
+    if (!std::getline(file, line)) return (0) ;
+    if (line != historyMagic) return (-1) ;
+    while (std::getline(file, line)) {
+        std::istringstream words(line) ;
+        uint32_t cls ;
+        std::string lib ;
+        Entry entry ;
+        if (!(words >> cls >> lib >> entry.count_ >> entry.meanSecs_)) continue ;
+        if (entry.count_ <= 0) continue ;
+        if (entry.count_ > maxWeight) entry.count_ = maxWeight ;
+        entries[Key(cls, lib)] = entry ;
+    }
+    return (1) ;
+}
+
+bool SolveHistory::writeFile (const std::string &path, const EntryMap &entries)
+{
+    std::ostringstream tmpPath ;
+    {
+        ScopedLock lock(mutex_) ;
+        tmpPath << path << "." << getpid() << "." << tmpSerial_++ << ".tmp" ;
+    }
+    FILE *file = std::fopen(tmpPath.str().c_str(), "w") ;
+    if (file == nullptr) return (false) ;
+    bool ok = (std::fprintf(file, "%s\n", historyMagic) > 0) ;
+    for (EntryMap::const_iterator iter = entries.begin() ;
+         ok && iter != entries.end() ; iter++) {
+        ok = (std::fprintf(file, "%u %s %d %.17g\n",
+                           static_cast<unsigned int>(iter->first.first),
+                           iter->first.second.c_str(), iter->second.count_,
+                           iter->second.meanSecs_) > 0) ;
+    }
+    ok = (std::fclose(file) == 0) && ok ;
+#   ifdef WIN32
+    if (ok) std::remove(path.c_str()) ;
+#   endif
+    if (!ok || std::rename(tmpPath.str().c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.str().c_str()) ;
+        return (false) ;
+    }
+    return (true) ;
+}
+
+}  // end namespace Osi2
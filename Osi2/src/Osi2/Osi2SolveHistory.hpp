@@ -0,0 +1,190 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolveHistory.hpp
+    \brief Solve times by model class and library, for choosing a solver.
+
+  See Osi2::SolveHistory and ControlAPI::enableSolveHistory.
+*/
+
+#ifndef Osi2SolveHistory_HPP
+#define Osi2SolveHistory_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*! \brief How long each library has taken on each class of model
+
+  Models are sorted into classes by a few coarse features (#Features): the
+  number of rows and of columns and the density, each to the nearest power
+  of two, and whether the model has no, few, or many integer variables.
+  For each class and library the history keeps the number of solves and
+  their mean time. The mean is a running one over roughly the last
+  #maxWeight solves, so a library that gets faster (or slower) is noticed.
+
+  #choose picks a library for a model from a list of candidates, by an
+  epsilon-greedy rule: a candidate that has never solved a model of the
+  class is tried first; otherwise, with probability #getExploration a
+  candidate is picked at random, and the rest of the time the one with the
+  least mean time wins. The occasional random pick keeps the means of the
+  losers honest as the workload changes.
+
+  Given a file (#setFile), the history is read from it and written back
+  after every solve recorded. The file is rewritten whole, through a
+  temporary name, so a reader never sees half of it; processes that share
+  a file don't merge their records, and the last to write wins.
+
+  All methods are thread-safe.
+*/
+class SolveHistory {
+
+public:
+
+    /*! \brief The features of a model that decide its class
+
+      See #featuresOf to fill one in from a solver object.
+    */
+    struct Features {
+        int numRows_ ;
+        int numCols_ ;
+        int64_t numElements_ ;
+        int numIntegers_ ;
+    } ;
+
+    /// Solves after which the running mean forgets old times
+    static const int maxWeight = 20 ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; an empty history with no file
+    SolveHistory() ;
+    /// Destructor
+    ~SolveHistory() ;
+    //@}
+
+    /// \name Parameters
+    //@{
+    /*! \brief Keep the history in file \p path
+
+      Replaces what's held with the contents of the file if it exists, and
+      otherwise makes the file from what's held; writes there from now on. An empty \p path means memory only.
+      \returns 0 on success, -1 if the file holds something other than a
+      history or can't be written (the history is then left as it was).
+    */
+    int setFile(const std::string &path) ;
+    /// The backing file; empty if there's none
+    std::string getFile() const ;
+    /// Set the probability of a random pick (default 0.05)
+    void setExploration(double epsilon) ;
+    /// The probability of a random pick
+    double getExploration() const ;
+    /// Seed the random picks
+    void setSeed(uint32_t seed) ;
+    //@}
+
+    /// \name The history
+    //@{
+    /*! \brief Record that \p lib took \p seconds on a model with \p features
+
+      A solve that didn't finish (\p solved false) counts as ten times as
+      long plus a second, so that a library can't look fast by giving up.
+    */
+    void record(const Features &features, const std::string &lib,
+                double seconds, bool solved = true) ;
+
+    /*! \brief Choose a library for a model with \p features
+
+      \returns the index in \p libs of the library chosen, or -1 if \p libs
+      is empty. \p explored, if given, is set true if the choice was made to
+      learn rather than because the library has been fastest.
+    */
+    int choose(const Features &features, const std::vector<std::string> &libs,
+               bool *explored = 0) ;
+
+    /*! \brief The record of \p lib on models of the class of \p features
+
+      \returns the number of solves recorded; \p meanSecs is their mean time.
+    */
+    int getRecord(const Features &features, const std::string &lib,
+                  double &meanSecs) const ;
+
+    /// Forget everything held in memory; the file is left alone
+    void clear() ;
+    //@}
+
+    /*! \brief The class of a model with \p features
+
+      Rows, columns and the number of halvings from full density to the
+      actual density, each as a binary logarithm, and 0, 1 or 2 for no
+      integer variables, fewer than one in ten, or more.
+    */
+    static uint32_t classOf(const Features &features) ;
+
+    /*! \brief The features of the model loaded in \p obj
+
+      For any API with \c getNumRows, \c getNumCols, \c getNumElements and
+      \c getNumIntegers (Osi1API).
+    */
+    template <class T>
+    static inline Features featuresOf (const T *obj) {
+        Features features ;
+        features.numRows_ = obj->getNumRows() ;
+        features.numCols_ = obj->getNumCols() ;
+        features.numElements_ = obj->getNumElements() ;
+        features.numIntegers_ = obj->getNumIntegers() ;
+        return (features) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    SolveHistory(const SolveHistory &rhs) ;
+    /// Assignment (not implemented)
+    SolveHistory &operator=(const SolveHistory &rhs) ;
+
+    /// The solves of one library on one class of model
+    struct Entry {
+        int count_ ;
+        double meanSecs_ ;
+    } ;
+    typedef std::pair<uint32_t, std::string> Key ;
+    typedef std::map<Key, Entry> EntryMap ;
+
+    /*! \brief Read \p path into \p entries
+
+      \returns 1 if read, 0 if there's no such file, -1 if it isn't a
+      history.
+    */
+    static int readFile(const std::string &path, EntryMap &entries) ;
+    /// Write \p entries to \p path; false if it can't be written
+    bool writeFile(const std::string &path, const EntryMap &entries) ;
+    /// A number uniformly distributed in [0,1); call with #mutex_ held
+    double uniform() ;
+
+    /// Guards everything below
+    mutable Mutex mutex_ ;
+    /// The records
+    EntryMap entries_ ;
+    /// See #setFile
+    std::string path_ ;
+    /// See #setExploration
+    double epsilon_ ;
+    /// State of the random number generator (xorshift)
+    uint32_t rng_ ;
+    /// Makes temporary file names unique within the process
+    unsigned int tmpSerial_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
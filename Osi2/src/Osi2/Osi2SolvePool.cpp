@@ -0,0 +1,169 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolvePool.cpp
+    \brief Method definitions for Osi2::SolvePool
+*/
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2Numa.hpp"
+#include "Osi2SolvePool.hpp"
+
+namespace Osi2 {
+
+SolvePool::SolvePool ()
+    : queues_(1),
+      numQueued_(0),
+      stopping_(false)
+{ }
+
+/*
+  Tell the threads to stop, then cancel whatever they leave in the queue.
+  A thread finishes the job it's running before it looks at stopping_.
+*/
+SolvePool::~SolvePool ()
+{
+    {
+        ScopedLock lock(mutex_) ;
+        stopping_ = true ;
+        wake_.wakeAll() ;
+    }
+    for (size_t i = 0 ; i < threads_.size() ; i++) joinThread(threads_[i]) ;
+    threads_.clear() ;
+    for (size_t i = 0 ; i < workers_.size() ; i++) delete workers_[i] ;
+    workers_.clear() ;
+    for (size_t q = 0 ; q < queues_.size() ; q++) {
+        std::deque<SolveTask *> &queue = queues_[q] ;
+        while (!queue.empty()) {
+            SolveTask *task = queue.front() ;
+            queue.pop_front() ;
+            {
+                ScopedLock lock(task->mutex_) ;
+                if (task->state_ == SolveFuture::Pending) {
+                    task->state_ = SolveFuture::Cancelled ;
+                    task->changed_.wakeAll() ;
+                }
+            }
+            task->release() ;
+        }
+    }
+}
+
+/*
+  The queues are sized before any thread starts, and don't change after.
+*/
+int SolvePool::start (int numThreads, bool numa)
+{
+    if (numThreads <= 0) numThreads = numProcessors() ;
+    const int numNodes = numa ? NumaTopology::system().getNumNodes() : 0 ;
+    if (threads_.empty()) queues_.resize(numNodes+1) ;
+    for (int i = 0 ; i < numThreads ; i++) {
+        Worker *worker = new Worker ;
+        worker->pool_ = this ;
+        worker->node_ = (numNodes > 0) ? i%numNodes : -1 ;
+        ThreadHandle thread ;
+        if (!startThread(thread, workerMain, worker)) {
+            delete worker ;
+            break ;
+        }
+        threads_.push_back(thread) ;
+        workers_.push_back(worker) ;
+    }
+    return (getNumThreads()) ;
+}
+
+/*
+  The reference the task is made with goes to the queue.
+*/
+SolveFuture SolvePool::submit (AsyncJob *job, int node)
+{
+    if (job == nullptr) return (SolveFuture()) ;
+    if (threads_.empty()) {
+        delete job ;
+        return (SolveFuture()) ;
+    }
+    SolveTask *task = new SolveTask(job) ;
+    SolveFuture future(task) ;
+    const size_t q =
+        (node < 0 || node+1 >= static_cast<int>(queues_.size())) ? 0 : node+1 ;
+    ScopedLock lock(mutex_) ;
+    queues_[q].push_back(task) ;
+    numQueued_++ ;
+    wake_.wakeAll() ;
+    return (future) ;
+}
+
+/*
+  A thread that can't be pinned runs anyway, unpinned; it still looks
+  first for the work of the node it was meant for.
+*/
+void *SolvePool::workerMain (void *arg)
+{
+    Worker *worker = static_cast<Worker *>(arg) ;
+    if (worker->node_ >= 0) numaBindThread(worker->node_) ;
+    worker->pool_->work(worker->node_) ;
+    return (nullptr) ;
+}
+
+/*
+  Own node, then any node, then the other nodes in turn from the next one
+  along.
+*/
+SolveTask *SolvePool::take (int node)
+{
+    const size_t numQueues = queues_.size() ;
+    const size_t own = (node < 0) ? 0 : node+1 ;
+    size_t q = own ;
+    if (queues_[q].empty()) q = 0 ;
+    for (size_t k = 1 ; k < numQueues && queues_[q].empty() ; k++)
+        q = (own+k)%numQueues ;
+    if (queues_[q].empty()) return (nullptr) ;
+    SolveTask *task = queues_[q].front() ;
+    queues_[q].pop_front() ;
+    numQueued_-- ;
+    return (task) ;
+}
+
+/*
+  A job that throws is taken to have failed; the exception mustn't escape
+  the thread.
+*/
+void SolvePool::work (int node)
+{
+    for (;;) {
+        SolveTask *task = nullptr ;
+        {
+            ScopedLock lock(mutex_) ;
+            while (!stopping_ && numQueued_ == 0) wake_.wait(mutex_) ;
+            if (stopping_) return ;
+            task = take(node) ;
+        }
+        bool run = false ;
+        {
+            ScopedLock lock(task->mutex_) ;
+            if (task->state_ == SolveFuture::Pending) {
+                task->state_ = SolveFuture::Running ;
+                run = true ;
+            }
+        }
+        if (run) {
+            int status = -1 ;
+            try {
+                status = task->job_->run() ;
+            } catch (...) {
+                status = -1 ;
+            }
+            ScopedLock lock(task->mutex_) ;
+            task->status_ = status ;
+            task->state_ = SolveFuture::Done ;
+            task->changed_.wakeAll() ;
+        }
+        task->release() ;
+    }
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,156 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolvePool.hpp
+    \brief The threads behind ControlAPI_Imp's asynchronous solves.
+
+  See Osi2::SolvePool.
+*/
+
+#ifndef Osi2SolvePool_HPP
+#define Osi2SolvePool_HPP
+
+#include <deque>
+#include <vector>
+
+#include "Osi2Threads.hpp"
+#include "Osi2SolveFuture.hpp"
+
+namespace Osi2 {
+
+/*! \brief A job, shared by the pool and the futures that refer to it
+
+  Reference counted: the pool's queue holds one reference while the task
+  waits, and each SolveFuture holds one. The last to let go deletes it.
+*/
+struct SolveTask {
+    /// Constructor; takes ownership of \p job; one reference, for the caller
+    explicit SolveTask (AsyncJob *job)
+        : job_(job),
+          refs_(1),
+          state_(SolveFuture::Pending),
+          status_(-1)
+    { }
+    /// Destructor
+    ~SolveTask () {
+        delete job_ ;
+    }
+
+    /// Take a reference
+    inline void retain () {
+        atomicAdd(&refs_, 1) ;
+    }
+    /// Let go of a reference; the last deletes the task
+    inline void release () {
+        if (atomicAdd(&refs_, -1) == 0) delete this ;
+    }
+
+    /// The job
+    AsyncJob *job_ ;
+    /// References
+    volatile int refs_ ;
+    /// Guards #state_ and #status_
+    Mutex mutex_ ;
+    /// Signalled when the job is done or cancelled
+    Condition changed_ ;
+    /// Where the job is
+    SolveFuture::State state_ ;
+    /// Status returned by the job
+    int status_ ;
+} ;
+
+/*! \brief A fixed set of threads that run AsyncJobs
+
+  Jobs are run first come, first served. Owned by a ControlAPI_Imp, which
+  starts it on the first asynchronous solve.
+
+  Started with NUMA placement, the threads are pinned to the nodes of the
+  machine in turn, and a job can be queued for a node. A thread runs the
+  jobs for its own node first, then jobs for any node, and only then jobs
+  queued for another node, rather than sit idle.
+*/
+class SolvePool {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; no threads until #start
+    SolvePool() ;
+    /*! \brief Destructor
+
+      Cancels the jobs still waiting and waits for those running.
+    */
+    ~SolvePool() ;
+    //@}
+
+    /*! \brief Start \p numThreads threads
+
+      One per processor if \p numThreads is 0 or less. With \p numa, thread
+      \c i is pinned to node <tt>i % N</tt> of the N nodes of
+      NumaTopology::system(). Returns the number started.
+    */
+    int start(int numThreads, bool numa = false) ;
+
+    /// Number of threads running
+    inline int getNumThreads () const {
+        return (static_cast<int>(threads_.size())) ;
+    }
+
+    /*! \brief Queue \p job, for node \p node
+
+      The pool takes ownership of the job. A \p node of -1, or one the pool
+      has no queue for (it wasn't started with NUMA placement), means any
+      node. Returns an invalid future if the pool has no threads.
+    */
+    SolveFuture submit(AsyncJob *job, int node = -1) ;
+
+private:
+
+    /// Copy constructor (not implemented)
+    SolvePool(const SolvePool &rhs) ;
+    /// Assignment (not implemented)
+    SolvePool &operator=(const SolvePool &rhs) ;
+
+    /// What a thread is told when it starts
+    struct Worker {
+        /// The pool
+        SolvePool *pool_ ;
+        /// Node the thread is pinned to; -1 if it isn't
+        int node_ ;
+    } ;
+
+    /// Thread body
+    static void *workerMain(void *arg) ;
+    /// Run jobs until told to stop, taking first those for \p node
+    void work(int node) ;
+    /// Take the next task for a thread on \p node; #mutex_ must be held
+    SolveTask *take(int node) ;
+
+    /// The threads
+    std::vector<ThreadHandle> threads_ ;
+    /// What each thread was started with
+    std::vector<Worker *> workers_ ;
+    /*! \brief Tasks waiting for a thread
+
+      Entry 0 holds the tasks for any node, entry <tt>n+1</tt> those for
+      node \c n.
+    */
+    std::vector<std::deque<SolveTask *> > queues_ ;
+    /// Tasks in #queues_
+    size_t numQueued_ ;
+    /// True once the threads are told to stop
+    bool stopping_ ;
+    /// Guards #queues_, #numQueued_ and #stopping_
+    Mutex mutex_ ;
+    /// Signalled when a task is queued or the threads should stop
+    Condition wake_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
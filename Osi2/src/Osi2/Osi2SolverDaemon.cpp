@@ -0,0 +1,352 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolverDaemon.cpp
+    \brief Method definitions for Osi2::SolverDaemon
+*/
+
+#include <cstdio>
+
+#ifndef WIN32
+#include <sys/stat.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2SolverDaemon.hpp"
+#include "Osi2RemoteWire.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
+
+namespace {
+
+/// How long the listener waits for a connection before looking around, ms
+const int acceptInterval = 100 ;
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+SolverDaemon::SolverDaemon ()
+    : listenSock_(-1),
+      running_(0),
+      maxResident_(dfltMaxResident),
+      useClock_(0),
+      numJobs_(0),
+      numHits_(0)
+{ }
+
+SolverDaemon::~SolverDaemon ()
+{
+    stop() ;
+}
+
+bool SolverDaemon::isSupported ()
+{
+    return (wireIsSupported()) ;
+}
+
+int SolverDaemon::start (const std::string &socketPath, std::string &errStr,
+                         int maxResident)
+{
+    stop() ;
+#   ifdef WIN32
+    errStr = "The solver daemon is not supported on this platform." ;
+    return (-1) ;
+#   else
+    maxResident_ = (maxResident < 0) ? 0 : maxResident ;
+    {
+        ScopedLock lock(ctrlMutex_) ;
+        numJobs_ = 0 ;
+        numHits_ = 0 ;
+    }
+    listenSock_ = wireListenLocal(socketPath, errStr) ;
+    if (listenSock_ < 0) return (-1) ;
+    socketPath_ = socketPath ;
+    running_ = 1 ;
+    if (!startThread(listener_, listenMain, this)) {
+        running_ = 0 ;
+        errStr = "Cannot start the listener thread" ;
+        stop() ;
+        return (-1) ;
+    }
+    return (0) ;
+#   endif
+}
+
+/*
+  Stop the listener first, so no new sessions appear, then cut off the
+  sessions and wait for their jobs to finish. After that no model is busy.
+*/
+void SolverDaemon::stop ()
+{
+    if (atomicLoad(&running_) != 0) {
+        running_ = 0 ;
+        joinThread(listener_) ;
+    }
+    {
+        ScopedLock lock(sessionMutex_) ;
+        for (size_t i = 0 ; i < sessions_.size() ; i++)
+            wireShutdown(sessions_[i]->sock_) ;
+    }
+    reapSessions(true) ;
+    if (listenSock_ >= 0) {
+        wireClose(listenSock_) ;
+        listenSock_ = -1 ;
+        std::remove(socketPath_.c_str()) ;
+    }
+    socketPath_ = "" ;
+    ScopedLock lock(ctrlMutex_) ;
+    while (!residents_.empty()) discard(residents_.size()-1) ;
+}
+
+int SolverDaemon::getNumJobs ()
+{
+    ScopedLock lock(ctrlMutex_) ;
+    return (numJobs_) ;
+}
+
+int SolverDaemon::getNumHits ()
+{
+    ScopedLock lock(ctrlMutex_) ;
+    return (numHits_) ;
+}
+
+int SolverDaemon::getNumResident ()
+{
+    ScopedLock lock(ctrlMutex_) ;
+    return (static_cast<int>(residents_.size())) ;
+}
+
+void *SolverDaemon::listenMain (void *arg)
+{
+    static_cast<SolverDaemon *>(arg)->listen() ;
+    return (nullptr) ;
+}
+
+void *SolverDaemon::sessionMain (void *arg)
+{
+    Session *session = static_cast<Session *>(arg) ;
+    session->daemon_->serve(*session) ;
+    atomicAdd(&session->done_, 1) ;
+    return (nullptr) ;
+}
+
+/*
+  Wake up now and then to see if we should stop, and to clear away finished
+  sessions.
+*/
+void SolverDaemon::listen ()
+{
+    while (atomicLoad(&running_) != 0) {
+        reapSessions(false) ;
+        const int sock = wireAccept(listenSock_, acceptInterval) ;
+        if (sock < 0) continue ;
+        Session *session = new Session ;
+        session->daemon_ = this ;
+        session->sock_ = sock ;
+        session->done_ = 0 ;
+        ScopedLock lock(sessionMutex_) ;
+        if (!startThread(session->thread_, sessionMain, session)) {
+            wireClose(sock) ;
+            delete session ;
+            continue ;
+        }
+        sessions_.push_back(session) ;
+    }
+}
+
+void SolverDaemon::reapSessions (bool all)
+{
+    std::vector<Session *> finished ;
+    {
+        ScopedLock lock(sessionMutex_) ;
+        std::vector<Session *> live ;
+        for (size_t i = 0 ; i < sessions_.size() ; i++) {
+            if (all || atomicLoad(&sessions_[i]->done_) != 0)
+                finished.push_back(sessions_[i]) ;
+            else
+                live.push_back(sessions_[i]) ;
+        }
+        sessions_.swap(live) ;
+    }
+    for (size_t i = 0 ; i < finished.size() ; i++) {
+        joinThread(finished[i]->thread_) ;
+        wireClose(finished[i]->sock_) ;
+        delete finished[i] ;
+    }
+}
+
+/*
+  A connection can carry any number of jobs, one after another. The socket
+  is closed when the session is reaped, so that #stop can't shut down a
+  descriptor that has been reused.
+*/
+void SolverDaemon::serve (Session &session)
+{
+    std::vector<char> request ;
+    std::vector<char> reply ;
+    while (wireRecv(session.sock_, request) == 0) {
+        WireReader in(request) ;
+        const int64_t op = in.getInt() ;
+        if (op == DaemonSolve) {
+            const std::string shortName = in.getStr() ;
+            const std::string libName = in.getStr() ;
+            const std::string path = in.getStr() ;
+            const bool keepNames = (in.getInt() != 0) ;
+            int solveStatus = -1 ;
+            bool hit = false ;
+            std::string errStr = "Malformed request" ;
+            int status = -1 ;
+            if (in.ok())
+                status = runJob(shortName, libName, path, keepNames,
+                                solveStatus, hit, errStr) ;
+            if (status == 0) errStr = "" ;
+            WireWriter(reply).putInt(status).putInt(solveStatus)
+                .putInt(hit).putStr(errStr) ;
+        } else if (op == DaemonStats) {
+            ScopedLock lock(ctrlMutex_) ;
+            WireWriter(reply).putInt(0).putInt(numJobs_).putInt(numHits_)
+                .putInt(static_cast<int64_t>(residents_.size())) ;
+        } else {
+            WireWriter(reply).putInt(-1) ;
+        }
+        if (wireSend(session.sock_, reply) < 0) break ;
+    }
+}
+
+/*
+  The file is looked at before it's read. If it changes while it's being
+  read, the next job sees a different time or size and reads it again.
+*/
+int SolverDaemon::runJob (const std::string &shortName,
+                          const std::string &libName, const std::string &path,
+                          bool keepNames, int &solveStatus, bool &hit,
+                          std::string &errStr)
+{
+#   ifdef WIN32
+    errStr = "The solver daemon is not supported on this platform." ;
+    return (-1) ;
+#   else
+    struct stat info ;
+    if (::stat(path.c_str(), &info) != 0) {
+        errStr = "Cannot find " + path ;
+        return (-1) ;
+    }
+    Resident *resident = checkOut(shortName, libName, path, keepNames,
+                                  static_cast<int64_t>(info.st_mtime),
+                                  static_cast<int64_t>(info.st_size),
+                                  hit, errStr) ;
+    if (resident == nullptr) return (-1) ;
+    ProbMgmtAPI *probMgmt = dynamic_cast<ProbMgmtAPI *>(resident->obj_) ;
+    if (!hit && probMgmt->readMps(path.c_str(), keepNames) != 0) {
+        checkIn(resident, false) ;
+        errStr = "Cannot read " + path ;
+        return (-1) ;
+    }
+    solveStatus = probMgmt->initialSolve() ;
+    checkIn(resident, true) ;
+    return (0) ;
+#   endif
+}
+
+/*
+  Loading is cheap once the library is known: load returns 1 straight away.
+  An object that can't do ProbMgmt is no use here and goes straight back.
+*/
+SolverDaemon::Resident *SolverDaemon::checkOut (
+    const std::string &shortName, const std::string &libName,
+    const std::string &path, bool keepNames, int64_t mtime, int64_t size,
+    bool &hit, std::string &errStr)
+{
+    ScopedLock lock(ctrlMutex_) ;
+    numJobs_++ ;
+    for (size_t i = residents_.size() ; i-- > 0 ; ) {
+        Resident *resident = residents_[i] ;
+        if (resident->shortName_ != shortName || resident->path_ != path)
+            continue ;
+        if (resident->mtime_ != mtime || resident->size_ != size) {
+            if (!resident->busy_) discard(i) ;
+            continue ;
+        }
+        if (resident->busy_ || resident->keepNames_ != keepNames) continue ;
+        resident->busy_ = true ;
+        resident->lastUse_ = ++useClock_ ;
+        numHits_++ ;
+        hit = true ;
+        return (resident) ;
+    }
+    hit = false ;
+    const int loadStatus = libName.empty() ? ctrlAPI_.load(shortName) :
+                                             ctrlAPI_.load(shortName, libName) ;
+    if (loadStatus < 0) {
+        errStr = "Cannot load the plugin library for " + shortName ;
+        return (nullptr) ;
+    }
+    API *obj = nullptr ;
+    if (ctrlAPI_.createObject(obj, "ProbMgmt", &shortName) != 0 ||
+            dynamic_cast<ProbMgmtAPI *>(obj) == nullptr) {
+        if (obj != nullptr) ctrlAPI_.destroyObject(obj) ;
+        errStr = "Cannot create a ProbMgmt object from " + shortName ;
+        return (nullptr) ;
+    }
+    Resident *resident = new Resident ;
+    resident->shortName_ = shortName ;
+    resident->path_ = path ;
+    resident->keepNames_ = keepNames ;
+    resident->mtime_ = mtime ;
+    resident->size_ = size ;
+    resident->obj_ = obj ;
+    resident->busy_ = true ;
+    resident->lastUse_ = ++useClock_ ;
+    residents_.push_back(resident) ;
+    return (resident) ;
+}
+
+void SolverDaemon::checkIn (Resident *resident, bool keep)
+{
+    ScopedLock lock(ctrlMutex_) ;
+    for (size_t i = 0 ; i < residents_.size() ; i++) {
+        if (residents_[i] != resident) continue ;
+        if (keep) {
+            resident->busy_ = false ;
+            trimResident() ;
+        } else {
+            discard(i) ;
+        }
+        return ;
+    }
+}
+
+void SolverDaemon::discard (size_t ndx)
+{
+    Resident *resident = residents_[ndx] ;
+    ctrlAPI_.destroyObject(resident->obj_) ;
+    delete resident ;
+    residents_.erase(residents_.begin()+ndx) ;
+}
+
+/*
+  Busy models don't count against the limit; they'll be back.
+*/
+void SolverDaemon::trimResident ()
+{
+    for (;;) {
+        int numIdle = 0 ;
+        size_t victim = residents_.size() ;
+        for (size_t i = 0 ; i < residents_.size() ; i++) {
+            const Resident *resident = residents_[i] ;
+            if (resident->busy_) continue ;
+            numIdle++ ;
+            if (victim == residents_.size() ||
+                    resident->lastUse_ < residents_[victim]->lastUse_)
+                victim = i ;
+        }
+        if (numIdle <= maxResident_) break ;
+        discard(victim) ;
+    }
+}
+
+}  // end namespace Osi2
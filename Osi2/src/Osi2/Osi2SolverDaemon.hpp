@@ -0,0 +1,231 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2SolverDaemon.hpp
+    \brief A long-lived server that runs solver jobs for local clients.
+
+  See Osi2::SolverDaemon and, for the client side, Osi2::DaemonClient.
+*/
+
+#ifndef Osi2SolverDaemon_HPP
+#define Osi2SolverDaemon_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Osi2Threads.hpp"
+#include "Osi2ControlAPI_Imp.hpp"
+
+namespace Osi2 {
+
+/*! \name Solver daemon protocol
+
+  Messages are built with WireWriter (see Osi2RemoteWire.hpp). Each request
+  is answered by a reply that starts with a status, 0 or -1.
+*/
+//@{
+/// Requests understood by the daemon
+enum DaemonOp {
+    /*! (shortName, libName, path, keepNames) ->
+        (status, solveStatus, resident, message) */
+    DaemonSolve = 1,
+    /// () -> (status, jobs, resident hits, resident models)
+    DaemonStats
+} ;
+//@}
+
+/*! \brief A long-lived server that runs solver jobs for local clients
+
+  A short job that loads a plugin library, reads a model and solves it
+  spends most of its time in the first two steps. The daemon does them once
+  and keeps the results: plugin libraries stay loaded in its ControlAPI_Imp,
+  and models stay resident, already read, in ProbMgmtAPI objects. Clients
+  (see DaemonClient) send jobs over a local socket and get the solve status
+  back.
+
+  A job names a plugin library by short name (the library is loaded on
+  first use if the job also gives its file name) and a model by file path.
+  A resident model is keyed by short name, path, and the file's
+  modification time and size when it was read; change the file and the
+  next job reads it afresh. A resident model is used by one job at a time;
+  a job that finds all the copies of its model busy reads another. When
+  there are more than #getMaxResident idle models, the ones used least
+  recently are discarded.
+
+  Each client connection is served by a thread of its own, so jobs run in
+  parallel. Only ProbMgmtAPI objects are used at present. Not available on
+  Windows (see #isSupported).
+*/
+class SolverDaemon {
+
+public:
+
+    /// Default limit on resident models
+    static const int dfltMaxResident = 16 ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor
+    SolverDaemon() ;
+    /// Destructor; stops the daemon
+    ~SolverDaemon() ;
+    //@}
+
+    /// True if the daemon is supported on this platform
+    static bool isSupported() ;
+
+    /// \name Service
+    //@{
+    /*! \brief Start serving on the local socket \p socketPath
+
+      Any file already at \p socketPath is replaced. If the daemon is
+      already serving, it's stopped first.
+
+      \return 0 on success; otherwise -1, with the reason in \p errStr.
+    */
+    int start(const std::string &socketPath, std::string &errStr,
+              int maxResident = dfltMaxResident) ;
+
+    /*! \brief Stop serving
+
+      Closes all connections, waits for their jobs to finish, discards the
+      resident models and removes the socket. Plugin libraries stay loaded.
+    */
+    void stop() ;
+
+    /*! \brief The daemon's control API
+
+      For loading plugin libraries before the first job, or setting the log
+      level. Don't use it while the daemon is serving.
+    */
+    inline ControlAPI_Imp &getControlAPI () {
+        return (ctrlAPI_) ;
+    }
+
+    /// Limit on idle resident models
+    inline int getMaxResident () const {
+        return (maxResident_) ;
+    }
+
+    /// Jobs run since #start
+    int getNumJobs() ;
+    /// Jobs since #start that found their model resident
+    int getNumHits() ;
+    /// Models resident now
+    int getNumResident() ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    SolverDaemon(const SolverDaemon &rhs) ;
+    /// Assignment (not implemented)
+    SolverDaemon &operator=(const SolverDaemon &rhs) ;
+
+    /// One client connection
+    struct Session {
+        /// The daemon
+        SolverDaemon *daemon_ ;
+        /// The connection
+        int sock_ ;
+        /// The thread serving it
+        ThreadHandle thread_ ;
+        /// Set by the thread when it's finished
+        volatile int done_ ;
+    } ;
+
+    /// A model held in an object, ready to solve
+    struct Resident {
+        std::string shortName_ ;
+        std::string path_ ;
+        bool keepNames_ ;
+        /// Modification time of the file when it was read
+        int64_t mtime_ ;
+        /// Size of the file when it was read
+        int64_t size_ ;
+        /// The object holding the model
+        API *obj_ ;
+        /// True while a job is using the model
+        bool busy_ ;
+        /// Value of #useClock_ when last used
+        unsigned long lastUse_ ;
+    } ;
+
+    /// Thread body of the listener
+    static void *listenMain(void *arg) ;
+    /// Thread body of a session
+    static void *sessionMain(void *arg) ;
+
+    /// Accept connections until told to stop
+    void listen() ;
+    /// Serve one connection until the client closes it
+    void serve(Session &session) ;
+    /// Join and discard finished sessions; all of them if \p all
+    void reapSessions(bool all) ;
+
+    /*! \brief Run one job
+
+      Returns 0 with the status of the solve in \p solveStatus and whether
+      the model was resident in \p hit; -1 with the reason in \p errStr.
+    */
+    int runJob(const std::string &shortName, const std::string &libName,
+               const std::string &path, bool keepNames, int &solveStatus,
+               bool &hit, std::string &errStr) ;
+
+    /*! \brief Find an idle resident model, or make an object to read one
+
+      Stale copies of the model are discarded on the way. The result is
+      marked busy; \p hit says whether it already holds the model. Returns
+      null with \p errStr if no object can be had.
+    */
+    Resident *checkOut(const std::string &shortName,
+                       const std::string &libName, const std::string &path,
+                       bool keepNames, int64_t mtime, int64_t size,
+                       bool &hit, std::string &errStr) ;
+
+    /// Return a model from #checkOut; if not \p keep, discard it
+    void checkIn(Resident *resident, bool keep) ;
+
+    /// Destroy the object and forget the model; #ctrlMutex_ held
+    void discard(size_t ndx) ;
+
+    /// Discard idle models beyond the limit; #ctrlMutex_ held
+    void trimResident() ;
+
+    /// Listening socket
+    int listenSock_ ;
+    /// Path of the listening socket
+    std::string socketPath_ ;
+    /// Nonzero while the daemon is serving
+    volatile int running_ ;
+    /// The listener thread
+    ThreadHandle listener_ ;
+
+    /// Live sessions
+    std::vector<Session *> sessions_ ;
+    /// Guards #sessions_
+    Mutex sessionMutex_ ;
+
+    /// Loads libraries and makes objects
+    ControlAPI_Imp ctrlAPI_ ;
+    /// The resident models
+    std::vector<Resident *> residents_ ;
+    /// Limit on idle resident models
+    int maxResident_ ;
+    /// Ticks once for each use of a resident model
+    unsigned long useClock_ ;
+    /// Jobs run, and those that found their model resident
+    int numJobs_ ;
+    int numHits_ ;
+    /// Guards #ctrlAPI_, #residents_ and the counts
+    Mutex ctrlMutex_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,169 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2StrongBranch.hpp
+    \brief Strong branching on a batch of candidates, in parallel.
+
+  See ControlAPI::strongBranch.
+*/
+
+#ifndef Osi2StrongBranch_HPP
+#define Osi2StrongBranch_HPP
+
+#include <vector>
+
+#include "Osi2SolveFuture.hpp"
+
+namespace Osi2 {
+
+/*! \brief A column to branch on, and the bounds of its two branches
+
+  The down branch sets the column's upper bound to #downBound_; the up
+  branch sets its lower bound to #upBound_. For an integer column at
+  value x, those would be floor(x) and ceil(x).
+*/
+struct BranchCandidate {
+    /// Constructor
+    BranchCandidate (int col = -1, double downBound = 0.0,
+                     double upBound = 0.0)
+      : col_(col),
+        downBound_(downBound),
+        upBound_(upBound)
+    { }
+    /// The column
+    int col_ ;
+    /// Upper bound in the down branch
+    double downBound_ ;
+    /// Lower bound in the up branch
+    double upBound_ ;
+} ;
+
+/// What came of one branch
+struct BranchOutcome {
+    /// Outcome of the solve
+    enum Status {
+        /// Proven optimal
+        Optimal = 0,
+        /// Proven primal infeasible, or the dual objective limit was reached
+        Infeasible,
+        /// Stopped on the iteration limit, or for some other reason
+        Stopped,
+        /// Not evaluated (a bad column index)
+        NotEvaluated
+    } ;
+    /// Constructor
+    BranchOutcome ()
+      : status_(NotEvaluated),
+        objValue_(0.0),
+        iterations_(0)
+    { }
+    /// Outcome of the solve
+    Status status_ ;
+    /// Objective value at the end of the solve
+    double objValue_ ;
+    /// Iterations taken
+    int iterations_ ;
+} ;
+
+/// What came of both branches on a candidate
+struct BranchResult {
+    /// The down branch
+    BranchOutcome down_ ;
+    /// The up branch
+    BranchOutcome up_ ;
+} ;
+
+/*! \brief Strong branching on a share of the candidates, on one object
+
+  Evaluates candidates #first_, #first_+#stride_, ... of the batch, each
+  from the object's hot start, and puts the outcomes in the matching
+  entries of the results. Jobs with different starting points can run at
+  once on different objects. Made by ControlAPI::strongBranch.
+
+  The iteration limit is set with \c setHotStartIterationLimit, found by
+  argument-dependent lookup; for Osi1API it's in Osi2Osi1API.hpp.
+*/
+template <class T>
+class StrongBranchJob : public AsyncJob {
+
+public:
+
+    /*! \brief Constructor
+
+      A \p clone is solved before its hot start is marked, to bring its
+      solver state up to date; its warm start makes that cheap.
+    */
+    StrongBranchJob (T *obj, bool clone,
+                     const std::vector<BranchCandidate> &candidates,
+                     std::vector<BranchResult> &results, int first,
+                     int stride, int iterLimit)
+      : obj_(obj),
+        clone_(clone),
+        candidates_(candidates),
+        results_(results),
+        first_(first),
+        stride_(stride),
+        iterLimit_(iterLimit)
+    { }
+
+    /// Evaluate the candidates; always returns 0
+    int run () {
+        if (clone_) obj_->resolve() ;
+        setHotStartIterationLimit(obj_, iterLimit_) ;
+        obj_->markHotStart() ;
+        const int numCols = obj_->getNumCols() ;
+        for (size_t k = first_ ; k < candidates_.size() ; k += stride_) {
+            const BranchCandidate &cand = candidates_[k] ;
+            if (cand.col_ < 0 || cand.col_ >= numCols) continue ;
+            const double lower = obj_->getColLower()[cand.col_] ;
+            const double upper = obj_->getColUpper()[cand.col_] ;
+            obj_->setColUpper(cand.col_, cand.downBound_) ;
+            solve(results_[k].down_) ;
+            obj_->setColUpper(cand.col_, upper) ;
+            obj_->setColLower(cand.col_, cand.upBound_) ;
+            solve(results_[k].up_) ;
+            obj_->setColLower(cand.col_, lower) ;
+        }
+        obj_->unmarkHotStart() ;
+        return (0) ;
+    }
+
+private:
+
+    /// Solve from the hot start and record the outcome
+    void solve (BranchOutcome &outcome) {
+        obj_->solveFromHotStart() ;
+        if (obj_->isProvenOptimal())
+            outcome.status_ = BranchOutcome::Optimal ;
+        else if (obj_->isProvenPrimalInfeasible() ||
+                 obj_->isDualObjectiveLimitReached())
+            outcome.status_ = BranchOutcome::Infeasible ;
+        else
+            outcome.status_ = BranchOutcome::Stopped ;
+        outcome.objValue_ = obj_->getObjValue() ;
+        outcome.iterations_ = obj_->getIterationCount() ;
+    }
+
+    /// The object
+    T *obj_ ;
+    /// True if the object is a clone made for the batch
+    bool clone_ ;
+    /// The batch
+    const std::vector<BranchCandidate> &candidates_ ;
+    /// Results for the batch; this job fills its share
+    std::vector<BranchResult> &results_ ;
+    /// Index of the first candidate for this job
+    int first_ ;
+    /// Distance between this job's candidates
+    int stride_ ;
+    /// Iteration limit for each branch
+    int iterLimit_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,292 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2WarmStartCache.cpp
+    \brief Method definitions for Osi2::WarmStartCache
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2WarmStartCache.hpp"
+
+#if !defined(S_ISDIR) && defined(S_IFMT)
+# define S_ISDIR(mode) (((mode)&S_IFMT) == S_IFDIR)
+#endif
+
+namespace {
+
+/// The first eight bytes of a basis file
+const char basisMagic[8] = { 'O', 'S', 'I', '2', 'W', 'S', 'B', '1' } ;
+
+/// Largest status byte; CoinWarmStartBasis::atLowerBound
+const unsigned char maxBasisStatus = 3 ;
+
+/*! \brief Header of a basis file
+
+  Followed by one status byte per column, then one per row. Written in the
+  machine's byte order; a file from a machine of the other order fails the
+  key check and is ignored.
+*/
+struct BasisHeader {
+    char magic_[8] ;
+    uint64_t key_ ;
+    int32_t numCols_ ;
+    int32_t numRows_ ;
+} ;
+
+}  // end file-local namespace
+
+namespace Osi2 {
+
+WarmStartCache::WarmStartCache ()
+    : capacity_(64),
+      hits_(0),
+      misses_(0),
+      tmpSerial_(0)
+{ }
+
+WarmStartCache::~WarmStartCache ()
+{ }
+
+void WarmStartCache::setCapacity (size_t capacity)
+{
+    ScopedLock lock(mutex_) ;
+    capacity_ = capacity ;
+    while (entries_.size() > capacity_) {
+        entries_.erase(lru_.back()) ;
+        lru_.pop_back() ;
+    }
+}
+
+size_t WarmStartCache::getCapacity () const
+{
+    ScopedLock lock(mutex_) ;
+    return (capacity_) ;
+}
+
+int WarmStartCache::setDirectory (const std::string &dir)
+{
+    if (!dir.empty()) {
+        struct stat info ;
+        if (::stat(dir.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+            return (-1) ;
+    }
+    ScopedLock lock(mutex_) ;
+    dir_ = dir ;
+    return (0) ;
+}
+
+std::string WarmStartCache::getDirectory () const
+{
+    ScopedLock lock(mutex_) ;
+    return (dir_) ;
+}
+
+/*
+  Memory first, then the directory. Files are read outside the lock; a
+  basis found there is kept in memory for next time.
+*/
+CoinWarmStartBasis *WarmStartCache::lookup (uint64_t key, int numCols,
+                                            int numRows)
+{
+    Entry entry ;
+    bool found = false ;
+    bool haveDir = false ;
+    {
+        ScopedLock lock(mutex_) ;
+        EntryMap::iterator iter = entries_.find(key) ;
+        if (iter != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, iter->second.lruPos_) ;
+            entry = iter->second ;
+            found = true ;
+        }
+        haveDir = !dir_.empty() ;
+    }
+    if (!found && haveDir && readEntry(key, entry)) {
+        found = true ;
+        ScopedLock lock(mutex_) ;
+        insert(key, entry) ;
+    }
+    found = found && entry.numCols_ == numCols && entry.numRows_ == numRows ;
+    {
+        ScopedLock lock(mutex_) ;
+        if (found)
+            hits_++ ;
+        else
+            misses_++ ;
+    }
+    if (!found) return (nullptr) ;
+
+    CoinWarmStartBasis *basis = new CoinWarmStartBasis() ;
+    basis->setSize(numCols, numRows) ;
+    for (int j = 0 ; j < numCols ; j++)
+        basis->setStructStatus(j,
+            static_cast<CoinWarmStartBasis::Status>(entry.status_[j])) ;
+    for (int i = 0 ; i < numRows ; i++)
+        basis->setArtifStatus(i,
+            static_cast<CoinWarmStartBasis::Status>(
+                entry.status_[numCols+i])) ;
+    return (basis) ;
+}
+
+void WarmStartCache::store (uint64_t key, const CoinWarmStartBasis &basis)
+{
+    Entry entry ;
+    entry.numCols_ = basis.getNumStructural() ;
+    entry.numRows_ = basis.getNumArtificial() ;
+    entry.status_.resize(entry.numCols_+entry.numRows_) ;
+    for (int j = 0 ; j < entry.numCols_ ; j++)
+        entry.status_[j] =
+            static_cast<unsigned char>(basis.getStructStatus(j)) ;
+    for (int i = 0 ; i < entry.numRows_ ; i++)
+        entry.status_[entry.numCols_+i] =
+            static_cast<unsigned char>(basis.getArtifStatus(i)) ;
+    bool haveDir = false ;
+    {
+        ScopedLock lock(mutex_) ;
+        insert(key, entry) ;
+        haveDir = !dir_.empty() ;
+    }
+    if (haveDir) writeEntry(key, entry) ;
+}
+
+void WarmStartCache::clear ()
+{
+    ScopedLock lock(mutex_) ;
+    entries_.clear() ;
+    lru_.clear() ;
+}
+
+size_t WarmStartCache::getHits () const
+{
+    ScopedLock lock(mutex_) ;
+    return (hits_) ;
+}
+
+size_t WarmStartCache::getMisses () const
+{
+    ScopedLock lock(mutex_) ;
+    return (misses_) ;
+}
+
+/*
+  Called with the lock held.
+*/
+void WarmStartCache::insert (uint64_t key, const Entry &entry)
+{
+    if (capacity_ == 0) return ;
+    EntryMap::iterator iter = entries_.find(key) ;
+    if (iter == entries_.end()) {
+        iter = entries_.insert(std::make_pair(key, entry)).first ;
+        lru_.push_front(key) ;
+    } else {
+        const std::list<uint64_t>::iterator lruPos = iter->second.lruPos_ ;
+        iter->second = entry ;
+        lru_.splice(lru_.begin(), lru_, lruPos) ;
+    }
+    iter->second.lruPos_ = lru_.begin() ;
+    while (entries_.size() > capacity_) {
+        entries_.erase(lru_.back()) ;
+        lru_.pop_back() ;
+    }
+}
+
+std::string WarmStartCache::pathOf (uint64_t key) const
+{
+    std::ostringstream path ;
+    path << dir_ << "/" << std::hex << std::setw(16) << std::setfill('0')
+         << key << ".wsb" ;
+    return (path.str()) ;
+}
+
+/*
+  Anything odd about the file (wrong length for its header, wrong magic,
+  wrong key, a status that isn't one) and it's treated as absent; a cache
+  miss is always safe. The length is checked before the header's counts
+  size anything.
+*/
+bool WarmStartCache::readEntry (uint64_t key, Entry &entry) const
+{
+    std::string path ;
+    {
+        ScopedLock lock(mutex_) ;
+        path = pathOf(key) ;
+    }
+    FILE *file = std::fopen(path.c_str(), "rb") ;
+    if (file == nullptr) return (false) ;
+    BasisHeader hdr ;
+    bool ok = (std::fread(&hdr, sizeof(hdr), 1, file) == 1 &&
+               std::memcmp(hdr.magic_, basisMagic, sizeof(basisMagic)) == 0 &&
+               hdr.key_ == key && hdr.numCols_ >= 0 && hdr.numRows_ >= 0) ;
+    const long len = ok ? static_cast<long>(hdr.numCols_)+hdr.numRows_ : 0 ;
+    if (ok) {
+        ok = (std::fseek(file, 0, SEEK_END) == 0 &&
+              std::ftell(file) == static_cast<long>(sizeof(hdr))+len &&
+              std::fseek(file, sizeof(hdr), SEEK_SET) == 0) ;
+    }
+    if (ok) {
+        entry.numCols_ = hdr.numCols_ ;
+        entry.numRows_ = hdr.numRows_ ;
+        entry.status_.resize(len) ;
+        ok = (len == 0 ||
+              std::fread(&entry.status_[0], 1, len, file) ==
+                  static_cast<size_t>(len)) ;
+        for (long k = 0 ; ok && k < len ; k++)
+            ok = (entry.status_[k] <= maxBasisStatus) ;
+    }
+    std::fclose(file) ;
+    return (ok) ;
+}
+
+/*
+  The temporary name carries the process id and a serial number, so two
+  writers, in this process or another, never share one. The rename is
+  atomic; the last writer wins.
+*/
+void WarmStartCache::writeEntry (uint64_t key, const Entry &entry)
+{
+    std::string path ;
+    std::ostringstream tmpPath ;
+    {
+        ScopedLock lock(mutex_) ;
+        path = pathOf(key) ;
+        tmpPath << path << "." << getpid() << "." << tmpSerial_++ << ".tmp" ;
+    }
+    FILE *file = std::fopen(tmpPath.str().c_str(), "wb") ;
+    if (file == nullptr) return ;
+    BasisHeader hdr ;
+    std::memset(&hdr, 0, sizeof(hdr)) ;
+    std::memcpy(hdr.magic_, basisMagic, sizeof(basisMagic)) ;
+    hdr.key_ = key ;
+    hdr.numCols_ = entry.numCols_ ;
+    hdr.numRows_ = entry.numRows_ ;
+    bool ok = (std::fwrite(&hdr, sizeof(hdr), 1, file) == 1) ;
+    if (ok && !entry.status_.empty())
+        ok = (std::fwrite(&entry.status_[0], 1, entry.status_.size(), file) ==
+              entry.status_.size()) ;
+    ok = (std::fclose(file) == 0) && ok ;
+#   ifdef WIN32
+    if (ok) std::remove(path.c_str()) ;
+#   endif
+    if (!ok || std::rename(tmpPath.str().c_str(), path.c_str()) != 0)
+        std::remove(tmpPath.str().c_str()) ;
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,220 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2WarmStartCache.hpp
+    \brief A cache of final bases, to warm start solves of models seen before.
+
+  See Osi2::WarmStartCache and ControlAPI::initialSolveCached.
+*/
+
+#ifndef Osi2WarmStartCache_HPP
+#define Osi2WarmStartCache_HPP
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "CoinPackedMatrix.hpp"
+#include "CoinWarmStartBasis.hpp"
+
+#include "Osi2Threads.hpp"
+#include "Osi2ModelHash.hpp"
+#include "Osi2SolveFuture.hpp"
+
+namespace Osi2 {
+
+/*! \brief A cache of final bases, keyed by model structure
+
+  The cache keeps the basis a solve finished with, under the structural
+  hash of the model (ModelHash::structure), and hands a copy back for the
+  next solve of a model with the same hash. The model needn't be the same
+  one, or live in the same object: a model with the same matrix pattern
+  and different bounds, objective or coefficients gets the basis too,
+  which is exactly the re-solve of a perturbed model. The dimensions are
+  kept with each basis and checked on lookup, so a hash collision between
+  models of different size is harmless.
+
+  The cache holds up to #getCapacity bases in memory, dropping the least
+  recently used. Given a directory (#setDirectory) it also keeps each basis
+  in a file there, named by the hash, and looks there on a miss in memory;
+  processes that share the directory share bases. Files are written to a
+  temporary name and renamed into place, so a reader never sees half a
+  basis.
+
+  Only CoinWarmStartBasis is cached. All methods are thread-safe.
+*/
+class WarmStartCache {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; an empty cache with no directory
+    WarmStartCache() ;
+    /// Destructor
+    ~WarmStartCache() ;
+    //@}
+
+    /// \name Parameters
+    //@{
+    /// Set the number of bases kept in memory (default 64)
+    void setCapacity(size_t capacity) ;
+    /// The number of bases kept in memory
+    size_t getCapacity() const ;
+    /*! \brief Keep bases in directory \p dir as well as in memory
+
+      An empty \p dir means memory only. The directory must exist.
+      \returns 0 on success, -1 if \p dir isn't a directory.
+    */
+    int setDirectory(const std::string &dir) ;
+    /// The backing directory; empty if there's none
+    std::string getDirectory() const ;
+    //@}
+
+    /// \name The cache
+    //@{
+    /*! \brief Look up the basis for a model
+
+      \returns a copy of the basis for \p key, belonging to the caller, if
+      there is one for a model of \p numCols columns and \p numRows rows;
+      null otherwise.
+    */
+    CoinWarmStartBasis *lookup(uint64_t key, int numCols, int numRows) ;
+    /// Keep \p basis as the basis for \p key, replacing any other
+    void store(uint64_t key, const CoinWarmStartBasis &basis) ;
+    /// Forget everything held in memory; files are left alone
+    void clear() ;
+    /// Lookups that found a basis
+    size_t getHits() const ;
+    /// Lookups that didn't
+    size_t getMisses() const ;
+    //@}
+
+    /*! \brief The key for the model loaded in \p obj
+
+      For any API with \c getMatrixByCol, \c getNumCols and \c getNumRows
+      (Osi1API).
+    */
+    template <class T>
+    static inline uint64_t keyOf (const T *obj) {
+        const CoinPackedMatrix *matrix = obj->getMatrixByCol() ;
+        return (ModelHash::structure(obj->getNumCols(), obj->getNumRows(),
+                                     matrix->getVectorStarts(),
+                                     matrix->getVectorLengths(),
+                                     matrix->getIndices())) ;
+    }
+
+    /*! \brief Solve \p obj, starting from a cached basis when there is one
+
+      Looks up the model in \p obj, gives it the basis found (if any) as
+      its warm start, and calls \c initialSolve. If the solve is proven
+      optimal, the final basis goes into the cache. For any API with
+      \c getWarmStart, \c setWarmStart and \c isProvenOptimal as well
+      (Osi1API).
+
+      \returns 1 if the solve was warm started, 0 if it wasn't.
+    */
+    template <class T>
+    inline int initialSolve (T *obj) {
+        return (initialSolve(obj, keyOf(obj))) ;
+    }
+
+    /*! \brief As #initialSolve, with the key already known
+
+      For a model whose key was worked out when it was made (as
+      SharedModel::getStructureKey is).
+    */
+    template <class T>
+    int initialSolve (T *obj, uint64_t key) {
+        CoinWarmStartBasis *basis =
+            lookup(key, obj->getNumCols(), obj->getNumRows()) ;
+        const bool warm = (basis != 0) ;
+        if (warm) {
+            obj->setWarmStart(basis) ;
+            delete basis ;
+        }
+        obj->initialSolve() ;
+        if (obj->isProvenOptimal()) {
+            CoinWarmStart *finish = obj->getWarmStart() ;
+            const CoinWarmStartBasis *finalBasis =
+                dynamic_cast<const CoinWarmStartBasis *>(finish) ;
+            if (finalBasis != 0) store(key, *finalBasis) ;
+            delete finish ;
+        }
+        return (warm ? 1 : 0) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    WarmStartCache(const WarmStartCache &rhs) ;
+    /// Assignment (not implemented)
+    WarmStartCache &operator=(const WarmStartCache &rhs) ;
+
+    /*! \brief A basis, one status byte per column then per row
+
+      The statuses are CoinWarmStartBasis::Status values.
+    */
+    struct Entry {
+        int numCols_ ;
+        int numRows_ ;
+        std::vector<unsigned char> status_ ;
+        /// Position in #lru_
+        std::list<uint64_t>::iterator lruPos_ ;
+    } ;
+    typedef std::map<uint64_t, Entry> EntryMap ;
+
+    /// Enter \p entry for \p key, dropping the oldest to stay in bounds
+    void insert(uint64_t key, const Entry &entry) ;
+    /// File holding the basis for \p key
+    std::string pathOf(uint64_t key) const ;
+    /// Read the basis for \p key from the directory; false if it's not there
+    bool readEntry(uint64_t key, Entry &entry) const ;
+    /// Write the basis for \p key to the directory
+    void writeEntry(uint64_t key, const Entry &entry) ;
+
+    /// Guards everything below
+    mutable Mutex mutex_ ;
+    /// Bases kept in memory
+    EntryMap entries_ ;
+    /// Keys in #entries_, most recently used first
+    std::list<uint64_t> lru_ ;
+    /// See #setCapacity
+    size_t capacity_ ;
+    /// See #setDirectory
+    std::string dir_ ;
+    /// Counts of lookups
+    size_t hits_ ;
+    size_t misses_ ;
+    /// Makes temporary file names unique within the process
+    unsigned int tmpSerial_ ;
+
+} ;
+
+/*! \brief Solve an object through a WarmStartCache
+
+  Made by ControlAPI::initialSolveCachedAsync. The job's status is 0; ask
+  the cache (WarmStartCache::getHits) to see whether it started warm.
+*/
+template <class T>
+class CachedSolveJob : public AsyncJob {
+public:
+    CachedSolveJob (WarmStartCache *cache, T *obj)
+        : cache_(cache), obj_(obj) { }
+    int run () {
+        cache_->initialSolve(obj_) ;
+        return (0) ;
+    }
+private:
+    WarmStartCache *cache_ ;
+    T *obj_ ;
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -1,5 +1,7 @@
 #include "OsiXForm.h"
 
+int OsiXForm::verbosity = 0;
+
 OsiXForm::OsiXForm()
 {
 }
@@ -8,20 +10,94 @@ OsiXForm::~OsiXForm()
 {
 }
 
+void OsiXForm::footprint(OsiXFormFootprint& fp)
+{
+}
+
+
+OsiXFormFootprint::OsiXFormFootprint()
+{
+    osinstance = NULL;
+}
+
+void OsiXFormFootprint::read(int space, int index)
+{
+    reads.push_back(std::make_pair(space, index));
+}
+
+void OsiXFormFootprint::write(int space, int index)
+{
+    writes.push_back(std::make_pair(space, index));
+}
+
+void OsiXFormFootprint::merge(const OsiXFormFootprint& other)
+{
+    reads.insert(reads.end(), other.reads.begin(), other.reads.end());
+    writes.insert(writes.end(), other.writes.begin(), other.writes.end());
+}
+
 
-void ModifyConstraintBounds::record( )
+// the payload is the number of constraints, a flag for each array
+// recorded (1 names, 2 lower bounds, 4 upper bounds, 8 constants) and the
+// arrays
+void ModifyConstraintBounds::record(OsiXFormJournal& journal)
 {
-    // we don't use this for now
+    OsiXFormJournal payload;
+    payload.putUnsigned(number);
+    payload.putUnsigned((names != NULL ? 1 : 0) | (lowerBounds != NULL ? 2 : 0) |
+                        (upperBounds != NULL ? 4 : 0) | (constants != NULL ? 8 : 0));
+    if (names != NULL) {
+        for (int k = 0; k < number; k++) payload.putString(names[k]);
+    }
+    if (lowerBounds != NULL) payload.putDoubles(lowerBounds, number);
+    if (upperBounds != NULL) payload.putDoubles(upperBounds, number);
+    if (constants != NULL) payload.putDoubles(constants, number);
+    journal.putEntry(opid, payload);
 }//end record()
 
 
+bool ModifyConstraintBounds::decode(OsiXFormJournalReader& reader, int& number,
+                                    std::vector<std::string>& names, std::vector<double>& lowerBounds,
+                                    std::vector<double>& upperBounds, std::vector<double>& constants)
+{
+    uint64_t count;
+    uint64_t flags;
+    if (!reader.getUnsigned(count) || !reader.getUnsigned(flags)) return false;
+    number = (int)count;
+    names.clear();
+    lowerBounds.clear();
+    upperBounds.clear();
+    constants.clear();
+    if (flags & 1) {
+        names.resize(number);
+        for (int k = 0; k < number; k++) {
+            if (!reader.getString(names[k])) return false;
+        }
+    }
+    std::vector<double>* arrays[3] = { &lowerBounds, &upperBounds, &constants };
+    for (int a = 0; a < 3; a++) {
+        if ((flags & (2 << a)) == 0) continue;
+        arrays[a]->resize(number);
+        if (number > 0 && !reader.getDoubles(&(*arrays[a])[0], number)) return false;
+    }
+    return true;
+}//end decode
+
+
 void ModifyConstraintBounds::modify()
 {
-    cout << "performing modification: " << opid << endl;
+    if (verbosity > 0) cout << "performing modification: " << opid << '\n';
     osinstance->setConstraints(number, names, lowerBounds, upperBounds, constants);
 }// end modify
 
 
+void ModifyConstraintBounds::footprint(OsiXFormFootprint& fp)
+{
+    fp.osinstance = osinstance;
+    fp.write(OsiXFormFootprint::ROWS);
+}// end footprint
+
+
 ModifyConstraintBounds::ModifyConstraintBounds(OSInstance* _osinstance, int _number,
         std::string* _names, double* _lowerBounds, double* _upperBounds, double* _constants)
 {
@@ -31,14 +107,102 @@ ModifyConstraintBounds::ModifyConstraintBounds(OSInstance* _osinstance, int _num
     lowerBounds = _lowerBounds;
     upperBounds = _upperBounds;
     constants = _constants;
-    opid = 17;
+    opid = OSIXFORM_MODIFY_CONSTRAINT_BOUNDS;
 }//end ModifyConstraintRhs
 
 ModifyConstraintBounds::ModifyConstraintBounds()
 {
-    opid = 17;
+    opid = OSIXFORM_MODIFY_CONSTRAINT_BOUNDS;
 }//end ModifyConstraintRhs
 
 ModifyConstraintBounds::~ModifyConstraintBounds()
 {
 }//end ~ModifyConstraintRhs
+
+
+void ModifyConstraintBound::record(OsiXFormJournal& journal)
+{
+    OsiXFormJournal payload;
+    payload.putInt(index);
+    payload.putDouble(lowerBound);
+    payload.putDouble(upperBound);
+    journal.putEntry(opid, payload);
+}//end record()
+
+
+bool ModifyConstraintBound::decode(OsiXFormJournalReader& reader, int& index,
+                                   double& lowerBound, double& upperBound)
+{
+    return reader.getInt(index) && reader.getDouble(lowerBound) && reader.getDouble(upperBound);
+}//end decode
+
+
+void ModifyConstraintBound::modify()
+{
+    if (verbosity > 0) cout << "performing modification: " << opid << '\n';
+    modifyBounds(osinstance, 1, &index, &lowerBound, &upperBound);
+}// end modify
+
+
+void ModifyConstraintBound::footprint(OsiXFormFootprint& fp)
+{
+    fp.osinstance = osinstance;
+    fp.read(OsiXFormFootprint::ROWS);
+    fp.write(OsiXFormFootprint::ROWS);
+}// end footprint
+
+
+// setConstraints deletes the old constraint data before it copies in the
+// new, so the current data is copied out first
+int ModifyConstraintBound::modifyBounds(OSInstance* osinstance, int number, const int* indices,
+                                        const double* lowerBounds, const double* upperBounds)
+{
+    int numCons = osinstance->getConstraintNumber();
+    if (numCons <= 0 || number <= 0) return 0;
+    double* oldLower = osinstance->getConstraintLowerBounds();
+    double* oldUpper = osinstance->getConstraintUpperBounds();
+    double* oldConstants = osinstance->getConstraintConstants();
+    std::string* oldNames = osinstance->getConstraintNames();
+    std::vector<double> lower(oldLower, oldLower + numCons);
+    std::vector<double> upper(oldUpper, oldUpper + numCons);
+    std::vector<double> constants;
+    std::vector<std::string> names;
+    if (oldConstants != NULL) constants.assign(oldConstants, oldConstants + numCons);
+    if (oldNames != NULL) names.assign(oldNames, oldNames + numCons);
+    int made = 0;
+    for (int k = 0; k < number; k++) {
+        if (indices[k] < 0 || indices[k] >= numCons) continue;
+        lower[indices[k]] = lowerBounds[k];
+        upper[indices[k]] = upperBounds[k];
+        made++;
+    }
+    if (made == 0) return 0;
+    osinstance->setConstraints(numCons, names.empty() ? NULL : &names[0],
+                               &lower[0], &upper[0],
+                               constants.empty() ? NULL : &constants[0]);
+    return made;
+}// end modifyBounds
+
+
+ModifyConstraintBound::ModifyConstraintBound(OSInstance* _osinstance, int _index,
+        double _lowerBound, double _upperBound)
+{
+    osinstance = _osinstance;
+    index = _index;
+    lowerBound = _lowerBound;
+    upperBound = _upperBound;
+    opid = OSIXFORM_MODIFY_CONSTRAINT_BOUND;
+}//end ModifyConstraintBound
+
+ModifyConstraintBound::ModifyConstraintBound()
+{
+    osinstance = NULL;
+    index = -1;
+    lowerBound = 0.0;
+    upperBound = 0.0;
+    opid = OSIXFORM_MODIFY_CONSTRAINT_BOUND;
+}//end ModifyConstraintBound
+
+ModifyConstraintBound::~ModifyConstraintBound()
+{
+}//end ~ModifyConstraintBound
@@ -7,20 +7,53 @@
 #include <string>
 #include <map>
 #include "OSInstance.h"
+#include "OsiXFormJournal.h"
 
 using std::cout;
 using std::endl;
 
+// the opid of each kind of operation; OsiXFormMgr dispatches on these
+enum OsiXFormOpid {
+    OSIXFORM_MODIFY_CONSTRAINT_BOUNDS = 17,
+    OSIXFORM_MODIFY_CONSTRAINT_BOUND = 18
+};
+
+// the parts of a model an operation reads and writes, so OsiXFormMgr knows
+// which operations it may run at the same time
+class OsiXFormFootprint {
+public:
+    enum Space { ROWS = 0, COLUMNS = 1, OBJECTIVE = 2 };
+    // the index that stands for the whole of a space
+    enum { ALL = -1 };
+    // the instance touched; NULL if the operation could touch anything, in
+    // which case it is ordered against every other operation
+    OSInstance* osinstance;
+    // (space, index) pairs read and written
+    std::vector<std::pair<int, int> > reads;
+    std::vector<std::pair<int, int> > writes;
+    OsiXFormFootprint();
+    void read(int space, int index = ALL);
+    void write(int space, int index = ALL);
+    // add what another footprint touches; the instances must match
+    void merge(const OsiXFormFootprint& other);
+}; //class OsiXFormFootprint
+
 // this is the virtual class that all command modification classes inherite from
 class OsiXForm {
 public:
-    // build a queue of operations to perform
-    virtual void record() = 0;
+    // say what modify() reads and writes. The default leaves the footprint
+    // empty, and the operation is ordered against every other
+    virtual void footprint(OsiXFormFootprint& fp);
+    // append this operation to a journal, for OsiXFormReplay
+    virtual void record(OsiXFormJournal& journal) = 0;
     // this method will execute the operations that have been accumulated in the queue
     virtual void modify() = 0;
     // opid is an integer that identifies each kind of operation, e.g. delete a constraint,
     // add a variable etc.
     int opid;
+    // print a line for each modification performed if nonzero; off by
+    // default, since modify() is called once for every operation
+    static int verbosity;
     // the constructor and destructor
     OsiXForm();
     virtual	~OsiXForm();
@@ -54,11 +87,53 @@ public:
     virtual ~ModifyConstraintBounds();
 
     // other methods
-    void record();
+    void record(OsiXFormJournal& journal);
     void modify();
+    // writes all the constraints
+    void footprint(OsiXFormFootprint& fp);
+    // read the payload record() wrote; an array not recorded comes back empty
+    static bool decode(OsiXFormJournalReader& reader, int& number,
+                       std::vector<std::string>& names, std::vector<double>& lowerBounds,
+                       std::vector<double>& upperBounds, std::vector<double>& constants);
 
 }; //class DeleteConstraints
 
 
+// change the bounds of one constraint, leaving the others alone
+// OsiXFormMgr folds a run of these into a single setConstraints call;
+// modify() on its own rewrites the constraints for just the one edit
+class ModifyConstraintBound : public OsiXForm {
+public:
+    OSInstance *osinstance;
+    int index;
+    double lowerBound;
+    double upperBound;
+// constructors and destructors
+    ModifyConstraintBound(OSInstance* _osinstance, int index, double lowerBound, double upperBound);
+    ModifyConstraintBound();
+    virtual ~ModifyConstraintBound();
+
+    // other methods
+    void record(OsiXFormJournal& journal);
+    void modify();
+    // read the payload record() wrote
+    static bool decode(OsiXFormJournalReader& reader, int& index,
+                       double& lowerBound, double& upperBound);
+    // setConstraints rewrites all the constraints, not just the one
+    void footprint(OsiXFormFootprint& fp);
+
+    /**
+     * change the bounds of a number of constraints in one setConstraints call.
+     * The edits are made in order, so where an index is repeated the last edit wins.
+     * Indices outside the instance are ignored.
+     *
+     * @return the number of edits made.
+     */
+    static int modifyBounds(OSInstance* osinstance, int number, const int* indices,
+                            const double* lowerBounds, const double* upperBounds);
+
+}; //class ModifyConstraintBound
+
+
 
 #endif /*OSIXFORM_H_*/
@@ -0,0 +1,258 @@
+#include <deque>
+
+#include "Osi2Threads.hpp"
+
+#include "OsiXFormGraph.h"
+
+namespace {
+
+// a worker's nodes ready to go
+struct Worker {
+    Osi2::Mutex lock;
+    std::deque<int> ready;
+};
+
+// what the workers share while the graph runs
+struct Shared {
+    OsiXFormGraph::Task* task;
+    const std::vector<std::vector<int> >* successors;
+    // per node, the predecessors not done yet
+    std::vector<int> waiting;
+    std::vector<Worker*> workers;
+    // guards numReady and remaining; workers with nothing to do sleep on wake
+    Osi2::Mutex lock;
+    Osi2::Condition wake;
+    int numReady;
+    int remaining;
+};
+
+struct WorkerArg {
+    Shared* shared;
+    int me;
+};
+
+void push(Shared& shared, int me, int node)
+{
+    Worker* worker = shared.workers[me];
+    worker->lock.lock();
+    worker->ready.push_back(node);
+    worker->lock.unlock();
+    Osi2::ScopedLock guard(shared.lock);
+    shared.numReady++;
+    shared.wake.wakeAll();
+}//push
+
+// the newest node from our own deque, or else the oldest from another's
+bool take(Shared& shared, int me, int& node)
+{
+    const int numWorkers = (int)shared.workers.size();
+    bool found = false;
+    for (int k = 0; k < numWorkers && !found; k++) {
+        Worker* worker = shared.workers[(me + k) % numWorkers];
+        worker->lock.lock();
+        if (!worker->ready.empty()) {
+            if (k == 0) {
+                node = worker->ready.back();
+                worker->ready.pop_back();
+            } else {
+                node = worker->ready.front();
+                worker->ready.pop_front();
+            }
+            found = true;
+        }
+        worker->lock.unlock();
+    }
+    if (found) {
+        Osi2::ScopedLock guard(shared.lock);
+        shared.numReady--;
+    }
+    return found;
+}//take
+
+// numReady can dip below zero for a moment, when a node is taken before
+// the worker that pushed it has counted it
+void work(Shared& shared, int me)
+{
+    for (;;) {
+        int node;
+        if (!take(shared, me, node)) {
+            Osi2::ScopedLock guard(shared.lock);
+            while (shared.numReady <= 0 && shared.remaining > 0)
+                shared.wake.wait(shared.lock);
+            if (shared.remaining == 0) return;
+            continue;
+        }
+        shared.task->perform(node);
+        const std::vector<int>& next = (*shared.successors)[node];
+        for (unsigned int k = 0; k < next.size(); k++) {
+            if (Osi2::atomicAdd(&shared.waiting[next[k]], -1) == 0)
+                push(shared, me, next[k]);
+        }
+        Osi2::ScopedLock guard(shared.lock);
+        if (--shared.remaining == 0) shared.wake.wakeAll();
+    }
+}//work
+
+void* startWorker(void* arg)
+{
+    WorkerArg* workerArg = static_cast<WorkerArg*>(arg);
+    work(*workerArg->shared, workerArg->me);
+    return NULL;
+}//startWorker
+
+}
+
+
+OsiXFormGraph::Task::~Task()
+{
+}
+
+OsiXFormGraph::SpaceState::SpaceState()
+{
+    wholeWriter = -1;
+}
+
+OsiXFormGraph::OsiXFormGraph()
+{
+    lastBarrier = -1;
+}
+
+OsiXFormGraph::~OsiXFormGraph()
+{
+}
+
+
+void OsiXFormGraph::clear()
+{
+    spaces.clear();
+    lastBarrier = -1;
+    sinceBarrier.clear();
+    predecessors.clear();
+    successors.clear();
+}//clear
+
+
+int OsiXFormGraph::getNumNodes()
+{
+    return (int)predecessors.size();
+}//getNumNodes
+
+
+const std::vector<int>& OsiXFormGraph::getPredecessors(int node)
+{
+    return predecessors[node];
+}//getPredecessors
+
+
+void OsiXFormGraph::order(std::set<int>& preds, int node)
+{
+    if (node >= 0) preds.insert(node);
+}//order
+
+void OsiXFormGraph::order(std::set<int>& preds, const std::vector<int>& nodes)
+{
+    preds.insert(nodes.begin(), nodes.end());
+}//order
+
+
+// For each space of each instance, keep the last node to write all of it,
+// and since then the nodes that read all of it, the nodes that touched
+// single indices, and for each index its last writer and the readers since.
+// Reads are taken before writes, so an operation that does both waits for
+// the earlier readers as well as the writers.
+int OsiXFormGraph::addNode(const OsiXFormFootprint& fp)
+{
+    const int node = (int)predecessors.size();
+    std::set<int> preds;
+    order(preds, lastBarrier);
+    if (fp.osinstance == NULL) {
+        order(preds, sinceBarrier);
+        lastBarrier = node;
+        sinceBarrier.clear();
+        spaces.clear();
+    } else {
+        for (unsigned int k = 0; k < fp.reads.size(); k++) {
+            SpaceState& state = spaces[SpaceKey(fp.osinstance, fp.reads[k].first)];
+            const int index = fp.reads[k].second;
+            order(preds, state.wholeWriter);
+            if (index == OsiXFormFootprint::ALL) {
+                order(preds, state.writers);
+                state.wholeReaders.push_back(node);
+            } else {
+                std::map<int, int>::iterator writer = state.lastWriter.find(index);
+                if (writer != state.lastWriter.end()) order(preds, writer->second);
+                state.readersSinceWrite[index].push_back(node);
+                state.readers.push_back(node);
+            }
+        }
+        for (unsigned int k = 0; k < fp.writes.size(); k++) {
+            SpaceState& state = spaces[SpaceKey(fp.osinstance, fp.writes[k].first)];
+            const int index = fp.writes[k].second;
+            order(preds, state.wholeWriter);
+            order(preds, state.wholeReaders);
+            if (index == OsiXFormFootprint::ALL) {
+                order(preds, state.writers);
+                order(preds, state.readers);
+                state = SpaceState();
+                state.wholeWriter = node;
+            } else {
+                std::map<int, int>::iterator writer = state.lastWriter.find(index);
+                if (writer != state.lastWriter.end()) order(preds, writer->second);
+                order(preds, state.readersSinceWrite[index]);
+                state.readersSinceWrite[index].clear();
+                state.lastWriter[index] = node;
+                state.writers.push_back(node);
+            }
+        }
+        sinceBarrier.push_back(node);
+    }
+    preds.erase(node);
+    predecessors.push_back(std::vector<int>(preds.begin(), preds.end()));
+    successors.push_back(std::vector<int>());
+    for (std::set<int>::iterator pred = preds.begin(); pred != preds.end(); pred++)
+        successors[*pred].push_back(node);
+    return node;
+}//addNode
+
+
+// nodes are added in the recorded order, so on one thread that order will do
+void OsiXFormGraph::run(Task& task, int numThreads)
+{
+    const int numNodes = getNumNodes();
+    if (numNodes == 0) return;
+    if (numThreads <= 1) {
+        for (int node = 0; node < numNodes; node++) task.perform(node);
+        return;
+    }
+    Shared shared;
+    shared.task = &task;
+    shared.successors = &successors;
+    shared.numReady = 0;
+    shared.remaining = numNodes;
+    shared.waiting.resize(numNodes);
+    for (int k = 0; k < numThreads; k++) shared.workers.push_back(new Worker());
+    int next = 0;
+    for (int node = 0; node < numNodes; node++) {
+        shared.waiting[node] = (int)predecessors[node].size();
+        if (shared.waiting[node] == 0) {
+            shared.workers[next]->ready.push_back(node);
+            shared.numReady++;
+            next = (next + 1) % numThreads;
+        }
+    }
+    std::vector<WorkerArg> args(numThreads);
+    std::vector<Osi2::ThreadHandle> threads;
+    std::vector<bool> started(numThreads, false);
+    for (int k = 0; k < numThreads; k++) {
+        args[k].shared = &shared;
+        args[k].me = k;
+    }
+    threads.resize(numThreads);
+    for (int k = 1; k < numThreads; k++)
+        started[k] = Osi2::startThread(threads[k], startWorker, &args[k]);
+    work(shared, 0);
+    for (int k = 1; k < numThreads; k++) {
+        if (started[k]) Osi2::joinThread(threads[k]);
+    }
+    for (int k = 0; k < numThreads; k++) delete shared.workers[k];
+}//run
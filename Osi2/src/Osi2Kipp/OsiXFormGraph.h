@@ -0,0 +1,62 @@
+#ifndef OSIXFORMGRAPH_H_
+#define OSIXFORMGRAPH_H_
+
+
+#include <vector>
+#include <map>
+#include <set>
+
+
+#include "OsiXForm.h"
+
+// the order operations must keep. Each node is an operation; a node comes
+// after every earlier node that writes something it reads or writes, or
+// reads something it writes. Nodes with no path between them may run at
+// the same time
+class OsiXFormGraph {
+public:
+    // what a worker does with a node; perform is called from several
+    // threads at once, for nodes with no path between them
+    class Task {
+    public:
+        virtual void perform(int node) = 0;
+        virtual ~Task();
+    };
+public:
+    OsiXFormGraph();
+    virtual ~OsiXFormGraph();
+    // add a node for an operation that touches fp, after the nodes already
+    // added; returns its number
+    int addNode(const OsiXFormFootprint& fp);
+    int getNumNodes();
+    // the nodes a node waits for
+    const std::vector<int>& getPredecessors(int node);
+    // perform every node, each after the nodes it waits for, on numThreads
+    // threads (the caller's and numThreads-1 more). Workers keep a deque of
+    // nodes ready to go and take from the back; a worker with an empty deque
+    // steals from the front of another's
+    void run(Task& task, int numThreads);
+    void clear();
+private:
+    // who has touched one space of one instance since it was last written as a whole
+    struct SpaceState {
+        SpaceState();
+        int wholeWriter;
+        std::vector<int> wholeReaders;
+        std::vector<int> writers;
+        std::vector<int> readers;
+        std::map<int, int> lastWriter;
+        std::map<int, std::vector<int> > readersSinceWrite;
+    };
+    typedef std::pair<OSInstance*, int> SpaceKey;
+    std::map<SpaceKey, SpaceState> spaces;
+    // the last node with an empty footprint, and the nodes since
+    int lastBarrier;
+    std::vector<int> sinceBarrier;
+    std::vector<std::vector<int> > predecessors;
+    std::vector<std::vector<int> > successors;
+    void order(std::set<int>& preds, int node);
+    void order(std::set<int>& preds, const std::vector<int>& nodes);
+};
+
+#endif /*OSIXFORMGRAPH_H_*/
@@ -0,0 +1,199 @@
+#include <cstring>
+
+#include "OsiXFormJournal.h"
+
+OsiXFormJournal::OsiXFormJournal()
+{
+}
+
+OsiXFormJournal::~OsiXFormJournal()
+{
+}
+
+
+void OsiXFormJournal::putUnsigned(uint64_t value)
+{
+    while (value >= 0x80) {
+        bytes.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((unsigned char)value);
+}//putUnsigned
+
+
+void OsiXFormJournal::putInt(int value)
+{
+    const int64_t wide = value;
+    putUnsigned(((uint64_t)wide << 1) ^ (uint64_t)(wide >> 63));
+}//putInt
+
+
+void OsiXFormJournal::putDouble(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int k = 0; k < 8; k++) {
+        bytes.push_back((unsigned char)(bits & 0xff));
+        bits >>= 8;
+    }
+}//putDouble
+
+
+void OsiXFormJournal::putDoubles(const double* values, int number)
+{
+    bytes.reserve(bytes.size() + 8*number);
+    for (int k = 0; k < number; k++) putDouble(values[k]);
+}//putDoubles
+
+
+void OsiXFormJournal::putString(const std::string& value)
+{
+    putUnsigned(value.size());
+    bytes.insert(bytes.end(), value.begin(), value.end());
+}//putString
+
+
+void OsiXFormJournal::putEntry(int opid, const OsiXFormJournal& payload)
+{
+    putUnsigned(opid);
+    putUnsigned(payload.bytes.size());
+    bytes.insert(bytes.end(), payload.bytes.begin(), payload.bytes.end());
+}//putEntry
+
+
+int OsiXFormJournal::getNumEntries()
+{
+    OsiXFormJournalReader reader(*this);
+    int opid;
+    int number = 0;
+    while (reader.nextEntry(opid)) number++;
+    return number;
+}//getNumEntries
+
+
+void OsiXFormJournal::clear()
+{
+    bytes.clear();
+}//clear
+
+
+bool OsiXFormJournal::write(std::ostream& out)
+{
+    if (!bytes.empty())
+        out.write((const char*)&bytes[0], bytes.size());
+    return out.good();
+}//write
+
+
+bool OsiXFormJournal::read(std::istream& in)
+{
+    char buffer[4096];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + in.gcount());
+    }
+    return !in.bad();
+}//read
+
+
+OsiXFormJournalReader::OsiXFormJournalReader(const OsiXFormJournal& _journal)
+    : journal(_journal)
+{
+    bad = false;
+    position = 0;
+    entryEnd = 0;
+    cursor = 0;
+}
+
+OsiXFormJournalReader::~OsiXFormJournalReader()
+{
+}
+
+
+bool OsiXFormJournalReader::getVarint(size_t& at, size_t end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && at < end; shift += 7) {
+        const unsigned char byte = journal.bytes[at++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}//getVarint
+
+
+bool OsiXFormJournalReader::nextEntry(int& opid)
+{
+    if (bad) return false;
+    size_t at = position;
+    const size_t end = journal.bytes.size();
+    uint64_t id;
+    uint64_t length;
+    if (!getVarint(at, end, id) || !getVarint(at, end, length)) return false;
+    if (length > end - at) return false;
+    opid = (int)id;
+    cursor = at;
+    entryEnd = at + length;
+    position = entryEnd;
+    return true;
+}//nextEntry
+
+
+bool OsiXFormJournalReader::entryDone()
+{
+    return cursor == entryEnd;
+}//entryDone
+
+
+bool OsiXFormJournalReader::getUnsigned(uint64_t& value)
+{
+    if (!getVarint(cursor, entryEnd, value)) bad = true;
+    return !bad;
+}//getUnsigned
+
+
+bool OsiXFormJournalReader::getInt(int& value)
+{
+    uint64_t zigzag;
+    if (!getUnsigned(zigzag)) return false;
+    value = (int)(int64_t)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    return true;
+}//getInt
+
+
+bool OsiXFormJournalReader::getDouble(double& value)
+{
+    if (entryEnd - cursor < 8) {
+        bad = true;
+        return false;
+    }
+    uint64_t bits = 0;
+    for (int k = 7; k >= 0; k--) bits = (bits << 8) | journal.bytes[cursor + k];
+    cursor += 8;
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}//getDouble
+
+
+bool OsiXFormJournalReader::getDoubles(double* values, int number)
+{
+    if (number < 0 || entryEnd - cursor < 8*(size_t)number) {
+        bad = true;
+        return false;
+    }
+    for (int k = 0; k < number; k++) getDouble(values[k]);
+    return true;
+}//getDoubles
+
+
+bool OsiXFormJournalReader::getString(std::string& value)
+{
+    uint64_t length;
+    if (!getUnsigned(length)) return false;
+    if (length > entryEnd - cursor) {
+        bad = true;
+        return false;
+    }
+    value.assign(journal.bytes.begin() + cursor, journal.bytes.begin() + cursor + length);
+    cursor += length;
+    return true;
+}//getString
@@ -0,0 +1,73 @@
+#ifndef OSIXFORMJOURNAL_H_
+#define OSIXFORMJOURNAL_H_
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+
+// an append-only record of operations, in a compact binary form, to be
+// replayed elsewhere (see OsiXFormReplay)
+//
+// Each entry is the opid and the length of the payload, as varints, then
+// the payload. A reader that doesn't know an opid can skip the entry.
+// Unsigned integers are varints, seven bits to a byte, low bits first;
+// signed integers are zigzag coded first, so small negative numbers stay
+// short. Doubles are their eight IEEE bytes, least significant first,
+// whatever the byte order of the machine.
+class OsiXFormJournal {
+public:
+    std::vector<unsigned char> bytes;
+    OsiXFormJournal();
+    virtual ~OsiXFormJournal();
+    // appending
+    void putUnsigned(uint64_t value);
+    void putInt(int value);
+    void putDouble(double value);
+    void putDoubles(const double* values, int number);
+    void putString(const std::string& value);
+    // append an entry; payload holds the bytes for the operation
+    void putEntry(int opid, const OsiXFormJournal& payload);
+    int getNumEntries();
+    void clear();
+    // the bytes, to and from a stream; read appends what it reads
+    bool write(std::ostream& out);
+    bool read(std::istream& in);
+};
+
+
+// reads a journal from the front, one entry at a time. The reader keeps
+// its place by offset, so a journal still being appended to can be read
+// as it grows
+class OsiXFormJournalReader {
+public:
+    OsiXFormJournalReader(const OsiXFormJournal& journal);
+    virtual ~OsiXFormJournalReader();
+    // move to the next entry and return its opid in opid. Returns false at
+    // the end of the journal, leaving the reader where it is; an entry not
+    // all there yet counts as the end
+    bool nextEntry(int& opid);
+    // true if the whole payload of the current entry has been read
+    bool entryDone();
+    // reading the payload of the current entry; each returns false, and
+    // marks the reader bad, if the entry is too short
+    bool getUnsigned(uint64_t& value);
+    bool getInt(int& value);
+    bool getDouble(double& value);
+    bool getDoubles(double* values, int number);
+    bool getString(std::string& value);
+    // true if the journal couldn't be read as written
+    bool bad;
+    // offset of the next entry
+    size_t position;
+private:
+    const OsiXFormJournal& journal;
+    // the end of the current entry's payload, and where the reader is in it
+    size_t entryEnd;
+    size_t cursor;
+    bool getVarint(size_t& at, size_t end, uint64_t& value);
+};
+
+#endif /*OSIXFORMJOURNAL_H_*/
@@ -1,7 +1,25 @@
+#include "Osi2Threads.hpp"
+
 #include "OsiXFormMgr.h"
 
+namespace {
+
+// the bound edits for one instance
+struct Edits {
+    std::vector<int> indices;
+    std::vector<double> lowerBounds;
+    std::vector<double> upperBounds;
+};
+
+}
+
 OsiXFormMgr::OsiXFormMgr()
 {
+    numCalls = 0;
+    numDropped = 0;
+    journal = NULL;
+    setHandler(OSIXFORM_MODIFY_CONSTRAINT_BOUNDS, &OsiXFormMgr::modifyConstraintBounds);
+    setHandler(OSIXFORM_MODIFY_CONSTRAINT_BOUND, &OsiXFormMgr::modifyConstraintBound);
 }
 
 OsiXFormMgr::~OsiXFormMgr()
@@ -14,21 +32,178 @@ OsiXFormMgr::~OsiXFormMgr()
 void OsiXFormMgr::record( OsiXForm* osmod)
 {
     modObjects.push_back( osmod);
+    if (journal != NULL) osmod->record(*journal);
 }//record
 
 
+void OsiXFormMgr::setHandler(int opid, XFormHandler handler)
+{
+    handlers[opid] = handler;
+}//setHandler
+
+
+OSInstance* OsiXFormMgr::constraintTarget(OsiXForm* osmod)
+{
+    switch( osmod->opid) {
+    case OSIXFORM_MODIFY_CONSTRAINT_BOUNDS:
+        return static_cast<ModifyConstraintBounds*>(osmod)->osinstance;
+    case OSIXFORM_MODIFY_CONSTRAINT_BOUND:
+        return static_cast<ModifyConstraintBound*>(osmod)->osinstance;
+    default:
+        return NULL;
+    }
+}//constraintTarget
+
+
+// Work back from the end of the queue. Once a ModifyConstraintBounds on an
+// instance has been seen, the constraint operations on that instance before it
+// are overwritten. An operation of any other kind may look at the instance, so
+// nothing before it is dropped.
+int OsiXFormMgr::findRedundant(std::vector<bool>& redundant)
+{
+    redundant.assign(modObjects.size(), false);
+    std::map<OSInstance*, bool> rewritten;
+    int dropped = 0;
+    for (int k = (int)modObjects.size() - 1; k >= 0; k--) {
+        OSInstance* target = constraintTarget(modObjects[k]);
+        if (target == NULL) {
+            rewritten.clear();
+            continue;
+        }
+        if (rewritten.find(target) != rewritten.end()) {
+            redundant[k] = true;
+            dropped++;
+        } else if (modObjects[k]->opid == OSIXFORM_MODIFY_CONSTRAINT_BOUNDS) {
+            rewritten[target] = true;
+        }
+    }
+    return dropped;
+}//findRedundant
+
+
 void OsiXFormMgr::callXFormClasses()
 {
-    std::vector<OsiXForm*>::iterator iter =  modObjects.begin();
-    while(iter != modObjects.end()) {
-        //(*iter)->record()
-        switch( (*iter)->opid) {
-        case 17:
-            (*iter)->modify();
-            break;
-        default:
-            cout << "unkown modification operation" << endl;
+    callXFormClasses(1);
+}
+
+
+// Each unit is a run of operations with the same opid on the same instance,
+// made in one handler call. A run of one kind on several instances is split
+// by instance, the operations on each instance keeping their order; an
+// operation with no instance in its footprint is a unit by itself.
+void OsiXFormMgr::callXFormClasses(int numThreads)
+{
+    std::vector<bool> redundant;
+    numDropped = findRedundant(redundant);
+    numCalls = 0;
+    unitXForms.clear();
+    unitStarts.clear();
+    OsiXFormGraph graph;
+    unsigned int k = 0;
+    while (k < modObjects.size()) {
+        if (redundant[k]) {
+            k++;
+            continue;
+        }
+        const int opid = modObjects[k]->opid;
+        std::vector<OSInstance*> order;
+        std::map<OSInstance*, std::vector<OsiXForm*> > runs;
+        std::map<OSInstance*, OsiXFormFootprint> footprints;
+        for (; k < modObjects.size() && (redundant[k] || modObjects[k]->opid == opid); k++) {
+            if (redundant[k]) continue;
+            OsiXFormFootprint fp;
+            modObjects[k]->footprint(fp);
+            if (fp.osinstance == NULL) {
+                unitStarts.push_back((int)unitXForms.size());
+                unitXForms.push_back(modObjects[k]);
+                graph.addNode(fp);
+                continue;
+            }
+            if (runs.find(fp.osinstance) == runs.end()) {
+                order.push_back(fp.osinstance);
+                footprints[fp.osinstance].osinstance = fp.osinstance;
+            }
+            runs[fp.osinstance].push_back(modObjects[k]);
+            footprints[fp.osinstance].merge(fp);
+        }
+        for (unsigned int i = 0; i < order.size(); i++) {
+            std::vector<OsiXForm*>& run = runs[order[i]];
+            unitStarts.push_back((int)unitXForms.size());
+            unitXForms.insert(unitXForms.end(), run.begin(), run.end());
+            graph.addNode(footprints[order[i]]);
         }
-        iter++;
     }
+    unitStarts.push_back((int)unitXForms.size());
+    UnitTask task(this);
+    graph.run(task, numThreads);
+}
+
+
+OsiXFormMgr::UnitTask::UnitTask(OsiXFormMgr* _mgr)
+{
+    mgr = _mgr;
 }
+
+void OsiXFormMgr::UnitTask::perform(int unit)
+{
+    mgr->performUnit(unit);
+}
+
+
+void OsiXFormMgr::performUnit(int unit)
+{
+    XFormIter first = unitXForms.begin() + unitStarts[unit];
+    XFormIter last = unitXForms.begin() + unitStarts[unit + 1];
+    std::map<int, XFormHandler>::iterator handler = handlers.find( (*first)->opid);
+    if (handler == handlers.end()) {
+        for (; first != last; first++)
+            cout << "unkown modification operation" << '\n';
+        return;
+    }
+    Osi2::atomicAdd(&numCalls, (this->*(handler->second))(first, last));
+}//performUnit
+
+
+// setConstraints replaces all the constraint data, so of a run on one
+// instance only the last counts; findRedundant will have dropped the others
+int OsiXFormMgr::modifyConstraintBounds(XFormIter first, XFormIter last)
+{
+    std::map<OSInstance*, OsiXForm*> latest;
+    std::vector<OSInstance*> order;
+    for (XFormIter iter = first; iter != last; iter++) {
+        OSInstance* target = static_cast<ModifyConstraintBounds*>(*iter)->osinstance;
+        if (latest.find(target) == latest.end()) order.push_back(target);
+        latest[target] = *iter;
+    }
+    for (unsigned int k = 0; k < order.size(); k++) latest[order[k]]->modify();
+    return (int)order.size();
+}//modifyConstraintBounds
+
+
+// edits to one instance go in one setConstraints call, in the order recorded
+int OsiXFormMgr::modifyConstraintBound(XFormIter first, XFormIter last)
+{
+    std::map<OSInstance*, Edits> edits;
+    std::vector<OSInstance*> order;
+    for (XFormIter iter = first; iter != last; iter++) {
+        ModifyConstraintBound* osmod = static_cast<ModifyConstraintBound*>(*iter);
+        if (edits.find(osmod->osinstance) == edits.end()) order.push_back(osmod->osinstance);
+        Edits& forInstance = edits[osmod->osinstance];
+        forInstance.indices.push_back(osmod->index);
+        forInstance.lowerBounds.push_back(osmod->lowerBound);
+        forInstance.upperBounds.push_back(osmod->upperBound);
+    }
+    int calls = 0;
+    for (unsigned int k = 0; k < order.size(); k++) {
+        Edits& forInstance = edits[order[k]];
+        if (OsiXForm::verbosity > 0)
+            cout << "performing modification: " << OSIXFORM_MODIFY_CONSTRAINT_BOUND
+                 << " x " << forInstance.indices.size() << '\n';
+        if (ModifyConstraintBound::modifyBounds(order[k], (int)forInstance.indices.size(),
+                                                &forInstance.indices[0],
+                                                &forInstance.lowerBounds[0],
+                                                &forInstance.upperBounds[0]) > 0)
+            calls++;
+    }
+    return calls;
+}//modifyConstraintBound
@@ -5,9 +5,11 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <map>
 
 
 #include "OsiXForm.h"
+#include "OsiXFormGraph.h"
 
 using std::cout;
 using std::endl;
@@ -15,14 +17,58 @@ using std::endl;
 class OsiXFormMgr {
 public:
     // the vector modObjects stores operations used to modify the instance
+    typedef std::vector<OsiXForm*>::iterator XFormIter;
+    // a handler performs a run of consecutive operations with the same opid,
+    // as few calls on the instance as it can; it returns the number of calls made
+    typedef int (OsiXFormMgr::*XFormHandler)(XFormIter first, XFormIter last);
 public:
     // members
     std::vector<OsiXForm*> modObjects;
+    // the number of calls made on instances by the last callXFormClasses
+    int numCalls;
+    // the number of operations the last callXFormClasses found redundant and dropped
+    int numDropped;
+    // if not NULL, record() also appends each operation here
+    OsiXFormJournal* journal;
     // methods
     OsiXFormMgr();
     virtual ~OsiXFormMgr();
+    // perform the recorded operations. A run of operations of the same kind is
+    // merged into one bulk call where the kind allows it, and an operation whose
+    // effect a later one overwrites is dropped
     void callXFormClasses();
+    // the same, on numThreads threads. Operations whose footprints show they
+    // touch different parts of the model may run at the same time; where two
+    // conflict they keep the recorded order. Handlers must then be safe to call
+    // from several threads for different instances
+    void callXFormClasses(int numThreads);
     void record( OsiXForm* osmod);
+    // install the handler for an opid, replacing any there is
+    void setHandler(int opid, XFormHandler handler);
+private:
+    // performs units for an OsiXFormGraph
+    class UnitTask : public OsiXFormGraph::Task {
+    public:
+        OsiXFormMgr* mgr;
+        UnitTask(OsiXFormMgr* _mgr);
+        void perform(int unit);
+    };
+    friend class UnitTask;
+    // the operations to perform, by unit; unit k is unitXForms[unitStarts[k]]
+    // up to unitXForms[unitStarts[k+1]]
+    std::vector<OsiXForm*> unitXForms;
+    std::vector<int> unitStarts;
+    void performUnit(int unit);
+    // the dispatch table, by opid
+    std::map<int, XFormHandler> handlers;
+    // the instance whose constraints the operation rewrites, or NULL if it is
+    // not one the manager knows to touch only constraints
+    static OSInstance* constraintTarget(OsiXForm* osmod);
+    // mark the operations that a later rewrite of all the constraints overwrites
+    int findRedundant(std::vector<bool>& redundant);
+    // the handlers
+    int modifyConstraintBounds(XFormIter first, XFormIter last);
+    int modifyConstraintBound(XFormIter first, XFormIter last);
 };
 
 #endif /*OSIXFORMMGR_H_*/
@@ -0,0 +1,68 @@
+#include <algorithm>
+
+#include "OsiXFormReplay.h"
+
+OsiXFormReplay::OsiXFormReplay()
+{
+    numSkipped = 0;
+}
+
+OsiXFormReplay::~OsiXFormReplay()
+{
+    for (unsigned int k = 0; k < made.size(); k++) delete made[k];
+    for (unsigned int k = 0; k < nameArrays.size(); k++) delete[] nameArrays[k];
+    for (unsigned int k = 0; k < doubleArrays.size(); k++) delete[] doubleArrays[k];
+}
+
+
+double* OsiXFormReplay::keep(const std::vector<double>& vec)
+{
+    if (vec.empty()) return NULL;
+    double* array = new double[vec.size()];
+    std::copy(vec.begin(), vec.end(), array);
+    doubleArrays.push_back(array);
+    return array;
+}//keep
+
+std::string* OsiXFormReplay::keep(const std::vector<std::string>& vec)
+{
+    if (vec.empty()) return NULL;
+    std::string* array = new std::string[vec.size()];
+    std::copy(vec.begin(), vec.end(), array);
+    nameArrays.push_back(array);
+    return array;
+}//keep
+
+
+int OsiXFormReplay::replay(OsiXFormJournalReader& reader, OSInstance* target, OsiXFormMgr& mgr)
+{
+    numSkipped = 0;
+    std::vector<std::string> names;
+    std::vector<double> lower;
+    std::vector<double> upper;
+    std::vector<double> constants;
+    int replayed = 0;
+    int opid;
+    while (reader.nextEntry(opid)) {
+        OsiXForm* osmod = NULL;
+        if (opid == OSIXFORM_MODIFY_CONSTRAINT_BOUND) {
+            int index;
+            double lb, ub;
+            if (!ModifyConstraintBound::decode(reader, index, lb, ub)) break;
+            osmod = new ModifyConstraintBound(target, index, lb, ub);
+        } else if (opid == OSIXFORM_MODIFY_CONSTRAINT_BOUNDS) {
+            int number;
+            if (!ModifyConstraintBounds::decode(reader, number, names, lower, upper, constants))
+                break;
+            osmod = new ModifyConstraintBounds(target, number, keep(names), keep(lower),
+                                               keep(upper), keep(constants));
+        } else {
+            numSkipped++;
+            continue;
+        }
+        made.push_back(osmod);
+        mgr.record(osmod);
+        replayed++;
+    }
+    return reader.bad ? -1 : replayed;
+}//replay
@@ -0,0 +1,91 @@
+#ifndef OSIXFORMREPLAY_H_
+#define OSIXFORMREPLAY_H_
+
+
+#include <vector>
+#include <string>
+
+
+#include "OsiXForm.h"
+#include "OsiXFormMgr.h"
+#include "OsiXFormJournal.h"
+
+// plays a journal back, either as operations for an OsiXFormMgr or
+// straight into a solver object. Replay goes from the reader's place to the
+// end of what has been written, so a replica can be fed a journal as it
+// arrives and replay it bit by bit
+class OsiXFormReplay {
+public:
+    // entries skipped by the last replay because their opid is unknown
+    int numSkipped;
+    OsiXFormReplay();
+    // deletes the operations and arrays the replay has made
+    virtual ~OsiXFormReplay();
+    // make the operations in the journal, against target, and record them in
+    // mgr. The operations belong to the replay. Returns the number of entries
+    // replayed, or -1 if the journal is bad
+    int replay(OsiXFormJournalReader& reader, OSInstance* target, OsiXFormMgr& mgr);
+    // make the operations in the journal on an object with the Osi1API row
+    // bound methods. The bound edits go to setRowSetBounds in one call;
+    // constraint constants are moved into the bounds, and names are dropped.
+    // ModifyConstraintBounds must give one bound for each row. Returns the
+    // number of entries replayed, or -1 if the journal is bad or doesn't fit
+    template <class T>
+    int replay(OsiXFormJournalReader& reader, T* obj)
+    {
+        numSkipped = 0;
+        const int numRows = obj->getNumRows();
+        const double inf = obj->getInfinity();
+        std::vector<int> rows;
+        std::vector<double> bounds;
+        std::vector<std::string> names;
+        std::vector<double> lower;
+        std::vector<double> upper;
+        std::vector<double> constants;
+        int replayed = 0;
+        bool fits = true;
+        int opid;
+        while (reader.nextEntry(opid)) {
+            if (opid == OSIXFORM_MODIFY_CONSTRAINT_BOUND) {
+                int index;
+                double lb, ub;
+                if (!ModifyConstraintBound::decode(reader, index, lb, ub)) break;
+                if (index >= 0 && index < numRows) {
+                    rows.push_back(index);
+                    bounds.push_back(lb);
+                    bounds.push_back(ub);
+                }
+            } else if (opid == OSIXFORM_MODIFY_CONSTRAINT_BOUNDS) {
+                int number;
+                if (!ModifyConstraintBounds::decode(reader, number, names, lower, upper, constants))
+                    break;
+                fits = (number == numRows);
+                if (!fits) break;
+                for (int i = 0; i < number; i++) {
+                    const double c = constants.empty() ? 0.0 : constants[i];
+                    const double lb = lower.empty() ? -inf : lower[i];
+                    const double ub = upper.empty() ? inf : upper[i];
+                    rows.push_back(i);
+                    bounds.push_back(lb <= -inf ? lb : lb - c);
+                    bounds.push_back(ub >= inf ? ub : ub - c);
+                }
+            } else {
+                numSkipped++;
+                continue;
+            }
+            replayed++;
+        }
+        if (!rows.empty())
+            obj->setRowSetBounds(&rows[0], &rows[0] + rows.size(), &bounds[0]);
+        return (reader.bad || !fits) ? -1 : replayed;
+    }
+private:
+    std::vector<OsiXForm*> made;
+    std::vector<std::string*> nameArrays;
+    std::vector<double*> doubleArrays;
+    // a copy of vec that lives as long as the replay, or NULL if vec is empty
+    double* keep(const std::vector<double>& vec);
+    std::string* keep(const std::vector<std::string>& vec);
+};
+
+#endif /*OSIXFORMREPLAY_H_*/
@@ -0,0 +1,60 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ApiTraits.hpp
+    \brief Compile-time identity of API classes.
+
+  An API class names itself to the plugin framework with #OSI2_API_TRAITS,
+  next to its definition:
+  <pre>
+    OSI2_API_TRAITS(ProbMgmtAPI, "ProbMgmt", ApiID_ProbMgmt)
+  </pre>
+  after which PluginManager::createObject<ProbMgmtAPI> and
+  ControlAPI::createObject(ProbMgmtAPI *&) need no API name, and the
+  object comes back with the right type. Asking for an object of a class
+  without traits doesn't compile.
+*/
+
+#ifndef OSI2APITRAITS_HPP
+#define OSI2APITRAITS_HPP
+
+namespace Osi2 {
+
+/*! \brief Compile-time IDs of the Osi2 APIs
+
+  Positive, unique, and less than PluginManager::maxApiID. An API defined
+  outside Osi2 takes a number from \c ApiID_User up.
+*/
+enum ApiID {
+    ApiID_ProbMgmt = 1,
+    ApiID_Osi1 = 2,
+    ApiID_User = 16
+} ;
+
+/*! \brief What the plugin framework knows of API class \p T
+
+  Specialised by #OSI2_API_TRAITS, which supplies
+  <ul>
+    <li> \c name(), the name the API is registered under, and
+    <li> \c id, its ApiID.
+  </ul>
+  Deliberately not defined otherwise.
+*/
+template <class T> struct ApiTraits ;
+
+/*! \brief Give API class \p zz_class the name \p zz_name and ID \p zz_id
+
+  Use at namespace scope in namespace Osi2.
+*/
+#define OSI2_API_TRAITS(zz_class, zz_name, zz_id) \
+    template <> struct ApiTraits<zz_class> { \
+        static inline const char *name () { return (zz_name) ; } \
+        enum { id = zz_id } ; \
+    } ;
+
+}  // end namespace Osi2
+
+#endif
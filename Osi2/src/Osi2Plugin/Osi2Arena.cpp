@@ -0,0 +1,169 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Arena.cpp
+    \brief Method definitions for Osi2::ArenaPool
+*/
+
+#include <cstdlib>
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2Arena.hpp"
+
+namespace Osi2 {
+
+const size_t ArenaPool::chunkSize ;
+const int ArenaPool::maxSpare ;
+const size_t ArenaPool::align ;
+
+ArenaPool::ArenaPool ()
+    : spare_(nullptr),
+      numSpare_(0),
+      numChunks_(0),
+      bytes_(0)
+{ }
+
+/*
+  Whatever the plugin left behind goes with the library. No account is
+  charged here; the library's account goes too.
+*/
+ArenaPool::~ArenaPool ()
+{
+    std::map<const void *, Arena>::iterator iter ;
+    for (iter = arenas_.begin() ; iter != arenas_.end() ; iter++) {
+        Chunk *chunk = iter->second.chunks_ ;
+        while (chunk != nullptr) {
+            Chunk *next = chunk->next_ ;
+            std::free(chunk) ;
+            chunk = next ;
+        }
+    }
+    while (spare_ != nullptr) {
+        Chunk *next = spare_->next_ ;
+        std::free(spare_) ;
+        spare_ = next ;
+    }
+}
+
+size_t ArenaPool::headerSize ()
+{
+    return ((sizeof(Chunk)+align-1)/align*align) ;
+}
+
+ArenaPool::Chunk *ArenaPool::takeChunk (size_t size)
+{
+    Chunk *chunk = nullptr ;
+    if (size <= chunkSize && spare_ != nullptr) {
+        chunk = spare_ ;
+        spare_ = chunk->next_ ;
+        numSpare_-- ;
+    } else {
+        if (size < chunkSize) size = chunkSize ;
+        chunk = static_cast<Chunk *>(std::malloc(size)) ;
+        if (chunk == nullptr) return (nullptr) ;
+        chunk->size_ = size ;
+    }
+    chunk->next_ = nullptr ;
+    chunk->used_ = headerSize() ;
+    return (chunk) ;
+}
+
+void ArenaPool::dropChunk (Chunk *chunk)
+{
+    if (chunk->size_ == chunkSize && numSpare_ < maxSpare) {
+        chunk->next_ = spare_ ;
+        spare_ = chunk ;
+        numSpare_++ ;
+    } else {
+        std::free(chunk) ;
+    }
+}
+
+/*
+  A block that would take more than a quarter of a chunk gets a chunk of
+  its own, placed behind the head so the head's free space isn't lost; the
+  head is the only chunk ever carved up.
+*/
+void *ArenaPool::alloc (const void *owner, size_t bytes, MemAccount &account)
+{
+    if (bytes == 0) bytes = 1 ;
+    const size_t need = (bytes+align-1)/align*align ;
+    ScopedLock lock(mutex_) ;
+    std::map<const void *, Arena>::iterator iter = arenas_.find(owner) ;
+    Chunk *head = (iter == arenas_.end()) ? nullptr : iter->second.chunks_ ;
+    if (head != nullptr && head->size_-head->used_ >= need) {
+        void *block = reinterpret_cast<char *>(head)+head->used_ ;
+        head->used_ += need ;
+        return (block) ;
+    }
+    const bool own = (need > (chunkSize-headerSize())/4) ;
+    Chunk *chunk = takeChunk(own ? headerSize()+need : chunkSize) ;
+    if (chunk == nullptr) return (nullptr) ;
+    if (account.charge(owner, static_cast<int64_t>(chunk->size_)) < 0) {
+        dropChunk(chunk) ;
+        return (nullptr) ;
+    }
+    if (iter == arenas_.end()) {
+        Arena fresh ;
+        fresh.chunks_ = nullptr ;
+        fresh.bytes_ = 0 ;
+        fresh.numChunks_ = 0 ;
+        iter = arenas_.insert(std::make_pair(owner, fresh)).first ;
+    }
+    Arena &arena = iter->second ;
+    if (own && head != nullptr) {
+        chunk->next_ = head->next_ ;
+        head->next_ = chunk ;
+    } else {
+        chunk->next_ = head ;
+        arena.chunks_ = chunk ;
+    }
+    arena.bytes_ += chunk->size_ ;
+    arena.numChunks_++ ;
+    numChunks_++ ;
+    bytes_ += chunk->size_ ;
+    void *block = reinterpret_cast<char *>(chunk)+chunk->used_ ;
+    chunk->used_ += need ;
+    return (block) ;
+}
+
+int64_t ArenaPool::release (const void *owner, MemAccount &account)
+{
+    ScopedLock lock(mutex_) ;
+    std::map<const void *, Arena>::iterator iter = arenas_.find(owner) ;
+    if (iter == arenas_.end()) return (0) ;
+    Arena &arena = iter->second ;
+    Chunk *chunk = arena.chunks_ ;
+    while (chunk != nullptr) {
+        Chunk *next = chunk->next_ ;
+        dropChunk(chunk) ;
+        chunk = next ;
+    }
+    const int64_t released = arena.bytes_ ;
+    numChunks_ -= arena.numChunks_ ;
+    bytes_ -= released ;
+    arenas_.erase(iter) ;
+    account.charge(owner, -released) ;
+    return (released) ;
+}
+
+bool ArenaPool::hasArena (const void *owner) const
+{
+    ScopedLock lock(mutex_) ;
+    return (arenas_.count(owner) != 0) ;
+}
+
+void ArenaPool::getStats (Stats &stats) const
+{
+    ScopedLock lock(mutex_) ;
+    stats.numArenas_ = static_cast<int>(arenas_.size()) ;
+    stats.numChunks_ = numChunks_ ;
+    stats.numSpare_ = numSpare_ ;
+    stats.bytes_ = bytes_ ;
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,155 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Arena.hpp
+    \brief Arena allocation for a plugin library.
+
+  See Osi2::ArenaPool.
+*/
+
+#ifndef OSI2ARENA_HPP
+#define OSI2ARENA_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+
+#include "Osi2Threads.hpp"
+#include "Osi2MemAccount.hpp"
+
+namespace Osi2 {
+
+/*! \brief Arenas for the objects of one plugin library
+
+  A plugin asks for memory through the
+  \link Osi2::PlatformServices#arenaAlloc_ arenaAlloc_ \endlink service (see
+  Osi2PluginMem.hpp), naming an owner: one of its objects, or a key of its
+  own for a job. Each owner has an arena, a list of chunks carved up in
+  order; nothing in an arena is freed on its own. The whole arena goes at
+  once, when the owner is released: by the plugin manager when it destroys
+  the object, or by the plugin when the job is done.
+
+  Chunks are #chunkSize bytes, and a released arena's chunks are kept, up
+  to #maxSpare of them, for the next arena. A request too big to share a
+  chunk gets one of its own, which is freed with its arena. Chunks are
+  charged to the owner in the library's MemAccount as they're taken, so
+  arenas count against the library's limits; a chunk that would take the
+  library over its hard limit isn't taken, and the request fails.
+
+  All methods are thread-safe.
+*/
+class ArenaPool {
+
+public:
+
+    /// Size of a standard chunk, header included
+    static const size_t chunkSize = 64*1024 ;
+    /// Most released chunks kept for reuse
+    static const int maxSpare = 16 ;
+    /// Alignment of every block handed out
+    static const size_t align = 16 ;
+
+    /// A snapshot of the pool
+    struct Stats {
+        /// Owners with an arena
+        int numArenas_ ;
+        /// Chunks held by arenas
+        int numChunks_ ;
+        /// Chunks kept for reuse
+        int numSpare_ ;
+        /// Bytes held by arenas, in whole chunks
+        int64_t bytes_ ;
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; no arenas
+    ArenaPool() ;
+
+    /// Destructor; frees everything, arenas and spares
+    ~ArenaPool() ;
+    //@}
+
+    /// \name Allocation
+    //@{
+    /*! \brief Allocate \p bytes in \p owner's arena
+
+      The block is aligned to #align bytes. Returns null if a new chunk is
+      needed and \p account refuses it, or if malloc fails.
+    */
+    void *alloc(const void *owner, size_t bytes, MemAccount &account) ;
+
+    /*! \brief Free \p owner's arena
+
+      Everything allocated for \p owner goes at once, and its charge in
+      \p account with it. Returns the bytes released.
+    */
+    int64_t release(const void *owner, MemAccount &account) ;
+
+    /// True if \p owner has an arena
+    bool hasArena(const void *owner) const ;
+    //@}
+
+    /// \name Queries
+    //@{
+    /// Snapshot of the pool
+    void getStats(Stats &stats) const ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    ArenaPool(const ArenaPool &rhs) ;
+    /// Assignment (not implemented)
+    ArenaPool &operator=(const ArenaPool &rhs) ;
+
+    /// Head of a chunk; the blocks follow it
+    struct Chunk {
+        /// Next chunk in the arena or the spare list
+        Chunk *next_ ;
+        /// Size of the chunk, header included
+        size_t size_ ;
+        /// Bytes carved off, header included
+        size_t used_ ;
+    } ;
+
+    /// One owner's arena
+    struct Arena {
+        /// Chunks, the one being carved up first
+        Chunk *chunks_ ;
+        /// Bytes held, in whole chunks
+        int64_t bytes_ ;
+        /// Number of chunks
+        int numChunks_ ;
+    } ;
+
+    /// Size of a chunk header, rounded up to #align
+    static size_t headerSize() ;
+
+    /// Take a chunk of at least \p size bytes, header included
+    Chunk *takeChunk(size_t size) ;
+
+    /// Keep \p chunk as a spare, or free it
+    void dropChunk(Chunk *chunk) ;
+
+    /// Arenas, by owner
+    std::map<const void *, Arena> arenas_ ;
+    /// Chunks kept for reuse, all of #chunkSize
+    Chunk *spare_ ;
+    /// Number of spares
+    int numSpare_ ;
+    /// Chunks held by arenas
+    int numChunks_ ;
+    /// Bytes held by arenas
+    int64_t bytes_ ;
+    /// Serialises everything
+    mutable Mutex mutex_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
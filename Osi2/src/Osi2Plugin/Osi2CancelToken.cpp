@@ -0,0 +1,123 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2CancelToken.cpp
+    \brief Method definitions for Osi2::CancelToken
+*/
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2CancelToken.hpp"
+#include "Osi2PerfStats.hpp"
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*
+  The request behind a token. The flags are read without the lock, so that
+  a solver can look at a token on every iteration for the price of a load;
+  once the deadline has been seen to pass, expired_ saves reading the clock
+  again.
+*/
+struct CancelState {
+    CancelState ()
+        : refs_(1),
+          cancelled_(0),
+          expired_(0),
+          hasDeadline_(false),
+          deadline_(0)
+    { }
+
+    /// References
+    volatile int refs_ ;
+    /// Set by cancel
+    volatile int cancelled_ ;
+    /// Set once the deadline is seen to have passed
+    volatile int expired_ ;
+    /// Guards #hasDeadline_ and #deadline_
+    Mutex mutex_ ;
+    /// True if there's a deadline
+    bool hasDeadline_ ;
+    /// The deadline, in PerfStats::now ticks (nanoseconds)
+    uint64_t deadline_ ;
+} ;
+
+namespace {
+
+const uint64_t ticksPerMillisec = 1000000 ;
+
+}   // end unnamed file-local namespace
+
+CancelToken::CancelToken ()
+    : state_(new CancelState())
+{ }
+
+CancelToken::CancelToken (const CancelToken &rhs)
+    : state_(rhs.state_)
+{
+    atomicAdd(&state_->refs_, 1) ;
+}
+
+CancelToken &CancelToken::operator= (const CancelToken &rhs)
+{
+    atomicAdd(&rhs.state_->refs_, 1) ;
+    if (atomicAdd(&state_->refs_, -1) == 0) delete state_ ;
+    state_ = rhs.state_ ;
+    return (*this) ;
+}
+
+CancelToken::~CancelToken ()
+{
+    if (atomicAdd(&state_->refs_, -1) == 0) delete state_ ;
+}
+
+void CancelToken::cancel ()
+{
+    atomicAdd(&state_->cancelled_, 1) ;
+}
+
+void CancelToken::setDeadline (int millisecs)
+{
+    ScopedLock lock(state_->mutex_) ;
+    state_->hasDeadline_ = (millisecs >= 0) ;
+    state_->deadline_ = PerfStats::now() +
+        static_cast<uint64_t>((millisecs >= 0) ? millisecs : 0)*ticksPerMillisec ;
+    state_->expired_ = 0 ;
+}
+
+bool CancelToken::isCancelled () const
+{
+    return (atomicLoad(&state_->cancelled_) != 0) ;
+}
+
+bool CancelToken::isExpired () const
+{
+    if (atomicLoad(&state_->expired_) != 0) return (true) ;
+    ScopedLock lock(state_->mutex_) ;
+    if (!state_->hasDeadline_ || PerfStats::now() < state_->deadline_)
+        return (false) ;
+    state_->expired_ = 1 ;
+    return (true) ;
+}
+
+int CancelToken::getMillisecsLeft () const
+{
+    ScopedLock lock(state_->mutex_) ;
+    if (!state_->hasDeadline_) return (-1) ;
+    const uint64_t now = PerfStats::now() ;
+    if (now >= state_->deadline_) return (0) ;
+    return (static_cast<int>((state_->deadline_-now+ticksPerMillisec-1)/
+                             ticksPerMillisec)) ;
+}
+
+CancelToken::Reason CancelToken::getStopReason () const
+{
+    if (isCancelled()) return (Cancelled) ;
+    if (isExpired()) return (DeadlineExpired) ;
+    return (None) ;
+}
+
+}  // end namespace Osi2
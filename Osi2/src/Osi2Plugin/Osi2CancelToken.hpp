@@ -0,0 +1,120 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2CancelToken.hpp
+    \brief Cancellation and deadlines for solves.
+
+  See Osi2::CancelToken.
+*/
+
+#ifndef OSI2CANCELTOKEN_HPP
+#define OSI2CANCELTOKEN_HPP
+
+#include <stdint.h>
+
+namespace Osi2 {
+
+struct CancelState ;
+
+/*! \brief A request to stop, shared by a client and the solves it started
+
+  The client makes a token and attaches it to a solver object
+  (ProbMgmtAPI::setCancelToken, Osi1API::setCancelToken). From any thread,
+  at any time, it can then #cancel the token, or give it a deadline. The
+  object looks at the token while it solves and stops, cleanly, at the
+  next point where the solver can be interrupted: a cancelled solve
+  reports that it was abandoned, one that ran out of time that it hit a
+  limit.
+
+  How often the token is looked at depends on the solver; some can only
+  look before the solve starts. setCancelToken says whether the object can
+  stop a solve once it's running.
+
+  Tokens are cheap to copy; all copies refer to the same request. One
+  token can be attached to many objects (the entrants of a race, say), and
+  cancelling it stops them all. A token stays cancelled; make a new one
+  for the next solve.
+*/
+class CancelToken {
+
+public:
+
+    /// Why a solve should stop
+    enum Reason {
+        /// It shouldn't
+        None = 0,
+        /// The token was cancelled
+        Cancelled,
+        /// The deadline has passed
+        DeadlineExpired
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; a token that isn't cancelled and has no deadline
+    CancelToken() ;
+    /// Copy constructor; the copy refers to the same request
+    CancelToken(const CancelToken &rhs) ;
+    /// Assignment; refer to \p rhs's request
+    CancelToken &operator=(const CancelToken &rhs) ;
+    /// Destructor
+    ~CancelToken() ;
+    //@}
+
+    /// \name Control
+    //@{
+    /// Ask every solve that holds the token to stop
+    void cancel() ;
+
+    /*! \brief Stop solves \p millisecs milliseconds from now
+
+      Replaces any earlier deadline; a negative value removes it.
+    */
+    void setDeadline(int millisecs) ;
+    //@}
+
+    /// \name Queries
+    //@{
+    /// True if #cancel has been called
+    bool isCancelled() const ;
+
+    /// True if the deadline has passed
+    bool isExpired() const ;
+
+    /*! \brief Milliseconds to the deadline
+
+      -1 if there's no deadline, 0 if it has passed.
+    */
+    int getMillisecsLeft() const ;
+
+    /*! \brief Why a solve holding the token should stop now
+
+      Cancellation wins over the deadline. Cheap enough to call on every
+      iteration.
+    */
+    Reason getStopReason() const ;
+
+    /// True if a solve holding the token should stop now
+    inline bool shouldStop () const {
+        return (getStopReason() != None) ;
+    }
+
+    /// True if \p rhs refers to the same request
+    inline bool sameAs (const CancelToken &rhs) const {
+        return (state_ == rhs.state_) ;
+    }
+    //@}
+
+private:
+
+    /// The request, shared by all copies
+    CancelState *state_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
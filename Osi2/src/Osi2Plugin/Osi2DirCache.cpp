@@ -0,0 +1,361 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2DirCache.cpp
+    \brief Method definitions for Osi2::DirCache
+*/
+
+#include <cstring>
+#include <cerrno>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+/*
+  Watching needs inotify, which is Linux-specific.
+*/
+#if defined(__linux__)
+# include <sys/inotify.h>
+# define OSI2_HAVE_INOTIFY 1
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2DirCache.hpp"
+
+using namespace Osi2 ;
+
+namespace {
+
+#ifdef OSI2_HAVE_INOTIFY
+/*
+  Events that can change what a listing would show. A write shows up once,
+  when the writer closes the file, rather than at every write.
+*/
+const uint32_t watchMask = IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO|
+                           IN_CLOSE_WRITE|IN_ATTRIB|
+                           IN_DELETE_SELF|IN_MOVE_SELF|IN_ONLYDIR ;
+#endif
+
+#ifndef WIN32
+/*
+  Restate one entry, relative to the open directory. Symbolic links are
+  followed, as dlopen would.
+*/
+bool statEntry (int dirFd, const char *name, DirCache::Entry &entry)
+{
+    struct stat st ;
+    if (::fstatat(dirFd, name, &st, 0) != 0) return (false) ;
+    entry.isFile_ = S_ISREG(st.st_mode) ;
+    entry.isDir_ = S_ISDIR(st.st_mode) ;
+    entry.size_ = static_cast<int64_t>(st.st_size) ;
+    entry.mtime_ = static_cast<int64_t>(st.st_mtime) ;
+    entry.inode_ = static_cast<uint64_t>(st.st_ino) ;
+    return (true) ;
+}
+#endif
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+DirCache::DirCache ()
+    : notifyFd_(-1),
+      numFullScans_(0)
+{
+#   ifdef OSI2_HAVE_INOTIFY
+    notifyFd_ = ::inotify_init1(IN_NONBLOCK|IN_CLOEXEC) ;
+#   endif
+}
+
+DirCache::~DirCache ()
+{
+    clear() ;
+#   ifndef WIN32
+    if (notifyFd_ >= 0) ::close(notifyFd_) ;
+#   endif
+}
+
+void DirCache::closeDir (DirState &state)
+{
+#   ifdef OSI2_HAVE_INOTIFY
+    if (state.watch_ >= 0) {
+        if (notifyFd_ >= 0) ::inotify_rm_watch(notifyFd_, state.watch_) ;
+        watchToDir_.erase(state.watch_) ;
+    }
+#   endif
+#   ifndef WIN32
+    if (state.dirFd_ >= 0) ::close(state.dirFd_) ;
+#   endif
+    state.watch_ = -1 ;
+    state.dirFd_ = -1 ;
+    state.valid_ = false ;
+}
+
+void DirCache::clear ()
+{
+    ScopedLock lock(mutex_) ;
+    for (std::map<std::string, DirState>::iterator iter = dirs_.begin() ;
+            iter != dirs_.end() ; iter++)
+        closeDir(iter->second) ;
+    dirs_.clear() ;
+}
+
+/*
+  The watch is set before the directory is read, so that nothing that
+  happens during the listing is missed; an event for something the listing
+  already saw just restates it. With a previous listing in hand, the names
+  whose entries differ are changes.
+*/
+int DirCache::fullScan (const std::string &dir, DirState &state,
+                        std::string &errStr)
+{
+    closeDir(state) ;
+    atomicAdd(&numFullScans_, 1) ;
+    EntryMap entries ;
+#   ifdef WIN32
+    WIN32_FIND_DATAA data ;
+    std::string pattern = dir + "\\*" ;
+    HANDLE handle = ::FindFirstFileA(pattern.c_str(), &data) ;
+    if (handle == INVALID_HANDLE_VALUE) {
+        if (::GetLastError() != ERROR_FILE_NOT_FOUND) {
+            errStr = "FindFirstFile failed" ;
+            return (-1) ;
+        }
+    } else {
+        do {
+            const std::string name(data.cFileName) ;
+            if (name == "." || name == "..") continue ;
+            Entry &entry = entries[name] ;
+            entry.isDir_ =
+                ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) ;
+            entry.isFile_ = !entry.isDir_ ;
+            entry.size_ = (static_cast<int64_t>(data.nFileSizeHigh) << 32) |
+                          data.nFileSizeLow ;
+            entry.mtime_ =
+                (static_cast<int64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                data.ftLastWriteTime.dwLowDateTime ;
+            entry.inode_ = 0 ;
+        } while (::FindNextFileA(handle, &data)) ;
+        ::FindClose(handle) ;
+    }
+#   else
+    int flags = O_RDONLY ;
+#     ifdef O_DIRECTORY
+    flags |= O_DIRECTORY ;
+#     endif
+#     ifdef O_CLOEXEC
+    flags |= O_CLOEXEC ;
+#     endif
+    const int dirFd = ::open(dir.c_str(), flags) ;
+    if (dirFd < 0) {
+        errStr = std::strerror(errno) ;
+        return (-1) ;
+    }
+    int watch = -1 ;
+#     ifdef OSI2_HAVE_INOTIFY
+    if (notifyFd_ >= 0) {
+        watch = ::inotify_add_watch(notifyFd_, dir.c_str(), watchMask) ;
+        if (watch >= 0) watchToDir_[watch] = dir ;
+    }
+#     endif
+    /*
+      fdopendir takes over the descriptor it's given; give it a copy, so
+      that ours stays open for restating entries later.
+    */
+    const int listFd = ::dup(dirFd) ;
+    DIR *dirp = (listFd < 0)?nullptr:(::fdopendir(listFd)) ;
+    if (dirp == nullptr) {
+        errStr = std::strerror(errno) ;
+        if (listFd >= 0) ::close(listFd) ;
+        state.dirFd_ = dirFd ;
+        state.watch_ = watch ;
+        closeDir(state) ;
+        return (-1) ;
+    }
+    for (struct dirent *dirEnt = ::readdir(dirp) ;
+            dirEnt != nullptr ;
+            dirEnt = ::readdir(dirp)) {
+        const char *name = dirEnt->d_name ;
+        if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0)
+            continue ;
+        Entry entry ;
+        if (statEntry(dirFd, name, entry)) entries[name] = entry ;
+    }
+    ::closedir(dirp) ;
+    state.dirFd_ = dirFd ;
+    state.watch_ = watch ;
+#   endif
+
+    if (state.listed_) {
+        for (EntryMap::const_iterator iter = state.entries_.begin() ;
+                iter != state.entries_.end() ; iter++) {
+            EntryMap::const_iterator other = entries.find(iter->first) ;
+            if (other == entries.end() || !other->second.sameAs(iter->second))
+                state.changed_.insert(iter->first) ;
+        }
+        for (EntryMap::const_iterator iter = entries.begin() ;
+                iter != entries.end() ; iter++) {
+            if (state.entries_.find(iter->first) == state.entries_.end())
+                state.changed_.insert(iter->first) ;
+        }
+    }
+    state.entries_.swap(entries) ;
+    state.listed_ = true ;
+    state.valid_ = (state.watch_ >= 0) ;
+    return (0) ;
+}
+
+void DirCache::updateEntry (DirState &state, const std::string &name,
+                            bool written)
+{
+#   ifndef WIN32
+    Entry entry ;
+    EntryMap::iterator iter = state.entries_.find(name) ;
+    if (statEntry(state.dirFd_, name.c_str(), entry)) {
+        if (iter == state.entries_.end()) {
+            state.entries_[name] = entry ;
+            state.changed_.insert(name) ;
+        } else if (written || !iter->second.sameAs(entry)) {
+            iter->second = entry ;
+            state.changed_.insert(name) ;
+        }
+    } else if (iter != state.entries_.end()) {
+        state.entries_.erase(iter) ;
+        state.changed_.insert(name) ;
+    }
+#   endif
+}
+
+/*
+  An overflowed event queue means events were lost; everything is listed
+  again. A directory that's been removed or renamed loses its watch and is
+  listed again (or fails to be) at the next request.
+*/
+void DirCache::applyEvents ()
+{
+#   ifdef OSI2_HAVE_INOTIFY
+    union {
+        struct inotify_event event_ ;
+        char bytes_[8192] ;
+    } buf ;
+    for (;;) {
+        const ssize_t len = ::read(notifyFd_, buf.bytes_, sizeof(buf.bytes_)) ;
+        if (len <= 0) break ;
+        for (ssize_t pos = 0 ; pos < len ; ) {
+            const struct inotify_event *event =
+                reinterpret_cast<const struct inotify_event *>(buf.bytes_+pos) ;
+            pos += sizeof(struct inotify_event) + event->len ;
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (std::map<std::string, DirState>::iterator iter =
+                            dirs_.begin() ;
+                        iter != dirs_.end() ; iter++)
+                    iter->second.valid_ = false ;
+                continue ;
+            }
+            std::map<int, std::string>::iterator wIter =
+                watchToDir_.find(event->wd) ;
+            if (wIter == watchToDir_.end()) continue ;
+            DirState &state = dirs_[wIter->second] ;
+            if (event->mask & IN_IGNORED) {
+                watchToDir_.erase(wIter) ;
+                state.watch_ = -1 ;
+                state.valid_ = false ;
+            } else if (event->mask & (IN_DELETE_SELF|IN_MOVE_SELF)) {
+                state.valid_ = false ;
+            } else if (event->len > 0 && state.valid_) {
+                updateEntry(state, event->name,
+                            (event->mask & IN_CLOSE_WRITE) != 0) ;
+            }
+        }
+    }
+#   endif
+}
+
+DirCache::DirState *DirCache::refresh (const std::string &dir,
+                                       std::string &errStr)
+{
+    if (notifyFd_ >= 0) applyEvents() ;
+    std::map<std::string, DirState>::iterator iter = dirs_.find(dir) ;
+    if (iter == dirs_.end()) {
+        DirState fresh ;
+        fresh.valid_ = false ;
+        fresh.dirFd_ = -1 ;
+        fresh.watch_ = -1 ;
+        fresh.listed_ = false ;
+        iter = dirs_.insert(std::make_pair(dir, fresh)).first ;
+    }
+    DirState &state = iter->second ;
+    if (!state.valid_ && fullScan(dir, state, errStr) != 0) return (nullptr) ;
+    return (&state) ;
+}
+
+int DirCache::list (const std::string &dir, EntryMap &entries,
+                    std::string &errStr)
+{
+    ScopedLock lock(mutex_) ;
+    DirState *state = refresh(dir, errStr) ;
+    if (state == nullptr) return (-1) ;
+    entries = state->entries_ ;
+    return (0) ;
+}
+
+int DirCache::takeChanges (const std::string &dir,
+                           std::vector<std::string> &names,
+                           std::string &errStr)
+{
+    ScopedLock lock(mutex_) ;
+    DirState *state = refresh(dir, errStr) ;
+    if (state == nullptr) return (-1) ;
+    names.insert(names.end(), state->changed_.begin(), state->changed_.end()) ;
+    state->changed_.clear() ;
+    return (0) ;
+}
+
+bool DirCache::isWatched (const std::string &dir) const
+{
+    ScopedLock lock(mutex_) ;
+    std::map<std::string, DirState>::const_iterator iter = dirs_.find(dir) ;
+    return (iter != dirs_.end() && iter->second.watch_ >= 0) ;
+}
+
+void DirCache::lockForFork ()
+{
+    mutex_.lock() ;
+}
+
+/*
+  In the child, close the shared watch descriptor and make a new one;
+  every directory is listed again on its next request.
+*/
+void DirCache::unlockAfterFork (bool child)
+{
+    if (!child) {
+        mutex_.unlock() ;
+        return ;
+    }
+#   ifdef OSI2_HAVE_INOTIFY
+    if (notifyFd_ >= 0) ::close(notifyFd_) ;
+    notifyFd_ = -1 ;
+    watchToDir_.clear() ;
+    for (std::map<std::string, DirState>::iterator iter = dirs_.begin() ;
+            iter != dirs_.end() ; iter++) {
+        iter->second.watch_ = -1 ;
+        closeDir(iter->second) ;
+    }
+    notifyFd_ = ::inotify_init1(IN_NONBLOCK|IN_CLOEXEC) ;
+#   endif
+    mutex_.reset() ;
+}
+
+}  // end namespace Osi2
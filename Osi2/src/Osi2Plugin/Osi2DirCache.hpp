@@ -0,0 +1,188 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2DirCache.hpp
+    \brief Cached directory listings for plugin discovery.
+
+  See Osi2::DirCache.
+*/
+
+#ifndef OSI2DIRCACHE_HPP
+#define OSI2DIRCACHE_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*! \brief Cache of directory listings and file metadata
+
+  The first request for a directory lists it once, with the metadata of each
+  entry taken relative to an open descriptor for the directory
+  (fstatat(2)), and keeps the result. Where the platform has inotify(7) the
+  directory is watched from then on, and later requests apply only the
+  changes reported since the last one, restating just the entries named.
+  Without a watch (other platforms, or the watch couldn't be set) every
+  request lists the directory again; the cache still serves to detect what
+  changed.
+
+  Each directory also accumulates the names of entries added, removed, or
+  modified since its changes were last taken (#takeChanges). That's the
+  hook for noticing new or rebuilt plugin libraries without rescanning.
+
+  All methods are thread-safe.
+*/
+class DirCache {
+
+public:
+
+    /// Metadata for one directory entry
+    struct Entry {
+        /// True for a regular file (after following symbolic links)
+        bool isFile_ ;
+        /// True for a directory
+        bool isDir_ ;
+        /// Size in bytes
+        int64_t size_ ;
+        /// Modification time, seconds since the epoch
+        int64_t mtime_ ;
+        /// Inode number (zero where there's no such thing)
+        uint64_t inode_ ;
+        /// True if the other fields are all equal
+        inline bool sameAs (const Entry &rhs) const {
+            return (isFile_ == rhs.isFile_ && isDir_ == rhs.isDir_ &&
+                    size_ == rhs.size_ && mtime_ == rhs.mtime_ &&
+                    inode_ == rhs.inode_) ;
+        }
+    } ;
+
+    /// Entries of one directory, by name
+    typedef std::map<std::string, Entry> EntryMap ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor
+    DirCache() ;
+    /// Destructor; closes the watches
+    ~DirCache() ;
+    //@}
+
+    /// \name Queries
+    //@{
+    /*! \brief Bring the listing of \p dir up to date and copy it to
+               \p entries
+
+      Returns 0 on success, -1 if the directory can't be read, with an
+      explanation in \p errStr. The entries \c "." and \c ".." are omitted.
+    */
+    int list(const std::string &dir, EntryMap &entries,
+             std::string &errStr) ;
+
+    /*! \brief Take the names changed in \p dir since the last call
+
+      Brings the listing up to date first. A name is reported if its entry
+      appeared, disappeared, or changed metadata, or (with a watch) the file
+      was written. An entry that came and went between calls isn't
+      reported. The first call for a directory reports nothing; the initial
+      listing is not a change.
+      Returns 0, or -1 if the directory can't be read.
+    */
+    int takeChanges(const std::string &dir, std::vector<std::string> &names,
+                    std::string &errStr) ;
+
+    /// True if changes to \p dir are reported by a watch
+    bool isWatched(const std::string &dir) const ;
+
+    /// Number of full listings done (for testing and tuning)
+    inline int getNumFullScans () const {
+        return (atomicLoad(&numFullScans_)) ;
+    }
+
+    /// Forget everything cached; the next request for each directory lists it
+    void clear() ;
+    //@}
+
+    /// \name Fork support
+    //@{
+    /// Acquire the internal lock before fork(2)
+    void lockForFork() ;
+    /*! \brief Release the internal lock after fork(2)
+
+      The child shares the parent's watch descriptor, and the two can't
+      both read it. The child gives up its watches and lists afresh.
+    */
+    void unlockAfterFork(bool child) ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    DirCache(const DirCache &rhs) ;
+    /// Assignment (not implemented)
+    DirCache &operator=(const DirCache &rhs) ;
+
+    /// What's known about one directory
+    struct DirState {
+        /// True if #entries_ is current, given the watch
+        bool valid_ ;
+        /// Open descriptor for the directory; -1 if none
+        int dirFd_ ;
+        /// Watch descriptor; -1 if not watched
+        int watch_ ;
+        /// True once the first listing is done
+        bool listed_ ;
+        /// The entries
+        EntryMap entries_ ;
+        /// Names changed since #takeChanges was last called
+        std::set<std::string> changed_ ;
+    } ;
+
+    /*! \brief Bring \p dir up to date
+
+      Must be called with #mutex_ held. Returns the state, or null if the
+      directory can't be read.
+    */
+    DirState *refresh(const std::string &dir, std::string &errStr) ;
+
+    /// Apply the events waiting on the watch descriptor
+    void applyEvents() ;
+
+    /// List \p state's directory from scratch
+    int fullScan(const std::string &dir, DirState &state,
+                 std::string &errStr) ;
+
+    /*! \brief Restate entry \p name of \p state's directory
+
+      \p written says the file is known to have been written, so it's a
+      change even if the metadata looks the same.
+    */
+    void updateEntry(DirState &state, const std::string &name,
+                     bool written) ;
+
+    /// Give up the descriptors held for \p state
+    void closeDir(DirState &state) ;
+
+    /// State by directory path
+    std::map<std::string, DirState> dirs_ ;
+    /// Directory path by watch descriptor
+    std::map<int, std::string> watchToDir_ ;
+    /// Watch (inotify) descriptor; -1 if there's none
+    int notifyFd_ ;
+    /// Full listings done
+    mutable volatile int numFullScans_ ;
+    /// Serialises everything
+    mutable Mutex mutex_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
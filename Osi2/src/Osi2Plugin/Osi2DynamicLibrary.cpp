@@ -21,9 +21,18 @@
 #include <dlfcn.h>
 #endif
 
+/*
+  Isolated loading needs dlmopen, a glibc extension (declared when _GNU_SOURCE
+  is defined, as it is by default for g++).
+*/
+#if !defined(WIN32) && defined(__GLIBC__) && defined(LM_ID_NEWLM)
+# define OSI2_HAVE_DLMOPEN 1
+#endif
+
 #include "Osi2Config.h"
 #include "Osi2nullptr.hpp"
 #include "Osi2DynamicLibrary.hpp"
+#include "Osi2Trace.hpp"
 #include <sstream>
 #include <iostream>
 
@@ -40,7 +49,11 @@
 namespace Osi2 {
 
 DynamicLibrary::DynamicLibrary (void *handle)
-    : handle_(handle)
+    : handle_(handle),
+      isolated_(false),
+      perfSlot_(0),
+      numLive_(0),
+      retiring_(false)
 {
     dfltPluginDir_ = std::string(OSI2DFLTPLUGINDIR) ;
 }
@@ -63,17 +76,22 @@ DynamicLibrary::~DynamicLibrary ()
     }
 }
 
-DynamicLibrary *DynamicLibrary::load (const std::string &name,
-                                      std::string &errorString)
+void *DynamicLibrary::openHandle (const std::string &name,
+                                  std::string &errorString, bool isolated)
 {
     if (name.empty()) {
         errorString = "Empty path." ;
         return (nullptr) ;
     }
+    TraceSpan span("plugin", "DynamicLibrary::load", name.c_str()) ;
 
     void *handle = nullptr ;
 
 # ifdef WIN32
+    if (isolated) {
+        errorString += "Isolated loading is not supported on this platform." ;
+        return (nullptr) ;
+    }
     handle = ::LoadLibraryA(name.c_str()) ;
     if (handle == nullptr) {
         DWORD errorCode = ::GetLastError() ;
@@ -82,7 +100,16 @@ DynamicLibrary *DynamicLibrary::load (const std::string &name,
         errorString = ss.str() ;
     }
 # else
-    handle = ::dlopen(name.c_str(),RTLD_NOW) ;
+    if (isolated) {
+#     ifdef OSI2_HAVE_DLMOPEN
+        handle = ::dlmopen(LM_ID_NEWLM, name.c_str(), RTLD_NOW|RTLD_LOCAL) ;
+#     else
+        errorString += "Isolated loading is not supported on this platform." ;
+        return (nullptr) ;
+#     endif
+    } else {
+        handle = ::dlopen(name.c_str(),RTLD_NOW) ;
+    }
     if (handle == nullptr) {
         errorString += "Failed to load library \"" + name + '"' ;
         const char *zErrorString = ::dlerror() ;
@@ -92,18 +119,61 @@ DynamicLibrary *DynamicLibrary::load (const std::string &name,
     }
 # endif
 
+    return (handle) ;
+}
+
+DynamicLibrary *DynamicLibrary::load (const std::string &name,
+                                      std::string &errorString, bool isolated)
+{
+    void *handle = openHandle(name, errorString, isolated) ;
+    if (handle == nullptr) return (nullptr) ;
+
     DynamicLibrary *dynLib = new DynamicLibrary(handle) ;
     dynLib->fullPath_ = name ;
+    dynLib->isolated_ = isolated ;
+    return (dynLib) ;
+}
+
+bool DynamicLibrary::isolationSupported ()
+{
+#ifdef OSI2_HAVE_DLMOPEN
+    return (true) ;
+#else
+    return (false) ;
+#endif
+}
+
+DynamicLibrary *DynamicLibrary::defer (const std::string &name)
+{
+    DynamicLibrary *dynLib = new DynamicLibrary(nullptr) ;
+    dynLib->fullPath_ = name ;
     return (dynLib) ;
 }
 
+bool DynamicLibrary::open (std::string &errorString)
+{
+    if (handle_ == nullptr) handle_ = openHandle(fullPath_, errorString) ;
+    return (handle_ != nullptr) ;
+}
+
+/*
+  Check the cache first. Only symbols that are found are cached, so a failed
+  lookup costs the same every time.
+*/
 void *DynamicLibrary::getSymbol (const std::string &symbol,
                                  std::string &errorString)
 {
     if (handle_ == nullptr) return (nullptr) ;
 
+    ScopedLock lock(symMutex_) ;
+    std::map<std::string, void *>::const_iterator iter = symCache_.find(symbol) ;
+    if (iter != symCache_.end()) return (iter->second) ;
+
 #ifdef WIN32
-    return (::GetProcAddress((HMODULE)handle_, symbol.c_str())) ;
+    void *sym = reinterpret_cast<void *>(
+                    ::GetProcAddress((HMODULE)handle_, symbol.c_str())) ;
+    if (sym == nullptr)
+        errorString += "Failed to load symbol \"" + symbol + '"' ;
 #else
     void *sym = ::dlsym(handle_,symbol.c_str()) ;
     if (sym == nullptr) {
@@ -112,8 +182,35 @@ void *DynamicLibrary::getSymbol (const std::string &symbol,
         if (zErrorString)
             errorString = errorString + ": " + zErrorString ;
     }
-    return (sym) ;
 #endif
+    if (sym != nullptr) symCache_[symbol] = sym ;
+    return (sym) ;
+}
+
+/*
+  Resolve the lot, then report everything that's missing in one message.
+*/
+int DynamicLibrary::bindSymbols (SymbolBinding *table, size_t count,
+                                 std::string &errorString)
+{
+    int missing = 0 ;
+    std::string missingNames ;
+    for (size_t i = 0 ; i < count ; i++) {
+        std::string symErr ;
+        table[i].addr_ = getSymbol(table[i].name_, symErr) ;
+        if (table[i].addr_ == nullptr) {
+            if (missing > 0) missingNames += ", " ;
+            missingNames += table[i].name_ ;
+            missing++ ;
+        }
+    }
+    if (missing > 0) {
+        std::ostringstream msg ;
+        msg << "Failed to load " << missing << " of " << count
+            << " symbols from \"" << fullPath_ << "\": " << missingNames ;
+        errorString += msg.str() ;
+    }
+    return (missing) ;
 }
 
 }  // end namespace Osi2
@@ -15,9 +15,41 @@
 */
 
 #include <string>
+#include <map>
+#include <stddef.h>
+
+#include "Osi2Threads.hpp"
+#include "Osi2MemAccount.hpp"
+#include "Osi2Arena.hpp"
 
 namespace Osi2 {
 
+/*! \brief Convert a symbol address to a function pointer
+
+  ISO C++ forbids the conversion of a pointer-to-object to a
+  pointer-to-function and there's no obvious way to suppress the warning
+  with a compiler flag. On the other hand, we are allowed to cast
+  pointer-to-anything to size_t and get it back. So we slip through a blind
+  spot in the compiler's algorithm for generating warnings.
+*/
+template <typename FuncType>
+inline FuncType symbolToFunc (void *sym)
+{
+    size_t grossHack = reinterpret_cast<size_t>(sym) ;
+    return (reinterpret_cast<FuncType>(grossHack)) ;
+}
+
+/*! \brief An entry in a table of symbols for DynamicLibrary::bindSymbols
+
+  The client supplies the name; bindSymbols fills in the address.
+*/
+struct SymbolBinding {
+    /// Symbol name
+    const char *name_ ;
+    /// Symbol address; null if the symbol could not be found
+    void *addr_ ;
+} ;
+
 /*! \brief A class to manage dynamic library load and unload.
 
   A call to the static method #load will load a library and return
@@ -47,8 +79,46 @@ public:
       will return a pointer to a DynamicLibrary object for the plugin. If
       unsuccessful, it will return null and \p errStr will be loaded with an
       error message.
+
+      If \p isolated is true, the library is loaded into a new linker
+      namespace of its own (dlmopen(LM_ID_NEWLM, ...)), along with everything
+      it depends on and everything it subsequently loads. Each isolated load
+      of the same library is an independent copy, with its own static and
+      global data. See #isolationSupported.
     */
-    static DynamicLibrary *load(const std::string &path, std::string &errStr) ;
+    static DynamicLibrary *load(const std::string &path, std::string &errStr,
+                                bool isolated = false) ;
+
+    /*! \brief True if isolated loading is supported on this platform
+
+      At present, only with glibc. Note that glibc supports a small, fixed
+      number of namespaces (16, including the base namespace).
+    */
+    static bool isolationSupported() ;
+
+    /*! \brief Create a DynamicLibrary object without loading the library
+
+      The library specified in \p path will be loaded when #open is called.
+      Until then, #getSymbol will fail. This is used to give a library an
+      identity (and a Osi2::PluginUniqueID) before it's loaded.
+    */
+    static DynamicLibrary *defer(const std::string &path) ;
+
+    /*! \brief Load a deferred library
+
+      Returns true if the library is (now) loaded. If unsuccessful, it will
+      return false and \p errStr will be loaded with an error message.
+    */
+    bool open(std::string &errStr) ;
+
+    /// True if the library is loaded
+    inline bool isLoaded() const {
+        return (handle_ != 0) ;
+    }
+    /// True if the library was loaded into its own namespace
+    inline bool isIsolated() const {
+        return (isolated_) ;
+    }
 //@}
 
     /*! \name Symbol Management
@@ -58,10 +128,22 @@ public:
     /* \brief Load a symbol
 
       Load the specified symbol. The return value must be cast to the appropriate
-      type for use. If unsuccessful, it will return null and \p errStr will be
-      loaded with an error message.
+      type for use (see #symbolToFunc). If unsuccessful, it will return null and
+      \p errStr will be loaded with an error message.
+
+      Symbols that are found are cached; a repeat request for the same symbol
+      doesn't go back to the platform's symbol lookup.
     */
     void *getSymbol(const std::string &name, std::string &errStr) ;
+
+    /*! \brief Load a table of symbols
+
+      Fill in the address of each of the \p count symbols in \p table. All
+      symbols are attempted; the return value is the number that could not be
+      found, and \p errStr lists all of them. Intended to be used once, when
+      the library is loaded, to resolve everything a client will need.
+    */
+    int bindSymbols(SymbolBinding *table, size_t count, std::string &errStr) ;
 //@}
 
     /*! \name Miscellaneous
@@ -79,6 +161,56 @@ public:
     inline std::string getLibPath () const {
         return (fullPath_) ;
     }
+    /*! \brief Get the performance statistics slot for the library
+
+      Assigned by the plugin manager (see PerfStats); 0 until then.
+    */
+    inline int getPerfSlot () const {
+        return (perfSlot_) ;
+    }
+    /// Set the performance statistics slot for the library
+    inline void setPerfSlot (int slot) {
+        perfSlot_ = slot ;
+    }
+    /*! \brief Number of objects created by the library and not yet
+               destroyed
+
+      Maintained by the plugin manager, which uses it to decide when a
+      library replaced by PluginManager::reloadOneLib can be closed.
+    */
+    inline int getNumLive () const {
+        return (atomicLoad(&numLive_)) ;
+    }
+    /// Add \p delta to the live object count; returns the new count
+    inline int adjustLive (int delta) {
+        return (atomicAdd(&numLive_, delta)) ;
+    }
+    /*! \brief True if the library has been replaced and is waiting for its
+               objects to be destroyed
+    */
+    inline bool isRetiring () const {
+        return (retiring_) ;
+    }
+    /// Mark the library as replaced
+    inline void setRetiring () {
+        retiring_ = true ;
+    }
+    /*! \brief Memory held by the library and its objects
+
+      Charged by the plugin through PlatformServices::chargeMem_; see
+      MemAccount.
+    */
+    inline MemAccount &getMemAccount () {
+        return (memAccount_) ;
+    }
+    /*! \brief Arenas of the library's objects
+
+      Allocated from by the plugin through PlatformServices::arenaAlloc_;
+      see ArenaPool.
+    */
+    inline ArenaPool &getArenaPool () {
+        return (arenaPool_) ;
+    }
 //@}
 
     /*! \name Destructor */
@@ -113,14 +245,46 @@ private:
     DynamicLibrary(const DynamicLibrary &dynlib) ;
 //@}
 
+    /*! \brief Load the library specified by \p name
+
+      Returns the platform-specific handle, or null (with an explanation in
+      \p errStr) on failure.
+    */
+    static void *openHandle(const std::string &name, std::string &errStr,
+                            bool isolated = false) ;
+
     /// Platform-specific dynamic library handle.
     void *handle_;
 
+    /// True if the library was loaded into its own namespace
+    bool isolated_ ;
+
     /// Full path of associated library
     std::string fullPath_ ;
 
     /// Default plugin directory
     std::string dfltPluginDir_ ;
+
+    /// Performance statistics slot
+    int perfSlot_ ;
+
+    /// Live object count
+    mutable volatile int numLive_ ;
+
+    /// Set once the library has been replaced
+    volatile bool retiring_ ;
+
+    /// Memory account
+    MemAccount memAccount_ ;
+
+    /// Arenas
+    ArenaPool arenaPool_ ;
+
+    /// Symbols found so far; protected by #symMutex_
+    std::map<std::string, void *> symCache_ ;
+
+    /// Serialises use of #symCache_
+    Mutex symMutex_ ;
 } ;
 
 }  // end namespace Osi2
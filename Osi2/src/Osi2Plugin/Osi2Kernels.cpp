@@ -0,0 +1,537 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Kernels.cpp
+    \brief Scalar and vector versions of the Osi2 kernels, and the choice
+	   between them
+*/
+
+#include <cmath>
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2Kernels.hpp"
+#include "Osi2Threads.hpp"
+
+/*
+  The x86 versions are built with the target attribute, so the rest of the
+  library needs no special flags and runs anywhere; they're called only if
+  the processor says it has the instructions. Define OSI2_NO_SIMD to build
+  the scalar versions alone.
+*/
+#if !defined(OSI2_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || \
+     (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define OSI2_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#if !defined(OSI2_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#define OSI2_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+/// One version of every kernel
+struct KernelTable {
+    Osi2::KernelIsa isa_ ;
+    double (*maxAbs_)(int, const double *) ;
+    void (*scale_)(int, double *, double) ;
+    int (*clamp_)(int, double *, double) ;
+    double (*sparseDot_)(int, const int *, const double *, const double *) ;
+    void (*sparseAxpy_)(int, const int *, const double *, double, double *) ;
+} ;
+
+/*
+  Scalar versions; also the tails of the vector versions.
+*/
+double scalarMaxAbs (int n, const double *vals)
+{
+    double largest = 0.0 ;
+    for (int k = 0 ; k < n ; k++) {
+        const double mag = std::fabs(vals[k]) ;
+        if (mag > largest) largest = mag ;
+    }
+    return (largest) ;
+}
+
+void scalarScale (int n, double *vals, double scale)
+{
+    for (int k = 0 ; k < n ; k++) vals[k] *= scale ;
+}
+
+int scalarClamp (int n, double *vals, double infinity)
+{
+    int changed = 0 ;
+    for (int k = 0 ; k < n ; k++) {
+        if (vals[k] > infinity) {
+            vals[k] = infinity ;
+            changed++ ;
+        } else if (vals[k] < -infinity) {
+            vals[k] = -infinity ;
+            changed++ ;
+        }
+    }
+    return (changed) ;
+}
+
+double scalarSparseDot (int len, const int *ind, const double *el,
+                        const double *x)
+{
+    double sum = 0.0 ;
+    for (int k = 0 ; k < len ; k++) sum += el[k]*x[ind[k]] ;
+    return (sum) ;
+}
+
+void scalarSparseAxpy (int len, const int *ind, const double *el, double a,
+                       double *y)
+{
+    for (int k = 0 ; k < len ; k++) y[ind[k]] += el[k]*a ;
+}
+
+const KernelTable scalarTable = {
+    Osi2::KernelScalar, scalarMaxAbs, scalarScale, scalarClamp,
+    scalarSparseDot, scalarSparseAxpy
+} ;
+
+#if defined(OSI2_KERNELS_X86)
+
+/*
+  AVX2: four doubles to a register. Magnitudes come from clearing the sign
+  bit. The clamp counts the lanes it changes from the compare masks. There
+  is no scatter, so the axpy forms the products four at a time and adds
+  them in one by one, in order.
+*/
+__attribute__((target("avx2")))
+double avx2MaxAbs (int n, const double *vals)
+{
+    const __m256d noSign = _mm256_castsi256_pd(
+        _mm256_set1_epi64x(0x7fffffffffffffffLL)) ;
+    __m256d largest = _mm256_setzero_pd() ;
+    int k = 0 ;
+    for ( ; k+4 <= n ; k += 4)
+        largest = _mm256_max_pd(largest,
+                      _mm256_and_pd(_mm256_loadu_pd(vals+k), noSign)) ;
+    double lanes[4] ;
+    _mm256_storeu_pd(lanes, largest) ;
+    double result = scalarMaxAbs(n-k, vals+k) ;
+    for (int l = 0 ; l < 4 ; l++)
+        if (lanes[l] > result) result = lanes[l] ;
+    return (result) ;
+}
+
+__attribute__((target("avx2")))
+void avx2Scale (int n, double *vals, double scale)
+{
+    const __m256d factor = _mm256_set1_pd(scale) ;
+    int k = 0 ;
+    for ( ; k+4 <= n ; k += 4)
+        _mm256_storeu_pd(vals+k,
+                         _mm256_mul_pd(_mm256_loadu_pd(vals+k), factor)) ;
+    scalarScale(n-k, vals+k, scale) ;
+}
+
+__attribute__((target("avx2,popcnt")))
+int avx2Clamp (int n, double *vals, double infinity)
+{
+    const __m256d upper = _mm256_set1_pd(infinity) ;
+    const __m256d lower = _mm256_set1_pd(-infinity) ;
+    int changed = 0 ;
+    int k = 0 ;
+    for ( ; k+4 <= n ; k += 4) {
+        __m256d v = _mm256_loadu_pd(vals+k) ;
+        const __m256d over = _mm256_cmp_pd(v, upper, _CMP_GT_OQ) ;
+        const __m256d under = _mm256_cmp_pd(v, lower, _CMP_LT_OQ) ;
+        const int mask = _mm256_movemask_pd(_mm256_or_pd(over, under)) ;
+        if (mask == 0) continue ;
+        changed += _mm_popcnt_u32(static_cast<unsigned>(mask)) ;
+        v = _mm256_blendv_pd(v, upper, over) ;
+        v = _mm256_blendv_pd(v, lower, under) ;
+        _mm256_storeu_pd(vals+k, v) ;
+    }
+    return (changed+scalarClamp(n-k, vals+k, infinity)) ;
+}
+
+__attribute__((target("avx2")))
+double avx2SparseDot (int len, const int *ind, const double *el,
+                      const double *x)
+{
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1)) ;
+    __m256d sum = _mm256_setzero_pd() ;
+    int k = 0 ;
+    for ( ; k+4 <= len ; k += 4) {
+        const __m128i idx =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(ind+k)) ;
+        const __m256d xs =
+            _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, idx, all, 8) ;
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(el+k), xs)) ;
+    }
+    double lanes[4] ;
+    _mm256_storeu_pd(lanes, sum) ;
+    return ((lanes[0]+lanes[1])+(lanes[2]+lanes[3]) +
+            scalarSparseDot(len-k, ind+k, el+k, x)) ;
+}
+
+__attribute__((target("avx2")))
+void avx2SparseAxpy (int len, const int *ind, const double *el, double a,
+                     double *y)
+{
+    const __m256d factor = _mm256_set1_pd(a) ;
+    int k = 0 ;
+    for ( ; k+4 <= len ; k += 4) {
+        double prods[4] ;
+        _mm256_storeu_pd(prods, _mm256_mul_pd(_mm256_loadu_pd(el+k), factor)) ;
+        for (int l = 0 ; l < 4 ; l++) y[ind[k+l]] += prods[l] ;
+    }
+    scalarSparseAxpy(len-k, ind+k, el+k, a, y) ;
+}
+
+const KernelTable avx2Table = {
+    Osi2::KernelAvx2, avx2MaxAbs, avx2Scale, avx2Clamp, avx2SparseDot,
+    avx2SparseAxpy
+} ;
+
+/*
+  AVX-512F: eight doubles to a register, with mask registers for the
+  compares. The max and the gathers are masked, with every lane on, so
+  that the compiler sees the lanes start defined. The axpy gathers, adds and scatters back; a block of eight
+  that names a row twice would lose an add that way, so AVX-512CD spots
+  those and they go one at a time. Every processor with AVX-512F so far
+  has CD as well.
+*/
+__attribute__((target("avx512f")))
+double avx512MaxAbs (int n, const double *vals)
+{
+    const __m512i noSign = _mm512_set1_epi64(0x7fffffffffffffffLL) ;
+    __m512d largest = _mm512_setzero_pd() ;
+    int k = 0 ;
+    for ( ; k+8 <= n ; k += 8) {
+        const __m512i bits = _mm512_castpd_si512(_mm512_loadu_pd(vals+k)) ;
+        largest = _mm512_maskz_max_pd(0xff, largest,
+                      _mm512_castsi512_pd(_mm512_and_epi64(bits, noSign))) ;
+    }
+    double lanes[8] ;
+    _mm512_storeu_pd(lanes, largest) ;
+    double result = scalarMaxAbs(n-k, vals+k) ;
+    for (int l = 0 ; l < 8 ; l++)
+        if (lanes[l] > result) result = lanes[l] ;
+    return (result) ;
+}
+
+__attribute__((target("avx512f")))
+void avx512Scale (int n, double *vals, double scale)
+{
+    const __m512d factor = _mm512_set1_pd(scale) ;
+    int k = 0 ;
+    for ( ; k+8 <= n ; k += 8)
+        _mm512_storeu_pd(vals+k,
+                         _mm512_mul_pd(_mm512_loadu_pd(vals+k), factor)) ;
+    scalarScale(n-k, vals+k, scale) ;
+}
+
+__attribute__((target("avx512f,popcnt")))
+int avx512Clamp (int n, double *vals, double infinity)
+{
+    const __m512d upper = _mm512_set1_pd(infinity) ;
+    const __m512d lower = _mm512_set1_pd(-infinity) ;
+    int changed = 0 ;
+    int k = 0 ;
+    for ( ; k+8 <= n ; k += 8) {
+        __m512d v = _mm512_loadu_pd(vals+k) ;
+        const __mmask8 over = _mm512_cmp_pd_mask(v, upper, _CMP_GT_OQ) ;
+        const __mmask8 under = _mm512_cmp_pd_mask(v, lower, _CMP_LT_OQ) ;
+        if ((over|under) == 0) continue ;
+        changed += _mm_popcnt_u32(static_cast<unsigned>(over|under)) ;
+        v = _mm512_mask_mov_pd(v, over, upper) ;
+        v = _mm512_mask_mov_pd(v, under, lower) ;
+        _mm512_storeu_pd(vals+k, v) ;
+    }
+    return (changed+scalarClamp(n-k, vals+k, infinity)) ;
+}
+
+__attribute__((target("avx512f")))
+double avx512SparseDot (int len, const int *ind, const double *el,
+                        const double *x)
+{
+    __m512d sum = _mm512_setzero_pd() ;
+    int k = 0 ;
+    for ( ; k+8 <= len ; k += 8) {
+        const __m256i idx =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ind+k)) ;
+        const __m512d xs =
+            _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, idx, x, 8) ;
+        sum = _mm512_add_pd(sum, _mm512_mul_pd(_mm512_loadu_pd(el+k), xs)) ;
+    }
+    double lanes[8] ;
+    _mm512_storeu_pd(lanes, sum) ;
+    return (((lanes[0]+lanes[1])+(lanes[2]+lanes[3])) +
+            ((lanes[4]+lanes[5])+(lanes[6]+lanes[7])) +
+            scalarSparseDot(len-k, ind+k, el+k, x)) ;
+}
+
+__attribute__((target("avx512f,avx512cd")))
+void avx512SparseAxpy (int len, const int *ind, const double *el, double a,
+                       double *y)
+{
+    const __m512d factor = _mm512_set1_pd(a) ;
+    int k = 0 ;
+    for ( ; k+8 <= len ; k += 8) {
+        const __m256i idx =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ind+k)) ;
+        const __m512i repeats =
+            _mm512_maskz_conflict_epi32(0xff,
+                _mm512_maskz_loadu_epi32(0xff, ind+k)) ;
+        if (_mm512_test_epi32_mask(repeats, repeats) != 0) {
+            scalarSparseAxpy(8, ind+k, el+k, a, y) ;
+            continue ;
+        }
+        const __m512d prods = _mm512_mul_pd(_mm512_loadu_pd(el+k), factor) ;
+        const __m512d ys =
+            _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, idx, y, 8) ;
+        _mm512_i32scatter_pd(y, idx, _mm512_add_pd(ys, prods), 8) ;
+    }
+    scalarSparseAxpy(len-k, ind+k, el+k, a, y) ;
+}
+
+const KernelTable avx512Table = {
+    Osi2::KernelAvx512, avx512MaxAbs, avx512Scale, avx512Clamp,
+    avx512SparseDot, avx512SparseAxpy
+} ;
+
+#endif   // OSI2_KERNELS_X86
+
+#if defined(OSI2_KERNELS_NEON)
+
+/*
+  NEON: two doubles to a register. There's no gather or scatter; the dot
+  product loads the two entries of x by hand, and the axpy stores the two
+  products by hand.
+*/
+double neonMaxAbs (int n, const double *vals)
+{
+    float64x2_t largest = vdupq_n_f64(0.0) ;
+    int k = 0 ;
+    for ( ; k+2 <= n ; k += 2)
+        largest = vmaxq_f64(largest, vabsq_f64(vld1q_f64(vals+k))) ;
+    double result = scalarMaxAbs(n-k, vals+k) ;
+    const double lanes = vmaxvq_f64(largest) ;
+    return ((lanes > result) ? lanes : result) ;
+}
+
+void neonScale (int n, double *vals, double scale)
+{
+    int k = 0 ;
+    for ( ; k+2 <= n ; k += 2)
+        vst1q_f64(vals+k, vmulq_n_f64(vld1q_f64(vals+k), scale)) ;
+    scalarScale(n-k, vals+k, scale) ;
+}
+
+int neonClamp (int n, double *vals, double infinity)
+{
+    const float64x2_t upper = vdupq_n_f64(infinity) ;
+    const float64x2_t lower = vdupq_n_f64(-infinity) ;
+    int changed = 0 ;
+    int k = 0 ;
+    for ( ; k+2 <= n ; k += 2) {
+        float64x2_t v = vld1q_f64(vals+k) ;
+        const uint64x2_t over = vcgtq_f64(v, upper) ;
+        const uint64x2_t under = vcltq_f64(v, lower) ;
+        const uint64x2_t either = vorrq_u64(over, under) ;
+        const int count = static_cast<int>(vgetq_lane_u64(either, 0) & 1) +
+                          static_cast<int>(vgetq_lane_u64(either, 1) & 1) ;
+        if (count == 0) continue ;
+        changed += count ;
+        v = vbslq_f64(over, upper, v) ;
+        v = vbslq_f64(under, lower, v) ;
+        vst1q_f64(vals+k, v) ;
+    }
+    return (changed+scalarClamp(n-k, vals+k, infinity)) ;
+}
+
+double neonSparseDot (int len, const int *ind, const double *el,
+                      const double *x)
+{
+    float64x2_t sum = vdupq_n_f64(0.0) ;
+    int k = 0 ;
+    for ( ; k+2 <= len ; k += 2) {
+        const double pair[2] = { x[ind[k]], x[ind[k+1]] } ;
+        sum = vfmaq_f64(sum, vld1q_f64(el+k), vld1q_f64(pair)) ;
+    }
+    return (vaddvq_f64(sum)+scalarSparseDot(len-k, ind+k, el+k, x)) ;
+}
+
+void neonSparseAxpy (int len, const int *ind, const double *el, double a,
+                     double *y)
+{
+    int k = 0 ;
+    for ( ; k+2 <= len ; k += 2) {
+        const float64x2_t prods = vmulq_n_f64(vld1q_f64(el+k), a) ;
+        y[ind[k]] += vgetq_lane_f64(prods, 0) ;
+        y[ind[k+1]] += vgetq_lane_f64(prods, 1) ;
+    }
+    scalarSparseAxpy(len-k, ind+k, el+k, a, y) ;
+}
+
+const KernelTable neonTable = {
+    Osi2::KernelNeon, neonMaxAbs, neonScale, neonClamp, neonSparseDot,
+    neonSparseAxpy
+} ;
+
+#endif   // OSI2_KERNELS_NEON
+
+/// The table for \p isa; null if this build doesn't have it
+const KernelTable *tableFor (Osi2::KernelIsa isa)
+{
+    switch (isa) {
+        case Osi2::KernelScalar:
+            return (&scalarTable) ;
+#       if defined(OSI2_KERNELS_NEON)
+        case Osi2::KernelNeon:
+            return (&neonTable) ;
+#       endif
+#       if defined(OSI2_KERNELS_X86)
+        case Osi2::KernelAvx2:
+            __builtin_cpu_init() ;
+            return (__builtin_cpu_supports("avx2") ? &avx2Table : nullptr) ;
+        case Osi2::KernelAvx512:
+            __builtin_cpu_init() ;
+            return ((__builtin_cpu_supports("avx512f") &&
+                     __builtin_cpu_supports("avx512cd")) ?
+                    &avx512Table : nullptr) ;
+#       endif
+        default:
+            return (nullptr) ;
+    }
+}
+
+/// The kernels in use; null until first use
+const KernelTable *volatile currentTable = 0 ;
+
+/*
+  Two threads may both make the choice on first use; they make the same
+  one.
+*/
+const KernelTable &kernels ()
+{
+    const KernelTable *table = Osi2::atomicLoadPtr(&currentTable) ;
+    if (table != nullptr) return (*table) ;
+    const Osi2::KernelIsa best[] = {
+        Osi2::KernelAvx512, Osi2::KernelAvx2, Osi2::KernelNeon
+    } ;
+    table = &scalarTable ;
+    for (int k = 0 ; k < 3 ; k++) {
+        const KernelTable *candidate = tableFor(best[k]) ;
+        if (candidate != nullptr) {
+            table = candidate ;
+            break ;
+        }
+    }
+    Osi2::atomicExchangePtr(&currentTable, table) ;
+    return (*table) ;
+}
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+KernelIsa getKernelIsa ()
+{
+    return (kernels().isa_) ;
+}
+
+const char *kernelIsaName (KernelIsa isa)
+{
+    switch (isa) {
+        case KernelNeon:
+            return ("neon") ;
+        case KernelAvx2:
+            return ("avx2") ;
+        case KernelAvx512:
+            return ("avx512") ;
+        default:
+            return ("scalar") ;
+    }
+}
+
+bool kernelIsaSupported (KernelIsa isa)
+{
+    return (tableFor(isa) != nullptr) ;
+}
+
+bool setKernelIsa (KernelIsa isa)
+{
+    const KernelTable *table = tableFor(isa) ;
+    if (table == nullptr) return (false) ;
+    atomicExchangePtr(&currentTable, table) ;
+    return (true) ;
+}
+
+double kernelMaxAbs (int n, const double *vals)
+{
+    if (n <= 0) return (0.0) ;
+    return (kernels().maxAbs_(n, vals)) ;
+}
+
+void kernelScale (int n, double *vals, double scale)
+{
+    if (n > 0) kernels().scale_(n, vals, scale) ;
+}
+
+int kernelClampInfinite (int n, double *vals, double infinity)
+{
+    if (n <= 0) return (0) ;
+    return (kernels().clamp_(n, vals, infinity)) ;
+}
+
+double kernelSparseDot (int len, const int *ind, const double *el,
+                        const double *x)
+{
+    if (len <= 0) return (0.0) ;
+    return (kernels().sparseDot_(len, ind, el, x)) ;
+}
+
+void kernelSparseAxpy (int len, const int *ind, const double *el, double a,
+                       double *y)
+{
+    if (len > 0) kernels().sparseAxpy_(len, ind, el, a, y) ;
+}
+
+/*
+  One table lookup for the lot; short rows go through the same kernel.
+*/
+void kernelRowTimes (int numRows, const int *starts, const int *ind,
+                     const double *el, const double *x, double *y)
+{
+    if (numRows <= 0) return ;
+    const KernelTable &table = kernels() ;
+    for (int i = 0 ; i < numRows ; i++) {
+        const int first = starts[i] ;
+        const int len = starts[i+1]-first ;
+        y[i] = (len > 0) ? table.sparseDot_(len, ind+first, el+first, x) : 0.0 ;
+    }
+}
+
+/*
+  As kernelRowTimes, one column at a time.
+*/
+void kernelColTimes (int numCols, const int *starts, const int *ind,
+                     const double *el, const double *x, int numRows,
+                     double *y)
+{
+    for (int i = 0 ; i < numRows ; i++) y[i] = 0.0 ;
+    if (numCols <= 0) return ;
+    const KernelTable &table = kernels() ;
+    for (int j = 0 ; j < numCols ; j++) {
+        const double xj = x[j] ;
+        const int first = starts[j] ;
+        const int len = starts[j+1]-first ;
+        if (xj == 0.0 || len <= 0) continue ;
+        table.sparseAxpy_(len, ind+first, el+first, xj, y) ;
+    }
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,126 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Kernels.hpp
+    \brief Vector kernels for element-wise work on model arrays.
+
+  The loops that run over bounds, coefficients and solutions before a
+  solver sees them: largest magnitude, scaling, clamping to infinity, and
+  sparse dot products and axpys over the CSR / CSC arrays of
+  \c getMatrixByRow and \c getMatrixByCol. Each kernel has a scalar
+  version and, where the compiler can build them, AVX2 and AVX-512
+  versions (x86, chosen at run time from what the processor supports) or a
+  NEON version (AArch64). The choice is made once, on first use; see
+  #getKernelIsa.
+
+  Vector dot products add in a different order than the scalar ones, so
+  sums can differ from them in the last bits. Everything else is exact.
+*/
+
+#ifndef OSI2KERNELS_HPP
+#define OSI2KERNELS_HPP
+
+namespace Osi2 {
+
+/// Instruction sets the kernels come in
+enum KernelIsa {
+    /// Plain C++
+    KernelScalar = 0,
+    /// AArch64 NEON, two doubles at a time
+    KernelNeon,
+    /// x86 AVX2, four doubles at a time
+    KernelAvx2,
+    /// x86 AVX-512F, eight doubles at a time
+    KernelAvx512
+} ;
+
+/*! \name Kernel selection */
+//@{
+
+/// The instruction set the kernels use
+KernelIsa getKernelIsa() ;
+
+/// Name of \p isa, as "scalar", "neon", "avx2" or "avx512"
+const char *kernelIsaName(KernelIsa isa) ;
+
+/*! \brief True if this build and this processor can run \p isa
+*/
+bool kernelIsaSupported(KernelIsa isa) ;
+
+/*! \brief Use the kernels for \p isa from here on
+
+  For tests and for measuring; the default is the best supported. Not safe
+  while another thread is in a kernel.
+
+  \returns false, with nothing changed, if \p isa isn't supported
+*/
+bool setKernelIsa(KernelIsa isa) ;
+//@}
+
+/*! \name Kernels
+
+  Lengths may be 0; pointers are then not looked at.
+*/
+//@{
+
+/// Largest magnitude in \p vals; 0 if \p n is 0
+double kernelMaxAbs(int n, const double *vals) ;
+
+/// Multiply each of \p vals by \p scale, in place
+void kernelScale(int n, double *vals, double scale) ;
+
+/*! \brief Clamp \p vals to [-\p infinity, \p infinity]
+
+  An entry of \p infinity or more becomes \p infinity; one of -\p infinity
+  or less, -\p infinity. NaNs are left alone.
+
+  \returns the number of entries changed
+*/
+int kernelClampInfinite(int n, double *vals, double infinity) ;
+
+/*! \brief <tt>sum el[k]*x[ind[k]]</tt> over \p len entries
+
+  A row of a CSR matrix against a column solution (or a column of a CSC
+  matrix against a row solution).
+*/
+double kernelSparseDot(int len, const int *ind, const double *el,
+                       const double *x) ;
+
+/*! \brief <tt>y[ind[k]] += a*el[k]</tt> over \p len entries
+
+  A column of a CSC matrix, times \p a, added into a row vector. \p ind
+  may name an entry more than once. Only AVX-512 scatters; the other
+  vector versions form the products in vector registers and add them in
+  one by one. Each entry of \p y takes its adds in the same order as the
+  scalar version, so the result is the same.
+*/
+void kernelSparseAxpy(int len, const int *ind, const double *el, double a,
+                      double *y) ;
+
+/*! \brief Row activity <tt>y = A x</tt> for \p A by row (CSR)
+
+  Row \c i is entries <tt>starts[i]</tt> to <tt>starts[i+1]-1</tt> of \p
+  ind and \p el; \p y gets \p numRows entries.
+*/
+void kernelRowTimes(int numRows, const int *starts, const int *ind,
+                    const double *el, const double *x, double *y) ;
+
+/*! \brief Row activity <tt>y = A x</tt> for \p A by column (CSC)
+
+  Column \c j is entries <tt>starts[j]</tt> to <tt>starts[j+1]-1</tt> of
+  \p ind and \p el; \p y gets \p numRows entries. Columns at 0 are skipped.
+  Each column goes through #kernelSparseAxpy. Short columns get little from
+  the vector versions, and the scatter is slower than the gather of
+  #kernelRowTimes, so use that when the row copy is at hand.
+*/
+void kernelColTimes(int numCols, const int *starts, const int *ind,
+                    const double *el, const double *x, int numRows,
+                    double *y) ;
+//@}
+
+}  // end namespace Osi2
+
+#endif
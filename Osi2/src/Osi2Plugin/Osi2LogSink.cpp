@@ -0,0 +1,187 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2LogSink.cpp
+    \brief Method definitions for Osi2::LogSink
+*/
+
+#include <cstring>
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2LogSink.hpp"
+
+namespace {
+
+/*
+  Thread-local cache of the calling thread's ring. The serial number
+  identifies the LogSink the ring belongs to. The address of tlsTag
+  identifies the thread.
+*/
+OSI2_THREAD_LOCAL int tlsSerial = 0 ;
+OSI2_THREAD_LOCAL void *tlsRing = 0 ;
+OSI2_THREAD_LOCAL char tlsTag = 0 ;
+
+/// Source of LogSink serial numbers
+volatile int nextSerial = 0 ;
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+LogSink::LogSink (DeliverFunc func, void *ctx)
+    : deliver_(func),
+      ctx_(ctx),
+      logLevel_(0),
+      numDropped_(0),
+      serial_(atomicAdd(&nextSerial, 1)),
+      running_(false),
+      stopping_(false)
+{ }
+
+LogSink::~LogSink ()
+{
+    stop() ;
+    for (std::map<const void *, Ring *>::iterator iter = rings_.begin() ;
+            iter != rings_.end() ; iter++)
+        delete iter->second ;
+}
+
+/*
+  The slow path, taken the first time a thread posts to this sink. It's
+  also where the drain thread gets started, so that a sink nobody posts to
+  costs no thread.
+*/
+LogSink::Ring *LogSink::myRing ()
+{
+    if (tlsSerial == serial_) return (static_cast<Ring *>(tlsRing)) ;
+
+    ScopedLock lock(mutex_) ;
+    std::map<const void *, Ring *>::iterator iter = rings_.find(&tlsTag) ;
+    Ring *ring = nullptr ;
+    if (iter != rings_.end()) {
+        ring = iter->second ;
+    } else {
+        ring = new Ring ;
+        ring->head_ = 0 ;
+        ring->tail_ = 0 ;
+        rings_[&tlsTag] = ring ;
+    }
+    if (!running_ && !stopping_)
+        running_ = startThread(thread_, drainMain, this) ;
+    tlsSerial = serial_ ;
+    tlsRing = ring ;
+    return (ring) ;
+}
+
+/*
+  The counters run freely and wrap; only their difference matters, taken
+  unsigned. The increment of head_ is a full barrier, so the drain sees the
+  record before it sees the count.
+*/
+bool LogSink::post (int level, const char *text)
+{
+    Ring *ring = myRing() ;
+    const unsigned int head = static_cast<unsigned int>(ring->head_) ;
+    const unsigned int tail =
+        static_cast<unsigned int>(atomicLoad(&ring->tail_)) ;
+    if (head - tail >= static_cast<unsigned int>(ringSize)) {
+        atomicAdd(&numDropped_, 1) ;
+        return (false) ;
+    }
+    Record &rec = ring->records_[head%ringSize] ;
+    rec.level_ = level ;
+    std::strncpy(rec.text_, text, maxMsgLen-1) ;
+    rec.text_[maxMsgLen-1] = '\0' ;
+    atomicAdd(&ring->head_, 1) ;
+    return (true) ;
+}
+
+/*
+  Empty each ring in turn. Messages from one thread are delivered in the
+  order posted; there's no order between threads.
+*/
+int LogSink::drain ()
+{
+    int numDelivered = 0 ;
+    ScopedLock lock(mutex_) ;
+    for (std::map<const void *, Ring *>::iterator iter = rings_.begin() ;
+            iter != rings_.end() ; iter++) {
+        Ring *ring = iter->second ;
+        const unsigned int tail = static_cast<unsigned int>(ring->tail_) ;
+        const unsigned int head =
+            static_cast<unsigned int>(atomicLoad(&ring->head_)) ;
+        for (unsigned int pos = tail ; pos != head ; pos++) {
+            const Record &rec = ring->records_[pos%ringSize] ;
+            (*deliver_)(ctx_, rec.level_, rec.text_) ;
+        }
+        atomicAdd(&ring->tail_, static_cast<int>(head - tail)) ;
+        numDelivered += static_cast<int>(head - tail) ;
+    }
+    return (numDelivered) ;
+}
+
+void LogSink::flush ()
+{
+    ScopedLock guard(drainMutex_) ;
+    drain() ;
+}
+
+/*
+  The drain thread wakes every drainIntervalMs, or when told to stop.
+*/
+void *LogSink::drainMain (void *arg)
+{
+    LogSink *sink = static_cast<LogSink *>(arg) ;
+    for (;;) {
+        sink->flush() ;
+        ScopedLock lock(sink->mutex_) ;
+        if (sink->stopping_) break ;
+        sink->wake_.waitFor(sink->mutex_, drainIntervalMs) ;
+        if (sink->stopping_) break ;
+    }
+    return (nullptr) ;
+}
+
+void LogSink::stop ()
+{
+    bool running = false ;
+    {
+        ScopedLock lock(mutex_) ;
+        stopping_ = true ;
+        running = running_ ;
+        running_ = false ;
+        wake_.wakeAll() ;
+    }
+    if (running) joinThread(thread_) ;
+    flush() ;
+}
+
+void LogSink::lockForFork ()
+{
+    drainMutex_.lock() ;
+    mutex_.lock() ;
+}
+
+/*
+  In the child a new serial number sends every thread back through the slow
+  path of myRing, which finds the thread's ring and starts a new drain
+  thread.
+*/
+void LogSink::unlockAfterFork (bool child)
+{
+    if (child) {
+        running_ = false ;
+        serial_ = atomicAdd(&nextSerial, 1) ;
+        mutex_.reset() ;
+        drainMutex_.reset() ;
+    } else {
+        mutex_.unlock() ;
+        drainMutex_.unlock() ;
+    }
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,200 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2LogSink.hpp
+    \brief Asynchronous delivery of log messages from plugins.
+
+  See Osi2::LogSink. The plugin side is in Osi2PluginLog.hpp.
+*/
+
+#ifndef OSI2LOGSINK_HPP
+#define OSI2LOGSINK_HPP
+
+#include <stdint.h>
+#include <map>
+
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*! \brief Asynchronous sink for log messages
+
+  Posting a message (#post) copies it into a ring buffer belonging to the
+  posting thread and returns; it neither takes a lock nor makes a system
+  call. A background thread empties the rings, in order for each thread,
+  and hands each message to the delivery function given to the constructor.
+  The thread is started the first time a message is posted.
+
+  Each ring is written only by its owner and read only by the thread that
+  holds the drain lock, so a single producer and a single consumer share
+  it. A message that finds its ring full is dropped and counted
+  (#getNumDropped); posting never waits for the drain. Messages longer than
+  #maxMsgLen - 1 characters are truncated.
+
+  The sink also holds the log level that plugins test before composing a
+  message (see PlatformServices::logLevel_). The level is not tested again
+  here.
+
+  A thread's ring is allocated the first time it posts and is not freed
+  until the sink is destroyed.
+*/
+class LogSink {
+
+public:
+
+    /*! \brief Delivery function
+
+      Called from the drain thread (or from #flush) with the level and text
+      of one message. Calls are never concurrent.
+    */
+    typedef void (*DeliverFunc)(void *ctx, int level, const char *text) ;
+
+    /// Message slots in each thread's ring
+    static const int ringSize = 1024 ;
+
+    /// Size of a message slot, including the terminating null
+    static const int maxMsgLen = 256 ;
+
+    /// Interval at which the drain thread looks for messages, milliseconds
+    static const int drainIntervalMs = 20 ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; messages are delivered by calling \p func(\p ctx, ...)
+    LogSink(DeliverFunc func, void *ctx) ;
+    /// Destructor; stops the drain thread and delivers what remains
+    ~LogSink() ;
+    //@}
+
+    /// \name Posting
+    //@{
+    /*! \brief Post a message
+
+      Returns false if the message was dropped because the calling thread's
+      ring is full.
+    */
+    bool post(int level, const char *text) ;
+
+    /// Set the log level advertised to plugins
+    inline void setLogLevel (int level) {
+        logLevel_ = level ;
+    }
+    /// The log level advertised to plugins
+    inline const volatile int32_t *getLogLevelPtr () const {
+        return (&logLevel_) ;
+    }
+    /// Number of messages dropped because a ring was full
+    inline int getNumDropped () const {
+        return (atomicLoad(&numDropped_)) ;
+    }
+    //@}
+
+    /// \name Delivery
+    //@{
+    /*! \brief Deliver everything posted so far
+
+      Returns once every message posted by any thread before the call has
+      been handed to the delivery function. Done on the calling thread.
+    */
+    void flush() ;
+
+    /// Stop the drain thread, after delivering what remains
+    void stop() ;
+
+    /*! \brief Acquire the internal locks before fork(2)
+
+      The caller must not hold the lock taken by the delivery function.
+      See PluginManager::forkProcess.
+    */
+    void lockForFork() ;
+    /*! \brief Release the internal locks after fork(2), in parent or child
+
+      The drain thread doesn't exist in the child; it's started again by
+      the next message posted there.
+    */
+    void unlockAfterFork(bool child) ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    LogSink(const LogSink &rhs) ;
+    /// Assignment (not implemented)
+    LogSink &operator=(const LogSink &rhs) ;
+
+    /// One message
+    struct Record {
+        /// Log level
+        int32_t level_ ;
+        /// Text, null terminated
+        char text_[maxMsgLen] ;
+    } ;
+
+    /*! \brief One thread's messages
+
+      \c head_ counts messages posted and is written only by the owner;
+      \c tail_ counts messages delivered and is written only by the drain.
+      The messages waiting are those at positions tail_ to head_ - 1,
+      modulo #ringSize.
+    */
+    struct Ring {
+        volatile int head_ ;
+        volatile int tail_ ;
+        Record records_[ringSize] ;
+    } ;
+
+    /// Return the calling thread's ring, allocating it if necessary
+    Ring *myRing() ;
+
+    /*! \brief Deliver the messages waiting in all rings
+
+      Must be called with #drainMutex_ held. Returns the number delivered.
+    */
+    int drain() ;
+
+    /// Body of the drain thread
+    static void *drainMain(void *arg) ;
+
+    /// Delivery function
+    DeliverFunc deliver_ ;
+    /// Context for #deliver_
+    void *ctx_ ;
+
+    /// Log level advertised to plugins
+    volatile int32_t logLevel_ ;
+
+    /// Messages dropped because a ring was full
+    mutable volatile int numDropped_ ;
+
+    /// Distinguishes this sink from others for thread-local lookup
+    int serial_ ;
+
+    /*! \brief Rings of all threads that have posted anything
+
+      Keyed by the address of a thread-local variable, which identifies the
+      thread.
+    */
+    std::map<const void *, Ring *> rings_ ;
+
+    /// Serialises use of #rings_, and the drain thread's sleep
+    Mutex mutex_ ;
+    /// Held while the rings are emptied; one consumer at a time
+    Mutex drainMutex_ ;
+    /// The drain thread sleeps on this
+    Condition wake_ ;
+
+    /// The drain thread
+    ThreadHandle thread_ ;
+    /// True while the drain thread is running
+    bool running_ ;
+    /// Tells the drain thread to finish
+    volatile bool stopping_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,113 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2MemAccount.cpp
+    \brief Method definitions for Osi2::MemAccount
+*/
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2MemAccount.hpp"
+
+namespace Osi2 {
+
+MemAccount::MemAccount ()
+    : current_(0),
+      peak_(0),
+      softLimit_(0),
+      hardLimit_(0),
+      numRefused_(0)
+{ }
+
+/*
+  A release is clipped to what the owner holds, so that a plugin that
+  releases memory after its object has been forgotten (in a destructor run
+  after destroyObject, for instance) can't drive the total negative.
+*/
+int MemAccount::charge (const void *owner, int64_t bytes)
+{
+    ScopedLock lock(mutex_) ;
+    if (bytes == 0) return (0) ;
+    if (bytes < 0) {
+        std::map<const void *, int64_t>::iterator iter = owners_.find(owner) ;
+        if (iter == owners_.end()) return (0) ;
+        int64_t released = -bytes ;
+        if (released > iter->second) released = iter->second ;
+        iter->second -= released ;
+        current_ -= released ;
+        if (iter->second == 0) owners_.erase(iter) ;
+        return (0) ;
+    }
+    if (hardLimit_ > 0 && current_+bytes > hardLimit_) {
+        numRefused_++ ;
+        return (-1) ;
+    }
+    owners_[owner] += bytes ;
+    current_ += bytes ;
+    if (current_ > peak_) peak_ = current_ ;
+    return ((softLimit_ > 0 && current_ > softLimit_) ? 1 : 0) ;
+}
+
+int64_t MemAccount::forget (const void *owner)
+{
+    ScopedLock lock(mutex_) ;
+    std::map<const void *, int64_t>::iterator iter = owners_.find(owner) ;
+    if (iter == owners_.end()) return (0) ;
+    const int64_t released = iter->second ;
+    current_ -= released ;
+    owners_.erase(iter) ;
+    return (released) ;
+}
+
+/*
+  The limits and the high-water mark stay; they describe the library, not
+  the objects it had.
+*/
+void MemAccount::clear ()
+{
+    ScopedLock lock(mutex_) ;
+    owners_.clear() ;
+    current_ = 0 ;
+}
+
+void MemAccount::setLimits (int64_t softLimit, int64_t hardLimit)
+{
+    ScopedLock lock(mutex_) ;
+    softLimit_ = (softLimit > 0) ? softLimit : 0 ;
+    hardLimit_ = (hardLimit > 0) ? hardLimit : 0 ;
+}
+
+/*
+  At the hard limit there's no room for anything a new object might need,
+  whatever the soft limit.
+*/
+bool MemAccount::admitsObject () const
+{
+    ScopedLock lock(mutex_) ;
+    if (softLimit_ > 0 && current_ > softLimit_) return (false) ;
+    if (hardLimit_ > 0 && current_ >= hardLimit_) return (false) ;
+    return (true) ;
+}
+
+void MemAccount::getUsage (Usage &usage) const
+{
+    ScopedLock lock(mutex_) ;
+    usage.current_ = current_ ;
+    usage.peak_ = peak_ ;
+    usage.softLimit_ = softLimit_ ;
+    usage.hardLimit_ = hardLimit_ ;
+    usage.numRefused_ = numRefused_ ;
+    usage.numOwners_ = static_cast<int>(owners_.size()) ;
+}
+
+int64_t MemAccount::getOwnerUsage (const void *owner) const
+{
+    ScopedLock lock(mutex_) ;
+    std::map<const void *, int64_t>::const_iterator iter = owners_.find(owner) ;
+    return ((iter == owners_.end()) ? 0 : iter->second) ;
+}
+
+}  // end namespace Osi2
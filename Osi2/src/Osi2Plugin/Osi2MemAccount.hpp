@@ -0,0 +1,135 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2MemAccount.hpp
+    \brief Memory accounting for a plugin library.
+
+  See Osi2::MemAccount.
+*/
+
+#ifndef OSI2MEMACCOUNT_HPP
+#define OSI2MEMACCOUNT_HPP
+
+#include <stdint.h>
+#include <map>
+
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*! \brief Bytes held by one plugin library, and its limits
+
+  A plugin reports what it allocates and frees through the
+  \link Osi2::PlatformServices#chargeMem_ chargeMem_ \endlink service (see
+  Osi2PluginMem.hpp), naming the object the memory belongs to, or none for
+  memory held by the library itself. The account keeps the total, its
+  high-water mark, and the bytes held by each object.
+
+  Two limits can be set, both in bytes, 0 meaning none. Over the soft limit,
+  the library is asked for no new objects (#admitsObject); the objects it
+  has can go on growing. The hard limit can't be passed: a charge that would
+  take the total over it is refused and nothing is charged, and the plugin
+  is expected to fail whatever it was doing (loading a problem, say)
+  cleanly.
+
+  Only what the plugin reports is seen. It's an account of what the plugin
+  says it holds, not a measurement.
+
+  All methods are thread-safe.
+*/
+class MemAccount {
+
+public:
+
+    /// A snapshot of the account
+    struct Usage {
+        /// Bytes held now
+        int64_t current_ ;
+        /// Most bytes held at once
+        int64_t peak_ ;
+        /// Soft limit; 0 for none
+        int64_t softLimit_ ;
+        /// Hard limit; 0 for none
+        int64_t hardLimit_ ;
+        /// Charges refused for the hard limit
+        int64_t numRefused_ ;
+        /// Objects holding memory
+        int numOwners_ ;
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; no limits
+    MemAccount() ;
+    //@}
+
+    /// \name Charging
+    //@{
+    /*! \brief Charge \p bytes to \p owner (null for the library itself)
+
+      A negative \p bytes releases memory; no more is released than
+      \p owner holds. Returns 0 if the charge is accepted, 1 if it's
+      accepted and the total is now over the soft limit, -1 if it's
+      refused for the hard limit.
+    */
+    int charge(const void *owner, int64_t bytes) ;
+
+    /*! \brief Forget \p owner, which has been destroyed
+
+      Whatever it still held is released with it. Returns the bytes
+      released.
+    */
+    int64_t forget(const void *owner) ;
+
+    /// Forget everything; the library has been closed
+    void clear() ;
+    //@}
+
+    /// \name Limits
+    //@{
+    /// Set the limits, in bytes; 0 for none
+    void setLimits(int64_t softLimit, int64_t hardLimit) ;
+
+    /// True if the library may be asked for another object
+    bool admitsObject() const ;
+    //@}
+
+    /// \name Queries
+    //@{
+    /// Snapshot of the account
+    void getUsage(Usage &usage) const ;
+
+    /// Bytes held by \p owner
+    int64_t getOwnerUsage(const void *owner) const ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    MemAccount(const MemAccount &rhs) ;
+    /// Assignment (not implemented)
+    MemAccount &operator=(const MemAccount &rhs) ;
+
+    /// Bytes held now
+    int64_t current_ ;
+    /// High-water mark
+    int64_t peak_ ;
+    /// Soft limit
+    int64_t softLimit_ ;
+    /// Hard limit
+    int64_t hardLimit_ ;
+    /// Charges refused
+    int64_t numRefused_ ;
+    /// Bytes held, by owner; the library's own under null
+    std::map<const void *, int64_t> owners_ ;
+    /// Serialises everything
+    mutable Mutex mutex_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,493 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ModelSnapshot.cpp
+    \brief Method definitions for Osi2::ModelSnapshot
+*/
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2ModelSnapshot.hpp"
+
+using namespace Osi2 ;
+
+namespace {
+
+/// The first eight bytes of a snapshot
+const char snapshotMagic[8] = { 'O', 'S', 'I', '2', 'S', 'N', 'A', 'P' } ;
+
+/// Written as is; reads back differently on a machine of the other order
+const uint32_t byteOrderMark = 0x01020304 ;
+
+/*! \brief The sections of a snapshot, in file order
+
+  New sections go at the end, with a new format version.
+*/
+enum Section {
+    SecStart = 0, SecIndex, SecValue,
+    SecColLower, SecColUpper, SecObj, SecRowLower, SecRowUpper,
+    SecInteger, SecStatus,
+    SecProbName, SecRowNames, SecColNames,
+    numSections
+} ;
+
+/*! \brief The snapshot header
+
+  Every field is naturally aligned, so the layout is the same for every
+  compiler we care about. Each section is an offset from the start of the
+  file and a size in bytes; an absent section has size 0.
+*/
+struct FileHeader {
+    char magic_[8] ;
+    uint32_t version_ ;
+    uint32_t byteOrder_ ;
+    int32_t numCols_ ;
+    int32_t numRows_ ;
+    int64_t numElements_ ;
+    double objOffset_ ;
+    double objSense_ ;
+    uint64_t section_[numSections][2] ;
+} ;
+
+/// Sections start on multiples of this
+const size_t sectionAlign = 8 ;
+
+/*
+  Write helpers. Each keeps track of the file position, so the writer
+  doesn't have to ask.
+*/
+class Output {
+public:
+    Output (FILE *file) : file_(file), pos_(0), ok_(true) { }
+
+    void put (const void *data, size_t bytes)
+    {
+        if (bytes == 0 || !ok_) return ;
+        ok_ = (std::fwrite(data, 1, bytes, file_) == bytes) ;
+        pos_ += bytes ;
+    }
+
+    void align ()
+    {
+        static const char zeros[sectionAlign] = { 0 } ;
+        put(zeros, (sectionAlign-pos_%sectionAlign)%sectionAlign) ;
+    }
+
+    uint64_t pos () const { return (pos_) ; }
+    bool ok () const { return (ok_) ; }
+
+private:
+    FILE *file_ ;
+    uint64_t pos_ ;
+    bool ok_ ;
+} ;
+
+/*
+  Write \p count names, each with its terminating null; a null name is
+  written as an empty one.
+*/
+void putNames (Output &out, const char *const *names, int count)
+{
+    for (int i = 0 ; i < count ; i++) {
+        const char *name = (names[i] == nullptr) ? "" : names[i] ;
+        out.put(name, std::strlen(name)+1) ;
+    }
+}
+
+}  // end file-local namespace
+
+ModelSnapshot::Problem::Problem ()
+    : numCols_(0),
+      numRows_(0),
+      start_(nullptr),
+      length_(nullptr),
+      index_(nullptr),
+      value_(nullptr),
+      colLower_(nullptr),
+      colUpper_(nullptr),
+      obj_(nullptr),
+      rowLower_(nullptr),
+      rowUpper_(nullptr),
+      integer_(nullptr),
+      status_(nullptr),
+      objOffset_(0.0),
+      objSense_(1.0),
+      problemName_(nullptr),
+      rowNames_(nullptr),
+      colNames_(nullptr)
+{ }
+
+ModelSnapshot::ModelSnapshot ()
+    : base_(nullptr),
+      size_(0),
+      mapped_(false)
+{ }
+
+ModelSnapshot::~ModelSnapshot ()
+{
+    clear() ;
+}
+
+void ModelSnapshot::clear ()
+{
+#ifndef WIN32
+    if (mapped_) ::munmap(const_cast<char *>(base_), size_) ;
+#endif
+    std::vector<double>().swap(copy_) ;
+    base_ = nullptr ;
+    size_ = 0 ;
+    mapped_ = false ;
+    prob_ = Problem() ;
+    rowNames_.clear() ;
+    colNames_.clear() ;
+    error_.clear() ;
+}
+
+int ModelSnapshot::fail (const std::string &msg)
+{
+    error_ = msg ;
+    return (-1) ;
+}
+
+/*
+  The header goes out twice: once as a placeholder, so the sections land
+  where they'll be, and again at the end with the section table filled in.
+  The matrix is packed on the way out, so a clp matrix with gaps between
+  columns can be written without a copy.
+*/
+int ModelSnapshot::write (const std::string &path, const Problem &prob,
+                          std::string &error)
+{
+    const int n = prob.numCols_ ;
+    const int m = prob.numRows_ ;
+    if (n < 0 || m < 0 ||
+            (n > 0 && (prob.start_ == nullptr || prob.colLower_ == nullptr ||
+                       prob.colUpper_ == nullptr || prob.obj_ == nullptr)) ||
+            (m > 0 && (prob.rowLower_ == nullptr ||
+                       prob.rowUpper_ == nullptr))) {
+        error = "Incomplete problem; nothing written." ;
+        return (-1) ;
+    }
+    const bool packed = (prob.length_ == nullptr && prob.start_ != nullptr &&
+                         prob.start_[0] == 0) ;
+    int64_t nz = 0 ;
+    for (int j = 0 ; j < n ; j++)
+        nz += (prob.length_ == nullptr) ?
+              prob.start_[j+1]-prob.start_[j] : prob.length_[j] ;
+    if (nz > INT_MAX || (nz > 0 && (prob.index_ == nullptr ||
+                                    prob.value_ == nullptr))) {
+        error = "Inconsistent matrix; nothing written." ;
+        return (-1) ;
+    }
+
+    const std::string tmpPath = path + ".tmp" ;
+    FILE *file = std::fopen(tmpPath.c_str(), "wb") ;
+    if (file == nullptr) {
+        error = "Can't create " + tmpPath + ": " + std::strerror(errno) + "." ;
+        return (-1) ;
+    }
+    FileHeader hdr ;
+    std::memset(&hdr, 0, sizeof(hdr)) ;
+    std::memcpy(hdr.magic_, snapshotMagic, sizeof(snapshotMagic)) ;
+    hdr.version_ = formatVersion ;
+    hdr.byteOrder_ = byteOrderMark ;
+    hdr.numCols_ = n ;
+    hdr.numRows_ = m ;
+    hdr.numElements_ = nz ;
+    hdr.objOffset_ = prob.objOffset_ ;
+    hdr.objSense_ = prob.objSense_ ;
+
+    Output out(file) ;
+    out.put(&hdr, sizeof(hdr)) ;
+    for (int sec = 0 ; sec < numSections ; sec++) {
+        out.align() ;
+        const uint64_t begin = out.pos() ;
+        switch (sec) {
+            case SecStart: {
+                if (packed) {
+                    out.put(prob.start_, (n+1)*sizeof(int)) ;
+                } else {
+                    int start = 0 ;
+                    out.put(&start, sizeof(int)) ;
+                    for (int j = 0 ; j < n ; j++) {
+                        start += (prob.length_ == nullptr) ?
+                                 prob.start_[j+1]-prob.start_[j] :
+                                 prob.length_[j] ;
+                        out.put(&start, sizeof(int)) ;
+                    }
+                }
+                break ;
+            }
+            case SecIndex:
+            case SecValue: {
+                const bool isIndex = (sec == SecIndex) ;
+                const size_t elemSize =
+                    isIndex ? sizeof(int) : sizeof(double) ;
+                const char *data = isIndex ?
+                    reinterpret_cast<const char *>(prob.index_) :
+                    reinterpret_cast<const char *>(prob.value_) ;
+                if (packed) {
+                    out.put(data, static_cast<size_t>(nz)*elemSize) ;
+                } else {
+                    for (int j = 0 ; j < n ; j++) {
+                        const int len = (prob.length_ == nullptr) ?
+                                        prob.start_[j+1]-prob.start_[j] :
+                                        prob.length_[j] ;
+                        out.put(data+prob.start_[j]*elemSize, len*elemSize) ;
+                    }
+                }
+                break ;
+            }
+            case SecColLower:
+                out.put(prob.colLower_, n*sizeof(double)) ;
+                break ;
+            case SecColUpper:
+                out.put(prob.colUpper_, n*sizeof(double)) ;
+                break ;
+            case SecObj:
+                out.put(prob.obj_, n*sizeof(double)) ;
+                break ;
+            case SecRowLower:
+                out.put(prob.rowLower_, m*sizeof(double)) ;
+                break ;
+            case SecRowUpper:
+                out.put(prob.rowUpper_, m*sizeof(double)) ;
+                break ;
+            case SecInteger:
+                if (prob.integer_ != nullptr) out.put(prob.integer_, n) ;
+                break ;
+            case SecStatus:
+                if (prob.status_ != nullptr) out.put(prob.status_, n+m) ;
+                break ;
+            case SecProbName:
+                if (prob.problemName_ != nullptr)
+                    out.put(prob.problemName_,
+                            std::strlen(prob.problemName_)+1) ;
+                break ;
+            case SecRowNames:
+                if (prob.rowNames_ != nullptr) putNames(out, prob.rowNames_, m) ;
+                break ;
+            case SecColNames:
+                if (prob.colNames_ != nullptr) putNames(out, prob.colNames_, n) ;
+                break ;
+        }
+        hdr.section_[sec][0] = begin ;
+        hdr.section_[sec][1] = out.pos()-begin ;
+    }
+    bool ok = out.ok() && std::fseek(file, 0, SEEK_SET) == 0 ;
+    if (ok) ok = (std::fwrite(&hdr, sizeof(hdr), 1, file) == 1) ;
+    ok = (std::fclose(file) == 0) && ok ;
+    if (ok) {
+#       ifdef WIN32
+        std::remove(path.c_str()) ;
+#       endif
+        ok = (std::rename(tmpPath.c_str(), path.c_str()) == 0) ;
+    }
+    if (!ok) {
+        error = "Can't write " + path + ": " + std::strerror(errno) + "." ;
+        std::remove(tmpPath.c_str()) ;
+        return (-1) ;
+    }
+    return (0) ;
+}
+
+/*
+  Map the file; on a platform without mmap, read it into copy_ instead.
+*/
+int ModelSnapshot::read (const std::string &path)
+{
+    clear() ;
+    const int fd = ::open(path.c_str(), O_RDONLY) ;
+    if (fd < 0)
+        return (fail("Can't open " + path + ": " + ::strerror(errno) + ".")) ;
+    struct stat info ;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd) ;
+        return (fail("Can't stat " + path + ": " + ::strerror(errno) + ".")) ;
+    }
+    if (info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd) ;
+        return (fail(path + " is too short to be a snapshot.")) ;
+    }
+    const size_t size = static_cast<size_t>(info.st_size) ;
+#ifdef WIN32
+    copy_.resize((size+sizeof(double)-1)/sizeof(double)) ;
+    char *buf = reinterpret_cast<char *>(&copy_[0]) ;
+    size_t got = 0 ;
+    while (got < size) {
+        const int chunk = ::_read(fd, buf+got, static_cast<unsigned>(
+                                  (size-got > INT_MAX) ? INT_MAX : size-got)) ;
+        if (chunk <= 0) break ;
+        got += chunk ;
+    }
+    ::close(fd) ;
+    if (got < size) {
+        copy_.clear() ;
+        return (fail("Can't read " + path + ".")) ;
+    }
+    base_ = buf ;
+#else
+    void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) ;
+    ::close(fd) ;
+    if (map == MAP_FAILED)
+        return (fail("Can't map " + path + ": " + ::strerror(errno) + ".")) ;
+#   ifdef MADV_WILLNEED
+    ::madvise(map, size, MADV_WILLNEED) ;
+#   endif
+    base_ = static_cast<const char *>(map) ;
+    mapped_ = true ;
+#endif
+    size_ = size ;
+    if (load() != 0) {
+        const std::string err = path + ": " + error_ ;
+        clear() ;
+        return (fail(err)) ;
+    }
+    return (0) ;
+}
+
+/*
+  The copy is checked over again, which costs little and points the
+  problem into it.
+*/
+int ModelSnapshot::replicate (const ModelSnapshot &src)
+{
+    if (&src == this) return ((base_ == nullptr) ? -1 : 0) ;
+    clear() ;
+    if (src.base_ == nullptr)
+        return (fail("Nothing to replicate.")) ;
+    copy_.resize((src.size_+sizeof(double)-1)/sizeof(double)) ;
+    char *buf = reinterpret_cast<char *>(&copy_[0]) ;
+    std::memcpy(buf, src.base_, src.size_) ;
+    base_ = buf ;
+    size_ = src.size_ ;
+    if (load() != 0) {
+        const std::string err = error_ ;
+        clear() ;
+        return (fail(err)) ;
+    }
+    return (0) ;
+}
+
+/*
+  Nothing in the image is trusted: every section has to lie inside the
+  file and have the size the header implies, and the matrix has to be a
+  valid CSC matrix, before anything is handed to a solver. The matrix check
+  reads the starts and indices once, which is the cost of faulting in those
+  pages anyway.
+*/
+int ModelSnapshot::load ()
+{
+    FileHeader hdr ;
+    std::memcpy(&hdr, base_, sizeof(hdr)) ;
+    if (std::memcmp(hdr.magic_, snapshotMagic, sizeof(snapshotMagic)) != 0)
+        return (fail("Not a snapshot.")) ;
+    if (hdr.byteOrder_ != byteOrderMark)
+        return (fail("Snapshot was written with the other byte order.")) ;
+    if (hdr.version_ != formatVersion) {
+        std::ostringstream msg ;
+        msg << "Snapshot format version " << hdr.version_
+            << "; this build reads version " << formatVersion << "." ;
+        return (fail(msg.str())) ;
+    }
+    const int64_t n = hdr.numCols_ ;
+    const int64_t m = hdr.numRows_ ;
+    const int64_t nz = hdr.numElements_ ;
+    if (n < 0 || m < 0 || nz < 0 || nz > INT_MAX)
+        return (fail("Bad problem size.")) ;
+    const uint64_t expected[numSections] = {
+        static_cast<uint64_t>(n+1)*sizeof(int),
+        static_cast<uint64_t>(nz)*sizeof(int),
+        static_cast<uint64_t>(nz)*sizeof(double),
+        static_cast<uint64_t>(n)*sizeof(double),
+        static_cast<uint64_t>(n)*sizeof(double),
+        static_cast<uint64_t>(n)*sizeof(double),
+        static_cast<uint64_t>(m)*sizeof(double),
+        static_cast<uint64_t>(m)*sizeof(double),
+        static_cast<uint64_t>(n),
+        static_cast<uint64_t>(n+m),
+        0, 0, 0
+    } ;
+    const char *data[numSections] ;
+    for (int sec = 0 ; sec < numSections ; sec++) {
+        const uint64_t offset = hdr.section_[sec][0] ;
+        const uint64_t bytes = hdr.section_[sec][1] ;
+        if (offset%sectionAlign != 0 || offset > size_ ||
+                bytes > size_-offset)
+            return (fail("Section outside the file.")) ;
+        const bool optional = (sec >= SecInteger) ;
+        if (sec < SecProbName && bytes != expected[sec] &&
+                !(optional && bytes == 0))
+            return (fail("Section of the wrong size.")) ;
+        if (sec >= SecProbName && bytes > 0 && base_[offset+bytes-1] != '\0')
+            return (fail("Unterminated name.")) ;
+        data[sec] = (bytes == 0) ? nullptr : base_+offset ;
+    }
+
+    const int *start = reinterpret_cast<const int *>(data[SecStart]) ;
+    const int *index = reinterpret_cast<const int *>(data[SecIndex]) ;
+    if (start[0] != 0 || start[n] != nz)
+        return (fail("Bad column starts.")) ;
+    for (int64_t j = 0 ; j < n ; j++) {
+        if (start[j+1] < start[j]) return (fail("Bad column starts.")) ;
+    }
+    for (int64_t k = 0 ; k < nz ; k++) {
+        if (index[k] < 0 || index[k] >= m)
+            return (fail("Row index out of range.")) ;
+    }
+
+    const int numNames[] = { 1, static_cast<int>(m), static_cast<int>(n) } ;
+    std::vector<const char *> *nameVecs[] = { nullptr, &rowNames_, &colNames_ } ;
+    for (int sec = SecProbName ; sec <= SecColNames ; sec++) {
+        if (data[sec] == nullptr) continue ;
+        const char *name = data[sec] ;
+        const char *end = name+hdr.section_[sec][1] ;
+        std::vector<const char *> *names = nameVecs[sec-SecProbName] ;
+        int count = 0 ;
+        for ( ; name < end ; name += std::strlen(name)+1) {
+            if (names != nullptr) names->push_back(name) ;
+            count++ ;
+        }
+        if (count != numNames[sec-SecProbName])
+            return (fail("Wrong number of names.")) ;
+    }
+
+    prob_.numCols_ = static_cast<int>(n) ;
+    prob_.numRows_ = static_cast<int>(m) ;
+    prob_.start_ = start ;
+    prob_.index_ = index ;
+    prob_.value_ = reinterpret_cast<const double *>(data[SecValue]) ;
+    prob_.colLower_ = reinterpret_cast<const double *>(data[SecColLower]) ;
+    prob_.colUpper_ = reinterpret_cast<const double *>(data[SecColUpper]) ;
+    prob_.obj_ = reinterpret_cast<const double *>(data[SecObj]) ;
+    prob_.rowLower_ = reinterpret_cast<const double *>(data[SecRowLower]) ;
+    prob_.rowUpper_ = reinterpret_cast<const double *>(data[SecRowUpper]) ;
+    prob_.integer_ = data[SecInteger] ;
+    prob_.status_ = reinterpret_cast<const unsigned char *>(data[SecStatus]) ;
+    prob_.objOffset_ = hdr.objOffset_ ;
+    prob_.objSense_ = hdr.objSense_ ;
+    prob_.problemName_ = data[SecProbName] ;
+    prob_.rowNames_ = rowNames_.empty() ? nullptr : &rowNames_[0] ;
+    prob_.colNames_ = colNames_.empty() ? nullptr : &colNames_[0] ;
+    return (0) ;
+}
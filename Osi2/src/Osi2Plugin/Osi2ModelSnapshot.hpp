@@ -0,0 +1,168 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ModelSnapshot.hpp
+    \brief A binary snapshot of a problem, for fast reloading.
+
+  See Osi2::ModelSnapshot.
+*/
+
+#ifndef Osi2ModelSnapshot_HPP
+#define Osi2ModelSnapshot_HPP
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace Osi2 {
+
+/*! \brief A binary snapshot of a problem
+
+  A snapshot holds the problem data a shim needs to rebuild a model: the
+  column-major matrix, bounds, objective, integrality, and optionally the
+  row and column names and a basis. It's meant for models that are
+  reloaded over and over, where parsing text would dominate.
+
+  The file is a fixed header followed by the arrays, each aligned on 8
+  bytes, in the byte order of the machine that wrote it. #read maps the
+  file and checks its structure; the arrays of #getProblem then point
+  straight into the mapping, so reading costs about what touching the
+  pages costs. The mapping lasts until the next read or until the snapshot
+  is destroyed.
+
+  The basis, when present, is one status byte per column then one per
+  row, in clp's encoding (ClpSimplex::Status).
+*/
+class ModelSnapshot {
+
+public:
+
+    /// Version of the file format written by #write
+    static const unsigned int formatVersion = 1 ;
+
+    /*! \brief The problem in a snapshot
+
+      Used both to describe a problem to #write and to return the problem
+      read by #read. For #write, the matrix can be given with column
+      lengths (as clp keeps it, with room to grow between columns); #read
+      always returns a packed matrix, with #length_ null. The bound and
+      objective arrays must be present; the rest are optional and null
+      when absent.
+    */
+    struct Problem {
+        /// Constructor; an empty problem
+        Problem() ;
+
+        int numCols_ ;
+        int numRows_ ;
+        /// Column starts; numCols_+1 entries unless #length_ is given
+        const int *start_ ;
+        /// Column lengths; null if the matrix is packed
+        const int *length_ ;
+        const int *index_ ;
+        const double *value_ ;
+        const double *colLower_ ;
+        const double *colUpper_ ;
+        const double *obj_ ;
+        const double *rowLower_ ;
+        const double *rowUpper_ ;
+        /// Nonzero for each integer column
+        const char *integer_ ;
+        /// Column status then row status, clp encoding
+        const unsigned char *status_ ;
+        /// Objective offset, as clp keeps it
+        double objOffset_ ;
+        /// Optimisation direction: 1 to minimise, -1 to maximise
+        double objSense_ ;
+        /// Problem name
+        const char *problemName_ ;
+        /// Row and column names
+        const char *const *rowNames_ ;
+        const char *const *colNames_ ;
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor
+    ModelSnapshot() ;
+    /// Destructor; releases the mapping
+    ~ModelSnapshot() ;
+    //@}
+
+    /*! \brief Write \p prob to \p path
+
+      The snapshot is written to a temporary file that's renamed over
+      \p path, so a process with the old file mapped keeps its view of it.
+
+      \returns 0 on success, -1 on error, with a description in \p error.
+    */
+    static int write(const std::string &path, const Problem &prob,
+                     std::string &error) ;
+
+    /*! \brief Map the snapshot at \p path
+
+      \returns 0 on success, -1 on error; #getError says what went wrong.
+    */
+    int read(const std::string &path) ;
+
+    /*! \brief Make this snapshot a copy of \p src, in memory of its own
+
+      The image is copied into memory first touched by the calling thread,
+      so on a NUMA machine it lands on the caller's node: one thread on each
+      node replicating a shared snapshot gives each node the model's arrays
+      locally. The copy lasts until the next read or replicate.
+
+      \returns 0 on success, -1 if \p src holds no problem
+    */
+    int replicate(const ModelSnapshot &src) ;
+
+    /// The problem read; valid until the next read
+    inline const Problem &getProblem () const {
+        return (prob_) ;
+    }
+
+    /// The error from the last read
+    inline const std::string &getError () const {
+        return (error_) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    ModelSnapshot(const ModelSnapshot &rhs) ;
+    /// Assignment (not implemented)
+    ModelSnapshot &operator=(const ModelSnapshot &rhs) ;
+
+    /// Release the mapping and forget the problem
+    void clear() ;
+    /// Check the snapshot at #base_ and point #prob_ into it
+    int load() ;
+    /// Record an error and return -1
+    int fail(const std::string &msg) ;
+
+    /// The file image
+    const char *base_ ;
+    /// Size of the file image
+    size_t size_ ;
+    /// True if #base_ is a mapping; otherwise it's #copy_
+    bool mapped_ ;
+    /// The file image, where it can't be mapped (doubles, for alignment)
+    std::vector<double> copy_ ;
+
+    /// The problem, pointing into the image
+    Problem prob_ ;
+    /// Name pointers for #prob_
+    std::vector<const char *> rowNames_ ;
+    std::vector<const char *> colNames_ ;
+
+    /// Error from the last read
+    std::string error_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,1222 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2MpsReader.cpp
+    \brief Method definitions for Osi2::MpsReader
+*/
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "CoinFinite.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2DynamicLibrary.hpp"
+#include "Osi2Threads.hpp"
+#include "Osi2MpsReader.hpp"
+
+#if !defined(S_ISREG) && defined(S_IFMT)
+# define S_ISREG(mode) (((mode)&S_IFMT) == S_IFREG)
+#endif
+
+#if defined(OSI2PLATFORM_MAC) || defined(__APPLE__)
+# define OSI2_LIBZ "libz.1.dylib"
+# define OSI2_LIBZSTD "libzstd.1.dylib"
+#elif defined(OSI2PLATFORM_WINDOWS) || defined(WIN32)
+# define OSI2_LIBZ "zlib1.dll"
+# define OSI2_LIBZSTD "libzstd.dll"
+#else
+# define OSI2_LIBZ "libz.so.1"
+# define OSI2_LIBZSTD "libzstd.so.1"
+#endif
+
+using namespace Osi2 ;
+
+namespace {
+
+/*
+  Reading and decompressing.
+*/
+
+/// Bytes read from a descriptor at a time
+const size_t readBlockSize = 1<<18 ;
+/// Room made in the output for each step of a decompressor
+const size_t outBlockSize = 1<<20 ;
+
+/*
+  Read up to len bytes, stopping early only at end of file. Returns the
+  number read, or -1 on error.
+*/
+long readFull (int fd, char *buf, size_t len)
+{
+    size_t got = 0 ;
+    while (got < len) {
+        const long n = static_cast<long>(::read(fd, buf+got, len-got)) ;
+        if (n < 0 && errno == EINTR) continue ;
+        if (n < 0) return (-1) ;
+        if (n == 0) break ;
+        got += static_cast<size_t>(n) ;
+    }
+    return (static_cast<long>(got)) ;
+}
+
+/// Recognise gzip and zstd by their magic numbers
+MpsReader::Compression detectCompression (const char *buf, long len)
+{
+    const unsigned char *magic = reinterpret_cast<const unsigned char *>(buf) ;
+    if (len >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+        return (MpsReader::Gzip) ;
+    if (len >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 &&
+            magic[2] == 0x2f && magic[3] == 0xfd)
+        return (MpsReader::Zstd) ;
+    return (MpsReader::Plain) ;
+}
+
+/*
+  Turns the bytes read into MPS text, appended to out.
+*/
+class Decoder {
+public:
+    virtual ~Decoder() {}
+    /// Load the decompressor, if there is one
+    virtual bool open (std::string &err) { return (true) ; }
+    /// Decode \p len bytes
+    virtual bool put(const char *data, size_t len, std::vector<char> &out,
+                     std::string &err) = 0 ;
+    /// Check that the input ended cleanly
+    virtual bool finish (std::string &err) { return (true) ; }
+} ;
+
+class PlainDecoder : public Decoder {
+public:
+    bool put (const char *data, size_t len, std::vector<char> &out,
+              std::string &err)
+    {
+        out.insert(out.end(), data, data+len) ;
+        return (true) ;
+    }
+} ;
+
+/*
+  zlib's inflate. We don't include zlib.h, so z_stream is declared here;
+  its layout hasn't changed in zlib 1.x, and inflateInit2_ checks the size.
+*/
+class GzipDecoder : public Decoder {
+public:
+    GzipDecoder () : lib_(nullptr), ended_(false), started_(false) {
+        ::memset(&strm_, 0, sizeof(strm_)) ;
+    }
+    ~GzipDecoder () {
+        if (started_) inflateEnd_(&strm_) ;
+        delete lib_ ;
+    }
+
+    bool open (std::string &err)
+    {
+        lib_ = DynamicLibrary::load(OSI2_LIBZ, err) ;
+        if (lib_ == nullptr) return (false) ;
+        SymbolBinding table[] = {
+            { "zlibVersion", nullptr },
+            { "inflateInit2_", nullptr },
+            { "inflate", nullptr },
+            { "inflateReset", nullptr },
+            { "inflateEnd", nullptr }
+        } ;
+        if (lib_->bindSymbols(table, 5, err) != 0) return (false) ;
+        zlibVersion_ = symbolToFunc<VersionFunc>(table[0].addr_) ;
+        inflateInit2_ = symbolToFunc<InitFunc>(table[1].addr_) ;
+        inflate_ = symbolToFunc<StreamIntFunc>(table[2].addr_) ;
+        inflateReset_ = symbolToFunc<StreamFunc>(table[3].addr_) ;
+        inflateEnd_ = symbolToFunc<StreamFunc>(table[4].addr_) ;
+        // 15+32: full window, gzip or zlib header
+        if (inflateInit2_(&strm_, 15+32, zlibVersion_(),
+                          static_cast<int>(sizeof(strm_))) != zOk) {
+            err = "Can't start zlib." ;
+            return (false) ;
+        }
+        started_ = true ;
+        return (true) ;
+    }
+
+    /*
+      A file can hold several gzip members end to end (pigz, cat); start
+      a new one whenever the last has ended and input remains.
+    */
+    bool put (const char *data, size_t len, std::vector<char> &out,
+              std::string &err)
+    {
+        strm_.next_in = reinterpret_cast<const unsigned char *>(data) ;
+        strm_.avail_in = static_cast<unsigned int>(len) ;
+        bool full = false ;
+        while (strm_.avail_in > 0 || full) {
+            if (ended_) {
+                if (strm_.avail_in == 0) break ;
+                inflateReset_(&strm_) ;
+                ended_ = false ;
+            }
+            const size_t old = out.size() ;
+            out.resize(old+outBlockSize) ;
+            strm_.next_out = reinterpret_cast<unsigned char *>(&out[old]) ;
+            strm_.avail_out = static_cast<unsigned int>(outBlockSize) ;
+            const int ret = inflate_(&strm_, 0) ;
+            full = (strm_.avail_out == 0) ;
+            out.resize(old+outBlockSize-strm_.avail_out) ;
+            if (ret == zStreamEnd) {
+                ended_ = true ;
+            } else if (ret == zBufError) {
+                if (!full) break ;
+            } else if (ret != zOk) {
+                err = "gzip input is corrupt" ;
+                if (strm_.msg != nullptr) err = err + ": " + strm_.msg ;
+                err += "." ;
+                return (false) ;
+            }
+        }
+        return (true) ;
+    }
+
+    bool finish (std::string &err)
+    {
+        if (!ended_) {
+            err = "gzip input ends early." ;
+            return (false) ;
+        }
+        return (true) ;
+    }
+
+private:
+    struct ZStream {
+        const unsigned char *next_in ;
+        unsigned int avail_in ;
+        unsigned long total_in ;
+        unsigned char *next_out ;
+        unsigned int avail_out ;
+        unsigned long total_out ;
+        const char *msg ;
+        void *state ;
+        void *zalloc ;
+        void *zfree ;
+        void *opaque ;
+        int data_type ;
+        unsigned long adler ;
+        unsigned long reserved ;
+    } ;
+    enum { zOk = 0, zStreamEnd = 1, zBufError = -5 } ;
+    typedef const char *(*VersionFunc)() ;
+    typedef int (*InitFunc)(ZStream *, int, const char *, int) ;
+    typedef int (*StreamIntFunc)(ZStream *, int) ;
+    typedef int (*StreamFunc)(ZStream *) ;
+
+    DynamicLibrary *lib_ ;
+    VersionFunc zlibVersion_ ;
+    InitFunc inflateInit2_ ;
+    StreamIntFunc inflate_ ;
+    StreamFunc inflateReset_ ;
+    StreamFunc inflateEnd_ ;
+    ZStream strm_ ;
+    bool ended_ ;
+    bool started_ ;
+} ;
+
+/*
+  zstd's streaming decompression. ZSTD_decompressStream runs on through
+  consecutive frames by itself.
+*/
+class ZstdDecoder : public Decoder {
+public:
+    ZstdDecoder () : lib_(nullptr), stream_(nullptr), last_(0) { }
+    ~ZstdDecoder () {
+        if (stream_ != nullptr) free_(stream_) ;
+        delete lib_ ;
+    }
+
+    bool open (std::string &err)
+    {
+        lib_ = DynamicLibrary::load(OSI2_LIBZSTD, err) ;
+        if (lib_ == nullptr) return (false) ;
+        SymbolBinding table[] = {
+            { "ZSTD_createDStream", nullptr },
+            { "ZSTD_initDStream", nullptr },
+            { "ZSTD_decompressStream", nullptr },
+            { "ZSTD_freeDStream", nullptr },
+            { "ZSTD_isError", nullptr },
+            { "ZSTD_getErrorName", nullptr }
+        } ;
+        if (lib_->bindSymbols(table, 6, err) != 0) return (false) ;
+        CreateFunc create = symbolToFunc<CreateFunc>(table[0].addr_) ;
+        InitFunc init = symbolToFunc<InitFunc>(table[1].addr_) ;
+        decompress_ = symbolToFunc<DecompressFunc>(table[2].addr_) ;
+        free_ = symbolToFunc<FreeFunc>(table[3].addr_) ;
+        isError_ = symbolToFunc<IsErrorFunc>(table[4].addr_) ;
+        errorName_ = symbolToFunc<ErrorNameFunc>(table[5].addr_) ;
+        stream_ = create() ;
+        if (stream_ == nullptr || isError_(init(stream_))) {
+            err = "Can't start zstd." ;
+            return (false) ;
+        }
+        return (true) ;
+    }
+
+    bool put (const char *data, size_t len, std::vector<char> &out,
+              std::string &err)
+    {
+        InBuffer in = { data, len, 0 } ;
+        bool full = false ;
+        while (in.pos < in.size || full) {
+            const size_t old = out.size() ;
+            out.resize(old+outBlockSize) ;
+            OutBuffer outBuf = { &out[old], outBlockSize, 0 } ;
+            const size_t ret = decompress_(stream_, &outBuf, &in) ;
+            full = (outBuf.pos == outBlockSize) ;
+            out.resize(old+outBuf.pos) ;
+            if (isError_(ret)) {
+                err = std::string("zstd input is corrupt: ")+errorName_(ret)+"." ;
+                return (false) ;
+            }
+            last_ = ret ;
+        }
+        return (true) ;
+    }
+
+    bool finish (std::string &err)
+    {
+        if (last_ != 0) {
+            err = "zstd input ends early." ;
+            return (false) ;
+        }
+        return (true) ;
+    }
+
+private:
+    struct InBuffer {
+        const void *src ;
+        size_t size ;
+        size_t pos ;
+    } ;
+    struct OutBuffer {
+        void *dst ;
+        size_t size ;
+        size_t pos ;
+    } ;
+    typedef void *(*CreateFunc)() ;
+    typedef size_t (*InitFunc)(void *) ;
+    typedef size_t (*DecompressFunc)(void *, OutBuffer *, InBuffer *) ;
+    typedef size_t (*FreeFunc)(void *) ;
+    typedef unsigned (*IsErrorFunc)(size_t) ;
+    typedef const char *(*ErrorNameFunc)(size_t) ;
+
+    DynamicLibrary *lib_ ;
+    void *stream_ ;
+    DecompressFunc decompress_ ;
+    FreeFunc free_ ;
+    IsErrorFunc isError_ ;
+    ErrorNameFunc errorName_ ;
+    size_t last_ ;
+} ;
+
+/*
+  Lines and tokens.
+*/
+
+/// A name or number in the text; points into the text, not terminated
+struct Token {
+    const char *str_ ;
+    int len_ ;
+} ;
+
+inline bool sameToken (const Token &a, const Token &b)
+{
+    return (a.len_ == b.len_ && ::memcmp(a.str_, b.str_, a.len_) == 0) ;
+}
+
+inline bool tokenIs (const Token &tok, const char *str)
+{
+    const size_t len = ::strlen(str) ;
+    return (static_cast<size_t>(tok.len_) == len &&
+            ::memcmp(tok.str_, str, len) == 0) ;
+}
+
+inline std::string tokenString (const Token &tok)
+{
+    return (std::string(tok.str_, tok.len_)) ;
+}
+
+inline bool isBlank (char c)
+{
+    return (c == ' ' || c == '\t' || c == '\r') ;
+}
+
+/*
+  Split the line [p, e) into tokens separated by blanks. Returns the number
+  of tokens, which can be more than maxTokens; only the first maxTokens are
+  stored.
+*/
+int splitLine (const char *p, const char *e, Token *tokens, int maxTokens)
+{
+    int n = 0 ;
+    for (;;) {
+        while (p < e && isBlank(*p)) p++ ;
+        if (p >= e) break ;
+        const char *s = p ;
+        while (p < e && !isBlank(*p)) p++ ;
+        if (n < maxTokens) {
+            tokens[n].str_ = s ;
+            tokens[n].len_ = static_cast<int>(p-s) ;
+        }
+        n++ ;
+    }
+    return (n) ;
+}
+
+/*
+  Convert a token to a number; magnitudes of 1e30 or more are infinite.
+  The token isn't terminated, and at the end of a mapped file there may be
+  nothing after it, so copy it out first.
+*/
+bool tokenToNumber (const Token &tok, double &value)
+{
+    char buf[64] ;
+    if (tok.len_ <= 0 || tok.len_ >= static_cast<int>(sizeof(buf)))
+        return (false) ;
+    ::memcpy(buf, tok.str_, tok.len_) ;
+    buf[tok.len_] = '\0' ;
+    char *end = nullptr ;
+    value = ::strtod(buf, &end) ;
+    if (end != buf+tok.len_) return (false) ;
+    if (value >= 1.0e30) value = COIN_DBL_MAX ;
+    else if (value <= -1.0e30) value = -COIN_DBL_MAX ;
+    return (true) ;
+}
+
+/*
+  Step through the lines of [begin, end). A line runs up to the next '\n',
+  which isn't part of it.
+*/
+class LineCursor {
+public:
+    LineCursor (const char *begin, const char *end, int lineNo = 0)
+        : p_(begin), end_(end), lineNo_(lineNo) { }
+
+    /// The next line, in [b, e); false at the end of the text
+    inline bool next (const char *&b, const char *&e)
+    {
+        if (p_ >= end_) return (false) ;
+        const char *nl =
+            static_cast<const char *>(::memchr(p_, '\n', end_-p_)) ;
+        b = p_ ;
+        e = (nl == nullptr) ? end_ : nl ;
+        p_ = (nl == nullptr) ? end_ : nl+1 ;
+        lineNo_++ ;
+        return (true) ;
+    }
+
+    /// Start of the next line
+    inline const char *position () const { return (p_) ; }
+    /// Number of the line last returned
+    inline int lineNo () const { return (lineNo_) ; }
+
+private:
+    const char *p_ ;
+    const char *end_ ;
+    int lineNo_ ;
+} ;
+
+/// MPS sections
+enum Section { NoSection = 0, NameSect, RowsSect, ColumnsSect, RhsSect,
+               RangesSect, BoundsSect, EndSect, OtherSect } ;
+
+/*
+  Classify the first token of a line that starts in column 1. In free
+  format a data line can start there too, so a token that isn't a known
+  section name is NoSection.
+*/
+Section sectionOf (const Token &tok)
+{
+    if (tokenIs(tok, "NAME")) return (NameSect) ;
+    if (tokenIs(tok, "ROWS")) return (RowsSect) ;
+    if (tokenIs(tok, "COLUMNS")) return (ColumnsSect) ;
+    if (tokenIs(tok, "RHS")) return (RhsSect) ;
+    if (tokenIs(tok, "RANGES")) return (RangesSect) ;
+    if (tokenIs(tok, "BOUNDS")) return (BoundsSect) ;
+    if (tokenIs(tok, "ENDATA")) return (EndSect) ;
+    static const char *const others[] = {
+        "OBJSENSE", "OBJSENS", "OBJNAME", "QUADOBJ", "QMATRIX", "QSECTION",
+        "QCMATRIX", "CSECTION", "SOS", "SETS", "INDICATORS", "USERCUTS",
+        "LAZYCONS", "BRANCH"
+    } ;
+    for (size_t i = 0 ; i < sizeof(others)/sizeof(others[0]) ; i++)
+        if (tokenIs(tok, others[i])) return (OtherSect) ;
+    return (NoSection) ;
+}
+
+/// True if the (nonblank) line starting at \p b could be a section header
+inline bool atHeader (const char *b)
+{
+    return (!isBlank(*b) && *b != '*') ;
+}
+
+/*
+  Names.
+*/
+
+/*
+  An open-addressed hash index over a vector of tokens. Read-only once
+  built, so the COLUMNS threads can share the row index.
+*/
+class NameIndex {
+public:
+    NameIndex () : names_(nullptr), mask_(0) { }
+
+    /// Index \p names; returns the position of the first repeat, or -1
+    int build (const std::vector<Token> &names)
+    {
+        names_ = &names ;
+        size_t size = 16 ;
+        while (size < 2*names.size()) size *= 2 ;
+        slots_.assign(size, -1) ;
+        mask_ = size-1 ;
+        for (size_t i = 0 ; i < names.size() ; i++) {
+            size_t slot = hash(names[i])&mask_ ;
+            while (slots_[slot] >= 0) {
+                if (sameToken(names[slots_[slot]], names[i]))
+                    return (static_cast<int>(i)) ;
+                slot = (slot+1)&mask_ ;
+            }
+            slots_[slot] = static_cast<int>(i) ;
+        }
+        return (-1) ;
+    }
+
+    /// Position of \p name in the vector; -1 if it isn't there
+    int find (const Token &name) const
+    {
+        if (mask_ == 0) return (-1) ;
+        size_t slot = hash(name)&mask_ ;
+        while (slots_[slot] >= 0) {
+            if (sameToken((*names_)[slots_[slot]], name))
+                return (slots_[slot]) ;
+            slot = (slot+1)&mask_ ;
+        }
+        return (-1) ;
+    }
+
+private:
+    /// FNV-1a
+    static inline size_t hash (const Token &tok)
+    {
+        size_t h = 2166136261u ;
+        for (int i = 0 ; i < tok.len_ ; i++) {
+            h ^= static_cast<unsigned char>(tok.str_[i]) ;
+            h *= 16777619u ;
+        }
+        return (h) ;
+    }
+
+    const std::vector<Token> *names_ ;
+    std::vector<int> slots_ ;
+    size_t mask_ ;
+} ;
+
+/*
+  A row in ROWS is a constraint (code >= 0, its index), the objective
+  (objRow), or another free row, which is dropped (freeRow).
+*/
+const int objRow = -1 ;
+const int freeRow = -2 ;
+
+/*
+  The COLUMNS section in pieces.
+*/
+
+/// Consecutive COLUMNS lines for one column
+struct ColumnRun {
+    /// Column name
+    Token name_ ;
+    /// First of its coefficients in the chunk
+    size_t first_ ;
+    /// Objective coefficient
+    double obj_ ;
+    /// 1 or 0 as set by a marker earlier in the chunk; -1 if none
+    int integer_ ;
+} ;
+
+/// A piece of COLUMNS, for one thread
+struct ColumnChunk {
+    ColumnChunk ()
+        : rowIndex_(nullptr), rowCode_(nullptr), begin_(nullptr),
+          end_(nullptr), endInteger_(-1), stop_(nullptr), lines_(0)
+    { }
+
+    /// \name Input
+    //@{
+    const NameIndex *rowIndex_ ;
+    const std::vector<int> *rowCode_ ;
+    const char *begin_ ;
+    const char *end_ ;
+    //@}
+
+    /// \name Output
+    //@{
+    std::vector<ColumnRun> runs_ ;
+    std::vector<int> rows_ ;
+    std::vector<double> values_ ;
+    /// Marker state at the end of the chunk; -1 if there was no marker
+    int endInteger_ ;
+    /// The section header that ends COLUMNS, if it's in this chunk
+    const char *stop_ ;
+    /// Lines read, not counting the header at stop_
+    int lines_ ;
+    /// Error, at the last line read
+    std::string error_ ;
+    //@}
+} ;
+
+/*
+  Parse the lines of a chunk as COLUMNS data, until the end of the chunk
+  or a section header. The chunk may start after the end of COLUMNS; its
+  results are thrown away once an earlier chunk finds the end.
+*/
+void parseColumns (ColumnChunk &chunk)
+{
+    const NameIndex &rowIndex = *chunk.rowIndex_ ;
+    const std::vector<int> &rowCode = *chunk.rowCode_ ;
+    LineCursor lines(chunk.begin_, chunk.end_) ;
+    const char *b = nullptr ;
+    const char *e = nullptr ;
+    Token tok[6] ;
+    int integer = -1 ;
+    while (lines.next(b, e)) {
+        const int n = splitLine(b, e, tok, 6) ;
+        if (n == 0 || *b == '*') continue ;
+        if (atHeader(b) && sectionOf(tok[0]) != NoSection) {
+            chunk.stop_ = b ;
+            chunk.lines_ = lines.lineNo()-1 ;
+            chunk.endInteger_ = integer ;
+            return ;
+        }
+        chunk.lines_ = lines.lineNo() ;
+        if (n >= 2 && tokenIs(tok[1], "'MARKER'")) {
+            if (n >= 3 && tokenIs(tok[2], "'INTORG'")) {
+                integer = 1 ;
+            } else if (n >= 3 && tokenIs(tok[2], "'INTEND'")) {
+                integer = 0 ;
+            } else {
+                chunk.error_ = "unknown marker." ;
+                return ;
+            }
+            continue ;
+        }
+        if (n != 3 && n != 5) {
+            chunk.error_ =
+                "expected a column, then one or two row and value pairs." ;
+            return ;
+        }
+        if (chunk.runs_.empty() || !sameToken(chunk.runs_.back().name_, tok[0])) {
+            ColumnRun run ;
+            run.name_ = tok[0] ;
+            run.first_ = chunk.rows_.size() ;
+            run.obj_ = 0.0 ;
+            run.integer_ = integer ;
+            chunk.runs_.push_back(run) ;
+        }
+        ColumnRun &run = chunk.runs_.back() ;
+        for (int k = 1 ; k < n ; k += 2) {
+            const int pos = rowIndex.find(tok[k]) ;
+            if (pos < 0) {
+                chunk.error_ = "unknown row " + tokenString(tok[k]) + "." ;
+                return ;
+            }
+            double value ;
+            if (!tokenToNumber(tok[k+1], value)) {
+                chunk.error_ = "bad number " + tokenString(tok[k+1]) + "." ;
+                return ;
+            }
+            const int code = rowCode[pos] ;
+            if (code >= 0) {
+                chunk.rows_.push_back(code) ;
+                chunk.values_.push_back(value) ;
+            } else if (code == objRow) {
+                run.obj_ += value ;
+            }
+        }
+    }
+    chunk.lines_ = lines.lineNo() ;
+    chunk.endInteger_ = integer ;
+}
+
+/// Thread body for parseColumns
+void *columnMain (void *arg)
+{
+    ColumnChunk &chunk = *static_cast<ColumnChunk *>(arg) ;
+    try {
+        parseColumns(chunk) ;
+    } catch (std::bad_alloc &) {
+        chunk.error_ = "out of memory." ;
+    }
+    return (nullptr) ;
+}
+
+/// columnMain as a thread pool task
+void columnTask (void *arg)
+{
+    columnMain(arg) ;
+}
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+MpsReader::MpsReader ()
+    : numThreads_(0),
+      chunkSize_(1<<20),
+      keepNames_(false),
+      numRows_(0),
+      haveIntegers_(false),
+      objOffset_(0.0),
+      canRetry_(true)
+{ }
+
+MpsReader::~MpsReader ()
+{ }
+
+void MpsReader::clear ()
+{
+    numRows_ = 0 ;
+    start_.clear() ;
+    index_.clear() ;
+    value_.clear() ;
+    colLower_.clear() ;
+    colUpper_.clear() ;
+    obj_.clear() ;
+    rowLower_.clear() ;
+    rowUpper_.clear() ;
+    integer_.clear() ;
+    haveIntegers_ = false ;
+    objOffset_ = 0.0 ;
+    problemName_.clear() ;
+    objName_.clear() ;
+    rowNames_.clear() ;
+    colNames_.clear() ;
+    error_.clear() ;
+    canRetry_ = true ;
+}
+
+int MpsReader::fail (int lineNo, const std::string &msg)
+{
+    std::ostringstream str ;
+    if (lineNo > 0) str << "Line " << lineNo << ": " ;
+    str << msg ;
+    error_ = str.str() ;
+    return (-1) ;
+}
+
+/*
+  Only a plain regular file is mapped. Compressed files and everything
+  that isn't a regular file are streamed.
+*/
+int MpsReader::readFile (const std::string &path)
+{
+    clear() ;
+    const int fd = ::open(path.c_str(), O_RDONLY) ;
+    if (fd < 0) {
+        error_ = "Can't open " + path + ": " + ::strerror(errno) + "." ;
+        return (-1) ;
+    }
+    struct stat info ;
+    if (::fstat(fd, &info) != 0) {
+        error_ = "Can't stat " + path + ": " + ::strerror(errno) + "." ;
+        ::close(fd) ;
+        return (-1) ;
+    }
+    int retval ;
+    if (S_ISREG(info.st_mode) && info.st_size > 0) {
+        const size_t size = static_cast<size_t>(info.st_size) ;
+        char magic[4] ;
+        const long got = readFull(fd, magic, sizeof(magic)) ;
+        const Compression compression = detectCompression(magic, got) ;
+        if (compression == Plain) {
+            retval = readMapped(fd, size) ;
+        } else if (::lseek(fd, 0, SEEK_SET) != 0) {
+            retval = fail(0, "Can't rewind " + path + ".") ;
+        } else {
+            retval = readStream(fd, compression, size) ;
+        }
+    } else {
+        canRetry_ = S_ISREG(info.st_mode) ;
+        retval = readStream(fd, Detect, 0) ;
+    }
+    ::close(fd) ;
+    return (retval) ;
+}
+
+int MpsReader::readFd (int fd, Compression compression)
+{
+    clear() ;
+    canRetry_ = false ;
+    return (readStream(fd, compression, 0)) ;
+}
+
+/*
+  The parse reads the mapping directly; nothing is copied. On a platform
+  without mmap, read it like a stream.
+*/
+int MpsReader::readMapped (int fd, size_t size)
+{
+#ifdef WIN32
+    if (_lseek(fd, 0, SEEK_SET) != 0) return (fail(0, "Can't rewind.")) ;
+    return (readStream(fd, Plain, size)) ;
+#else
+    void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) ;
+    if (map == MAP_FAILED) {
+        error_ = std::string("Can't map the file: ")+::strerror(errno)+"." ;
+        return (-1) ;
+    }
+#   ifdef MADV_WILLNEED
+    ::madvise(map, size, MADV_WILLNEED) ;
+#   endif
+    int retval = -1 ;
+    try {
+        retval = parse(static_cast<const char *>(map), size) ;
+    } catch (std::bad_alloc &) {
+        retval = fail(0, "Out of memory.") ;
+    }
+    ::munmap(map, size) ;
+    return (retval) ;
+#endif
+}
+
+/*
+  The text has to be in memory in one piece for the COLUMNS threads, so a
+  stream is read to the end before parsing starts. The names kept are
+  copied out of the text, so it can go once the parse is done.
+*/
+int MpsReader::readStream (int fd, Compression compression, size_t sizeHint)
+{
+    std::vector<char> block(readBlockSize) ;
+    long got = readFull(fd, &block[0], block.size()) ;
+    if (got < 0)
+        return (fail(0, std::string("Read failed: ")+::strerror(errno)+".")) ;
+    if (compression == Detect) compression = detectCompression(&block[0], got) ;
+    Decoder *decoder = nullptr ;
+    switch (compression) {
+        case Gzip:
+            decoder = new GzipDecoder() ;
+            break ;
+        case Zstd:
+            decoder = new ZstdDecoder() ;
+            break ;
+        default:
+            decoder = new PlainDecoder() ;
+            break ;
+    }
+    std::string err ;
+    int retval = 0 ;
+    std::vector<char> text ;
+    try {
+        if (!decoder->open(err)) {
+            retval = fail(0, "Can't decompress the input: " + err) ;
+        } else {
+            if (sizeHint > 0)
+                text.reserve((compression == Plain) ? sizeHint : 4*sizeHint) ;
+            while (got > 0) {
+                if (!decoder->put(&block[0], got, text, err)) break ;
+                got = readFull(fd, &block[0], block.size()) ;
+            }
+            if (!err.empty()) {
+                retval = fail(0, err) ;
+            } else if (got < 0) {
+                retval = fail(0, std::string("Read failed: ")+
+                                 ::strerror(errno)+".") ;
+            } else if (!decoder->finish(err)) {
+                retval = fail(0, err) ;
+            }
+        }
+        delete decoder ;
+        decoder = nullptr ;
+        if (retval == 0) {
+            const char *start = text.empty() ? "" : &text[0] ;
+            retval = parse(start, text.size()) ;
+        }
+    } catch (std::bad_alloc &) {
+        delete decoder ;
+        retval = fail(0, "Out of memory.") ;
+    }
+    return (retval) ;
+}
+
+/*
+  NAME and ROWS are read first. COLUMNS is then parsed in chunks, one
+  thread per chunk, merged in order, and the remaining sections are read
+  from wherever COLUMNS turned out to end.
+*/
+int MpsReader::parse (const char *text, size_t len)
+{
+    const char *const end = text+len ;
+    LineCursor lines(text, end) ;
+    const char *b = nullptr ;
+    const char *e = nullptr ;
+    Token tok[6] ;
+    /*
+      NAME and ROWS
+    */
+    std::vector<Token> rowTokens ;
+    std::vector<int> rowCode ;
+    std::vector<char> rowType ;
+    Token objToken = { "", 0 } ;
+    bool haveObj = false ;
+    Section section = NoSection ;
+    while (section != ColumnsSect && lines.next(b, e)) {
+        const int n = splitLine(b, e, tok, 6) ;
+        if (n == 0 || *b == '*') continue ;
+        if (atHeader(b)) {
+            const Section next = sectionOf(tok[0]) ;
+            if (next == OtherSect) {
+                fail(lines.lineNo(), "section " + tokenString(tok[0]) +
+                                     " is not supported.") ;
+                return (1) ;
+            }
+            if (next != NoSection) {
+                if (next != NameSect && next != RowsSect &&
+                        next != ColumnsSect)
+                    return (fail(lines.lineNo(), "expected ROWS, then COLUMNS.")) ;
+                if (next == NameSect && n > 1) {
+                    const char *p = tok[1].str_ ;
+                    const char *q = e ;
+                    while (q > p && isBlank(*(q-1))) q-- ;
+                    problemName_.assign(p, q-p) ;
+                }
+                section = next ;
+                continue ;
+            }
+        }
+        if (section != RowsSect)
+            return (fail(lines.lineNo(), "data outside a section.")) ;
+        if (n != 2 || tok[0].len_ != 1)
+            return (fail(lines.lineNo(), "expected a row type and name.")) ;
+        const char type = static_cast<char>(::toupper(tok[0].str_[0])) ;
+        int code = freeRow ;
+        if (type == 'N') {
+            if (!haveObj) {
+                code = objRow ;
+                objToken = tok[1] ;
+                haveObj = true ;
+            }
+        } else if (type == 'E' || type == 'L' || type == 'G') {
+            code = static_cast<int>(rowType.size()) ;
+            rowType.push_back(type) ;
+        } else {
+            return (fail(lines.lineNo(), "unknown row type " +
+                                         tokenString(tok[0]) + ".")) ;
+        }
+        rowTokens.push_back(tok[1]) ;
+        rowCode.push_back(code) ;
+    }
+    if (section != ColumnsSect) return (fail(0, "No COLUMNS section.")) ;
+    NameIndex rowIndex ;
+    const int dupRow = rowIndex.build(rowTokens) ;
+    if (dupRow >= 0)
+        return (fail(0, "Row " + tokenString(rowTokens[dupRow]) +
+                        " is declared twice.")) ;
+    numRows_ = static_cast<int>(rowType.size()) ;
+    /*
+      COLUMNS. Cut the rest of the text into chunks at line boundaries.
+      The first chunk is parsed here, the others in the thread pool if
+      there is one, otherwise in threads; a chunk whose thread can't be
+      started is parsed here too.
+    */
+    const char *const colBegin = lines.position() ;
+    const int colLine = lines.lineNo() ;
+    const size_t colBytes = end-colBegin ;
+    const bool pooled = threads_.enabled() ;
+    size_t numChunks = numThreads_ ;
+    if (numChunks == 0)
+        numChunks = pooled ? threads_.getNumThreads()+1 : numProcessors() ;
+    if (numChunks > colBytes/chunkSize_+1) numChunks = colBytes/chunkSize_+1 ;
+    std::vector<ColumnChunk> chunks(numChunks) ;
+    const char *p = colBegin ;
+    for (size_t i = 0 ; i < numChunks ; i++) {
+        ColumnChunk &chunk = chunks[i] ;
+        chunk.rowIndex_ = &rowIndex ;
+        chunk.rowCode_ = &rowCode ;
+        chunk.begin_ = p ;
+        if (i == numChunks-1) {
+            p = end ;
+        } else {
+            const char *q = colBegin+(colBytes/numChunks)*(i+1) ;
+            if (q < p) q = p ;
+            const char *nl = static_cast<const char *>(::memchr(q, '\n', end-q)) ;
+            p = (nl == nullptr) ? end : nl+1 ;
+        }
+        chunk.end_ = p ;
+    }
+    if (pooled) {
+        std::vector<void *> args(numChunks) ;
+        for (size_t i = 0 ; i < numChunks ; i++) args[i] = &chunks[i] ;
+        threads_.run(columnTask, &args[0], static_cast<int>(numChunks)) ;
+    } else {
+        std::vector<ThreadHandle> threads(numChunks) ;
+        std::vector<char> started(numChunks, 0) ;
+        for (size_t i = 1 ; i < numChunks ; i++)
+            started[i] = startThread(threads[i], columnMain, &chunks[i]) ;
+        columnMain(&chunks[0]) ;
+        for (size_t i = 1 ; i < numChunks ; i++) {
+            if (started[i]) joinThread(threads[i]) ;
+            else columnMain(&chunks[i]) ;
+        }
+    }
+    /*
+      Find where COLUMNS ended and check for errors up to there.
+    */
+    size_t numUsed = 0 ;
+    size_t numElements = 0 ;
+    int lineNo = colLine ;
+    for (size_t i = 0 ; i < numChunks ; i++) {
+        const ColumnChunk &chunk = chunks[i] ;
+        if (!chunk.error_.empty())
+            return (fail(lineNo+chunk.lines_, chunk.error_)) ;
+        numUsed++ ;
+        numElements += chunk.rows_.size() ;
+        lineNo += chunk.lines_ ;
+        if (chunk.stop_ != nullptr) break ;
+    }
+    if (numElements > static_cast<size_t>(INT_MAX))
+        return (fail(0, "Too many coefficients.")) ;
+    /*
+      Merge. A column can straddle two chunks, in which case the second
+      chunk starts with a run for the column the first ended with.
+    */
+    index_.resize(numElements) ;
+    value_.resize(numElements) ;
+    std::vector<Token> colTokens ;
+    int integer = 0 ;
+    size_t offset = 0 ;
+    for (size_t i = 0 ; i < numUsed ; i++) {
+        ColumnChunk &chunk = chunks[i] ;
+        for (size_t k = 0 ; k < chunk.runs_.size() ; k++) {
+            const ColumnRun &run = chunk.runs_[k] ;
+            if (k > 0 || colTokens.empty() ||
+                    !sameToken(colTokens.back(), run.name_)) {
+                start_.push_back(static_cast<int>(offset+run.first_)) ;
+                colTokens.push_back(run.name_) ;
+                obj_.push_back(0.0) ;
+                const int isInt = (run.integer_ >= 0) ? run.integer_ : integer ;
+                integer_.push_back(static_cast<char>(isInt)) ;
+                if (isInt) haveIntegers_ = true ;
+            }
+            obj_.back() += run.obj_ ;
+        }
+        if (chunk.endInteger_ >= 0) integer = chunk.endInteger_ ;
+        const size_t count = chunk.rows_.size() ;
+        if (count > 0) {
+            ::memcpy(&index_[offset], &chunk.rows_[0], count*sizeof(int)) ;
+            ::memcpy(&value_[offset], &chunk.values_[0], count*sizeof(double)) ;
+        }
+        offset += count ;
+        std::vector<int>().swap(chunk.rows_) ;
+        std::vector<double>().swap(chunk.values_) ;
+    }
+    start_.push_back(static_cast<int>(offset)) ;
+    NameIndex colIndex ;
+    const int dupCol = colIndex.build(colTokens) ;
+    if (dupCol >= 0)
+        return (fail(0, "Column " + tokenString(colTokens[dupCol]) +
+                        " is not contiguous.")) ;
+    const size_t numCols = colTokens.size() ;
+    colLower_.assign(numCols, 0.0) ;
+    colUpper_.assign(numCols, COIN_DBL_MAX) ;
+    /*
+      RHS, RANGES and BOUNDS, from the header that ended COLUMNS. Each may
+      name a set; only the first set is used. In RHS and RANGES an odd
+      number of fields means the line starts with the set name.
+    */
+    std::vector<double> rhs(numRows_, 0.0) ;
+    std::vector<double> range(numRows_, 0.0) ;
+    std::vector<char> hasRange(numRows_, 0) ;
+    Token sets[3] ;
+    bool haveSet[3] = { false, false, false } ;
+    const char *rest = chunks[numUsed-1].stop_ ;
+    LineCursor tail((rest == nullptr) ? end : rest, end, lineNo) ;
+    section = ColumnsSect ;
+    while (section != EndSect && tail.next(b, e)) {
+        const int n = splitLine(b, e, tok, 6) ;
+        if (n == 0 || *b == '*') continue ;
+        if (atHeader(b)) {
+            const Section next = sectionOf(tok[0]) ;
+            if (next == OtherSect) {
+                fail(tail.lineNo(), "section " + tokenString(tok[0]) +
+                                    " is not supported.") ;
+                return (1) ;
+            }
+            if (next != NoSection) {
+                if (next == NameSect || next == RowsSect || next == ColumnsSect)
+                    return (fail(tail.lineNo(), "section " +
+                                 tokenString(tok[0]) + " is out of order.")) ;
+                section = next ;
+                continue ;
+            }
+        }
+        if (section == RhsSect || section == RangesSect) {
+            const int which = (section == RhsSect) ? 0 : 1 ;
+            if (n < 2 || n > 5)
+                return (fail(tail.lineNo(), "expected row and value pairs.")) ;
+            int k = 0 ;
+            if (n%2 == 1) {
+                if (!haveSet[which]) {
+                    sets[which] = tok[0] ;
+                    haveSet[which] = true ;
+                } else if (!sameToken(sets[which], tok[0])) {
+                    continue ;
+                }
+                k = 1 ;
+            }
+            for ( ; k < n ; k += 2) {
+                const int pos = rowIndex.find(tok[k]) ;
+                if (pos < 0)
+                    return (fail(tail.lineNo(), "unknown row " +
+                                                tokenString(tok[k]) + ".")) ;
+                double value ;
+                if (!tokenToNumber(tok[k+1], value))
+                    return (fail(tail.lineNo(), "bad number " +
+                                                tokenString(tok[k+1]) + ".")) ;
+                const int code = rowCode[pos] ;
+                if (code >= 0) {
+                    if (which == 0) {
+                        rhs[code] = value ;
+                    } else {
+                        range[code] = value ;
+                        hasRange[code] = 1 ;
+                    }
+                } else if (code == objRow && which == 0) {
+                    objOffset_ = value ;
+                }
+            }
+        } else if (section == BoundsSect) {
+            /*
+              type [set] column value, where FR, MI, PL and BV need no
+              value. With three fields and no value needed, the second is
+              the set if the third is a column.
+            */
+            const Token &type = tok[0] ;
+            const bool needsValue = tokenIs(type, "UP") || tokenIs(type, "LO") ||
+                                    tokenIs(type, "FX") || tokenIs(type, "LI") ||
+                                    tokenIs(type, "UI") ;
+            const bool noValue = tokenIs(type, "FR") || tokenIs(type, "MI") ||
+                                 tokenIs(type, "PL") || tokenIs(type, "BV") ;
+            if (tokenIs(type, "SC")) {
+                fail(tail.lineNo(), "semicontinuous bounds are not supported.") ;
+                return (1) ;
+            }
+            if (!needsValue && !noValue)
+                return (fail(tail.lineNo(), "unknown bound type " +
+                                            tokenString(type) + ".")) ;
+            if (n < 2 || n > 4 || (needsValue && n < 3))
+                return (fail(tail.lineNo(), "expected a bound type, column "
+                                            "and value.")) ;
+            int colTok = 1 ;
+            if (n == 4 || (noValue && n == 3 && colIndex.find(tok[2]) >= 0))
+                colTok = 2 ;
+            if (colTok == 2) {
+                if (!haveSet[2]) {
+                    sets[2] = tok[1] ;
+                    haveSet[2] = true ;
+                } else if (!sameToken(sets[2], tok[1])) {
+                    continue ;
+                }
+            }
+            const int j = colIndex.find(tok[colTok]) ;
+            if (j < 0)
+                return (fail(tail.lineNo(), "unknown column " +
+                                            tokenString(tok[colTok]) + ".")) ;
+            double value = 0.0 ;
+            if (needsValue && !tokenToNumber(tok[colTok+1], value))
+                return (fail(tail.lineNo(), "bad number " +
+                                            tokenString(tok[colTok+1]) + ".")) ;
+            if (tokenIs(type, "UP") || tokenIs(type, "UI")) {
+                colUpper_[j] = value ;
+                if (value < 0.0 && colLower_[j] == 0.0)
+                    colLower_[j] = -COIN_DBL_MAX ;
+            } else if (tokenIs(type, "LO") || tokenIs(type, "LI")) {
+                colLower_[j] = value ;
+            } else if (tokenIs(type, "FX")) {
+                colLower_[j] = value ;
+                colUpper_[j] = value ;
+            } else if (tokenIs(type, "FR")) {
+                colLower_[j] = -COIN_DBL_MAX ;
+                colUpper_[j] = COIN_DBL_MAX ;
+            } else if (tokenIs(type, "MI")) {
+                colLower_[j] = -COIN_DBL_MAX ;
+            } else if (tokenIs(type, "PL")) {
+                colUpper_[j] = COIN_DBL_MAX ;
+            } else {
+                colLower_[j] = 0.0 ;
+                colUpper_[j] = 1.0 ;
+            }
+            if (tokenIs(type, "LI") || tokenIs(type, "UI") ||
+                    tokenIs(type, "BV")) {
+                integer_[j] = 1 ;
+                haveIntegers_ = true ;
+            }
+        } else {
+            return (fail(tail.lineNo(), "data outside a section.")) ;
+        }
+    }
+    /*
+      Row bounds from the row type, RHS and range.
+    */
+    rowLower_.resize(numRows_) ;
+    rowUpper_.resize(numRows_) ;
+    for (int i = 0 ; i < numRows_ ; i++) {
+        const double r = rhs[i] ;
+        const double absRange = (range[i] < 0.0) ? -range[i] : range[i] ;
+        switch (rowType[i]) {
+            case 'E':
+                if (hasRange[i] && range[i] < 0.0) {
+                    rowLower_[i] = r-absRange ;
+                    rowUpper_[i] = r ;
+                } else {
+                    rowLower_[i] = r ;
+                    rowUpper_[i] = hasRange[i] ? r+absRange : r ;
+                }
+                break ;
+            case 'L':
+                rowLower_[i] = hasRange[i] ? r-absRange : -COIN_DBL_MAX ;
+                rowUpper_[i] = r ;
+                break ;
+            default:
+                rowLower_[i] = r ;
+                rowUpper_[i] = hasRange[i] ? r+absRange : COIN_DBL_MAX ;
+                break ;
+        }
+    }
+    if (haveObj) objName_ = tokenString(objToken) ;
+    if (keepNames_) {
+        rowNames_.resize(numRows_) ;
+        for (size_t i = 0 ; i < rowTokens.size() ; i++)
+            if (rowCode[i] >= 0) rowNames_[rowCode[i]] = tokenString(rowTokens[i]) ;
+        colNames_.resize(numCols) ;
+        for (size_t j = 0 ; j < numCols ; j++)
+            colNames_[j] = tokenString(colTokens[j]) ;
+    }
+    return (0) ;
+}
+
+}  // end namespace Osi2
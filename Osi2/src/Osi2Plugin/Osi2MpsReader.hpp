@@ -0,0 +1,291 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2MpsReader.hpp
+    \brief A reader for large MPS files.
+
+  See Osi2::MpsReader.
+*/
+
+#ifndef Osi2MpsReader_HPP
+#define Osi2MpsReader_HPP
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+#include "Osi2PluginThreads.hpp"
+
+namespace Osi2 {
+
+/*! \brief Read an MPS file into column-major arrays
+
+  Meant for large models, and used by the shims behind readMps. A plain
+  file is memory-mapped and parsed in place. Anything else (a pipe, a file
+  descriptor, gzip or zstd input) is read into memory in one pass,
+  decompressed on the way. The COLUMNS section, which is the bulk of any
+  large model, is then cut into pieces at line boundaries. The pieces are
+  parsed in parallel and merged into a single CSC matrix. The result is in
+  the form ProbMgmtAPI::loadProblem takes.
+
+  Compressed input is recognised by its magic number, not by the file
+  name. The decompressors (libz, libzstd) are loaded at run time when first
+  needed, as the light clp shim loads libClp, so neither is a build
+  dependency. If one can't be loaded, input that needs it is an error.
+
+  The reader handles free-format MPS, and fixed-format MPS whose names have
+  no embedded blanks. It reads the sections NAME, ROWS, COLUMNS (with
+  integer markers), RHS, RANGES, BOUNDS and ENDATA. Any other section
+  (OBJSENSE, QUADOBJ, SOS, and so on), and semicontinuous bounds, are
+  reported as unsupported, so that the caller can fall back to a full
+  reader such as CoinMpsIO. As in CoinMpsIO:
+    - Only the first N row is kept, as the objective. Other free rows are
+      dropped.
+    - Only the first RHS, RANGES and BOUNDS sets are used.
+    - Values of 1e30 or more in magnitude are infinite.
+*/
+class MpsReader {
+
+public:
+
+    /// Compression of the input
+    enum Compression {
+        /// Decide from the first bytes
+        Detect = 0,
+        /// Plain text
+        Plain,
+        /// gzip (or zlib)
+        Gzip,
+        /// zstd
+        Zstd
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor
+    MpsReader() ;
+    /// Destructor
+    ~MpsReader() ;
+    //@}
+
+    /*! \name Reading
+
+      Each read replaces the previous problem. The return value is 0 on
+      success, 1 if the input uses MPS features the reader doesn't handle,
+      and -1 for any other error; #getError says what went wrong.
+    */
+    //@{
+    /*! \brief Read the file at \p path
+
+      A regular file that isn't compressed is memory-mapped. Anything else
+      (a named pipe, \c /dev/stdin, \c /dev/fd/N) is read as a stream.
+    */
+    int readFile(const std::string &path) ;
+
+    /*! \brief Read from the open file descriptor \p fd
+
+      Reads to end of file. The descriptor is left open.
+    */
+    int readFd(int fd, Compression compression = Detect) ;
+
+    /// The error from the last read
+    inline const std::string &getError () const {
+        return (error_) ;
+    }
+
+    /*! \brief True if the input to a failed read can be given to another
+               reader
+
+      True if it's a regular file, or couldn't be opened at all. A stream
+      that's been read from is gone.
+    */
+    inline bool canRetry () const {
+        return (canRetry_) ;
+    }
+    //@}
+
+    /// \name Parameters
+    //@{
+    /// Set the number of threads for COLUMNS; 0 means one per processor
+    inline void setNumThreads (int numThreads) {
+        numThreads_ = (numThreads < 0) ? 0 : numThreads ;
+    }
+    /// Number of threads for COLUMNS; 0 means one per processor
+    inline int getNumThreads () const {
+        return (numThreads_) ;
+    }
+    /*! \brief Parse COLUMNS in the plugin manager's thread pool
+
+      Instead of threads of the reader's own. With the pool, 0 threads
+      means one piece for each of the pool's workers and one for the
+      calling thread.
+    */
+    inline void setThreads (const PluginThreads &threads) {
+        threads_ = threads ;
+    }
+    /// Set the smallest piece of COLUMNS given to a thread, in bytes
+    inline void setChunkSize (size_t chunkSize) {
+        chunkSize_ = (chunkSize < 1) ? 1 : chunkSize ;
+    }
+    /// Smallest piece of COLUMNS given to a thread (default 1 MB)
+    inline size_t getChunkSize () const {
+        return (chunkSize_) ;
+    }
+    /// Keep row and column names (default false)
+    inline void setKeepNames (bool keepNames) {
+        keepNames_ = keepNames ;
+    }
+    /// True if row and column names are kept
+    inline bool getKeepNames () const {
+        return (keepNames_) ;
+    }
+    //@}
+
+    /*! \name The problem
+
+      Valid after a successful read. Every bound is filled in; infinite
+      bounds are +/-COIN_DBL_MAX.
+    */
+    //@{
+    /// Number of rows, not counting the objective
+    inline int getNumRows () const {
+        return (numRows_) ;
+    }
+    /// Number of columns
+    inline int getNumCols () const {
+        return (static_cast<int>(colLower_.size())) ;
+    }
+    /// Number of coefficients
+    inline int getNumElements () const {
+        return (static_cast<int>(index_.size())) ;
+    }
+    /// Column starts; getNumCols()+1 entries
+    inline const int *getStarts () const {
+        return (dataOf(start_)) ;
+    }
+    /// Row index of each coefficient
+    inline const int *getIndices () const {
+        return (dataOf(index_)) ;
+    }
+    /// Coefficients
+    inline const double *getValues () const {
+        return (dataOf(value_)) ;
+    }
+    /// Column lower bounds
+    inline const double *getColLower () const {
+        return (dataOf(colLower_)) ;
+    }
+    /// Column upper bounds
+    inline const double *getColUpper () const {
+        return (dataOf(colUpper_)) ;
+    }
+    /// Objective coefficients
+    inline const double *getObjective () const {
+        return (dataOf(obj_)) ;
+    }
+    /// Row lower bounds
+    inline const double *getRowLower () const {
+        return (dataOf(rowLower_)) ;
+    }
+    /// Row upper bounds
+    inline const double *getRowUpper () const {
+        return (dataOf(rowUpper_)) ;
+    }
+    /// 1 for each integer column, 0 otherwise; null if there are none
+    inline const char *getIntegerInfo () const {
+        return (haveIntegers_ ? dataOf(integer_) : 0) ;
+    }
+    /*! \brief The objective offset, as clp keeps it
+
+      The RHS of the objective row; the objective is c'x - offset.
+    */
+    inline double getObjOffset () const {
+        return (objOffset_) ;
+    }
+    /// Problem name, from the NAME line
+    inline const std::string &getProblemName () const {
+        return (problemName_) ;
+    }
+    /// Name of the objective row
+    inline const std::string &getObjName () const {
+        return (objName_) ;
+    }
+    /// Row names; empty unless names are kept
+    inline const std::vector<std::string> &getRowNames () const {
+        return (rowNames_) ;
+    }
+    /// Column names; empty unless names are kept
+    inline const std::vector<std::string> &getColNames () const {
+        return (colNames_) ;
+    }
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    MpsReader(const MpsReader &rhs) ;
+    /// Assignment (not implemented)
+    MpsReader &operator=(const MpsReader &rhs) ;
+
+    /// The data of a vector; null if it's empty
+    template <typename T>
+    static inline const T *dataOf (const std::vector<T> &vec) {
+        return (vec.empty() ? 0 : &vec[0]) ;
+    }
+
+    /// Forget the last problem
+    void clear() ;
+    /// Map \p fd (\p size bytes) and parse it
+    int readMapped(int fd, size_t size) ;
+    /*! \brief Read \p fd to end of file, decompressing, and parse the
+               text
+
+      \p sizeHint is the size of the input when known, 0 otherwise.
+    */
+    int readStream(int fd, Compression compression, size_t sizeHint) ;
+    /// Parse \p len bytes of MPS text
+    int parse(const char *text, size_t len) ;
+    /// Record an error at line \p lineNo and return -1
+    int fail(int lineNo, const std::string &msg) ;
+
+    /// \name Parameters
+    //@{
+    int numThreads_ ;
+    PluginThreads threads_ ;
+    size_t chunkSize_ ;
+    bool keepNames_ ;
+    //@}
+
+    /// \name The problem
+    //@{
+    int numRows_ ;
+    std::vector<int> start_ ;
+    std::vector<int> index_ ;
+    std::vector<double> value_ ;
+    std::vector<double> colLower_ ;
+    std::vector<double> colUpper_ ;
+    std::vector<double> obj_ ;
+    std::vector<double> rowLower_ ;
+    std::vector<double> rowUpper_ ;
+    std::vector<char> integer_ ;
+    bool haveIntegers_ ;
+    double objOffset_ ;
+    std::string problemName_ ;
+    std::string objName_ ;
+    std::vector<std::string> rowNames_ ;
+    std::vector<std::string> colNames_ ;
+    //@}
+
+    /// Error from the last read
+    std::string error_ ;
+    /// See #canRetry
+    bool canRetry_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
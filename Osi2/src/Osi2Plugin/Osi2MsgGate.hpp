@@ -0,0 +1,104 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2MsgGate.hpp
+    \brief Cheap tests to suppress messages that won't print.
+
+  CoinMessageHandler decides whether a message will print only after the
+  message has been started, and every argument shifted into the message is
+  evaluated (and, for strings, copied) regardless. On a path that's executed
+  often (object creation, for instance) that's a noticeable cost for
+  messages that almost never print.
+
+  The tools here let a caller test first. A message is issued only if its
+  log level is no greater than both the build-time maximum #OSI2_MSG_MAXLVL
+  and the handler's log level. Used as
+  <pre>
+    OSI2_MSG_IF(msgEnabled(handler, lvl))
+        handler->message(id, msgs) << arg1 << arg2 << CoinMessageEol ;
+  </pre>
+  the arguments are not evaluated unless the message will print. When
+  \c lvl is a compile-time constant greater than #OSI2_MSG_MAXLVL, the
+  compiler discards the message altogether.
+
+  The comparison is made against the handler's overall log level
+  (CoinMessageHandler::logLevel()); log levels set for individual message
+  classes are not consulted.
+*/
+
+#ifndef OSI2MSGGATE_HPP
+#define OSI2MSGGATE_HPP
+
+#include "CoinMessageHandler.hpp"
+
+#include "Osi2Threads.hpp"
+
+/*! \brief Maximum message log level compiled into the library
+
+  Messages with a higher log level are compiled out. The default keeps all
+  messages; define a lower value at build time (e.g.,
+  <tt>-DOSI2_MSG_MAXLVL=4</tt>) to drop the debugging messages.
+*/
+#ifndef OSI2_MSG_MAXLVL
+# define OSI2_MSG_MAXLVL 7
+#endif
+
+/*! \brief Execute the following statement only if \p zz_cond is true
+
+  Written as an if-else so that it can be used safely as the body of an
+  unbraced if.
+*/
+#define OSI2_MSG_IF(zz_cond) if (!(zz_cond)) ; else
+
+namespace Osi2 {
+
+/// True if a message of log level \p lvl would be printed by \p handler
+inline bool msgEnabled (const CoinMessageHandler *handler, int lvl)
+{
+    return (lvl <= OSI2_MSG_MAXLVL && lvl <= handler->logLevel()) ;
+}
+
+/*! \brief Message handler reference that holds a lock
+
+  Intended for use as a temporary: the lock is held until the end of the
+  full expression, which covers the whole of a message, from
+  CoinMessageHandler::message through CoinMessageEol.
+  <pre>
+    LockedMsgHandler(mutex, handler)->message(id, msgs) << ... << CoinMessageEol ;
+  </pre>
+*/
+class LockedMsgHandler {
+
+public:
+
+    /// Constructor; acquires \p mutex
+    LockedMsgHandler (Mutex &mutex, CoinMessageHandler *handler)
+        : lock_(mutex),
+          handler_(handler)
+    { }
+
+    /// Access the handler
+    inline CoinMessageHandler *operator-> () const {
+        return (handler_) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    LockedMsgHandler(const LockedMsgHandler &rhs) ;
+    /// Assignment (not implemented)
+    LockedMsgHandler &operator=(const LockedMsgHandler &rhs) ;
+
+    /// The lock
+    ScopedLock lock_ ;
+    /// The handler
+    CoinMessageHandler *handler_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,241 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Numa.cpp
+    \brief Method definitions for Osi2::NumaTopology and NUMA placement
+*/
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2Numa.hpp"
+#include "Osi2Threads.hpp"
+
+namespace {
+
+/*
+  The machine's topology, made on first use and kept for the life of the
+  process.
+*/
+Osi2::Mutex systemMutex ;
+Osi2::NumaTopology *systemTopology = nullptr ;
+
+/*
+  A sysfs list, as in "0-3,8,10-11". Returns false if the text isn't one.
+*/
+bool parseList (const std::string &text, std::vector<int> &values)
+{
+    values.clear() ;
+    std::istringstream in(text) ;
+    std::string item ;
+    while (std::getline(in, item, ',')) {
+        if (item.empty()) continue ;
+        char *end = nullptr ;
+        const long first = std::strtol(item.c_str(), &end, 10) ;
+        long last = first ;
+        if (end == item.c_str() || first < 0) return (false) ;
+        if (*end == '-') {
+            const char *from = end+1 ;
+            last = std::strtol(from, &end, 10) ;
+            if (end == from || last < first) return (false) ;
+        }
+        if (*end != '\0') return (false) ;
+        for (long v = first ; v <= last ; v++)
+            values.push_back(static_cast<int>(v)) ;
+    }
+    return (true) ;
+}
+
+/// First line of the file at \p path, without the newline
+bool readLine (const std::string &path, std::string &line)
+{
+    std::ifstream file(path.c_str()) ;
+    line.clear() ;
+    if (!file) return (false) ;
+    std::getline(file, line) ;
+    return (true) ;
+}
+
+#if defined(__linux__) && defined(SYS_move_pages)
+
+/// move_pages(2) flag: move pages used only by this process
+const int mpolMoveFlag = (1 << 1) ;
+
+/*
+  Pages go to the kernel a batch at a time. With nodes null, move_pages
+  moves nothing and reports where each page is.
+*/
+long movePages (void **pages, size_t count, const int *nodes, int *status)
+{
+    return (::syscall(SYS_move_pages, 0, static_cast<unsigned long>(count),
+                      pages, nodes, status, (nodes == 0) ? 0 : mpolMoveFlag)) ;
+}
+
+#endif
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+NumaTopology::NumaTopology ()
+    : cpus_(1),
+      sysNodes_(1, 0)
+{
+    for (int cpu = 0 ; cpu < numProcessors() ; cpu++) cpus_[0].push_back(cpu) ;
+}
+
+NumaTopology::~NumaTopology ()
+{ }
+
+/*
+  Read everything before changing anything, so that a tree that can't be
+  read leaves the one-node default.
+*/
+int NumaTopology::load (const std::string &root)
+{
+    *this = NumaTopology() ;
+    std::string line ;
+    std::vector<int> sysNodes ;
+    if (!readLine(root+"/online", line) || !parseList(line, sysNodes) ||
+            sysNodes.empty())
+        return (-1) ;
+    std::vector<std::vector<int> > cpus(sysNodes.size()) ;
+    for (size_t n = 0 ; n < sysNodes.size() ; n++) {
+        std::ostringstream path ;
+        path << root << "/node" << sysNodes[n] << "/cpulist" ;
+        if (!readLine(path.str(), line) || !parseList(line, cpus[n]))
+            return (-1) ;
+    }
+    cpus_.swap(cpus) ;
+    sysNodes_.swap(sysNodes) ;
+    return (getNumNodes()) ;
+}
+
+const std::vector<int> &NumaTopology::getCpus (int node) const
+{
+    static const std::vector<int> none ;
+    if (node < 0 || node >= getNumNodes()) return (none) ;
+    return (cpus_[node]) ;
+}
+
+int NumaTopology::getNodeOfCpu (int cpu) const
+{
+    for (int n = 0 ; n < getNumNodes() ; n++) {
+        const std::vector<int> &cpus = cpus_[n] ;
+        for (size_t k = 0 ; k < cpus.size() ; k++) {
+            if (cpus[k] == cpu) return (n) ;
+        }
+    }
+    return (0) ;
+}
+
+int NumaTopology::getSystemNode (int node) const
+{
+    if (node < 0 || node >= getNumNodes()) return (-1) ;
+    return (sysNodes_[node]) ;
+}
+
+const NumaTopology &NumaTopology::system ()
+{
+    ScopedLock lock(systemMutex) ;
+    if (systemTopology == nullptr) {
+        NumaTopology *topology = new NumaTopology() ;
+#       if defined(__linux__)
+        topology->load("/sys/devices/system/node") ;
+#       endif
+        systemTopology = topology ;
+    }
+    return (*systemTopology) ;
+}
+
+bool numaBindThread (int node)
+{
+    const std::vector<int> &cpus = NumaTopology::system().getCpus(node) ;
+    if (cpus.empty()) return (false) ;
+#   if defined(__linux__) && defined(CPU_SET)
+    cpu_set_t mask ;
+    CPU_ZERO(&mask) ;
+    int numSet = 0 ;
+    for (size_t k = 0 ; k < cpus.size() ; k++) {
+        if (cpus[k] >= CPU_SETSIZE) continue ;
+        CPU_SET(cpus[k], &mask) ;
+        numSet++ ;
+    }
+    if (numSet == 0) return (false) ;
+    return (::sched_setaffinity(0, sizeof(mask), &mask) == 0) ;
+#   else
+    return (false) ;
+#   endif
+}
+
+int numaCurrentNode ()
+{
+#   if defined(__linux__) && defined(CPU_SET)
+    const int cpu = ::sched_getcpu() ;
+    if (cpu >= 0) return (NumaTopology::system().getNodeOfCpu(cpu)) ;
+#   endif
+    return (0) ;
+}
+
+long numaMigrate (const void *addr, size_t len, int node)
+{
+#   if defined(__linux__) && defined(SYS_move_pages)
+    const int sysNode = NumaTopology::system().getSystemNode(node) ;
+    if (sysNode < 0) return (-1) ;
+    if (addr == nullptr || len == 0) return (0) ;
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE)) ;
+    const size_t first = reinterpret_cast<size_t>(addr)/pageSize ;
+    const size_t last = (reinterpret_cast<size_t>(addr)+len-1)/pageSize ;
+    const size_t batch = 1024 ;
+    std::vector<void *> pages(batch) ;
+    std::vector<int> nodes(batch, sysNode) ;
+    std::vector<int> status(batch) ;
+    long onNode = 0 ;
+    for (size_t page = first ; page <= last ; page += batch) {
+        const size_t count = (last-page+1 < batch) ? last-page+1 : batch ;
+        for (size_t k = 0 ; k < count ; k++)
+            pages[k] = reinterpret_cast<void *>((page+k)*pageSize) ;
+        if (movePages(&pages[0], count, &nodes[0], &status[0]) < 0)
+            return (-1) ;
+        for (size_t k = 0 ; k < count ; k++) {
+            if (status[k] == sysNode) onNode++ ;
+        }
+    }
+    return (onNode) ;
+#   else
+    return (-1) ;
+#   endif
+}
+
+/*
+  The kernel answers in its own node numbers; translate back.
+*/
+int numaNodeOf (const void *addr)
+{
+#   if defined(__linux__) && defined(SYS_move_pages)
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE)) ;
+    void *page = reinterpret_cast<void *>(
+                     reinterpret_cast<size_t>(addr)/pageSize*pageSize) ;
+    int status = -1 ;
+    if (movePages(&page, 1, nullptr, &status) < 0 || status < 0) return (-1) ;
+    const NumaTopology &topology = NumaTopology::system() ;
+    for (int n = 0 ; n < topology.getNumNodes() ; n++) {
+        if (topology.getSystemNode(n) == status) return (n) ;
+    }
+#   endif
+    return (-1) ;
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,119 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Numa.hpp
+    \brief NUMA topology, and placing threads and pages on nodes.
+
+  Just enough of the machine's NUMA layout to keep a solve on the node that
+  holds its model: the nodes and their processors (Osi2::NumaTopology),
+  pinning the calling thread to a node, and moving pages to one. On Linux
+  the layout comes from sysfs and placement from the affinity and
+  move_pages(2) system calls, so there's no dependence on libnuma.
+  Elsewhere the machine is one node and placement does nothing.
+*/
+
+#ifndef OSI2NUMA_HPP
+#define OSI2NUMA_HPP
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace Osi2 {
+
+/*! \brief The NUMA nodes of a machine and the processors on each
+
+  Nodes are numbered 0 to #getNumNodes()-1 in the order the system lists
+  them, which need not be the system's own numbering. A processor the
+  topology doesn't know is taken to be on node 0.
+*/
+class NumaTopology {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; one node, with every processor
+    NumaTopology() ;
+    /// Destructor
+    ~NumaTopology() ;
+    //@}
+
+    /*! \brief Read the topology from the sysfs tree at \p root
+
+      \p root is a directory like /sys/devices/system/node, with an
+      \c online list of node numbers and a \c nodeN/cpulist for each. A
+      node with no processors is kept; no thread is pinned to it.
+
+      \returns the number of nodes, or -1 if the tree can't be read (the
+      topology is then one node)
+    */
+    int load(const std::string &root) ;
+
+    /// Number of nodes; at least 1
+    inline int getNumNodes () const {
+        return (static_cast<int>(cpus_.size())) ;
+    }
+
+    /// Processors on node \p node; empty for a node out of range
+    const std::vector<int> &getCpus(int node) const ;
+
+    /// Node of processor \p cpu
+    int getNodeOfCpu(int cpu) const ;
+
+    /// The system's number for node \p node; -1 for a node out of range
+    int getSystemNode(int node) const ;
+
+    /// The topology of this machine, read the first time it's asked for
+    static const NumaTopology &system() ;
+
+private:
+
+    /// Processors on each node
+    std::vector<std::vector<int> > cpus_ ;
+    /// The system's number for each node
+    std::vector<int> sysNodes_ ;
+
+} ;
+
+/*! \name NUMA placement
+
+  Nodes are numbered as in NumaTopology::system(). All are thread-safe.
+*/
+//@{
+
+/*! \brief Pin the calling thread to the processors of node \p node
+
+  \returns false if the node has no processors or the thread can't be
+  pinned; it then runs where it did.
+*/
+bool numaBindThread(int node) ;
+
+/// Node the calling thread is running on; 0 where that can't be told
+int numaCurrentNode() ;
+
+/*! \brief Move the pages under [\p addr, \p addr+\p len) to node \p node
+
+  For memory first touched on the wrong node: the matrix of a model read
+  by one thread and solved by another, say. The pages keep their
+  addresses. A page partly in the range is moved whole.
+
+  \returns the number of pages on \p node afterwards, or -1 if pages can't
+  be moved here
+*/
+long numaMigrate(const void *addr, size_t len, int node) ;
+
+/*! \brief Node holding the page at \p addr
+
+  \returns -1 if the page isn't in memory yet or the node can't be told
+*/
+int numaNodeOf(const void *addr) ;
+
+//@}
+
+}  // end namespace Osi2
+
+#endif
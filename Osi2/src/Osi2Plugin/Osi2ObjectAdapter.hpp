@@ -1,7 +1,11 @@
 #ifndef OSI2OBJECT_ADAPTER_H
 #define OSI2OBJECT_ADAPTER_H
 
+#include <vector>
+#include <utility>
+
 #include "Osi2Plugin.hpp"
+#include "Osi2Threads.hpp"
 
 namespace Osi2 {
 
@@ -34,6 +38,103 @@ struct DummyAdapter : public IObjectAdapter {
     }
 } ;
 
+/*! \brief Adapt C plugin objects to API class \p T through recycled
+	   wrappers of class \p W
+
+  ObjectAdapter allocates a wrapper for every object and the wrapper looks
+  up the plugin's functions for itself. This adapter instead binds the
+  plugin's function table once per library and hands it to each wrapper,
+  and keeps released wrappers for reuse, so that once warmed up, adapting
+  an object allocates nothing.
+
+  \p W derives from \p T and provides
+  <ul>
+    <li> a type \c Table, the plugin's function table;
+    <li> <tt>static const Table *bindTable(void *object)</tt>, called once
+	 per library (per DestroyFunc) with its first object;
+    <li> <tt>void attach(void *object, const Table *table, DestroyFunc df)</tt>,
+	 to take up an object; and
+    <li> <tt>void *detach()</tt>, to give it up again.
+  </ul>
+  An object is given back with #release, which returns the plugin's object
+  for PluginManager::destroyObject. Wrappers still out when the adapter is
+  destroyed are the caller's to delete.
+*/
+template <class W, class T>
+class CObjectAdapter : public IObjectAdapter {
+
+public:
+
+    /// Constructor
+    CObjectAdapter () { }
+
+    /// Destructor; deletes the idle wrappers
+    virtual ~CObjectAdapter ()
+    {
+        for (size_t i = 0 ; i < idle_.size() ; i++) delete idle_[i] ;
+    }
+
+    /// Wrap \p object; the result is a \p T
+    virtual void *adapt (void *object, DestroyFunc df)
+    {
+        if (object == 0) return (0) ;
+        const typename W::Table *table = 0 ;
+        W *wrapper = 0 ;
+        {
+            ScopedLock lock(mutex_) ;
+            for (size_t i = 0 ; i < tables_.size() ; i++) {
+                if (tables_[i].first == df) {
+                    table = tables_[i].second ;
+                    break ;
+                }
+            }
+            if (table == 0) {
+                table = W::bindTable(object) ;
+                if (table == 0) return (0) ;
+                tables_.push_back(TableEntry(df, table)) ;
+            }
+            if (!idle_.empty()) {
+                wrapper = idle_.back() ;
+                idle_.pop_back() ;
+            }
+        }
+        if (wrapper == 0) wrapper = new W() ;
+        wrapper->attach(object, table, df) ;
+        return (static_cast<void *>(static_cast<T *>(wrapper))) ;
+    }
+
+    /*! \brief Give back \p obj, made by #adapt
+
+      \returns the plugin's object, to be passed to
+      PluginManager::destroyObject.
+    */
+    void *release (T *obj)
+    {
+        W *wrapper = static_cast<W *>(obj) ;
+        void *object = wrapper->detach() ;
+        ScopedLock lock(mutex_) ;
+        idle_.push_back(wrapper) ;
+        return (object) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    CObjectAdapter(const CObjectAdapter &rhs) ;
+    /// Assignment (not implemented)
+    CObjectAdapter &operator=(const CObjectAdapter &rhs) ;
+
+    typedef std::pair<DestroyFunc, const typename W::Table *> TableEntry ;
+
+    /// Guards #tables_ and #idle_
+    Mutex mutex_ ;
+    /// The function table bound for each library, by its DestroyFunc
+    std::vector<TableEntry> tables_ ;
+    /// Wrappers released and waiting for reuse
+    std::vector<W *> idle_ ;
+
+} ;
+
 }  // end namespace Osi2
 
 #endif // OSI2OBJECT_ADAPTER_H
@@ -0,0 +1,281 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2PerfStats.cpp
+    \brief Method definitions for Osi2::PerfStats
+*/
+
+#include <cstring>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2PerfStats.hpp"
+
+namespace {
+
+/*
+  A counter is written only by the thread that owns it, and read by any thread
+  taking a snapshot. The owner can read its own counter without ceremony; the
+  store and the reads by other threads must be atomic.
+*/
+template <typename T>
+inline void bump (T *target, T delta)
+{
+#  if defined(__ATOMIC_RELAXED)
+    __atomic_store_n(target, *target + delta, __ATOMIC_RELAXED) ;
+#  else
+    *static_cast<volatile T *>(target) += delta ;
+#  endif
+}
+
+template <typename T>
+inline T peek (const T *target)
+{
+#  if defined(__ATOMIC_RELAXED)
+    return (__atomic_load_n(target, __ATOMIC_RELAXED)) ;
+#  else
+    return (*static_cast<const volatile T *>(target)) ;
+#  endif
+}
+
+/*
+  Histogram bucket for an elapsed time: floor(log2(ns)), clamped to the
+  number of buckets.
+*/
+inline int bucketFor (uint64_t ns)
+{
+    int b = 0 ;
+#  if defined(__GNUC__)
+    if (ns != 0) b = 63 - __builtin_clzll(ns) ;
+#  else
+    while (ns >>= 1) b++ ;
+#  endif
+    if (b >= Osi2::PerfStats::numBuckets) b = Osi2::PerfStats::numBuckets - 1 ;
+    return (b) ;
+}
+
+/*
+  Thread-local cache of the calling thread's block. The serial number
+  identifies the PerfStats object the block belongs to. The address of
+  tlsTag identifies the thread.
+*/
+OSI2_THREAD_LOCAL int tlsSerial = 0 ;
+OSI2_THREAD_LOCAL void *tlsBlock = 0 ;
+OSI2_THREAD_LOCAL char tlsTag = 0 ;
+
+/// Source of PerfStats serial numbers
+volatile int nextSerial = 0 ;
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+/*
+  Slot 0 is reserved for activity that can't be attributed to a library.
+*/
+PerfStats::PerfStats ()
+    : enabled_(true),
+      serial_(atomicAdd(&nextSerial, 1))
+{
+    slotPaths_.push_back("") ;
+}
+
+PerfStats::~PerfStats ()
+{
+    for (std::map<const void *, ThreadBlock *>::iterator iter =
+                threadBlocks_.begin() ;
+            iter != threadBlocks_.end() ; iter++)
+        delete iter->second ;
+}
+
+int PerfStats::slotFor (const std::string &libPath)
+{
+    ScopedLock lock(mutex_) ;
+    std::map<std::string, int>::const_iterator iter = pathToSlot_.find(libPath) ;
+    if (iter != pathToSlot_.end()) return (iter->second) ;
+    if (slotPaths_.size() >= static_cast<size_t>(maxSlots)) return (0) ;
+    int slot = static_cast<int>(slotPaths_.size()) ;
+    slotPaths_.push_back(libPath) ;
+    pathToSlot_[libPath] = slot ;
+    return (slot) ;
+}
+
+/*
+  The common case is a hit in the thread-local cache. Otherwise, this thread
+  may already have a block for this object (it's been using another
+  PerfStats object in the meantime) or it may need a new one.
+*/
+PerfStats::ThreadBlock *PerfStats::myBlock ()
+{
+    if (tlsSerial == serial_) return (static_cast<ThreadBlock *>(tlsBlock)) ;
+
+    ScopedLock lock(mutex_) ;
+    std::map<const void *, ThreadBlock *>::iterator iter =
+        threadBlocks_.find(&tlsTag) ;
+    ThreadBlock *block = nullptr ;
+    if (iter != threadBlocks_.end()) {
+        block = iter->second ;
+    } else {
+        block = new ThreadBlock ;
+        std::memset(block, 0, sizeof(ThreadBlock)) ;
+        threadBlocks_[&tlsTag] = block ;
+    }
+    tlsSerial = serial_ ;
+    tlsBlock = block ;
+    return (block) ;
+}
+
+void PerfStats::record (int slot, Op op, uint64_t ns, bool ok)
+{
+    if (slot < 0 || slot >= maxSlots) slot = 0 ;
+    Counter &counter = myBlock()->ops_[slot][op] ;
+    bump(&counter.calls_, static_cast<uint64_t>(1)) ;
+    if (!ok) bump(&counter.failures_, static_cast<uint64_t>(1)) ;
+    bump(&counter.totalNs_, ns) ;
+    bump(&counter.hist_[bucketFor(ns)], static_cast<uint64_t>(1)) ;
+}
+
+void PerfStats::adjustLive (int slot, int delta)
+{
+    if (slot < 0 || slot >= maxSlots) slot = 0 ;
+    bump(&myBlock()->live_[slot], static_cast<int64_t>(delta)) ;
+}
+
+uint64_t PerfStats::now ()
+{
+#  ifdef WIN32
+    LARGE_INTEGER freq ;
+    LARGE_INTEGER count ;
+    ::QueryPerformanceFrequency(&freq) ;
+    ::QueryPerformanceCounter(&count) ;
+    return (static_cast<uint64_t>(count.QuadPart/freq.QuadPart)*1000000000u +
+            static_cast<uint64_t>(count.QuadPart%freq.QuadPart)*1000000000u/
+                freq.QuadPart) ;
+#  else
+    struct timespec ts ;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return (static_cast<uint64_t>(ts.tv_sec)*1000000000u +
+            static_cast<uint64_t>(ts.tv_nsec)) ;
+#  endif
+}
+
+void PerfStats::getStats (std::vector<LibStats> &stats) const
+{
+    ScopedLock lock(mutex_) ;
+    const size_t numSlots = slotPaths_.size() ;
+    stats.resize(numSlots) ;
+    for (size_t slot = 0 ; slot < numSlots ; slot++) {
+        LibStats &lib = stats[slot] ;
+        lib.libPath_ = slotPaths_[slot] ;
+        lib.shortName_.clear() ;
+        std::memset(lib.ops_, 0, sizeof(lib.ops_)) ;
+        lib.liveObjects_ = 0 ;
+        for (std::map<const void *, ThreadBlock *>::const_iterator iter =
+                    threadBlocks_.begin() ;
+                iter != threadBlocks_.end() ; iter++) {
+            const ThreadBlock *block = iter->second ;
+            for (int op = 0 ; op < NumOps ; op++) {
+                const Counter &src = block->ops_[slot][op] ;
+                Counter &dst = lib.ops_[op] ;
+                dst.calls_ += peek(&src.calls_) ;
+                dst.failures_ += peek(&src.failures_) ;
+                dst.totalNs_ += peek(&src.totalNs_) ;
+                for (int b = 0 ; b < numBuckets ; b++)
+                    dst.hist_[b] += peek(&src.hist_[b]) ;
+            }
+            lib.liveObjects_ += peek(&block->live_[slot]) ;
+        }
+    }
+}
+
+const char *PerfStats::opName (Op op)
+{
+    switch (op) {
+        case LoadLib:        return ("loadLib") ;
+        case InitPlugin:     return ("initPlugin") ;
+        case CreateExact:    return ("createExact") ;
+        case CreateWildcard: return ("createWildcard") ;
+        case DestroyObject:  return ("destroyObject") ;
+        case UnloadLib:      return ("unloadLib") ;
+        default:             return ("unknown") ;
+    }
+}
+
+void PerfStats::writeJSONString (std::ostream &os, const std::string &str)
+{
+    static const char hexDigits[] = "0123456789abcdef" ;
+    os << '"' ;
+    for (std::string::const_iterator iter = str.begin() ;
+            iter != str.end() ; iter++) {
+        const unsigned char c = static_cast<unsigned char>(*iter) ;
+        if (c == '"' || c == '\\') {
+            os << '\\' << *iter ;
+        } else if (c < 0x20) {
+            os << "\\u00" << hexDigits[c >> 4] << hexDigits[c & 0xf] ;
+        } else {
+            os << *iter ;
+        }
+    }
+    os << '"' ;
+}
+
+/*
+  Entries with no activity at all are left out.
+*/
+void PerfStats::writeJSON (std::ostream &os,
+                           const std::vector<LibStats> &stats)
+{
+    os << "{\n  \"plugins\": [" ;
+    bool firstLib = true ;
+    for (size_t i = 0 ; i < stats.size() ; i++) {
+        const LibStats &lib = stats[i] ;
+        bool active = (lib.liveObjects_ != 0) ;
+        for (int op = 0 ; op < NumOps && !active ; op++)
+            active = (lib.ops_[op].calls_ != 0) ;
+        if (!active) continue ;
+
+        os << (firstLib ? "\n" : ",\n") << "    {\n      \"library\": " ;
+        firstLib = false ;
+        writeJSONString(os, lib.libPath_) ;
+        if (!lib.shortName_.empty()) {
+            os << ",\n      \"shortName\": " ;
+            writeJSONString(os, lib.shortName_) ;
+        }
+        os << ",\n      \"liveObjects\": " << lib.liveObjects_
+           << ",\n      \"ops\": {" ;
+        bool firstOp = true ;
+        for (int op = 0 ; op < NumOps ; op++) {
+            const Counter &counter = lib.ops_[op] ;
+            if (counter.calls_ == 0) continue ;
+            os << (firstOp ? "\n" : ",\n") << "        \""
+               << opName(static_cast<Op>(op)) << "\": {"
+               << "\"calls\": " << counter.calls_
+               << ", \"failures\": " << counter.failures_
+               << ", \"totalNs\": " << counter.totalNs_
+               << ", \"histogram\": {" ;
+            firstOp = false ;
+            bool firstBucket = true ;
+            for (int b = 0 ; b < numBuckets ; b++) {
+                if (counter.hist_[b] == 0) continue ;
+                os << (firstBucket ? "" : ", ") << "\""
+                   << (static_cast<uint64_t>(1) << b) << "\": "
+                   << counter.hist_[b] ;
+                firstBucket = false ;
+            }
+            os << "}}" ;
+        }
+        os << "\n      }\n    }" ;
+    }
+    os << (firstLib ? "]\n}\n" : "\n  ]\n}\n") ;
+}
+
+}  // end namespace Osi2
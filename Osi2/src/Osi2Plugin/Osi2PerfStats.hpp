@@ -0,0 +1,307 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2PerfStats.hpp
+    \brief Performance counters for the plugin framework.
+
+  Counts, cumulative time, and latency histograms for the operations of the
+  plugin manager, broken out by plugin library. See Osi2::PerfStats.
+*/
+
+#ifndef OSI2PERFSTATS_HPP
+#define OSI2PERFSTATS_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*! \brief Per-plugin performance counters
+
+  For each plugin library and each instrumented operation (see #Op), a
+  PerfStats object accumulates the number of calls and failures, the total
+  elapsed time, and a histogram of elapsed times. The histogram buckets are
+  powers of two: bucket \c b counts calls that took at least 2<sup>b</sup>
+  and less than 2<sup>b+1</sup> nanoseconds (bucket 0 also holds calls that
+  took less than 1 ns; the last bucket holds everything longer). It also
+  tracks the number of live objects created by each library, as the
+  difference of successful creations and destructions. Objects deleted by
+  the client without going through the plugin manager are not seen.
+
+  Each library is assigned a slot the first time it's seen, by path; the
+  slot survives unloading and reloading of the library, so the counts are
+  cumulative over the life of the PerfStats object. Slot 0 collects
+  activity that can't be attributed to a library (a request for an API that
+  no plugin supplies, for instance) and, should more than #maxSlots - 1
+  libraries turn up, activity for the excess libraries.
+
+  Counters are kept per thread, so that recording never contends for a
+  lock or a cache line with another thread. The first use by a thread
+  allocates its block of counters; after that, recording allocates nothing.
+  A snapshot (#getStats) sums over the blocks of all threads that have ever
+  recorded anything. The blocks are not freed when a thread exits; its
+  counts remain part of the totals.
+*/
+class PerfStats {
+
+public:
+
+    /// Instrumented operations
+    enum Op {
+        /// Load a library (and find its initialisation function)
+        LoadLib = 0,
+        /// Call a library's initialisation function
+        InitPlugin,
+        /// Create an object from an exact match registration
+        CreateExact,
+        /// Create an object from a wildcard registration
+        CreateWildcard,
+        /// Destroy an object
+        DestroyObject,
+        /// Run a library's exit function and close it
+        UnloadLib,
+        /// Number of operations (not an operation)
+        NumOps
+    } ;
+
+    /// Number of histogram buckets
+    static const int numBuckets = 32 ;
+
+    /// Maximum number of distinct slots (libraries, plus slot 0)
+    static const int maxSlots = 32 ;
+
+    /// Counters for one operation
+    struct Counter {
+        /// Number of calls
+        uint64_t calls_ ;
+        /// Number of calls that failed
+        uint64_t failures_ ;
+        /// Total elapsed time, nanoseconds
+        uint64_t totalNs_ ;
+        /// Elapsed time histogram, by power of two nanoseconds
+        uint64_t hist_[numBuckets] ;
+    } ;
+
+    /// Statistics for one library
+    struct LibStats {
+        /// Full path of the library; empty for slot 0
+        std::string libPath_ ;
+        /*! \brief Short name of the library
+
+          Not filled in by PerfStats. Available for use by clients that
+          know the library by another name (see ControlAPI::getPerfStats).
+        */
+        std::string shortName_ ;
+        /// Counters, indexed by #Op
+        Counter ops_[NumOps] ;
+        /// Objects created and not (yet) destroyed
+        int64_t liveObjects_ ;
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor
+    PerfStats() ;
+    /// Destructor
+    ~PerfStats() ;
+    //@}
+
+    /// \name Recording
+    //@{
+    /// Enable or disable recording
+    inline void setEnabled (bool enabled) {
+        enabled_ = enabled ;
+    }
+    /// True if recording is enabled
+    inline bool isEnabled () const {
+        return (enabled_) ;
+    }
+    /*! \brief Return the slot for the library at \p libPath
+
+      Assigns a slot if this is the first time the library has been seen.
+    */
+    int slotFor(const std::string &libPath) ;
+
+    /// Record one call of \p op, which took \p ns nanoseconds
+    void record(int slot, Op op, uint64_t ns, bool ok) ;
+
+    /// Adjust the live object count for \p slot by \p delta
+    void adjustLive(int slot, int delta) ;
+
+    /// Current value of a monotonic clock, in nanoseconds
+    static uint64_t now() ;
+
+    /*! \brief Acquire the internal lock before fork(2)
+
+      No other thread can be assigning a slot or a counter block while it's
+      held. See PluginManager::forkProcess.
+    */
+    inline void lockForFork () const {
+        mutex_.lock() ;
+    }
+    /// Release the internal lock after fork(2), in parent or child
+    inline void unlockAfterFork (bool child) const {
+        if (child) {
+            mutex_.reset() ;
+        } else {
+            mutex_.unlock() ;
+        }
+    }
+    //@}
+
+    /// \name Reporting
+    //@{
+    /*! \brief Collect the current statistics
+
+      One entry per slot in use. The counts of other threads are read
+      without stopping them, so a snapshot taken while operations are in
+      progress may be very slightly inconsistent (a call counted but its time
+      not yet added, for instance).
+    */
+    void getStats(std::vector<LibStats> &stats) const ;
+
+    /// Name of \p op, as used in the JSON output
+    static const char *opName(Op op) ;
+
+    /*! \brief Write \p stats to \p os as JSON
+
+      The output is a single object with a member \c plugins, an array with
+      one object per library. Operations that were never called are omitted,
+      as are empty histogram buckets; histogram buckets are keyed by their
+      lower bound in nanoseconds.
+    */
+    static void writeJSON(std::ostream &os,
+                          const std::vector<LibStats> &stats) ;
+
+    /// Write \p str to \p os as a JSON string, with quotes and escapes
+    static void writeJSONString(std::ostream &os, const std::string &str) ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    PerfStats(const PerfStats &rhs) ;
+    /// Assignment (not implemented)
+    PerfStats &operator=(const PerfStats &rhs) ;
+
+    /// Counters belonging to one thread
+    struct ThreadBlock {
+        /// Counters, indexed by slot and operation
+        Counter ops_[maxSlots][NumOps] ;
+        /// Live object count adjustments, indexed by slot
+        int64_t live_[maxSlots] ;
+    } ;
+
+    /// Return the calling thread's block, allocating it if necessary
+    ThreadBlock *myBlock() ;
+
+    /// True if recording is enabled
+    volatile bool enabled_ ;
+
+    /// Distinguishes this object from others for thread-local lookup
+    int serial_ ;
+
+    /*! \brief Blocks of all threads that have recorded anything
+
+      Keyed by the address of a thread-local variable, which identifies the
+      thread.
+    */
+    std::map<const void *, ThreadBlock *> threadBlocks_ ;
+
+    /// Library paths, indexed by slot
+    std::vector<std::string> slotPaths_ ;
+
+    /// Library path to slot
+    std::map<std::string, int> pathToSlot_ ;
+
+    /// Serialises slot assignment and use of #threadBlocks_
+    mutable Mutex mutex_ ;
+
+} ;
+
+/*! \brief Time a single operation
+
+  Intended for use as a local variable. The time from construction to
+  destruction (or #stop) is recorded against whatever slot and operation are current
+  at destruction. The call counts as a failure unless #succeeded is called.
+  Does nothing if recording was disabled at construction.
+*/
+class PerfTimer {
+
+public:
+
+    /// Constructor; starts the clock
+    PerfTimer (PerfStats &stats, PerfStats::Op op, int slot = 0)
+        : stats_(stats),
+          op_(op),
+          slot_(slot),
+          ok_(false),
+          active_(stats.isEnabled()),
+          start_(active_ ? PerfStats::now() : 0)
+    { }
+
+    /// Destructor; stops the clock and records the operation
+    ~PerfTimer ()
+    {
+        if (active_)
+            stats_.record(slot_, op_, PerfStats::now() - start_, ok_) ;
+    }
+
+    /// Change the operation to be recorded
+    inline void setOp (PerfStats::Op op) {
+        op_ = op ;
+    }
+    /// Change the slot the operation is recorded against
+    inline void setSlot (int slot) {
+        slot_ = slot ;
+    }
+    /// Mark the operation as successful; adjust the slot's live objects
+    inline void succeeded (int slot, int liveDelta = 0) {
+        slot_ = slot ;
+        ok_ = true ;
+        if (active_ && liveDelta != 0) stats_.adjustLive(slot, liveDelta) ;
+    }
+    /// Stop the clock and record the operation now, rather than at destruction
+    inline void stop () {
+        if (active_)
+            stats_.record(slot_, op_, PerfStats::now() - start_, ok_) ;
+        active_ = false ;
+    }
+    /// Don't record anything
+    inline void cancel () {
+        active_ = false ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    PerfTimer(const PerfTimer &rhs) ;
+    /// Assignment (not implemented)
+    PerfTimer &operator=(const PerfTimer &rhs) ;
+
+    /// Where to record
+    PerfStats &stats_ ;
+    /// Operation
+    PerfStats::Op op_ ;
+    /// Slot
+    int slot_ ;
+    /// Success?
+    bool ok_ ;
+    /// Recording?
+    bool active_ ;
+    /// Start time
+    uint64_t start_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
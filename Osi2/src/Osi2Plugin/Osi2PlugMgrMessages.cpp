@@ -21,13 +21,6 @@ typedef struct {
     */
     int extID_ ;
 
-    /*! Message log level
-
-      Message will print if log level is less than or equal to the current
-      log level.
-    */
-    char logLvl_ ;
-
     /// Message text (may contain format codes).
     const char *text_ ;
 } OnePlugMgrMessage ;
@@ -37,6 +30,8 @@ typedef struct {
     * Choose a unique ID. Add it to the enum in Osi2PlugMgrMessages.hpp
     * Choose an external ID number from the appropriate range (information,
       warning, nonfatal or fatal error).
+    * Choose a log level and add the ID to the appropriate case in
+      plugMgrMsgLvl (Osi2PlugMgrMessages.hpp).
     * Define the message in the appropriate place in the list by adding the
       initialisation expression for a OnePlugMgrMessage structure.
 
@@ -44,56 +39,112 @@ typedef struct {
 */
 static OnePlugMgrMessage us_english[] = {
     // Information: 0 -- 2999
-    { PLUGMGR_INIT, 0000, 7, "Plugin Manager initialising." },
-    { PLUGMGR_LIBLDOK, 0001, 4, "Loaded plugin library \"%s\"." },
-    { PLUGMGR_LIBINITOK, 0002, 4, "Initialised plugin library \"%s\"." },
-    { PLUGMGR_LIBEXITOK, 0003, 4, "Shut down plugin library \"%s\"." },
-    { PLUGMGR_LIBCLOSE, 0004, 4, "Unloading plugin library \"%s\"." },
+    { PLUGMGR_INIT, 0000, "Plugin Manager initialising." },
+    { PLUGMGR_LIBLDOK, 0001, "Loaded plugin library \"%s\"." },
+    { PLUGMGR_LIBINITOK, 0002, "Initialised plugin library \"%s\"." },
+    { PLUGMGR_LIBEXITOK, 0003, "Shut down plugin library \"%s\"." },
+    { PLUGMGR_LIBCLOSE, 0004, "Unloading plugin library \"%s\"." },
     {
-        PLUGMGR_APIREGOK, 0010, 5,
+        PLUGMGR_APIREGOK, 0010,
         "Registered API \"%s\" for plugin library \"%s\"."
     },
     {
-        PLUGMGR_APIUNREG, 0011, 5,
+        PLUGMGR_APIUNREG, 0011,
         "Unregistered API \"%s\" for plugin library \"%s\"."
     },
-    { PLUGMGR_APICREATEOK, 0012, 5, "Created object \"%s\" (%s)." },
-    { PLUGMGR_APIDELOK, 0013, 5, "Destroyed object \"%s\"." },
+    { PLUGMGR_APICREATEOK, 0012, "Created object \"%s\" (%s)." },
+    { PLUGMGR_APIDELOK, 0013, "Destroyed object \"%s\"." },
+    {
+        PLUGMGR_LIBLDTIME, 0005,
+        "Plugin library \"%s\": load %g s, initialisation %g s."
+    },
+    {
+        PLUGMGR_LOADALLOK, 0006,
+        "Loaded %d of %d plugin libraries in \"%s\" (%d threads, %g s)."
+    },
+    {
+        PLUGMGR_NOINITFUNC, 0007,
+        "Skipping \"%s\"; it is not a plugin library."
+    },
+    {
+        PLUGMGR_LIBDEFER, 0014,
+        "Deferred loading plugin library \"%s\" (manifest \"%s\")."
+    },
+    {
+        PLUGMGR_LIBDEFERLD, 0015,
+        "Completing deferred load of plugin library \"%s\"."
+    },
+    {
+        PLUGMGR_LIBPOOLOK, 0016,
+        "Loaded %d isolated copies of plugin library \"%s\"."
+    },
+    {
+        PLUGMGR_APIBATCHOK, 0017,
+        "Created %d of %d objects \"%s\" (batch)."
+    },
+    { PLUGMGR_APIBATCHDEL, 0020, "Destroyed %d objects \"%s\" (batch)." },
+    { PLUGMGR_PLUGINLOG, 0021, "%s" },
+    {
+        PLUGMGR_LIBRELOAD, 0022,
+        "Reloaded plugin library \"%s\" from \"%s\"; %d old objects still live."
+    },
+    {
+        PLUGMGR_LIBRETIRED, 0023,
+        "Retired old version of plugin library \"%s\"."
+    },
 
     // Warning: 3000 -- 5999
-    { PLUGMGR_LIBLDDUP, 3000, 3, "Plugin library \"%s\" is already loaded." },
-    { PLUGMGR_LIBNOTFOUND, 3001, 3, "Plugin library \"%s\" is not loaded." },
+    { PLUGMGR_LIBLDDUP, 3000, "Plugin library \"%s\" is already loaded." },
+    { PLUGMGR_LIBNOTFOUND, 3001, "Plugin library \"%s\" is not loaded." },
+    {
+        PLUGMGR_BADMANIFEST, 3002,
+        "Ignoring plugin manifest \"%s\"; %s."
+    },
+    {
+        PLUGMGR_LIBPOOLSHORT, 3003,
+        "Loaded only %d of %d isolated copies of plugin library \"%s\"; %s."
+    },
+    { PLUGMGR_TRACEFAIL, 3004, "Cannot write trace; %s." },
+    {
+        PLUGMGR_MEMLIMIT, 3005,
+        "Plugin library \"%s\" is at its %s memory limit of %d KB; %s."
+    },
+    { PLUGMGR_NOSERVICE, 3006, "A plugin asked for service \"%s\"; there's no such service." },
 
     // Nonfatal Error: 6000 -- 8999
 
     {
-        PLUGMGR_LIBLDFAIL, 6000, 1,
+        PLUGMGR_LIBLDFAIL, 6000,
         "Load failed for plugin library \"%s\"; error \"%s\"."
     },
     {
-        PLUGMGR_LIBINITFAIL, 6001, 1,
+        PLUGMGR_LIBINITFAIL, 6001,
         "Initialisation failed for plugin library \"%s\"."
     },
     {
-        PLUGMGR_LIBEXITFAIL, 6002, 1,
+        PLUGMGR_LIBEXITFAIL, 6002,
         "Shutdown failed for plugin library \"%s\"."
     },
     {
-        PLUGMGR_SYMLDFAIL, 6020, 1,
+        PLUGMGR_DIRREADFAIL, 6003,
+        "Cannot read plugin directory \"%s\"; error \"%s\"."
+    },
+    {
+        PLUGMGR_SYMLDFAIL, 6020,
         "Failed to find %s \"%s\" in plugin library \"%s\", error \"%s\"."
     },
-    { PLUGMGR_APICREATEFAIL, 6030, 1, "Failed to create API \"%s\"; %s." },
-    { PLUGMGR_APIDELFAIL, 6031, 1, "Failed to destroy API \"%s\"; %s." },
+    { PLUGMGR_APICREATEFAIL, 6030, "Failed to create API \"%s\"; %s." },
+    { PLUGMGR_APIDELFAIL, 6031, "Failed to destroy API \"%s\"; %s." },
 
-    { PLUGMGR_APIREGDUP, 6051, 1, "API \"%s\" is already registered." },
+    { PLUGMGR_APIREGDUP, 6051, "API \"%s\" is already registered." },
     {
-        PLUGMGR_BADVER, 6052, 1,
+        PLUGMGR_BADVER, 6052,
         "Plugin version %d does not match Manager version %d."
     },
-    { PLUGMGR_APIBADPARM, 6053, 1, "Invalid API registration parameters: %s." },
+    { PLUGMGR_APIBADPARM, 6053, "Invalid API registration parameters: %s." },
 
     // Fatal Error: 9000 -- 9999
-    { PLUGMGR_DUMMY_END, 9999, 0, "" }
+    { PLUGMGR_DUMMY_END, 9999, "" }
 } ;
 
 /*
@@ -115,7 +166,7 @@ PlugMgrMessages::PlugMgrMessages (Language language)
 
     OnePlugMgrMessage *msg = &us_english[0] ;
     while (msg->intID_ != PLUGMGR_DUMMY_END) {
-        CoinOneMessage tmpMsg(msg->extID_, msg->logLvl_, msg->text_) ;
+        CoinOneMessage tmpMsg(msg->extID_, plugMgrMsgLvl(msg->intID_), msg->text_) ;
         addMessage(msg->intID_, tmpMsg) ;
         msg++ ;
     }
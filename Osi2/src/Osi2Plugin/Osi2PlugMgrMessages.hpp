@@ -29,11 +29,27 @@ enum PlugMgrMsg {
     PLUGMGR_APIUNREG,
     PLUGMGR_APICREATEOK,
     PLUGMGR_APIDELOK,
+    PLUGMGR_LIBLDTIME,
+    PLUGMGR_LOADALLOK,
+    PLUGMGR_LIBDEFER,
+    PLUGMGR_LIBDEFERLD,
+    PLUGMGR_LIBPOOLOK,
+    PLUGMGR_APIBATCHOK,
+    PLUGMGR_APIBATCHDEL,
+    PLUGMGR_PLUGINLOG,
+    PLUGMGR_LIBRELOAD,
+    PLUGMGR_LIBRETIRED,
     PLUGMGR_LIBLDDUP,
     PLUGMGR_LIBNOTFOUND,
+    PLUGMGR_BADMANIFEST,
+    PLUGMGR_LIBPOOLSHORT,
+    PLUGMGR_TRACEFAIL,
+    PLUGMGR_MEMLIMIT,
+    PLUGMGR_NOSERVICE,
     PLUGMGR_LIBLDFAIL,
     PLUGMGR_LIBINITFAIL,
     PLUGMGR_LIBEXITFAIL,
+    PLUGMGR_DIRREADFAIL,
     PLUGMGR_SYMLDFAIL,
     PLUGMGR_APICREATEFAIL,
     PLUGMGR_APIDELFAIL,
@@ -44,6 +60,62 @@ enum PlugMgrMsg {
     PLUGMGR_DUMMY_END
 };
 
+/*! \brief Log level of a plugin manager message
+
+  A message prints if its log level is less than or equal to the current log
+  level. Kept here, rather than in the message table, so that the level is
+  visible at compile time; see Osi2MsgGate.hpp.
+*/
+inline int plugMgrMsgLvl (PlugMgrMsg msg)
+{
+    switch (msg) {
+    case PLUGMGR_INIT:
+        return (7) ;
+    case PLUGMGR_APIREGOK:
+    case PLUGMGR_APIUNREG:
+    case PLUGMGR_APICREATEOK:
+    case PLUGMGR_APIDELOK:
+    case PLUGMGR_APIBATCHOK:
+    case PLUGMGR_APIBATCHDEL:
+        return (5) ;
+    case PLUGMGR_LIBLDOK:
+    case PLUGMGR_LIBINITOK:
+    case PLUGMGR_LIBEXITOK:
+    case PLUGMGR_LIBCLOSE:
+    case PLUGMGR_LIBLDTIME:
+    case PLUGMGR_NOINITFUNC:
+    case PLUGMGR_LIBDEFER:
+    case PLUGMGR_LIBDEFERLD:
+    case PLUGMGR_LIBPOOLOK:
+    case PLUGMGR_LIBRELOAD:
+    case PLUGMGR_LIBRETIRED:
+        return (4) ;
+    case PLUGMGR_LOADALLOK:
+    case PLUGMGR_LIBLDDUP:
+    case PLUGMGR_LIBNOTFOUND:
+    case PLUGMGR_BADMANIFEST:
+    case PLUGMGR_LIBPOOLSHORT:
+    case PLUGMGR_TRACEFAIL:
+    case PLUGMGR_MEMLIMIT:
+    case PLUGMGR_NOSERVICE:
+        return (3) ;
+    case PLUGMGR_LIBLDFAIL:
+    case PLUGMGR_LIBINITFAIL:
+    case PLUGMGR_LIBEXITFAIL:
+    case PLUGMGR_DIRREADFAIL:
+    case PLUGMGR_SYMLDFAIL:
+    case PLUGMGR_APICREATEFAIL:
+    case PLUGMGR_APIDELFAIL:
+    case PLUGMGR_APIREGDUP:
+    case PLUGMGR_BADVER:
+    case PLUGMGR_APIBADPARM:
+        return (1) ;
+    case PLUGMGR_PLUGINLOG:
+    default:
+        return (0) ;
+    }
+}
+
 /*! \brief Osi2 plugin manager messages
 
   This class holds the array of messages once they are loaded and provides the
@@ -15,6 +15,7 @@
 #ifndef OSI2_PLUGIN_HPP
 #define OSI2_PLUGIN_HPP
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -131,6 +132,44 @@ extern "C" {
     */
     typedef int32_t (*DestroyFunc)(void *victim, const ObjectParams *parms) ;
 
+    /*! \brief Capability check for a plugin object
+
+      This function is implemented by the plugin and invoked by the
+      PluginManager to ask whether the plugin can supply an object supporting
+      the API specified in \p parms, without actually creating one. It's
+      used for wildcard registrations, where the manager would otherwise have
+      to call the \link Osi2::CreateFunc create function \endlink (and
+      throw away the object) to find out. A \c CapabilityFunc is optional;
+      specify null if the plugin has none.
+
+      \param parms \link ObjectParams object parameters \endlink for use
+      	   by the plugin.
+      \returns Nonzero if the plugin can supply the API, 0 otherwise.
+    */
+    typedef int32_t (*CapabilityFunc)(const ObjectParams *parms) ;
+
+    /*! \brief Bulk constructor for plugin objects
+
+      This function is implemented by the plugin and invoked by the
+      PluginManager when a client asks for several objects of an API at once
+      (PluginManager::createObjects). It should create up to \p count objects
+      and store them in \p objects[0] through \p objects[count-1]; setup
+      common to all of them need be done only once. A \c BulkCreateFunc is
+      optional; specify null and the manager will call the
+      \link Osi2::CreateFunc create function \endlink once for each object.
+      Objects made in bulk are destroyed one at a time by the
+      \link Osi2::DestroyFunc destroy function \endlink.
+
+      \param parms \link ObjectParams object parameters \endlink for use
+      	   by the plugin.
+      \param count the number of objects wanted.
+      \param objects an array of \p count entries to receive the objects.
+      \returns The number of objects created, which are the first entries
+      	   of \p objects.
+    */
+    typedef int32_t (*BulkCreateFunc)(const ObjectParams *parms, int32_t count,
+                                      void **objects) ;
+
     /*! \brief API registration function
 
       This function is implemented by the PluginManager and passed to the plugin
@@ -156,17 +195,98 @@ extern "C" {
       a PlatformServices parameter object. The plugin can invoke this function to
       access services provided by the PluginManager.
 
+      Services are registered with the plugin manager by name (see
+      PluginManager::registerService). A service used often hands back, in
+      \p serviceParams, the functions to call from then on, so that the
+      name is looked up once; the \link Osi2::ThreadPoolService thread
+      pool \endlink is one such.
+
       \param serviceName A null-terminated character string identifying the
     		     service.
       \param serviceParams arbitrary parameter block appropriate to service
 
-      \returns 0 if the service is successfully invoked, nonzero otherwise
-
-      \todo Implement this! Currently unimplemented.
+      \returns 0 if the service is successfully invoked, -1 if there's no
+    	   such service, otherwise whatever the service returns
     */
     typedef int32_t (*InvokeServiceFunc)(const CharString *serviceName,
                                          void *serviceParams) ;
 
+    /*! \brief Function to allow the plugin to log a message through the
+    	   plugin manager.
+
+      This method is implemented by the PluginManager and passed to the plugin
+      in a PlatformServices parameter object. The message is copied and
+      delivered later, from another thread, to the plugin manager's message
+      handler. The plugin should compare \p level with
+      \link Osi2::PlatformServices#logLevel_ logLevel_ \endlink before
+      composing a message; see Osi2PluginLog.hpp.
+
+      \param level the log level of the message.
+      \param msg a null-terminated character string, the text of the message.
+
+      \returns 0 if the message is queued, nonzero if it was dropped.
+    */
+    typedef int32_t (*LogFunc)(int32_t level, const CharString *msg) ;
+
+    /*! \brief Function to allow the plugin to account for the memory it
+    	   holds.
+
+      This method is implemented by the PluginManager and passed to the plugin
+      in a PlatformServices parameter object. The plugin calls it with a
+      positive \p bytes before it allocates memory and with a negative
+      \p bytes after it frees memory; see Osi2PluginMem.hpp. The plugin
+      manager keeps the total for each plugin library and each object, and
+      enforces the limits set for the library (see MemAccount).
+
+      \param pluginID the library's \link Osi2::PluginUniqueID unique ID
+    	   \endlink.
+      \param owner the object the memory belongs to, as returned by the
+    	   \link Osi2::CreateFunc create function \endlink, or null for
+    	   memory held by the library itself.
+      \param bytes the number of bytes allocated (positive) or freed
+    	   (negative).
+
+      \returns 0 if the charge is accepted, 1 if it's accepted but the
+    	   library is over its soft limit, -1 if it's refused because it
+    	   would take the library over its hard limit. A refused charge
+    	   isn't recorded; the plugin should not allocate the memory.
+    */
+    typedef int32_t (*MemChargeFunc)(PluginUniqueID pluginID,
+                                     const void *owner, int64_t bytes) ;
+
+    /*! \brief Function to allow the plugin to allocate from an arena
+
+      This method is implemented by the PluginManager and passed to the plugin
+      in a PlatformServices parameter object. Each owner has an arena; the
+      blocks in it are never freed one at a time, but all at once, when the
+      owner's arena is released (see \link Osi2::ArenaReleaseFunc
+      ArenaReleaseFunc \endlink). The plugin manager releases an object's
+      arena when it destroys the object, after the destroy function has
+      run. The memory is charged to the owner as by
+      \link Osi2::MemChargeFunc MemChargeFunc \endlink. See
+      Osi2PluginMem.hpp.
+
+      \param pluginID the library's \link Osi2::PluginUniqueID unique ID
+    	   \endlink.
+      \param owner an object, as returned by the \link Osi2::CreateFunc
+    	   create function \endlink, or any other key the plugin chooses
+    	   for memory it will release itself.
+      \param bytes the size of the block.
+
+      \returns the block, aligned for any type, or null if it would take the
+    	   library over its hard memory limit or there's no memory.
+    */
+    typedef void *(*ArenaAllocFunc)(PluginUniqueID pluginID,
+                                    const void *owner, size_t bytes) ;
+
+    /*! \brief Function to allow the plugin to release an arena
+
+      Frees everything allocated for \p owner by \link Osi2::ArenaAllocFunc
+      ArenaAllocFunc \endlink. Returns 0, or -1 if \p pluginID is null.
+    */
+    typedef int32_t (*ArenaReleaseFunc)(PluginUniqueID pluginID,
+                                        const void *owner) ;
+
     /*! \brief Type definition of the \c exitPlugin function
 
       This function is called by the PluginManager to tell the plugin to clean
@@ -205,6 +325,45 @@ extern "C" {
 //@}
 
 
+    /*! \brief What a plugin can do, declared when it registers
+
+      Lets the plugin manager choose among the libraries that provide an
+      API without creating objects to find out (see
+      PluginManager::selectLib). All zero means the plugin says nothing
+      about itself; a plugin that fills in the descriptor should set at
+      least one bit of #problems_.
+    */
+    struct PluginCaps {
+        /// Problem classes the plugin's objects can solve (PluginProblemClass)
+        uint32_t problems_ ;
+        /// Properties of the plugin's objects (PluginProperty)
+        uint32_t props_ ;
+        /*! \brief Relative cost of creating an object
+
+          On the scale of #solveCost_; 0 if the plugin doesn't say.
+        */
+        int32_t createCost_ ;
+        /*! \brief Relative cost of a solve
+
+          100 is a typical in-process solver, larger is slower. 0 if the
+          plugin doesn't say, which the plugin manager takes as 100.
+        */
+        int32_t solveCost_ ;
+    } ;
+
+/// Problem classes, for PluginCaps::problems_
+    enum PluginProblemClass
+    { PluginProb_LP = 0x1, PluginProb_MIP = 0x2, PluginProb_QP = 0x4 } ;
+
+/*! \brief Object properties, for PluginCaps::props_
+
+  \c PluginProp_ThreadSafe: distinct objects may be used from different
+  threads at once. \c PluginProp_LoadInMemory: a problem can be loaded
+  from memory as well as read from a file.
+*/
+    enum PluginProperty
+    { PluginProp_ThreadSafe = 0x1, PluginProp_LoadInMemory = 0x2 } ;
+
     /*! \brief Parameters required to register an API with the plugin manager
 
       The plugin supplies this structure when it registers with the plugin
@@ -245,6 +404,36 @@ extern "C" {
         CreateFunc createFunc_ ;
         /// Destructor for API being registered
         DestroyFunc destroyFunc_ ;
+        /*! \brief Capability check for API being registered
+
+          Optional; consulted only for wildcard registrations. Null if the
+          plugin supplies none.
+        */
+        CapabilityFunc capabilityFunc_ ;
+        /*! \brief Bulk constructor for API being registered
+
+          Optional; null if the plugin supplies none. Ignored for wildcard
+          registrations.
+        */
+        BulkCreateFunc bulkCreateFunc_ ;
+        /*! \brief What the objects of this API can do
+
+          Optional; all zero if the plugin doesn't say.
+        */
+        PluginCaps caps_ ;
+
+        /*! \name Plugin manager information
+
+          Filled in by the plugin manager when the registration is accepted.
+          The plugin need not set these.
+        */
+        /*! \brief Plugin library control object
+
+          The \link Osi2::PlatformServices#ctrlObj_ library state object
+          \endlink of the registering library, cached here so that object
+          creation needn't look it up.
+        */
+        PluginState *libCtrlObj_ ;
     } ;
 
     /*! \brief Parameters passed to a plugin for object creation and destruction.
@@ -295,9 +484,101 @@ extern "C" {
         RegisterFunc registerObject_ ;
         /*! \brief Method to allow the plugin to invoke a service provided by the
         	     plugin manager.
+
+          Null before version 1.5.
         */
         InvokeServiceFunc invokeService_;
+        /*! \brief Method to log a message through the plugin manager
+
+          Available from version 1.2.
+        */
+        LogFunc log_ ;
+        /*! \brief The plugin manager's current log level
+
+          Messages with a higher level will not be printed. Available from
+          version 1.2.
+        */
+        const volatile int32_t *logLevel_ ;
+        /*! \brief Method to account for memory held by the plugin
+
+          Available from version 1.3.
+        */
+        MemChargeFunc chargeMem_ ;
+        /*! \brief Method to allocate from an arena
+
+          Available from version 1.4.
+        */
+        ArenaAllocFunc arenaAlloc_ ;
+        /*! \brief Method to release an arena
+
+          Available from version 1.4.
+        */
+        ArenaReleaseFunc arenaRelease_ ;
+    } ;
+
+    /*! \defgroup PluginServices Plugin Manager Services
+
+      Types for the services a plugin reaches through
+      \link Osi2::PlatformServices#invokeService_ invokeService_ \endlink.
+    */
+//@{
+    /// Name of the thread pool service
+#define OSI2_THREADPOOL_SERVICE "ThreadPool"
+
+    /// A task for the thread pool
+    typedef void (*TaskFunc)(void *arg) ;
+
+    /*! \brief A set of tasks to wait for
+
+      Initialise #pending_ to zero, submit tasks naming the group, and wait
+      for it. Each submission adds one to #pending_ and each task finished
+      takes one away.
+    */
+    struct TaskGroup {
+        /// Tasks submitted and not yet finished
+        volatile int32_t pending_ ;
+    } ;
+
+    /*! \brief Submit \p func(\p arg) to the thread pool
+
+      \p group may be null if nobody will wait for the task. Returns 0; a
+      task that can't be queued is run before the function returns.
+    */
+    typedef int32_t (*TaskSubmitFunc)(TaskFunc func, void *arg,
+                                      TaskGroup *group) ;
+
+    /*! \brief Wait for the tasks in \p group to finish
+
+      The calling thread runs queued tasks while it waits, so waiting from
+      within a task can't deadlock the pool. Returns 0.
+    */
+    typedef int32_t (*TaskWaitFunc)(TaskGroup *group) ;
+
+    /*! \brief Run \p func(\p args[i]) for i in 0 .. \p count-1 and wait
+
+      The calling thread runs its share. Returns 0.
+    */
+    typedef int32_t (*TaskRunFunc)(TaskFunc func, void **args,
+                                   int32_t count) ;
+
+    /*! \brief Parameter block for the thread pool service
+
+      Invoking OSI2_THREADPOOL_SERVICE fills it in. The pool is shared by
+      everything in the process that uses the plugin manager, so that
+      solvers share one budget of cores instead of each starting threads of
+      its own.
+    */
+    struct ThreadPoolService {
+        /// Worker threads in the pool; the calling thread makes one more
+        int32_t numThreads_ ;
+        /// Submit a task
+        TaskSubmitFunc submit_ ;
+        /// Wait for a group of tasks
+        TaskWaitFunc wait_ ;
+        /// Run a batch of tasks and wait for them
+        TaskRunFunc run_ ;
     } ;
+//@}
 
 
     }  // end namespace Osi2
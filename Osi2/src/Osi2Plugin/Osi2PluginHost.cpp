@@ -0,0 +1,531 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2PluginHost.cpp
+    \brief Method definitions for Osi2::PluginHost and its proxies
+*/
+
+#include <cstring>
+#include <cerrno>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2PluginHost.hpp"
+#include "Osi2ShmChannel.hpp"
+#include "Osi2PluginManager.hpp"
+#include "Osi2ObjectAdapter.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
+
+namespace {
+
+/*
+  Requests understood by a worker. Every request but Shutdown gets a reply,
+  which starts with a status.
+*/
+enum HostOp {
+    /// (apiName) -> (status, handle)
+    OpCreate = 1,
+    /// (handle) -> (status)
+    OpDestroy,
+    /// (handle, filename, keepNames, ignoreErrors) -> (status)
+    OpReadMps,
+    /// (handle) -> (status)
+    OpInitialSolve,
+    /// () -> no reply
+    OpShutdown
+} ;
+
+/*
+  Messages are a sequence of fields, each an integer (8 bytes, native byte
+  order --- both ends are the same machine) or a string (a length, then the
+  bytes).
+*/
+class MsgWriter {
+public:
+    explicit MsgWriter (std::vector<char> &buf) : buf_(buf)
+    {
+        buf_.clear() ;
+    }
+    MsgWriter &putInt (int64_t value)
+    {
+        const char *bytes = reinterpret_cast<const char *>(&value) ;
+        buf_.insert(buf_.end(), bytes, bytes+sizeof(value)) ;
+        return (*this) ;
+    }
+    MsgWriter &putStr (const std::string &str)
+    {
+        putInt(static_cast<int64_t>(str.size())) ;
+        buf_.insert(buf_.end(), str.begin(), str.end()) ;
+        return (*this) ;
+    }
+private:
+    std::vector<char> &buf_ ;
+} ;
+
+class MsgReader {
+public:
+    explicit MsgReader (const std::vector<char> &buf)
+        : buf_(buf), pos_(0), ok_(true)
+    { }
+    int64_t getInt ()
+    {
+        int64_t value = 0 ;
+        if (pos_+sizeof(value) > buf_.size()) {
+            ok_ = false ;
+            return (-1) ;
+        }
+        std::memcpy(&value, &buf_[pos_], sizeof(value)) ;
+        pos_ += sizeof(value) ;
+        return (value) ;
+    }
+    std::string getStr ()
+    {
+        const int64_t len = getInt() ;
+        if (!ok_ || len < 0 ||
+                pos_+static_cast<size_t>(len) > buf_.size()) {
+            ok_ = false ;
+            return ("") ;
+        }
+        std::string str(buf_.begin()+pos_, buf_.begin()+pos_+len) ;
+        pos_ += static_cast<size_t>(len) ;
+        return (str) ;
+    }
+    bool ok () const
+    {
+        return (ok_) ;
+    }
+private:
+    const std::vector<char> &buf_ ;
+    size_t pos_ ;
+    bool ok_ ;
+} ;
+
+#ifndef WIN32
+
+/// An object held by a worker on behalf of the client
+struct HostedObject {
+    Osi2::ProbMgmtAPI *obj_ ;
+    std::string apiName_ ;
+    Osi2::PluginUniqueID libID_ ;
+} ;
+
+/*
+  The body of a worker process. Load the library, report the result, then
+  serve requests until told to stop or until the client goes away. Either
+  way, shut down the plugin manager (so the plugin's exit function runs) and
+  exit without running the client's atexit handlers and static destructors,
+  which belong to the client.
+
+  The worker is single-threaded; nothing here needs a lock.
+*/
+void hostMain (Osi2::ShmChannel &channel, const std::string &lib,
+               const std::string *dir)
+{
+    Osi2::PluginManager &plugMgr = Osi2::PluginManager::getInstance() ;
+    Osi2::PluginUniqueID libID = nullptr ;
+    std::vector<char> request ;
+    std::vector<char> reply ;
+    const int loadStatus = plugMgr.loadOneLib(lib, dir, &libID) ;
+    MsgWriter(reply).putInt(loadStatus) ;
+    if (channel.send(reply) < 0 || loadStatus < 0) ::_exit(1) ;
+
+    std::vector<HostedObject> objects ;
+    std::vector<int64_t> freeSlots ;
+    Osi2::DummyAdapter adapter ;
+    bool running = true ;
+    while (running && channel.recv(request) == 0) {
+        MsgReader in(request) ;
+        MsgWriter out(reply) ;
+        const int64_t op = in.getInt() ;
+        if (op == OpShutdown) {
+            running = false ;
+            continue ;
+        }
+        if (op == OpCreate) {
+            HostedObject hosted ;
+            hosted.apiName_ = in.getStr() ;
+            hosted.libID_ = libID ;
+            Osi2::API *obj = static_cast<Osi2::API *>(
+                plugMgr.createObject(hosted.apiName_, hosted.libID_, adapter)) ;
+            hosted.obj_ = dynamic_cast<Osi2::ProbMgmtAPI *>(obj) ;
+            if (obj != nullptr && hosted.obj_ == nullptr)
+                plugMgr.destroyObject(hosted.apiName_, hosted.libID_, obj) ;
+            if (hosted.obj_ == nullptr) {
+                out.putInt(-1) ;
+            } else {
+                int64_t handle = static_cast<int64_t>(objects.size()) ;
+                if (!freeSlots.empty()) {
+                    handle = freeSlots.back() ;
+                    freeSlots.pop_back() ;
+                    objects[handle] = hosted ;
+                } else {
+                    objects.push_back(hosted) ;
+                }
+                out.putInt(0).putInt(handle) ;
+            }
+        } else {
+            const int64_t handle = in.getInt() ;
+            HostedObject *hosted = nullptr ;
+            if (in.ok() && handle >= 0 &&
+                    handle < static_cast<int64_t>(objects.size()) &&
+                    objects[handle].obj_ != nullptr)
+                hosted = &objects[handle] ;
+            int64_t status = -1 ;
+            if (hosted == nullptr) {
+                // Unknown object; status stays -1.
+            } else if (op == OpDestroy) {
+                status = plugMgr.destroyObject(hosted->apiName_,
+                                               hosted->libID_, hosted->obj_) ;
+                hosted->obj_ = nullptr ;
+                freeSlots.push_back(handle) ;
+            } else if (op == OpReadMps) {
+                const std::string filename = in.getStr() ;
+                const bool keepNames = (in.getInt() != 0) ;
+                const bool ignoreErrors = (in.getInt() != 0) ;
+                if (in.ok())
+                    status = hosted->obj_->readMps(filename.c_str(),
+                                                   keepNames, ignoreErrors) ;
+            } else if (op == OpInitialSolve) {
+                status = hosted->obj_->initialSolve() ;
+            }
+            out.putInt(status) ;
+        }
+        if (channel.send(reply) < 0) running = false ;
+    }
+    /*
+      Objects still held are the plugin's to clean up in its exit function.
+    */
+    plugMgr.shutdown() ;
+    ::_exit(0) ;
+}
+
+#endif
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+/*! \brief Proxy for a ProbMgmtAPI object held by a worker
+
+  Each method is a call to the worker. If the worker has gone, methods
+  return -1.
+*/
+class HostedProbMgmt : public ProbMgmtAPI {
+
+public:
+
+    /// Constructor
+    HostedProbMgmt (PluginHost *host, size_t worker, int generation,
+                    int64_t handle)
+        : host_(host),
+          worker_(worker),
+          generation_(generation),
+          handle_(handle),
+          released_(false)
+    { }
+
+    /// Destructor; destroys the object in the worker
+    ~HostedProbMgmt ()
+    {
+        release() ;
+    }
+
+    /// Read an mps file from the given filename
+    int readMps (const char *filename, bool keepNames, bool ignoreErrors)
+    {
+        MsgWriter(request_).putInt(OpReadMps).putInt(handle_)
+            .putStr(filename).putInt(keepNames).putInt(ignoreErrors) ;
+        return (invoke()) ;
+    }
+
+    /// Solve an lp
+    int initialSolve ()
+    {
+        MsgWriter(request_).putInt(OpInitialSolve).putInt(handle_) ;
+        return (invoke()) ;
+    }
+
+    /// Destroy the object in the worker (once only)
+    int release ()
+    {
+        if (released_) return (-1) ;
+        released_ = true ;
+        MsgWriter(request_).putInt(OpDestroy).putInt(handle_) ;
+        return (invoke()) ;
+    }
+
+    /// The host that made this proxy
+    inline const PluginHost *getHost () const {
+        return (host_) ;
+    }
+
+private:
+
+    /// Send the request, return the status from the reply
+    int invoke ()
+    {
+        if (host_->call(worker_, generation_, request_, reply_) < 0)
+            return (-1) ;
+        MsgReader in(reply_) ;
+        const int64_t status = in.getInt() ;
+        return (in.ok() ? static_cast<int>(status) : -1) ;
+    }
+
+    PluginHost *host_ ;
+    const size_t worker_ ;
+    const int generation_ ;
+    const int64_t handle_ ;
+    bool released_ ;
+    /// Buffers, kept to avoid reallocation on every call
+    std::vector<char> request_ ;
+    std::vector<char> reply_ ;
+
+} ;
+
+PluginHost::PluginHost ()
+    : next_(0),
+      haveDir_(false),
+      capacity_(0)
+{ }
+
+PluginHost::~PluginHost ()
+{
+    stop() ;
+}
+
+bool PluginHost::isSupported ()
+{
+    return (ShmChannel::isSupported()) ;
+}
+
+int PluginHost::start (const std::string &lib, const std::string *dir,
+                       int numWorkers, std::string &errStr, size_t capacity)
+{
+    stop() ;
+#   ifdef WIN32
+    errStr = "Plugin hosting is not supported on this platform." ;
+    return (-1) ;
+#   else
+    if (numWorkers <= 0) {
+        const long numCPUs = ::sysconf(_SC_NPROCESSORS_ONLN) ;
+        numWorkers = (numCPUs > 0) ? static_cast<int>(numCPUs) : 1 ;
+    }
+    lib_ = lib ;
+    haveDir_ = (dir != nullptr) ;
+    dir_ = haveDir_ ? *dir : "" ;
+    capacity_ = capacity ;
+    next_ = 0 ;
+    for (int i = 0 ; i < numWorkers ; i++) {
+        Worker *worker = new Worker ;
+        worker->pid_ = 0 ;
+        worker->channel_ = nullptr ;
+        worker->generation_ = 0 ;
+        workers_.push_back(worker) ;
+    }
+    for (size_t ndx = 0 ; ndx < workers_.size() ; ndx++) {
+        ScopedLock lock(workers_[ndx]->mutex_) ;
+        if (spawn(ndx, errStr) < 0) break ;
+    }
+    if (getNumLive() != numWorkers) {
+        stop() ;
+        return (-1) ;
+    }
+    return (0) ;
+#   endif
+}
+
+void PluginHost::stop ()
+{
+    for (size_t ndx = 0 ; ndx < workers_.size() ; ndx++) {
+        {
+            ScopedLock lock(workers_[ndx]->mutex_) ;
+            reap(ndx, true) ;
+        }
+        delete workers_[ndx] ;
+    }
+    workers_.clear() ;
+}
+
+int PluginHost::getNumLive ()
+{
+    int numLive = 0 ;
+    for (size_t ndx = 0 ; ndx < workers_.size() ; ndx++) {
+        Worker &worker = *workers_[ndx] ;
+        ScopedLock lock(worker.mutex_) ;
+        if (worker.channel_ != nullptr && worker.channel_->isConnected())
+            numLive++ ;
+    }
+    return (numLive) ;
+}
+
+/*
+  Try each worker in turn, starting with the next in the rotation, until
+  one gives an answer. A worker that has died is replaced first. A worker
+  that answers `no' speaks for them all: they've all loaded the same
+  library.
+*/
+API *PluginHost::createObject (const std::string &apiName,
+                               std::string &errStr)
+{
+    const unsigned int numWorkers = static_cast<unsigned int>(workers_.size()) ;
+    if (numWorkers == 0) {
+        errStr = "the plugin host is not running" ;
+        return (nullptr) ;
+    }
+    std::vector<char> request ;
+    std::vector<char> reply ;
+    MsgWriter(request).putInt(OpCreate).putStr(apiName) ;
+    errStr = "no worker is available" ;
+    for (unsigned int k = 0 ; k < numWorkers ; k++) {
+        const size_t ndx =
+            static_cast<unsigned int>(atomicAdd(&next_, 1)-1)%numWorkers ;
+        Worker &worker = *workers_[ndx] ;
+        ScopedLock lock(worker.mutex_) ;
+        if (worker.channel_ == nullptr || !worker.channel_->isConnected()) {
+            reap(ndx, false) ;
+            if (spawn(ndx, errStr) < 0) continue ;
+        }
+        if (exchange(worker, request, reply) < 0) continue ;
+        MsgReader in(reply) ;
+        const int64_t status = in.getInt() ;
+        const int64_t handle = in.getInt() ;
+        if (!in.ok() || status < 0) {
+            errStr = "no capable plugin" ;
+            return (nullptr) ;
+        }
+        return (new HostedProbMgmt(this, ndx, worker.generation_, handle)) ;
+    }
+    return (nullptr) ;
+}
+
+int PluginHost::destroyObject (API *obj)
+{
+    HostedProbMgmt *proxy = dynamic_cast<HostedProbMgmt *>(obj) ;
+    if (proxy == nullptr || proxy->getHost() != this) return (-1) ;
+    const int status = proxy->release() ;
+    delete proxy ;
+    return (status) ;
+}
+
+int PluginHost::call (size_t ndx, int generation,
+                      const std::vector<char> &request,
+                      std::vector<char> &reply)
+{
+    if (ndx >= workers_.size()) return (-1) ;
+    Worker &worker = *workers_[ndx] ;
+    ScopedLock lock(worker.mutex_) ;
+    if (worker.generation_ != generation) return (-1) ;
+    return (exchange(worker, request, reply)) ;
+}
+
+int PluginHost::exchange (Worker &worker, const std::vector<char> &request,
+                          std::vector<char> &reply)
+{
+    if (worker.channel_ == nullptr || !worker.channel_->isConnected())
+        return (-1) ;
+    if (worker.channel_->send(request) < 0 ||
+            worker.channel_->recv(reply) < 0)
+        return (-1) ;
+    return (0) ;
+}
+
+#ifdef WIN32
+
+int PluginHost::spawn (size_t, std::string &errStr)
+{
+    errStr = "Plugin hosting is not supported on this platform." ;
+    return (-1) ;
+}
+
+void PluginHost::reap (size_t, bool) { }
+
+#else
+
+/*
+  The child closes its copies of the other workers' channels. Otherwise a
+  worker would hold the client's end of a sibling's socket, and the sibling
+  could not see the client go away.
+*/
+int PluginHost::spawn (size_t ndx, std::string &errStr)
+{
+    Worker &worker = *workers_[ndx] ;
+    ShmChannel *channel = ShmChannel::create(capacity_, errStr) ;
+    if (channel == nullptr) return (-1) ;
+    const int pid = PluginManager::getInstance().forkProcess() ;
+    if (pid < 0) {
+        errStr = std::string("Cannot start worker process: ") +
+                 std::strerror(errno) ;
+        delete channel ;
+        return (-1) ;
+    }
+    if (pid == 0) {
+        channel->attach(true) ;
+        for (size_t i = 0 ; i < workers_.size() ; i++)
+            delete workers_[i]->channel_ ;
+        hostMain(*channel, lib_, haveDir_ ? &dir_ : nullptr) ;
+    }
+    channel->attach(false) ;
+    worker.pid_ = pid ;
+    worker.channel_ = channel ;
+    worker.generation_++ ;
+    /*
+      The worker's first message is the result of loading the library.
+    */
+    std::vector<char> reply ;
+    if (channel->recv(reply) < 0) {
+        errStr = "worker process exited while loading " + lib_ ;
+        reap(ndx, false) ;
+        return (-1) ;
+    }
+    MsgReader in(reply) ;
+    const int64_t status = in.getInt() ;
+    if (!in.ok() || status < 0) {
+        errStr = "worker process failed to load " + lib_ ;
+        reap(ndx, false) ;
+        return (-1) ;
+    }
+    return (0) ;
+}
+
+/*
+  Give a polite worker a couple of seconds to run the plugin's exit
+  function and go. After that, or if we're not being polite, kill it.
+*/
+void PluginHost::reap (size_t ndx, bool polite)
+{
+    Worker &worker = *workers_[ndx] ;
+    if (worker.pid_ == 0) return ;
+    const pid_t pid = static_cast<pid_t>(worker.pid_) ;
+    bool exited = false ;
+    if (polite && worker.channel_->isConnected()) {
+        std::vector<char> request ;
+        MsgWriter(request).putInt(OpShutdown) ;
+        if (worker.channel_->send(request) == 0) {
+            for (int tries = 0 ; tries < 200 && !exited ; tries++) {
+                exited = (::waitpid(pid, nullptr, WNOHANG) == pid) ;
+                if (!exited) ::usleep(10000) ;
+            }
+        }
+    }
+    if (!exited) {
+        ::kill(pid, SIGKILL) ;
+        while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR) ;
+    }
+    delete worker.channel_ ;
+    worker.channel_ = nullptr ;
+    worker.pid_ = 0 ;
+}
+
+#endif
+
+}  // end namespace Osi2
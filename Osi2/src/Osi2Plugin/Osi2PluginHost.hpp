@@ -0,0 +1,184 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2PluginHost.hpp
+    \brief Run a plugin library in a pool of worker processes.
+
+  See Osi2::PluginHost.
+*/
+
+#ifndef OSI2PLUGINHOST_HPP
+#define OSI2PLUGINHOST_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+class API ;
+class ShmChannel ;
+class HostedProbMgmt ;
+
+/*! \brief Run a plugin library in a pool of worker processes
+
+  Each worker is a child process, forked from the client (see
+  PluginManager::forkProcess), that loads the plugin library into its own
+  plugin manager and then serves requests. The client sees proxy objects: a
+  request for an object is passed to a worker, which creates the object and
+  keeps it; the client gets a proxy that forwards each method call to that
+  worker. If the solver crashes, it takes down the worker and nothing else.
+  Calls on the proxies of that worker's objects fail from then on; the next
+  request for an object starts a fresh worker in its place.
+
+  Requests and results travel through a shared memory channel (see
+  ShmChannel), so a large message is copied into shared memory and out
+  again, and not otherwise moved.
+
+  Objects are handed out round robin over the workers. Once created, an
+  object stays with its worker. A worker serves one call at a time; calls
+  for objects on different workers proceed in parallel.
+
+  Only ProbMgmtAPI objects can be hosted at present. The host must outlive
+  the objects it hands out. Not available on Windows (see #isSupported).
+*/
+class PluginHost {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor
+    PluginHost() ;
+    /// Destructor; stops the workers
+    ~PluginHost() ;
+    //@}
+
+    /// True if plugin hosting is supported on this platform
+    static bool isSupported() ;
+
+    /// \name Workers
+    //@{
+    /*! \brief Start the workers
+
+      Starts \p numWorkers workers (one per processor if \p numWorkers is 0
+      or less), each of which loads the library \c dir/lib as
+      PluginManager::loadOneLib would. Returns once every worker has
+      reported the result of its load. If the host is already started, it's
+      stopped first.
+
+      \p capacity is the capacity, in bytes, of each direction of each
+      worker's channel; 0 means ShmChannel::dfltCapacity.
+
+      \return 0 if all the workers started and loaded the library;
+      otherwise -1, with the reason in \p errStr. After a failure no
+      workers are left running.
+    */
+    int start(const std::string &lib, const std::string *dir,
+              int numWorkers, std::string &errStr, size_t capacity = 0) ;
+
+    /*! \brief Stop the workers
+
+      Asks each worker to shut down its plugin manager and exit, and waits
+      for it to do so (forcibly, if it takes too long).
+    */
+    void stop() ;
+
+    /// Number of workers requested in #start
+    inline int getNumWorkers () const {
+        return (static_cast<int>(workers_.size())) ;
+    }
+
+    /// Number of workers running now
+    int getNumLive() ;
+    //@}
+
+    /// \name Objects
+    //@{
+    /*! \brief Create an object supporting \p apiName
+
+      Returns a proxy, or null (with the reason in \p errStr) if no worker
+      could supply the object.
+    */
+    API *createObject(const std::string &apiName, std::string &errStr) ;
+
+    /*! \brief Destroy an object created by #createObject
+
+      The object is destroyed in its worker and the proxy is deleted.
+      Deleting the proxy directly has the same effect, without the status.
+
+      \return The worker's destroy status; -1 if \p obj is not a proxy
+      from this host or its worker has gone.
+    */
+    int destroyObject(API *obj) ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    PluginHost(const PluginHost &rhs) ;
+    /// Assignment (not implemented)
+    PluginHost &operator=(const PluginHost &rhs) ;
+
+    friend class HostedProbMgmt ;
+
+    /// One worker process
+    struct Worker {
+        /// Process ID; 0 if there's no process
+        int pid_ ;
+        /// Channel to the worker
+        ShmChannel *channel_ ;
+        /// Incremented each time a new process takes this slot
+        int generation_ ;
+        /// Serialises calls to this worker
+        Mutex mutex_ ;
+    } ;
+
+    /*! \brief Start a process in slot \p ndx
+
+      Must be called with the slot's mutex held.
+    */
+    int spawn(size_t ndx, std::string &errStr) ;
+
+    /*! \brief Dispose of the process in slot \p ndx
+
+      If \p polite, ask it to exit and give it a chance to do so. Must be
+      called with the slot's mutex held.
+    */
+    void reap(size_t ndx, bool polite) ;
+
+    /// Send \p request to a worker and wait for \p reply; mutex held
+    int exchange(Worker &worker, const std::vector<char> &request,
+                 std::vector<char> &reply) ;
+
+    /*! \brief Send \p request to worker \p ndx and wait for \p reply
+
+      Fails (returns -1) unless the worker is still the process of
+      generation \p generation.
+    */
+    int call(size_t ndx, int generation, const std::vector<char> &request,
+             std::vector<char> &reply) ;
+
+    /// The workers
+    std::vector<Worker *> workers_ ;
+    /// Next worker to receive a request for an object
+    volatile int next_ ;
+    /// The library, as given to #start
+    std::string lib_ ;
+    /// The directory, as given to #start
+    std::string dir_ ;
+    /// True if a directory was given to #start
+    bool haveDir_ ;
+    /// Capacity of the channels
+    size_t capacity_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,149 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2PluginLog.hpp
+    \brief Logging from a plugin through the plugin manager.
+
+  A plugin that wants its messages to go where the plugin manager's go keeps
+  a PluginLog, set from the PlatformServices block handed to its
+  initialisation function, and writes
+  <pre>
+    OSI2_PLUGIN_LOG(log, lvl) << arg1 << arg2 ;
+  </pre>
+  The message is composed only if \c lvl is no greater than the plugin
+  manager's log level, and is then posted to the manager's LogSink, which
+  delivers it to the manager's message handler from a background thread.
+  The plugin never waits for output. A plugin loaded by a manager too old to
+  supply the service logs nothing.
+*/
+
+#ifndef OSI2PLUGINLOG_HPP
+#define OSI2PLUGINLOG_HPP
+
+#include <sstream>
+
+#include "Osi2Plugin.hpp"
+#include "Osi2nullptr.hpp"
+
+#ifndef OSI2_MSG_MAXLVL
+# define OSI2_MSG_MAXLVL 7
+#endif
+
+namespace Osi2 {
+
+/*! \brief The plugin's end of the plugin manager's log service
+
+  Cheap to copy; it's two pointers.
+*/
+class PluginLog {
+
+public:
+
+    /// Constructor; logs nothing until #init is called
+    PluginLog ()
+        : log_(nullptr),
+          logLevel_(nullptr)
+    { }
+
+    /*! \brief Take the log service from \p services
+
+      Leaves the log disabled if the plugin manager doesn't supply it
+      (PlatformServices minor version less than 2).
+    */
+    inline void init (const PlatformServices *services)
+    {
+        log_ = nullptr ;
+        logLevel_ = nullptr ;
+        if (services->version_.major_ > 1 ||
+                (services->version_.major_ == 1 &&
+                 services->version_.minor_ >= 2)) {
+            log_ = services->log_ ;
+            logLevel_ = services->logLevel_ ;
+        }
+        if (logLevel_ == nullptr) log_ = nullptr ;
+    }
+
+    /// True if a message of log level \p lvl would be printed
+    inline bool enabled (int lvl) const
+    {
+        return (lvl <= OSI2_MSG_MAXLVL && log_ != nullptr && lvl <= *logLevel_) ;
+    }
+
+    /// Post \p text at log level \p lvl; does not test the level
+    inline void post (int lvl, const char *text) const
+    {
+        if (log_ != nullptr)
+            (*log_)(lvl, reinterpret_cast<const CharString *>(text)) ;
+    }
+
+private:
+
+    /// The plugin manager's log function
+    LogFunc log_ ;
+    /// The plugin manager's log level
+    const volatile int32_t *logLevel_ ;
+
+} ;
+
+/*! \brief One message under construction
+
+  Intended for use as a temporary (see #OSI2_PLUGIN_LOG): the text is
+  collected by the insertion operators and posted at the end of the full
+  expression.
+*/
+class PluginLogLine {
+
+public:
+
+    /// Constructor
+    PluginLogLine (const PluginLog &log, int lvl)
+        : log_(log),
+          lvl_(lvl)
+    { }
+
+    /// Destructor; posts the message
+    ~PluginLogLine ()
+    {
+        log_.post(lvl_, text_.str().c_str()) ;
+    }
+
+    /// Append \p val to the message
+    template <typename T>
+    inline PluginLogLine &operator<< (const T &val)
+    {
+        text_ << val ;
+        return (*this) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    PluginLogLine(const PluginLogLine &rhs) ;
+    /// Assignment (not implemented)
+    PluginLogLine &operator=(const PluginLogLine &rhs) ;
+
+    /// The log
+    const PluginLog &log_ ;
+    /// Log level
+    int lvl_ ;
+    /// The message
+    std::ostringstream text_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+/*! \brief Compose and post a message if log level \p zz_lvl is enabled
+
+  Written as an if-else so that it can be used safely as the body of an
+  unbraced if. The arguments are not evaluated unless the message will
+  print.
+*/
+#define OSI2_PLUGIN_LOG(zz_log, zz_lvl) \
+    if (!(zz_log).enabled(zz_lvl)) ; else \
+        Osi2::PluginLogLine((zz_log), (zz_lvl))
+
+#endif
@@ -9,12 +9,26 @@
     \brief Definition of methods for Osi2::PluginManager.
 */
 
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <cerrno>
 #include <cassert>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
 
 #include "CoinHelperFunctions.hpp"
+#include "CoinTime.hpp"
 
 /*
   #include "Osi2Directory.hpp"
@@ -25,6 +39,8 @@
 #include "Osi2PluginManager.hpp"
 #include "Osi2DynamicLibrary.hpp"
 #include "Osi2ObjectAdapter.hpp"
+#include "Osi2MsgGate.hpp"
+#include "Osi2Trace.hpp"
 
 #ifndef OSI2PLUGINDIR
 # define OSI2DFLTPLUGINDIR "/usr/local/lib"
@@ -32,37 +48,304 @@
 # define OSI2DFLTPLUGINDIR OSI2PLUGINDIR
 #endif
 
-#if defined(OSI2PLATFORM_MAC)
+#if defined(OSI2PLATFORM_MAC) || defined(__APPLE__)
 static std::string dynamicLibraryExtension("dylib") ;
-#elif defined(OSI2PLATFORM_LINUX)
-static std::string dynamicLibraryExtension("so") ;
-#elif defined(OSI2PLATFORM_WINDOWS)
+#elif defined(OSI2PLATFORM_WINDOWS) || defined(WIN32)
 static std::string dynamicLibraryExtension("dll") ;
+#else
+static std::string dynamicLibraryExtension("so") ;
 #endif
 
 using namespace Osi2 ;
 
+/*
+  Issue a plugin manager message, holding msgMutex_ while the message is
+  built. If the message won't print, the mutex isn't taken and the arguments
+  aren't evaluated; messages above OSI2_MSG_MAXLVL are compiled out. Use as
+
+    PLUGMGR_MSG(PLUGMGR_LIBLDOK) << fullPath << CoinMessageEol ;
+*/
+#define PLUGMGR_MSG(zz_id) \
+    OSI2_MSG_IF(msgEnabled(msgHandler_, plugMgrMsgLvl(zz_id))) \
+        LockedMsgHandler(msgMutex_, msgHandler_)->message((zz_id), msgs_)
+
+namespace {
+
+/*
+  Per-thread nesting depth of read-side sections and writer critical
+  sections. A thread that is inside either must not wait for a grace period:
+  it would wait for itself.
+*/
+OSI2_THREAD_LOCAL int readDepth = 0 ;
+OSI2_THREAD_LOCAL int writeDepth = 0 ;
+
+/*
+  Scoped acquisition of the writer lock that also tracks the nesting depth.
+*/
+class WriteGuard {
+public:
+    explicit WriteGuard (Mutex &mutex)
+        : mutex_(mutex)
+    {
+        mutex_.lock() ;
+        writeDepth++ ;
+    }
+    ~WriteGuard ()
+    {
+        writeDepth-- ;
+        mutex_.unlock() ;
+    }
+private:
+    WriteGuard(const WriteGuard &rhs) ;
+    WriteGuard &operator=(const WriteGuard &rhs) ;
+    Mutex &mutex_ ;
+} ;
+
+/*
+  True if the descriptor \p caps covers everything \p need asks for. A
+  descriptor with no problem classes says nothing, and covers only a
+  request for nothing.
+*/
+bool capsCover (const PluginCaps &caps, const PluginCaps &need)
+{
+    if (need.problems_ == 0 && need.props_ == 0) return (true) ;
+    if (caps.problems_ == 0) return (false) ;
+    return ((caps.problems_&need.problems_) == need.problems_ &&
+            (caps.props_&need.props_) == need.props_) ;
+}
+
+/*
+  The cost of using a library, from its hints; an unstated solve cost is a
+  typical one.
+*/
+int64_t capsCost (const PluginCaps &caps)
+{
+    const int64_t solve = (caps.solveCost_ > 0) ? caps.solveCost_ : 100 ;
+    const int64_t create = (caps.createCost_ > 0) ? caps.createCost_ : 0 ;
+    return (solve+create) ;
+}
+
+/*
+  Orders (cost, library) pairs by cost alone, for a stable sort.
+*/
+struct CostLess {
+    bool operator() (const std::pair<int64_t, PluginUniqueID> &a,
+                     const std::pair<int64_t, PluginUniqueID> &b) const
+    {
+        return (a.first < b.first) ;
+    }
+} ;
+
+/*
+  A candidate library for loadAllLibs, and the results of trying to open it.
+*/
+struct LoadCandidate {
+    std::string fullPath_ ;
+    DynamicLibrary *dynLib_ ;
+    InitFunc initFunc_ ;
+    std::string errStr_ ;
+    int status_ ;
+    double loadTime_ ;
+} ;
+
+/*
+  Shared work queue for the threads that open candidates. Each thread claims
+  the next unclaimed candidate until there are none left.
+*/
+struct LoadQueue {
+    std::vector<LoadCandidate> *candidates_ ;
+    volatile int next_ ;
+    int (*open_)(const std::string &, DynamicLibrary *&, InitFunc &,
+                 std::string &, bool) ;
+    PerfStats *perfStats_ ;
+} ;
+
+void *loadWorker (void *arg)
+{
+    LoadQueue *queue = static_cast<LoadQueue *>(arg) ;
+    std::vector<LoadCandidate> &candidates = *queue->candidates_ ;
+    for (;;) {
+        int ndx = atomicAdd(&queue->next_, 1) - 1 ;
+        if (ndx >= static_cast<int>(candidates.size())) break ;
+        LoadCandidate &cand = candidates[ndx] ;
+        uint64_t start = PerfStats::now() ;
+        cand.status_ = queue->open_(cand.fullPath_, cand.dynLib_,
+                                    cand.initFunc_, cand.errStr_, false) ;
+        uint64_t elapsed = PerfStats::now() - start ;
+        cand.loadTime_ = elapsed*1.0e-9 ;
+        PerfStats &perfStats = *queue->perfStats_ ;
+        if (perfStats.isEnabled())
+            perfStats.record(perfStats.slotFor(cand.fullPath_),
+                             PerfStats::LoadLib, elapsed, cand.status_ == 0) ;
+    }
+    return (nullptr) ;
+}
+
+/*
+  Number of threads to use for loading candidates: one per processor, but
+  no more than there are candidates.
+*/
+int loadThreadCount (size_t numCandidates)
+{
+    long numProcs = 1 ;
+#   ifdef WIN32
+    SYSTEM_INFO info ;
+    ::GetSystemInfo(&info) ;
+    numProcs = info.dwNumberOfProcessors ;
+#   elif defined(_SC_NPROCESSORS_ONLN)
+    numProcs = ::sysconf(_SC_NPROCESSORS_ONLN) ;
+#   endif
+    if (numProcs < 1) numProcs = 1 ;
+    if (static_cast<size_t>(numProcs) > numCandidates)
+        numProcs = static_cast<long>(numCandidates) ;
+    return (static_cast<int>(numProcs)) ;
+}
+
+/*
+  Find the initialisation function "initPlugin". symbolToFunc launders the
+  conversion from pointer-to-object to pointer-to-function.
+*/
+InitFunc findInitFunc (DynamicLibrary *dynLib, std::string &errStr)
+{
+    return (symbolToFunc<InitFunc>(dynLib->getSymbol("initPlugin", errStr))) ;
+}
+
+/*
+  A plugin library manifest. See the PluginManager class documentation for
+  the format. apis_ and langs_ are parallel vectors.
+*/
+struct Manifest {
+    PluginAPIVersion version_ ;
+    std::vector<std::string> apis_ ;
+    std::vector<PluginLang> langs_ ;
+} ;
+
+/*
+  Read a manifest. Returns 1 if the file can't be opened (the usual case:
+  there's no manifest), -1 (with an explanation in errStr) if it's
+  malformed, 0 on success.
+*/
+int readManifest (const std::string &path, Manifest &manifest,
+                  std::string &errStr)
+{
+    std::ifstream in(path.c_str()) ;
+    if (!in) return (1) ;
+
+    bool haveVersion = false ;
+    std::string line ;
+    int lineNo = 0 ;
+    while (std::getline(in, line)) {
+        lineNo++ ;
+        std::istringstream words(line) ;
+        std::string keyword ;
+        if (!(words >> keyword) || keyword[0] == '#') continue ;
+        std::ostringstream where ;
+        where << "line " << lineNo << ": " ;
+        if (keyword == "version") {
+            if (!(words >> manifest.version_.major_
+                        >> manifest.version_.minor_)) {
+                errStr = where.str() + "bad version" ;
+                return (-1) ;
+            }
+            haveVersion = true ;
+        } else if (keyword == "api") {
+            std::string api, lang ;
+            if (!(words >> api >> lang)) {
+                errStr = where.str() + "expected API name and language" ;
+                return (-1) ;
+            }
+            if (lang == "C") {
+                manifest.langs_.push_back(Plugin_C) ;
+            } else if (lang == "C++") {
+                manifest.langs_.push_back(Plugin_CPP) ;
+            } else {
+                errStr = where.str() + "unknown language \"" + lang + "\"" ;
+                return (-1) ;
+            }
+            manifest.apis_.push_back(api) ;
+        } else {
+            errStr = where.str() + "unknown keyword \"" + keyword + "\"" ;
+            return (-1) ;
+        }
+    }
+    if (!haveVersion) {
+        errStr = "no version" ;
+        return (-1) ;
+    }
+    if (manifest.apis_.empty()) {
+        errStr = "no APIs" ;
+        return (-1) ;
+    }
+    return (0) ;
+}
+
+/*
+  The performance statistics slot of a library, given its unique ID.
+*/
+inline int perfSlotOf (PluginUniqueID libID)
+{
+    return (static_cast<DynamicLibrary *>(libID)->getPerfSlot()) ;
+}
+
+/*
+  Count objects created (positive delta) or destroyed by a library. True if
+  the library has been replaced and that was its last object.
+*/
+inline bool adjustLibLive (PluginUniqueID libID, int delta)
+{
+    DynamicLibrary *dynLib = static_cast<DynamicLibrary *>(libID) ;
+    return (dynLib->adjustLive(delta) == 0 && dynLib->isRetiring()) ;
+}
+
+}   // end unnamed file-local namespace
+
+const int PluginManager::maxApiID ;
 
 /*
   Plugin manager constructor.
 */
 PluginManager::PluginManager()
-    : initialisingPlugin_(false),
+    : current_(new Registry()),
+      epoch_(0),
+      writeMutex_(true),
+      initialisingPlugin_(false),
+      libInInit_(nullptr),
       dfltHandler_(true),
-      logLvl_(7)
+      logLvl_(7),
+      lazyLoad_(true),
+      dfltSoftMemLimit_(0),
+      dfltHardMemLimit_(0),
+      clientService_(nullptr),
+      logSink_(deliverPluginLog, this)
 {
+    readers_[0] = 0 ;
+    readers_[1] = 0 ;
+    for (int i = 0 ; i < maxApiID ; i++) typedHandles_[i] = -1 ;
     msgHandler_ = new CoinMessageHandler() ;
     msgs_ = PlugMgrMessages() ;
     msgHandler_->setLogLevel(logLvl_) ;
-    msgHandler_->message(PLUGMGR_INIT, msgs_) << CoinMessageEol ;
+    logSink_.setLogLevel(logLvl_) ;
+    PLUGMGR_MSG(PLUGMGR_INIT) << CoinMessageEol ;
     dfltPluginDir_ = std::string(OSI2DFLTPLUGINDIR) ;
     platformServices_.version_.major_ = 1 ;
-    platformServices_.version_.minor_ = 0 ;
+    platformServices_.version_.minor_ = 5 ;
     platformServices_.dfltPluginDir_ =
         reinterpret_cast<const CharString*>(dfltPluginDir_.c_str()) ;
-    // can be populated during loadAll()
-    platformServices_.invokeService_ = nullptr ;
+    platformServices_.invokeService_ = invokeService ;
     platformServices_.registerObject_ = registerObject ;
+    platformServices_.pluginID_ = nullptr ;
+    platformServices_.ctrlObj_ = nullptr ;
+    platformServices_.log_ = logMessage ;
+    platformServices_.logLevel_ = logSink_.getLogLevelPtr() ;
+    platformServices_.chargeMem_ = chargeMemory ;
+    platformServices_.arenaAlloc_ = arenaAlloc ;
+    platformServices_.arenaRelease_ = arenaRelease ;
+    registerService(OSI2_THREADPOOL_SERVICE, threadPoolService, &threadPool_) ;
+    const char *tracePath = std::getenv("OSI2_TRACE") ;
+    if (tracePath != nullptr && tracePath[0] != '\0') {
+        tracePath_ = tracePath ;
+        Trace::setEnabled(true) ;
+    }
 }
 
 /*
@@ -74,6 +357,15 @@ PluginManager::~PluginManager ()
 {
     // Just in case it wasn't called earlier
     shutdown() ;
+    // Write the trace requested by OSI2_TRACE, unloading included
+    if (!tracePath_.empty()) {
+        std::string errStr ;
+        if (Trace::writeFile(tracePath_, errStr) != 0) {
+            PLUGMGR_MSG(PLUGMGR_TRACEFAIL) << errStr << CoinMessageEol ;
+        }
+    }
+    // Deliver what the plugins logged while the handler's still here
+    logSink_.stop() ;
     /*
       If this is our handler, delete it. Otherwise it's the client's
       responsibility.
@@ -82,6 +374,83 @@ PluginManager::~PluginManager ()
         delete msgHandler_ ;
         msgHandler_ = nullptr ;
     }
+    /*
+      There can be no readers at this point; free the snapshots directly.
+    */
+    for (size_t i = 0 ; i < retired_.size() ; i++) delete retired_[i] ;
+    retired_.clear() ;
+    delete current_ ;
+    current_ = nullptr ;
+}
+
+
+/*
+  Read-side sections.
+
+  A reader reads the epoch, counts itself in the reader counter for that
+  epoch's parity, then checks that the epoch hasn't moved. If it has, a
+  writer may have started waiting on the other counter; back out and try
+  again. Once counted, the reader can use whatever snapshot is current for
+  as long as it likes; #synchronize will not return until it finishes.
+*/
+const PluginManager::Registry *PluginManager::beginRead (int &parity) const
+{
+    for (;;) {
+        int epoch = atomicLoad(const_cast<volatile int *>(&epoch_)) ;
+        parity = epoch & 1 ;
+        atomicAdd(&readers_[parity], 1) ;
+        if (atomicLoad(const_cast<volatile int *>(&epoch_)) == epoch) break ;
+        atomicAdd(&readers_[parity], -1) ;
+    }
+    readDepth++ ;
+    return (atomicLoadPtr(const_cast<Registry *volatile *>(&current_))) ;
+}
+
+void PluginManager::endRead (int parity) const
+{
+    readDepth-- ;
+    atomicAdd(&readers_[parity], -1) ;
+}
+
+/*
+  Writers hold writeMutex_, so current_ can be read directly.
+*/
+PluginManager::Registry *PluginManager::copyRegistry () const
+{
+    return (new Registry(*current_)) ;
+}
+
+void PluginManager::publish (Registry *next)
+{
+    next->generation_ = current_->generation_+1 ;
+    Registry *old = atomicExchangePtr(&current_, next) ;
+    retired_.push_back(old) ;
+}
+
+/*
+  Advance the epoch and wait for readers counted under the old parity to
+  drain. Any reader that started before the flip is counted there; any that
+  starts after the flip sees the new epoch (and hence, the new snapshot).
+  Grace periods are serialised so that at most two epochs are ever live.
+*/
+void PluginManager::synchronize ()
+{
+    ScopedLock lock(graceMutex_) ;
+    int oldParity = (atomicAdd(&epoch_, 1) - 1) & 1 ;
+    while (atomicLoad(&readers_[oldParity]) != 0) yieldThread() ;
+}
+
+void PluginManager::reclaim ()
+{
+    if (readDepth > 0 || writeDepth > 0) return ;
+
+    std::vector<Registry *> victims ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        victims.swap(retired_) ;
+    }
+    synchronize() ;
+    for (size_t i = 0 ; i < victims.size() ; i++) delete victims[i] ;
 }
 
 /*
@@ -126,12 +495,8 @@ DynamicLibrary *PluginManager::validateRegParams (const CharString *apiStr,
                 dynLib = libInInit_ ;
             }
         } else {
-            DynamicLibraryMap::const_iterator dlmIter ;
-            for (dlmIter = dynamicLibraryMap_.begin() ;
-                    dlmIter != dynamicLibraryMap_.end() ;
-                    dlmIter++) {
-                if (params->pluginID_ == dlmIter->second.dynLib_) break ;
-            }
+            DynamicLibraryMap::const_iterator dlmIter =
+                dynamicLibraryMap_.find(params->pluginID_) ;
             if (dlmIter == dynamicLibraryMap_.end()) {
                 errStr += "; bad plugin library ID" ;
                 retval = false ;
@@ -152,7 +517,7 @@ DynamicLibrary *PluginManager::validateRegParams (const CharString *apiStr,
         // The major version must match
         PluginAPIVersion ver = platformServices_.version_ ;
         if (ver.major_ != params->version_.major_) {
-            msgHandler_->message(PLUGMGR_BADVER, msgs_)
+            PLUGMGR_MSG(PLUGMGR_BADVER)
                     << params->version_.major_ << ver.major_ << CoinMessageEol ;
             errStr += "; version mismatch" ;
             retval = false ;
@@ -161,7 +526,7 @@ DynamicLibrary *PluginManager::validateRegParams (const CharString *apiStr,
 
     if (!retval) {
         errStr = errStr.substr(2) ;
-        msgHandler_->message(PLUGMGR_APIBADPARM, msgs_) << errStr << CoinMessageEol ;
+        PLUGMGR_MSG(PLUGMGR_APIBADPARM) << errStr << CoinMessageEol ;
     }
 
     return (dynLib) ;
@@ -169,33 +534,64 @@ DynamicLibrary *PluginManager::validateRegParams (const CharString *apiStr,
 
 
 /*
-  Check for an entry that matches key and libID. Returns an iterator for the
-  entry, if it exists, else regMap.end(). A libID of 0 is a wildcard.
+  Interning of API names. Handles are assigned sequentially, starting from 0.
+  The wildcard is not an API and never receives a handle.
+
+  The common case (the name is already known) is a lookup in the current
+  snapshot. Otherwise, take the writer lock, check again (someone may have
+  beaten us to it), and publish a snapshot that includes the new name.
 */
-PluginManager::RegistrationMap::iterator
-PluginManager::apiEntryExists (RegistrationMap &regMap,
-                               const std::string &key,
-                               PluginUniqueID libID)
+APIHandle PluginManager::getAPIHandle (const std::string &apiStr)
 {
-    typedef RegistrationMap::iterator RMCI ;
-    /*
-      See if we find anything. For the case where there's no entry at all
-      for this API, iterPair.first will be regMap.end(). For the case where
-      the libID is a wildCard (0), we're perfectly happy to use the first
-      entry found. In either case, we can simply return iterPair.first.
-    */
-    std::pair<RMCI, RMCI> iterPair = regMap.equal_range(key) ;
-    if (libID == 0 || iterPair.first == regMap.end()) return (iterPair.first) ;
-    /*
-      There's at least one entry matching the API (key). Check to see if any of
-      them are from the same plugin library.
-    */
-    for (RMCI iter = iterPair.first ; iter != iterPair.second ; iter++) {
-        RegisterParams parms = iter->second ;
-        if (parms.pluginID_ == libID) return (iter) ;
+    if (apiStr == "*") return (-1) ;
+
+    APIHandle api = findAPIHandle(apiStr) ;
+    if (api >= 0) return (api) ;
+
+    {
+        WriteGuard guard(writeMutex_) ;
+        APIHandleMap::const_iterator ahIter =
+            current_->apiHandleMap_.find(apiStr) ;
+        if (ahIter != current_->apiHandleMap_.end()) return (ahIter->second) ;
+
+        api = static_cast<APIHandle>(apiNames_.size()) ;
+        apiNames_.push_back(apiStr) ;
+        Registry *next = copyRegistry() ;
+        next->apiHandleMap_[apiStr] = api ;
+        next->apiNames_.push_back(&apiNames_.back()) ;
+        publish(next) ;
     }
+    reclaim() ;
+
+    return (api) ;
+}
+
+APIHandle PluginManager::findAPIHandle (const std::string &apiStr) const
+{
+    APIHandle api = -1 ;
+    int parity ;
+    const Registry *reg = beginRead(parity) ;
+    APIHandleMap::const_iterator ahIter = reg->apiHandleMap_.find(apiStr) ;
+    if (ahIter != reg->apiHandleMap_.end()) api = ahIter->second ;
+    endRead(parity) ;
+    return (api) ;
+}
 
-    return (regMap.end()) ;
+/*
+  The strings themselves never move or disappear, so it's safe to return a
+  reference after leaving the read-side section.
+*/
+const std::string &PluginManager::getAPIName (APIHandle api) const
+{
+    static const std::string noName ;
+
+    const std::string *name = &noName ;
+    int parity ;
+    const Registry *reg = beginRead(parity) ;
+    if (api >= 0 && static_cast<size_t>(api) < reg->apiNames_.size())
+        name = reg->apiNames_[api] ;
+    endRead(parity) ;
+    return (*name) ;
 }
 
 
@@ -209,67 +605,114 @@ PluginManager::apiEntryExists (RegistrationMap &regMap,
 int32_t PluginManager::registerObject (const CharString *apiStr,
                                        const RegisterParams *params)
 {
+    TraceSpan span("plugin", "registerObject",
+                   reinterpret_cast<const char *>(apiStr)) ;
     PluginManager &pm = getInstance() ;
+    WriteGuard guard(pm.writeMutex_) ;
 
     // Validate the parameter block
     DynamicLibrary *dynLib = pm.validateRegParams(apiStr, params) ;
     if (dynLib == nullptr) return (-1) ;
     /*
-      If the registration is a wild card, add it to the wild card vector. If the
-      registration is for a specific API, check before adding to the exact match
-      vector --- duplicates are not allowed.
-
-      If this call comes while we're initialising a plugin, add the APIs to
-      temporary vectors for merge if initialisation is successful.
+      If the registration is a wild card, add it to the wild card vector. If
+      this call comes while we're initialising a plugin, add it to the
+      temporary vector for merge if initialisation is successful.
 
       Note that we cannot just store a pointer to the RegisterParams block;
-      there's no telling how the plugin is handling it and we don't get ownership.
+      there's no telling how the plugin is handling it and we don't get
+      ownership.
 
       \todo
-      Note that the same API can be registered by multiple plugin libraries, so
-      checking for duplicate entries is a bit more work. If we're guarding against
-      a malfunctioning plugin making a duplicate registration, we should also check
-      for duplicate entries when inserting into the wildcard vector.
+      If we're guarding against a malfunctioning plugin making a duplicate
+      registration, we should also check for duplicate entries when inserting
+      into the wildcard vector.
       -- lh, 111013 --
     */
-    const std::string key((const char *) apiStr) ;
-    int retval = 0 ;
+    const std::string key(reinterpret_cast<const char *>(apiStr)) ;
 
     if (key == std::string("*")) {
         if (pm.initialisingPlugin_) {
             pm.tmpWildCardVec_.push_back(*params) ;
         } else {
-            pm.wildCardVec_.push_back(*params) ;
-        }
-    } else {
-        RegistrationMap::const_iterator rmIter ;
-        if (pm.initialisingPlugin_) {
-            rmIter = pm.apiEntryExists(pm.exactMatchMap_, key, dynLib) ;
-            if (rmIter != pm.exactMatchMap_.end()) retval = -1 ;
-        } else {
-            rmIter = pm.apiEntryExists(pm.tmpExactMatchMap_, key, dynLib) ;
-            if (rmIter != pm.tmpExactMatchMap_.end()) retval = -1 ;
+            Registry *next = pm.copyRegistry() ;
+            next->wildCardVec_.push_back(*params) ;
+            next->wildCardVec_.back().libCtrlObj_ =
+                pm.dynamicLibraryMap_[dynLib].ctrlObj_ ;
+            pm.publish(next) ;
         }
-        if (retval) {
-            pm.msgHandler_->message(PLUGMGR_APIREGDUP, pm.msgs_)
-                    << key << CoinMessageEol ;
+        OSI2_MSG_IF(msgEnabled(pm.msgHandler_, plugMgrMsgLvl(PLUGMGR_APIREGOK)))
+            LockedMsgHandler(pm.msgMutex_, pm.msgHandler_)->
+                message(PLUGMGR_APIREGOK, pm.msgs_)
+                    << key << dynLib->getLibPath() << CoinMessageEol ;
+        return (0) ;
+    }
+    /*
+      A specific API. Intern the name and hand off to the handle-based method.
+    */
+    return (pm.registerObject(pm.getAPIHandle(key), params)) ;
+}
+
+/*
+  Register a (validated) exact match API. The same API can be registered by
+  multiple plugin libraries, but a given library can register an API only
+  once.
+
+  If we're initialising a plugin, the registration goes into the temporary
+  table. Check for duplicates in both the temporary and permanent tables;
+  the permanent check guards against a plugin library that shares a unique
+  ID with something already loaded, which really shouldn't happen.
+
+  Must be called with the writer lock held. Outside of initialisation, the
+  new registration is published in a fresh snapshot, with the library's
+  control object filled in; it replaces a deferred placeholder for the same
+  library. During initialisation the control object isn't
+  yet known; initOneLib fills it in.
+
+  Returns 0 for success, -1 for failure.
+*/
+int32_t PluginManager::registerObject (APIHandle api,
+                                       const RegisterParams *params)
+{
+    const std::string &key = getAPIName(api) ;
+    int retval = 0 ;
+
+    const RegisterParams *existing =
+        current_->exactMatchMap_.find(api, params->pluginID_) ;
+    bool dup = (existing != nullptr && existing->createFunc_ != nullptr) ;
+    if (!dup) {
+        if (initialisingPlugin_) {
+            dup = !tmpExactMatchMap_.insert(api, *params) ;
         } else {
-            RegistrationMap::value_type tmp(key, *params) ;
-            if (pm.initialisingPlugin_) {
-                pm.tmpExactMatchMap_.insert(tmp) ;
-            } else {
-                pm.exactMatchMap_.insert(tmp) ;
-            }
+            RegisterParams stamped = *params ;
+            DynamicLibraryMap::const_iterator dlmIter =
+                dynamicLibraryMap_.find(params->pluginID_) ;
+            stamped.libCtrlObj_ = (dlmIter == dynamicLibraryMap_.end()) ?
+                                  nullptr : dlmIter->second.ctrlObj_ ;
+            Registry *next = copyRegistry() ;
+            if (existing != nullptr)
+                next->exactMatchMap_.erase(api, params->pluginID_) ;
+            dup = !next->exactMatchMap_.insert(api, stamped) ;
+            if (dup)
+                delete next ;
+            else
+                publish(next) ;
         }
     }
-    if (!retval)
-        pm.msgHandler_->message(PLUGMGR_APIREGOK, pm.msgs_)
+    if (dup) {
+        PLUGMGR_MSG(PLUGMGR_APIREGDUP) << key << CoinMessageEol ;
+        retval = -1 ;
+    } else {
+        DynamicLibrary *dynLib =
+            static_cast<DynamicLibrary *>(params->pluginID_) ;
+        PLUGMGR_MSG(PLUGMGR_APIREGOK)
                 << key << dynLib->getLibPath() << CoinMessageEol ;
+    }
     return (retval) ;
 }
 
 /*
-  Instantiate a single instance of the manager.
+  Instantiate a single instance of the manager. Construction of a local static
+  is thread-safe with gcc (and any C++11 compiler).
 */
 PluginManager &PluginManager::getInstance()
 {
@@ -278,6 +721,196 @@ PluginManager &PluginManager::getInstance()
     return (instance) ;
 }
 
+/*
+  Queue a message from a plugin. The plugin has already checked the level;
+  don't check it again.
+*/
+int32_t PluginManager::logMessage (int32_t level, const CharString *msg)
+{
+    if (msg == nullptr) return (-1) ;
+    PluginManager &pm = getInstance() ;
+    const bool queued =
+        pm.logSink_.post(level, reinterpret_cast<const char *>(msg)) ;
+    return (queued ? 0 : -1) ;
+}
+
+/*
+  The unique ID is the DynamicLibrary, and a plugin's code is running, so
+  the library is open; there's nothing to look up.
+*/
+int32_t PluginManager::chargeMemory (PluginUniqueID pluginID,
+                                     const void *owner, int64_t bytes)
+{
+    if (pluginID == nullptr) return (-1) ;
+    DynamicLibrary *dynLib = static_cast<DynamicLibrary *>(pluginID) ;
+    MemAccount &account = dynLib->getMemAccount() ;
+    const int retval = account.charge(owner, bytes) ;
+    if (retval < 0) noteMemRefused(dynLib, bytes) ;
+    return (retval) ;
+}
+
+/*
+  As chargeMemory, the library is open. A null return is a refusal only if
+  the account says so; otherwise malloc failed.
+*/
+void *PluginManager::arenaAlloc (PluginUniqueID pluginID, const void *owner,
+                                 size_t bytes)
+{
+    if (pluginID == nullptr) return (nullptr) ;
+    DynamicLibrary *dynLib = static_cast<DynamicLibrary *>(pluginID) ;
+    MemAccount &account = dynLib->getMemAccount() ;
+    void *block = dynLib->getArenaPool().alloc(owner, bytes, account) ;
+    if (block == nullptr) {
+        MemAccount::Usage usage ;
+        account.getUsage(usage) ;
+        if (usage.hardLimit_ > 0)
+            noteMemRefused(dynLib, static_cast<int64_t>(bytes)) ;
+    }
+    return (block) ;
+}
+
+int32_t PluginManager::arenaRelease (PluginUniqueID pluginID,
+                                     const void *owner)
+{
+    if (pluginID == nullptr) return (-1) ;
+    DynamicLibrary *dynLib = static_cast<DynamicLibrary *>(pluginID) ;
+    dynLib->getArenaPool().release(owner, dynLib->getMemAccount()) ;
+    return (0) ;
+}
+
+void PluginManager::noteMemRefused (DynamicLibrary *dynLib, int64_t bytes)
+{
+    PluginManager &pm = getInstance() ;
+    MemAccount::Usage usage ;
+    dynLib->getMemAccount().getUsage(usage) ;
+    std::ostringstream why ;
+    why << "refused " << (bytes+1023)/1024 << " KB" ;
+    OSI2_MSG_IF(msgEnabled(pm.msgHandler_, plugMgrMsgLvl(PLUGMGR_MEMLIMIT)))
+        LockedMsgHandler(pm.msgMutex_, pm.msgHandler_)->
+            message(PLUGMGR_MEMLIMIT, pm.msgs_)
+                << dynLib->getLibPath() << "hard"
+                << static_cast<int>(usage.hardLimit_/1024) << why.str()
+                << CoinMessageEol ;
+}
+
+/*
+  The name is looked up on every call; services used often hand back
+  functions to call instead (see threadPoolService).
+*/
+int32_t PluginManager::invokeService (const CharString *serviceName,
+                                      void *serviceParams)
+{
+    if (serviceName == nullptr) return (-1) ;
+    PluginManager &pm = getInstance() ;
+    const std::string name = reinterpret_cast<const char *>(serviceName) ;
+    Service service ;
+    service.func_ = nullptr ;
+    InvokeServiceFunc client = nullptr ;
+    {
+        ScopedLock lock(pm.serviceMutex_) ;
+        std::map<std::string, Service>::const_iterator iter =
+            pm.services_.find(name) ;
+        if (iter != pm.services_.end()) service = iter->second ;
+        client = pm.clientService_ ;
+    }
+    if (service.func_ != nullptr)
+        return (service.func_(service.ctx_, serviceParams)) ;
+    if (client != nullptr) return (client(serviceName, serviceParams)) ;
+    OSI2_MSG_IF(msgEnabled(pm.msgHandler_, plugMgrMsgLvl(PLUGMGR_NOSERVICE)))
+        LockedMsgHandler(pm.msgMutex_, pm.msgHandler_)->
+            message(PLUGMGR_NOSERVICE, pm.msgs_)
+                << name << CoinMessageEol ;
+    return (-1) ;
+}
+
+int PluginManager::registerService (const std::string &name,
+                                    ServiceFunc func, void *ctx)
+{
+    ScopedLock lock(serviceMutex_) ;
+    if (func == nullptr || services_.count(name) != 0) return (-1) ;
+    Service &service = services_[name] ;
+    service.func_ = func ;
+    service.ctx_ = ctx ;
+    return (0) ;
+}
+
+int PluginManager::unregisterService (const std::string &name)
+{
+    ScopedLock lock(serviceMutex_) ;
+    return ((services_.erase(name) != 0) ? 0 : -1) ;
+}
+
+/*
+  There's only the one pool, so the entry points find it through
+  getInstance and the context isn't needed.
+*/
+int32_t PluginManager::threadPoolService (void *ctx, void *serviceParams)
+{
+    if (serviceParams == nullptr) return (-1) ;
+    ThreadPoolService &svc = *static_cast<ThreadPoolService *>(serviceParams) ;
+    svc.numThreads_ = static_cast<ThreadPool *>(ctx)->getNumThreads() ;
+    svc.submit_ = poolSubmit ;
+    svc.wait_ = poolWait ;
+    svc.run_ = poolRun ;
+    return (0) ;
+}
+
+int32_t PluginManager::poolSubmit (TaskFunc func, void *arg,
+                                   TaskGroup *group)
+{
+    getInstance().threadPool_.submit(func, arg, group) ;
+    return (0) ;
+}
+
+int32_t PluginManager::poolWait (TaskGroup *group)
+{
+    getInstance().threadPool_.wait(group) ;
+    return (0) ;
+}
+
+int32_t PluginManager::poolRun (TaskFunc func, void **args, int32_t count)
+{
+    getInstance().threadPool_.run(func, args, count) ;
+    return (0) ;
+}
+
+bool PluginManager::memAdmits (PluginUniqueID libID, const std::string &apiStr)
+{
+    MemAccount &account =
+        static_cast<DynamicLibrary *>(libID)->getMemAccount() ;
+    if (account.admitsObject()) return (true) ;
+    MemAccount::Usage usage ;
+    account.getUsage(usage) ;
+    const bool soft =
+        (usage.softLimit_ > 0 && usage.current_ > usage.softLimit_) ;
+    const int64_t limit = soft ? usage.softLimit_ : usage.hardLimit_ ;
+    PLUGMGR_MSG(PLUGMGR_MEMLIMIT)
+            << static_cast<DynamicLibrary *>(libID)->getLibPath()
+            << (soft ? "soft" : "hard") << static_cast<int>(limit/1024)
+            << ("no object \"" + apiStr + "\" created") << CoinMessageEol ;
+    return (false) ;
+}
+
+/*
+  The destroy function has run, so nothing in the arena can be in use.
+*/
+void PluginManager::releaseObjMem (PluginUniqueID libID, const void *obj)
+{
+    DynamicLibrary *dynLib = static_cast<DynamicLibrary *>(libID) ;
+    dynLib->getArenaPool().release(obj, dynLib->getMemAccount()) ;
+    dynLib->getMemAccount().forget(obj) ;
+}
+
+/*
+  Called from the log drain, never from two threads at once.
+*/
+void PluginManager::deliverPluginLog (void *ctx, int, const char *text)
+{
+    PluginManager *pm = static_cast<PluginManager *>(ctx) ;
+    LockedMsgHandler(pm->msgMutex_, pm->msgHandler_)->
+        message(PLUGMGR_PLUGINLOG, pm->msgs_) << text << CoinMessageEol ;
+}
+
 
 /*
   Load a plugin given a full path to the plugin.
@@ -314,72 +947,406 @@ int PluginManager::loadOneLib (const std::string &lib, const std::string *dir,
     }
     char dirSep = CoinFindDirSeparator() ;
     fullPath += dirSep + lib ;
+    TraceSpan span("plugin", "loadOneLib", fullPath.c_str()) ;
+    /*
+      Loading a library is a single writer transaction. The lock is recursive,
+      so the plugin can register APIs from its initialisation function.
+    */
+    int retval = 0 ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        retval = loadOneLibLocked(fullPath, uniqueID) ;
+    }
+    reclaim() ;
+
+    return (retval) ;
+}
+
+/*
+  Does the work of loadOneLib; must be called with the writer lock held.
+*/
+int PluginManager::loadOneLibLocked (const std::string &fullPath,
+                                     PluginUniqueID *uniqueID)
+{
     /*
       Is this library already loaded? If so, don't do it again.
     */
-    if (libPathToIDMap_.find(fullPath) != libPathToIDMap_.end()) {
-        msgHandler_->message(PLUGMGR_LIBLDDUP, msgs_)
+    LibPathToIDMap::const_iterator known = libPathToIDMap_.find(fullPath) ;
+    if (known != libPathToIDMap_.end()) {
+        PLUGMGR_MSG(PLUGMGR_LIBLDDUP)
                 << fullPath << CoinMessageEol ;
+        if (uniqueID != 0) (*uniqueID) = known->second ;
         return (1) ;
     }
     /*
-      Attempt to load the library. A null return indicates failure. Report the
-      problem and return an error.
+      If there's a manifest, we may not need to load the library just yet.
+    */
+    if (deferOneLib(fullPath, uniqueID) == 0) return (0) ;
+    /*
+      Attempt to load the library and find the initialisation function.
+      Report any problem and return an error.
     */
     std::string errStr ;
-    DynamicLibrary *dynLib = DynamicLibrary::load(fullPath, errStr) ;
-    if (dynLib == nullptr) {
-        msgHandler_->message(PLUGMGR_LIBLDFAIL, msgs_)
+    DynamicLibrary *dynLib = nullptr ;
+    InitFunc initFunc = nullptr ;
+    int retval = 0 ;
+    {
+        const int slot = perfStats_.slotFor(fullPath) ;
+        PerfTimer timer(perfStats_, PerfStats::LoadLib, slot) ;
+        retval = openOneLib(fullPath, dynLib, initFunc, errStr) ;
+        if (retval == 0) timer.succeeded(slot) ;
+    }
+    if (retval == -1) {
+        PLUGMGR_MSG(PLUGMGR_LIBLDFAIL)
                 << fullPath << errStr << CoinMessageEol ;
         return (-1) ;
-    }
-    /*
-      Find the initialisation function "initPlugin". If this entry point
-      is missing from the library, we're in trouble.
-
-      Suppress the "can't convert pointer-to-object to pointer-to-function"
-      warning. Use the guarantee that any pointer can be converted to size_t
-      and back to launder the function pointer
-    */
-    size_t grossHack =
-        reinterpret_cast<size_t>(dynLib->getSymbol("initPlugin", errStr)) ;
-    InitFunc initFunc = reinterpret_cast<InitFunc>(grossHack) ;
-    if (initFunc == nullptr) {
-        msgHandler_->message(PLUGMGR_SYMLDFAIL, msgs_)
+    } else if (retval == -2) {
+        PLUGMGR_MSG(PLUGMGR_SYMLDFAIL)
                 << "function" << "initPlugin" << fullPath << errStr << CoinMessageEol ;
         return (-2) ;
     }
     /*
-      Invoke the initialisation function, which will (in the typical case)
-      trigger the registration of the various APIs implemented in this
-      plugin library. We should get back the exit function for the library.
-
-      Set initialisingPlugin_ to true so that the APIs will be registered
-      into the temporary wildcard and exact match vectors. If initialisation
-      is successful, we'll transfer them to the permanent vectors.
+      Initialise the library and make its registrations visible.
     */
-    initialisingPlugin_ = true ;
-    libInInit_ = dynLib ;
-    tmpExactMatchMap_.clear() ;
-    tmpWildCardVec_.clear() ;
-    platformServices_.dfltPluginDir_ =
+    LoadBatch batch ;
+    retval = initOneLib(fullPath, dynLib, initFunc, batch) ;
+    if (retval < 0) {
+        delete dynLib ;
+        return (retval) ;
+    }
+    publishBatch(batch) ;
+    if (uniqueID != 0) (*uniqueID) = dynLib ;
+
+    PLUGMGR_MSG(PLUGMGR_LIBLDOK) << fullPath << CoinMessageEol ;
+
+    return (0) ;
+}
+
+/*
+  Load a pool of isolated copies of a library. The copies are loaded one
+  after another into a single batch, so that clients see the whole pool or
+  none of it. Every copy has the same path; libPathToIDMap_ records only the
+  first, which stands for the pool.
+*/
+int PluginManager::loadLibPool (const std::string &lib, const std::string *dir,
+                                int copies, PluginUniqueID *uniqueID)
+{
+    if (uniqueID != 0) (*uniqueID) = 0 ;
+    std::string fullPath ;
+    if (dir == nullptr || (dir->compare("") == 0)) {
+        fullPath += getDfltPluginDir() ;
+    } else {
+        fullPath += *dir ;
+    }
+    char dirSep = CoinFindDirSeparator() ;
+    fullPath += dirSep + lib ;
+
+    if (!DynamicLibrary::isolationSupported()) {
+        PLUGMGR_MSG(PLUGMGR_LIBLDFAIL)
+                << fullPath << "isolated loading is not supported"
+                << CoinMessageEol ;
+        return (-4) ;
+    }
+    if (copies < 1) copies = 1 ;
+
+    int retval = 0 ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        if (libPathToIDMap_.find(fullPath) != libPathToIDMap_.end()) {
+            PLUGMGR_MSG(PLUGMGR_LIBLDDUP)
+                    << fullPath << CoinMessageEol ;
+            return (1) ;
+        }
+        /*
+          Load and initialise the copies. Stop at the first failure; if it's
+          not the first copy, the likely cause is that we've run out of
+          namespaces, and the rest would fail too.
+        */
+        LibPool *pool = new LibPool ;
+        pool->next_ = 0 ;
+        LoadBatch batch ;
+        std::string errStr ;
+        const int slot = perfStats_.slotFor(fullPath) ;
+        for (int i = 0 ; i < copies ; i++) {
+            DynamicLibrary *dynLib = nullptr ;
+            InitFunc initFunc = nullptr ;
+            {
+                PerfTimer timer(perfStats_, PerfStats::LoadLib, slot) ;
+                retval = openOneLib(fullPath, dynLib, initFunc, errStr, true) ;
+                if (retval == 0) timer.succeeded(slot) ;
+            }
+            if (retval == 0) {
+                retval = initOneLib(fullPath, dynLib, initFunc, batch) ;
+                if (retval < 0) {
+                    delete dynLib ;
+                    errStr = "initialisation failed" ;
+                }
+            }
+            if (retval < 0) break ;
+            pool->copies_.push_back(dynLib) ;
+        }
+        const int loaded = static_cast<int>(pool->copies_.size()) ;
+        if (loaded == 0) {
+            delete pool ;
+            if (retval == -1) {
+                PLUGMGR_MSG(PLUGMGR_LIBLDFAIL)
+                        << fullPath << errStr << CoinMessageEol ;
+            } else if (retval == -2) {
+                PLUGMGR_MSG(PLUGMGR_SYMLDFAIL)
+                        << "function" << "initPlugin" << fullPath << errStr
+                        << CoinMessageEol ;
+            }
+            return (retval) ;
+        }
+        libPathToIDMap_[fullPath] = pool->copies_[0] ;
+        libPools_[pool->copies_[0]] = pool ;
+        batch.pool_ = pool ;
+        publishBatch(batch) ;
+        if (uniqueID != 0) (*uniqueID) = pool->copies_[0] ;
+        retval = 0 ;
+
+        if (loaded < copies) {
+            PLUGMGR_MSG(PLUGMGR_LIBPOOLSHORT)
+                    << loaded << copies << fullPath << errStr
+                    << CoinMessageEol ;
+        }
+        PLUGMGR_MSG(PLUGMGR_LIBPOOLOK)
+                << loaded << fullPath << CoinMessageEol ;
+    }
+    reclaim() ;
+
+    return (retval) ;
+}
+
+int PluginManager::getPoolSize (PluginUniqueID libID)
+{
+    int parity ;
+    const Registry *reg = beginRead(parity) ;
+    std::map<PluginUniqueID, const LibPool *>::const_iterator iter =
+        reg->pools_.find(libID) ;
+    int size = -1 ;
+    if (iter != reg->pools_.end())
+        size = static_cast<int>(iter->second->copies_.size()) ;
+    endRead(parity) ;
+    if (size < 0) {
+        WriteGuard guard(writeMutex_) ;
+        size = (dynamicLibraryMap_.count(libID) != 0) ? 1 : 0 ;
+    }
+    return (size) ;
+}
+
+/*
+  Load a library and find the initialisation function "initPlugin". If this
+  entry point is missing from the library, it's not a plugin library.
+*/
+int PluginManager::openOneLib (const std::string &fullPath,
+                               DynamicLibrary *&dynLib, InitFunc &initFunc,
+                               std::string &errStr, bool isolated)
+{
+    initFunc = nullptr ;
+    dynLib = DynamicLibrary::load(fullPath, errStr, isolated) ;
+    if (dynLib == nullptr) return (-1) ;
+
+    initFunc = findInitFunc(dynLib, errStr) ;
+    if (initFunc == nullptr) {
+        delete dynLib ;
+        dynLib = nullptr ;
+        return (-2) ;
+    }
+    return (0) ;
+}
+
+/*
+  Enter a library from its manifest. A placeholder registration has no create
+  or destroy function; that's how the rest of the manager recognises it.
+  Problems with the manifest are reported, but aren't fatal: we fall back to
+  loading the library.
+*/
+int PluginManager::deferOneLib (const std::string &fullPath,
+                                PluginUniqueID *uniqueID)
+{
+    if (!lazyLoad_) return (1) ;
+
+    const std::string manifestPath = fullPath + ".manifest" ;
+    Manifest manifest ;
+    std::string errStr ;
+    int retval = readManifest(manifestPath, manifest, errStr) ;
+    if (retval > 0) return (1) ;
+    if (retval == 0 &&
+            manifest.version_.major_ != platformServices_.version_.major_) {
+        std::ostringstream msg ;
+        msg << "plugin version " << manifest.version_.major_
+            << " does not match manager version "
+            << platformServices_.version_.major_ ;
+        errStr = msg.str() ;
+        retval = -1 ;
+    }
+    if (retval < 0) {
+        PLUGMGR_MSG(PLUGMGR_BADMANIFEST)
+                << manifestPath << errStr << CoinMessageEol ;
+        return (1) ;
+    }
+    /*
+      Creating the library object gives us the unique ID. Enter the library
+      in the bookkeeping and publish the placeholders.
+    */
+    DynamicLibrary *dynLib = DynamicLibrary::defer(fullPath) ;
+    dynLib->setPerfSlot(perfStats_.slotFor(fullPath)) ;
+    dynLib->getMemAccount().setLimits(dfltSoftMemLimit_, dfltHardMemLimit_) ;
+    libPathToIDMap_[fullPath] = dynLib ;
+    DynLibInfo &info = dynamicLibraryMap_[dynLib] ;
+    info.dynLib_ = dynLib ;
+    info.libPath_ = fullPath ;
+    info.ctrlObj_ = nullptr ;
+    info.exitFunc_ = nullptr ;
+    info.deferred_ = true ;
+    info.replaced_ = false ;
+
+    LoadBatch batch ;
+    RegisterParams placeholder ;
+    std::memset(&placeholder, 0, sizeof(placeholder)) ;
+    placeholder.version_ = manifest.version_ ;
+    placeholder.pluginID_ = dynLib ;
+    for (size_t i = 0 ; i < manifest.apis_.size() ; i++) {
+        placeholder.lang_ = manifest.langs_[i] ;
+        if (manifest.apis_[i] == "*") {
+            batch.wildCardVec_.push_back(placeholder) ;
+        } else {
+            batch.exactMatchMap_.insert(getAPIHandle(manifest.apis_[i]),
+                                        placeholder) ;
+        }
+    }
+    batch.libs_.push_back(dynLib) ;
+    publishBatch(batch) ;
+    if (uniqueID != 0) (*uniqueID) = dynLib ;
+
+    PLUGMGR_MSG(PLUGMGR_LIBDEFER)
+            << fullPath << manifestPath << CoinMessageEol ;
+
+    return (0) ;
+}
+
+/*
+  Complete a deferred load. Several threads can arrive here for the same
+  library; the first does the work and the rest find it's already done.
+*/
+int PluginManager::completeLoad (PluginUniqueID libID)
+{
+    int retval = 0 ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        DynamicLibraryMap::iterator dlmIter = dynamicLibraryMap_.find(libID) ;
+        if (dlmIter == dynamicLibraryMap_.end()) return (-1) ;
+        DynLibInfo &info = dlmIter->second ;
+        if (info.replaced_) return (-1) ;
+        if (!info.deferred_) return ((info.exitFunc_ == nullptr) ? -2 : 0) ;
+        info.deferred_ = false ;
+
+        DynamicLibrary *dynLib = info.dynLib_ ;
+        const std::string fullPath = dynLib->getLibPath() ;
+        PLUGMGR_MSG(PLUGMGR_LIBDEFERLD)
+                << fullPath << CoinMessageEol ;
+        std::string errStr ;
+        InitFunc initFunc = nullptr ;
+        PerfTimer timer(perfStats_, PerfStats::LoadLib,
+                        dynLib->getPerfSlot()) ;
+        if (!dynLib->open(errStr)) {
+            PLUGMGR_MSG(PLUGMGR_LIBLDFAIL)
+                    << fullPath << errStr << CoinMessageEol ;
+            retval = -2 ;
+        } else {
+            initFunc = findInitFunc(dynLib, errStr) ;
+            if (initFunc == nullptr) {
+                PLUGMGR_MSG(PLUGMGR_SYMLDFAIL)
+                        << "function" << "initPlugin" << fullPath << errStr
+                        << CoinMessageEol ;
+                retval = -2 ;
+            }
+        }
+        if (retval == 0) timer.succeeded(dynLib->getPerfSlot()) ;
+        timer.stop() ;
+        /*
+          Success or failure, the placeholders are withdrawn. A library that
+          failed stays in the bookkeeping (with no exit function) until it's
+          unloaded.
+        */
+        LoadBatch batch ;
+        if (retval == 0 && initOneLib(fullPath, dynLib, initFunc, batch) < 0)
+            retval = -2 ;
+        publishBatch(batch, dynLib) ;
+        if (retval == 0) {
+            PLUGMGR_MSG(PLUGMGR_LIBLDOK)
+                    << fullPath << CoinMessageEol ;
+        }
+    }
+    reclaim() ;
+
+    return (retval) ;
+}
+
+bool PluginManager::isDeferred (PluginUniqueID libID)
+{
+    WriteGuard guard(writeMutex_) ;
+    DynamicLibraryMap::const_iterator dlmIter = dynamicLibraryMap_.find(libID) ;
+    return (dlmIter != dynamicLibraryMap_.end() && dlmIter->second.deferred_) ;
+}
+
+/*
+  Invoke the initialisation function, which will (in the typical case)
+  trigger the registration of the various APIs implemented in this
+  plugin library. We should get back the exit function for the library.
+
+  Set initialisingPlugin_ to true so that the APIs will be registered
+  into the temporary wildcard and exact match vectors. If initialisation
+  is successful, we'll transfer them to the batch.
+
+  The plugin gets its own copy of the platform services block and will
+  (typically) fill in the ctrlObj_ field with its state object.
+*/
+int PluginManager::initOneLib (const std::string &fullPath,
+                               DynamicLibrary *dynLib, InitFunc initFunc,
+                               LoadBatch &batch)
+{
+    const int slot = perfStats_.slotFor(fullPath) ;
+    dynLib->setPerfSlot(slot) ;
+    /*
+      A deferred library got the default limits when it was deferred, and
+      may have had its own set since.
+    */
+    if (dynamicLibraryMap_.count(dynLib) == 0)
+        dynLib->getMemAccount().setLimits(dfltSoftMemLimit_, dfltHardMemLimit_) ;
+    initialisingPlugin_ = true ;
+    libInInit_ = dynLib ;
+    tmpExactMatchMap_.clear() ;
+    tmpWildCardVec_.clear() ;
+    PlatformServices services = platformServices_ ;
+    services.dfltPluginDir_ =
         reinterpret_cast<const CharString*>(dfltPluginDir_.c_str()) ;
-    platformServices_.pluginID_ = dynLib ;
-    ExitFunc exitFunc = initFunc(&platformServices_) ;
+    services.pluginID_ = dynLib ;
+    services.ctrlObj_ = nullptr ;
+    ExitFunc exitFunc = nullptr ;
+    {
+        PerfTimer timer(perfStats_, PerfStats::InitPlugin, slot) ;
+        TraceSpan span("plugin", "initPlugin", fullPath.c_str()) ;
+        exitFunc = initFunc(&services) ;
+        if (exitFunc != nullptr) timer.succeeded(slot) ;
+    }
+    initialisingPlugin_ = false ;
+    libInInit_ = nullptr ;
     if (exitFunc == nullptr) {
-        msgHandler_->message(PLUGMGR_LIBINITFAIL, msgs_)
+        PLUGMGR_MSG(PLUGMGR_LIBINITFAIL)
                 << fullPath << CoinMessageEol ;
-        delete dynLib ;
-        initialisingPlugin_ = false ;
+        tmpExactMatchMap_.clear() ;
+        tmpWildCardVec_.clear() ;
         return (-3) ;
     }
-    msgHandler_->message(PLUGMGR_LIBINITOK, msgs_)
+    PLUGMGR_MSG(PLUGMGR_LIBINITOK)
             << fullPath << CoinMessageEol ;
     /*
       We have happiness: the library is loaded and initialised. Do the
-      bookkeeping.  Enter the library in the library map. Add the exit function
-      to the vector of exit functions, and copy information from the temporary
-      wildcard and exact match vectors to the permanent vectors.
+      bookkeeping.  Enter the library in the library map along with its exit
+      function, and move the registrations from the temporary wildcard and
+      exact match vectors to the batch.
 
       \todo
       How paranoid do we want to be? Given that we check entries for uniqueness
@@ -390,78 +1357,258 @@ int PluginManager::loadOneLib (const std::string &lib, const std::string *dir,
     libPathToIDMap_[fullPath] = dynLib ;
     DynLibInfo &info = dynamicLibraryMap_[dynLib] ;
     info.dynLib_ = dynLib ;
-    info.ctrlObj_ = platformServices_.ctrlObj_ ;
+    info.libPath_ = fullPath ;
+    info.ctrlObj_ = services.ctrlObj_ ;
     info.exitFunc_ = exitFunc ;
-    exactMatchMap_.insert(tmpExactMatchMap_.begin(), tmpExactMatchMap_.end()) ;
+    info.deferred_ = false ;
+    info.replaced_ = false ;
+    tmpExactMatchMap_.setLibCtrlObj(dynLib, services.ctrlObj_) ;
+    for (size_t i = 0 ; i < tmpWildCardVec_.size() ; i++)
+        tmpWildCardVec_[i].libCtrlObj_ = services.ctrlObj_ ;
+    batch.exactMatchMap_.merge(tmpExactMatchMap_) ;
     tmpExactMatchMap_.clear() ;
-    wildCardVec_.insert(wildCardVec_.end(),
-                        tmpWildCardVec_.begin(), tmpWildCardVec_.end()) ;
+    batch.wildCardVec_.insert(batch.wildCardVec_.end(),
+                              tmpWildCardVec_.begin(), tmpWildCardVec_.end()) ;
     tmpWildCardVec_.clear() ;
-    initialisingPlugin_ = false ;
-    if (uniqueID != 0) (*uniqueID) = dynLib ;
-
-    msgHandler_->message(PLUGMGR_LIBLDOK, msgs_) << fullPath << CoinMessageEol ;
+    batch.libs_.push_back(dynLib) ;
 
     return (0) ;
 }
 
-
 /*
- We're not going to implement loadAll functionality in the first round.
- Make this method into a guaranteed failure, so we'll catch it when it's
- called.
+  Copy the batch into a new snapshot. Publishing the snapshot makes the APIs
+  of all libraries in the batch visible to clients at once. The copy must be
+  made here, not earlier: plugin initialisation can intern new API names,
+  which publishes a snapshot of its own.
 */
-
-int PluginManager::loadAllLibs (const std::string &libDir,
-                                InvokeServiceFunc func)
+void PluginManager::publishBatch (LoadBatch &batch, PluginUniqueID replaced,
+                                  bool retire)
 {
-    assert(false) ;
-
-    return (-1) ;
+    if (batch.libs_.empty() && replaced == nullptr) return ;
+
+    Registry *next = copyRegistry() ;
+    if (replaced != nullptr) {
+        if (retire)
+            next->retiredMap_.mergeLib(next->exactMatchMap_, replaced) ;
+        next->exactMatchMap_.eraseLib(replaced) ;
+        RegistrationVec &wild = next->wildCardVec_ ;
+        for (RegistrationVec::iterator rvIter = wild.begin() ;
+                rvIter != wild.end() ; ) {
+            if (rvIter->pluginID_ == replaced)
+                rvIter = wild.erase(rvIter) ;
+            else
+                rvIter++ ;
+        }
+    }
+    next->exactMatchMap_.merge(batch.exactMatchMap_) ;
+    next->wildCardVec_.insert(next->wildCardVec_.end(),
+                              batch.wildCardVec_.begin(),
+                              batch.wildCardVec_.end()) ;
+    if (batch.pool_ != nullptr) {
+        for (size_t i = 0 ; i < batch.pool_->copies_.size() ; i++)
+            next->pools_[batch.pool_->copies_[i]] = batch.pool_ ;
+    }
+    publish(next) ;
+    batch.exactMatchMap_.clear() ;
+    batch.wildCardVec_.clear() ;
+    batch.libs_.clear() ;
+    batch.pool_ = nullptr ;
 }
 
-#if defined(OSI2_IMPLEMENT_LOADALL)
 
-int32_t PluginManager::loadAll(const std::string &libDir,
-                               InvokeServiceFunc func)
+/*
+  Load all plugin libraries in a directory. This is a pipeline:
+
+    * Scan the directory once for candidates and drop any that are already
+      loaded.
+    * Open the candidates in parallel. Opening a library (mapping it,
+      resolving its symbols, running its static constructors) is where the
+      time goes.
+    * Take the writer lock and run the initialisation functions in sorted
+      order, so that registration order (and hence the choice of provider
+      for an unrestricted request) doesn't depend on thread timing.
+    * Publish all the registrations in a single snapshot.
+
+  Messages are emitted from this thread only, in sorted order.
+*/
+int PluginManager::loadAllLibs (const std::string &libDir,
+                                InvokeServiceFunc func)
 {
-    if (libDir.empty()) // Check that the path is non-empty.
-        return -1 ;
-
-    platformServices_.invokeService = func ;
-
-    Path dir_path(libDir) ;
-    if (!dir_path.exists() || !dir_path.isDirectory())
-        return -1 ;
+    double startTime = CoinWallclockTime() ;
+    std::string dir = libDir ;
+    if (dir.empty()) dir = getDfltPluginDir() ;
+    /*
+      Scan the directory. The cached listing comes back sorted, and says
+      which candidates have a manifest, so a library without one costs no
+      attempt to open it.
+    */
+    DirCache::EntryMap entries ;
+    std::string errStr ;
+    if (dirCache_.list(dir, entries, errStr) != 0) {
+        PLUGMGR_MSG(PLUGMGR_DIRREADFAIL)
+                << dir << errStr << CoinMessageEol ;
+        return (-1) ;
+    }
+    std::vector<std::string> names ;
+    const std::string suffix = "." + dynamicLibraryExtension ;
+    for (DirCache::EntryMap::const_iterator iter = entries.begin() ;
+            iter != entries.end() ; iter++) {
+        const std::string &name = iter->first ;
+        if (iter->second.isFile_ && name.size() > suffix.size() &&
+                name.compare(name.size() - suffix.size(),
+                             suffix.size(), suffix) == 0)
+            names.push_back(name) ;
+    }
 
-    Directory::Entry e ;
-    Directory::Iterator di(dir_path) ;
-    while (di.next(e)) {
-        Path full_path(dir_path + Path(e.path)) ;
+    char dirSep = CoinFindDirSeparator() ;
+    std::vector<LoadCandidate> candidates ;
+    int numDeferred = 0 ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        if (func != nullptr) {
+            ScopedLock lock(serviceMutex_) ;
+            clientService_ = func ;
+        }
+        for (size_t i = 0 ; i < names.size() ; i++) {
+            LoadCandidate cand ;
+            cand.fullPath_ = dir + dirSep + names[i] ;
+            if (libPathToIDMap_.find(cand.fullPath_) != libPathToIDMap_.end())
+                continue ;
+            if (entries.count(names[i] + ".manifest") != 0 &&
+                    deferOneLib(cand.fullPath_, nullptr) == 0) {
+                numDeferred++ ;
+                continue ;
+            }
+            cand.dynLib_ = nullptr ;
+            cand.initFunc_ = nullptr ;
+            cand.status_ = -1 ;
+            cand.loadTime_ = 0.0 ;
+            candidates.push_back(cand) ;
+        }
+    }
+    /*
+      Open the candidates in parallel. If we can't start a thread, this thread
+      picks up the slack.
+    */
+    int numThreads = loadThreadCount(candidates.size()) ;
+    LoadQueue queue ;
+    queue.candidates_ = &candidates ;
+    queue.next_ = 0 ;
+    queue.open_ = openOneLib ;
+    queue.perfStats_ = &perfStats_ ;
+    std::vector<ThreadHandle> threads ;
+    for (int i = 1 ; i < numThreads ; i++) {
+        ThreadHandle thread ;
+        if (!startThread(thread, loadWorker, &queue)) break ;
+        threads.push_back(thread) ;
+    }
+    loadWorker(&queue) ;
+    for (size_t i = 0 ; i < threads.size() ; i++) joinThread(threads[i]) ;
+    /*
+      Initialise, in order, and publish the lot.
+    */
+    int retval = 0 ;
+    int numLoaded = 0 ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        LoadBatch batch ;
+        for (size_t i = 0 ; i < candidates.size() ; i++) {
+            LoadCandidate &cand = candidates[i] ;
+            if (cand.status_ == -1) {
+                PLUGMGR_MSG(PLUGMGR_LIBLDFAIL)
+                        << cand.fullPath_ << cand.errStr_ << CoinMessageEol ;
+                retval = 1 ;
+                continue ;
+            }
+            if (cand.status_ == -2) {
+                PLUGMGR_MSG(PLUGMGR_NOINITFUNC)
+                        << cand.fullPath_ << CoinMessageEol ;
+                continue ;
+            }
+            /*
+              Someone may have loaded this library while we weren't holding
+              the lock. Our handle is just an extra reference; drop it.
+            */
+            if (libPathToIDMap_.find(cand.fullPath_) != libPathToIDMap_.end()) {
+                delete cand.dynLib_ ;
+                PLUGMGR_MSG(PLUGMGR_LIBLDDUP)
+                        << cand.fullPath_ << CoinMessageEol ;
+                continue ;
+            }
+            double initStart = CoinWallclockTime() ;
+            int res = initOneLib(cand.fullPath_, cand.dynLib_,
+                                 cand.initFunc_, batch) ;
+            double initTime = CoinWallclockTime() - initStart ;
+            if (res < 0) {
+                delete cand.dynLib_ ;
+                retval = 1 ;
+                continue ;
+            }
+            numLoaded++ ;
+            PLUGMGR_MSG(PLUGMGR_LIBLDTIME)
+                    << cand.fullPath_ << cand.loadTime_ << initTime
+                    << CoinMessageEol ;
+        }
+        std::vector<DynamicLibrary *> loaded = batch.libs_ ;
+        publishBatch(batch) ;
+        for (size_t i = 0 ; i < loaded.size() ; i++) {
+            PLUGMGR_MSG(PLUGMGR_LIBLDOK)
+                    << loaded[i]->getLibPath() << CoinMessageEol ;
+        }
+        PLUGMGR_MSG(PLUGMGR_LOADALLOK)
+                << numLoaded + numDeferred
+                << static_cast<int>(candidates.size()) + numDeferred << dir
+                << static_cast<int>(threads.size()) + 1
+                << CoinWallclockTime() - startTime << CoinMessageEol ;
+    }
+    reclaim() ;
 
-        // Skip directories
-        if (full_path.isDirectory())
-            continue ;
+    return (retval) ;
+}
 
-        // Skip files with the wrong extension
-        std::string ext = std::string(full_path.getExtension()) ;
-        if (ext != dynamicLibraryExtension)
+/*
+  A change to a manifest is reported as a change to its library.
+*/
+int PluginManager::getPluginDirChanges (const std::string &libDir,
+                                        std::vector<std::string> &libs)
+{
+    std::string dir = libDir ;
+    if (dir.empty()) dir = getDfltPluginDir() ;
+    std::vector<std::string> changed ;
+    std::string errStr ;
+    if (dirCache_.takeChanges(dir, changed, errStr) != 0) {
+        PLUGMGR_MSG(PLUGMGR_DIRREADFAIL)
+                << dir << errStr << CoinMessageEol ;
+        return (-1) ;
+    }
+    const std::string suffix = "." + dynamicLibraryExtension ;
+    const std::string manifestSuffix = ".manifest" ;
+    std::set<std::string> seen ;
+    for (size_t i = 0 ; i < changed.size() ; i++) {
+        std::string name = changed[i] ;
+        if (name.size() > manifestSuffix.size() &&
+                name.compare(name.size() - manifestSuffix.size(),
+                             manifestSuffix.size(), manifestSuffix) == 0)
+            name.erase(name.size() - manifestSuffix.size()) ;
+        if (name.size() <= suffix.size() ||
+                name.compare(name.size() - suffix.size(),
+                             suffix.size(), suffix) != 0)
             continue ;
-
-        // Ignore return value
-        /*int32_t res = */
-        loadOneLib(std::string(full_path)) ;
+        if (seen.insert(name).second) libs.push_back(name) ;
     }
-
-    return 0 ;
+    return (0) ;
 }
-#endif		// OSI2_IMPLEMENT_LOADALL
 
 
 /*
   Unload a single library specified by name. The name must exactly match the
   name used to load the library. Issue a warning if the library isn't loaded.
 
+  The registrations are withdrawn by publishing a snapshot without them. Then
+  we wait out a grace period, so that any thread that found one of the
+  library's registrations in the old snapshot has finished with it, before
+  running the exit function and closing the library.
+
   Returns:  1 if the library isn't loaded
 	    0 if the library unloads successfully
 	   -1 exit function failed
@@ -482,85 +1629,317 @@ int PluginManager::unloadOneLib (const std::string &lib,
     }
     char dirSep = CoinFindDirSeparator() ;
     fullPath += dirSep + lib ;
-    /*
-      Find the entry for the library. Warn the user if the library is
-      not loaded.
-    */
-    LibPathToIDMap::iterator lpiIter = libPathToIDMap_.find(fullPath) ;
-    if (lpiIter == libPathToIDMap_.end()) {
-        msgHandler_->message(PLUGMGR_LIBNOTFOUND, msgs_)
-                << fullPath << CoinMessageEol ;
-        return (1) ;
-    }
-    DynamicLibraryMap::iterator dlmIter =
-        dynamicLibraryMap_.find(lpiIter->second) ;
-    /*
-      Step through the exact match map and remove any entries that are
-      registered to this library. Regrettably, erase for a map is defined
-      to invalidate the iterator pointing to the element. But not iterators
-      pointing to other elements, so we need to advance prior to erasing.
-    */
-    DynLibInfo &libInfo = dlmIter->second ;
-    DynamicLibrary *dynLib = libInfo.dynLib_ ;
-    RegistrationMap::iterator rmIter = exactMatchMap_.begin() ;
-    while (rmIter != exactMatchMap_.end()) {
-        RegisterParams &regParms = rmIter->second ;
-        if (regParms.pluginID_ == dynLib) {
-            RegistrationMap::iterator tmpIter = rmIter ;
-            rmIter++ ;
-            msgHandler_->message(PLUGMGR_APIUNREG, msgs_)
-                    << tmpIter->first << dynLib->getLibPath() << CoinMessageEol ;
-            exactMatchMap_.erase(tmpIter) ;
-        } else {
-            rmIter++ ;
+    TraceSpan span("plugin", "unloadOneLib", fullPath.c_str()) ;
+
+    std::vector<DynLibInfo> victims ;
+    LibPool *pool = nullptr ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        /*
+          Find the entry for the library. Warn the user if the library is
+          not loaded. If the library is a pool, all the copies go.
+        */
+        LibPathToIDMap::iterator lpiIter = libPathToIDMap_.find(fullPath) ;
+        if (lpiIter == libPathToIDMap_.end()) {
+            PLUGMGR_MSG(PLUGMGR_LIBNOTFOUND)
+                    << fullPath << CoinMessageEol ;
+            return (1) ;
         }
-    }
-    /*
-      See if there's an entry in the wildcard vector. Vectors don't have the
-      same problem as maps (erase returns a valid iterator), but there's only
-      one entry so it's irrelevant.
-    */
-    for (RegistrationVec::iterator rvIter = wildCardVec_.begin() ;
-            rvIter != wildCardVec_.end() ;
-            rvIter++) {
-        RegisterParams &regParms = *rvIter ;
-        if (regParms.pluginID_ == dynLib) {
-            msgHandler_->message(PLUGMGR_APIUNREG, msgs_)
-                    << "wildcard" << dynLib->getLibPath() << CoinMessageEol ;
-            wildCardVec_.erase(rvIter) ;
-            break ;
+        std::vector<PluginUniqueID> libIDs(1, lpiIter->second) ;
+        std::map<PluginUniqueID, LibPool *>::iterator poolIter =
+            libPools_.find(lpiIter->second) ;
+        if (poolIter != libPools_.end()) {
+            pool = poolIter->second ;
+            libIDs = pool->copies_ ;
+            libPools_.erase(poolIter) ;
         }
+        Registry *next = copyRegistry() ;
+        for (size_t l = 0 ; l < libIDs.size() ; l++) {
+            DynamicLibraryMap::iterator dlmIter =
+                dynamicLibraryMap_.find(libIDs[l]) ;
+            victims.push_back(dlmIter->second) ;
+            DynamicLibrary *dynLib = dlmIter->second.dynLib_ ;
+            /*
+              Remove any entries in the exact match table that are registered
+              to this library.
+            */
+            std::vector<APIHandle> removed ;
+            next->exactMatchMap_.eraseLib(dynLib, &removed) ;
+            for (size_t i = 0 ; i < removed.size() ; i++) {
+                PLUGMGR_MSG(PLUGMGR_APIUNREG)
+                        << *next->apiNames_[removed[i]] << dynLib->getLibPath()
+                        << CoinMessageEol ;
+            }
+            /*
+              See if there's an entry in the wildcard vector. Vectors don't
+              have the same problem as maps (erase returns a valid iterator),
+              but there's only one entry so it's irrelevant.
+            */
+            for (RegistrationVec::iterator rvIter = next->wildCardVec_.begin() ;
+                    rvIter != next->wildCardVec_.end() ;
+                    rvIter++) {
+                RegisterParams &regParms = *rvIter ;
+                if (regParms.pluginID_ == dynLib) {
+                    PLUGMGR_MSG(PLUGMGR_APIUNREG)
+                            << "wildcard" << dynLib->getLibPath()
+                            << CoinMessageEol ;
+                    next->wildCardVec_.erase(rvIter) ;
+                    break ;
+                }
+            }
+            next->pools_.erase(dynLib) ;
+            dynamicLibraryMap_.erase(dlmIter) ;
+        }
+        publish(next) ;
+        libPathToIDMap_.erase(lpiIter) ;
     }
     /*
-      Execute the exit function for the library.
+      Wait until no thread can be using the library, then execute the exit
+      function for the library. A deferred library was never initialised and
+      has no exit function.
     */
+    reclaim() ;
+    delete pool ;
+    for (size_t l = 0 ; l < victims.size() ; l++) {
+        if (closeLib(victims[l]) < 0) result = -1 ;
+    }
+
+    return (result) ;
+}
+
+/*
+  Run the exit function of a library that's been withdrawn and close it.
+*/
+int PluginManager::closeLib (const DynLibInfo &libInfo)
+{
+    DynamicLibrary *dynLib = libInfo.dynLib_ ;
+    const int slot = dynLib->getPerfSlot() ;
+    PerfTimer timer(perfStats_, PerfStats::UnloadLib, slot) ;
+    int libResult = 0 ;
     bool threwError = false ;
     ExitFunc func = libInfo.exitFunc_ ;
-    platformServices_.pluginID_ = dynLib ;
-    platformServices_.ctrlObj_ = libInfo.ctrlObj_ ;
-    try {
-        result = (*func)(&platformServices_) ;
-    } catch (...) {
-        threwError = true ;
-    }
-    if (threwError || result != 0) {
-        msgHandler_->message(PLUGMGR_LIBEXITFAIL, msgs_)
+    PlatformServices services = platformServices_ ;
+    services.pluginID_ = dynLib ;
+    services.ctrlObj_ = libInfo.ctrlObj_ ;
+    if (func != nullptr) {
+        try {
+            libResult = (*func)(&services) ;
+        } catch (...) {
+            threwError = true ;
+        }
+    }
+    if (func == nullptr) {
+        // Nothing to shut down.
+    } else if (threwError || libResult != 0) {
+        PLUGMGR_MSG(PLUGMGR_LIBEXITFAIL)
                 << dynLib->getLibPath() << CoinMessageEol ;
-        result = -1 ;
+        libResult = -1 ;
     } else {
-        msgHandler_->message(PLUGMGR_LIBEXITOK, msgs_)
+        PLUGMGR_MSG(PLUGMGR_LIBEXITOK)
                 << dynLib->getLibPath() << CoinMessageEol ;
     }
     /*
-      Unload the library and remove the map entry.
+      Unload the library.
     */
-    msgHandler_->message(PLUGMGR_LIBCLOSE, msgs_)
+    PLUGMGR_MSG(PLUGMGR_LIBCLOSE)
             << dynLib->getLibPath() << CoinMessageEol ;
     delete dynLib ;
-    dynamicLibraryMap_.erase(dlmIter) ;
-    libPathToIDMap_.erase(lpiIter) ;
+    if (libResult == 0) timer.succeeded(slot) ;
 
-    return (result) ;
+    return (libResult) ;
+}
+
+
+/*
+  Replace a library with a new version. The new version is opened and
+  initialised with the writer lock held, and its registrations replace the
+  old version's in one snapshot, so a reader sees one version or the other,
+  never neither. The old version's exact match registrations move to the
+  retired table, where destroyObject can still find them.
+
+  The old version can't be closed while any object it created is live. Its
+  live count can still go up until every reader that might have found its
+  registrations in an older snapshot has finished, so it's marked as
+  retiring only after a grace period. From then on, the destroy that takes
+  the count to zero closes it (closeRetired). If the count is already zero,
+  the call here does it.
+
+  dlopen returns the handle it already has for a path that's open, so a
+  library rebuilt in place is loaded isolated to get a fresh copy.
+*/
+int PluginManager::reloadOneLib (const std::string &lib,
+                                 const std::string *dir,
+                                 const std::string *newLib,
+                                 PluginUniqueID *uniqueID)
+{
+    if (uniqueID != 0) (*uniqueID) = 0 ;
+    std::string libDir ;
+    if (dir == nullptr || (dir->compare("") == 0)) {
+        libDir = getDfltPluginDir() ;
+    } else {
+        libDir = *dir ;
+    }
+    char dirSep = CoinFindDirSeparator() ;
+    const std::string fullPath = libDir + dirSep + lib ;
+    const std::string newPath =
+        (newLib == nullptr) ? fullPath : (libDir + dirSep + *newLib) ;
+    const bool isolated = (newPath == fullPath) ;
+    TraceSpan span("plugin", "reloadOneLib", newPath.c_str()) ;
+
+    if (isolated && !DynamicLibrary::isolationSupported()) {
+        PLUGMGR_MSG(PLUGMGR_LIBLDFAIL)
+                << newPath << "isolated loading is not supported"
+                << CoinMessageEol ;
+        return (-4) ;
+    }
+
+    DynamicLibrary *oldLib = nullptr ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        LibPathToIDMap::const_iterator lpiIter = libPathToIDMap_.find(fullPath) ;
+        if (lpiIter == libPathToIDMap_.end() ||
+                libPools_.count(lpiIter->second) != 0) {
+            PLUGMGR_MSG(PLUGMGR_LIBNOTFOUND)
+                    << fullPath << CoinMessageEol ;
+            return (-5) ;
+        }
+        if (!isolated && libPathToIDMap_.count(newPath) != 0) {
+            PLUGMGR_MSG(PLUGMGR_LIBLDDUP)
+                    << newPath << CoinMessageEol ;
+            return (-5) ;
+        }
+        DynLibInfo &oldInfo = dynamicLibraryMap_[lpiIter->second] ;
+        oldLib = oldInfo.dynLib_ ;
+        /*
+          Load and initialise the new version. On failure the old version is
+          untouched.
+        */
+        std::string errStr ;
+        DynamicLibrary *dynLib = nullptr ;
+        InitFunc initFunc = nullptr ;
+        int retval = 0 ;
+        {
+            const int slot = perfStats_.slotFor(newPath) ;
+            PerfTimer timer(perfStats_, PerfStats::LoadLib, slot) ;
+            retval = openOneLib(newPath, dynLib, initFunc, errStr, isolated) ;
+            if (retval == 0) timer.succeeded(slot) ;
+        }
+        if (retval == -1) {
+            PLUGMGR_MSG(PLUGMGR_LIBLDFAIL)
+                    << newPath << errStr << CoinMessageEol ;
+            return (-1) ;
+        } else if (retval == -2) {
+            PLUGMGR_MSG(PLUGMGR_SYMLDFAIL)
+                    << "function" << "initPlugin" << newPath << errStr
+                    << CoinMessageEol ;
+            return (-2) ;
+        }
+        LoadBatch batch ;
+        retval = initOneLib(newPath, dynLib, initFunc, batch) ;
+        if (retval < 0) {
+            delete dynLib ;
+            return (retval) ;
+        }
+        /*
+          Swap. A deferred library has no objects; its placeholders simply
+          go. The path now names the new version.
+        */
+        oldInfo.replaced_ = true ;
+        publishBatch(batch, oldLib, !oldInfo.deferred_) ;
+        if (!isolated) libPathToIDMap_.erase(newPath) ;
+        libPathToIDMap_[fullPath] = dynLib ;
+        dynamicLibraryMap_[dynLib].libPath_ = fullPath ;
+        if (uniqueID != 0) (*uniqueID) = dynLib ;
+
+        PLUGMGR_MSG(PLUGMGR_LIBRELOAD)
+                << fullPath << newPath << oldLib->getNumLive()
+                << CoinMessageEol ;
+    }
+    reclaim() ;
+    oldLib->setRetiring() ;
+    closeRetired() ;
+
+    return (0) ;
+}
+
+/*
+  Close the replaced libraries whose objects are all gone. Their
+  registrations are withdrawn from the retired table in one snapshot, and
+  after a grace period no destroy can be using them.
+*/
+void PluginManager::closeRetired ()
+{
+    if (readDepth > 0 || writeDepth > 0) return ;
+
+    std::vector<DynLibInfo> idle ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        for (DynamicLibraryMap::iterator dlmIter = dynamicLibraryMap_.begin() ;
+                dlmIter != dynamicLibraryMap_.end() ; ) {
+            const DynLibInfo &info = dlmIter->second ;
+            if (info.replaced_ && info.dynLib_->isRetiring() &&
+                    info.dynLib_->getNumLive() <= 0) {
+                idle.push_back(info) ;
+                dynamicLibraryMap_.erase(dlmIter++) ;
+            } else {
+                dlmIter++ ;
+            }
+        }
+        if (idle.empty()) return ;
+        Registry *next = copyRegistry() ;
+        for (size_t l = 0 ; l < idle.size() ; l++)
+            next->retiredMap_.eraseLib(idle[l].dynLib_) ;
+        publish(next) ;
+    }
+    reclaim() ;
+    for (size_t l = 0 ; l < idle.size() ; l++) {
+        PLUGMGR_MSG(PLUGMGR_LIBRETIRED)
+                << idle[l].dynLib_->getLibPath() << CoinMessageEol ;
+        closeLib(idle[l]) ;
+    }
+}
+
+int PluginManager::getNumRetiring ()
+{
+    WriteGuard guard(writeMutex_) ;
+    int numRetiring = 0 ;
+    for (DynamicLibraryMap::const_iterator dlmIter =
+                dynamicLibraryMap_.begin() ;
+            dlmIter != dynamicLibraryMap_.end() ; dlmIter++) {
+        if (dlmIter->second.replaced_) numRetiring++ ;
+    }
+    return (numRetiring) ;
+}
+
+/*
+  Memory accounting. The lock keeps the library from being closed while
+  we look at its account.
+*/
+int PluginManager::setMemLimits (PluginUniqueID libID, int64_t softLimit,
+                                 int64_t hardLimit)
+{
+    WriteGuard guard(writeMutex_) ;
+    DynamicLibraryMap::const_iterator dlmIter = dynamicLibraryMap_.find(libID) ;
+    if (dlmIter == dynamicLibraryMap_.end()) return (-1) ;
+    dlmIter->second.dynLib_->getMemAccount().setLimits(softLimit, hardLimit) ;
+    return (0) ;
+}
+
+int PluginManager::getMemUsage (PluginUniqueID libID, MemAccount::Usage &usage)
+{
+    WriteGuard guard(writeMutex_) ;
+    DynamicLibraryMap::const_iterator dlmIter = dynamicLibraryMap_.find(libID) ;
+    if (dlmIter == dynamicLibraryMap_.end()) return (-1) ;
+    dlmIter->second.dynLib_->getMemAccount().getUsage(usage) ;
+    return (0) ;
+}
+
+int64_t PluginManager::getObjMemUsage (PluginUniqueID libID, const void *obj)
+{
+    WriteGuard guard(writeMutex_) ;
+    DynamicLibraryMap::const_iterator dlmIter = dynamicLibraryMap_.find(libID) ;
+    if (dlmIter == dynamicLibraryMap_.end()) return (-1) ;
+    return (dlmIter->second.dynLib_->getMemAccount().getOwnerUsage(obj)) ;
 }
 
 
@@ -570,6 +1949,9 @@ int PluginManager::unloadOneLib (const std::string &lib,
   manager. Executing the destructor for the DynamicLibrary object will unload
   the library.
 
+  As with unloadOneLib, we publish an empty registry and wait out a grace
+  period before touching the libraries. API names remain interned.
+
   \todo: The exit functions can throw? Why isn't there a catch block for all
 	 the others (init function, etc.)
 */
@@ -577,57 +1959,125 @@ int PluginManager::shutdown()
 {
     int overallResult = 0 ;
 
-    for (DynamicLibraryMap::iterator dlmIter = dynamicLibraryMap_.begin() ;
-            dlmIter != dynamicLibraryMap_.end() ;
+    // Plugin code queued in the pool runs before the plugins go
+    threadPool_.stop() ;
+    DynamicLibraryMap libs ;
+    std::map<PluginUniqueID, LibPool *> pools ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        libs.swap(dynamicLibraryMap_) ;
+        pools.swap(libPools_) ;
+        libPathToIDMap_.clear() ;
+        Registry *next = copyRegistry() ;
+        next->exactMatchMap_.clear() ;
+        next->wildCardVec_.clear() ;
+        next->pools_.clear() ;
+        next->retiredMap_.clear() ;
+        publish(next) ;
+    }
+    reclaim() ;
+    for (std::map<PluginUniqueID, LibPool *>::iterator poolIter =
+                pools.begin() ;
+            poolIter != pools.end() ; poolIter++)
+        delete poolIter->second ;
+
+    for (DynamicLibraryMap::iterator dlmIter = libs.begin() ;
+            dlmIter != libs.end() ;
             dlmIter++) {
         int result = 0 ;
         bool threwError = false ;
         ExitFunc func = dlmIter->second.exitFunc_ ;
         DynamicLibrary *dynLib = dlmIter->second.dynLib_ ;
-        platformServices_.pluginID_ = dynLib ;
-        platformServices_.ctrlObj_ = dlmIter->second.ctrlObj_ ;
+        PlatformServices services = platformServices_ ;
+        services.pluginID_ = dynLib ;
+        services.ctrlObj_ = dlmIter->second.ctrlObj_ ;
+        if (func == nullptr) continue ;
         try {
-            result = (*func)(&platformServices_) ;
+            result = (*func)(&services) ;
         } catch (...) {
             threwError = true ;
         }
         if (threwError || result != 0) {
-            msgHandler_->message(PLUGMGR_LIBEXITFAIL, msgs_)
+            PLUGMGR_MSG(PLUGMGR_LIBEXITFAIL)
                     << dynLib->getLibPath() << CoinMessageEol ;
             overallResult-- ;
         } else {
-            msgHandler_->message(PLUGMGR_LIBEXITOK, msgs_)
+            PLUGMGR_MSG(PLUGMGR_LIBEXITOK)
                     << dynLib->getLibPath() << CoinMessageEol ;
         }
     }
     /*
-      Clear out the maps. Before we clear dynamicLibraryMap_, go through and
-      delete the DynamicLibrary objects; the destructor will unload the library.
-      The other vectors hold actual objects rather than pointers.
+      Close the libraries. Go through and delete the DynamicLibrary objects;
+      the destructor will unload the library.
     */
-    for (DynamicLibraryMap::iterator dlmIter = dynamicLibraryMap_.begin() ;
-            dlmIter != dynamicLibraryMap_.end() ;
+    for (DynamicLibraryMap::iterator dlmIter = libs.begin() ;
+            dlmIter != libs.end() ;
             dlmIter++) {
         DynamicLibrary *dynLib = dlmIter->second.dynLib_ ;
-        msgHandler_->message(PLUGMGR_LIBCLOSE, msgs_)
+        PLUGMGR_MSG(PLUGMGR_LIBCLOSE)
                 << dynLib->getLibPath() << CoinMessageEol ;
         delete dynLib ;
     }
-    libPathToIDMap_.clear() ;
-    dynamicLibraryMap_.clear() ;
-    exactMatchMap_.clear() ;
-    wildCardVec_.clear() ;
 
     return (overallResult) ;
 }
 
+/*
+  Take every lock a child might need, in the order the rest of the manager
+  takes them, then fork. Output still buffered would be written twice, once
+  by each process; flush it first. The parent releases the locks; the child resets
+  them (see Mutex::reset). Any reader counted in the child's copy of
+  readers_ is a thread that doesn't exist there.
+*/
+int PluginManager::forkProcess ()
+{
+#   ifdef WIN32
+    return (-1) ;
+#   else
+    Mutex *held[] = { &writeMutex_, &graceMutex_, &msgMutex_, &declineMutex_,
+                      &serviceMutex_ } ;
+    const int numHeld = sizeof(held)/sizeof(held[0]) ;
+    // The log drain takes msgMutex_ while holding its own locks
+    logSink_.lockForFork() ;
+    for (int i = 0 ; i < numHeld ; i++) held[i]->lock() ;
+    perfStats_.lockForFork() ;
+    Trace::lockForFork() ;
+    dirCache_.lockForFork() ;
+    threadPool_.lockForFork() ;
+    std::fflush(nullptr) ;
+    const pid_t pid = ::fork() ;
+    const bool child = (pid == 0) ;
+    threadPool_.unlockAfterFork(child) ;
+    dirCache_.unlockAfterFork(child) ;
+    Trace::unlockAfterFork(child) ;
+    perfStats_.unlockAfterFork(child) ;
+    for (int i = numHeld-1 ; i >= 0 ; i--) {
+        if (child) {
+            held[i]->reset() ;
+        } else {
+            held[i]->unlock() ;
+        }
+    }
+    logSink_.unlockAfterFork(child) ;
+    if (child) {
+        readers_[0] = 0 ;
+        readers_[1] = 0 ;
+    }
+    return (static_cast<int>(pid)) ;
+#   endif
+}
+
 /*
   Replace the current handler with a new handler. The current handler may or
   may not be our responsibility. If newHandler is null, create a default
   handler. (We can't be without one; the code isn't prepared for that.)
+  Plugin messages already queued go to the current handler; msgMutex_ keeps
+  the log drain out while the handler is replaced.
 */
 void PluginManager::setMsgHandler (CoinMessageHandler *newHandler)
 {
+    logSink_.flush() ;
+    ScopedLock lock(msgMutex_) ;
     if (dfltHandler_) {
         delete msgHandler_ ;
         msgHandler_ = nullptr ;
@@ -646,30 +2096,118 @@ void PluginManager::setMsgHandler (CoinMessageHandler *newHandler)
 // ---------------------------------------------------------------
 
 /*
-  Construct an ObjectParams block to pass to the plugin.
+  Fill in an ObjectParams block to pass to the plugin.
+
+  This method hides the details of constructing the object creation
+  parameters. The library state object is cached in the registration, so
+  there's nothing to look up. The API string handed to the plugin is the
+  interned copy, so it remains valid for the life of the plugin manager. Both
+  blocks are supplied by the caller (normally on the stack) so that
+  concurrent calls don't share them and nothing is allocated.
+*/
+void PluginManager::buildObjectParams (const Registry &reg,
+        APIHandle api, const RegisterParams &rp,
+        ObjectParams &objParms, PlatformServices &services) const
+{
+    objParms.apiStr_ =
+        reinterpret_cast<const CharString *>(reg.apiNames_[api]->c_str()) ;
+
+    services = platformServices_ ;
+    services.pluginID_ = rp.pluginID_ ;
+    services.ctrlObj_ = rp.libCtrlObj_ ;
+    objParms.platformServices_ = &services ;
+    objParms.ctrlObj_ = rp.ctrlObj_ ;
+}
+
+/*
+  Promote a wildcard registration to an exact match. Two threads can race to
+  promote the same API; the loser finds the registration already present,
+  which is just as good. The library may have been withdrawn (by unloadOneLib)
+  since the caller found the wildcard registration; in that case, don't
+  resurrect it. Likewise if it has been replaced by reloadOneLib.
+
+  Returns 0 if the registration is (now) present, -1 otherwise.
+*/
+int PluginManager::promoteWildcard (APIHandle api, const RegisterParams &rp)
+{
+    int retval = 0 ;
+    {
+        WriteGuard guard(writeMutex_) ;
+        DynamicLibraryMap::const_iterator dlmIter =
+            dynamicLibraryMap_.find(rp.pluginID_) ;
+        if (dlmIter == dynamicLibraryMap_.end() || dlmIter->second.replaced_)
+            return (-1) ;
+        if (current_->exactMatchMap_.find(api, rp.pluginID_) == nullptr)
+            retval = registerObject(api, &rp) ;
+    }
+    reclaim() ;
+
+    return (retval) ;
+}
 
-  This method hides the details of constructing the object creation parameters.
-  In particular, it hides the business of finding the correct library state
-  object.
+/*
+  The negative result cache. An entry is meaningful only for the generation
+  of snapshot it was made under. A reader working with a stale snapshot
+  neither sees nor adds entries; a reader working with a newer snapshot
+  discards the lot and starts over.
 */
-ObjectParams *PluginManager::buildObjectParams (const std::string apiStr,
-        const RegisterParams &rp)
+bool PluginManager::isDeclined (const Registry &reg, APIHandle api,
+                                PluginUniqueID libID) const
+{
+    ScopedLock lock(declineMutex_) ;
+    if (declineCache_.generation_ != reg.generation_) return (false) ;
+    return (declineCache_.declined_.count(std::make_pair(api, libID)) != 0) ;
+}
+
+void PluginManager::noteDeclined (const Registry &reg, APIHandle api,
+                                  PluginUniqueID libID) const
 {
-    ObjectParams *objParms = new ObjectParams() ;
-    objParms->apiStr_ = reinterpret_cast<const CharString *>(apiStr.c_str()) ;
+    ScopedLock lock(declineMutex_) ;
+    if (declineCache_.generation_ != reg.generation_) {
+        if (reg.generation_ < declineCache_.generation_) return ;
+        declineCache_.declined_.clear() ;
+        declineCache_.generation_ = reg.generation_ ;
+    }
+    declineCache_.declined_.insert(std::make_pair(api, libID)) ;
+}
 
-    DynamicLibraryMap::iterator dlmIter =
-        dynamicLibraryMap_.find(rp.pluginID_) ;
-    DynLibInfo &dynLib = dlmIter->second ;
-    platformServices_.pluginID_ = rp.pluginID_ ;
-    platformServices_.ctrlObj_ = dynLib.ctrlObj_ ;
-    objParms->platformServices_ = &platformServices_ ;
-    objParms->ctrlObj_ = rp.ctrlObj_ ;
 
-    return (objParms) ;
+/*
+  Round robin over the copies of a pool. A copy that doesn't (yet) have a
+  usable registration for the API is passed over --- a wildcard promotion
+  registers the API for one copy only, for instance. If no copy will do, we
+  fall back on the registration we were given.
+*/
+const RegisterParams *PluginManager::pickPoolCopy (
+    const Registry &reg, APIHandle api, PluginUniqueID libID,
+    const RegisterParams *rp) const
+{
+    std::map<PluginUniqueID, const LibPool *>::const_iterator iter =
+        reg.pools_.find(rp->pluginID_) ;
+    if (iter == reg.pools_.end()) return (rp) ;
+    const LibPool &pool = *iter->second ;
+    if (libID != 0 && libID != pool.copies_[0]) return (rp) ;
+
+    const unsigned int numCopies =
+        static_cast<unsigned int>(pool.copies_.size()) ;
+    const unsigned int start =
+        static_cast<unsigned int>(atomicAdd(&pool.next_, 1)) ;
+    for (unsigned int k = 0 ; k < numCopies ; k++) {
+        PluginUniqueID copy = pool.copies_[(start+k)%numCopies] ;
+        const RegisterParams *candidate = reg.exactMatchMap_.find(api, copy) ;
+        if (candidate != nullptr && candidate->createFunc_ != nullptr)
+            return (candidate) ;
+    }
+    return (rp) ;
 }
 
 
+/*
+  Resolve the API string and hand off to the handle-based method. We don't
+  intern the string here --- a request for an API that nobody supplies
+  shouldn't permanently consume a handle --- unless we need to go looking
+  for a wildcard.
+*/
 void *PluginManager::createObject (const std::string &apiStr,
                                    PluginUniqueID &libID,
                                    IObjectAdapter &adapter)
@@ -677,36 +2215,96 @@ void *PluginManager::createObject (const std::string &apiStr,
     /*
       "*" is not a valid object type --- some qualification is needed.
     */
-    if (apiStr == std::string("*")) {
-        msgHandler_->message(PLUGMGR_APICREATEFAIL, msgs_)
+    if (apiStr == "*") {
+        PLUGMGR_MSG(PLUGMGR_APICREATEFAIL)
                 << apiStr << "wildcard is invalid for createObject" << CoinMessageEol ;
         return (nullptr) ;
     }
+    APIHandle api = findAPIHandle(apiStr) ;
+    if (api < 0) {
+        int parity ;
+        bool noWildcards = beginRead(parity)->wildCardVec_.empty() ;
+        endRead(parity) ;
+        if (noWildcards) {
+            PLUGMGR_MSG(PLUGMGR_APICREATEFAIL)
+                    << apiStr << "no capable plugin" << CoinMessageEol ;
+            return (nullptr) ;
+        }
+        api = getAPIHandle(apiStr) ;
+    }
+    return (createObject(api, libID, adapter)) ;
+}
+
+
+/*
+  The whole of the creation, including the call to the plugin's create
+  function, happens in a read-side section. That guarantees that the plugin
+  library can't be closed out from under us.
+*/
+void *PluginManager::createObject (APIHandle api, PluginUniqueID &libID,
+                                   IObjectAdapter &adapter)
+{
+    PerfTimer timer(perfStats_, PerfStats::CreateExact) ;
+    int parity ;
+    const Registry *reg = beginRead(parity) ;
+
+    if (api < 0 || static_cast<size_t>(api) >= reg->apiNames_.size()) {
+        endRead(parity) ;
+        PLUGMGR_MSG(PLUGMGR_APICREATEFAIL)
+                << "<invalid handle>" << "invalid API handle" << CoinMessageEol ;
+        return (nullptr) ;
+    }
+    const std::string &apiStr = *reg->apiNames_[api] ;
+    TraceSpan span("object", "createObject", apiStr.c_str()) ;
     /*
-      Check for an exact (string) match. If so, add the plugin's management object
+      Check for an exact match. If so, add the plugin's management object
       to the parameter block and ask for an object. If we're successful, we need
       one last step for a C plugin --- wrap it for C++ use.
     */
-    RegistrationMap::iterator apiIter = apiEntryExists(exactMatchMap_,
-                                        apiStr, libID) ;
-    if (apiIter != exactMatchMap_.end()) {
-        RegisterParams &rp = apiIter->second ;
-        ObjectParams *objParms = buildObjectParams(apiStr, rp) ;
-        void *object = rp.createFunc_(objParms) ;
-        delete objParms ;
+    const RegisterParams *exact = reg->exactMatchMap_.find(api, libID) ;
+    if (exact != nullptr && !reg->pools_.empty())
+        exact = pickPoolCopy(*reg, api, libID, exact) ;
+    /*
+      A placeholder for a library whose loading was deferred. Load it and try
+      again. completeLoad guarantees the placeholder is gone, so this can't
+      happen twice for the same library.
+    */
+    if (exact != nullptr && exact->createFunc_ == nullptr) {
+        PluginUniqueID pending = exact->pluginID_ ;
+        endRead(parity) ;
+        timer.cancel() ;
+        completeLoad(pending) ;
+        return (createObject(api, libID, adapter)) ;
+    }
+    if (exact != nullptr && !memAdmits(exact->pluginID_, apiStr)) {
+        endRead(parity) ;
+        return (nullptr) ;
+    }
+    if (exact != nullptr) {
+        const RegisterParams &rp = *exact ;
+        PlatformServices services ;
+        ObjectParams objParms ;
+        buildObjectParams(*reg, api, rp, objParms, services) ;
+        void *object = rp.createFunc_(&objParms) ;
         if (object) {
-            msgHandler_->message(PLUGMGR_APICREATEOK, msgs_)
+            PLUGMGR_MSG(PLUGMGR_APICREATEOK)
                     << apiStr << "exact" << CoinMessageEol ;
-	    if (libID == 0) libID = rp.pluginID_ ;
+            timer.succeeded(perfSlotOf(rp.pluginID_), 1) ;
+            adjustLibLive(rp.pluginID_, 1) ;
+            libID = rp.pluginID_ ;
             if (rp.lang_ == Plugin_C)
                 object = adapter.adapt(object, rp.destroyFunc_) ;
+            endRead(parity) ;
             return (object) ;
         }
     }
     /*
       No exact match. Try for a wildcard match. If some plugin volunteers an
       object, register it. As with exact match, respect a restriction to a
-      particular plugin library.
+      particular plugin library. A plugin that has already declined this API
+      isn't asked again. A plugin that supplies a capability function is
+      asked that first, so that it needn't build an object just to refuse or
+      to have it thrown away.
 
       Surely we could do better here than just blindly calling create functions?
       Maybe not. It's not really all that different from having a separate `Can
@@ -722,80 +2320,200 @@ void *PluginManager::createObject (const std::string &apiStr,
       adapter object and give the adapter's delete the responsibility for
       calling the proper destroyFunc?   -- lh, 111013 --
     */
-    for (size_t i = 0 ; i < wildCardVec_.size() ; ++i) {
-        RegisterParams &rp = wildCardVec_[i] ;
+    for (size_t i = 0 ; i < reg->wildCardVec_.size() ; ++i) {
+        const RegisterParams &rp = reg->wildCardVec_[i] ;
         if (libID && rp.pluginID_ != libID) continue ;
-        ObjectParams *objParms = buildObjectParams(apiStr, rp) ;
-        void *object = rp.createFunc_(objParms) ;
-        if (object) {
-            msgHandler_->message(PLUGMGR_APICREATEOK, msgs_)
-                    << apiStr << "wildcard" << CoinMessageEol ;
-	    if (libID == 0) libID = rp.pluginID_ ;
-            if (rp.lang_ == Plugin_C)
-                object = adapter.adapt(object, rp.destroyFunc_) ;
-            int32_t res = registerObject(objParms->apiStr_, &rp) ;
-            if (res < 0) {
-                rp.destroyFunc_(object, objParms) ;
-                object = nullptr ;
-            }
+        timer.setOp(PerfStats::CreateWildcard) ;
+        if (rp.createFunc_ == nullptr) {
+            PluginUniqueID pending = rp.pluginID_ ;
+            endRead(parity) ;
+            timer.cancel() ;
+            completeLoad(pending) ;
+            return (createObject(api, libID, adapter)) ;
+        }
+        if (isDeclined(*reg, api, rp.pluginID_)) continue ;
+        if (!memAdmits(rp.pluginID_, apiStr)) continue ;
+        PlatformServices services ;
+        ObjectParams objParms ;
+        buildObjectParams(*reg, api, rp, objParms, services) ;
+        void *object = nullptr ;
+        if (rp.capabilityFunc_ == nullptr ||
+                rp.capabilityFunc_(&objParms) != 0)
+            object = rp.createFunc_(&objParms) ;
+        if (object == nullptr) {
+            noteDeclined(*reg, api, rp.pluginID_) ;
+            continue ;
+        }
+        PLUGMGR_MSG(PLUGMGR_APICREATEOK)
+                << apiStr << "wildcard" << CoinMessageEol ;
+        if (libID == 0) libID = rp.pluginID_ ;
+        if (rp.lang_ == Plugin_C)
+            object = adapter.adapt(object, rp.destroyFunc_) ;
+        int32_t res = promoteWildcard(api, rp) ;
+        if (res < 0) {
+            rp.destroyFunc_(object, &objParms) ;
+            object = nullptr ;
+        } else {
+            timer.succeeded(perfSlotOf(rp.pluginID_), 1) ;
+            adjustLibLive(rp.pluginID_, 1) ;
         }
-        delete objParms ;
+        endRead(parity) ;
         return (object) ;
     }
+    endRead(parity) ;
     /*
       No plugin volunteered. We can't create this object.
     */
-    msgHandler_->message(PLUGMGR_APICREATEFAIL, msgs_)
+    PLUGMGR_MSG(PLUGMGR_APICREATEFAIL)
             << apiStr << "no capable plugin" << CoinMessageEol ;
     return (nullptr) ;
 }
 
-#ifdef UNDEFINED
-
 /*
-  Presumably this avoids requiring the client to cast to the appropriate type.
-  Might be worth exploring.  -- lh, 110929 --
+  Batch creation. Each round either creates what it can from an exact match
+  registration in one read-side section, or, if there's none yet, falls
+  back on createObject for a single object; that loads a deferred library
+  or promotes a wildcard, and the next round finds the exact match.
 */
-template <typename T, typename U>
-T *PluginManager::createObject(const std::string & apiStr, IObjectAdapter<T, U> & adapter)
+int PluginManager::createObjects (const std::string &apiStr,
+                                  PluginUniqueID libID, int count,
+                                  std::vector<void *> &objects,
+                                  std::vector<PluginUniqueID> &libIDs,
+                                  IObjectAdapter &adapter)
 {
-    // "*" is not a valid object type
-    if (apiStr == std::string("*"))
-        return (nullptr) ;
+    if (apiStr == "*") {
+        PLUGMGR_MSG(PLUGMGR_APICREATEFAIL)
+                << apiStr << "wildcard is invalid for createObjects"
+                << CoinMessageEol ;
+        return (0) ;
+    }
+    if (count <= 0) return (0) ;
+    /*
+      As for createObject, don't intern a name until some plugin has
+      supplied an object for it.
+    */
+    APIHandle api = findAPIHandle(apiStr) ;
+    if (api < 0) {
+        PluginUniqueID objLib = libID ;
+        void *object = createObject(apiStr, objLib, adapter) ;
+        if (object == nullptr) return (0) ;
+        objects.push_back(object) ;
+        libIDs.push_back(objLib) ;
+        return (1 + createObjects(findAPIHandle(apiStr), libID, count-1,
+                                  objects, libIDs, adapter)) ;
+    }
+    return (createObjects(api, libID, count, objects, libIDs, adapter)) ;
+}
 
-    // Prepare object params
-    ObjectParams np ;
-    np.apiStr = apiStr.c_str() ;
-    np.platformServices = &ServiceProvider::getInstance() ;
-
-    // Exact match found
-    if (exactMatchMap_.find(apiStr) != exactMatchMap_.end()) {
-        RegisterParams & rp = exactMatchMap_[apiStr] ;
-        IObject * object = createObject(rp, np, adapter) ;
-        if (object) // great, it worked
-            return object ;
-    }
-
-    for (Size i = 0; i < wildCardVec_.size(); ++i) {
-        RegisterParams & rp = wildCardVec_[i] ;
-        IObject * object = createObject(rp, np, adapter) ;
-        if (object) { // great, it worked
-            // promote registration to exactMatc_
-            // (but keep also the wild card registration for other object types)
-            int32_t res = registerObject(np.apiStr, &rp) ;
-            if (res < 0) {
-                THROW << "PluginManager::createObject(" << np.apiStr << "), registration failed" ;
-                delete object ;
-                return (nullptr) ;
+int PluginManager::createObjects (APIHandle api, PluginUniqueID libID,
+                                  int count, std::vector<void *> &objects,
+                                  std::vector<PluginUniqueID> &libIDs,
+                                  IObjectAdapter &adapter)
+{
+    int made = 0 ;
+    while (made < count) {
+        const int batch = createBatch(api, libID, count-made, objects,
+                                      libIDs, adapter) ;
+        if (batch == 0) break ;
+        if (batch > 0) {
+            made += batch ;
+            continue ;
+        }
+        PluginUniqueID objLib = libID ;
+        void *object = createObject(api, objLib, adapter) ;
+        if (object == nullptr) break ;
+        objects.push_back(object) ;
+        libIDs.push_back(objLib) ;
+        made++ ;
+    }
+    return (made) ;
+}
+
+/*
+  Pools are handled one object at a time, so that the copies take turns;
+  a bulk constructor is used only when all the objects can come from the
+  one library.
+*/
+int PluginManager::createBatch (APIHandle api, PluginUniqueID libID,
+                                int count, std::vector<void *> &objects,
+                                std::vector<PluginUniqueID> &libIDs,
+                                IObjectAdapter &adapter)
+{
+    PerfTimer timer(perfStats_, PerfStats::CreateExact) ;
+    int parity ;
+    const Registry *reg = beginRead(parity) ;
+
+    const RegisterParams *exact = nullptr ;
+    if (api >= 0 && static_cast<size_t>(api) < reg->apiNames_.size())
+        exact = reg->exactMatchMap_.find(api, libID) ;
+    if (exact == nullptr || exact->createFunc_ == nullptr) {
+        endRead(parity) ;
+        timer.cancel() ;
+        return (-1) ;
+    }
+    const std::string &apiStr = *reg->apiNames_[api] ;
+    TraceSpan span("object", "createBatch", apiStr.c_str()) ;
+    const bool pooled =
+        (!reg->pools_.empty() && reg->pools_.count(exact->pluginID_) != 0) ;
+    if (!pooled && !memAdmits(exact->pluginID_, apiStr)) {
+        endRead(parity) ;
+        timer.cancel() ;
+        return (0) ;
+    }
+    PlatformServices services ;
+    ObjectParams objParms ;
+    int made = 0 ;
+    if (!pooled && exact->bulkCreateFunc_ != nullptr) {
+        buildObjectParams(*reg, api, *exact, objParms, services) ;
+        std::vector<void *> batch(count, nullptr) ;
+        int32_t numMade = exact->bulkCreateFunc_(&objParms, count, &batch[0]) ;
+        if (numMade < 0) numMade = 0 ;
+        if (numMade > count) numMade = count ;
+        for (made = 0 ; made < numMade ; made++) {
+            void *object = batch[made] ;
+            if (exact->lang_ == Plugin_C)
+                object = adapter.adapt(object, exact->destroyFunc_) ;
+            objects.push_back(object) ;
+            libIDs.push_back(exact->pluginID_) ;
+        }
+        if (made > 0) {
+            timer.succeeded(perfSlotOf(exact->pluginID_), made) ;
+            adjustLibLive(exact->pluginID_, made) ;
+        }
+    } else {
+        const RegisterParams *last = nullptr ;
+        for ( ; made < count ; made++) {
+            const RegisterParams *rp =
+                pooled ? pickPoolCopy(*reg, api, libID, exact) : exact ;
+            if (pooled && !memAdmits(rp->pluginID_, apiStr)) break ;
+            if (rp != last) {
+                buildObjectParams(*reg, api, *rp, objParms, services) ;
+                last = rp ;
             }
-            return object ;
+            void *object = rp->createFunc_(&objParms) ;
+            if (object == nullptr) break ;
+            if (rp->lang_ == Plugin_C)
+                object = adapter.adapt(object, rp->destroyFunc_) ;
+            objects.push_back(object) ;
+            libIDs.push_back(rp->pluginID_) ;
+            adjustLibLive(rp->pluginID_, 1) ;
+            if (pooled && perfStats_.isEnabled())
+                perfStats_.adjustLive(perfSlotOf(rp->pluginID_), 1) ;
         }
+        if (made > 0)
+            timer.succeeded(perfSlotOf(exact->pluginID_), pooled ? 0 : made) ;
     }
+    endRead(parity) ;
 
-    // Too bad no one can create this objectType
-    return (nullptr) ;
+    if (made > 0) {
+        PLUGMGR_MSG(PLUGMGR_APIBATCHOK)
+                << made << count << apiStr << CoinMessageEol ;
+    } else {
+        PLUGMGR_MSG(PLUGMGR_APICREATEFAIL)
+                << apiStr << "CreateFunc failed" << CoinMessageEol ;
+    }
+    return (made) ;
 }
-#endif
 
 
 /*
@@ -810,47 +2528,193 @@ T *PluginManager::createObject(const std::string & apiStr, IObjectAdapter<T, U>
 int PluginManager::destroyObject (const std::string &apiStr,
                                   PluginUniqueID libID, void *victim)
 {
-    int result = 0 ;
-    RegistrationMap::iterator apiIter = apiEntryExists(exactMatchMap_,
-                                        apiStr, libID) ;
-    if (apiIter == exactMatchMap_.end()) {
-        msgHandler_->message(PLUGMGR_APIDELFAIL, msgs_)
+    APIHandle api = findAPIHandle(apiStr) ;
+    if (api < 0) {
+        PLUGMGR_MSG(PLUGMGR_APIDELFAIL)
                 << apiStr << "no such API" << CoinMessageEol ;
+        return (-1) ;
+    }
+    return (destroyObject(api, libID, victim)) ;
+}
+
+int PluginManager::destroyObject (APIHandle api, PluginUniqueID libID,
+                                  void *victim)
+{
+    int result = 0 ;
+    const std::string &apiStr = getAPIName(api) ;
+    PerfTimer timer(perfStats_, PerfStats::DestroyObject) ;
+    int parity ;
+    const Registry *reg = beginRead(parity) ;
+    const RegisterParams *rp = reg->exactMatchMap_.find(api, libID) ;
+    if (rp == nullptr && libID != 0 && reg->retiredMap_.size() > 0)
+        rp = reg->retiredMap_.find(api, libID) ;
+    bool found = (rp != nullptr && rp->destroyFunc_ != nullptr) ;
+    bool lastOfLib = false ;
+    if (!found) {
         result = -1 ;
     } else {
-        RegisterParams &rp = apiIter->second ;
-        ObjectParams *objParms = buildObjectParams(apiStr, rp) ;
-        result = rp.destroyFunc_(victim, objParms) ;
-        if (result < 0) {
-            msgHandler_->message(PLUGMGR_APIDELFAIL, msgs_)
-                    << apiStr << "DestroyFunc failed" << CoinMessageEol ;
+        PlatformServices services ;
+        ObjectParams objParms ;
+        buildObjectParams(*reg, api, *rp, objParms, services) ;
+        result = rp->destroyFunc_(victim, &objParms) ;
+        const int slot = perfSlotOf(rp->pluginID_) ;
+        if (result >= 0) {
+            releaseObjMem(rp->pluginID_, victim) ;
+            timer.succeeded(slot, -1) ;
+            lastOfLib = adjustLibLive(rp->pluginID_, -1) ;
+        } else {
+            timer.setSlot(slot) ;
         }
     }
-    if (result >= 0)
-        msgHandler_->message(PLUGMGR_APIDELOK, msgs_) << apiStr << CoinMessageEol ;
+    endRead(parity) ;
+    if (lastOfLib) closeRetired() ;
+
+    if (!found) {
+        PLUGMGR_MSG(PLUGMGR_APIDELFAIL)
+                << apiStr << "no such API" << CoinMessageEol ;
+    } else if (result < 0) {
+        PLUGMGR_MSG(PLUGMGR_APIDELFAIL)
+                << apiStr << "DestroyFunc failed" << CoinMessageEol ;
+    }
+    if (result >= 0) {
+        PLUGMGR_MSG(PLUGMGR_APIDELOK) << apiStr << CoinMessageEol ;
+    }
 
     return (result) ;
 }
 
 
+/*
+  Consecutive objects usually come from the same library, so look up the
+  registration again only when the library changes.
+*/
+int PluginManager::destroyObjects (APIHandle api,
+                                   std::vector<void *> &victims,
+                                   const std::vector<PluginUniqueID> &libIDs)
+{
+    if (victims.empty()) return (0) ;
+    const std::string &apiStr = getAPIName(api) ;
+    int destroyed = 0 ;
+    int failed = 0 ;
+    PerfTimer timer(perfStats_, PerfStats::DestroyObject) ;
+    int parity ;
+    const Registry *reg = beginRead(parity) ;
+    const RegisterParams *rp = nullptr ;
+    PluginUniqueID current = nullptr ;
+    PlatformServices services ;
+    ObjectParams objParms ;
+    bool lastOfLib = false ;
+    for (size_t i = 0 ; i < victims.size() ; i++) {
+        const PluginUniqueID objLib = (i < libIDs.size()) ? libIDs[i] : 0 ;
+        if (rp == nullptr || objLib != current) {
+            current = objLib ;
+            rp = reg->exactMatchMap_.find(api, objLib) ;
+            if (rp == nullptr && objLib != 0 && reg->retiredMap_.size() > 0)
+                rp = reg->retiredMap_.find(api, objLib) ;
+            if (rp != nullptr && rp->destroyFunc_ != nullptr)
+                buildObjectParams(*reg, api, *rp, objParms, services) ;
+        }
+        if (rp == nullptr || rp->destroyFunc_ == nullptr ||
+                rp->destroyFunc_(victims[i], &objParms) < 0) {
+            failed++ ;
+            rp = nullptr ;
+            continue ;
+        }
+        releaseObjMem(rp->pluginID_, victims[i]) ;
+        victims[i] = nullptr ;
+        destroyed++ ;
+        if (adjustLibLive(rp->pluginID_, -1)) lastOfLib = true ;
+        if (perfStats_.isEnabled())
+            perfStats_.adjustLive(perfSlotOf(rp->pluginID_), -1) ;
+    }
+    endRead(parity) ;
+    if (lastOfLib) closeRetired() ;
+    if (destroyed > 0 && current != nullptr)
+        timer.succeeded(perfSlotOf(current)) ;
+
+    if (failed > 0) {
+        PLUGMGR_MSG(PLUGMGR_APIDELFAIL)
+                << apiStr << "DestroyFunc failed or no such API"
+                << CoinMessageEol ;
+    }
+    if (destroyed > 0) {
+        PLUGMGR_MSG(PLUGMGR_APIBATCHDEL)
+                << destroyed << apiStr << CoinMessageEol ;
+    }
+
+    return ((failed > 0) ? -1 : 0) ;
+}
+
+PluginUniqueID PluginManager::selectLib (const std::string &apiStr,
+                                         const PluginCaps &need) const
+{
+    return (selectLib(findAPIHandle(apiStr), need)) ;
+}
+
+PluginUniqueID PluginManager::selectLib (APIHandle api,
+                                         const PluginCaps &need) const
+{
+    std::vector<PluginUniqueID> libIDs ;
+    if (rankLibs(api, need, libIDs) == 0) return (0) ;
+    return (libIDs.front()) ;
+}
+
+int PluginManager::findLibs (const std::string &apiStr, const PluginCaps &need,
+                             std::vector<PluginUniqueID> &libIDs) const
+{
+    return (rankLibs(findAPIHandle(apiStr), need, libIDs)) ;
+}
+
+/*
+  Exact registrations are looked at first, and the sort is stable, so that
+  on a tie in cost they win over wildcards. An API the manager has never
+  seen (api < 0) can only go to a wildcard.
+*/
+int PluginManager::rankLibs (APIHandle api, const PluginCaps &need,
+                             std::vector<PluginUniqueID> &libIDs) const
+{
+    int parity ;
+    const Registry *reg = beginRead(parity) ;
+    std::vector<const RegisterParams *> cands ;
+    reg->exactMatchMap_.findAll(api, cands) ;
+    for (size_t i = 0 ; i < reg->wildCardVec_.size() ; i++) {
+        const RegisterParams &rp = reg->wildCardVec_[i] ;
+        if (api >= 0 && isDeclined(*reg, api, rp.pluginID_)) continue ;
+        cands.push_back(&rp) ;
+    }
+    std::vector<std::pair<int64_t, PluginUniqueID> > ranked ;
+    for (size_t i = 0 ; i < cands.size() ; i++) {
+        const RegisterParams &rp = *cands[i] ;
+        if (!capsCover(rp.caps_, need)) continue ;
+        ranked.push_back(std::make_pair(capsCost(rp.caps_), rp.pluginID_)) ;
+    }
+    endRead(parity) ;
+    std::stable_sort(ranked.begin(), ranked.end(), CostLess()) ;
+    int found = 0 ;
+    std::set<PluginUniqueID> seen ;
+    for (size_t i = 0 ; i < ranked.size() ; i++) {
+        if (!seen.insert(ranked[i].second).second) continue ;
+        libIDs.push_back(ranked[i].second) ;
+        found++ ;
+    }
+    return (found) ;
+}
+
 PlatformServices &PluginManager::getPlatformServices ()
 {
     return (platformServices_) ;
 }
 
 /*
-  Find the full path for the library specified by libID.
+  Find the full path for the library specified by libID. Every library,
+  each copy of a pool included, is in the library map under its ID.
 */
 std::string PluginManager::getLibPath (PluginUniqueID libID)
 {
-    typedef LibPathToIDMap::const_iterator LPTIMI ;
-    /*
-      Step through the map and find the matching entry.
-    */
-    for (LPTIMI iter = libPathToIDMap_.begin() ;
-         iter != libPathToIDMap_.end() ; iter++) {
-        if (iter->second == libID) return (iter->first) ;
-    }
+    WriteGuard guard(writeMutex_) ;
+    DynamicLibraryMap::const_iterator dlmIter = dynamicLibraryMap_.find(libID) ;
+    if (dlmIter != dynamicLibraryMap_.end())
+        return (dlmIter->second.libPath_) ;
     return ("<library not loaded>") ;
 }
 
@@ -16,15 +16,25 @@
 #define OSI2PLUGINMANAGER_HPP
 
 #include <vector>
+#include <deque>
 #include <map>
+#include <set>
 #include "Osi2PlugMgrMessages.hpp"
 #include "Osi2Plugin.hpp"
+#include "Osi2ApiTraits.hpp"
+#include "Osi2ObjectAdapter.hpp"
+#include "Osi2RegistrationTable.hpp"
+#include "Osi2Threads.hpp"
+#include "Osi2PerfStats.hpp"
+#include "Osi2MemAccount.hpp"
+#include "Osi2ThreadPool.hpp"
+#include "Osi2LogSink.hpp"
+#include "Osi2DirCache.hpp"
 
 
 namespace Osi2 {
 
 class DynamicLibrary ;
-struct IObjectAdapter ;
 
 
 /*! \brief Plugin library manager
@@ -45,18 +55,62 @@ struct IObjectAdapter ;
   APIs are registered by plugin libraries; a character string identifies each
   API. If the registration string is exactly "*", the registration is classed
   as a wildcard and entered in the #wildCardVec_. Otherwise, it will be
-  entered in the #exactMatchMap_ using the character string as the key.
+  entered in the #exactMatchMap_. Internally, API names are interned: each
+  distinct name is assigned a small integer APIHandle the first time it's
+  seen, and #exactMatchMap_ is keyed by the pair (handle, PluginUniqueID).
+  Clients that create objects at a high rate should obtain the handle once
+  with #getAPIHandle and use the handle overloads of #createObject and
+  #destroyObject.
 
   Clients request an object supporting a specific API by specifying a
   character string.  If an exact match for the API requested by the client
   is not found in #exactMatchMap_, the #wildCardVec_ is scanned. For each
-  entry, the corresponding create function is asked to create an object
-  supporting the requested API. If this is successful, an entry is made in the
-  #exactMatchMap_ so that subsequent requests for the same API can be
-  satisfied more efficiently.
+  entry, the corresponding capability function (if the plugin supplied one)
+  is asked whether the plugin supports the requested API; if so, or if there
+  is no capability function, the create function is asked to create an
+  object. If this is successful, an entry is made in the #exactMatchMap_ so
+  that subsequent requests for the same API can be satisfied more
+  efficiently. If the plugin declines, that's recorded in the
+  #declineCache_ and the plugin isn't asked again about the same API until
+  a library is loaded or unloaded.
 
   Any request for an object supporting a particular API can be qualified with
   a request that the object be supplied by a particular library.
+
+  A plugin library can be accompanied by a manifest, a text file in the same
+  directory named by appending ".manifest" to the library file name. The
+  manifest lists the APIs the library will register. When a manifest is
+  present (and lazy loading is enabled; see #setLazyLoad), #loadOneLib
+  enters the APIs listed in the manifest as placeholder registrations and
+  does not load the library. The library is loaded and initialised the first
+  time a client request selects one of the placeholders; the placeholders are
+  then replaced by the library's actual registrations. The manifest format is
+  line oriented; blank lines and lines starting with '#' are ignored:
+  <pre>
+    version <major> <minor>
+    api <API name> <C | C++>
+    ...
+  </pre>
+  An API name of "*" is a wildcard registration. The major version must
+  match the plugin manager's.
+
+  The factory methods (#createObject, #destroyObject) and the API name
+  lookup methods can be called concurrently from any number of threads.
+  Everything a reader needs (the exact match table, the wildcard vector,
+  the API names, and the library state objects) is held in an immutable
+  Registry snapshot. Readers announce themselves by incrementing a counter
+  for the current epoch, use whatever snapshot is current, and decrement the
+  counter when finished; no lock is taken. Operations that change the
+  registry (library load and unload, API registration, wildcard promotion,
+  interning a new API name) serialise on a writer lock, build a modified
+  copy of the snapshot, and publish it. The old snapshot is reclaimed (and
+  a library being unloaded is actually closed) only after a grace period
+  has elapsed in which every reader that might have seen it has finished.
+  Each call into a plugin receives its own PlatformServices block.
+
+  The control methods (#setLogLvl, #setMsgHandler, #setDfltPluginDir) are
+  not synchronised and should not be called while other threads are using
+  the manager.
 */
 
 class PluginManager {
@@ -88,7 +142,12 @@ public:
     /// Return full path for a library
     std::string getLibPath(PluginUniqueID libID) ;
 
-    /// Get the services provided by the plugin manager
+    /*! \brief Get the services provided by the plugin manager
+
+      This is the template used to build the PlatformServices block handed to
+      a plugin; the library-specific fields (\c pluginID_, \c ctrlObj_) are
+      not meaningful.
+    */
     PlatformServices &getPlatformServices() ;
 
     /*! \brief Load and initialise the specified plugin library.
@@ -97,7 +156,14 @@ public:
       #dfltPluginDir_ is used.
 
       The PluginUniqueID assigned to the library will be returned in \p uniqueID
-      if a parameter is supplied.
+      if a parameter is supplied. If the library is already loaded, its
+      existing ID is returned.
+
+      If the library has a manifest and lazy loading is enabled, the APIs
+      listed in the manifest are registered and loading of the library is
+      deferred until one of them is requested. Errors in loading or
+      initialising a deferred library are reported when it's loaded. The
+      unique ID is assigned immediately and does not change.
 
       \return
       - -3: initialisation function failed
@@ -112,23 +178,145 @@ public:
     int loadOneLib(const std::string &lib, const std::string *dir = 0,
                    PluginUniqueID *uniqueID = 0) ;
 
+    /*! \brief Load a pool of isolated copies of a plugin library
+
+      Loads \p copies independent copies of the library \c dir/lib, each in
+      a linker namespace of its own (see DynamicLibrary::load). Everything
+      the plugin loads, the solver library in particular, is loaded into the
+      same namespace, so each copy has its own global state and a solver
+      that isn't reentrant can run in several threads at once, one per copy.
+
+      Each copy has its own unique ID and registers its own APIs. The unique
+      ID of the first copy identifies the pool and is returned in \p
+      uniqueID. A request for an object restricted to the pool's ID, or with
+      no restriction that resolves to the pool, is satisfied by the copies in
+      turn (round robin); the unique ID of the copy actually used is returned
+      from #createObject, and must be used to destroy the object. Objects
+      from an isolated copy must be destroyed with #destroyObject, not with
+      \c delete: each copy has its own heap. Unloading the library (with
+      #unloadOneLib, by path) unloads every copy.
+
+      Manifests are ignored; the copies are loaded immediately. If some but
+      not all copies can be loaded (the platform limits the number of
+      namespaces), the pool is made from those that could be, with a
+      warning.
+
+      \return
+      - -4: isolated loading is not supported on this platform
+      - -3: initialisation function failed
+      - -2: failed to find the initialisation function
+      - -1: library failed to load
+      -  0: at least one copy loaded and initialised without error
+      -  1: library is already loaded
+    */
+    int loadLibPool(const std::string &lib, const std::string *dir,
+                    int copies, PluginUniqueID *uniqueID = 0) ;
+
+    /*! \brief Number of copies in the pool containing library \p libID
+
+      1 if the library is loaded but not part of a pool, 0 if the library
+      isn't loaded.
+    */
+    int getPoolSize(PluginUniqueID libID) ;
+
     /*! \brief Load and initialise all plugin libraries in the directory.
 
-      \todo
-      Unimplemented until we can create platform-independent file
-      system support. For that matter, it's questionable whether we want this
-      functionality.
+      Every file in \p pluginDirectory with the platform's dynamic library
+      extension is a candidate. The candidates are loaded in parallel. Those
+      that turn out not to be plugin libraries (no \c initPlugin function)
+      are quietly closed again. The initialisation functions of the rest are
+      run one at a time, in lexicographic order of file name, and all the
+      registrations are made visible to clients together. Libraries that are
+      already loaded are skipped. Load and initialisation times for each
+      library are reported through the message handler. Libraries with a
+      manifest are handled as for #loadOneLib: if lazy loading is enabled,
+      loading is deferred.
+
+      If \p func is supplied, services a plugin asks for that aren't
+      registered with the manager (see #registerService) are passed to it.
+
+      \return
+      - -1: the directory could not be read
+      -  0: all plugin libraries loaded and initialised without error
+      -  1: one or more libraries failed to load or initialise
     */
     int loadAllLibs(const std::string &pluginDirectory,
                     const InvokeServiceFunc func = NULL) ;
 
+    /*! \brief Plugin libraries in a directory that have changed
+
+      Appends to \p libs the file names of the candidate libraries in
+      \p pluginDirectory (default: the default plugin directory) that have
+      appeared, disappeared, or been rewritten, or whose manifest has, since
+      the previous call for the directory. The first call (or #loadAllLibs)
+      establishes the baseline and reports nothing. Directory listings are
+      cached, and where the platform allows the directory is watched, so a
+      call with nothing to report costs no more than a check of the watch.
+
+      \return 0, or -1 if the directory can't be read.
+    */
+    int getPluginDirChanges(const std::string &pluginDirectory,
+                            std::vector<std::string> &libs) ;
+
     /*! \brief unload the specified plugin library
 
       Removes all APIs registered by the specified plugin library, invokes the
-      library's Osi2::ExitFunc, and unloads the library.
+      library's Osi2::ExitFunc, and unloads the library. Safe to call while
+      other threads are creating objects; the library is not closed until
+      every call into it that might be using the old registrations has
+      returned. Must not be called from within a plugin's create or destroy
+      function.
     */
     int unloadOneLib(const std::string &lib, const std::string *dir = 0) ;
 
+    /*! \brief Replace a loaded plugin library with a new version
+
+      Loads the new version, \c dir/newLib, alongside the loaded library
+      \c dir/lib and initialises it. If that succeeds, the new version's
+      registrations replace the old version's in a single snapshot: from
+      then on every request for an object is satisfied by the new version,
+      and unloading \p lib unloads the new version. Clients are never
+      without a provider.
+
+      The old version is drained rather than closed. Objects it created
+      remain valid, and are destroyed as usual with #destroyObject, which
+      must be given the unique ID returned when the object was created (an
+      unrestricted destroy would find the new version). When the last of
+      them has been destroyed the old version's exit function is run and it
+      is closed. Objects still live at #shutdown are abandoned, as ever.
+
+      If \p newLib is null the new version is the same file, rebuilt in
+      place. The platform won't load a second copy of a file it already has
+      open, so in that case the new version is loaded in a linker namespace
+      of its own (see DynamicLibrary::load), with the same caveats as for
+      #loadLibPool. A deferred library is replaced immediately. A library
+      pool can't be reloaded.
+
+      The unique ID of the new version is returned in \p uniqueID. Must not
+      be called from within a plugin's create or destroy function.
+
+      \return
+      - -5: \p lib is not loaded or is a library pool, or \p newLib is
+            already loaded
+      - -4: \p newLib is null and isolated loading is not supported
+      - -3: initialisation function failed
+      - -2: failed to find the initialisation function
+      - -1: library failed to load
+      -  0: the new version is in service
+
+      In case of error the old version stays in service.
+    */
+    int reloadOneLib(const std::string &lib, const std::string *dir = 0,
+                     const std::string *newLib = 0,
+                     PluginUniqueID *uniqueID = 0) ;
+
+    /*! \brief Number of replaced library versions not yet closed
+
+      Those still waiting for their objects to be destroyed (see
+      #reloadOneLib).
+    */
+    int getNumRetiring() ;
+
     /*! \brief Shut down the plugin manager
 
       For each loaded plugin library, invoke the library's exit function and
@@ -136,6 +324,20 @@ public:
     */
     int shutdown() ;
 
+    /*! \brief Fork the process with the plugin manager in a consistent state
+
+      As fork(2), but the manager's locks are held across the fork, so the
+      child doesn't inherit a lock held by some other thread of the parent
+      (which the child, having only one thread, could never acquire). In the
+      child, read-side sections belonging to other threads of the parent are
+      forgotten. The child can then use the manager as usual. Must not be
+      called from within a read-side section (a plugin's create or destroy
+      function, for instance).
+
+      \return As fork(2); -1 on Windows.
+    */
+    int forkProcess() ;
+
     //@}
 
     /*! \name Factory methods
@@ -164,6 +366,15 @@ public:
     void *createObject(const std::string &apiStr, PluginUniqueID &libID,
                        IObjectAdapter &adapter) ;
 
+    /*! \brief Invoked by client to create an object
+
+      As the previous method, but the API is specified by a handle obtained
+      from #getAPIHandle. This avoids all string handling when an exact
+      match is registered.
+    */
+    void *createObject(APIHandle api, PluginUniqueID &libID,
+                       IObjectAdapter &adapter) ;
+
     /*! \brief Invoked by client to destroy an object
 
       This method should be invoked by the client to destroy an object. This
@@ -179,6 +390,168 @@ public:
     int destroyObject(const std::string &apiStr, PluginUniqueID libID,
                       void *victim) ;
 
+    /*! \brief Invoked by client to destroy an object
+
+      As the previous method, but the API is specified by a handle obtained
+      from #getAPIHandle.
+    */
+    int destroyObject(APIHandle api, PluginUniqueID libID, void *victim) ;
+
+    /*! \brief Invoked by client to create several objects at once
+
+      Creates up to \p count objects of the API, appending them to
+      \p objects and the unique ID of the library that supplied each one to
+      \p libIDs. \p libID restricts the choice of library as for
+      #createObject; the choice is made once for the batch. If the library
+      registered a \link Osi2::BulkCreateFunc bulk constructor \endlink,
+      it's asked for all the objects in one call. The copies of a library
+      pool (#loadLibPool) take turns, as with #createObject, so objects in a
+      batch can come from different copies.
+
+      Returns the number of objects created. Fewer than \p count means the
+      plugin ran out; the objects made are still valid.
+    */
+    int createObjects(const std::string &apiStr, PluginUniqueID libID,
+                      int count, std::vector<void *> &objects,
+                      std::vector<PluginUniqueID> &libIDs,
+                      IObjectAdapter &adapter) ;
+
+    /*! \brief Invoked by client to create several objects at once
+
+      As the previous method, but the API is specified by a handle obtained
+      from #getAPIHandle.
+    */
+    int createObjects(APIHandle api, PluginUniqueID libID, int count,
+                      std::vector<void *> &objects,
+                      std::vector<PluginUniqueID> &libIDs,
+                      IObjectAdapter &adapter) ;
+
+    /*! \brief Invoked by client to destroy several objects at once
+
+      Destroys \p victims[i], which came from library \p libIDs[i], for
+      each \p i, and sets \p victims[i] to null. Returns 0 if all went
+      well, -1 if any object could not be destroyed; those are left in
+      \p victims and the rest are destroyed regardless.
+    */
+    int destroyObjects(APIHandle api, std::vector<void *> &victims,
+                       const std::vector<PluginUniqueID> &libIDs) ;
+
+    /*! \brief Choose the library best suited to a request
+
+      Looks only at what the libraries declared when they registered
+      (RegisterParams::caps_); no object is created and no plugin is asked.
+      A library qualifies if it registered \p apiStr, or registered as a
+      wildcard and hasn't declined \p apiStr, and its descriptor covers
+      every problem class and property set in \p need. A library that
+      declared nothing (or whose loading was deferred) qualifies only if
+      \p need asks for nothing. Of those that qualify, the one with the
+      lowest total of the cost hints wins; ties go to an exact registration,
+      then to the earlier registration.
+
+      Returns the unique ID of the library chosen, suitable as the
+      restriction for #createObject, or 0 if no library qualifies.
+    */
+    PluginUniqueID selectLib(const std::string &apiStr,
+                             const PluginCaps &need) const ;
+
+    /*! \brief Choose the library best suited to a request
+
+      As the previous method, but the API is specified by a handle obtained
+      from #getAPIHandle.
+    */
+    PluginUniqueID selectLib(APIHandle api, const PluginCaps &need) const ;
+
+    /*! \brief List the libraries that could meet a request
+
+      As #selectLib, but every library that qualifies is appended to
+      \p libIDs, best first; a library with several qualifying
+      registrations appears once. Returns the number appended.
+    */
+    int findLibs(const std::string &apiStr, const PluginCaps &need,
+                 std::vector<PluginUniqueID> &libIDs) const ;
+
+    /*! \brief Create an object of API class \p T
+
+      As #createObject, but the API is named by its class (see ApiTraits)
+      and the object comes back as a \p T. The API's handle is looked up
+      once per plugin manager and kept in a slot indexed by
+      <tt>ApiTraits<T>::id</tt>, so after the first call there's no string
+      handling at all. Objects of a C plugin come back through \p adapter,
+      which must produce a \p T (CObjectAdapter, for example).
+    */
+    template <class T>
+    inline T *createObject (PluginUniqueID &libID, IObjectAdapter &adapter) {
+        void *object = createObject(getAPIHandle<T>(), libID, adapter) ;
+        return (static_cast<T *>(object)) ;
+    }
+
+    /// As the previous method, for C++ plugins
+    template <class T>
+    inline T *createObject (PluginUniqueID &libID) {
+        DummyAdapter dummy ;
+        return (createObject<T>(libID, dummy)) ;
+    }
+
+    /*! \brief Destroy an object made by the typed #createObject
+
+      Not for an object of a C plugin: pass the plugin's object, from
+      CObjectAdapter::release, to the untyped #destroyObject.
+    */
+    template <class T>
+    inline int destroyObject (PluginUniqueID libID, T *victim) {
+        return (destroyObject(getAPIHandle<T>(), libID,
+                              static_cast<void *>(victim))) ;
+    }
+
+    //@}
+
+    /*! \name API name interning
+
+      Methods to convert between API names and handles.
+    */
+    //@{
+
+    /*! \brief Get the handle for an API name
+
+      If the name has not been seen before, a new handle is assigned. A
+      handle, once assigned, remains valid for the life of the plugin
+      manager, even if no library currently registers the API. The wildcard
+      string "*" is not an API and yields -1.
+    */
+    APIHandle getAPIHandle(const std::string &apiStr) ;
+
+    /*! \brief Look up the handle for an API name
+
+      As #getAPIHandle, but a name that has not been seen before is not
+      interned; -1 is returned instead.
+    */
+    APIHandle findAPIHandle(const std::string &apiStr) const ;
+
+    /// Get the API name for a handle; the empty string if the handle is invalid
+    const std::string &getAPIName(APIHandle api) const ;
+
+    /// Bound on ApiTraits ids accepted by the typed methods
+    static const int maxApiID = 32 ;
+
+    /*! \brief Get the handle for API class \p T
+
+      As #getAPIHandle, for the name in <tt>ApiTraits<T></tt>. The handle
+      is remembered under <tt>ApiTraits<T>::id</tt>; an id out of range
+      doesn't compile.
+    */
+    template <class T>
+    inline APIHandle getAPIHandle () {
+        typedef char idInRange[(ApiTraits<T>::id > 0 &&
+                                ApiTraits<T>::id < maxApiID) ? 1 : -1] ;
+        (void) sizeof(idInRange) ;
+        volatile int *slot = &typedHandles_[ApiTraits<T>::id] ;
+        const int cached = atomicLoad(slot) ;
+        if (cached >= 0) return (cached) ;
+        const APIHandle api = getAPIHandle(std::string(ApiTraits<T>::name())) ;
+        *slot = api ;
+        return (api) ;
+    }
+
     //@}
 
     /*! \name Plugin manager control methods
@@ -191,6 +564,7 @@ public:
     inline void setLogLvl(int logLvl) {
         logLvl_ = logLvl ;
         msgHandler_->setLogLevel(logLvl_) ;
+        logSink_.setLogLevel(logLvl_) ;
     }
 
     /// Get the log (verbosity) level
@@ -217,6 +591,145 @@ public:
         return (dfltHandler_) ;
     }
 
+    /*! \brief Deliver the messages plugins have logged so far
+
+      Plugin messages (PlatformServices::log_) are queued and delivered to
+      the message handler from a background thread. This waits until
+      everything logged before the call has been delivered.
+    */
+    inline void flushPluginLog() {
+        logSink_.flush() ;
+    }
+
+    /// Number of plugin messages dropped because the queue was full
+    inline int getPluginLogDropped() const {
+        return (logSink_.getNumDropped()) ;
+    }
+
+    /*! \brief Enable or disable lazy loading
+
+      When enabled (the default), a library with a manifest is not loaded
+      until one of its APIs is requested. Affects subsequent calls to
+      #loadOneLib.
+    */
+    inline void setLazyLoad(bool lazyLoad) {
+        lazyLoad_ = lazyLoad ;
+    }
+
+    /// Report whether lazy loading is enabled
+    inline bool getLazyLoad() const {
+        return (lazyLoad_) ;
+    }
+
+    /// True if loading of library \p libID has been deferred and not completed
+    bool isDeferred(PluginUniqueID libID) ;
+
+    //@}
+
+    /*! \name Performance statistics
+
+      The plugin manager keeps, for each plugin library, counts and timings
+      of library loads, initialisation, object creation (exact and
+      wildcard), object destruction, and library unloads, along with the
+      number of live objects. See PerfStats for details.
+    */
+    //@{
+
+    /// Enable or disable collection of statistics (enabled by default)
+    inline void setPerfStatsEnabled(bool enabled) {
+        perfStats_.setEnabled(enabled) ;
+    }
+
+    /// Report whether statistics are being collected
+    inline bool getPerfStatsEnabled() const {
+        return (perfStats_.isEnabled()) ;
+    }
+
+    /// Collect the current statistics, one entry per plugin library
+    inline void getPerfStats(std::vector<PerfStats::LibStats> &stats) const {
+        perfStats_.getStats(stats) ;
+    }
+
+    //@}
+
+    /*! \name Memory accounting
+
+      Each plugin library has a MemAccount, charged by the plugin through
+      PlatformServices::chargeMem_ with the memory it and its objects hold.
+      A library over its soft limit is asked for no new objects; a library
+      can't make a charge that takes it over its hard limit. What an object
+      still holds when it's destroyed is released with it, its arena (see
+      ArenaPool) included. Each copy of a library pool has an account and
+      arenas of its own.
+    */
+    //@{
+
+    /*! \brief Set the limits for libraries loaded from now on
+
+      In bytes; 0 for no limit. Libraries already loaded keep theirs.
+    */
+    inline void setDfltMemLimits (int64_t softLimit, int64_t hardLimit) {
+        dfltSoftMemLimit_ = softLimit ;
+        dfltHardMemLimit_ = hardLimit ;
+    }
+
+    /*! \brief Set the limits for library \p libID
+
+      In bytes; 0 for no limit. A library already over a new limit keeps
+      what it has. Returns 0, or -1 if the library isn't loaded.
+    */
+    int setMemLimits(PluginUniqueID libID, int64_t softLimit,
+                     int64_t hardLimit) ;
+
+    /*! \brief Get the memory account of library \p libID
+
+      Returns 0, or -1 if the library isn't loaded.
+    */
+    int getMemUsage(PluginUniqueID libID, MemAccount::Usage &usage) ;
+
+    /*! \brief Bytes held by object \p obj of library \p libID
+
+      \p obj is the object as the plugin manager handed it out. Returns -1
+      if the library isn't loaded.
+    */
+    int64_t getObjMemUsage(PluginUniqueID libID, const void *obj) ;
+
+    //@}
+
+    /*! \name Services
+
+      Plugins reach services by name through PlatformServices::invokeService_.
+      The manager registers OSI2_THREADPOOL_SERVICE, its thread pool; the
+      client can register more.
+    */
+    //@{
+
+    /*! \brief A service
+
+      Called with the context given to #registerService and the plugin's
+      parameter block.
+    */
+    typedef int32_t (*ServiceFunc)(void *ctx, void *serviceParams) ;
+
+    /*! \brief Register a service as \p name
+
+      Returns 0, or -1 if there's a service with that name already.
+    */
+    int registerService(const std::string &name, ServiceFunc func,
+                        void *ctx) ;
+
+    /// Withdraw the service \p name; returns 0, or -1 if there's no such service
+    int unregisterService(const std::string &name) ;
+
+    /*! \brief The thread pool shared with plugins
+
+      Size it (ThreadPool::setNumThreads) before plugins start handing it
+      work; each plugin learns the size when it first finds the pool.
+    */
+    inline ThreadPool &getThreadPool () {
+        return (threadPool_) ;
+    }
+
     //@}
 
 private:
@@ -227,6 +740,177 @@ private:
     static int32_t registerObject(const CharString *nodeType,
                                   const RegisterParams *params) ;
 
+    /*! \brief Register an object type with the plugin manager
+
+      Does the work for #registerObject once the API string has been
+      resolved. Also used to promote a successful wildcard creation to an
+      exact match registration.
+    */
+    int32_t registerObject(APIHandle api, const RegisterParams *params) ;
+
+    /*! \brief Log a message for a plugin
+
+      Invoked by plugins (PlatformServices::log_); queues the message in
+      #logSink_.
+    */
+    static int32_t logMessage(int32_t level, const CharString *msg) ;
+
+    /*! \brief Charge memory to a plugin library
+
+      Invoked by plugins (PlatformServices::chargeMem_); charges the
+      library's MemAccount. A charge refused for the hard limit rates a
+      warning.
+    */
+    static int32_t chargeMemory(PluginUniqueID pluginID, const void *owner,
+                                int64_t bytes) ;
+
+    /*! \brief Allocate from a plugin library's arena
+
+      Invoked by plugins (PlatformServices::arenaAlloc_); allocates from the
+      library's ArenaPool. A chunk refused for the hard limit rates a
+      warning.
+    */
+    static void *arenaAlloc(PluginUniqueID pluginID, const void *owner,
+                            size_t bytes) ;
+
+    /// Release an arena; invoked by plugins (PlatformServices::arenaRelease_)
+    static int32_t arenaRelease(PluginUniqueID pluginID, const void *owner) ;
+
+    /*! \brief Invoke a service
+
+      Invoked by plugins (PlatformServices::invokeService_). A service not
+      registered goes to the client's function, if there is one (see
+      #loadAllLibs).
+    */
+    static int32_t invokeService(const CharString *serviceName,
+                                 void *serviceParams) ;
+
+    /// The thread pool service; fills in a ThreadPoolService
+    static int32_t threadPoolService(void *ctx, void *serviceParams) ;
+
+    /// \name Thread pool entry points handed out by #threadPoolService
+    //@{
+    static int32_t poolSubmit(TaskFunc func, void *arg, TaskGroup *group) ;
+    static int32_t poolWait(TaskGroup *group) ;
+    static int32_t poolRun(TaskFunc func, void **args, int32_t count) ;
+    //@}
+
+    /// Warn that a charge of \p bytes to \p dynLib was refused
+    static void noteMemRefused(DynamicLibrary *dynLib, int64_t bytes) ;
+
+    /*! \brief True if library \p libID may be asked for an object
+
+      False if it's over a memory limit (see MemAccount::admitsObject), with
+      a message saying why object \p apiStr can't be had from it.
+    */
+    bool memAdmits(PluginUniqueID libID, const std::string &apiStr) ;
+
+    /*! \brief Release what object \p obj of library \p libID holds
+
+      Its arena and whatever else is charged to it; called once the object
+      has been destroyed.
+    */
+    void releaseObjMem(PluginUniqueID libID, const void *obj) ;
+
+    /*! \brief Deliver a plugin message to the message handler
+
+      The delivery function for #logSink_.
+    */
+    static void deliverPluginLog(void *ctx, int level, const char *text) ;
+
+    /*! \brief Load and initialise a plugin library
+
+      Does the work of #loadOneLib once the full path is known. Must be called
+      with #writeMutex_ held. Return values as for #loadOneLib.
+    */
+    int loadOneLibLocked(const std::string &fullPath, PluginUniqueID *uniqueID) ;
+
+    /*! \brief Enter a library from its manifest
+
+      If lazy loading is enabled and \p fullPath has a usable manifest, enter
+      the library in the manager's bookkeeping without loading it and
+      register the APIs listed in the manifest as placeholders. Must be called
+      with #writeMutex_ held. Returns 0 if loading was deferred, 1 otherwise.
+    */
+    int deferOneLib(const std::string &fullPath, PluginUniqueID *uniqueID) ;
+
+    /*! \brief Complete loading of a deferred library
+
+      Load and initialise library \p libID, replacing its placeholder
+      registrations with its actual registrations. If the library fails to
+      load or initialise, its placeholders are withdrawn. Either way, there
+      are no placeholders for the library on return. Must not be called from
+      within a read-side section.
+
+      \return 0 if the library is loaded and initialised (by this call or
+      another), -1 if the library is unknown, -2 if it failed.
+    */
+    int completeLoad(PluginUniqueID libID) ;
+
+    /*! \brief A pool of isolated copies of one library
+
+      The copies are fixed when the pool is created. Only #next_ changes.
+    */
+    struct LibPool {
+        /// The copies; the first is the pool's ID
+        std::vector<PluginUniqueID> copies_ ;
+        /// Next copy to hand out (taken modulo the number of copies)
+        mutable volatile int next_ ;
+    } ;
+
+    /*! \brief Registrations accumulated while loading libraries
+
+      Holds the registrations from one or more successfully initialised
+      libraries until they are published by #publishBatch.
+    */
+    struct LoadBatch {
+        /// Constructor
+        LoadBatch () : pool_(0) { }
+        /// Exact match registrations
+        RegistrationTable exactMatchMap_ ;
+        /// Wildcard registrations
+        std::vector<RegisterParams> wildCardVec_ ;
+        /// Libraries in the batch
+        std::vector<DynamicLibrary *> libs_ ;
+        /// Library pool formed by the libraries in the batch, if any
+        const LibPool *pool_ ;
+    } ;
+
+    /*! \brief Open a library and find its initialisation function
+
+      Emits no messages and touches no manager state, so it can be called
+      from any thread. Returns 0 on success, -1 if the library failed to
+      load, -2 if there's no initialisation function (in which case the
+      library is closed). In case of error, \p errStr describes the problem.
+      If \p isolated is true, the library is loaded in a linker namespace of
+      its own.
+    */
+    static int openOneLib(const std::string &fullPath, DynamicLibrary *&dynLib,
+                          InitFunc &initFunc, std::string &errStr,
+                          bool isolated = false) ;
+
+    /*! \brief Initialise an open library
+
+      Runs the library's initialisation function and, if it succeeds, enters
+      the library in the manager's bookkeeping and adds its registrations to
+      \p batch. Must be called with #writeMutex_ held. Returns 0 on success,
+      -3 if initialisation failed. In case of failure it's the caller's
+      responsibility to dispose of the library.
+    */
+    int initOneLib(const std::string &fullPath, DynamicLibrary *dynLib,
+                   InitFunc initFunc, LoadBatch &batch) ;
+
+    /*! \brief Publish the registrations accumulated in \p batch
+
+      Must be called with #writeMutex_ held. If \p replaced is not null, any
+      existing registrations for that library are removed in the same
+      snapshot. If \p retire is true as well, its exact match registrations
+      are kept in Registry::retiredMap_, so that its objects can still be
+      destroyed.
+    */
+    void publishBatch(LoadBatch &batch, PluginUniqueID replaced = 0,
+                      bool retire = false) ;
+
     /*! \name Constructors and Destructors
 
       Private because the plugin manager should be a single static instance.
@@ -240,6 +924,54 @@ private:
     ~PluginManager() ;
     //@}
 
+    /*! \brief Registry snapshot
+
+      All the information needed to satisfy a client request for an object.
+      Once published, a snapshot is never modified. Writers copy the current
+      snapshot, modify the copy, and publish it.
+    */
+    struct Registry {
+        /// Constructor
+        Registry () : generation_(0) { }
+        /*! \brief Generation number
+
+          Incremented each time a snapshot is published. Anything derived
+          from a snapshot (see #DeclineCache) is valid only for snapshots of
+          the same generation.
+        */
+        unsigned int generation_ ;
+        /*! \brief API management information table
+
+          Holds the registration parameters for specific APIs registered by
+          plugin libraries, keyed by (API handle, plugin unique ID).
+        */
+        RegistrationTable exactMatchMap_ ;
+        /*! \brief Wildcard management information
+
+          Records management information for wildcard registrations by plugin
+          libraries.
+        */
+        std::vector<RegisterParams> wildCardVec_ ;
+        /// API name to handle map
+        std::map<std::string, APIHandle> apiHandleMap_ ;
+        /// API names, indexed by handle; points into PluginManager::apiNames_
+        std::vector<const std::string *> apiNames_ ;
+        /*! \brief Library pools, keyed by the unique ID of each copy
+
+          Points into PluginManager::libPools_. Empty unless #loadLibPool has
+          been used, in which case object creation consults it to spread
+          requests over the copies.
+        */
+        std::map<PluginUniqueID, const LibPool *> pools_ ;
+        /*! \brief Registrations of replaced libraries
+
+          Exact match registrations of libraries replaced by #reloadOneLib
+          and not yet closed. Consulted only to destroy objects created by
+          an old version.
+        */
+        RegistrationTable retiredMap_ ;
+    } ;
+
     /*! \name Utility methods */
     //@{
     /*! \brief Validate registration parameters
@@ -252,16 +984,163 @@ private:
     */
     DynamicLibrary *validateRegParams(const CharString *apiStr,
                                       const RegisterParams *params) const ;
-    /*! \brief Construct an ObjectParams block
+    /*! \brief Fill in an ObjectParams block
+
+      Fills in \p objParms, the parameter block passed to the plugin for
+      object creation or destruction. \p services is filled in with the
+      plugin library's view of the platform services and is referenced from
+      the parameter block, so it must outlive the block. Nothing is
+      allocated.
+    */
+    void buildObjectParams(const Registry &reg, APIHandle api,
+                           const RegisterParams &rp, ObjectParams &objParms,
+                           PlatformServices &services) const ;
+
+    /*! \brief Promote a wildcard registration
+
+      Register \p rp as the exact match provider of \p api. It's not an
+      error if another thread got there first.
+    */
+    int promoteWildcard(APIHandle api, const RegisterParams &rp) ;
+
+    /// Work of #selectLib and #findLibs
+    int rankLibs(APIHandle api, const PluginCaps &need,
+                 std::vector<PluginUniqueID> &libIDs) const ;
+
+    /*! \brief Check whether a wildcard plugin has declined an API
+
+      True if the wildcard registration of library \p libID has already
+      declined to supply \p api under a snapshot of the same generation as
+      \p reg.
+    */
+    bool isDeclined(const Registry &reg, APIHandle api,
+                    PluginUniqueID libID) const ;
+
+    /// Record that library \p libID declined to supply \p api
+    void noteDeclined(const Registry &reg, APIHandle api,
+                      PluginUniqueID libID) const ;
+
+    /*! \brief Create objects for #createObjects from an exact match
+
+      Works within a single read-side section. Returns the number of objects
+      created, or -1 if there's no usable exact match registration (the
+      library is deferred, or only a wildcard will do), in which case
+      #createObject must resolve the registration first.
+    */
+    int createBatch(APIHandle api, PluginUniqueID libID, int count,
+                    std::vector<void *> &objects,
+                    std::vector<PluginUniqueID> &libIDs,
+                    IObjectAdapter &adapter) ;
+
+    /*! \brief Choose a copy from a library pool
 
-      Constructs the parameter block passed to the plugin for object creation
-      or destruction.
+      \p rp is the registration found for (\p api, \p libID). If it belongs
+      to a library pool, and the request wasn't for a specific copy, returns
+      the registration of the next copy in turn. Otherwise returns \p rp.
     */
-    ObjectParams *buildObjectParams(const std::string apiStr,
-                                    const RegisterParams &rp) ;
+    const RegisterParams *pickPoolCopy(const Registry &reg, APIHandle api,
+                                       PluginUniqueID libID,
+                                       const RegisterParams *rp) const ;
     //@}
 
-    /// Partially filled-in platform services record
+    /*! \name Snapshot management
+
+      Support for concurrent readers. See the class documentation.
+    */
+    //@{
+    /*! \brief Begin a read-side section
+
+      Returns the current snapshot, which remains valid until the matching
+      #endRead. \p parity must be handed to #endRead.
+    */
+    const Registry *beginRead(int &parity) const ;
+
+    /// End a read-side section begun with #beginRead
+    void endRead(int parity) const ;
+
+    /*! \brief Get a private copy of the current snapshot for modification
+
+      Must be called with #writeMutex_ held.
+    */
+    Registry *copyRegistry() const ;
+
+    /*! \brief Publish a new snapshot
+
+      Must be called with #writeMutex_ held. The old snapshot is retired and
+      will be freed by #reclaim.
+    */
+    void publish(Registry *next) ;
+
+    /*! \brief Wait for a grace period
+
+      Returns only when every read-side section that was in progress when the
+      call began has ended. Must not be called with #writeMutex_ held or from
+      within a read-side section.
+    */
+    void synchronize() ;
+
+    /*! \brief Free retired snapshots
+
+      Waits for a grace period and frees any snapshots retired before the
+      call. Does nothing if the calling thread is in a read-side section or
+      holds #writeMutex_; the snapshots will be freed by a later call.
+    */
+    void reclaim() ;
+
+    /// Current snapshot
+    Registry *volatile current_ ;
+
+    /// Snapshots replaced but not yet freed
+    std::vector<Registry *> retired_ ;
+
+    /// Epoch counter; advanced by #synchronize
+    volatile int epoch_ ;
+
+    /// Active readers, by epoch parity
+    mutable volatile int readers_[2] ;
+
+    /// Serialises writers; recursive so plugins can register during load
+    Mutex writeMutex_ ;
+
+    /// Serialises grace period detection
+    Mutex graceMutex_ ;
+
+    /// Serialises use of the message handler
+    mutable Mutex msgMutex_ ;
+    //@}
+
+    /*! \brief Wildcard negative result cache
+
+      The (API, library) pairs for which a wildcard registration has declined
+      to produce an object. Without this, every request for an API that no
+      plugin supplies would probe every wildcard plugin again.
+
+      The cache belongs to a single snapshot generation. Any change to the
+      registry (loading or unloading a library, registering or promoting an
+      API) publishes a new snapshot, and the first use under the new
+      generation discards the old entries. Entries from a reader still
+      working with an older snapshot are ignored.
+    */
+    struct DeclineCache {
+        /// Constructor
+        DeclineCache () : generation_(0) { }
+        /// Snapshot generation the entries belong to
+        unsigned int generation_ ;
+        /// Declined (API, library) pairs
+        std::set<std::pair<APIHandle, PluginUniqueID> > declined_ ;
+    } ;
+
+    /// Wildcard negative result cache; protected by #declineMutex_
+    mutable DeclineCache declineCache_ ;
+
+    /// Serialises use of #declineCache_
+    mutable Mutex declineMutex_ ;
+
+    /*! \brief Partially filled-in platform services record
+
+      The fields common to all plugin libraries. Copied and completed for each
+      call into a plugin.
+    */
     PlatformServices platformServices_ ;
 
     /*! \brief Plugin library management information
@@ -272,20 +1151,59 @@ private:
 
         /// The dynamic library
         DynamicLibrary *dynLib_ ;
+        /*! \brief The path the library is known by
+
+          As the library's own, except after #reloadOneLib, when the new
+          version takes the old one's path.
+        */
+        std::string libPath_ ;
         /// Plugin library state object supplied by plugin (opaque pointer)
         PluginState *ctrlObj_ ;
-        /// Exit (cleanup) function for the library; called prior to unload
+        /*! \brief Exit (cleanup) function for the library; called prior to
+        	   unload
+
+          Null if the library has not been (successfully) initialised.
+        */
         ExitFunc exitFunc_ ;
+        /// True while loading of the library is deferred
+        bool deferred_ ;
+        /// True once the library has been replaced by #reloadOneLib
+        bool replaced_ ;
 
     } ;
 
+    /*! \brief Run a library's exit function and close it
+
+      The library must already have been withdrawn from the registry and a
+      grace period have passed. Returns 0, or -1 if the exit function
+      failed.
+    */
+    int closeLib(const DynLibInfo &info) ;
+
+    /*! \brief Close replaced libraries that have no live objects
+
+      Called whenever a retiring library's live object count falls to zero.
+      Does nothing if the calling thread is in a read-side section or holds
+      #writeMutex_; the caller of #reloadOneLib or a later destroy will
+      finish the job.
+    */
+    void closeRetired() ;
+
     /// Map type to map library path strings to PluginUniqueID
     typedef std::map<std::string, PluginUniqueID> LibPathToIDMap ;
 
+    /*! \brief Library pools, keyed by pool ID
+
+      Owned here; a pool is freed only after it has been withdrawn from the
+      registry and a grace period has passed.
+    */
+    std::map<PluginUniqueID, LibPool *> libPools_ ;
+
     /*! \brief Plugin library path to ID map
 
       So that we don't have to work with strings internally, map the full
-      path to a more tractable ID.
+      path to a more tractable ID. This and the remaining bookkeeping
+      structures are used only with #writeMutex_ held.
     */
     LibPathToIDMap libPathToIDMap_ ;
 
@@ -299,32 +1217,21 @@ private:
     */
     DynamicLibraryMap dynamicLibraryMap_ ;
 
-    /// Map type for API management
-    typedef std::multimap<std::string, RegisterParams> RegistrationMap ;
     /// Vector type for wildcard management
     typedef std::vector<RegisterParams> RegistrationVec ;
 
-    /*! \brief Check for an existing entry in the API multimaps
-
-      Checks both the key and the plugin unique ID. Returns an iterator for the
-      entry if it exists, null otherwise.
-    */
-    RegistrationMap::iterator apiEntryExists(RegistrationMap &regMap,
-            const std::string &key,
-            PluginUniqueID libID) ;
-
-    /*! \brief API management information map
+    /// Map type for API name interning
+    typedef std::map<std::string, APIHandle> APIHandleMap ;
 
-      Maps specific APIs registered by plugin libraries to a block of
-      information (#APIInfo) used to manage the API.
-    */
-    RegistrationMap exactMatchMap_ ;
-    /*! \brief Wildcard management information
+    /*! \brief API name storage
 
-      Records management information for wildcard registrations by plugin
-      libraries.
+      Each distinct API name is assigned the next available handle when it's
+      first seen, and the name is stored here. A deque, so that adding a name
+      never moves the existing strings; snapshots and ObjectParams blocks
+      point directly at these. Names are never removed. Modified only with
+      #writeMutex_ held.
     */
-    RegistrationVec wildCardVec_ ;
+    std::deque<std::string> apiNames_ ;
 
     /*! \brief Initialising a plugin?
 
@@ -338,8 +1245,8 @@ private:
     */
     DynamicLibrary *libInInit_ ;
 
-    /// Temporary API map used during plugin library initialisation
-    RegistrationMap tmpExactMatchMap_ ;
+    /// Temporary API table used during plugin library initialisation
+    RegistrationTable tmpExactMatchMap_ ;
     /// Temporary wildcard vector used during plugin library initialisation
     RegistrationVec tmpWildCardVec_ ;     // wild card ('*') object types
 
@@ -354,6 +1261,42 @@ private:
     CoinMessages msgs_ ;
     /// Log (verbosity) level
     int logLvl_ ;
+    /// Lazy loading of libraries with a manifest
+    bool lazyLoad_ ;
+    /// Soft memory limit given to libraries as they're loaded
+    int64_t dfltSoftMemLimit_ ;
+    /// Hard memory limit given to libraries as they're loaded
+    int64_t dfltHardMemLimit_ ;
+    /// A registered service
+    struct Service {
+        /// The service
+        ServiceFunc func_ ;
+        /// Its context
+        void *ctx_ ;
+    } ;
+    /// Registered services, by name; guarded by #serviceMutex_
+    std::map<std::string, Service> services_ ;
+    /// Guards #services_ and #clientService_
+    Mutex serviceMutex_ ;
+    /// The client's service function, for services not registered
+    InvokeServiceFunc clientService_ ;
+    /// Thread pool shared with plugins
+    ThreadPool threadPool_ ;
+    /// Performance statistics
+    PerfStats perfStats_ ;
+    /// Queue for messages logged by plugins
+    LogSink logSink_ ;
+    /// File for the trace (see Trace), from OSI2_TRACE; empty if none
+    std::string tracePath_ ;
+    /// Cached listings of the plugin directories
+    DirCache dirCache_ ;
+
+    /*! \brief Handles of the API classes, by ApiTraits id; -1 if not yet known
+
+      A handle never changes once assigned, so the slots need no lock: a
+      race only has two threads store the same value.
+    */
+    volatile int typedHandles_[maxApiID] ;
 
 } ;
 
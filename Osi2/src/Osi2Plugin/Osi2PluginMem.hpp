@@ -0,0 +1,342 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2PluginMem.hpp
+    \brief Memory accounting and arenas through the plugin manager.
+
+  A plugin that wants the memory it holds counted against it keeps a
+  PluginMem, set from the PlatformServices block handed to its
+  initialisation function, and charges what it allocates:
+  <pre>
+    if (mem.charge(this, bytes) < 0) return (-1) ;   // over the hard limit
+    ...
+    mem.release(this, bytes) ;
+  </pre>
+  or lets #alloc and #free do it. The owner is the object the memory
+  belongs to, as the create function returned it; memory still charged to
+  an object when the plugin manager destroys it is released with it.
+
+  A shim over a solver that allocates for itself (a `heavy' shim) can't see
+  the solver's allocations. It charges an estimate instead, when it hands
+  the solver a problem (see #modelBytes), and so can refuse a problem too
+  big for its limit before the solver tries to build it.
+
+  A plugin loaded by a manager too old to supply the service accounts for
+  nothing, and every charge is accepted.
+
+  The plugin manager also keeps an arena for each owner (see ArenaPool).
+  Memory for an object's model (row and column data built while loading a
+  problem, say) can come from the object's arena with #arenaAlloc and is
+  freed all at once when the plugin manager destroys the object. Memory
+  needed only for one job goes in an ArenaScope, which releases its arena
+  when it goes out of scope:
+  <pre>
+    ArenaScope scratch(mem) ;
+    const char **names = scratch.allocArray<const char *>(numRows) ;
+  </pre>
+  A scope works whatever the plugin manager's version; #arenaAlloc needs a
+  manager that supplies arenas (#hasArenas).
+*/
+
+#ifndef OSI2PLUGINMEM_HPP
+#define OSI2PLUGINMEM_HPP
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Osi2Plugin.hpp"
+#include "Osi2nullptr.hpp"
+
+namespace Osi2 {
+
+/*! \brief The plugin's end of the plugin manager's memory accounting
+
+  Cheap to copy; it's four pointers.
+*/
+class PluginMem {
+
+public:
+
+    /// Constructor; accounts for nothing until #init is called
+    PluginMem ()
+        : chargeMem_(nullptr),
+          arenaAlloc_(nullptr),
+          arenaRelease_(nullptr),
+          pluginID_(nullptr)
+    { }
+
+    /*! \brief Take the accounting service from \p services
+
+      Leaves accounting disabled if the plugin manager doesn't supply it
+      (PlatformServices minor version less than 3), and arenas if it doesn't
+      supply those (minor version less than 4).
+    */
+    inline void init (const PlatformServices *services)
+    {
+        chargeMem_ = nullptr ;
+        arenaAlloc_ = nullptr ;
+        arenaRelease_ = nullptr ;
+        pluginID_ = services->pluginID_ ;
+        const int major = services->version_.major_ ;
+        const int minor = services->version_.minor_ ;
+        if (major > 1 || (major == 1 && minor >= 3))
+            chargeMem_ = services->chargeMem_ ;
+        if (major > 1 || (major == 1 && minor >= 4)) {
+            arenaAlloc_ = services->arenaAlloc_ ;
+            arenaRelease_ = services->arenaRelease_ ;
+        }
+    }
+
+    /// True if charges go anywhere
+    inline bool enabled () const
+    {
+        return (chargeMem_ != nullptr) ;
+    }
+
+    /// True if the plugin manager supplies arenas
+    inline bool hasArenas () const
+    {
+        return (arenaAlloc_ != nullptr && arenaRelease_ != nullptr) ;
+    }
+
+    /*! \brief Charge \p bytes to \p owner
+
+      Returns 0 if the charge is accepted, 1 if it's accepted and the
+      library is over its soft limit, -1 if it's refused (see
+      \link Osi2::MemChargeFunc MemChargeFunc \endlink).
+    */
+    inline int charge (const void *owner, int64_t bytes) const
+    {
+        if (chargeMem_ == nullptr || bytes <= 0) return (0) ;
+        return ((*chargeMem_)(pluginID_, owner, bytes)) ;
+    }
+
+    /// Release \p bytes charged to \p owner
+    inline void release (const void *owner, int64_t bytes) const
+    {
+        if (chargeMem_ != nullptr && bytes > 0)
+            (*chargeMem_)(pluginID_, owner, -bytes) ;
+    }
+
+    /*! \brief Allocate \p bytes for \p owner
+
+      As malloc(3), but charged first; returns null if the charge is refused
+      or malloc fails. Free the block with #free, with the same owner.
+    */
+    inline void *alloc (const void *owner, size_t bytes) const
+    {
+        const size_t total = bytes+sizeof(Header) ;
+        if (charge(owner, static_cast<int64_t>(total)) < 0) return (nullptr) ;
+        Header *block = static_cast<Header *>(std::malloc(total)) ;
+        if (block == nullptr) {
+            release(owner, static_cast<int64_t>(total)) ;
+            return (nullptr) ;
+        }
+        block->size_ = total ;
+        return (block+1) ;
+    }
+
+    /// Free a block from #alloc and release its charge
+    inline void free (const void *owner, void *ptr) const
+    {
+        if (ptr == nullptr) return ;
+        Header *block = static_cast<Header *>(ptr)-1 ;
+        release(owner, static_cast<int64_t>(block->size_)) ;
+        std::free(block) ;
+    }
+
+    /*! \brief Allocate \p bytes in \p owner's arena
+
+      The block is freed with the rest of the arena, by #arenaRelease or,
+      if \p owner is an object, when the plugin manager destroys it.
+      Returns null if the charge is refused, or if there are no arenas.
+    */
+    inline void *arenaAlloc (const void *owner, size_t bytes) const
+    {
+        if (arenaAlloc_ == nullptr) return (nullptr) ;
+        return ((*arenaAlloc_)(pluginID_, owner, bytes)) ;
+    }
+
+    /// Free everything in \p owner's arena
+    inline void arenaRelease (const void *owner) const
+    {
+        if (arenaRelease_ != nullptr) (*arenaRelease_)(pluginID_, owner) ;
+    }
+
+    /*! \brief Estimate of the memory a solver needs for a problem
+
+      A rough figure for a simplex code: the column-major matrix and a
+      row-major copy, the bounds, objective and solution vectors, and the
+      factorisation, which is taken to be a few times the size of the
+      matrix.
+    */
+    static inline int64_t modelBytes (int numRows, int numCols,
+                                      int64_t numElements)
+    {
+        const int64_t perElement = 4*(sizeof(double)+sizeof(int)) ;
+        const int64_t perVector = 8*sizeof(double)+2*sizeof(int) ;
+        return (numElements*perElement +
+                (static_cast<int64_t>(numRows)+numCols)*perVector) ;
+    }
+
+private:
+
+    /// Prefix of a block from #alloc; a double keeps the payload aligned
+    union Header {
+        size_t size_ ;
+        double align_ ;
+    } ;
+
+    /// The plugin manager's accounting function
+    MemChargeFunc chargeMem_ ;
+    /// The plugin manager's arena allocator
+    ArenaAllocFunc arenaAlloc_ ;
+    /// The plugin manager's arena release function
+    ArenaReleaseFunc arenaRelease_ ;
+    /// The library's unique ID
+    PluginUniqueID pluginID_ ;
+
+} ;
+
+/*! \brief Memory charged for as long as the object lives
+
+  Holds one charge and releases it on destruction or #set; for a shim
+  object, the estimate for the problem it holds now. A charge that's
+  refused leaves the old reservation in place.
+*/
+class MemReservation {
+
+public:
+
+    /// Constructor; nothing reserved
+    MemReservation ()
+        : owner_(nullptr),
+          bytes_(0)
+    { }
+
+    /// Destructor; releases the reservation
+    ~MemReservation ()
+    {
+        mem_.release(owner_, bytes_) ;
+    }
+
+    /// Set the accounting service and owner; call before #set
+    inline void init (const PluginMem &mem, const void *owner)
+    {
+        mem_ = mem ;
+        owner_ = owner ;
+    }
+
+    /*! \brief Replace the reservation with one of \p bytes
+
+      The old reservation is released first, since what it held is about to
+      be replaced. Returns as PluginMem::charge; on refusal the old
+      reservation is restored, as what it held will be kept.
+    */
+    inline int set (int64_t bytes)
+    {
+        const int64_t old = bytes_ ;
+        mem_.release(owner_, old) ;
+        bytes_ = 0 ;
+        const int retval = mem_.charge(owner_, bytes) ;
+        if (retval >= 0) {
+            bytes_ = bytes ;
+        } else if (mem_.charge(owner_, old) >= 0) {
+            bytes_ = old ;
+        }
+        return (retval) ;
+    }
+
+    /// Bytes reserved
+    inline int64_t getBytes () const
+    {
+        return (bytes_) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    MemReservation(const MemReservation &rhs) ;
+    /// Assignment (not implemented)
+    MemReservation &operator=(const MemReservation &rhs) ;
+
+    /// The accounting service
+    PluginMem mem_ ;
+    /// Owner of the charge
+    const void *owner_ ;
+    /// Bytes charged
+    int64_t bytes_ ;
+
+} ;
+
+/*! \brief An arena for one job
+
+  Everything allocated through the scope is freed when it goes out of
+  scope. The scope itself is the arena's owner. Without arenas from the
+  plugin manager, each block is malloc'd and freed with the scope, which
+  costs what the arena would have saved but lets the plugin use one code
+  path.
+*/
+class ArenaScope {
+
+public:
+
+    /// Constructor; nothing allocated
+    explicit ArenaScope (const PluginMem &mem)
+        : mem_(mem)
+    { }
+
+    /// Destructor; frees everything allocated
+    ~ArenaScope ()
+    {
+        mem_.arenaRelease(this) ;
+        for (size_t i = 0 ; i < fallback_.size() ; i++)
+            std::free(fallback_[i]) ;
+    }
+
+    /// Allocate \p bytes; null if refused
+    inline void *alloc (size_t bytes)
+    {
+        if (mem_.hasArenas()) return (mem_.arenaAlloc(this, bytes)) ;
+        void *block = std::malloc((bytes > 0) ? bytes : 1) ;
+        if (block != nullptr) fallback_.push_back(block) ;
+        return (block) ;
+    }
+
+    /// Allocate an array of \p n T; T must need no construction
+    template <typename T>
+    inline T *allocArray (size_t n)
+    {
+        return (static_cast<T *>(alloc(n*sizeof(T)))) ;
+    }
+
+    /// Copy the string \p str; null if refused
+    inline char *copy (const char *str)
+    {
+        const size_t len = std::strlen(str)+1 ;
+        char *dup = allocArray<char>(len) ;
+        if (dup != nullptr) std::memcpy(dup, str, len) ;
+        return (dup) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    ArenaScope(const ArenaScope &rhs) ;
+    /// Assignment (not implemented)
+    ArenaScope &operator=(const ArenaScope &rhs) ;
+
+    /// The arena service
+    PluginMem mem_ ;
+    /// Blocks malloc'd for want of arenas
+    std::vector<void *> fallback_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,121 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2PluginThreads.hpp
+    \brief The plugin manager's thread pool, from a plugin.
+
+  A plugin that wants to run work in parallel uses the pool shared by the
+  process instead of starting threads of its own. It keeps a PluginThreads,
+  set from the PlatformServices block handed to its initialisation
+  function:
+  <pre>
+    threads.init(services) ;
+    ...
+    threads.run(parseChunk, chunkPtrs, numChunks) ;
+  </pre>
+  The first call to #init finds the pool through
+  \link Osi2::PlatformServices#invokeService_ invokeService_ \endlink; the
+  calls after that go straight to the pool.
+
+  Under a plugin manager too old to supply the pool, every task runs in the
+  calling thread, when it's submitted, and #getNumThreads is 0.
+*/
+
+#ifndef OSI2PLUGINTHREADS_HPP
+#define OSI2PLUGINTHREADS_HPP
+
+#include "Osi2Plugin.hpp"
+#include "Osi2nullptr.hpp"
+
+namespace Osi2 {
+
+/*! \brief The plugin's end of the plugin manager's thread pool
+
+  Cheap to copy.
+*/
+class PluginThreads {
+
+public:
+
+    /// Constructor; runs everything in the calling thread until #init
+    PluginThreads ()
+    {
+        clear() ;
+    }
+
+    /*! \brief Find the thread pool through \p services
+
+      Leaves the pool unused if the plugin manager doesn't supply it
+      (PlatformServices minor version less than 5).
+    */
+    inline void init (const PlatformServices *services)
+    {
+        clear() ;
+        const int major = services->version_.major_ ;
+        const int minor = services->version_.minor_ ;
+        if (!(major > 1 || (major == 1 && minor >= 5)) ||
+                services->invokeService_ == nullptr)
+            return ;
+        ThreadPoolService pool ;
+        const CharString *name =
+            reinterpret_cast<const CharString *>(OSI2_THREADPOOL_SERVICE) ;
+        if (services->invokeService_(name, &pool) == 0) pool_ = pool ;
+    }
+
+    /// True if tasks go to the plugin manager's pool
+    inline bool enabled () const
+    {
+        return (pool_.submit_ != nullptr) ;
+    }
+
+    /// Worker threads in the pool; the calling thread makes one more
+    inline int getNumThreads () const
+    {
+        return (pool_.numThreads_) ;
+    }
+
+    /// Submit \p func(\p arg), counted in \p group (may be null)
+    inline void submit (TaskFunc func, void *arg, TaskGroup *group) const
+    {
+        if (pool_.submit_ != nullptr) pool_.submit_(func, arg, group) ;
+        else func(arg) ;
+    }
+
+    /// Wait for the tasks in \p group
+    inline void wait (TaskGroup *group) const
+    {
+        if (pool_.wait_ != nullptr) pool_.wait_(group) ;
+    }
+
+    /// Run \p func(\p args[i]) for i in 0 .. \p count-1 and wait for them
+    inline void run (TaskFunc func, void **args, int count) const
+    {
+        if (pool_.run_ != nullptr) {
+            pool_.run_(func, args, count) ;
+        } else {
+            for (int i = 0 ; i < count ; i++) func(args[i]) ;
+        }
+    }
+
+private:
+
+    /// Forget the pool
+    inline void clear ()
+    {
+        pool_.numThreads_ = 0 ;
+        pool_.submit_ = nullptr ;
+        pool_.wait_ = nullptr ;
+        pool_.run_ = nullptr ;
+    }
+
+    /// What the thread pool service handed back
+    ThreadPoolService pool_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,247 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RegistrationTable.cpp
+    \brief Method definitions for Osi2::RegistrationTable
+*/
+
+#include <algorithm>
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2RegistrationTable.hpp"
+
+namespace {
+
+/*
+  Initial number of slots. Must be a power of two.
+*/
+const size_t initialSlots = 16 ;
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+RegistrationTable::RegistrationTable ()
+    : count_(0),
+      deleted_(0)
+{
+    Slot empty ;
+    empty.state_ = Empty ;
+    slots_.assign(initialSlots, empty) ;
+}
+
+/*
+  The unique ID is a pointer; the low-order bits carry no information
+  because of alignment, so shift them away before mixing in the API handle.
+  The final multiply-and-shift spreads the result across the table.
+*/
+size_t RegistrationTable::hash (APIHandle api, PluginUniqueID libID) const
+{
+    size_t h = reinterpret_cast<size_t>(libID) >> 4 ;
+    h ^= static_cast<size_t>(api) * 0x9e3779b1u ;
+    h ^= (h >> 15) ;
+    h *= 0x2c1b3c6du ;
+    h ^= (h >> 12) ;
+    return (h & (slots_.size() - 1)) ;
+}
+
+/*
+  Linear probe from the home slot. Deleted slots do not terminate the probe;
+  an empty slot does.
+*/
+int RegistrationTable::findSlot (APIHandle api, PluginUniqueID libID) const
+{
+    const size_t mask = slots_.size() - 1 ;
+    for (size_t ndx = hash(api, libID) ; ; ndx = (ndx + 1) & mask) {
+        const Slot &slot = slots_[ndx] ;
+        if (slot.state_ == Empty) return (-1) ;
+        if (slot.state_ == Occupied && slot.api_ == api &&
+                slot.params_.pluginID_ == libID)
+            return (static_cast<int>(ndx)) ;
+    }
+}
+
+const RegisterParams *RegistrationTable::find (APIHandle api,
+        PluginUniqueID libID) const
+{
+    if (api < 0) return (nullptr) ;
+    /*
+      No restriction? Use the first library to register the API.
+    */
+    if (libID == 0) {
+        if (static_cast<size_t>(api) >= providers_.size() ||
+                providers_[api].empty())
+            return (nullptr) ;
+        libID = providers_[api].front() ;
+    }
+    int ndx = findSlot(api, libID) ;
+    if (ndx < 0) return (nullptr) ;
+    return (&slots_[ndx].params_) ;
+}
+
+int RegistrationTable::findAll (APIHandle api,
+                                std::vector<const RegisterParams *> &regs) const
+{
+    if (api < 0 || static_cast<size_t>(api) >= providers_.size()) return (0) ;
+    const std::vector<PluginUniqueID> &libs = providers_[api] ;
+    int found = 0 ;
+    for (size_t i = 0 ; i < libs.size() ; i++) {
+        int ndx = findSlot(api, libs[i]) ;
+        if (ndx < 0) continue ;
+        regs.push_back(&slots_[ndx].params_) ;
+        found++ ;
+    }
+    return (found) ;
+}
+
+/*
+  Keep the load factor (including tombstones) at or below 1/2.
+*/
+bool RegistrationTable::insert (APIHandle api, const RegisterParams &params)
+{
+    if (api < 0) return (false) ;
+    if (findSlot(api, params.pluginID_) >= 0) return (false) ;
+
+    if (2 * static_cast<size_t>(count_ + deleted_ + 1) > slots_.size()) {
+        size_t newSize = slots_.size() ;
+        while (2 * static_cast<size_t>(count_ + 1) > newSize) newSize *= 2 ;
+        rehash(newSize) ;
+    }
+    const size_t mask = slots_.size() - 1 ;
+    size_t ndx = hash(api, params.pluginID_) ;
+    while (slots_[ndx].state_ == Occupied) ndx = (ndx + 1) & mask ;
+    Slot &slot = slots_[ndx] ;
+    if (slot.state_ == Deleted) deleted_-- ;
+    slot.state_ = Occupied ;
+    slot.api_ = api ;
+    slot.params_ = params ;
+    count_++ ;
+
+    if (static_cast<size_t>(api) >= providers_.size())
+        providers_.resize(api + 1) ;
+    providers_[api].push_back(params.pluginID_) ;
+    libAPIs_[params.pluginID_].push_back(api) ;
+
+    return (true) ;
+}
+
+bool RegistrationTable::erase (APIHandle api, PluginUniqueID libID)
+{
+    if (api < 0) return (false) ;
+    int ndx = findSlot(api, libID) ;
+    if (ndx < 0) return (false) ;
+    slots_[ndx].state_ = Deleted ;
+    count_-- ;
+    deleted_++ ;
+
+    std::vector<PluginUniqueID> &libs = providers_[api] ;
+    libs.erase(std::find(libs.begin(), libs.end(), libID)) ;
+    LibAPIMap::iterator laIter = libAPIs_.find(libID) ;
+    std::vector<APIHandle> &apis = laIter->second ;
+    apis.erase(std::find(apis.begin(), apis.end(), api)) ;
+    if (apis.empty()) libAPIs_.erase(laIter) ;
+
+    return (true) ;
+}
+
+int RegistrationTable::eraseLib (PluginUniqueID libID,
+                                 std::vector<APIHandle> *removed)
+{
+    LibAPIMap::iterator laIter = libAPIs_.find(libID) ;
+    if (laIter == libAPIs_.end()) return (0) ;
+    const std::vector<APIHandle> &apis = laIter->second ;
+    for (size_t i = 0 ; i < apis.size() ; i++) {
+        const APIHandle api = apis[i] ;
+        slots_[findSlot(api, libID)].state_ = Deleted ;
+        count_-- ;
+        deleted_++ ;
+        std::vector<PluginUniqueID> &libs = providers_[api] ;
+        libs.erase(std::find(libs.begin(), libs.end(), libID)) ;
+        if (removed != nullptr) removed->push_back(api) ;
+    }
+    const int numRemoved = static_cast<int>(apis.size()) ;
+    libAPIs_.erase(laIter) ;
+    return (numRemoved) ;
+}
+
+void RegistrationTable::setLibCtrlObj (PluginUniqueID libID,
+                                       PluginState *ctrlObj)
+{
+    LibAPIMap::const_iterator laIter = libAPIs_.find(libID) ;
+    if (laIter == libAPIs_.end()) return ;
+    const std::vector<APIHandle> &apis = laIter->second ;
+    for (size_t i = 0 ; i < apis.size() ; i++)
+        slots_[findSlot(apis[i], libID)].params_.libCtrlObj_ = ctrlObj ;
+}
+
+/*
+  Walk the other table's provider lists rather than its slots so that the
+  registration order for each API is preserved.
+*/
+int RegistrationTable::merge (const RegistrationTable &other)
+{
+    int dups = 0 ;
+    for (size_t api = 0 ; api < other.providers_.size() ; api++) {
+        const std::vector<PluginUniqueID> &libs = other.providers_[api] ;
+        for (size_t i = 0 ; i < libs.size() ; i++) {
+            int ndx = other.findSlot(static_cast<APIHandle>(api), libs[i]) ;
+            if (!insert(static_cast<APIHandle>(api), other.slots_[ndx].params_))
+                dups++ ;
+        }
+    }
+    return (dups) ;
+}
+
+int RegistrationTable::mergeLib (const RegistrationTable &other,
+                                 PluginUniqueID libID)
+{
+    LibAPIMap::const_iterator laIter = other.libAPIs_.find(libID) ;
+    if (laIter == other.libAPIs_.end()) return (0) ;
+    const std::vector<APIHandle> &apis = laIter->second ;
+    int copied = 0 ;
+    for (size_t i = 0 ; i < apis.size() ; i++) {
+        int ndx = other.findSlot(apis[i], libID) ;
+        if (insert(apis[i], other.slots_[ndx].params_)) copied++ ;
+    }
+    return (copied) ;
+}
+
+void RegistrationTable::clear ()
+{
+    Slot empty ;
+    empty.state_ = Empty ;
+    slots_.assign(initialSlots, empty) ;
+    count_ = 0 ;
+    deleted_ = 0 ;
+    providers_.clear() ;
+    libAPIs_.clear() ;
+}
+
+/*
+  Rehash all occupied slots into a new array of the given size. Tombstones
+  are discarded.
+*/
+void RegistrationTable::rehash (size_t newSize)
+{
+    std::vector<Slot> oldSlots ;
+    oldSlots.swap(slots_) ;
+    Slot empty ;
+    empty.state_ = Empty ;
+    slots_.assign(newSize, empty) ;
+    deleted_ = 0 ;
+
+    const size_t mask = newSize - 1 ;
+    for (size_t i = 0 ; i < oldSlots.size() ; i++) {
+        const Slot &old = oldSlots[i] ;
+        if (old.state_ != Occupied) continue ;
+        size_t ndx = hash(old.api_, old.params_.pluginID_) ;
+        while (slots_[ndx].state_ == Occupied) ndx = (ndx + 1) & mask ;
+        slots_[ndx] = old ;
+    }
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,166 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RegistrationTable.hpp
+    \brief Declarations for Osi2::RegistrationTable
+
+  A flat hash table holding API registrations, keyed by (API handle, plugin
+  library unique ID).
+*/
+
+#ifndef OSI2REGISTRATIONTABLE_HPP
+#define OSI2REGISTRATIONTABLE_HPP
+
+#include <vector>
+#include <map>
+
+#include "Osi2Plugin.hpp"
+
+namespace Osi2 {
+
+/*! \brief Handle for an interned API name
+
+  The plugin manager maps each distinct API name to a small nonnegative
+  integer the first time it sees the name. Clients that create objects at
+  a high rate can resolve the name once with
+  PluginManager::getAPIHandle and use the handle thereafter, avoiding
+  string comparisons on the object creation path. A negative value is
+  never a valid handle.
+*/
+typedef int APIHandle ;
+
+/*! \brief API registration table
+
+  Holds RegisterParams blocks for exact-match API registrations. The table
+  is open-addressed with linear probing and keyed by the pair (API handle,
+  plugin unique ID), so a lookup for a specific library is a hash probe
+  and a few integer comparisons.
+
+  Lookups with a unique ID of 0 (no library restriction) are satisfied by
+  the first library that registered the API. To support this the table keeps,
+  for each API handle, the list of providing libraries in registration order.
+  It also keeps, for each library, the list of APIs it provides, so that
+  the work of #eraseLib and #setLibCtrlObj is proportional to one library's
+  registrations rather than to the size of the table.
+*/
+class RegistrationTable {
+
+public:
+
+    /// Default constructor
+    RegistrationTable() ;
+
+    /*! \brief Find a registration
+
+      Returns the registration for \p api supplied by library \p libID, or
+      null if there is none. If \p libID is 0, the first registration for
+      \p api is returned.
+    */
+    const RegisterParams *find(APIHandle api, PluginUniqueID libID) const ;
+
+    /*! \brief Find all registrations for an API
+
+      Appends the registrations for \p api to \p regs, in order of
+      registration. Returns the number appended.
+    */
+    int findAll(APIHandle api, std::vector<const RegisterParams *> &regs) const ;
+
+    /*! \brief Add a registration
+
+      The library is taken from the \c pluginID_ field of \p params.
+      Returns false (and adds nothing) if the library already has a
+      registration for \p api.
+    */
+    bool insert(APIHandle api, const RegisterParams &params) ;
+
+    /*! \brief Remove a registration
+
+      Returns false if there was no registration for (\p api, \p libID).
+    */
+    bool erase(APIHandle api, PluginUniqueID libID) ;
+
+    /*! \brief Remove all registrations for a library
+
+      The handles of the APIs removed are appended to \p removed, if it is
+      supplied. Returns the number of registrations removed.
+    */
+    int eraseLib(PluginUniqueID libID, std::vector<APIHandle> *removed = 0) ;
+
+    /*! \brief Set the library control object for a library's registrations
+
+      Sets the \c libCtrlObj_ field of every registration supplied by
+      library \p libID to \p ctrlObj.
+    */
+    void setLibCtrlObj(PluginUniqueID libID, PluginState *ctrlObj) ;
+
+    /*! \brief Copy all registrations from \p other into this table
+
+      Returns the number of registrations that were not copied because they
+      duplicate an existing registration.
+    */
+    int merge(const RegistrationTable &other) ;
+
+    /*! \brief Copy the registrations of library \p libID from \p other
+
+      Returns the number of registrations copied.
+    */
+    int mergeLib(const RegistrationTable &other, PluginUniqueID libID) ;
+
+    /// Remove all registrations
+    void clear() ;
+
+    /// Number of registrations in the table
+    inline int size() const {
+        return (count_) ;
+    }
+
+private:
+
+    /// State of a slot in the table
+    enum SlotState { Empty, Occupied, Deleted } ;
+
+    /// A single slot in the hash table
+    struct Slot {
+        /// Slot state
+        SlotState state_ ;
+        /// API handle (key)
+        APIHandle api_ ;
+        /// Registration parameters; \c pluginID_ is the second half of the key
+        RegisterParams params_ ;
+    } ;
+
+    /// Locate the slot for (api, libID); -1 if not present
+    int findSlot(APIHandle api, PluginUniqueID libID) const ;
+
+    /// Hash function for (api, libID)
+    size_t hash(APIHandle api, PluginUniqueID libID) const ;
+
+    /// Resize the slot array to \p newSize (a power of two) and rehash
+    void rehash(size_t newSize) ;
+
+    /// The slots; size is always a power of two
+    std::vector<Slot> slots_ ;
+
+    /// Number of occupied slots
+    int count_ ;
+
+    /// Number of deleted (tombstone) slots
+    int deleted_ ;
+
+    /// Providing libraries for each API handle, in order of registration
+    std::vector< std::vector<PluginUniqueID> > providers_ ;
+
+    /// Map type for #libAPIs_
+    typedef std::map<PluginUniqueID, std::vector<APIHandle> > LibAPIMap ;
+
+    /// APIs provided by each library, in order of registration
+    LibAPIMap libAPIs_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
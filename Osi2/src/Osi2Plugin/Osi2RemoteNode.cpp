@@ -0,0 +1,604 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RemoteNode.cpp
+    \brief Method definitions for Osi2::RemoteNode
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2RemoteNode.hpp"
+#include "Osi2RemoteWire.hpp"
+#include "Osi2PluginManager.hpp"
+#include "Osi2ObjectAdapter.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
+#include "Osi2Osi1API.hpp"
+
+namespace {
+
+/// How long the listener waits for a connection before looking around, ms
+const int acceptInterval = 100 ;
+
+/*
+  The suffix becomes part of a file name in the cache, so it must not be
+  able to name anything outside it.
+*/
+bool goodSuffix (const std::string &suffix)
+{
+    if (suffix.size() > 8) return (false) ;
+    for (size_t i = 0 ; i < suffix.size() ; i++) {
+        const char c = suffix[i] ;
+        if (!(c == '.' || (c >= '0' && c <= '9') ||
+                (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')))
+            return (false) ;
+    }
+    return (suffix.find("..") == std::string::npos) ;
+}
+
+/// Read the whole of a cached model back into memory
+bool readWhole (const std::string &path, std::vector<char> &data)
+{
+    data.clear() ;
+    std::FILE *file = std::fopen(path.c_str(), "rb") ;
+    if (file == nullptr) return (false) ;
+    char chunk[4096] ;
+    size_t got ;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.insert(data.end(), chunk, chunk+got) ;
+    const bool good = (std::ferror(file) == 0) ;
+    std::fclose(file) ;
+    return (good) ;
+}
+
+/// The data of an optional array, or null if it was absent
+template <class T>
+const T *orNull (const std::vector<T> &vec)
+{
+    return ((vec.empty()) ? nullptr : &vec[0]) ;
+}
+
+/// Load an unpacked problem into a ProbMgmt object
+int loadInto (Osi2::ProbMgmtAPI *obj, const Osi2::WireProblem &prob)
+{
+    return (obj->loadProblem(prob.numCols_, prob.numRows_, &prob.start_[0],
+                             orNull(prob.index_), orNull(prob.value_),
+                             orNull(prob.colLower_), orNull(prob.colUpper_),
+                             orNull(prob.obj_), orNull(prob.rowLower_),
+                             orNull(prob.rowUpper_))) ;
+}
+
+/*
+  Osi1 reports trouble by throwing, and an exception mustn't escape the
+  session thread.
+*/
+int loadInto (Osi2::Osi1API *osi, const Osi2::WireProblem &prob)
+{
+    try {
+        osi->loadProblem(prob.numCols_, prob.numRows_, &prob.start_[0],
+                         orNull(prob.index_), orNull(prob.value_),
+                         orNull(prob.colLower_), orNull(prob.colUpper_),
+                         orNull(prob.obj_), orNull(prob.rowLower_),
+                         orNull(prob.rowUpper_)) ;
+    } catch (...) {
+        return (-1) ;
+    }
+    return (0) ;
+}
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+RemoteNode::RemoteNode ()
+    : listenSock_(-1),
+      port_(0),
+      running_(0),
+      libID_(nullptr),
+      loadedLib_(false),
+      haveDir_(false),
+      cacheBytes_(0),
+      maxCacheBytes_(0),
+      useClock_(0),
+      numReceived_(0)
+{ }
+
+RemoteNode::~RemoteNode ()
+{
+    stop() ;
+}
+
+bool RemoteNode::isSupported ()
+{
+    return (wireIsSupported()) ;
+}
+
+int RemoteNode::start (const std::string &lib, const std::string *dir,
+                       int port, std::string &errStr, size_t maxCacheBytes)
+{
+    stop() ;
+#   ifdef WIN32
+    errStr = "Remote nodes are not supported on this platform." ;
+    return (-1) ;
+#   else
+    /*
+      Make the cache directory first; it's the cheapest thing to undo.
+    */
+    const char *tmpDir = std::getenv("TMPDIR") ;
+    std::string dirTemplate = (tmpDir != nullptr && *tmpDir != '\0') ?
+                              tmpDir : "/tmp" ;
+    dirTemplate += "/osi2node.XXXXXX" ;
+    std::vector<char> dirName(dirTemplate.begin(), dirTemplate.end()) ;
+    dirName.push_back('\0') ;
+    if (::mkdtemp(&dirName[0]) == nullptr) {
+        errStr = "Cannot create the model cache " + dirTemplate + ": " +
+                 std::strerror(errno) ;
+        return (-1) ;
+    }
+    cacheDir_ = &dirName[0] ;
+    maxCacheBytes_ = maxCacheBytes ;
+    numReceived_ = 0 ;
+    /*
+      Objects come from this library and no other; a wildcard request might
+      otherwise find a remote shim loaded in this process, and the node would
+      end up as its own client.
+    */
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    libID_ = nullptr ;
+    const int loadStatus = plugMgr.loadOneLib(lib, dir, &libID_) ;
+    if (loadStatus < 0) {
+        errStr = "Cannot load plugin library " + lib ;
+        stop() ;
+        return (-1) ;
+    }
+    loadedLib_ = (loadStatus == 0) ;
+    lib_ = lib ;
+    haveDir_ = (dir != nullptr) ;
+    dir_ = haveDir_ ? *dir : "" ;
+
+    listenSock_ = wireListen(port, port_, errStr) ;
+    if (listenSock_ < 0) {
+        stop() ;
+        return (-1) ;
+    }
+    running_ = 1 ;
+    if (!startThread(listener_, listenMain, this)) {
+        running_ = 0 ;
+        errStr = "Cannot start the listener thread" ;
+        stop() ;
+        return (-1) ;
+    }
+    return (0) ;
+#   endif
+}
+
+/*
+  Stop the listener first, so no new sessions appear, then cut off the
+  sessions and wait for them to clean up their objects.
+*/
+void RemoteNode::stop ()
+{
+    if (atomicLoad(&running_) != 0) {
+        running_ = 0 ;
+        joinThread(listener_) ;
+    }
+    {
+        ScopedLock lock(sessionMutex_) ;
+        for (size_t i = 0 ; i < sessions_.size() ; i++)
+            wireShutdown(sessions_[i]->sock_) ;
+    }
+    reapSessions(true) ;
+    wireClose(listenSock_) ;
+    listenSock_ = -1 ;
+    port_ = 0 ;
+    if (loadedLib_) {
+        PluginManager::getInstance().unloadOneLib(lib_,
+                                                  haveDir_ ? &dir_ : nullptr) ;
+        loadedLib_ = false ;
+    }
+    libID_ = nullptr ;
+#   ifndef WIN32
+    ScopedLock lock(cacheMutex_) ;
+    std::map<uint64_t, CachedModel>::iterator iter ;
+    for (iter = cache_.begin() ; iter != cache_.end() ; iter++)
+        std::remove(iter->second.path_.c_str()) ;
+    cache_.clear() ;
+    cacheBytes_ = 0 ;
+    if (!cacheDir_.empty()) ::rmdir(cacheDir_.c_str()) ;
+    cacheDir_ = "" ;
+#   endif
+}
+
+int RemoteNode::getNumCached ()
+{
+    ScopedLock lock(cacheMutex_) ;
+    return (static_cast<int>(cache_.size())) ;
+}
+
+void *RemoteNode::listenMain (void *arg)
+{
+    static_cast<RemoteNode *>(arg)->listen() ;
+    return (nullptr) ;
+}
+
+void *RemoteNode::sessionMain (void *arg)
+{
+    Session *session = static_cast<Session *>(arg) ;
+    session->node_->serve(*session) ;
+    atomicAdd(&session->done_, 1) ;
+    return (nullptr) ;
+}
+
+/*
+  Wake up now and then to see if we should stop, and to clear away finished
+  sessions.
+*/
+void RemoteNode::listen ()
+{
+    while (atomicLoad(&running_) != 0) {
+        reapSessions(false) ;
+        const int sock = wireAccept(listenSock_, acceptInterval) ;
+        if (sock < 0) continue ;
+        Session *session = new Session ;
+        session->node_ = this ;
+        session->sock_ = sock ;
+        session->done_ = 0 ;
+        ScopedLock lock(sessionMutex_) ;
+        if (!startThread(session->thread_, sessionMain, session)) {
+            wireClose(sock) ;
+            delete session ;
+            continue ;
+        }
+        sessions_.push_back(session) ;
+    }
+}
+
+void RemoteNode::reapSessions (bool all)
+{
+    std::vector<Session *> finished ;
+    {
+        ScopedLock lock(sessionMutex_) ;
+        std::vector<Session *> live ;
+        for (size_t i = 0 ; i < sessions_.size() ; i++) {
+            if (all || atomicLoad(&sessions_[i]->done_) != 0)
+                finished.push_back(sessions_[i]) ;
+            else
+                live.push_back(sessions_[i]) ;
+        }
+        sessions_.swap(live) ;
+    }
+    for (size_t i = 0 ; i < finished.size() ; i++) {
+        joinThread(finished[i]->thread_) ;
+        wireClose(finished[i]->sock_) ;
+        delete finished[i] ;
+    }
+}
+
+/*
+  One object per connection. The session is the only user of its object, so
+  calls need no lock here; the plugin manager and the cache look after
+  themselves. The socket is closed when the session is reaped, so that #stop
+  can't shut down a descriptor that has been reused.
+*/
+void RemoteNode::serve (Session &session)
+{
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    DummyAdapter adapter ;
+    API *api = nullptr ;
+    ProbMgmtAPI *obj = nullptr ;
+    Osi1API *osi = nullptr ;
+    std::string apiName ;
+    PluginUniqueID objLib = nullptr ;
+    std::vector<char> request ;
+    std::vector<char> reply ;
+    while (wireRecv(session.sock_, request) == 0) {
+        WireReader in(request) ;
+        const int64_t op = in.getInt() ;
+        int64_t status = -1 ;
+        if (op == RemoteOpen) {
+            const int64_t version = in.getInt() ;
+            const std::string name = in.getStr() ;
+            if (in.ok() && version == remoteWireVersion && api == nullptr) {
+                objLib = libID_ ;
+                api = static_cast<API *>(
+                    plugMgr.createObject(name, objLib, adapter)) ;
+                obj = dynamic_cast<ProbMgmtAPI *>(api) ;
+                osi = dynamic_cast<Osi1API *>(api) ;
+                if (api != nullptr && obj == nullptr && osi == nullptr) {
+                    plugMgr.destroyObject(name, objLib, api) ;
+                    api = nullptr ;
+                }
+                if (api != nullptr) {
+                    apiName = name ;
+                    status = 0 ;
+                }
+            }
+        } else if (op == RemoteReadMps) {
+            const uint64_t hash = static_cast<uint64_t>(in.getInt()) ;
+            const bool keepNames = (in.getInt() != 0) ;
+            const bool ignoreErrors = (in.getInt() != 0) ;
+            std::string path ;
+            if (!in.ok() || obj == nullptr) {
+                // Bad request; status stays -1.
+            } else if (!acquireModel(hash, path)) {
+                status = remoteUnknownModel ;
+            } else {
+                status = obj->readMps(path.c_str(), keepNames, ignoreErrors) ;
+                releaseModel(hash) ;
+            }
+        } else if (op == RemotePutModel) {
+            const uint64_t hash = static_cast<uint64_t>(in.getInt()) ;
+            const std::string suffix = in.getStr() ;
+            size_t len = 0 ;
+            const char *data = in.getBytes(len) ;
+            if (in.ok()) status = putModel(hash, suffix, data, len) ;
+        } else if (op == RemoteLoadProblem) {
+            const uint64_t hash = static_cast<uint64_t>(in.getInt()) ;
+            std::string path ;
+            std::vector<char> packed ;
+            WireProblem prob ;
+            if (!in.ok() || api == nullptr) {
+                // Bad request; status stays -1.
+            } else if (!acquireModel(hash, path)) {
+                status = remoteUnknownModel ;
+            } else {
+                if (readWhole(path, packed) &&
+                        wireUnpackProblem(packed, prob)) {
+                    status = (obj != nullptr) ? loadInto(obj, prob) :
+                             loadInto(osi, prob) ;
+                }
+                releaseModel(hash) ;
+            }
+        } else if (op == RemoteInitialSolve) {
+            if (obj != nullptr) status = obj->initialSolve() ;
+        } else if (op == RemoteResolveBatch) {
+            resolveBatch(obj, in, reply) ;
+            if (wireSend(session.sock_, reply) < 0) break ;
+            continue ;
+        } else if (op == RemoteOsiSetData) {
+            status = osiSetData(osi, in) ;
+        } else if (op == RemoteOsiSolve) {
+            osiSolve(osi, in, reply) ;
+            if (wireSend(session.sock_, reply) < 0) break ;
+            continue ;
+        }
+        WireWriter(reply).putInt(status) ;
+        if (wireSend(session.sock_, reply) < 0) break ;
+    }
+    if (api != nullptr) plugMgr.destroyObject(apiName, objLib, api) ;
+}
+
+/*
+  The reply carries the results only if the batch was run. The sizes come
+  from the client, so check them before sizing anything by them; the
+  object has no way to say how big its model is.
+*/
+void RemoteNode::resolveBatch (ProbMgmtAPI *obj, WireReader &in,
+                               std::vector<char> &reply)
+{
+    const int64_t kind = in.getInt() ;
+    const int64_t numVariants = in.getInt() ;
+    const int64_t numRows = in.getInt() ;
+    const int64_t numCols = in.getInt() ;
+    std::vector<double> variants ;
+    const int64_t numValues = in.getDoubles(variants) ;
+    const bool withSolutions = (in.getInt() != 0) ;
+    const int64_t len = (kind == BatchRhs) ? numRows : numCols ;
+    const int64_t maxValues = static_cast<int64_t>(1) << 30 ;
+    WireWriter out(reply) ;
+    if (!in.ok() || obj == nullptr ||
+            (kind != BatchRhs && kind != BatchObjective) ||
+            numVariants <= 0 || numRows < 0 || numCols < 0 ||
+            numVariants > maxValues || numCols > maxValues ||
+            numValues <= 0 || numValues != numVariants*len ||
+            (withSolutions && numVariants*numCols > maxValues)) {
+        out.putInt(-1) ;
+        return ;
+    }
+    const int num = static_cast<int>(numVariants) ;
+    std::vector<int> statuses(num) ;
+    std::vector<double> objValues(num) ;
+    std::vector<double> colSolutions ;
+    if (withSolutions)
+        colSolutions.resize(static_cast<size_t>(numVariants*numCols)) ;
+    const int status = obj->resolveBatch(static_cast<BatchKind>(kind), num,
+        &variants[0], &statuses[0], &objValues[0],
+        (withSolutions && numCols > 0) ? &colSolutions[0] : nullptr) ;
+    out.putInt(status) ;
+    if (status < 0) return ;
+    out.putInts(&statuses[0], num) ;
+    out.putDoubles(&objValues[0], num) ;
+    if (withSolutions)
+        out.putDoubles(orNull(colSolutions), colSolutions.size()) ;
+    else
+        out.putDoubles(nullptr, 0) ;
+}
+
+/*
+  The arrays replace the object's own, so they must match its size. Row
+  bounds go one row at a time; Osi1 has no call that takes them all.
+*/
+int RemoteNode::osiSetData (Osi1API *osi, WireReader &in)
+{
+    std::vector<double> objSense ;
+    std::vector<double> colLower ;
+    std::vector<double> colUpper ;
+    std::vector<double> obj ;
+    std::vector<double> rowLower ;
+    std::vector<double> rowUpper ;
+    in.getDoubles(objSense) ;
+    const int64_t numColLower = in.getDoubles(colLower) ;
+    const int64_t numColUpper = in.getDoubles(colUpper) ;
+    const int64_t numObj = in.getDoubles(obj) ;
+    const int64_t numRowLower = in.getDoubles(rowLower) ;
+    const int64_t numRowUpper = in.getDoubles(rowUpper) ;
+    if (!in.ok() || osi == nullptr || objSense.size() != 1) return (-1) ;
+    try {
+        const int64_t numCols = osi->getNumCols() ;
+        const int64_t numRows = osi->getNumRows() ;
+        if (std::max<int64_t>(numColLower, 0) != numCols ||
+                std::max<int64_t>(numColUpper, 0) != numCols ||
+                std::max<int64_t>(numObj, 0) != numCols ||
+                std::max<int64_t>(numRowLower, 0) != numRows ||
+                std::max<int64_t>(numRowUpper, 0) != numRows)
+            return (-1) ;
+        osi->setObjSense(objSense[0]) ;
+        if (numCols > 0) {
+            osi->setColLower(&colLower[0]) ;
+            osi->setColUpper(&colUpper[0]) ;
+            osi->setObjective(&obj[0]) ;
+        }
+        for (int i = 0 ; i < numRows ; i++)
+            osi->setRowBounds(i, rowLower[i], rowUpper[i]) ;
+    } catch (...) {
+        return (-1) ;
+    }
+    return (0) ;
+}
+
+/*
+  The whole of the solution goes back in one reply, so the client can answer
+  its queries without asking again.
+*/
+void RemoteNode::osiSolve (Osi1API *osi, WireReader &in,
+                           std::vector<char> &reply)
+{
+    const bool resolve = (in.getInt() != 0) ;
+    if (!in.ok() || osi == nullptr) {
+        WireWriter(reply).putInt(-1) ;
+        return ;
+    }
+    try {
+        if (resolve)
+            osi->resolve() ;
+        else
+            osi->initialSolve() ;
+        int flags = 0 ;
+        if (osi->isAbandoned()) flags |= RemoteOsiAbandoned ;
+        if (osi->isProvenOptimal()) flags |= RemoteOsiOptimal ;
+        if (osi->isProvenPrimalInfeasible())
+            flags |= RemoteOsiPrimalInfeasible ;
+        if (osi->isProvenDualInfeasible()) flags |= RemoteOsiDualInfeasible ;
+        if (osi->isPrimalObjectiveLimitReached())
+            flags |= RemoteOsiPrimalObjLimit ;
+        if (osi->isDualObjectiveLimitReached())
+            flags |= RemoteOsiDualObjLimit ;
+        if (osi->isIterationLimitReached()) flags |= RemoteOsiIterationLimit ;
+        const double objValue = osi->getObjValue() ;
+        const size_t numCols = osi->getNumCols() ;
+        const size_t numRows = osi->getNumRows() ;
+        WireWriter(reply).putInt(0).putInt(flags).putDoubles(&objValue, 1)
+            .putInt(osi->getIterationCount())
+            .putDoubles(osi->getColSolution(), numCols)
+            .putDoubles(osi->getRowPrice(), numRows)
+            .putDoubles(osi->getReducedCost(), numCols)
+            .putDoubles(osi->getRowActivity(), numRows) ;
+    } catch (...) {
+        WireWriter(reply).putInt(-1) ;
+    }
+}
+
+/*
+  Write the file outside the lock, under a name private to this call, then
+  move it into place. If another session stored the same model meanwhile,
+  keep theirs.
+*/
+int RemoteNode::putModel (uint64_t hash, const std::string &suffix,
+                          const char *data, size_t len)
+{
+    if (!goodSuffix(suffix) || contentHash(data, len) != hash) return (-1) ;
+    std::ostringstream name ;
+    name << cacheDir_ << "/" << std::hex << hash ;
+    const std::string path = name.str() + suffix ;
+    {
+        ScopedLock lock(cacheMutex_) ;
+        if (cache_.find(hash) != cache_.end()) return (0) ;
+        name << "." << ++useClock_ << ".part" ;
+    }
+    const std::string partPath = name.str() ;
+    std::FILE *file = std::fopen(partPath.c_str(), "wb") ;
+    if (file == nullptr) return (-1) ;
+    const bool written = (std::fwrite(data, 1, len, file) == len) ;
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(partPath.c_str()) ;
+        return (-1) ;
+    }
+    atomicAdd(&numReceived_, 1) ;
+    ScopedLock lock(cacheMutex_) ;
+    if (cache_.find(hash) != cache_.end()) {
+        std::remove(partPath.c_str()) ;
+        return (0) ;
+    }
+    if (std::rename(partPath.c_str(), path.c_str()) != 0) {
+        std::remove(partPath.c_str()) ;
+        return (-1) ;
+    }
+    CachedModel &model = cache_[hash] ;
+    model.path_ = path ;
+    model.size_ = len ;
+    model.inUse_ = 0 ;
+    model.lastUse_ = ++useClock_ ;
+    cacheBytes_ += len ;
+    trimCache() ;
+    return (0) ;
+}
+
+bool RemoteNode::acquireModel (uint64_t hash, std::string &path)
+{
+    ScopedLock lock(cacheMutex_) ;
+    std::map<uint64_t, CachedModel>::iterator iter = cache_.find(hash) ;
+    if (iter == cache_.end()) return (false) ;
+    CachedModel &model = iter->second ;
+    model.inUse_++ ;
+    model.lastUse_ = ++useClock_ ;
+    path = model.path_ ;
+    return (true) ;
+}
+
+void RemoteNode::releaseModel (uint64_t hash)
+{
+    ScopedLock lock(cacheMutex_) ;
+    std::map<uint64_t, CachedModel>::iterator iter = cache_.find(hash) ;
+    if (iter == cache_.end()) return ;
+    iter->second.inUse_-- ;
+    trimCache() ;
+}
+
+/*
+  A model being read stays, even if that leaves the cache over its limit.
+  The newest model stays too, or a model bigger than the limit would be
+  dropped before anyone could read it.
+*/
+void RemoteNode::trimCache ()
+{
+    while (maxCacheBytes_ > 0 && cacheBytes_ > maxCacheBytes_) {
+        std::map<uint64_t, CachedModel>::iterator victim = cache_.end() ;
+        std::map<uint64_t, CachedModel>::iterator iter ;
+        for (iter = cache_.begin() ; iter != cache_.end() ; iter++) {
+            const CachedModel &model = iter->second ;
+            if (model.inUse_ > 0 || model.lastUse_ == useClock_) continue ;
+            if (victim == cache_.end() ||
+                    model.lastUse_ < victim->second.lastUse_)
+                victim = iter ;
+        }
+        if (victim == cache_.end()) break ;
+        std::remove(victim->second.path_.c_str()) ;
+        cacheBytes_ -= victim->second.size_ ;
+        cache_.erase(victim) ;
+    }
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,215 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RemoteNode.hpp
+    \brief Serve a plugin library's objects to remote clients.
+
+  See Osi2::RemoteNode.
+*/
+
+#ifndef OSI2REMOTENODE_HPP
+#define OSI2REMOTENODE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Osi2Plugin.hpp"
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+class ProbMgmtAPI ;
+class Osi1API ;
+class WireReader ;
+
+/*! \brief Serve a plugin library's objects to remote clients
+
+  A node loads a plugin library into this process' plugin manager and
+  listens for connections from remote shims (see Osi2RemoteShim). Each
+  connection holds one object, created from the library when the client
+  opens the connection and destroyed when it closes it. Each connection is
+  served by a thread of its own, so objects on one node work in parallel.
+
+  Models arrive as the content of the client's file, or packed from the
+  client's arrays, and are kept in a cache on the node, named by a hash of
+  the content (see Osi2RemoteWire.hpp). A model is sent to a node once;
+  later objects that read the same model find it in the cache. The cache
+  is kept in files in a private temporary
+  directory, since the solver reads its model from a file. When the cache
+  grows past its limit, the models used least recently are dropped.
+
+  ProbMgmtAPI and Osi1API objects can be served. An Osi1 client reads its
+  model itself and sends it as arrays; the node loads it, takes bounds and
+  objective as replacements, and solves. Not available on Windows (see
+  #isSupported).
+*/
+class RemoteNode {
+
+public:
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor
+    RemoteNode() ;
+    /// Destructor; stops the node
+    ~RemoteNode() ;
+    //@}
+
+    /// True if remote nodes are supported on this platform
+    static bool isSupported() ;
+
+    /// \name Service
+    //@{
+    /*! \brief Start serving
+
+      Loads the library \c dir/lib as PluginManager::loadOneLib would and
+      starts listening on \p port (the system chooses if \p port is 0; see
+      #getPort). If the library is already loaded, the node uses it as it
+      is and leaves it loaded on #stop. \p maxCacheBytes limits the size of
+      the model cache; 0 means no limit. If the node is already serving,
+      it's stopped first.
+
+      \return 0 on success; otherwise -1, with the reason in \p errStr.
+    */
+    int start(const std::string &lib, const std::string *dir, int port,
+              std::string &errStr, size_t maxCacheBytes = 0) ;
+
+    /*! \brief Stop serving
+
+      Closes all connections, destroys their objects, and empties the model
+      cache. A library loaded by #start is unloaded.
+    */
+    void stop() ;
+
+    /// Port the node is listening on; 0 if it isn't
+    inline int getPort () const {
+        return (port_) ;
+    }
+
+    /// Number of models in the cache
+    int getNumCached() ;
+
+    /// Number of models received from clients since #start
+    inline int getNumReceived () {
+        return (atomicLoad(&numReceived_)) ;
+    }
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    RemoteNode(const RemoteNode &rhs) ;
+    /// Assignment (not implemented)
+    RemoteNode &operator=(const RemoteNode &rhs) ;
+
+    /// One client connection
+    struct Session {
+        /// The node
+        RemoteNode *node_ ;
+        /// The connection
+        int sock_ ;
+        /// The thread serving it
+        ThreadHandle thread_ ;
+        /// Set by the thread when it's finished
+        volatile int done_ ;
+    } ;
+
+    /// A model in the cache
+    struct CachedModel {
+        /// File holding the model
+        std::string path_ ;
+        /// Size of the model
+        size_t size_ ;
+        /// Number of sessions reading the model now
+        int inUse_ ;
+        /// Value of #useClock_ when last used
+        unsigned long lastUse_ ;
+    } ;
+
+    /// Thread body of the listener
+    static void *listenMain(void *arg) ;
+    /// Thread body of a session
+    static void *sessionMain(void *arg) ;
+
+    /// Accept connections until told to stop
+    void listen() ;
+    /// Serve one connection until the client closes it
+    void serve(Session &session) ;
+    /// Run a #RemoteResolveBatch request on \p obj and build the reply
+    void resolveBatch(ProbMgmtAPI *obj, WireReader &in,
+                      std::vector<char> &reply) ;
+    /// Run a #RemoteOsiSetData request on \p osi; returns the status
+    int osiSetData(Osi1API *osi, WireReader &in) ;
+    /// Run a #RemoteOsiSolve request on \p osi and build the reply
+    void osiSolve(Osi1API *osi, WireReader &in, std::vector<char> &reply) ;
+    /// Join and discard finished sessions; all of them if \p all
+    void reapSessions(bool all) ;
+
+    /*! \brief Add a model to the cache
+
+      Checks that \p data hashes to \p hash. \p suffix (.gz, for example) is
+      kept on the file name so the solver sees how the model is compressed.
+      Returns 0 on success, -1 if the model is bad or can't be stored.
+    */
+    int putModel(uint64_t hash, const std::string &suffix,
+                 const char *data, size_t len) ;
+
+    /*! \brief Find a model in the cache and hold it there
+
+      Returns false if the model isn't cached. Otherwise returns the file in
+      \p path; the model isn't dropped until #releaseModel.
+    */
+    bool acquireModel(uint64_t hash, std::string &path) ;
+    /// Release a model held by #acquireModel
+    void releaseModel(uint64_t hash) ;
+    /// Drop models until the cache is within its limit; cache mutex held
+    void trimCache() ;
+
+    /// Listening socket
+    int listenSock_ ;
+    /// Listening port
+    int port_ ;
+    /// Nonzero while the node is serving
+    volatile int running_ ;
+    /// The listener thread
+    ThreadHandle listener_ ;
+    /// Objects come from this library
+    PluginUniqueID libID_ ;
+    /// True if #start loaded the library
+    bool loadedLib_ ;
+    /// The library and directory given to #start
+    std::string lib_ ;
+    std::string dir_ ;
+    bool haveDir_ ;
+
+    /// Live sessions
+    std::vector<Session *> sessions_ ;
+    /// Guards #sessions_
+    Mutex sessionMutex_ ;
+
+    /// Directory holding the cached models
+    std::string cacheDir_ ;
+    /// The cache, by hash
+    std::map<uint64_t, CachedModel> cache_ ;
+    /// Total size of the cached models
+    size_t cacheBytes_ ;
+    /// Limit on #cacheBytes_ (0 for none)
+    size_t maxCacheBytes_ ;
+    /// Ticks once for each use of the cache
+    unsigned long useClock_ ;
+    /// Guards the cache
+    Mutex cacheMutex_ ;
+    /// Models received
+    volatile int numReceived_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,515 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RemoteWire.cpp
+    \brief Messages and sockets for talking to remote solver nodes.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2RemoteWire.hpp"
+
+#if !defined(WIN32) && !defined(MSG_NOSIGNAL)
+# define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+inline void encode64 (uint64_t value, unsigned char *bytes)
+{
+    for (int i = 7 ; i >= 0 ; i--) {
+        bytes[i] = static_cast<unsigned char>(value&0xff) ;
+        value >>= 8 ;
+    }
+}
+
+inline uint64_t decode64 (const unsigned char *bytes)
+{
+    uint64_t value = 0 ;
+    for (int i = 0 ; i < 8 ; i++) value = (value<<8)|bytes[i] ;
+    return (value) ;
+}
+
+#ifndef WIN32
+
+int sendAll (int sock, const char *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t sent = ::send(sock, data, len, MSG_NOSIGNAL) ;
+        if (sent < 0) {
+            if (errno == EINTR) continue ;
+            return (-1) ;
+        }
+        data += sent ;
+        len -= static_cast<size_t>(sent) ;
+    }
+    return (0) ;
+}
+
+int recvAll (int sock, char *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t got = ::recv(sock, data, len, 0) ;
+        if (got < 0 && errno == EINTR) continue ;
+        if (got <= 0) return (-1) ;
+        data += got ;
+        len -= static_cast<size_t>(got) ;
+    }
+    return (0) ;
+}
+
+bool localAddress (const std::string &path, struct sockaddr_un &addr,
+                   std::string &errStr)
+{
+    std::memset(&addr, 0, sizeof(addr)) ;
+    addr.sun_family = AF_UNIX ;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        errStr = "Bad local socket path \"" + path + "\"" ;
+        return (false) ;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size()+1) ;
+    return (true) ;
+}
+
+#endif
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+WireWriter &WireWriter::putInt (int64_t value)
+{
+    unsigned char bytes[8] ;
+    encode64(static_cast<uint64_t>(value), bytes) ;
+    buf_.insert(buf_.end(), bytes, bytes+8) ;
+    return (*this) ;
+}
+
+WireWriter &WireWriter::putBytes (const char *data, size_t len)
+{
+    putInt(static_cast<int64_t>(len)) ;
+    buf_.insert(buf_.end(), data, data+len) ;
+    return (*this) ;
+}
+
+WireWriter &WireWriter::putInts (const int *vals, size_t len)
+{
+    if (vals == nullptr) return (putInt(-1)) ;
+    putInt(static_cast<int64_t>(len)) ;
+    for (size_t i = 0 ; i < len ; i++) putInt(vals[i]) ;
+    return (*this) ;
+}
+
+WireWriter &WireWriter::putDoubles (const double *vals, size_t len)
+{
+    if (vals == nullptr) return (putInt(-1)) ;
+    putInt(static_cast<int64_t>(len)) ;
+    for (size_t i = 0 ; i < len ; i++) {
+        uint64_t bits ;
+        std::memcpy(&bits, &vals[i], sizeof(bits)) ;
+        putInt(static_cast<int64_t>(bits)) ;
+    }
+    return (*this) ;
+}
+
+int64_t WireReader::getInt ()
+{
+    if (!ok_ || pos_+8 > buf_.size()) {
+        ok_ = false ;
+        return (-1) ;
+    }
+    const uint64_t value =
+        decode64(reinterpret_cast<const unsigned char *>(&buf_[pos_])) ;
+    pos_ += 8 ;
+    return (static_cast<int64_t>(value)) ;
+}
+
+const char *WireReader::getBytes (size_t &len)
+{
+    len = 0 ;
+    const int64_t fieldLen = getInt() ;
+    if (!ok_ || fieldLen < 0 ||
+            static_cast<uint64_t>(fieldLen) > buf_.size()-pos_) {
+        ok_ = false ;
+        return (nullptr) ;
+    }
+    len = static_cast<size_t>(fieldLen) ;
+    const char *data = (len > 0) ? &buf_[pos_] : "" ;
+    pos_ += len ;
+    return (data) ;
+}
+
+std::string WireReader::getStr ()
+{
+    size_t len = 0 ;
+    const char *data = getBytes(len) ;
+    if (data == nullptr) return ("") ;
+    return (std::string(data, len)) ;
+}
+
+/*
+  The count is checked against what's left of the message before anything
+  is allocated.
+*/
+int64_t WireReader::getInts (std::vector<int> &vals)
+{
+    vals.clear() ;
+    const int64_t len = getInt() ;
+    if (!ok_ || len < 0) return (-1) ;
+    if (static_cast<uint64_t>(len) > (buf_.size()-pos_)/8) {
+        ok_ = false ;
+        return (-1) ;
+    }
+    vals.resize(static_cast<size_t>(len)) ;
+    for (size_t i = 0 ; i < vals.size() ; i++)
+        vals[i] = static_cast<int>(getInt()) ;
+    return (len) ;
+}
+
+int64_t WireReader::getDoubles (std::vector<double> &vals)
+{
+    vals.clear() ;
+    const int64_t len = getInt() ;
+    if (!ok_ || len < 0) return (-1) ;
+    if (static_cast<uint64_t>(len) > (buf_.size()-pos_)/8) {
+        ok_ = false ;
+        return (-1) ;
+    }
+    vals.resize(static_cast<size_t>(len)) ;
+    for (size_t i = 0 ; i < vals.size() ; i++) {
+        const uint64_t bits = static_cast<uint64_t>(getInt()) ;
+        std::memcpy(&vals[i], &bits, sizeof(bits)) ;
+    }
+    return (len) ;
+}
+
+uint64_t contentHash (const char *data, size_t len)
+{
+    uint64_t hash = 14695981039346656037ULL ;
+    for (size_t i = 0 ; i < len ; i++) {
+        hash ^= static_cast<unsigned char>(data[i]) ;
+        hash *= 1099511628211ULL ;
+    }
+    return (hash) ;
+}
+
+void wirePackProblem (std::vector<char> &buf, int numCols, int numRows,
+                      const int *start, const int *index,
+                      const double *value, const double *colLower,
+                      const double *colUpper, const double *obj,
+                      const double *rowLower, const double *rowUpper)
+{
+    if (numCols < 0) numCols = 0 ;
+    if (numRows < 0) numRows = 0 ;
+    const size_t numElements =
+        (start != nullptr && numCols > 0) ? start[numCols] : 0 ;
+    const std::vector<int> noStart(numCols+1, 0) ;
+    WireWriter(buf).putInt(numCols).putInt(numRows)
+        .putInts((start != nullptr) ? start : &noStart[0], numCols+1)
+        .putInts(index, numElements).putDoubles(value, numElements)
+        .putDoubles(colLower, numCols).putDoubles(colUpper, numCols)
+        .putDoubles(obj, numCols).putDoubles(rowLower, numRows)
+        .putDoubles(rowUpper, numRows) ;
+}
+
+/*
+  Optional arrays may be absent, but not the wrong length. The matrix must
+  be there in full; only an empty one may be sent as absent.
+*/
+bool wireUnpackProblem (const std::vector<char> &buf, WireProblem &prob)
+{
+    WireReader in(buf) ;
+    const int64_t numCols = in.getInt() ;
+    const int64_t numRows = in.getInt() ;
+    if (!in.ok() || numCols < 0 || numRows < 0 ||
+            numCols > 0x7fffffff || numRows > 0x7fffffff)
+        return (false) ;
+    prob.numCols_ = static_cast<int>(numCols) ;
+    prob.numRows_ = static_cast<int>(numRows) ;
+    if (in.getInts(prob.start_) != numCols+1 || prob.start_[0] != 0)
+        return (false) ;
+    for (int j = 0 ; j < prob.numCols_ ; j++) {
+        if (prob.start_[j+1] < prob.start_[j]) return (false) ;
+    }
+    const int64_t numElements = prob.start_[prob.numCols_] ;
+    const int64_t numIndices = in.getInts(prob.index_) ;
+    const int64_t numValues = in.getDoubles(prob.value_) ;
+    if (std::max<int64_t>(numIndices, 0) != numElements ||
+            std::max<int64_t>(numValues, 0) != numElements)
+        return (false) ;
+    for (size_t k = 0 ; k < prob.index_.size() ; k++) {
+        if (prob.index_[k] < 0 || prob.index_[k] >= prob.numRows_)
+            return (false) ;
+    }
+    std::vector<double> *colArrays[] =
+        { &prob.colLower_, &prob.colUpper_, &prob.obj_ } ;
+    for (int i = 0 ; i < 3 ; i++) {
+        const int64_t len = in.getDoubles(*colArrays[i]) ;
+        if (len >= 0 && len != numCols) return (false) ;
+    }
+    std::vector<double> *rowArrays[] = { &prob.rowLower_, &prob.rowUpper_ } ;
+    for (int i = 0 ; i < 2 ; i++) {
+        const int64_t len = in.getDoubles(*rowArrays[i]) ;
+        if (len >= 0 && len != numRows) return (false) ;
+    }
+    return (in.ok()) ;
+}
+
+bool parseNodeList (const std::string &spec, int dfltPort,
+                    std::vector<std::pair<std::string, int> > &nodes)
+{
+    bool allGood = true ;
+    std::string work = spec ;
+    for (size_t i = 0 ; i < work.size() ; i++) {
+        if (work[i] == ',') work[i] = ' ' ;
+    }
+    std::istringstream entries(work) ;
+    std::string entry ;
+    while (entries >> entry) {
+        const size_t colon = entry.rfind(':') ;
+        std::string host = entry ;
+        int port = dfltPort ;
+        if (colon != std::string::npos) {
+            host = entry.substr(0, colon) ;
+            const std::string portStr = entry.substr(colon+1) ;
+            char *end = nullptr ;
+            const long value = std::strtol(portStr.c_str(), &end, 10) ;
+            port = (portStr.empty() || *end != '\0') ? -1 :
+                   static_cast<int>(value) ;
+        }
+        if (host.empty() || port <= 0 || port > 65535) {
+            allGood = false ;
+            continue ;
+        }
+        nodes.push_back(std::make_pair(host, port)) ;
+    }
+    return (allGood) ;
+}
+
+#ifdef WIN32
+
+bool wireIsSupported () { return (false) ; }
+
+int wireConnect (const std::string &, int, std::string &errStr)
+{
+    errStr = "Remote connections are not supported on this platform." ;
+    return (-1) ;
+}
+
+int wireListen (int, int &, std::string &errStr)
+{
+    errStr = "Remote connections are not supported on this platform." ;
+    return (-1) ;
+}
+
+int wireListenLocal (const std::string &, std::string &errStr)
+{
+    errStr = "Local sockets are not supported on this platform." ;
+    return (-1) ;
+}
+
+int wireConnectLocal (const std::string &, std::string &errStr)
+{
+    errStr = "Local sockets are not supported on this platform." ;
+    return (-1) ;
+}
+
+int wireAccept (int, int) { return (-1) ; }
+int wireSend (int, const std::vector<char> &) { return (-1) ; }
+int wireRecv (int, std::vector<char> &) { return (-1) ; }
+void wireShutdown (int) { }
+void wireClose (int) { }
+
+#else
+
+bool wireIsSupported ()
+{
+    return (true) ;
+}
+
+/*
+  Try each address the name resolves to until one accepts. Requests are
+  small and answered at once, so turn off Nagle's algorithm.
+*/
+int wireConnect (const std::string &host, int port, std::string &errStr)
+{
+    struct addrinfo hints ;
+    std::memset(&hints, 0, sizeof(hints)) ;
+    hints.ai_family = AF_UNSPEC ;
+    hints.ai_socktype = SOCK_STREAM ;
+    std::ostringstream portStr ;
+    portStr << port ;
+    struct addrinfo *addrs = nullptr ;
+    const int gaiErr =
+        ::getaddrinfo(host.c_str(), portStr.str().c_str(), &hints, &addrs) ;
+    if (gaiErr != 0) {
+        errStr = "Cannot resolve " + host + ": " + ::gai_strerror(gaiErr) ;
+        return (-1) ;
+    }
+    int sock = -1 ;
+    errStr = "Cannot connect to " + host + ":" + portStr.str() ;
+    for (struct addrinfo *addr = addrs ; addr != nullptr ;
+            addr = addr->ai_next) {
+        sock = ::socket(addr->ai_family, addr->ai_socktype,
+                        addr->ai_protocol) ;
+        if (sock < 0) continue ;
+        if (::connect(sock, addr->ai_addr, addr->ai_addrlen) == 0) break ;
+        errStr = errStr + ": " + std::strerror(errno) ;
+        ::close(sock) ;
+        sock = -1 ;
+    }
+    ::freeaddrinfo(addrs) ;
+    if (sock >= 0) {
+        const int one = 1 ;
+        ::setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) ;
+        errStr = "" ;
+    }
+    return (sock) ;
+}
+
+int wireListen (int port, int &boundPort, std::string &errStr)
+{
+    boundPort = 0 ;
+    const int sock = ::socket(AF_INET, SOCK_STREAM, 0) ;
+    if (sock < 0) {
+        errStr = std::string("Cannot create socket: ") + std::strerror(errno) ;
+        return (-1) ;
+    }
+    const int one = 1 ;
+    ::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) ;
+    struct sockaddr_in addr ;
+    std::memset(&addr, 0, sizeof(addr)) ;
+    addr.sin_family = AF_INET ;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY) ;
+    addr.sin_port = htons(static_cast<unsigned short>(port)) ;
+    socklen_t addrLen = sizeof(addr) ;
+    if (::bind(sock, reinterpret_cast<struct sockaddr *>(&addr),
+               addrLen) != 0 ||
+            ::listen(sock, SOMAXCONN) != 0 ||
+            ::getsockname(sock, reinterpret_cast<struct sockaddr *>(&addr),
+                          &addrLen) != 0) {
+        std::ostringstream msg ;
+        msg << "Cannot listen on port " << port << ": "
+            << std::strerror(errno) ;
+        errStr = msg.str() ;
+        ::close(sock) ;
+        return (-1) ;
+    }
+    boundPort = ntohs(addr.sin_port) ;
+    return (sock) ;
+}
+
+int wireListenLocal (const std::string &path, std::string &errStr)
+{
+    struct sockaddr_un addr ;
+    if (!localAddress(path, addr, errStr)) return (-1) ;
+    const int sock = ::socket(AF_UNIX, SOCK_STREAM, 0) ;
+    if (sock < 0) {
+        errStr = std::string("Cannot create socket: ") + std::strerror(errno) ;
+        return (-1) ;
+    }
+    ::unlink(path.c_str()) ;
+    if (::bind(sock, reinterpret_cast<struct sockaddr *>(&addr),
+               sizeof(addr)) != 0 ||
+            ::listen(sock, SOMAXCONN) != 0) {
+        errStr = "Cannot listen on " + path + ": " + std::strerror(errno) ;
+        ::close(sock) ;
+        return (-1) ;
+    }
+    return (sock) ;
+}
+
+int wireConnectLocal (const std::string &path, std::string &errStr)
+{
+    struct sockaddr_un addr ;
+    if (!localAddress(path, addr, errStr)) return (-1) ;
+    const int sock = ::socket(AF_UNIX, SOCK_STREAM, 0) ;
+    if (sock < 0) {
+        errStr = std::string("Cannot create socket: ") + std::strerror(errno) ;
+        return (-1) ;
+    }
+    if (::connect(sock, reinterpret_cast<struct sockaddr *>(&addr),
+                  sizeof(addr)) != 0) {
+        errStr = "Cannot connect to " + path + ": " + std::strerror(errno) ;
+        ::close(sock) ;
+        return (-1) ;
+    }
+    return (sock) ;
+}
+
+int wireAccept (int listenSock, int timeoutMs)
+{
+    struct pollfd pfd ;
+    pfd.fd = listenSock ;
+    pfd.events = POLLIN ;
+    pfd.revents = 0 ;
+    if (::poll(&pfd, 1, timeoutMs) <= 0) return (-1) ;
+    const int sock = ::accept(listenSock, nullptr, nullptr) ;
+    if (sock >= 0) {
+        // Fails harmlessly on a local socket.
+        const int one = 1 ;
+        ::setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) ;
+    }
+    return (sock) ;
+}
+
+/*
+  The length and a short message go out in one send; a long message is sent
+  from where it lies.
+*/
+int wireSend (int sock, const std::vector<char> &msg)
+{
+    char frame[256] ;
+    encode64(msg.size(), reinterpret_cast<unsigned char *>(frame)) ;
+    if (msg.size() <= sizeof(frame)-8) {
+        if (!msg.empty()) std::memcpy(frame+8, &msg[0], msg.size()) ;
+        return (sendAll(sock, frame, 8+msg.size())) ;
+    }
+    if (sendAll(sock, frame, 8) < 0) return (-1) ;
+    return (sendAll(sock, &msg[0], msg.size())) ;
+}
+
+int wireRecv (int sock, std::vector<char> &msg)
+{
+    unsigned char lenBytes[8] ;
+    if (recvAll(sock, reinterpret_cast<char *>(lenBytes), 8) < 0) return (-1) ;
+    const uint64_t len = decode64(lenBytes) ;
+    if (len > static_cast<uint64_t>(static_cast<size_t>(-1)/2)) return (-1) ;
+    msg.resize(static_cast<size_t>(len)) ;
+    if (len == 0) return (0) ;
+    return (recvAll(sock, &msg[0], msg.size())) ;
+}
+
+void wireShutdown (int sock)
+{
+    if (sock >= 0) ::shutdown(sock, SHUT_RDWR) ;
+}
+
+void wireClose (int sock)
+{
+    if (sock >= 0) ::close(sock) ;
+}
+
+#endif   // WIN32
+
+}  // end namespace Osi2
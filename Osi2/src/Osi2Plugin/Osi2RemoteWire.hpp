@@ -0,0 +1,283 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RemoteWire.hpp
+    \brief Messages and sockets for talking to remote solver nodes.
+
+  Shared by the remote node (Osi2::RemoteNode) and the remote shim that is
+  its client.
+*/
+
+#ifndef OSI2REMOTEWIRE_HPP
+#define OSI2REMOTEWIRE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace Osi2 {
+
+/*! \name Remote solver protocol
+
+  A client holds one connection to a node for each object it has there; the
+  object is created by #RemoteOpen and destroyed when the connection is
+  closed. Each request is answered by a reply that starts with a status.
+
+  Models are identified by the hash of their content (see #contentHash). A
+  node keeps the models it has been sent, so a client asks first for the
+  model by hash alone and sends the content only if the node replies
+  #remoteUnknownModel. A model read from a file travels as the file; a
+  model loaded from arrays travels packed by #wirePackProblem, and is
+  cached and asked for the same way.
+*/
+//@{
+/// Requests understood by a node
+enum RemoteOp {
+    /// (version, apiName) -> (status)
+    RemoteOpen = 1,
+    /// (hash, keepNames, ignoreErrors) -> (status)
+    RemoteReadMps,
+    /// (hash, suffix, content) -> (status)
+    RemotePutModel,
+    /// () -> (status)
+    RemoteInitialSolve,
+    /// (hash) -> (status); the model is a packed problem
+    RemoteLoadProblem,
+    /*! (kind, numVariants, numRows, numCols, variants, withSolutions) ->
+        (status, statuses, objValues, colSolutions); the results follow
+        only if the status is not negative */
+    RemoteResolveBatch,
+    /*! (objSense, colLower, colUpper, obj, rowLower, rowUpper) -> (status);
+        replaces the bounds and objective of an Osi1 object */
+    RemoteOsiSetData,
+    /*! (resolve) -> (status, flags, objValue, iterations, colSolution,
+        rowPrice, reducedCost, rowActivity); an Osi1 initialSolve, or
+        resolve if \c resolve is nonzero. \c flags is made of
+        #RemoteOsiFlag, and \c objValue is an array of one. The results
+        follow only if the status is not negative. */
+    RemoteOsiSolve
+} ;
+
+/// How an Osi1 solve ended, as the bits of the flags of #RemoteOsiSolve
+enum RemoteOsiFlag {
+    RemoteOsiAbandoned = 0x01,
+    RemoteOsiOptimal = 0x02,
+    RemoteOsiPrimalInfeasible = 0x04,
+    RemoteOsiDualInfeasible = 0x08,
+    RemoteOsiPrimalObjLimit = 0x10,
+    RemoteOsiDualObjLimit = 0x20,
+    RemoteOsiIterationLimit = 0x40
+} ;
+
+/// Status returned by #RemoteReadMps when the node doesn't hold the model
+const int remoteUnknownModel = -2 ;
+
+/// Version of the protocol; a node refuses #RemoteOpen from other versions
+const int remoteWireVersion = 3 ;
+//@}
+
+/*! \brief Build a message
+
+  A message is a sequence of fields, each an integer (8 bytes, most
+  significant first) or a string of bytes (a length, then the bytes). An
+  array is a count followed by its entries as integers; a double goes as
+  the integer with its bits, and a null array as the count -1. The two ends
+  need not share a byte order.
+*/
+class WireWriter {
+
+public:
+
+    /// Start a message in \p buf, discarding what was there
+    explicit WireWriter (std::vector<char> &buf) : buf_(buf)
+    {
+        buf_.clear() ;
+    }
+
+    /// Append an integer
+    WireWriter &putInt(int64_t value) ;
+
+    /// Append a string of \p len bytes
+    WireWriter &putBytes(const char *data, size_t len) ;
+
+    /// Append a string
+    inline WireWriter &putStr (const std::string &str)
+    {
+        return (putBytes(str.data(), str.size())) ;
+    }
+
+    /// Append an array of \p len integers; \p vals may be null
+    WireWriter &putInts(const int *vals, size_t len) ;
+
+    /// Append an array of \p len doubles; \p vals may be null
+    WireWriter &putDoubles(const double *vals, size_t len) ;
+
+private:
+
+    std::vector<char> &buf_ ;
+
+} ;
+
+/*! \brief Take apart a message built by WireWriter
+
+  Reading past the end of the message, or a string with an impossible
+  length, makes the reader not #ok; the field read returns -1 or an empty
+  string.
+*/
+class WireReader {
+
+public:
+
+    /// Read the message in \p buf
+    explicit WireReader (const std::vector<char> &buf)
+        : buf_(buf), pos_(0), ok_(true)
+    { }
+
+    /// Next field, an integer
+    int64_t getInt() ;
+
+    /// Next field, a string
+    std::string getStr() ;
+
+    /*! \brief Next field, a string, in place
+
+      Returns a pointer into the message and the length in \p len; null
+      (and \p len 0) if the field is bad.
+    */
+    const char *getBytes(size_t &len) ;
+
+    /*! \brief Next field, an array of integers, into \p vals
+
+      Returns the count, or -1 with \p vals empty for a null array or a
+      bad field.
+    */
+    int64_t getInts(std::vector<int> &vals) ;
+
+    /// Next field, an array of doubles, into \p vals; as #getInts
+    int64_t getDoubles(std::vector<double> &vals) ;
+
+    /// False once a field could not be read
+    inline bool ok () const
+    {
+        return (ok_) ;
+    }
+
+private:
+
+    const std::vector<char> &buf_ ;
+    size_t pos_ ;
+    bool ok_ ;
+
+} ;
+
+/*! \name Remote connections
+
+  Thin wrappers over stream sockets, TCP or local. Each message travels as its length (8
+  bytes, most significant first) followed by its bytes. Functions that
+  return a status return 0 on success and -1 on failure.
+*/
+//@{
+/// True if remote connections are supported on this platform
+bool wireIsSupported() ;
+
+/// Connect to \p host:\p port; returns the socket, or -1 with \p errStr
+int wireConnect(const std::string &host, int port, std::string &errStr) ;
+
+/*! \brief Listen on \p port on all interfaces
+
+  If \p port is 0 the system picks one. Returns the socket, or -1 with
+  \p errStr; the port actually used is returned in \p boundPort.
+*/
+int wireListen(int port, int &boundPort, std::string &errStr) ;
+
+/*! \brief Listen on the local socket \p path
+
+  Any file already at \p path is removed first. Returns the socket, or -1
+  with \p errStr.
+*/
+int wireListenLocal(const std::string &path, std::string &errStr) ;
+
+/// Connect to the local socket \p path; returns the socket, or -1
+int wireConnectLocal(const std::string &path, std::string &errStr) ;
+
+/*! \brief Accept a connection on \p listenSock
+
+  Waits at most \p timeoutMs milliseconds. Returns the new socket, or -1 if
+  no connection arrived in time, or on error.
+*/
+int wireAccept(int listenSock, int timeoutMs) ;
+
+/// Send a message
+int wireSend(int sock, const std::vector<char> &msg) ;
+
+/// Receive a message
+int wireRecv(int sock, std::vector<char> &msg) ;
+
+/// Stop all traffic on a socket; a thread blocked on it returns a failure
+void wireShutdown(int sock) ;
+
+/// Close a socket
+void wireClose(int sock) ;
+
+/*! \brief Parse a list of nodes
+
+  \p spec is a list of \c host:port separated by commas or white space. A
+  \c host without a port gets \p dfltPort. Returns false if any entry can't
+  be parsed; \p nodes holds the ones that could.
+*/
+bool parseNodeList(const std::string &spec, int dfltPort,
+                   std::vector<std::pair<std::string, int> > &nodes) ;
+//@}
+
+/*! \brief Hash of a model's content
+
+  64-bit FNV-1a of \p len bytes at \p data. Used to name models on remote
+  nodes; a node checks the hash of the content it's sent.
+*/
+uint64_t contentHash(const char *data, size_t len) ;
+
+/*! \brief A problem loaded from arrays, as a node unpacks it
+
+  The arrays of ProbMgmtAPI::loadProblem. A bound or objective array the
+  client left null is empty here, and goes back to the solver as null.
+*/
+struct WireProblem {
+    int numCols_ ;
+    int numRows_ ;
+    std::vector<int> start_ ;
+    std::vector<int> index_ ;
+    std::vector<double> value_ ;
+    std::vector<double> colLower_ ;
+    std::vector<double> colUpper_ ;
+    std::vector<double> obj_ ;
+    std::vector<double> rowLower_ ;
+    std::vector<double> rowUpper_ ;
+} ;
+
+/*! \brief Pack the arrays of ProbMgmtAPI::loadProblem into \p buf
+
+  The result is a model like any other: it's named by its #contentHash
+  and sent by #RemotePutModel.
+*/
+void wirePackProblem(std::vector<char> &buf, int numCols, int numRows,
+                     const int *start, const int *index, const double *value,
+                     const double *colLower, const double *colUpper,
+                     const double *obj, const double *rowLower,
+                     const double *rowUpper) ;
+
+/*! \brief Unpack a problem packed by #wirePackProblem
+
+  Returns false if \p buf doesn't hold a well-formed problem: counts that
+  don't match the sizes, column starts out of order, or a row index out of
+  range.
+*/
+bool wireUnpackProblem(const std::vector<char> &buf, WireProblem &prob) ;
+
+}  // end namespace Osi2
+
+#endif
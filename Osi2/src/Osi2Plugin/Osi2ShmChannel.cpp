@@ -0,0 +1,331 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ShmChannel.cpp
+    \brief Method definitions for Osi2::ShmChannel
+*/
+
+#include <cstring>
+#include <cerrno>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2ShmChannel.hpp"
+
+#if !defined(WIN32) && !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+# define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#if !defined(WIN32) && !defined(MSG_NOSIGNAL)
+# define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+/*
+  The rings are shared between processes. A position is written by one
+  process and read by the other; a waiting flag likewise. The wait protocol
+  (set our flag, then look at the other side's position; or publish our
+  position, then look at the other side's flag) needs sequential consistency
+  to guarantee that one side or the other sees the change.
+*/
+inline uint64_t load64 (const volatile uint64_t *target)
+{
+#  if defined(__ATOMIC_SEQ_CST)
+    return (__atomic_load_n(target, __ATOMIC_SEQ_CST)) ;
+#  else
+    __sync_synchronize() ;
+    uint64_t value = *target ;
+    __sync_synchronize() ;
+    return (value) ;
+#  endif
+}
+
+inline void store64 (volatile uint64_t *target, uint64_t value)
+{
+#  if defined(__ATOMIC_SEQ_CST)
+    __atomic_store_n(target, value, __ATOMIC_SEQ_CST) ;
+#  else
+    __sync_synchronize() ;
+    *target = value ;
+    __sync_synchronize() ;
+#  endif
+}
+
+inline int loadFlag (const volatile int *target)
+{
+#  if defined(__ATOMIC_SEQ_CST)
+    return (__atomic_load_n(target, __ATOMIC_SEQ_CST)) ;
+#  else
+    __sync_synchronize() ;
+    int value = *target ;
+    __sync_synchronize() ;
+    return (value) ;
+#  endif
+}
+
+inline void storeFlag (volatile int *target, int value)
+{
+#  if defined(__ATOMIC_SEQ_CST)
+    __atomic_store_n(target, value, __ATOMIC_SEQ_CST) ;
+#  else
+    __sync_synchronize() ;
+    *target = value ;
+    __sync_synchronize() ;
+#  endif
+}
+
+/// Ring headers are padded out to a cache line so the two don't share one
+const size_t ringHdrSize = 64 ;
+
+/// How long to sleep before looking again, milliseconds
+const int pollInterval = 100 ;
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+ShmChannel::ShmChannel ()
+    : region_(nullptr),
+      regionSize_(0),
+      capacity_(0),
+      out_(nullptr),
+      in_(nullptr),
+      outData_(nullptr),
+      inData_(nullptr),
+      mySock_(-1),
+#     ifndef WIN32
+      parentPid_(0),
+#     endif
+      connected_(false)
+{
+    sock_[0] = -1 ;
+    sock_[1] = -1 ;
+}
+
+bool ShmChannel::isSupported ()
+{
+#  ifdef WIN32
+    return (false) ;
+#  else
+    return (true) ;
+#  endif
+}
+
+#ifdef WIN32
+
+ShmChannel *ShmChannel::create (size_t, std::string &errStr)
+{
+    errStr = "Shared memory channels are not supported on this platform." ;
+    return (nullptr) ;
+}
+
+ShmChannel::~ShmChannel () { }
+void ShmChannel::attach (bool) { }
+int ShmChannel::send (const std::vector<char> &) { return (-1) ; }
+int ShmChannel::recv (std::vector<char> &) { return (-1) ; }
+int ShmChannel::writeBytes (const char *, size_t) { return (-1) ; }
+int ShmChannel::readBytes (char *, size_t) { return (-1) ; }
+int ShmChannel::wait (volatile int *, const Ring &, bool) { return (-1) ; }
+void ShmChannel::notify (volatile int *) { }
+
+#else
+
+/*
+  Layout of the region: the parent-to-child ring header, the child-to-parent
+  ring header, then the two data areas in the same order.
+*/
+ShmChannel *ShmChannel::create (size_t capacity, std::string &errStr)
+{
+    if (capacity == 0) capacity = dfltCapacity ;
+    const size_t regionSize = 2*ringHdrSize + 2*capacity ;
+    void *region = ::mmap(nullptr, regionSize, PROT_READ|PROT_WRITE,
+                          MAP_SHARED|MAP_ANONYMOUS, -1, 0) ;
+    if (region == MAP_FAILED) {
+        errStr = std::string("Cannot map shared memory: ") +
+                 std::strerror(errno) ;
+        return (nullptr) ;
+    }
+    std::memset(region, 0, 2*ringHdrSize) ;
+    int sock[2] ;
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sock) != 0) {
+        errStr = std::string("Cannot create socket pair: ") +
+                 std::strerror(errno) ;
+        ::munmap(region, regionSize) ;
+        return (nullptr) ;
+    }
+    ShmChannel *channel = new ShmChannel() ;
+    channel->region_ = region ;
+    channel->regionSize_ = regionSize ;
+    channel->capacity_ = capacity ;
+    channel->sock_[0] = sock[0] ;
+    channel->sock_[1] = sock[1] ;
+    channel->connected_ = true ;
+    return (channel) ;
+}
+
+ShmChannel::~ShmChannel ()
+{
+    for (int i = 0 ; i < 2 ; i++) {
+        if (sock_[i] >= 0) ::close(sock_[i]) ;
+    }
+    if (region_ != nullptr) ::munmap(region_, regionSize_) ;
+}
+
+/*
+  The parent keeps socket 0 and writes the first ring; the child keeps
+  socket 1 and writes the second.
+*/
+void ShmChannel::attach (bool isChild)
+{
+    char *base = static_cast<char *>(region_) ;
+    Ring *toChild = reinterpret_cast<Ring *>(base) ;
+    Ring *toParent = reinterpret_cast<Ring *>(base+ringHdrSize) ;
+    char *toChildData = base+2*ringHdrSize ;
+    char *toParentData = toChildData+capacity_ ;
+    if (isChild) {
+        out_ = toParent ;
+        outData_ = toParentData ;
+        in_ = toChild ;
+        inData_ = toChildData ;
+        mySock_ = 1 ;
+        parentPid_ = ::getppid() ;
+    } else {
+        out_ = toChild ;
+        outData_ = toChildData ;
+        in_ = toParent ;
+        inData_ = toParentData ;
+        mySock_ = 0 ;
+    }
+    ::close(sock_[1-mySock_]) ;
+    sock_[1-mySock_] = -1 ;
+}
+
+int ShmChannel::send (const std::vector<char> &msg)
+{
+    const uint64_t len = msg.size() ;
+    if (writeBytes(reinterpret_cast<const char *>(&len), sizeof(len)) < 0)
+        return (-1) ;
+    if (len == 0) return (0) ;
+    return (writeBytes(&msg[0], msg.size())) ;
+}
+
+int ShmChannel::recv (std::vector<char> &msg)
+{
+    uint64_t len = 0 ;
+    if (readBytes(reinterpret_cast<char *>(&len), sizeof(len)) < 0)
+        return (-1) ;
+    msg.resize(static_cast<size_t>(len)) ;
+    if (len == 0) return (0) ;
+    return (readBytes(&msg[0], msg.size())) ;
+}
+
+/*
+  Copy as much as fits, publish it, and wake the reader if it's asleep.
+  Repeat until done. Only the writer changes tail_, so we can read our own
+  copy without ceremony.
+*/
+int ShmChannel::writeBytes (const char *data, size_t len)
+{
+    while (len > 0) {
+        if (!connected_) return (-1) ;
+        const uint64_t tail = out_->tail_ ;
+        const size_t used = static_cast<size_t>(tail-load64(&out_->head_)) ;
+        const size_t space = capacity_-used ;
+        if (space == 0) {
+            if (wait(&out_->writerWaiting_, *out_, false) < 0) return (-1) ;
+            continue ;
+        }
+        const size_t chunk = (len < space) ? len : space ;
+        const size_t offset = static_cast<size_t>(tail%capacity_) ;
+        const size_t first =
+            (chunk < capacity_-offset) ? chunk : capacity_-offset ;
+        std::memcpy(outData_+offset, data, first) ;
+        std::memcpy(outData_, data+first, chunk-first) ;
+        store64(&out_->tail_, tail+chunk) ;
+        notify(&out_->readerWaiting_) ;
+        data += chunk ;
+        len -= chunk ;
+    }
+    return (0) ;
+}
+
+int ShmChannel::readBytes (char *data, size_t len)
+{
+    while (len > 0) {
+        const uint64_t head = in_->head_ ;
+        const size_t avail = static_cast<size_t>(load64(&in_->tail_)-head) ;
+        if (avail == 0) {
+            if (!connected_) return (-1) ;
+            if (wait(&in_->readerWaiting_, *in_, true) < 0) return (-1) ;
+            continue ;
+        }
+        const size_t chunk = (len < avail) ? len : avail ;
+        const size_t offset = static_cast<size_t>(head%capacity_) ;
+        const size_t first =
+            (chunk < capacity_-offset) ? chunk : capacity_-offset ;
+        std::memcpy(data, inData_+offset, first) ;
+        std::memcpy(data+first, inData_, chunk-first) ;
+        store64(&in_->head_, head+chunk) ;
+        notify(&in_->writerWaiting_) ;
+        data += chunk ;
+        len -= chunk ;
+    }
+    return (0) ;
+}
+
+/*
+  Announce that we're waiting, then look again: the other process may have
+  acted between our last look and the announcement, in which case it may not
+  have seen the flag. Sleep with a timeout, so that a lost doorbell costs
+  only a delay and so that the child notices the death of its parent (which
+  it can't learn from the socket if a sibling inherited the parent's end).
+*/
+int ShmChannel::wait (volatile int *flag, const Ring &ring, bool forData)
+{
+    storeFlag(flag, 1) ;
+    const uint64_t used = load64(&ring.tail_)-load64(&ring.head_) ;
+    const bool ready = forData ? (used != 0) : (used < capacity_) ;
+    if (!ready) {
+        struct pollfd pfd ;
+        pfd.fd = sock_[mySock_] ;
+        pfd.events = POLLIN ;
+        pfd.revents = 0 ;
+        const int result = ::poll(&pfd, 1, pollInterval) ;
+        if (result > 0) {
+            char bells[64] ;
+            const ssize_t got =
+                ::recv(pfd.fd, bells, sizeof(bells), MSG_DONTWAIT) ;
+            if (got == 0 ||
+                    (got < 0 && errno != EAGAIN && errno != EINTR))
+                connected_ = false ;
+        } else if (result < 0 && errno != EINTR) {
+            connected_ = false ;
+        } else if (mySock_ == 1 && ::getppid() != parentPid_) {
+            connected_ = false ;
+        }
+    }
+    storeFlag(flag, 0) ;
+    return (connected_ ? 0 : -1) ;
+}
+
+void ShmChannel::notify (volatile int *flag)
+{
+    if (loadFlag(flag) == 0) return ;
+    const char bell = 0 ;
+    ::send(sock_[mySock_], &bell, 1, MSG_DONTWAIT|MSG_NOSIGNAL) ;
+}
+
+#endif   // WIN32
+
+}  // end namespace Osi2
@@ -0,0 +1,166 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ShmChannel.hpp
+    \brief A shared memory message channel between two processes.
+
+  See Osi2::ShmChannel.
+*/
+
+#ifndef OSI2SHMCHANNEL_HPP
+#define OSI2SHMCHANNEL_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/types.h>
+#endif
+
+namespace Osi2 {
+
+/*! \brief A shared memory message channel between a parent and a child
+  process
+
+  The channel is a pair of byte rings in a shared memory region, one for each
+  direction, created by the parent before it forks. Messages of any size can
+  be sent: a message larger than the ring is streamed through it, the reader
+  consuming while the writer produces. The bytes of a message are copied into
+  the ring by the sender and out of it by the receiver, and that's all; they
+  don't pass through the kernel.
+
+  A socket pair serves as the doorbell. A process that must wait (for data,
+  or for space) says so in the shared region and sleeps on its end of the
+  socket; the other process sends a byte when it changes the state of the
+  ring. The socket also tells each process when the other has gone away:
+  if the child crashes, the parent's next send or receive fails rather than
+  waiting forever. (The child also checks that its parent is still its
+  parent.)
+
+  Each direction has a single writer and a single reader. The channel does
+  no locking; a process that uses it from several threads must serialise
+  them.
+
+  Not available on Windows (see #isSupported).
+*/
+class ShmChannel {
+
+public:
+
+    /// Default capacity of each ring, in bytes
+    static const size_t dfltCapacity = 1<<20 ;
+
+    /*! \brief Create a channel with rings of \p capacity bytes
+
+      Returns null if the region or the socket pair can't be created, with
+      the reason in \p errStr.
+    */
+    static ShmChannel *create(size_t capacity, std::string &errStr) ;
+
+    /// True if channels are supported on this platform
+    static bool isSupported() ;
+
+    /// Destructor; unmaps the region and closes this process' socket
+    ~ShmChannel() ;
+
+    /*! \brief Choose a side
+
+      Must be called by each process after the fork, the parent with \p
+      isChild false, the child with \p isChild true. Closes the other
+      process' end of the socket.
+    */
+    void attach(bool isChild) ;
+
+    /*! \brief Send a message
+
+      Blocks until the whole message has been placed in the ring. Returns 0
+      on success, -1 if the other process has gone away.
+    */
+    int send(const std::vector<char> &msg) ;
+
+    /*! \brief Receive a message
+
+      Blocks until a whole message has arrived. Returns 0 on success, -1 if
+      the other process has gone away.
+    */
+    int recv(std::vector<char> &msg) ;
+
+    /// False once the other process is known to have gone away
+    inline bool isConnected () const {
+        return (connected_) ;
+    }
+
+private:
+
+    /// One direction of the channel, as laid out in the shared region
+    struct Ring {
+        /// Bytes consumed by the reader, ever
+        volatile uint64_t head_ ;
+        /// Bytes produced by the writer, ever
+        volatile uint64_t tail_ ;
+        /// Nonzero while the reader waits for data
+        volatile int readerWaiting_ ;
+        /// Nonzero while the writer waits for space
+        volatile int writerWaiting_ ;
+    } ;
+
+    /// Constructor; see #create
+    ShmChannel() ;
+    /// Copy constructor (not implemented)
+    ShmChannel(const ShmChannel &rhs) ;
+    /// Assignment (not implemented)
+    ShmChannel &operator=(const ShmChannel &rhs) ;
+
+    /// Copy \p len bytes into the outgoing ring
+    int writeBytes(const char *data, size_t len) ;
+    /// Copy \p len bytes out of the incoming ring
+    int readBytes(char *data, size_t len) ;
+
+    /*! \brief Sleep until the other process rings the doorbell
+
+      \p flag is our waiting flag in \p ring; it's set while we sleep. If
+      \p forData, we're waiting for the ring to hold data, otherwise for it
+      to have space. Returns -1 if the other process has gone away, 0 when
+      there's reason to look again (which may be immediately, if the
+      condition already holds).
+    */
+    int wait(volatile int *flag, const Ring &ring, bool forData) ;
+
+    /// Ring the doorbell if the other process is waiting on \p flag
+    void notify(volatile int *flag) ;
+
+    /// The shared region
+    void *region_ ;
+    /// Size of the shared region
+    size_t regionSize_ ;
+    /// Capacity of each ring
+    size_t capacity_ ;
+    /// Ring we write (parent to child, or child to parent)
+    Ring *out_ ;
+    /// Ring we read
+    Ring *in_ ;
+    /// Data area of #out_
+    char *outData_ ;
+    /// Data area of #in_
+    char *inData_ ;
+    /// Socket pair; after #attach only our end is open
+    int sock_[2] ;
+    /// Index of our end of the socket pair
+    int mySock_ ;
+#   ifndef WIN32
+    /// In the child, the parent's process ID
+    pid_t parentPid_ ;
+#   endif
+    /// False once the other process is known to have gone away
+    bool connected_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
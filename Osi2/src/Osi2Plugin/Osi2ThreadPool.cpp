@@ -0,0 +1,297 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ThreadPool.cpp
+    \brief Method definitions for Osi2::ThreadPool
+*/
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2ThreadPool.hpp"
+
+namespace {
+
+/*
+  The pool a worker thread belongs to, and its index there. Thread-local
+  storage holds only plain data, hence the two variables.
+*/
+OSI2_THREAD_LOCAL const void *tlsPool = 0 ;
+OSI2_THREAD_LOCAL int tlsIndex = -1 ;
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+const int ThreadPool::maxThreads ;
+
+ThreadPool::ThreadPool ()
+    : wanted_(-1),
+      started_(0),
+      numRunning_(0),
+      numSlots_(0),
+      numQueued_(0),
+      numIdle_(0),
+      stopping_(0),
+      idleCond_(new Condition()),
+      numRun_(0),
+      numStolen_(0),
+      numHelped_(0)
+{
+    for (int i = 0 ; i < maxThreads ; i++) workers_[i] = nullptr ;
+}
+
+/*
+  Nothing queued is left behind: what the workers didn't get to is run
+  here.
+*/
+ThreadPool::~ThreadPool ()
+{
+    stop() ;
+    while (runOne(-1)) ;
+    for (int i = 0 ; i < numSlots_ ; i++) delete workers_[i] ;
+    delete idleCond_ ;
+}
+
+int ThreadPool::selfIndex () const
+{
+    return ((tlsPool == this) ? tlsIndex : -1) ;
+}
+
+bool ThreadPool::take (Queue &queue, bool back, Task &task)
+{
+    ScopedLock lock(queue.mutex_) ;
+    if (queue.tasks_.empty()) return (false) ;
+    if (back) {
+        task = queue.tasks_.back() ;
+        queue.tasks_.pop_back() ;
+    } else {
+        task = queue.tasks_.front() ;
+        queue.tasks_.pop_front() ;
+    }
+    return (true) ;
+}
+
+/*
+  Own deque first, newest first; then the shared queue; then the other
+  workers, oldest first, starting with the next one along so that thieves
+  spread out.
+*/
+bool ThreadPool::runOne (int self)
+{
+    if (atomicLoad(&numQueued_) == 0) return (false) ;
+    Task task ;
+    bool found = false ;
+    bool stolen = false ;
+    if (self >= 0) found = take(workers_[self]->queue_, true, task) ;
+    if (!found) found = take(shared_, false, task) ;
+    if (!found) {
+        const int numSlots = atomicLoad(&numSlots_) ;
+        for (int k = 1 ; k <= numSlots && !found ; k++) {
+            const int i = (self+k+numSlots)%numSlots ;
+            if (i == self) continue ;
+            found = take(workers_[i]->queue_, false, task) ;
+            stolen = found ;
+        }
+    }
+    if (!found) return (false) ;
+    atomicAdd(&numQueued_, -1) ;
+    atomicAdd(&numRun_, 1) ;
+    if (self < 0) {
+        atomicAdd(&numHelped_, 1) ;
+    } else if (stolen) {
+        atomicAdd(&numStolen_, 1) ;
+    }
+    task.func_(task.arg_) ;
+    if (task.group_ != nullptr) atomicAdd(&task.group_->pending_, -1) ;
+    return (true) ;
+}
+
+/*
+  A worker leaves only when it's been told to and can find nothing to run.
+  The count of queued tasks is checked under idleMutex_, which a submitter
+  takes to wake a sleeper, so a task can't slip in unseen between the
+  check and the sleep.
+*/
+void *ThreadPool::workerMain (void *arg)
+{
+    Worker *worker = static_cast<Worker *>(arg) ;
+    ThreadPool &pool = *worker->pool_ ;
+    tlsPool = &pool ;
+    tlsIndex = worker->index_ ;
+    for (;;) {
+        if (pool.runOne(worker->index_)) continue ;
+        ScopedLock lock(pool.idleMutex_) ;
+        if (pool.stopping_) break ;
+        if (atomicLoad(&pool.numQueued_) != 0) continue ;
+        pool.numIdle_++ ;
+        pool.idleCond_->wait(pool.idleMutex_) ;
+        pool.numIdle_-- ;
+    }
+    tlsPool = 0 ;
+    tlsIndex = -1 ;
+    return (nullptr) ;
+}
+
+void ThreadPool::start ()
+{
+    ScopedLock lock(startMutex_) ;
+    if (started_) return ;
+    int wanted = (wanted_ < 0) ? numProcessors()-1 : wanted_ ;
+    if (wanted > maxThreads) wanted = maxThreads ;
+    int running = 0 ;
+    for (int i = 0 ; i < wanted ; i++) {
+        if (workers_[i] == nullptr) {
+            Worker *worker = new Worker() ;
+            worker->pool_ = this ;
+            worker->index_ = i ;
+            workers_[i] = worker ;
+            atomicAdd(&numSlots_, 1) ;
+        }
+        if (!startThread(workers_[i]->thread_, workerMain, workers_[i]))
+            break ;
+        running++ ;
+    }
+    numRunning_ = running ;
+    atomicAdd(&started_, 1) ;
+}
+
+void ThreadPool::stopLocked ()
+{
+    if (!started_) return ;
+    {
+        ScopedLock lock(idleMutex_) ;
+        stopping_ = 1 ;
+        idleCond_->wakeAll() ;
+    }
+    for (int i = 0 ; i < numRunning_ ; i++) joinThread(workers_[i]->thread_) ;
+    while (runOne(-1)) ;
+    numRunning_ = 0 ;
+    stopping_ = 0 ;
+    atomicAdd(&started_, -1) ;
+}
+
+void ThreadPool::stop ()
+{
+    ScopedLock lock(startMutex_) ;
+    stopLocked() ;
+}
+
+void ThreadPool::setNumThreads (int numThreads)
+{
+    ScopedLock lock(startMutex_) ;
+    stopLocked() ;
+    wanted_ = (numThreads < 0) ? -1 : numThreads ;
+}
+
+int ThreadPool::getNumThreads () const
+{
+    if (atomicLoad(const_cast<volatile int *>(&started_)))
+        return (atomicLoad(const_cast<volatile int *>(&numRunning_))) ;
+    const int wanted = (wanted_ < 0) ? numProcessors()-1 : wanted_ ;
+    return ((wanted > maxThreads) ? maxThreads : wanted) ;
+}
+
+/*
+  With no workers the task runs here, now; waiting for it would otherwise
+  be the only way it ever ran. A task from a worker goes on the worker's
+  own deque.
+*/
+void ThreadPool::submit (TaskFunc func, void *arg, TaskGroup *group)
+{
+    if (!atomicLoad(&started_)) start() ;
+    if (atomicLoad(&numRunning_) == 0) {
+        func(arg) ;
+        return ;
+    }
+    if (group != nullptr) atomicAdd(&group->pending_, 1) ;
+    Task task ;
+    task.func_ = func ;
+    task.arg_ = arg ;
+    task.group_ = group ;
+    const int self = selfIndex() ;
+    Queue &queue = (self >= 0) ? workers_[self]->queue_ : shared_ ;
+    {
+        ScopedLock lock(queue.mutex_) ;
+        queue.tasks_.push_back(task) ;
+    }
+    atomicAdd(&numQueued_, 1) ;
+    ScopedLock lock(idleMutex_) ;
+    if (numIdle_ > 0) idleCond_->wakeOne() ;
+}
+
+void ThreadPool::wait (TaskGroup *group)
+{
+    const int self = selfIndex() ;
+    while (atomicLoad(&group->pending_) > 0) {
+        if (!runOne(self)) yieldThread() ;
+    }
+}
+
+/*
+  The first task is the caller's, which saves a trip through a queue.
+*/
+void ThreadPool::run (TaskFunc func, void **args, int count)
+{
+    if (count <= 0) return ;
+    TaskGroup group ;
+    group.pending_ = 0 ;
+    for (int i = 1 ; i < count ; i++) submit(func, args[i], &group) ;
+    func(args[0]) ;
+    wait(&group) ;
+}
+
+void ThreadPool::getStats (Stats &stats) const
+{
+    stats.numThreads_ = atomicLoad(const_cast<volatile int *>(&numRunning_)) ;
+    stats.numRun_ = atomicLoad(const_cast<volatile int *>(&numRun_)) ;
+    stats.numStolen_ = atomicLoad(const_cast<volatile int *>(&numStolen_)) ;
+    stats.numHelped_ = atomicLoad(const_cast<volatile int *>(&numHelped_)) ;
+}
+
+/*
+  In the order the pool takes them: startMutex_, then a queue, then
+  idleMutex_ (submit takes a queue and idleMutex_ one after the other,
+  never both at once, but a fixed order costs nothing).
+*/
+void ThreadPool::lockForFork ()
+{
+    startMutex_.lock() ;
+    shared_.mutex_.lock() ;
+    for (int i = 0 ; i < numSlots_ ; i++) workers_[i]->queue_.mutex_.lock() ;
+    idleMutex_.lock() ;
+}
+
+/*
+  The child's condition variable may have had waiters in the parent;
+  rather than destroy it, the child leaks it and makes another.
+*/
+void ThreadPool::unlockAfterFork (bool child)
+{
+    if (child) {
+        idleMutex_.reset() ;
+        for (int i = 0 ; i < numSlots_ ; i++) {
+            workers_[i]->queue_.tasks_.clear() ;
+            workers_[i]->queue_.mutex_.reset() ;
+        }
+        shared_.tasks_.clear() ;
+        shared_.mutex_.reset() ;
+        numQueued_ = 0 ;
+        numIdle_ = 0 ;
+        numRunning_ = 0 ;
+        stopping_ = 0 ;
+        started_ = 0 ;
+        idleCond_ = new Condition() ;
+        startMutex_.reset() ;
+    } else {
+        idleMutex_.unlock() ;
+        for (int i = numSlots_-1 ; i >= 0 ; i--)
+            workers_[i]->queue_.mutex_.unlock() ;
+        shared_.mutex_.unlock() ;
+        startMutex_.unlock() ;
+    }
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,214 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ThreadPool.hpp
+    \brief A work-stealing thread pool shared by everything in the process.
+
+  See Osi2::ThreadPool. Plugins reach the plugin manager's pool through the
+  thread pool service (see Osi2PluginThreads.hpp).
+*/
+
+#ifndef OSI2THREADPOOL_HPP
+#define OSI2THREADPOOL_HPP
+
+#include <deque>
+
+#include "Osi2Plugin.hpp"
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*! \brief A work-stealing thread pool
+
+  Each worker has a deque of tasks. A task submitted from a worker goes on
+  the back of the worker's own deque and the worker takes tasks from the
+  back, newest first, so nested work stays on one core while it's hot. A
+  task submitted from any other thread goes on a shared queue. A worker
+  with nothing of its own takes from the shared queue, then steals from the
+  front of another worker's deque.
+
+  A thread waiting for a TaskGroup runs queued tasks while it waits, so a
+  task can wait for tasks it submitted without tying up its worker, and a
+  pool of no workers (one processor, say) still runs everything, on the
+  waiting threads.
+
+  The workers are started the first time a task is submitted, and sleep
+  when there's nothing to do. All methods are thread-safe.
+*/
+class ThreadPool {
+
+public:
+
+    /// A snapshot of the pool's counters
+    struct Stats {
+        /// Worker threads running
+        int numThreads_ ;
+        /// Tasks run
+        int numRun_ ;
+        /// Tasks run by a worker other than the one they were queued for
+        int numStolen_ ;
+        /// Tasks run by a thread waiting for a group
+        int numHelped_ ;
+    } ;
+
+    /// \name Constructors and Destructors
+    //@{
+    /// Constructor; one worker per processor but one, started when needed
+    ThreadPool() ;
+
+    /// Destructor; runs what's queued and stops the workers
+    ~ThreadPool() ;
+    //@}
+
+    /// \name Tasks
+    //@{
+    /*! \brief Submit \p func(\p arg), counted in \p group
+
+      \p group may be null. With no workers, the task is run before submit
+      returns.
+    */
+    void submit(TaskFunc func, void *arg, TaskGroup *group) ;
+
+    /// Wait for the tasks in \p group, running queued tasks meanwhile
+    void wait(TaskGroup *group) ;
+
+    /// Run \p func(\p args[i]) for i in 0 .. \p count-1 and wait for them
+    void run(TaskFunc func, void **args, int count) ;
+    //@}
+
+    /// \name Control
+    //@{
+    /*! \brief Set the number of worker threads
+
+      Negative means one per processor but one. Workers already running
+      finish what's queued and stop; the new number start as needed.
+    */
+    void setNumThreads(int numThreads) ;
+
+    /// Number of worker threads the pool runs
+    int getNumThreads() const ;
+
+    /// Run what's queued and stop the workers; they start again as needed
+    void stop() ;
+
+    /// Snapshot of the counters
+    void getStats(Stats &stats) const ;
+
+    /// Take every lock in the pool, before fork(2)
+    void lockForFork() ;
+
+    /*! \brief Release the locks taken by #lockForFork
+
+      In the child, the workers are gone. Tasks still queued are dropped:
+      they were the parent's, and the parent will run them. New workers
+      start as needed.
+    */
+    void unlockAfterFork(bool child) ;
+    //@}
+
+private:
+
+    /// Copy constructor (not implemented)
+    ThreadPool(const ThreadPool &rhs) ;
+    /// Assignment (not implemented)
+    ThreadPool &operator=(const ThreadPool &rhs) ;
+
+    /// A queued task
+    struct Task {
+        /// The task
+        TaskFunc func_ ;
+        /// Its argument
+        void *arg_ ;
+        /// Group to tell when it's done; may be null
+        TaskGroup *group_ ;
+    } ;
+
+    /// A task queue and its lock
+    struct Queue {
+        /// Tasks, oldest first
+        std::deque<Task> tasks_ ;
+        /// Guards #tasks_
+        Mutex mutex_ ;
+    } ;
+
+    /// A worker thread and its deque
+    struct Worker {
+        /// The pool
+        ThreadPool *pool_ ;
+        /// Index in ThreadPool::workers_
+        int index_ ;
+        /// The thread, while it runs
+        ThreadHandle thread_ ;
+        /// Tasks submitted by the worker
+        Queue queue_ ;
+    } ;
+
+    /// Body of a worker thread
+    static void *workerMain(void *arg) ;
+
+    /// Start the workers if they aren't running
+    void start() ;
+
+    /// Stop the workers; #startMutex_ must be held
+    void stopLocked() ;
+
+    /*! \brief Find a task and run it
+
+      \p self is the calling worker's index, or -1 for a thread not in the
+      pool. Returns false if there was nothing to run.
+    */
+    bool runOne(int self) ;
+
+    /// Take a task from \p queue, the back if \p back; false if it's empty
+    static bool take(Queue &queue, bool back, Task &task) ;
+
+    /// The calling thread's index in this pool; -1 if it isn't a worker
+    int selfIndex() const ;
+
+    /*! \brief Most workers
+
+      Workers are made as needed and kept, with their deques, until the pool
+      is destroyed, so that a thread looking for work never finds a worker
+      gone.
+    */
+    static const int maxThreads = 256 ;
+
+    /// Workers wanted; -1 for one per processor but one
+    int wanted_ ;
+    /// Set once the workers have been started
+    volatile int started_ ;
+    /// Workers running
+    volatile int numRunning_ ;
+    /// Workers made; the first #numSlots_ entries of #workers_
+    volatile int numSlots_ ;
+    /// Workers
+    Worker *workers_[maxThreads] ;
+    /// Tasks from threads not in the pool
+    Queue shared_ ;
+    /// Tasks queued and not yet taken
+    volatile int numQueued_ ;
+    /// Workers asleep
+    int numIdle_ ;
+    /// Set to tell the workers to stop
+    volatile int stopping_ ;
+    /// Guards #numIdle_ and the sleep of idle workers
+    Mutex idleMutex_ ;
+    /// Where idle workers sleep; a pointer so the child of a fork can replace it
+    Condition *idleCond_ ;
+    /// Serialises starting and stopping
+    Mutex startMutex_ ;
+    /// Tasks run
+    volatile int numRun_ ;
+    /// Tasks stolen
+    volatile int numStolen_ ;
+    /// Tasks run by threads not in the pool
+    volatile int numHelped_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,379 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Threads.hpp
+    \brief Minimal thread support for the plugin framework.
+
+  Thin wrappers around the pthreads mutex and condition variable, plus the
+  handful of atomic operations the plugin manager needs. Atomics use the gcc
+  __atomic builtins where available (gcc 4.7 and later) and the older __sync
+  builtins otherwise.
+
+  Like DynamicLibrary, there are hooks for Windows but they are untested.
+*/
+
+#ifndef OSI2THREADS_HPP
+#define OSI2THREADS_HPP
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/*! \brief Declare a variable with thread-local storage
+
+  Only plain old data can be thread-local.
+*/
+#if defined(_MSC_VER)
+# define OSI2_THREAD_LOCAL __declspec(thread)
+#else
+# define OSI2_THREAD_LOCAL __thread
+#endif
+
+namespace Osi2 {
+
+/*! \brief A mutex
+
+  The mutex can be recursive (the owning thread can lock it repeatedly; it
+  must unlock it an equal number of times) or not. Not copyable.
+*/
+class Mutex {
+
+public:
+
+    /// Constructor
+    Mutex (bool recursive = false)
+        : recursive_(recursive)
+    {
+        init() ;
+    }
+
+    /// Destructor
+    ~Mutex ()
+    {
+#     ifdef WIN32
+        ::DeleteCriticalSection(&mutex_) ;
+#     else
+        ::pthread_mutex_destroy(&mutex_) ;
+#     endif
+    }
+
+    /// Acquire the mutex
+    inline void lock ()
+    {
+#     ifdef WIN32
+        ::EnterCriticalSection(&mutex_) ;
+#     else
+        ::pthread_mutex_lock(&mutex_) ;
+#     endif
+    }
+
+    /// Release the mutex
+    inline void unlock ()
+    {
+#     ifdef WIN32
+        ::LeaveCriticalSection(&mutex_) ;
+#     else
+        ::pthread_mutex_unlock(&mutex_) ;
+#     endif
+    }
+
+    /*! \brief Return the mutex to its initial, unlocked, state
+
+      For use only in the child after fork(2), on a mutex that was locked by
+      the thread that forked. The child can't simply unlock it: ownership is
+      recorded by thread, and the child's thread is not the parent's.
+    */
+    inline void reset ()
+    {
+        init() ;
+    }
+
+private:
+
+    /// Initialise the platform mutex
+    inline void init ()
+    {
+#     ifdef WIN32
+        ::InitializeCriticalSection(&mutex_) ;
+#     else
+        pthread_mutexattr_t attr ;
+        ::pthread_mutexattr_init(&attr) ;
+        if (recursive_)
+            ::pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE) ;
+        ::pthread_mutex_init(&mutex_, &attr) ;
+        ::pthread_mutexattr_destroy(&attr) ;
+#     endif
+    }
+
+    /// Copy constructor (not implemented)
+    Mutex(const Mutex &rhs) ;
+    /// Assignment (not implemented)
+    Mutex &operator=(const Mutex &rhs) ;
+
+    friend class Condition ;
+
+    /// True if the mutex is recursive
+    bool recursive_ ;
+
+#   ifdef WIN32
+    /// Platform mutex
+    CRITICAL_SECTION mutex_ ;
+#   else
+    /// Platform mutex
+    pthread_mutex_t mutex_ ;
+#   endif
+
+} ;
+
+/*! \brief A condition variable
+
+  For waiting, with a (non-recursive) Mutex held, until another thread says
+  that something has changed. As usual, wakeups can be spurious: recheck
+  the condition after each #wait. Not copyable.
+*/
+class Condition {
+
+public:
+
+    /// Constructor
+    Condition ()
+    {
+#     ifdef WIN32
+        ::InitializeConditionVariable(&cond_) ;
+#     else
+        ::pthread_cond_init(&cond_, NULL) ;
+#     endif
+    }
+
+    /// Destructor
+    ~Condition ()
+    {
+#     ifndef WIN32
+        ::pthread_cond_destroy(&cond_) ;
+#     endif
+    }
+
+    /// Release \p mutex, wait to be woken, and acquire \p mutex again
+    inline void wait (Mutex &mutex)
+    {
+#     ifdef WIN32
+        ::SleepConditionVariableCS(&cond_, &mutex.mutex_, INFINITE) ;
+#     else
+        ::pthread_cond_wait(&cond_, &mutex.mutex_) ;
+#     endif
+    }
+
+    /*! \brief As #wait, but for no more than \p millisecs milliseconds
+
+      Returns false if the time ran out.
+    */
+    inline bool waitFor (Mutex &mutex, int millisecs)
+    {
+#     ifdef WIN32
+        return (::SleepConditionVariableCS(&cond_, &mutex.mutex_,
+                                           millisecs) != 0) ;
+#     else
+        struct timespec until ;
+        ::clock_gettime(CLOCK_REALTIME, &until) ;
+        until.tv_sec += millisecs/1000 ;
+        until.tv_nsec += (millisecs%1000)*1000000L ;
+        if (until.tv_nsec >= 1000000000L) {
+            until.tv_sec++ ;
+            until.tv_nsec -= 1000000000L ;
+        }
+        return (::pthread_cond_timedwait(&cond_, &mutex.mutex_, &until) == 0) ;
+#     endif
+    }
+
+    /// Wake one waiting thread, if there is one
+    inline void wakeOne ()
+    {
+#     ifdef WIN32
+        ::WakeConditionVariable(&cond_) ;
+#     else
+        ::pthread_cond_signal(&cond_) ;
+#     endif
+    }
+
+    /// Wake all waiting threads
+    inline void wakeAll ()
+    {
+#     ifdef WIN32
+        ::WakeAllConditionVariable(&cond_) ;
+#     else
+        ::pthread_cond_broadcast(&cond_) ;
+#     endif
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    Condition(const Condition &rhs) ;
+    /// Assignment (not implemented)
+    Condition &operator=(const Condition &rhs) ;
+
+#   ifdef WIN32
+    /// Platform condition variable
+    CONDITION_VARIABLE cond_ ;
+#   else
+    /// Platform condition variable
+    pthread_cond_t cond_ ;
+#   endif
+
+} ;
+
+/*! \brief Scoped mutex lock
+
+  Acquires the mutex on construction and releases it on destruction.
+*/
+class ScopedLock {
+
+public:
+
+    /// Constructor; acquires \p mutex
+    explicit ScopedLock (Mutex &mutex)
+        : mutex_(mutex)
+    {
+        mutex_.lock() ;
+    }
+
+    /// Destructor; releases the mutex
+    ~ScopedLock ()
+    {
+        mutex_.unlock() ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    ScopedLock(const ScopedLock &rhs) ;
+    /// Assignment (not implemented)
+    ScopedLock &operator=(const ScopedLock &rhs) ;
+
+    /// The mutex
+    Mutex &mutex_ ;
+
+} ;
+
+/*! \name Threads
+
+  Just enough to run a function in a few worker threads and wait for them.
+*/
+//@{
+
+#ifdef WIN32
+/// Platform thread handle
+typedef HANDLE ThreadHandle ;
+#else
+/// Platform thread handle
+typedef pthread_t ThreadHandle ;
+#endif
+
+/// Thread body
+typedef void *(*ThreadFunc)(void *arg) ;
+
+/// Start a thread running \p func(\p arg); returns false on failure
+inline bool startThread (ThreadHandle &thread, ThreadFunc func, void *arg)
+{
+#  ifdef WIN32
+    thread = ::CreateThread(NULL, 0,
+                            reinterpret_cast<LPTHREAD_START_ROUTINE>(func),
+                            arg, 0, NULL) ;
+    return (thread != NULL) ;
+#  else
+    return (::pthread_create(&thread, NULL, func, arg) == 0) ;
+#  endif
+}
+
+/// Wait for \p thread to finish
+inline void joinThread (ThreadHandle thread)
+{
+#  ifdef WIN32
+    ::WaitForSingleObject(thread, INFINITE) ;
+    ::CloseHandle(thread) ;
+#  else
+    ::pthread_join(thread, NULL) ;
+#  endif
+}
+
+/// Number of processors online; at least 1
+inline int numProcessors ()
+{
+    long numProcs = 1 ;
+#  ifdef WIN32
+    SYSTEM_INFO info ;
+    ::GetSystemInfo(&info) ;
+    numProcs = info.dwNumberOfProcessors ;
+#  elif defined(_SC_NPROCESSORS_ONLN)
+    numProcs = ::sysconf(_SC_NPROCESSORS_ONLN) ;
+#  endif
+    return ((numProcs < 1) ? 1 : static_cast<int>(numProcs)) ;
+}
+
+//@}
+
+/*! \name Atomic operations
+
+  All of these imply a full memory barrier.
+*/
+//@{
+
+/// Atomically add \p delta to \p *target and return the new value
+inline int atomicAdd (volatile int *target, int delta)
+{
+    return (__sync_add_and_fetch(target, delta)) ;
+}
+
+/// Atomically read \p *target
+inline int atomicLoad (volatile int *target)
+{
+#  if defined(__ATOMIC_SEQ_CST)
+    return (__atomic_load_n(target, __ATOMIC_SEQ_CST)) ;
+#  else
+    return (__sync_fetch_and_add(target, 0)) ;
+#  endif
+}
+
+/// Atomically read the pointer \p *target
+template <typename T>
+inline T *atomicLoadPtr (T *volatile *target)
+{
+#  if defined(__ATOMIC_SEQ_CST)
+    return (__atomic_load_n(target, __ATOMIC_SEQ_CST)) ;
+#  else
+    return (__sync_fetch_and_add(target, 0)) ;
+#  endif
+}
+
+/// Atomically replace the pointer \p *target with \p value; return the old value
+template <typename T>
+inline T *atomicExchangePtr (T *volatile *target, T *value)
+{
+    T *old = *target ;
+    while (!__sync_bool_compare_and_swap(target, old, value)) old = *target ;
+    return (old) ;
+}
+
+/// Give up the processor
+inline void yieldThread ()
+{
+#  ifdef WIN32
+    ::SwitchToThread() ;
+#  else
+    ::sched_yield() ;
+#  endif
+}
+
+//@}
+
+}  // end namespace Osi2
+
+#endif
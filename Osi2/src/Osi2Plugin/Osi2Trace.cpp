@@ -0,0 +1,242 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Trace.cpp
+    \brief Method definitions for Osi2::Trace
+*/
+
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#ifdef WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2Trace.hpp"
+
+using namespace Osi2 ;
+
+namespace {
+
+/// One recorded span
+struct Event {
+    std::string cat_ ;
+    std::string name_ ;
+    std::string detail_ ;
+    uint64_t start_ ;
+    uint64_t dur_ ;
+} ;
+
+/*
+  The events of one thread. The lock is taken by the owner to record and by
+  whoever is writing or clearing the trace.
+*/
+struct ThreadEvents {
+    int tid_ ;
+    int numDropped_ ;
+    Mutex mutex_ ;
+    std::vector<Event> events_ ;
+} ;
+
+/// Buffers of all threads that have recorded anything, in order of tid
+std::vector<ThreadEvents *> allThreads ;
+/// Serialises use of allThreads
+Mutex allThreadsMutex ;
+
+/// Thread-local cache of the calling thread's buffer
+OSI2_THREAD_LOCAL void *tlsEvents = 0 ;
+
+/*
+  The slow path, taken the first time a thread records a span. Buffers are
+  never freed, so the cached pointer stays good for the life of the
+  process.
+*/
+ThreadEvents *myEvents ()
+{
+    if (tlsEvents != 0) return (static_cast<ThreadEvents *>(tlsEvents)) ;
+    ThreadEvents *events = new ThreadEvents ;
+    events->numDropped_ = 0 ;
+    {
+        ScopedLock lock(allThreadsMutex) ;
+        events->tid_ = static_cast<int>(allThreads.size()) + 1 ;
+        allThreads.push_back(events) ;
+    }
+    tlsEvents = events ;
+    return (events) ;
+}
+
+inline int processID ()
+{
+#  ifdef WIN32
+    return (::_getpid()) ;
+#  else
+    return (static_cast<int>(::getpid())) ;
+#  endif
+}
+
+/// Write \p ns nanoseconds as microseconds
+void writeMicros (std::ostream &os, uint64_t ns)
+{
+    const uint64_t frac = ns%1000 ;
+    os << ns/1000 << '.' << static_cast<char>('0' + frac/100)
+       << static_cast<char>('0' + (frac/10)%10)
+       << static_cast<char>('0' + frac%10) ;
+}
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+volatile bool Trace::enabled_ = false ;
+
+void Trace::setEnabled (bool enabled)
+{
+    enabled_ = enabled ;
+}
+
+void Trace::clear ()
+{
+    ScopedLock lock(allThreadsMutex) ;
+    for (size_t i = 0 ; i < allThreads.size() ; i++) {
+        ThreadEvents *events = allThreads[i] ;
+        ScopedLock eventsLock(events->mutex_) ;
+        events->events_.clear() ;
+        events->numDropped_ = 0 ;
+    }
+}
+
+void Trace::record (const char *cat, const char *name, const char *detail,
+                    uint64_t start, uint64_t end)
+{
+    ThreadEvents *events = myEvents() ;
+    ScopedLock lock(events->mutex_) ;
+    if (events->events_.size() >= static_cast<size_t>(maxEventsPerThread)) {
+        events->numDropped_++ ;
+        return ;
+    }
+    events->events_.push_back(Event()) ;
+    Event &event = events->events_.back() ;
+    event.cat_ = cat ;
+    event.name_ = name ;
+    if (detail != nullptr) event.detail_ = detail ;
+    event.start_ = start ;
+    event.dur_ = (end > start)?(end - start):0 ;
+}
+
+int Trace::getNumEvents ()
+{
+    int numEvents = 0 ;
+    ScopedLock lock(allThreadsMutex) ;
+    for (size_t i = 0 ; i < allThreads.size() ; i++) {
+        ScopedLock eventsLock(allThreads[i]->mutex_) ;
+        numEvents += static_cast<int>(allThreads[i]->events_.size()) ;
+    }
+    return (numEvents) ;
+}
+
+int Trace::getNumDropped ()
+{
+    int numDropped = 0 ;
+    ScopedLock lock(allThreadsMutex) ;
+    for (size_t i = 0 ; i < allThreads.size() ; i++) {
+        ScopedLock eventsLock(allThreads[i]->mutex_) ;
+        numDropped += allThreads[i]->numDropped_ ;
+    }
+    return (numDropped) ;
+}
+
+void Trace::lockForFork ()
+{
+    allThreadsMutex.lock() ;
+    for (size_t i = 0 ; i < allThreads.size() ; i++)
+        allThreads[i]->mutex_.lock() ;
+}
+
+/*
+  In the child, only the forking thread survives. The other threads'
+  events stay in the trace; they happened before the fork.
+*/
+void Trace::unlockAfterFork (bool child)
+{
+    for (size_t i = allThreads.size() ; i > 0 ; i--) {
+        if (child) {
+            allThreads[i-1]->mutex_.reset() ;
+        } else {
+            allThreads[i-1]->mutex_.unlock() ;
+        }
+    }
+    if (child) {
+        allThreadsMutex.reset() ;
+    } else {
+        allThreadsMutex.unlock() ;
+    }
+}
+
+/*
+  Events are written thread by thread; the viewers sort by time.
+*/
+void Trace::writeJSON (std::ostream &os)
+{
+    const int pid = processID() ;
+    ScopedLock lock(allThreadsMutex) ;
+    os << "{\"traceEvents\":[" ;
+    bool first = true ;
+    for (size_t i = 0 ; i < allThreads.size() ; i++) {
+        ThreadEvents *events = allThreads[i] ;
+        ScopedLock eventsLock(events->mutex_) ;
+        for (size_t j = 0 ; j < events->events_.size() ; j++) {
+            const Event &event = events->events_[j] ;
+            if (!first) os << "," ;
+            first = false ;
+            os << "\n{\"name\":" ;
+            PerfStats::writeJSONString(os, event.name_) ;
+            os << ",\"cat\":" ;
+            PerfStats::writeJSONString(os, event.cat_) ;
+            os << ",\"ph\":\"X\",\"ts\":" ;
+            writeMicros(os, event.start_) ;
+            os << ",\"dur\":" ;
+            writeMicros(os, event.dur_) ;
+            os << ",\"pid\":" << pid << ",\"tid\":" << events->tid_ ;
+            if (!event.detail_.empty()) {
+                os << ",\"args\":{\"detail\":" ;
+                PerfStats::writeJSONString(os, event.detail_) ;
+                os << "}" ;
+            }
+            os << "}" ;
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n" ;
+}
+
+int Trace::writeFile (const std::string &path, std::string &errStr)
+{
+    std::string fullPath = path ;
+    std::string::size_type pos = fullPath.find("%p") ;
+    if (pos != std::string::npos) {
+        std::ostringstream pid ;
+        pid << processID() ;
+        fullPath.replace(pos, 2, pid.str()) ;
+    }
+    std::ofstream file(fullPath.c_str()) ;
+    if (!file) {
+        errStr = "cannot open " + fullPath ;
+        return (-1) ;
+    }
+    writeJSON(file) ;
+    file.close() ;
+    if (!file) {
+        errStr = "error writing " + fullPath ;
+        return (-1) ;
+    }
+    return (0) ;
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,170 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Trace.hpp
+    \brief Timeline tracing for the plugin framework.
+
+  See Osi2::Trace and Osi2::TraceSpan.
+*/
+
+#ifndef OSI2TRACE_HPP
+#define OSI2TRACE_HPP
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+
+#include "Osi2nullptr.hpp"
+#include "Osi2PerfStats.hpp"
+
+namespace Osi2 {
+
+/*! \brief Process-wide trace of timed spans
+
+  While tracing is enabled, each TraceSpan records one event: a category, a
+  name, an optional detail string, the thread that ran it, and its start
+  time and duration. The events can be written out (#writeJSON) in the
+  Chrome trace-event format, which chrome://tracing and Perfetto
+  (ui.perfetto.dev) will display as a timeline, one track per thread.
+
+  The trace is a single collection for the whole process, so that the
+  plugin manager, DynamicLibrary, and the shims can all contribute to it.
+  (A library loaded in an isolated namespace has its own copy of
+  libOsi2Plugin, and its spans are not seen.) When tracing is disabled a
+  span costs a test of one flag at each end.
+
+  Events are kept per thread; recording takes only the calling thread's
+  own lock, which is contended only while the trace is being written or
+  cleared. A thread records at most #maxEventsPerThread events; past that,
+  events are counted (#getNumDropped) and discarded. Threads are numbered
+  from 1 in the order they first record something.
+
+  Setting the environment variable OSI2_TRACE to a file name enables tracing
+  from the construction of the plugin manager and writes the trace to that
+  file when the plugin manager is destroyed. The sequence %p in the name is
+  replaced by the process ID, so that forked and hosted processes write
+  separate files.
+*/
+class Trace {
+
+public:
+
+    /// Most events recorded by one thread
+    static const int maxEventsPerThread = 1<<18 ;
+
+    /// \name Control
+    //@{
+    /// True if spans are being recorded
+    static inline bool isEnabled () {
+        return (enabled_) ;
+    }
+    /// Start or stop recording spans
+    static void setEnabled(bool enabled) ;
+    /// Discard the events recorded so far, and the count of dropped events
+    static void clear() ;
+    //@}
+
+    /// \name Recording
+    //@{
+    /*! \brief Record one complete span
+
+      \p start and \p end are from PerfStats::now. The strings are copied.
+      Records whether or not tracing is enabled; see TraceSpan.
+    */
+    static void record(const char *cat, const char *name, const char *detail,
+                       uint64_t start, uint64_t end) ;
+
+    /// Number of events recorded and not yet cleared
+    static int getNumEvents() ;
+    /// Number of events discarded because a thread's buffer was full
+    static int getNumDropped() ;
+
+    /// Acquire the internal locks before fork(2)
+    static void lockForFork() ;
+    /// Release the internal locks after fork(2), in parent or child
+    static void unlockAfterFork(bool child) ;
+    //@}
+
+    /// \name Output
+    //@{
+    /*! \brief Write the trace to \p os as Chrome trace-event JSON
+
+      The output is a single object with a member \c traceEvents, an array
+      of complete (\c "ph":"X") events with times in microseconds. A span's
+      detail string, if it has one, is in the event's \c args.
+    */
+    static void writeJSON(std::ostream &os) ;
+
+    /*! \brief Write the trace to the file \p path
+
+      A %p in \p path is replaced by the process ID. Returns 0 on success,
+      -1 if the file can't be written, with an explanation in \p errStr.
+    */
+    static int writeFile(const std::string &path, std::string &errStr) ;
+    //@}
+
+private:
+
+    /// Set while spans are being recorded
+    static volatile bool enabled_ ;
+
+} ;
+
+/*! \brief Trace the lifetime of a scope
+
+  Records a span from construction to destruction, if tracing was enabled
+  at construction. The category and name must be nonnull; the detail string
+  is optional. Nothing is copied unless the span is being recorded.
+*/
+class TraceSpan {
+
+public:
+
+    /// Constructor; starts the span
+    TraceSpan (const char *cat, const char *name,
+               const char *detail = nullptr)
+        : active_(Trace::isEnabled()),
+          cat_(cat),
+          name_(name),
+          start_(0)
+    {
+        if (active_) {
+            if (detail != nullptr) detail_ = detail ;
+            start_ = PerfStats::now() ;
+        }
+    }
+
+    /// Destructor; ends the span and records it
+    ~TraceSpan ()
+    {
+        if (active_)
+            Trace::record(cat_, name_, detail_.c_str(), start_,
+                          PerfStats::now()) ;
+    }
+
+private:
+
+    /// Copy constructor (not implemented)
+    TraceSpan(const TraceSpan &rhs) ;
+    /// Assignment (not implemented)
+    TraceSpan &operator=(const TraceSpan &rhs) ;
+
+    /// True if the span will be recorded
+    const bool active_ ;
+    /// Category
+    const char *cat_ ;
+    /// Name
+    const char *name_ ;
+    /// Detail; empty if there's none
+    std::string detail_ ;
+    /// Start time
+    uint64_t start_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
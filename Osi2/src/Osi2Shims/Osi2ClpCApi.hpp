@@ -0,0 +1,214 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ClpCApi.hpp
+    \brief The clp C interface, as a table of entry points.
+
+  See Osi2::ClpCApi.
+*/
+
+#ifndef Osi2ClpCApi_HPP
+#define Osi2ClpCApi_HPP
+
+#include "Clp_C_Interface.h"
+
+class ClpSimplex ;
+
+namespace Osi2 {
+
+/*! \brief The clp C interface, as a table of entry points
+
+  The light clp shim loads libClp at run time, so it can't call the C
+  interface directly. Instead ClpShim::bindClp looks up every entry point
+  once, when the shim is initialised, and fills in this table. The table
+  is not changed afterwards; all the objects the shim hands out share it,
+  and a call through it is a single indirect call.
+
+  The entries marked `required' are needed by the shim itself, and a libClp
+  without them is rejected. The rest are null if libClp doesn't supply
+  them; check before use.
+*/
+struct ClpCApi {
+
+    /*! \name Models */
+    //@{
+    /// Clp_newModel (required)
+    typedef Clp_Simplex *(*NewModelFunc)() ;
+    NewModelFunc newModel_ ;
+    /// Clp_deleteModel (required)
+    typedef void (*DeleteModelFunc)(Clp_Simplex *) ;
+    DeleteModelFunc deleteModel_ ;
+    /// Clp_model (required)
+    typedef ClpSimplex *(*ModelFunc)(Clp_Simplex *) ;
+    ModelFunc model_ ;
+    /// Clp_Version
+    typedef const char *(*VersionFunc)() ;
+    VersionFunc version_ ;
+    //@}
+
+    /*! \name Loading and saving */
+    //@{
+    /// Clp_readMps (required)
+    typedef int (*ReadMpsFunc)(Clp_Simplex *, const char *, int, int) ;
+    ReadMpsFunc readMps_ ;
+    /// Clp_writeMps
+    typedef int (*WriteMpsFunc)(Clp_Simplex *, const char *, int, int,
+                                double) ;
+    WriteMpsFunc writeMps_ ;
+    /// Clp_loadProblem
+    typedef void (*LoadProblemFunc)(Clp_Simplex *, int, int,
+                                    const CoinBigIndex *, const int *,
+                                    const double *, const double *,
+                                    const double *, const double *,
+                                    const double *, const double *) ;
+    LoadProblemFunc loadProblem_ ;
+    /// Clp_copyNames
+    typedef void (*CopyNamesFunc)(Clp_Simplex *, const char *const *,
+                                  const char *const *) ;
+    CopyNamesFunc copyNames_ ;
+    /// Clp_copyInteger
+    typedef void (*CopyIntegerFunc)(Clp_Simplex *, const char *) ;
+    CopyIntegerFunc copyInteger_ ;
+    /// Clp_setProblemName
+    typedef int (*SetProblemNameFunc)(Clp_Simplex *, int, char *) ;
+    SetProblemNameFunc setProblemName_ ;
+    /// Clp_copyinStatus
+    typedef void (*CopyinStatusFunc)(Clp_Simplex *, const unsigned char *) ;
+    CopyinStatusFunc copyinStatus_ ;
+    //@}
+
+    /*! \name Modifying the problem */
+    //@{
+    /// Clp_addRows
+    typedef void (*AddRowsFunc)(Clp_Simplex *, int, const double *,
+                                const double *, const CoinBigIndex *,
+                                const int *, const double *) ;
+    AddRowsFunc addRows_ ;
+    /// Clp_addColumns
+    typedef void (*AddColumnsFunc)(Clp_Simplex *, int, const double *,
+                                   const double *, const double *,
+                                   const CoinBigIndex *, const int *,
+                                   const double *) ;
+    AddColumnsFunc addColumns_ ;
+    /// Clp_deleteRows, Clp_deleteColumns
+    typedef void (*DeleteFunc)(Clp_Simplex *, int, const int *) ;
+    DeleteFunc deleteRows_ ;
+    DeleteFunc deleteColumns_ ;
+    /// Clp_chgRowLower, Clp_chgRowUpper, Clp_chgColumnLower,
+    /// Clp_chgColumnUpper, Clp_chgObjCoefficients
+    typedef void (*ChangeFunc)(Clp_Simplex *, const double *) ;
+    ChangeFunc chgRowLower_ ;
+    ChangeFunc chgRowUpper_ ;
+    ChangeFunc chgColumnLower_ ;
+    ChangeFunc chgColumnUpper_ ;
+    ChangeFunc chgObjCoefficients_ ;
+    //@}
+
+    /*! \name Solving */
+    //@{
+    /// Clp_initialSolve (required), and the other Clp_initial*Solve
+    typedef int (*SolveFunc)(Clp_Simplex *) ;
+    SolveFunc initialSolve_ ;
+    SolveFunc initialDualSolve_ ;
+    SolveFunc initialPrimalSolve_ ;
+    SolveFunc initialBarrierSolve_ ;
+    /// Clp_dual, Clp_primal
+    typedef int (*SimplexFunc)(Clp_Simplex *, int) ;
+    SimplexFunc dual_ ;
+    SimplexFunc primal_ ;
+    //@}
+
+    /*! \name Parameters */
+    //@{
+    /// Clp_setLogLevel, Clp_setMaximumIterations
+    typedef void (*SetIntFunc)(Clp_Simplex *, int) ;
+    SetIntFunc setLogLevel_ ;
+    SetIntFunc setMaximumIterations_ ;
+    /// Clp_setMaximumSeconds, Clp_setOptimizationDirection,
+    /// Clp_setPrimalTolerance, Clp_setDualTolerance
+    typedef void (*SetDoubleFunc)(Clp_Simplex *, double) ;
+    SetDoubleFunc setMaximumSeconds_ ;
+    SetDoubleFunc setOptimizationDirection_ ;
+    SetDoubleFunc setPrimalTolerance_ ;
+    SetDoubleFunc setDualTolerance_ ;
+    /// Clp_setObjectiveOffset
+    SetDoubleFunc setObjectiveOffset_ ;
+    //@}
+
+    /*! \name The problem and its solution */
+    //@{
+    /*! \brief Functions of the model that return an int
+
+      Clp_numberRows, Clp_numberColumns, Clp_numberIterations, Clp_status,
+      Clp_secondaryStatus, Clp_logLevel, and the Clp_is* status tests.
+    */
+    typedef int (*GetIntFunc)(Clp_Simplex *) ;
+    GetIntFunc numberRows_ ;
+    GetIntFunc numberColumns_ ;
+    GetIntFunc numberIterations_ ;
+    GetIntFunc status_ ;
+    GetIntFunc secondaryStatus_ ;
+    GetIntFunc logLevel_ ;
+    GetIntFunc isProvenOptimal_ ;
+    GetIntFunc isProvenPrimalInfeasible_ ;
+    GetIntFunc isProvenDualInfeasible_ ;
+    GetIntFunc isAbandoned_ ;
+    GetIntFunc isIterationLimitReached_ ;
+    /// Clp_objectiveValue, Clp_optimizationDirection
+    typedef double (*GetDoubleFunc)(Clp_Simplex *) ;
+    GetDoubleFunc objectiveValue_ ;
+    GetDoubleFunc optimizationDirection_ ;
+    /*! \brief Functions of the model that return a vector
+
+      Clp_rowLower, Clp_rowUpper, Clp_columnLower, Clp_columnUpper,
+      Clp_objective, and the solution: Clp_primalRowSolution,
+      Clp_primalColumnSolution, Clp_dualRowSolution, Clp_dualColumnSolution.
+    */
+    typedef double *(*GetVectorFunc)(Clp_Simplex *) ;
+    GetVectorFunc rowLower_ ;
+    GetVectorFunc rowUpper_ ;
+    GetVectorFunc columnLower_ ;
+    GetVectorFunc columnUpper_ ;
+    GetVectorFunc objective_ ;
+    GetVectorFunc primalRowSolution_ ;
+    GetVectorFunc primalColumnSolution_ ;
+    GetVectorFunc dualRowSolution_ ;
+    GetVectorFunc dualColumnSolution_ ;
+    /// Clp_objectiveOffset
+    GetDoubleFunc objectiveOffset_ ;
+    /// Clp_getNumElements
+    typedef CoinBigIndex (*GetNumElementsFunc)(Clp_Simplex *) ;
+    GetNumElementsFunc getNumElements_ ;
+    /// Clp_getVectorStarts
+    typedef const CoinBigIndex *(*GetStartsFunc)(Clp_Simplex *) ;
+    GetStartsFunc getVectorStarts_ ;
+    /// Clp_getIndices, Clp_getVectorLengths
+    typedef const int *(*GetIndexVectorFunc)(Clp_Simplex *) ;
+    GetIndexVectorFunc getIndices_ ;
+    GetIndexVectorFunc getVectorLengths_ ;
+    /// Clp_getElements
+    typedef const double *(*GetElementsFunc)(Clp_Simplex *) ;
+    GetElementsFunc getElements_ ;
+    /// Clp_integerInformation
+    typedef char *(*IntegerInformationFunc)(Clp_Simplex *) ;
+    IntegerInformationFunc integerInformation_ ;
+    /// Clp_statusArray
+    typedef unsigned char *(*StatusArrayFunc)(Clp_Simplex *) ;
+    StatusArrayFunc statusArray_ ;
+    /// Clp_lengthNames
+    GetIntFunc lengthNames_ ;
+    /// Clp_rowName, Clp_columnName, Clp_problemName
+    typedef void (*GetNameFunc)(Clp_Simplex *, int, char *) ;
+    GetNameFunc rowName_ ;
+    GetNameFunc columnName_ ;
+    GetNameFunc problemName_ ;
+    //@}
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
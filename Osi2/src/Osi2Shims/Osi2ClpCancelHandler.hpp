@@ -0,0 +1,84 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ClpCancelHandler.hpp
+    \brief A CancelToken, as clp's event handler.
+
+  See Osi2::ClpCancelHandler.
+*/
+
+#ifndef Osi2ClpCancelHandler_HPP
+#define Osi2ClpCancelHandler_HPP
+
+#include "ClpEventHandler.hpp"
+#include "ClpSimplex.hpp"
+
+#include "Osi2CancelToken.hpp"
+
+namespace Osi2 {
+
+/*! \brief Stop a clp solve when its CancelToken says so
+
+  Passed to ClpSimplex::passInEventHandler, which keeps a clone. Clp calls
+  #event at the end of every simplex iteration; once the token should stop,
+  the solve ends with status 5 (stopped by event handler). The heavy clp
+  shim's objects then look at the token to say why (#stopReason).
+*/
+class ClpCancelHandler : public ClpEventHandler {
+
+public:
+
+    /// Constructor
+    explicit ClpCancelHandler (const CancelToken &token)
+        : ClpEventHandler(),
+          token_(token)
+    { }
+
+    /// Copy constructor
+    ClpCancelHandler (const ClpCancelHandler &rhs)
+        : ClpEventHandler(rhs),
+          token_(rhs.token_)
+    { }
+
+    /// Clone; the clone shares the token
+    virtual ClpEventHandler *clone () const
+    {
+        return (new ClpCancelHandler(*this)) ;
+    }
+
+    /// -1 to carry on, 0 to stop
+    virtual int event (Event whichEvent)
+    {
+        if (whichEvent == endOfIteration && token_.shouldStop())
+            return (0) ;
+        return (-1) ;
+    }
+
+    /*! \brief Why the last solve of \p model stopped early
+
+      CancelToken::None unless \p model ended with status 5 and \p token
+      says to stop.
+    */
+    static inline CancelToken::Reason stopReason (const ClpSimplex *model,
+                                                  const CancelToken &token)
+    {
+        if (model->status() != 5) return (CancelToken::None) ;
+        return (token.getStopReason()) ;
+    }
+
+private:
+
+    /// Assignment (not implemented)
+    ClpCancelHandler &operator=(const ClpCancelHandler &rhs) ;
+
+    /// The token
+    CancelToken token_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -12,8 +12,6 @@
   appropriate clp libraries.
 */
 
-#include <iostream>
-
 #include "Osi2ClpHeavyShim.hpp"
 #include "ClpConfig.h"
 #include "ClpSimplex.hpp"
@@ -44,21 +42,25 @@ void *ClpHeavyShim::create (const ObjectParams *params)
 {
     std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
     void *retval = nullptr ;
+    const ClpHeavyShim *shim =
+        static_cast<const ClpHeavyShim *>(params->ctrlObj_) ;
+    const PluginLog &log = shim->getLog() ;
 
-    std::cout << "ClpHeavy create: type " << what << "." << std::endl ;
+    OSI2_PLUGIN_LOG(log, 5) << "ClpHeavy create: type " << what << "." ;
 
     if (what == "ProbMgmt") {
-      std::cout
-	  << "Request to create " << what << " recognised." << std::endl ;
+      OSI2_PLUGIN_LOG(log, 5)
+	  << "Request to create " << what << " recognised." ;
       ClpSimplex *clp = new ClpSimplex() ;
-      retval = new ProbMgmtAPI_ClpHeavy(clp) ;
+      retval = new ProbMgmtAPI_ClpHeavy(clp, log, shim->getMem(),
+                                        shim->getThreads()) ;
     } else if (what == "Osi1") {
-      std::cout
-	  << "Request to create " << what << " recognised." << std::endl ;
-      retval = new Osi1API_ClpHeavy() ;
+      OSI2_PLUGIN_LOG(log, 5)
+	  << "Request to create " << what << " recognised." ;
+      retval = new Osi1API_ClpHeavy(log) ;
     } else {
-      std::cout
-	  << "ClpHeavy create: unrecognised type " << what << "." << std::endl ;
+      OSI2_PLUGIN_LOG(log, 1)
+	  << "ClpHeavy create: unrecognised type " << what << "." ;
     }
 
     return (retval) ;
@@ -72,8 +74,11 @@ void *ClpHeavyShim::create (const ObjectParams *params)
 int32_t ClpHeavyShim::destroy (void *victim, const ObjectParams *objParms)
 {
     std::string what = reinterpret_cast<const char *>(objParms->apiStr_) ;
-    std::cout
-            << "Request to destroy " << what << " recognised." << std::endl ;
+    const ClpHeavyShim *shim =
+        static_cast<const ClpHeavyShim *>(objParms->ctrlObj_) ;
+    const PluginLog &log = shim->getLog() ;
+    OSI2_PLUGIN_LOG(log, 5)
+            << "Request to destroy " << what << " recognised." ;
     API *api = static_cast<API *>(victim) ;
     delete api ;
 
@@ -91,9 +96,11 @@ extern "C"
 ExitFunc initPlugin (PlatformServices *services)
 {
     std::string version = CLP_VERSION ;
-    std::cout
+    PluginLog log ;
+    log.init(services) ;
+    OSI2_PLUGIN_LOG(log, 4)
             << "Executing ClpHeavyShim::initPlugin, clp version "
-            << version << "." << std::endl ;
+            << version << "." ;
     /*
       Create the plugin library state object, ClpHeavyShim.  Arrange to
       remember our unique ID from the plugin manager.  Then stash a pointer
@@ -103,6 +110,13 @@ ExitFunc initPlugin (PlatformServices *services)
     */
     ClpHeavyShim *shim = new ClpHeavyShim() ;
     shim->setPluginID(services->pluginID_) ;
+    shim->setLog(log) ;
+    PluginMem mem ;
+    mem.init(services) ;
+    shim->setMem(mem) ;
+    PluginThreads threads ;
+    threads.init(services) ;
+    shim->setThreads(threads) ;
     services->ctrlObj_ = static_cast<PluginState *>(shim) ;
     /*
       RegisterParams.
@@ -121,19 +135,25 @@ ExitFunc initPlugin (PlatformServices *services)
     reginfo.pluginID_ = shim->getPluginID() ;
     reginfo.createFunc_ = ClpHeavyShim::create ;
     reginfo.destroyFunc_ = ClpHeavyShim::destroy ;
+    reginfo.capabilityFunc_ = nullptr ;
+    reginfo.bulkCreateFunc_ = nullptr ;
+    reginfo.caps_.problems_ = PluginProb_LP ;
+    reginfo.caps_.props_ = PluginProp_ThreadSafe|PluginProp_LoadInMemory ;
+    reginfo.caps_.createCost_ = 20 ;
+    reginfo.caps_.solveCost_ = 100 ;
     int retval =
 	services->registerObject_(
 	    reinterpret_cast<const unsigned char*>("ProbMgmt"), &reginfo) ;
     if (retval < 0) {
-        std::cout
-                << "Apparent failure to register ProbMgmt plugin." << std::endl ;
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Apparent failure to register ProbMgmt plugin." ;
         return (nullptr) ;
     }
     retval = services->registerObject_(
 		reinterpret_cast<const unsigned char*>("Osi1"), &reginfo) ;
     if (retval < 0) {
-        std::cout
-                << "Apparent failure to register Osi1 plugin." << std::endl ;
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Apparent failure to register Osi1 plugin." ;
         return (nullptr) ;
     }
 
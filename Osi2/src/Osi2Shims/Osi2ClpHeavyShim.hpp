@@ -18,6 +18,9 @@
 
 #include "Osi2Plugin.hpp"
 #include "Osi2DynamicLibrary.hpp"
+#include "Osi2PluginLog.hpp"
+#include "Osi2PluginMem.hpp"
+#include "Osi2PluginThreads.hpp"
 
 namespace Osi2 {
 
@@ -63,6 +66,30 @@ public:
     inline int getVerbosity () const {
         return (verbosity_) ;
     }
+    /// Set the plugin manager's log service
+    inline void setLog (const PluginLog &log) {
+        log_ = log ;
+    }
+    /// The plugin manager's log service
+    inline const PluginLog &getLog () const {
+        return (log_) ;
+    }
+    /// Set the plugin manager's memory accounting service
+    inline void setMem (const PluginMem &mem) {
+        mem_ = mem ;
+    }
+    /// The plugin manager's memory accounting service
+    inline const PluginMem &getMem () const {
+        return (mem_) ;
+    }
+    /// Set the plugin manager's thread pool
+    inline void setThreads (const PluginThreads &threads) {
+        threads_ = threads ;
+    }
+    /// The plugin manager's thread pool
+    inline const PluginThreads &getThreads () const {
+        return (threads_) ;
+    }
 
 private:
 
@@ -79,6 +106,15 @@ private:
     /// Verbosity level for information messages
     int verbosity_ ;
 
+    /// The plugin manager's log service
+    PluginLog log_ ;
+
+    /// The plugin manager's memory accounting service
+    PluginMem mem_ ;
+
+    /// The plugin manager's thread pool
+    PluginThreads threads_ ;
+
 } ;
 
 /*! \brief Plugin initialisation method
@@ -12,7 +12,6 @@
   interface and dynamically load the methods it wants to use.
 */
 
-#include <iostream>
 
 #include "ClpConfig.h"
 #include "Osi2ClpShim.hpp"
@@ -21,20 +20,159 @@
 #include "Osi2Config.h"
 #include "Osi2nullptr.hpp"
 #include "Osi2DynamicLibrary.hpp"
+#include "Osi2PluginLog.hpp"
 
 #include "Osi2ProbMgmtAPI_Clp.hpp"
 
 using namespace Osi2 ;
 
+namespace {
+
 /*
-  Default constructor.
+  Look up one entry point of the C interface. A missing required entry is
+  added to the list in missing.
+*/
+template <typename FuncType>
+void bindEntry (DynamicLibrary *lib, const char *name, FuncType &entry,
+                bool required, std::string &missing)
+{
+    std::string symErr ;
+    entry = symbolToFunc<FuncType>(lib->getSymbol(name, symErr)) ;
+    if (entry == nullptr && required) {
+        if (!missing.empty()) missing += ", " ;
+        missing += name ;
+    }
+}
+
+}   // end unnamed file-local namespace
+
+/*
+  Default constructor. The C interface table starts out null.
 */
 ClpShim::ClpShim ()
     : services_(0),
       libClp_(0),
-      verbosity_(1)
+      verbosity_(1),
+      clpApi_()
 { }
 
+/*
+  Bind the C interface, all at once. The objects we hand out call through
+  the table and never look anything up themselves, so a libClp that lacks a
+  required entry point is rejected here, up front.
+*/
+bool ClpShim::bindClp (std::string &errStr)
+{
+    DynamicLibrary *lib = libClp_ ;
+    ClpCApi &api = clpApi_ ;
+    std::string missing ;
+
+    bindEntry(lib, "Clp_newModel", api.newModel_, true, missing) ;
+    bindEntry(lib, "Clp_deleteModel", api.deleteModel_, true, missing) ;
+    bindEntry(lib, "Clp_model", api.model_, true, missing) ;
+    bindEntry(lib, "Clp_Version", api.version_, false, missing) ;
+
+    bindEntry(lib, "Clp_readMps", api.readMps_, true, missing) ;
+    bindEntry(lib, "Clp_writeMps", api.writeMps_, false, missing) ;
+    bindEntry(lib, "Clp_loadProblem", api.loadProblem_, false, missing) ;
+    bindEntry(lib, "Clp_copyNames", api.copyNames_, false, missing) ;
+    bindEntry(lib, "Clp_copyInteger", api.copyInteger_, false, missing) ;
+    bindEntry(lib, "Clp_setProblemName", api.setProblemName_, false, missing) ;
+    bindEntry(lib, "Clp_copyinStatus", api.copyinStatus_, false, missing) ;
+
+    bindEntry(lib, "Clp_addRows", api.addRows_, false, missing) ;
+    bindEntry(lib, "Clp_addColumns", api.addColumns_, false, missing) ;
+    bindEntry(lib, "Clp_deleteRows", api.deleteRows_, false, missing) ;
+    bindEntry(lib, "Clp_deleteColumns", api.deleteColumns_, false, missing) ;
+    bindEntry(lib, "Clp_chgRowLower", api.chgRowLower_, false, missing) ;
+    bindEntry(lib, "Clp_chgRowUpper", api.chgRowUpper_, false, missing) ;
+    bindEntry(lib, "Clp_chgColumnLower", api.chgColumnLower_, false, missing) ;
+    bindEntry(lib, "Clp_chgColumnUpper", api.chgColumnUpper_, false, missing) ;
+    bindEntry(lib, "Clp_chgObjCoefficients", api.chgObjCoefficients_,
+              false, missing) ;
+
+    bindEntry(lib, "Clp_initialSolve", api.initialSolve_, true, missing) ;
+    bindEntry(lib, "Clp_initialDualSolve", api.initialDualSolve_,
+              false, missing) ;
+    bindEntry(lib, "Clp_initialPrimalSolve", api.initialPrimalSolve_,
+              false, missing) ;
+    bindEntry(lib, "Clp_initialBarrierSolve", api.initialBarrierSolve_,
+              false, missing) ;
+    bindEntry(lib, "Clp_dual", api.dual_, false, missing) ;
+    bindEntry(lib, "Clp_primal", api.primal_, false, missing) ;
+
+    bindEntry(lib, "Clp_setLogLevel", api.setLogLevel_, false, missing) ;
+    bindEntry(lib, "Clp_setMaximumIterations", api.setMaximumIterations_,
+              false, missing) ;
+    bindEntry(lib, "Clp_setMaximumSeconds", api.setMaximumSeconds_,
+              false, missing) ;
+    bindEntry(lib, "Clp_setOptimizationDirection",
+              api.setOptimizationDirection_, false, missing) ;
+    bindEntry(lib, "Clp_setPrimalTolerance", api.setPrimalTolerance_,
+              false, missing) ;
+    bindEntry(lib, "Clp_setDualTolerance", api.setDualTolerance_,
+              false, missing) ;
+    bindEntry(lib, "Clp_setObjectiveOffset", api.setObjectiveOffset_,
+              false, missing) ;
+
+    bindEntry(lib, "Clp_numberRows", api.numberRows_, false, missing) ;
+    bindEntry(lib, "Clp_numberColumns", api.numberColumns_, false, missing) ;
+    bindEntry(lib, "Clp_numberIterations", api.numberIterations_,
+              false, missing) ;
+    bindEntry(lib, "Clp_status", api.status_, false, missing) ;
+    bindEntry(lib, "Clp_secondaryStatus", api.secondaryStatus_,
+              false, missing) ;
+    bindEntry(lib, "Clp_logLevel", api.logLevel_, false, missing) ;
+    bindEntry(lib, "Clp_isProvenOptimal", api.isProvenOptimal_,
+              false, missing) ;
+    bindEntry(lib, "Clp_isProvenPrimalInfeasible",
+              api.isProvenPrimalInfeasible_, false, missing) ;
+    bindEntry(lib, "Clp_isProvenDualInfeasible",
+              api.isProvenDualInfeasible_, false, missing) ;
+    bindEntry(lib, "Clp_isAbandoned", api.isAbandoned_, false, missing) ;
+    bindEntry(lib, "Clp_isIterationLimitReached",
+              api.isIterationLimitReached_, false, missing) ;
+    bindEntry(lib, "Clp_objectiveValue", api.objectiveValue_,
+              false, missing) ;
+    bindEntry(lib, "Clp_optimizationDirection", api.optimizationDirection_,
+              false, missing) ;
+    bindEntry(lib, "Clp_rowLower", api.rowLower_, false, missing) ;
+    bindEntry(lib, "Clp_rowUpper", api.rowUpper_, false, missing) ;
+    bindEntry(lib, "Clp_columnLower", api.columnLower_, false, missing) ;
+    bindEntry(lib, "Clp_columnUpper", api.columnUpper_, false, missing) ;
+    bindEntry(lib, "Clp_objective", api.objective_, false, missing) ;
+    bindEntry(lib, "Clp_primalRowSolution", api.primalRowSolution_,
+              false, missing) ;
+    bindEntry(lib, "Clp_primalColumnSolution", api.primalColumnSolution_,
+              false, missing) ;
+    bindEntry(lib, "Clp_dualRowSolution", api.dualRowSolution_,
+              false, missing) ;
+    bindEntry(lib, "Clp_dualColumnSolution", api.dualColumnSolution_,
+              false, missing) ;
+    bindEntry(lib, "Clp_objectiveOffset", api.objectiveOffset_,
+              false, missing) ;
+    bindEntry(lib, "Clp_getNumElements", api.getNumElements_, false, missing) ;
+    bindEntry(lib, "Clp_getVectorStarts", api.getVectorStarts_,
+              false, missing) ;
+    bindEntry(lib, "Clp_getIndices", api.getIndices_, false, missing) ;
+    bindEntry(lib, "Clp_getVectorLengths", api.getVectorLengths_,
+              false, missing) ;
+    bindEntry(lib, "Clp_getElements", api.getElements_, false, missing) ;
+    bindEntry(lib, "Clp_integerInformation", api.integerInformation_,
+              false, missing) ;
+    bindEntry(lib, "Clp_statusArray", api.statusArray_, false, missing) ;
+    bindEntry(lib, "Clp_lengthNames", api.lengthNames_, false, missing) ;
+    bindEntry(lib, "Clp_rowName", api.rowName_, false, missing) ;
+    bindEntry(lib, "Clp_columnName", api.columnName_, false, missing) ;
+    bindEntry(lib, "Clp_problemName", api.problemName_, false, missing) ;
+
+    if (!missing.empty()) {
+        errStr += "Missing required clp entry points: " + missing ;
+        return (false) ;
+    }
+    return (true) ;
+}
+
 /*! \brief Object factory
 
   Create clp-specific objects to satisfy the Osi2 API specified as the
@@ -44,47 +182,29 @@ ClpShim::ClpShim ()
 */
 void *ClpShim::create (const ObjectParams *params)
 {
-    class ClpSimplex ;
-    typedef Clp_Simplex *(*ClpFactory)() ;
-    typedef ClpSimplex *(*ClpSimplexFactory)(Clp_Simplex *clp) ;
-
     std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
     void *retval = nullptr ;
+    ClpShim *shim = static_cast<ClpShim*>(params->ctrlObj_) ;
+    const PluginLog &log = shim->getLog() ;
 
-    std::cout << "Clp create: type " << what << "." << std::endl ;
+    OSI2_PLUGIN_LOG(log, 5) << "Clp create: type " << what << "." ;
 
     if (what == "ClpSimplex" ||
         // what == "Osi1" ||
 	what == "ProbMgmt" ||
         what == "WildProbMgmt") {
-        std::cout
-                << "Request to create " << what << " recognised." << std::endl ;
-        ClpShim *shim = static_cast<ClpShim*>(params->ctrlObj_) ;
-        DynamicLibrary *libClp = shim->libClp_ ;
-        std::string errStr ;
-	/*
-	  Use size_t as an intermediary to suppress function to object pointer
-	  conversion error.
-	*/
-	size_t grossHack =
-            reinterpret_cast<size_t>(libClp->getSymbol("Clp_newModel", errStr)) ;
-        ClpFactory factory = reinterpret_cast<ClpFactory>(grossHack) ;
-        if (factory == nullptr) {
-            std::cout << "Apparent failure to find Clp_newModel." << std::endl ;
-            std::cout << errStr << std::endl ;
-            return (nullptr) ;
-        }
-        Clp_Simplex *wrapper = factory() ;
-        grossHack = reinterpret_cast<size_t>(libClp->getSymbol("Clp_model", errStr)) ;
-        ClpSimplexFactory underlyingModel = reinterpret_cast<ClpSimplexFactory>(grossHack) ;
-        if (underlyingModel == 0) {
-            std::cout << "Apparent failure to find Clp_model." << std::endl ;
-            std::cout << errStr << std::endl ;
-            return (nullptr) ;
-        }
-        ClpSimplex *retval = underlyingModel(wrapper) ;
+        OSI2_PLUGIN_LOG(log, 5)
+                << "Request to create " << what << " recognised." ;
+        /*
+          The entry points were bound when the shim was initialised.
+        */
+        const ClpCApi *clpApi = shim->getClpApi() ;
+        Clp_Simplex *wrapper = clpApi->newModel_() ;
+        ClpSimplex *retval = clpApi->model_(wrapper) ;
         if (what == "ProbMgmt" || what == "WildProbMgmt") {
-            ProbMgmtAPI *probMgmt = new ProbMgmtAPI_Clp(libClp, wrapper) ;
+            ProbMgmtAPI *probMgmt =
+                new ProbMgmtAPI_Clp(clpApi, wrapper, log, shim->getMem(),
+                                    shim->getThreads()) ;
             return (probMgmt) ;
 	} else if (what == "Osi1") {
 	    // Osi1API *osi1 = new Osi1API_Clp(libClp,wrapper) ;
@@ -93,13 +213,59 @@ void *ClpShim::create (const ObjectParams *params)
             return (retval) ;
         }
     } else {
-        std::cout
-                << "Clp create: unrecognised type " << what << "." << std::endl ;
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Clp create: unrecognised type " << what << "." ;
     }
 
     return (retval) ;
 }
 
+/*! \brief Bulk object factory
+
+  Decode the API once, then make the models. Only the APIs that give back
+  a ProbMgmtAPI are worth doing in bulk; anything else goes to #create one
+  at a time.
+*/
+int32_t ClpShim::createMany (const ObjectParams *params, int32_t count,
+                             void **objects)
+{
+    std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
+    if (!(what == "ProbMgmt" || what == "WildProbMgmt")) {
+        int32_t made = 0 ;
+        while (made < count &&
+                (objects[made] = create(params)) != nullptr)
+            made++ ;
+        return (made) ;
+    }
+    ClpShim *shim = static_cast<ClpShim*>(params->ctrlObj_) ;
+    const PluginLog &log = shim->getLog() ;
+    OSI2_PLUGIN_LOG(log, 5)
+            << "Request to create " << count << " " << what << " recognised." ;
+    const ClpCApi *clpApi = shim->getClpApi() ;
+    for (int32_t i = 0 ; i < count ; i++) {
+        Clp_Simplex *wrapper = clpApi->newModel_() ;
+        if (wrapper == nullptr) return (i) ;
+        objects[i] = new ProbMgmtAPI_Clp(clpApi, wrapper, log,
+                                         shim->getMem(), shim->getThreads()) ;
+    }
+    return (count) ;
+}
+
+/*! \brief Capability check
+
+  The same list of APIs recognised by #create, but nothing is created. This
+  lets the plugin manager rule out the wildcard registration for an API we
+  can't supply without touching libClp.
+*/
+int32_t ClpShim::canCreate (const ObjectParams *params)
+{
+    std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
+
+    return (what == "ClpSimplex" ||
+            what == "ProbMgmt" ||
+            what == "WildProbMgmt") ;
+}
+
 /*! \brief Object destructor
 
   Given that ClpShim only hands out C++ objects that are derived from
@@ -107,9 +273,11 @@ void *ClpShim::create (const ObjectParams *params)
 */
 int32_t ClpShim::destroy (void *victim, const ObjectParams *objParms)
 {
-    std::string what = reinterpret_cast<const char *>(objParms->apiStr_) ;
-    std::cout
-            << "Request to destroy " << what << " recognised." << std::endl ;
+    const ClpShim *shim = static_cast<const ClpShim*>(objParms->ctrlObj_) ;
+    OSI2_PLUGIN_LOG(shim->getLog(), 5)
+            << "Request to destroy "
+            << reinterpret_cast<const char *>(objParms->apiStr_)
+            << " recognised." ;
     API *api = static_cast<API *>(victim) ;
     delete api ;
 
@@ -127,9 +295,11 @@ extern "C"
 ExitFunc initPlugin (PlatformServices *services)
 {
     std::string version = CLP_VERSION ;
-    std::cout
+    PluginLog log ;
+    log.init(services) ;
+    OSI2_PLUGIN_LOG(log, 4)
             << "Executing ClpShim::initPlugin, clp version "
-            << version << "." << std::endl ;
+            << version << "." ;
     /*
       Attempt to load clp.
     */
@@ -140,10 +310,9 @@ ExitFunc initPlugin (PlatformServices *services)
     std::string fullPath = libPath + "/" + libClpName ;
     DynamicLibrary *libClp = DynamicLibrary::load(fullPath, errMsg) ;
     if (libClp == nullptr) {
-        std::cout
-                << "Apparent failure opening " << fullPath << "." << std::endl ;
-        std::cout
-                << "Error is " << errMsg << "." << std::endl ;
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Apparent failure opening " << fullPath << "." ;
+        OSI2_PLUGIN_LOG(log, 1) << "Error is " << errMsg << "." ;
         return (nullptr) ;
     }
     /*
@@ -156,6 +325,21 @@ ExitFunc initPlugin (PlatformServices *services)
     ClpShim *shim = new ClpShim() ;
     shim->setLibClp(libClp) ;
     shim->setPluginID(services->pluginID_) ;
+    shim->setLog(log) ;
+    PluginMem mem ;
+    mem.init(services) ;
+    shim->setMem(mem) ;
+    PluginThreads threads ;
+    threads.init(services) ;
+    shim->setThreads(threads) ;
+    if (!shim->bindClp(errMsg)) {
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Apparent failure binding " << fullPath << "." ;
+        OSI2_PLUGIN_LOG(log, 1) << "Error is " << errMsg << "." ;
+        delete shim ;
+        delete libClp ;
+        return (nullptr) ;
+    }
     services->ctrlObj_ = static_cast<PluginState *>(shim) ;
     /*
       RegisterParams.
@@ -173,20 +357,33 @@ ExitFunc initPlugin (PlatformServices *services)
     reginfo.pluginID_ = shim->getPluginID() ;
     reginfo.createFunc_ = ClpShim::create ;
     reginfo.destroyFunc_ = ClpShim::destroy ;
+    reginfo.capabilityFunc_ = ClpShim::canCreate ;
+    reginfo.bulkCreateFunc_ = ClpShim::createMany ;
+    /*
+      Each object has its own ClpSimplex, so distinct objects can be used from
+      different threads. Loading from memory needs Clp_loadProblem, which an
+      old libClp may lack.
+    */
+    reginfo.caps_.problems_ = PluginProb_LP ;
+    reginfo.caps_.props_ = PluginProp_ThreadSafe ;
+    if (shim->getClpApi()->loadProblem_ != nullptr)
+        reginfo.caps_.props_ |= PluginProp_LoadInMemory ;
+    reginfo.caps_.createCost_ = 10 ;
+    reginfo.caps_.solveCost_ = 100 ;
     int retval =
         services->registerObject_(
             reinterpret_cast<const unsigned char*>("ClpSimplex"), &reginfo) ;
     if (retval < 0) {
-        std::cout
-                << "Apparent failure to register ClpSimplex plugin." << std::endl ;
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Apparent failure to register ClpSimplex plugin." ;
         return (nullptr) ;
     }
     retval =
         services->registerObject_(
             reinterpret_cast<const unsigned char*>("ProbMgmt"), &reginfo) ;
     if (retval < 0) {
-        std::cout
-                << "Apparent failure to register ProgMgmt plugin." << std::endl ;
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Apparent failure to register ProgMgmt plugin." ;
         return (nullptr) ;
     }
     /*
@@ -196,8 +393,8 @@ ExitFunc initPlugin (PlatformServices *services)
         services->registerObject_(
             reinterpret_cast<const unsigned char*>("*"), &reginfo) ;
     if (retval < 0) {
-        std::cout
-                << "Apparent failure to register wildcard plugin." << std::endl ;
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Apparent failure to register wildcard plugin." ;
         return (nullptr) ;
     }
 
@@ -17,6 +17,12 @@
 
 #include "Osi2Plugin.hpp"
 #include "Osi2DynamicLibrary.hpp"
+#include "Osi2PluginLog.hpp"
+#include "Osi2PluginMem.hpp"
+#include "Osi2PluginThreads.hpp"
+
+#include "Clp_C_Interface.h"
+#include "Osi2ClpCApi.hpp"
 
 namespace Osi2 {
 /*! \brief Light shim for the clp solver
@@ -40,12 +46,26 @@ public:
     */
     static void *create (const ObjectParams *params) ;
 
+    /*! \brief Bulk object factory
+
+      As #create, for \p count objects at once. The API is decoded once for
+      the lot.
+    */
+    static int32_t createMany (const ObjectParams *params, int32_t count,
+                               void **objects) ;
+
     /*! \brief Object destructor
 
       Destroys objects created by this shim.
     */
     static int32_t destroy (void *victim, const ObjectParams *params) ;
 
+    /*! \brief Capability check
+
+      Returns nonzero if #create can supply the API specified in \p params.
+    */
+    static int32_t canCreate (const ObjectParams *params) ;
+
     /// Set our unique ID (supplied by the plugin manager)
     inline void setPluginID (PluginUniqueID id) {
         ourID_ = id ;
@@ -71,6 +91,46 @@ public:
         return (verbosity_) ;
     }
 
+    /// Set the plugin manager's log service
+    inline void setLog (const PluginLog &log) {
+        log_ = log ;
+    }
+    /// The plugin manager's log service, shared by all objects from this shim
+    inline const PluginLog &getLog () const {
+        return (log_) ;
+    }
+
+    /// Set the plugin manager's memory accounting service
+    inline void setMem (const PluginMem &mem) {
+        mem_ = mem ;
+    }
+    /// The plugin manager's memory accounting service
+    inline const PluginMem &getMem () const {
+        return (mem_) ;
+    }
+
+    /// Set the plugin manager's thread pool
+    inline void setThreads (const PluginThreads &threads) {
+        threads_ = threads ;
+    }
+    /// The plugin manager's thread pool
+    inline const PluginThreads &getThreads () const {
+        return (threads_) ;
+    }
+
+    /*! \brief Bind the clp C interface
+
+      Fills in the table returned by #getClpApi, in one pass when the shim
+      is initialised. Returns false if any required entry point is missing;
+      \p errStr names them.
+    */
+    bool bindClp(std::string &errStr) ;
+
+    /// The clp C interface, shared by all the objects from this shim
+    inline const ClpCApi *getClpApi () const {
+        return (&clpApi_) ;
+    }
+
 private:
 
     /*! \brief Plugin manager services structure
@@ -88,6 +148,15 @@ private:
 
     /// Verbosity level for information messages
     int verbosity_ ;
+    /// The plugin manager's log service
+    PluginLog log_ ;
+    /// The plugin manager's memory accounting service
+    PluginMem mem_ ;
+    /// The plugin manager's thread pool
+    PluginThreads threads_ ;
+
+    /// The clp C interface; bound by #bindClp and not changed afterwards
+    ClpCApi clpApi_ ;
 
 } ;
 
@@ -0,0 +1,149 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2GlpkCApi.hpp
+    \brief The glpk C interface, as a table of entry points.
+
+  See Osi2::GlpkCApi.
+*/
+
+#ifndef Osi2GlpkCApi_HPP
+#define Osi2GlpkCApi_HPP
+
+namespace Osi2 {
+
+/*! \brief A glpk problem object
+
+  Opaque; only ever handled by pointer. glpk's own glp_prob has been
+  declared differently over the releases, so the light shim doesn't use
+  glpk.h at all and calls through pointers to this type instead.
+*/
+struct GlpkProb ;
+
+/*! \brief The values of the glpk constants used by the light shim
+
+  These have been stable across glpk releases; they're repeated here so
+  that the light shim needs no glpk header.
+*/
+namespace GlpkConst {
+    /*! \name Objective direction (GLP_MIN, GLP_MAX) */
+    //@{
+    const int minimise = 1 ;
+    const int maximise = 2 ;
+    //@}
+    /// Variable kind (GLP_IV)
+    const int integerVar = 2 ;
+    /*! \name Bound types (GLP_FR, GLP_LO, GLP_UP, GLP_DB, GLP_FX) */
+    //@{
+    const int boundFree = 1 ;
+    const int boundLower = 2 ;
+    const int boundUpper = 3 ;
+    const int boundDouble = 4 ;
+    const int boundFixed = 5 ;
+    //@}
+    /*! \name Solution status (GLP_INFEAS, GLP_NOFEAS, GLP_OPT, GLP_UNBND) */
+    //@{
+    const int infeasible = 3 ;
+    const int noFeasible = 4 ;
+    const int optimal = 5 ;
+    const int unbounded = 6 ;
+    //@}
+    /*! \name glp_simplex failures (GLP_EITLIM, GLP_ETMLIM) */
+    //@{
+    const int iterationLimit = 0x08 ;
+    const int timeLimit = 0x09 ;
+    //@}
+    /// Free mps format (GLP_MPS_FILE)
+    const int freeMps = 2 ;
+}
+
+/*! \brief The glpk C interface, as a table of entry points
+
+  The light glpk shim loads libglpk at run time, and only when the first
+  object is made, so it can't call glpk directly. Instead GlpkShim binds
+  every entry point once, when libglpk is loaded, and fills in this table.
+  The table is not changed afterwards; all the objects the shim hands out
+  share it.
+
+  The entries marked `required' are needed by the shim itself, and a
+  libglpk without them is rejected. The rest are null if libglpk doesn't
+  supply them; check before use.
+*/
+struct GlpkCApi {
+
+    /*! \name Problems */
+    //@{
+    /// glp_create_prob (required)
+    typedef GlpkProb *(*CreateProbFunc)() ;
+    CreateProbFunc createProb_ ;
+    /// glp_delete_prob (required)
+    typedef void (*DeleteProbFunc)(GlpkProb *) ;
+    DeleteProbFunc deleteProb_ ;
+    /// glp_erase_prob (required)
+    typedef void (*EraseProbFunc)(GlpkProb *) ;
+    EraseProbFunc eraseProb_ ;
+    /// glp_version
+    typedef const char *(*VersionFunc)() ;
+    VersionFunc version_ ;
+    //@}
+
+    /*! \name Loading */
+    //@{
+    /// glp_read_mps (required)
+    typedef int (*ReadMpsFunc)(GlpkProb *, int, const void *, const char *) ;
+    ReadMpsFunc readMps_ ;
+    /// glp_add_rows, glp_add_cols (required)
+    typedef int (*AddFunc)(GlpkProb *, int) ;
+    AddFunc addRows_ ;
+    AddFunc addCols_ ;
+    /// glp_set_row_bnds, glp_set_col_bnds (required)
+    typedef void (*SetBndsFunc)(GlpkProb *, int, int, double, double) ;
+    SetBndsFunc setRowBnds_ ;
+    SetBndsFunc setColBnds_ ;
+    /// glp_set_obj_coef (required)
+    typedef void (*SetObjCoefFunc)(GlpkProb *, int, double) ;
+    SetObjCoefFunc setObjCoef_ ;
+    /// glp_set_mat_col (required)
+    typedef void (*SetMatColFunc)(GlpkProb *, int, int, const int *,
+                                  const double *) ;
+    SetMatColFunc setMatCol_ ;
+    /// glp_set_obj_dir
+    typedef void (*SetObjDirFunc)(GlpkProb *, int) ;
+    SetObjDirFunc setObjDir_ ;
+    /// glp_set_col_kind
+    typedef void (*SetColKindFunc)(GlpkProb *, int, int) ;
+    SetColKindFunc setColKind_ ;
+    /// glp_set_prob_name
+    typedef void (*SetProbNameFunc)(GlpkProb *, const char *) ;
+    SetProbNameFunc setProbName_ ;
+    /// glp_set_row_name, glp_set_col_name
+    typedef void (*SetNameFunc)(GlpkProb *, int, const char *) ;
+    SetNameFunc setRowName_ ;
+    SetNameFunc setColName_ ;
+    //@}
+
+    /*! \name Solving */
+    //@{
+    /// glp_simplex (required); the parameter block may be null
+    typedef int (*SimplexFunc)(GlpkProb *, const void *) ;
+    SimplexFunc simplex_ ;
+    /// glp_get_status (required)
+    typedef int (*GetStatusFunc)(GlpkProb *) ;
+    GetStatusFunc getStatus_ ;
+    /// glp_get_obj_val
+    typedef double (*GetObjValFunc)(GlpkProb *) ;
+    GetObjValFunc getObjVal_ ;
+    /// glp_get_num_rows, glp_get_num_cols
+    typedef int (*GetNumFunc)(GlpkProb *) ;
+    GetNumFunc getNumRows_ ;
+    GetNumFunc getNumCols_ ;
+    //@}
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -12,8 +12,6 @@
   glpk libraries.
 */
 
-#include <iostream>
-
 #include "glpk.h"
 
 #include "Osi2GlpkHeavyShim.hpp"
@@ -43,17 +41,19 @@ void *GlpkHeavyShim::create (const ObjectParams *params)
 {
     std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
     void *retval = nullptr ;
+    const GlpkHeavyShim *shim =
+        static_cast<const GlpkHeavyShim *>(params->ctrlObj_) ;
+    const PluginLog &log = shim->getLog() ;
 
-    std::cout << "GlpkHeavy create: type " << what << "." << std::endl ;
+    OSI2_PLUGIN_LOG(log, 5) << "GlpkHeavy create: type " << what << "." ;
 
     if (what == "Osi1") {
-      std::cout
-	  << "Request to create " << what << " recognised." << std::endl ;
-      retval = new Osi1API_GlpkHeavy() ;
+      OSI2_PLUGIN_LOG(log, 5)
+	  << "Request to create " << what << " recognised." ;
+      retval = new Osi1API_GlpkHeavy(log) ;
     } else {
-      std::cout
-	  << "GlpkHeavy create: unrecognised type " << what << "."
-	  << std::endl ;
+      OSI2_PLUGIN_LOG(log, 1)
+	  << "GlpkHeavy create: unrecognised type " << what << "." ;
     }
 
     return (retval) ;
@@ -67,8 +67,11 @@ void *GlpkHeavyShim::create (const ObjectParams *params)
 int32_t GlpkHeavyShim::destroy (void *victim, const ObjectParams *objParms)
 {
     std::string what = reinterpret_cast<const char *>(objParms->apiStr_) ;
-    std::cout
-            << "Request to destroy " << what << " recognised." << std::endl ;
+    const GlpkHeavyShim *shim =
+        static_cast<const GlpkHeavyShim *>(objParms->ctrlObj_) ;
+    const PluginLog &log = shim->getLog() ;
+    OSI2_PLUGIN_LOG(log, 5)
+            << "Request to destroy " << what << " recognised." ;
     API *api = static_cast<API *>(victim) ;
     delete api ;
 
@@ -86,9 +89,11 @@ extern "C"
 ExitFunc initPlugin (PlatformServices *services)
 {
     std::string version = glp_version() ;
-    std::cout
+    PluginLog log ;
+    log.init(services) ;
+    OSI2_PLUGIN_LOG(log, 4)
             << "Executing GlpkHeavyShim::initPlugin, glpk version "
-            << version << "." << std::endl ;
+            << version << "." ;
     /*
       Create the plugin library state object, GlpkHeavyShim.  Arrange to
       remember our unique ID from the plugin manager.  Then stash a pointer
@@ -98,6 +103,7 @@ ExitFunc initPlugin (PlatformServices *services)
     */
     GlpkHeavyShim *shim = new GlpkHeavyShim() ;
     shim->setPluginID(services->pluginID_) ;
+    shim->setLog(log) ;
     services->ctrlObj_ = static_cast<PluginState *>(shim) ;
     /*
       RegisterParams.
@@ -116,11 +122,21 @@ ExitFunc initPlugin (PlatformServices *services)
     reginfo.pluginID_ = shim->getPluginID() ;
     reginfo.createFunc_ = GlpkHeavyShim::create ;
     reginfo.destroyFunc_ = GlpkHeavyShim::destroy ;
+    reginfo.capabilityFunc_ = nullptr ;
+    reginfo.bulkCreateFunc_ = nullptr ;
+    /*
+      Older glpk keeps its environment in globals, so make no claim about
+      threads.
+    */
+    reginfo.caps_.problems_ = PluginProb_LP|PluginProb_MIP ;
+    reginfo.caps_.props_ = PluginProp_LoadInMemory ;
+    reginfo.caps_.createCost_ = 20 ;
+    reginfo.caps_.solveCost_ = 200 ;
     int retval = services->registerObject_(
 		reinterpret_cast<const unsigned char*>("Osi1"), &reginfo) ;
     if (retval < 0) {
-        std::cout
-                << "Apparent failure to register Osi1 plugin." << std::endl ;
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Apparent failure to register Osi1 plugin." ;
         return (nullptr) ;
     }
 
@@ -17,6 +17,7 @@
 
 #include "Osi2Plugin.hpp"
 #include "Osi2DynamicLibrary.hpp"
+#include "Osi2PluginLog.hpp"
 
 namespace Osi2 {
 
@@ -62,6 +63,14 @@ public:
     inline int getVerbosity () const {
         return (verbosity_) ;
     }
+    /// Set the plugin manager's log service
+    inline void setLog (const PluginLog &log) {
+        log_ = log ;
+    }
+    /// The plugin manager's log service
+    inline const PluginLog &getLog () const {
+        return (log_) ;
+    }
 
 private:
 
@@ -78,6 +87,9 @@ private:
     /// Verbosity level for information messages
     int verbosity_ ;
 
+    /// The plugin manager's log service
+    PluginLog log_ ;
+
 } ;
 
 /*! \brief Plugin initialisation method
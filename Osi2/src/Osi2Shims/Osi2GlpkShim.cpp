@@ -0,0 +1,429 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2GlpkShim.cpp
+    \brief Method definitions for GlpkShim.
+
+  This shim is written to dynamically load libglpk, on first use. As such,
+  it doesn't need to be linked with libglpk. The tradeoff is that it must
+  work through glpk's C interface and look up the functions it wants to
+  use.
+*/
+
+#include <cstring>
+
+#include "Osi2GlpkShim.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2DynamicLibrary.hpp"
+
+#include "Osi2ProbMgmtAPI_Glpk.hpp"
+
+using namespace Osi2 ;
+
+namespace {
+
+/*
+  Look up one entry point of the C interface. A missing required entry is
+  added to the list in missing.
+*/
+template <typename FuncType>
+void bindEntry (DynamicLibrary *lib, const char *name, FuncType &entry,
+                bool required, std::string &missing)
+{
+    std::string symErr ;
+    entry = symbolToFunc<FuncType>(lib->getSymbol(name, symErr)) ;
+    if (entry == nullptr && required) {
+        if (!missing.empty()) missing += ", " ;
+        missing += name ;
+    }
+}
+
+/*
+  Load a library from the plugin directory, or failing that wherever the
+  platform's search finds it.
+*/
+DynamicLibrary *loadFromDirOrPath (const std::string &dir,
+                                   const std::string &name,
+                                   std::string &errStr)
+{
+    std::string dirErr ;
+    DynamicLibrary *lib = nullptr ;
+    if (!dir.empty()) {
+        lib = DynamicLibrary::load(dir+"/"+name, dirErr) ;
+        if (lib != nullptr) return (lib) ;
+    }
+    lib = DynamicLibrary::load(name, errStr) ;
+    if (lib == nullptr && !dirErr.empty()) errStr = dirErr+"; "+errStr ;
+    return (lib) ;
+}
+
+/// The name of libglpk
+const char *const libGlpkName = "libglpk.so" ;
+
+/// The name of the heavy glpk shim
+const char *const libHeavyName = "libOsi2GlpkHeavyShim.so" ;
+
+}   // end unnamed file-local namespace
+
+GlpkShim *GlpkShim::starting_ = nullptr ;
+
+/*
+  Default constructor. Nothing is loaded; the C interface table starts out
+  null.
+*/
+GlpkShim::GlpkShim ()
+    : ourID_(0),
+      verbosity_(1),
+      libGlpk_(nullptr),
+      glpkApi_(),
+      glpkBound_(false),
+      libHeavy_(nullptr),
+      heavyRegistered_(false),
+      heavyExit_(nullptr)
+{
+    std::memset(&heavyServices_, 0, sizeof(heavyServices_)) ;
+    std::memset(&heavyReg_, 0, sizeof(heavyReg_)) ;
+}
+
+/*
+  Destructor. By now the heavy shim has been shut down (#cleanup) and all
+  the objects destroyed.
+*/
+GlpkShim::~GlpkShim ()
+{
+    cleanup() ;
+    delete libHeavy_ ;
+    libHeavy_ = nullptr ;
+    delete libGlpk_ ;
+    libGlpk_ = nullptr ;
+}
+
+void GlpkShim::setServices (const PlatformServices &services)
+{
+    const char *dir =
+        reinterpret_cast<const char *>(services.dfltPluginDir_) ;
+    pluginDir_ = (dir == nullptr) ? "" : dir ;
+    log_.init(&services) ;
+    heavyServices_ = services ;
+    heavyServices_.dfltPluginDir_ =
+        reinterpret_cast<const CharString *>(pluginDir_.c_str()) ;
+}
+
+/*
+  The first caller pays for the load; everyone after just takes the lock
+  and finds the table bound. The table doesn't change once bound, so
+  objects can use it without the lock.
+*/
+const GlpkCApi *GlpkShim::getGlpkApi (std::string &errStr)
+{
+    ScopedLock lock(mutex_) ;
+    if (!glpkBound_ && glpkErr_.empty()) {
+        if (!bindGlpk(glpkErr_) && glpkErr_.empty())
+            glpkErr_ = "Cannot bind libglpk." ;
+    }
+    if (!glpkBound_) {
+        errStr += glpkErr_ ;
+        return (nullptr) ;
+    }
+    return (&glpkApi_) ;
+}
+
+/*
+  Load libglpk and bind the C interface, all at once. The objects we hand
+  out call through the table and never look anything up themselves, so a
+  libglpk that lacks a required entry point is rejected here.
+*/
+bool GlpkShim::bindGlpk (std::string &errStr)
+{
+    DynamicLibrary *lib = loadFromDirOrPath(pluginDir_, libGlpkName, errStr) ;
+    if (lib == nullptr) return (false) ;
+    GlpkCApi &api = glpkApi_ ;
+    std::string missing ;
+
+    bindEntry(lib, "glp_create_prob", api.createProb_, true, missing) ;
+    bindEntry(lib, "glp_delete_prob", api.deleteProb_, true, missing) ;
+    bindEntry(lib, "glp_erase_prob", api.eraseProb_, true, missing) ;
+    bindEntry(lib, "glp_version", api.version_, false, missing) ;
+
+    bindEntry(lib, "glp_read_mps", api.readMps_, true, missing) ;
+    bindEntry(lib, "glp_add_rows", api.addRows_, true, missing) ;
+    bindEntry(lib, "glp_add_cols", api.addCols_, true, missing) ;
+    bindEntry(lib, "glp_set_row_bnds", api.setRowBnds_, true, missing) ;
+    bindEntry(lib, "glp_set_col_bnds", api.setColBnds_, true, missing) ;
+    bindEntry(lib, "glp_set_obj_coef", api.setObjCoef_, true, missing) ;
+    bindEntry(lib, "glp_set_mat_col", api.setMatCol_, true, missing) ;
+    bindEntry(lib, "glp_set_obj_dir", api.setObjDir_, false, missing) ;
+    bindEntry(lib, "glp_set_col_kind", api.setColKind_, false, missing) ;
+    bindEntry(lib, "glp_set_prob_name", api.setProbName_, false, missing) ;
+    bindEntry(lib, "glp_set_row_name", api.setRowName_, false, missing) ;
+    bindEntry(lib, "glp_set_col_name", api.setColName_, false, missing) ;
+
+    bindEntry(lib, "glp_simplex", api.simplex_, true, missing) ;
+    bindEntry(lib, "glp_get_status", api.getStatus_, true, missing) ;
+    bindEntry(lib, "glp_get_obj_val", api.getObjVal_, false, missing) ;
+    bindEntry(lib, "glp_get_num_rows", api.getNumRows_, false, missing) ;
+    bindEntry(lib, "glp_get_num_cols", api.getNumCols_, false, missing) ;
+
+    if (!missing.empty()) {
+        errStr += "Missing required glpk entry points: " + missing ;
+        glpkApi_ = GlpkCApi() ;
+        delete lib ;
+        return (false) ;
+    }
+    libGlpk_ = lib ;
+    glpkBound_ = true ;
+    OSI2_PLUGIN_LOG(log_, 4)
+        << "GlpkShim: loaded libglpk"
+        << ((api.version_ == nullptr) ? "" : ", version ")
+        << ((api.version_ == nullptr) ? "" : api.version_())
+        << "." ;
+    return (true) ;
+}
+
+/*
+  Start the heavy shim as the plugin manager would, but with our own
+  registration function, which keeps its registration for Osi1. It's
+  called from inside the heavy shim's initPlugin, while #mutex_ is held;
+  #starting_ tells it where to put what it's given.
+*/
+bool GlpkShim::startHeavy (std::string &errStr)
+{
+    DynamicLibrary *lib = loadFromDirOrPath(pluginDir_, libHeavyName, errStr) ;
+    if (lib == nullptr) return (false) ;
+    std::string symErr ;
+    InitFunc initFunc =
+        symbolToFunc<InitFunc>(lib->getSymbol("initPlugin", symErr)) ;
+    if (initFunc == nullptr) {
+        errStr += symErr ;
+        delete lib ;
+        return (false) ;
+    }
+    PlatformServices services = heavyServices_ ;
+    services.ctrlObj_ = nullptr ;
+    services.registerObject_ = registerHeavy ;
+    starting_ = this ;
+    ExitFunc exitFunc = initFunc(&services) ;
+    starting_ = nullptr ;
+    if (exitFunc == nullptr || !heavyRegistered_) {
+        errStr += "The heavy glpk shim did not register Osi1." ;
+        if (exitFunc != nullptr) {
+            services.registerObject_ = nullptr ;
+            exitFunc(&services) ;
+        }
+        heavyRegistered_ = false ;
+        delete lib ;
+        return (false) ;
+    }
+    heavyServices_.ctrlObj_ = services.ctrlObj_ ;
+    heavyExit_ = exitFunc ;
+    libHeavy_ = lib ;
+    return (true) ;
+}
+
+int32_t GlpkShim::registerHeavy (const CharString *apiStr,
+                                 const RegisterParams *params)
+{
+    GlpkShim *shim = starting_ ;
+    if (shim == nullptr || params == nullptr || params->createFunc_ == nullptr)
+        return (-1) ;
+    const char *api = reinterpret_cast<const char *>(apiStr) ;
+    if (std::strcmp(api, "Osi1") != 0) return (0) ;
+    shim->heavyReg_ = *params ;
+    shim->heavyRegistered_ = true ;
+    return (0) ;
+}
+
+/*
+  Create an Osi1 object by way of the heavy shim, starting it first if
+  need be. A failure to start is remembered.
+*/
+void *GlpkShim::createOsi1 (const ObjectParams *params)
+{
+    CreateFunc createFunc = nullptr ;
+    ObjectParams heavyParams ;
+    {
+        ScopedLock lock(mutex_) ;
+        if (libHeavy_ == nullptr && heavyErr_.empty()) {
+            if (!startHeavy(heavyErr_) && heavyErr_.empty())
+                heavyErr_ = "Cannot start the heavy glpk shim." ;
+        }
+        if (libHeavy_ == nullptr) {
+            OSI2_PLUGIN_LOG(log_, 1) << "GlpkShim: " << heavyErr_ ;
+            return (nullptr) ;
+        }
+        createFunc = heavyReg_.createFunc_ ;
+        heavyParams.apiStr_ = params->apiStr_ ;
+        heavyParams.platformServices_ = &heavyServices_ ;
+        heavyParams.ctrlObj_ = heavyReg_.ctrlObj_ ;
+    }
+    return (createFunc(&heavyParams)) ;
+}
+
+int32_t GlpkShim::destroyOsi1 (void *victim, const ObjectParams *params)
+{
+    ObjectParams heavyParams ;
+    heavyParams.apiStr_ = params->apiStr_ ;
+    heavyParams.platformServices_ = &heavyServices_ ;
+    heavyParams.ctrlObj_ = heavyReg_.ctrlObj_ ;
+    return (heavyReg_.destroyFunc_(victim, &heavyParams)) ;
+}
+
+/*
+  Shut down the heavy shim. The library stays loaded until the destructor;
+  its exit function may have left things that need its code.
+*/
+void GlpkShim::cleanup ()
+{
+    ScopedLock lock(mutex_) ;
+    if (heavyExit_ != nullptr) {
+        PlatformServices services = heavyServices_ ;
+        services.registerObject_ = nullptr ;
+        heavyExit_(&services) ;
+        heavyExit_ = nullptr ;
+    }
+}
+
+/*! \brief Object factory
+
+  Create glpk-specific objects to satisfy the Osi2 API specified as the
+  \p objectType member of of \p params. This is where libglpk, or the heavy
+  shim, gets loaded.
+*/
+void *GlpkShim::create (const ObjectParams *params)
+{
+    std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
+    GlpkShim *shim = static_cast<GlpkShim*>(params->ctrlObj_) ;
+    const PluginLog &log = shim->getLog() ;
+
+    OSI2_PLUGIN_LOG(log, 5) << "Glpk create: type " << what << "." ;
+
+    if (what == "ProbMgmt") {
+        OSI2_PLUGIN_LOG(log, 5)
+                << "Request to create " << what << " recognised." ;
+        std::string errStr ;
+        const GlpkCApi *glpkApi = shim->getGlpkApi(errStr) ;
+        if (glpkApi == nullptr) {
+            OSI2_PLUGIN_LOG(log, 1) << "GlpkShim: " << errStr ;
+            return (nullptr) ;
+        }
+        GlpkProb *prob = glpkApi->createProb_() ;
+        if (prob == nullptr) return (nullptr) ;
+        ProbMgmtAPI *probMgmt = new ProbMgmtAPI_Glpk(glpkApi, prob, log) ;
+        return (probMgmt) ;
+    } else if (what == "Osi1") {
+        OSI2_PLUGIN_LOG(log, 5)
+                << "Request to create " << what << " recognised." ;
+        return (shim->createOsi1(params)) ;
+    }
+    OSI2_PLUGIN_LOG(log, 1)
+            << "Glpk create: unrecognised type " << what << "." ;
+    return (nullptr) ;
+}
+
+/*! \brief Capability check
+
+  The same list of APIs recognised by #create, but nothing is created or
+  loaded.
+*/
+int32_t GlpkShim::canCreate (const ObjectParams *params)
+{
+    std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
+
+    return (what == "ProbMgmt" || what == "Osi1") ;
+}
+
+/*! \brief Object destructor
+
+  ProbMgmt objects are ours, derived from Osi2::API, and can simply be
+  deleted. Osi1 objects go back to the heavy shim that made them.
+*/
+int32_t GlpkShim::destroy (void *victim, const ObjectParams *objParms)
+{
+    std::string what = reinterpret_cast<const char *>(objParms->apiStr_) ;
+    GlpkShim *shim = static_cast<GlpkShim*>(objParms->ctrlObj_) ;
+    OSI2_PLUGIN_LOG(shim->getLog(), 5)
+            << "Request to destroy " << what << " recognised." ;
+    if (what == "Osi1") {
+        return (shim->destroyOsi1(victim, objParms)) ;
+    }
+    API *api = static_cast<API *>(victim) ;
+    delete api ;
+
+    return (0) ;
+}
+
+
+/*
+  Plugin initialisation method. Construct the shim and register the APIs
+  we support. Nothing is loaded here; see GlpkShim::create.
+*/
+extern "C"
+ExitFunc initPlugin (PlatformServices *services)
+{
+    PluginLog log ;
+    log.init(services) ;
+    OSI2_PLUGIN_LOG(log, 4) << "Executing GlpkShim::initPlugin." ;
+    /*
+      Create the plugin library state object, GlpkShim. Arrange to remember
+      the plugin directory, and our unique ID from the plugin manager. Then
+      stash a pointer to the shim in PlatformServices to return it to the
+      plugin manager.
+    */
+    GlpkShim *shim = new GlpkShim() ;
+    shim->setPluginID(services->pluginID_) ;
+    shim->setServices(*services) ;
+    services->ctrlObj_ = static_cast<PluginState *>(shim) ;
+    /*
+      Fill in the rest of the registration parameters and invoke the
+      registration method, once for each API.
+    */
+    RegisterParams reginfo ;
+    reginfo.ctrlObj_ = static_cast<PluginState *>(shim) ;
+    reginfo.version_.major_ = 1 ;
+    reginfo.version_.minor_ = 0 ;
+    reginfo.lang_ = Plugin_CPP ;
+    reginfo.pluginID_ = shim->getPluginID() ;
+    reginfo.createFunc_ = GlpkShim::create ;
+    reginfo.destroyFunc_ = GlpkShim::destroy ;
+    reginfo.capabilityFunc_ = GlpkShim::canCreate ;
+    reginfo.bulkCreateFunc_ = nullptr ;
+    /*
+      Older glpk keeps its environment in globals, so make no claim about
+      threads. The first object also loads libglpk.
+    */
+    reginfo.caps_.problems_ = PluginProb_LP|PluginProb_MIP ;
+    reginfo.caps_.props_ = PluginProp_LoadInMemory ;
+    reginfo.caps_.createCost_ = 10 ;
+    reginfo.caps_.solveCost_ = 200 ;
+    const char *apis[] = { "ProbMgmt", "Osi1" } ;
+    for (int i = 0 ; i < 2 ; i++) {
+        int retval = services->registerObject_(
+                reinterpret_cast<const unsigned char*>(apis[i]), &reginfo) ;
+        if (retval < 0) {
+            OSI2_PLUGIN_LOG(log, 1)
+                    << "Apparent failure to register " << apis[i]
+                    << " plugin." ;
+            services->ctrlObj_ = nullptr ;
+            delete shim ;
+            return (nullptr) ;
+        }
+    }
+
+    return (cleanupPlugin) ;
+}
+
+/*
+  Plugin cleanup method. Shut down the heavy shim, then let go of both
+  libraries.
+*/
+extern "C" int32_t cleanupPlugin (const PlatformServices *services)
+{
+    GlpkShim *shim = static_cast<GlpkShim *>(services->ctrlObj_) ;
+    delete shim ;
+    return (0) ;
+}
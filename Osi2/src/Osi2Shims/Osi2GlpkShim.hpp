@@ -0,0 +1,207 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2GlpkShim.hpp
+    \brief Declarations for Osi2::GlpkShim.
+
+  This shim is written to dynamically load libglpk, and only when it's
+  first needed. As such, it doesn't need to be linked with libglpk, and a
+  process that loads the shim but never makes a glpk object never maps
+  glpk. The tradeoff is that it must work through glpk's C interface and
+  look up the functions it wants to use.
+*/
+
+#ifndef Osi2GlpkShim_HPP
+#define Osi2GlpkShim_HPP
+
+#include <string>
+
+#include "Osi2Plugin.hpp"
+#include "Osi2DynamicLibrary.hpp"
+#include "Osi2Threads.hpp"
+#include "Osi2PluginLog.hpp"
+
+#include "Osi2GlpkCApi.hpp"
+
+namespace Osi2 {
+
+/*! \brief Light shim for the glpk solver
+
+  Like ClpShim, this shim works through the solver's C interface, bound
+  into a table (GlpkCApi) of entry points. Unlike ClpShim, nothing is
+  loaded when the shim is initialised: libglpk is loaded and bound by the
+  first request for a ProbMgmt object.
+
+  Osi1 objects come from the heavy glpk shim (GlpkHeavyShim), which
+  wraps OsiGlpkSolverInterface. It's loaded, and initialised with this
+  shim standing in for the plugin manager, by the first request for an
+  Osi1 object. The plugin manager sees only this shim.
+*/
+class GlpkShim {
+
+public:
+
+    /// Default constructor
+    GlpkShim() ;
+
+    /// Destructor; unloads what was loaded
+    ~GlpkShim() ;
+
+    /*! \brief Object factory
+
+      Create glpk-specific objects to satisfy the Osi2 API specified as the
+      \p objectType member of of \p params.
+    */
+    static void *create (const ObjectParams *params) ;
+
+    /*! \brief Object destructor
+
+      Destroys objects created by this shim.
+    */
+    static int32_t destroy (void *victim, const ObjectParams *params) ;
+
+    /*! \brief Capability check
+
+      Returns nonzero if #create can supply the API specified in \p params.
+      Nothing is loaded to find out.
+    */
+    static int32_t canCreate (const ObjectParams *params) ;
+
+    /// Set our unique ID (supplied by the plugin manager)
+    inline void setPluginID (PluginUniqueID id) {
+        ourID_ = id ;
+    }
+    /// Get our unique ID
+    inline PluginUniqueID getPluginID () const {
+        return (ourID_) ;
+    }
+    /*! \brief Keep what's needed of the plugin manager's services
+
+      The directory to search for libglpk and the heavy shim, the log
+      service, and the services to hand on to the heavy shim. \p services
+      needn't outlive the call.
+    */
+    void setServices(const PlatformServices &services) ;
+    /// Set verbosity
+    inline void setVerbosity (int verbosity) {
+        verbosity_ = verbosity ;
+    }
+    /// Get verbosity
+    inline int getVerbosity () const {
+        return (verbosity_) ;
+    }
+    /// The plugin manager's log service, shared by all objects from this shim
+    inline const PluginLog &getLog () const {
+        return (log_) ;
+    }
+
+    /*! \brief The glpk C interface, shared by all the objects from this shim
+
+      Loads and binds libglpk on the first call. Returns null if libglpk
+      can't be had; \p errStr says why. A failure is remembered, and later
+      calls fail at once.
+    */
+    const GlpkCApi *getGlpkApi(std::string &errStr) ;
+
+    /// Shut down the heavy shim, if it was started
+    void cleanup() ;
+
+private:
+
+    /// Load libglpk and fill in #glpkApi_; call with #mutex_ held
+    bool bindGlpk(std::string &errStr) ;
+
+    /// Load and initialise the heavy shim; call with #mutex_ held
+    bool startHeavy(std::string &errStr) ;
+
+    /*! \brief Registration function handed to the heavy shim
+
+      Keeps the heavy shim's registration for Osi1 in the shim being
+      started (#starting_).
+    */
+    static int32_t registerHeavy(const CharString *apiStr,
+                                 const RegisterParams *params) ;
+
+    /// Make an Osi1 object through the heavy shim
+    void *createOsi1(const ObjectParams *params) ;
+
+    /// Destroy an Osi1 object made by the heavy shim
+    int32_t destroyOsi1(void *victim, const ObjectParams *params) ;
+
+    /// Copy constructor (not implemented)
+    GlpkShim(const GlpkShim &rhs) ;
+    /// Assignment (not implemented)
+    GlpkShim &operator=(const GlpkShim &rhs) ;
+
+    /// Our registration ID from the plugin manager
+    PluginUniqueID ourID_ ;
+
+    /// Verbosity level for information messages
+    int verbosity_ ;
+
+    /// The plugin manager's log service
+    PluginLog log_ ;
+
+    /// Directory searched for libglpk and the heavy shim
+    std::string pluginDir_ ;
+
+    /// Serialises the loads
+    Mutex mutex_ ;
+
+    /*! \name libglpk */
+    //@{
+    /// The handle for libglpk; null until loaded
+    DynamicLibrary *libGlpk_ ;
+    /// The glpk C interface; bound by #bindGlpk and not changed afterwards
+    GlpkCApi glpkApi_ ;
+    /// Set once libglpk has been bound
+    bool glpkBound_ ;
+    /// Why libglpk couldn't be had; empty if no attempt has failed
+    std::string glpkErr_ ;
+    //@}
+
+    /*! \name The heavy shim */
+    //@{
+    /// The handle for the heavy shim; null until loaded
+    DynamicLibrary *libHeavy_ ;
+    /// Services handed to the heavy shim; see #setServices
+    PlatformServices heavyServices_ ;
+    /// The heavy shim's registration for Osi1
+    RegisterParams heavyReg_ ;
+    /// Set once the heavy shim has registered Osi1
+    bool heavyRegistered_ ;
+    /// The heavy shim's exit function
+    ExitFunc heavyExit_ ;
+    /// Why the heavy shim couldn't be had; empty if no attempt has failed
+    std::string heavyErr_ ;
+    /// The shim whose heavy shim is being started; see #registerHeavy
+    static GlpkShim *starting_ ;
+    //@}
+
+} ;
+
+/*! \brief Plugin initialisation method
+    \relates GlpkShim
+
+  Registers the APIs; loads nothing.
+
+  This method needs to have C linkage so it can be easily loaded with
+  DynamicLibrary::getSymbol.
+*/
+extern "C"
+ExitFunc initPlugin (PlatformServices *services) ;
+
+/*! \brief Plugin cleanup method
+    \relates GlpkShim
+
+  Shuts down the heavy shim, if it was started, and unloads libglpk.
+*/
+extern "C"
+int32_t cleanupPlugin (const PlatformServices *services) ;
+
+}  // end namespace Osi2
+
+#endif
@@ -12,7 +12,7 @@
   direct access to clp objects.
 */
 
-#include <iostream>
+#include <string>
 
 #include "ClpConfig.h"
 #include "Osi2ClpHeavyShim.hpp"
@@ -24,19 +24,23 @@
 #include "Osi2API.hpp"
 #include "Osi2Osi1API.hpp"
 #include "Osi2Osi1API_ClpHeavy.hpp"
+#include "Osi2ClpCancelHandler.hpp"
+#include "Osi2MpsReader.hpp"
+#include "Osi2ModelSnapshot.hpp"
+#include "Osi2ProbMgmtAPI_ClpHeavy.hpp"
+#include "Osi2Trace.hpp"
 
 namespace Osi2 {
 
 /*
   Constructor. There's nothing to do here; all the work happens in the
-  constructors for the parent classes. The declarations here are just for
+  constructors for the parent classes. The messages are just for
   convenient debugging.
 */
-Osi1API_ClpHeavy::Osi1API_ClpHeavy ()
+Osi1API_ClpHeavy::Osi1API_ClpHeavy (const PluginLog &log)
+    : log_(log)
 {
-  /*
-  std::cout << "Osi1API_ClpHeavy object constructor." << std::endl ;
-  */
+  OSI2_PLUGIN_LOG(log_, 5) << "Osi1API_ClpHeavy object constructor." ;
 }
 
 /*
@@ -44,11 +48,68 @@ Osi1API_ClpHeavy::Osi1API_ClpHeavy ()
 */
 Osi1API_ClpHeavy::Osi1API_ClpHeavy (const Osi1API_ClpHeavy &rhs)
     : Osi1API(rhs),
-      OsiClpSolverInterface(rhs)
+      OsiClpSolverInterface(rhs),
+      cancel_(rhs.cancel_),
+      log_(rhs.log_)
 {
-  /*
-  std::cout << "Osi1API_ClpHeavy object copy constructor." << std::endl ;
-  */
+  OSI2_PLUGIN_LOG(log_, 5) << "Osi1API_ClpHeavy object copy constructor." ;
+}
+
+/*
+  The row copies are rebuilt if the clone asks for them. Names are held in
+  the clp model as well as in OsiSolverInterface; both go.
+*/
+Osi1API_ClpHeavy *Osi1API_ClpHeavy::cloneLean (bool keepNames) const
+{
+  Osi1API_ClpHeavy *copy = new Osi1API_ClpHeavy(*this) ;
+  copy->freeCachedResults() ;
+  copy->getModelPtr()->setNewRowCopy(nullptr) ;
+  if (!keepNames) {
+    copy->OsiClpSolverInterface::deleteRowNames(0,copy->getNumRows()) ;
+    copy->OsiClpSolverInterface::deleteColNames(0,copy->getNumCols()) ;
+    copy->getModelPtr()->dropNames() ;
+    copy->OsiClpSolverInterface::setIntParam(OsiNameDiscipline,0) ;
+  }
+  return (copy) ;
+}
+
+/*
+  Clp clones the handler, and the clone shares the token.
+*/
+bool Osi1API_ClpHeavy::setCancelToken (const CancelToken &token)
+{
+  cancel_ = token ;
+  ClpCancelHandler handler(token) ;
+  getModelPtr()->passInEventHandler(&handler) ;
+  return (true) ;
+}
+
+/*
+  The hint and special options are put back as they were, whatever the
+  batch did.
+*/
+int Osi1API_ClpHeavy::resolveBatch (BatchKind kind, int numVariants,
+				    const double *variants,
+				    BatchResult &results, bool withDuals)
+{
+  TraceSpan span("solver", "resolveBatch") ;
+  const unsigned int oldOptions = specialOptions() ;
+  bool oldDual = true ;
+  OsiHintStrength oldStrength = OsiHintIgnore ;
+  OsiClpSolverInterface::getHintParam(OsiDoDualInResolve,oldDual,oldStrength) ;
+  setSpecialOptions(oldOptions|1) ;
+  if (kind == BatchObjective)
+    OsiClpSolverInterface::setHintParam(OsiDoDualInResolve,false,OsiHintDo) ;
+  const int retval = resolveBatchOf(this,kind,numVariants,variants,results,
+				    withDuals) ;
+  OsiClpSolverInterface::setHintParam(OsiDoDualInResolve,oldDual,oldStrength) ;
+  setSpecialOptions(oldOptions) ;
+  return (retval) ;
+}
+
+CancelToken::Reason Osi1API_ClpHeavy::stopReason () const
+{
+  return (ClpCancelHandler::stopReason(getModelPtr(), cancel_)) ;
 }
 
 /*
@@ -56,11 +117,94 @@ Osi1API_ClpHeavy::Osi1API_ClpHeavy (const Osi1API_ClpHeavy &rhs)
 */
 Osi1API_ClpHeavy::~Osi1API_ClpHeavy ()
 {
-  /*
-  std::cout << "Osi1API_ClpHeavy object destructor." << std::endl ;
-  */
+  OSI2_PLUGIN_LOG(log_, 5) << "Osi1API_ClpHeavy object destructor." ;
+}
+
+/*
+  As in CoinMpsIO, the extension is added only if the file name doesn't
+  already have one. Names are kept, as OsiClpSolverInterface::readMps
+  keeps them.
+*/
+int Osi1API_ClpHeavy::readMps (const char *fname, const char *ext)
+{
+    TraceSpan span("solver", "readMps", fname) ;
+    std::string path(fname) ;
+    if (ext != nullptr && *ext != '\0') {
+        const std::string::size_type slash = path.find_last_of("/\\") ;
+        const std::string::size_type dot = path.find_last_of('.') ;
+        if (dot == std::string::npos ||
+                (slash != std::string::npos && dot < slash))
+            path = path + "." + ext ;
+    }
+    MpsReader reader ;
+    reader.setKeepNames(true) ;
+    if (reader.readFile(path) != 0) {
+        if (!reader.canRetry()) return (1) ;
+        return (OsiClpSolverInterface::readMps(fname,ext)) ;
+    }
+    const int numCols = reader.getNumCols() ;
+    OsiClpSolverInterface::loadProblem(numCols, reader.getNumRows(),
+                                       reader.getStarts(), reader.getIndices(),
+                                       reader.getValues(), reader.getColLower(),
+                                       reader.getColUpper(),
+                                       reader.getObjective(),
+                                       reader.getRowLower(),
+                                       reader.getRowUpper()) ;
+    const char *integer = reader.getIntegerInfo() ;
+    if (integer != nullptr) {
+        for (int j = 0 ; j < numCols ; j++)
+            if (integer[j]) setInteger(j) ;
+    }
+    OsiClpSolverInterface::setDblParam(OsiObjOffset, reader.getObjOffset()) ;
+    OsiClpSolverInterface::setStrParam(OsiProbName, reader.getProblemName()) ;
+    OsiClpSolverInterface::getModelPtr()->copyNames(reader.getRowNames(),
+                                                    reader.getColNames()) ;
+    return (0) ;
 }
 
+int Osi1API_ClpHeavy::writeSnapshot (const char *fname) const
+{
+    return (ProbMgmtAPI_ClpHeavy::writeClpSnapshot(
+                OsiClpSolverInterface::getModelPtr(), fname, log_)) ;
+}
+
+/*
+  The problem goes in through OsiClpSolverInterface, so that its cached
+  copies of the problem are dropped. The basis goes into the model and is
+  then picked up as the warm start, which is where OsiClp starts from.
+*/
+int Osi1API_ClpHeavy::readSnapshot (const char *fname)
+{
+    ModelSnapshot snap ;
+    if (snap.read(fname) != 0) {
+        OSI2_PLUGIN_LOG(log_, 1) << snap.getError() ;
+        return (-1) ;
+    }
+    const ModelSnapshot::Problem &prob = snap.getProblem() ;
+    OsiClpSolverInterface::loadProblem(prob.numCols_, prob.numRows_,
+                                       prob.start_, prob.index_, prob.value_,
+                                       prob.colLower_, prob.colUpper_,
+                                       prob.obj_, prob.rowLower_,
+                                       prob.rowUpper_) ;
+    if (prob.integer_ != nullptr) {
+        for (int j = 0 ; j < prob.numCols_ ; j++)
+            if (prob.integer_[j]) setInteger(j) ;
+    }
+    OsiClpSolverInterface::setObjSense(prob.objSense_) ;
+    OsiClpSolverInterface::setDblParam(OsiObjOffset, prob.objOffset_) ;
+    if (prob.problemName_ != nullptr)
+        OsiClpSolverInterface::setStrParam(OsiProbName, prob.problemName_) ;
+    ClpSimplex *clp = OsiClpSolverInterface::getModelPtr() ;
+    if (prob.rowNames_ != nullptr && prob.colNames_ != nullptr)
+        clp->copyNames(prob.rowNames_, prob.colNames_) ;
+    if (prob.status_ != nullptr) {
+        clp->copyinStatus(prob.status_) ;
+        CoinWarmStart *basis = OsiClpSolverInterface::getWarmStart() ;
+        OsiClpSolverInterface::setWarmStart(basis) ;
+        delete basis ;
+    }
+    return (0) ;
+}
 
 }    // end Osi2 namespace
 
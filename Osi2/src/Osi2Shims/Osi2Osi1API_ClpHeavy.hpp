@@ -14,6 +14,8 @@
 
 #include "Osi2API.hpp"
 #include "Osi2Osi1API.hpp"
+#include "Osi2PluginLog.hpp"
+#include "Osi2Trace.hpp"
 
 #include "OsiClpSolverInterface.hpp"
 
@@ -29,14 +31,23 @@ namespace Osi2 {
   the implementation (with a few exceptions) consists of defining the virtual
   methods of Osi2::Osi1API as calls to the appropriate OsiClpSolverInterface
   methods.
+
+  Calls through an Osi1API pointer pass through the Osi1API virtual
+  function and then the forwarder. A client that links with this shim and
+  calls an accessor in a tight loop can convert once, with
+  <tt>api_cast<Osi1API_ClpHeavy></tt> or the typed
+  ControlAPI::createObject, and call through the result; the class is
+  #OSI2_FINAL, so the compiler can bind those calls directly.
 */
-class Osi1API_ClpHeavy : public Osi1API, public OsiClpSolverInterface {
+class Osi1API_ClpHeavy OSI2_FINAL
+    : public Osi1API, public OsiClpSolverInterface {
 
 public:
 
   /// \name Constructors and destructors
   //@{
-  Osi1API_ClpHeavy () ;
+  /// Constructor; messages go to \p log
+  explicit Osi1API_ClpHeavy (const PluginLog &log = PluginLog()) ;
 
   Osi1API_ClpHeavy (const Osi1API_ClpHeavy &rhs) ;
 
@@ -45,6 +56,15 @@ public:
   inline Osi1API_ClpHeavy *clone(bool copyData = true) const
   { return (new Osi1API_ClpHeavy(*this)) ; }
 
+  /*! \brief Clone for a worker that only solves
+
+    Clp keeps its own copy of the matrix, bounds and objective in each
+    model, and writes to them as it solves, so they can't be shared between
+    clones. The clone leaves out the cached row-major copies of the matrix
+    and, unless \p keepNames is true, the names.
+  */
+  Osi1API_ClpHeavy *cloneLean(bool keepNames = false) const ;
+
   inline void reset()
   { OsiClpSolverInterface::reset() ; }
   //@}
@@ -52,9 +72,35 @@ public:
 
   /// \name Solve methods
   //@{
-  inline void resolve() { OsiClpSolverInterface::resolve() ; }
+  inline void resolve()
+  {
+    TraceSpan span("solver", "resolve") ;
+    OsiClpSolverInterface::resolve() ;
+  }
+
+  inline void initialSolve()
+  {
+    TraceSpan span("solver", "initialSolve") ;
+    OsiClpSolverInterface::initialSolve() ;
+  }
+
+  /*! \brief Attach \p token to the object
+
+    The token goes to the clp model as its event handler (see
+    ClpCancelHandler), replacing any other, and is looked at on every
+    simplex iteration. Clones share the token.
+  */
+  bool setCancelToken(const CancelToken &token) ;
+
+  /*! \brief Resolve under a batch of right-hand sides or objectives
 
-  inline void initialSolve() { OsiClpSolverInterface::initialSolve() ; }
+    As Osi1API::resolveBatch, with OsiClpSolverInterface told to keep its
+    work areas and factorization between resolves (special option 1), and
+    objectives re-solved by the primal simplex, since a change of costs
+    leaves the basis primal feasible.
+  */
+  int resolveBatch(BatchKind kind, int numVariants, const double *variants,
+		   BatchResult &results, bool withDuals = false) ;
   //@}
 
 
@@ -106,7 +152,8 @@ public:
   /// \name Methods returning info on how the solution process terminated
   //@{
   inline bool isAbandoned() const
-  { return (OsiClpSolverInterface::isAbandoned()) ; }
+  { return (OsiClpSolverInterface::isAbandoned() ||
+	    stopReason() == CancelToken::Cancelled) ; }
 
   inline bool isProvenOptimal() const
   { return (OsiClpSolverInterface::isProvenOptimal()) ; }
@@ -124,7 +171,8 @@ public:
   { return (OsiClpSolverInterface::isDualObjectiveLimitReached()) ; }
 
   inline bool isIterationLimitReached() const
-  { return (OsiClpSolverInterface::isIterationLimitReached()) ; }
+  { return (OsiClpSolverInterface::isIterationLimitReached() ||
+	    stopReason() == CancelToken::DeadlineExpired) ; }
   //@}
 
 
@@ -260,6 +308,14 @@ public:
   inline int getIterationCount() const
   { return (OsiClpSolverInterface::getIterationCount()) ; }
 
+  /// The solution in one call, without passing back through Osi1API
+  inline int getSolutionBundle(SolutionView &view) const
+  { typedef OsiClpSolverInterface S ;
+    return (view.fill(S::getNumCols(),S::getNumRows(),S::getColSolution(),
+    		      S::getReducedCost(),S::getRowPrice(),
+		      S::getRowActivity(),S::getObjValue(),
+		      S::getIterationCount())) ; }
+
   inline std::vector<double*> getDualRays(int maxCnt, bool fullRay) const
   { return (OsiClpSolverInterface::getDualRays(maxCnt,fullRay)) ; }
 
@@ -590,8 +646,13 @@ public:
   { return (OsiClpSolverInterface::loadFromCoinModel(mod,keepSolution)) ; }
 
 
-  inline int readMps(const char *fname, const char *ext = "mps")
-  { return (OsiClpSolverInterface::readMps(fname,ext)) ; }
+  /*! \brief Read an mps file
+
+    Read with MpsReader, falling back to OsiClpSolverInterface::readMps
+    for what MpsReader can't handle (and for a missing file, which
+    CoinMpsIO looks for under other names).
+  */
+  int readMps(const char *fname, const char *ext = "mps") ;
 
   inline int readMps(const char *fname, const char *ext,
   		     int &numSets, CoinSet **&sets)
@@ -612,6 +673,15 @@ public:
   { return (OsiSolverInterface::writeMpsNative(fname,rowNames,colNames,
 			      fmtType,numAcross,objSense,numSOS,setInfo)) ; }
 
+  /// Write the problem to a binary snapshot (see ModelSnapshot)
+  int writeSnapshot(const char *fname) const ;
+
+  /*! \brief Load the problem in a binary snapshot
+
+    A basis in the snapshot becomes the warm start.
+  */
+  int readSnapshot(const char *fname) ;
+
   inline void writeLp(const char *fname, const char *ext = "lp",
   		      double eps = 1e-5, int numAcross = 10, int decimals = 5,
 		      double objSense = 0.0, bool useRowNames = true) const
@@ -806,6 +876,17 @@ public:
   						   outStatus,t,dx)) ; }
   //@}
 
+private:
+
+  /// Why the last solve stopped early, if the token stopped it
+  CancelToken::Reason stopReason() const ;
+
+  /// The token attached by #setCancelToken
+  CancelToken cancel_ ;
+
+  /// The plugin manager's log service
+  PluginLog log_ ;
+
 } ;
 
 }    // end namespace Osi2
@@ -12,7 +12,7 @@
   direct access to glpk objects.
 */
 
-#include <iostream>
+#include <algorithm>
 
 #include "Osi2GlpkHeavyShim.hpp"
 
@@ -27,14 +27,16 @@ namespace Osi2 {
 
 /*
   Constructor. There's nothing to do here; all the work happens in the
-  constructors for the parent classes. The declarations here are just for
+  constructors for the parent classes. The messages are just for
   convenient debugging.
 */
-Osi1API_GlpkHeavy::Osi1API_GlpkHeavy ()
+Osi1API_GlpkHeavy::Osi1API_GlpkHeavy (const PluginLog &log)
+    : sliced_(false),
+      stopped_(CancelToken::None),
+      iterations_(0),
+      log_(log)
 {
-  /*
-  std::cout << "Osi1API_Glpk object constructor." << std::endl ;
-  */
+  OSI2_PLUGIN_LOG(log_, 5) << "Osi1API_GlpkHeavy object constructor." ;
 }
 
 /*
@@ -42,11 +44,14 @@ Osi1API_GlpkHeavy::Osi1API_GlpkHeavy ()
 */
 Osi1API_GlpkHeavy::Osi1API_GlpkHeavy (const Osi1API_GlpkHeavy &rhs)
     : Osi1API(rhs),
-      OsiGlpkSolverInterface(rhs)
+      OsiGlpkSolverInterface(rhs),
+      sliced_(rhs.sliced_),
+      cancel_(rhs.cancel_),
+      stopped_(rhs.stopped_),
+      iterations_(rhs.iterations_),
+      log_(rhs.log_)
 {
-  /*
-  std::cout << "Osi1API_Glpk object copy constructor." << std::endl ;
-  */
+  OSI2_PLUGIN_LOG(log_, 5) << "Osi1API_GlpkHeavy object copy constructor." ;
 }
 
 /*
@@ -54,11 +59,49 @@ Osi1API_GlpkHeavy::Osi1API_GlpkHeavy (const Osi1API_GlpkHeavy &rhs)
 */
 Osi1API_GlpkHeavy::~Osi1API_GlpkHeavy ()
 {
-  /*
-  std::cout << "Osi1API_Glpk object destructor." << std::endl ;
-  */
+  OSI2_PLUGIN_LOG(log_, 5) << "Osi1API_GlpkHeavy object destructor." ;
 }
 
+const int Osi1API_GlpkHeavy::sliceIters ;
+
+bool Osi1API_GlpkHeavy::setCancelToken (const CancelToken &token)
+{
+  cancel_ = token ;
+  sliced_ = true ;
+  return (true) ;
+}
+
+/*
+  glpk keeps the basis in the problem when it stops on the iteration
+  limit, so each resolve picks up where the last slice stopped. A token
+  that says to stop before the solve starts leaves the last solution as it
+  was.
+*/
+void Osi1API_GlpkHeavy::solveInSlices (bool initial)
+{
+  iterations_ = 0 ;
+  stopped_ = cancel_.getStopReason() ;
+  if (stopped_ != CancelToken::None) return ;
+  int maxIters = 0 ;
+  OsiGlpkSolverInterface::getIntParam(OsiMaxNumIteration,maxIters) ;
+  bool first = true ;
+  for (;;) {
+    const int slice = std::min(sliceIters,maxIters-iterations_) ;
+    OsiGlpkSolverInterface::setIntParam(OsiMaxNumIteration,slice) ;
+    if (first && initial)
+      OsiGlpkSolverInterface::initialSolve() ;
+    else
+      OsiGlpkSolverInterface::resolve() ;
+    first = false ;
+    iterations_ += OsiGlpkSolverInterface::getIterationCount() ;
+    if (!OsiGlpkSolverInterface::isIterationLimitReached() ||
+	iterations_ >= maxIters)
+      break ;
+    stopped_ = cancel_.getStopReason() ;
+    if (stopped_ != CancelToken::None) break ;
+  }
+  OsiGlpkSolverInterface::setIntParam(OsiMaxNumIteration,maxIters) ;
+}
 
 }    // end Osi2 namespace
 
@@ -14,6 +14,8 @@
 
 #include "Osi2API.hpp"
 #include "Osi2Osi1API.hpp"
+#include "Osi2PluginLog.hpp"
+#include "Osi2Trace.hpp"
 
 #include "OsiGlpkSolverInterface.hpp"
 
@@ -30,13 +32,15 @@ namespace Osi2 {
   methods of Osi2::Osi1API as calls to the appropriate OsiGlpkSolverInterface
   methods.
 */
-class Osi1API_GlpkHeavy : public Osi1API, public OsiGlpkSolverInterface {
+class Osi1API_GlpkHeavy OSI2_FINAL
+    : public Osi1API, public OsiGlpkSolverInterface {
 
 public:
 
   /// \name Constructors and destructors
   //@{
-  Osi1API_GlpkHeavy () ;
+  /// Constructor; messages go to \p log
+  explicit Osi1API_GlpkHeavy (const PluginLog &log = PluginLog()) ;
 
   Osi1API_GlpkHeavy (const Osi1API_GlpkHeavy &rhs) ;
 
@@ -52,9 +56,27 @@ public:
 
   /// \name Solve methods
   //@{
-  inline void resolve() { OsiGlpkSolverInterface::resolve() ; }
-
-  inline void initialSolve() { OsiGlpkSolverInterface::initialSolve() ; }
+  inline void resolve()
+  {
+    TraceSpan span("solver", "resolve") ;
+    if (sliced_) solveInSlices(false) ;
+    else OsiGlpkSolverInterface::resolve() ;
+  }
+
+  inline void initialSolve()
+  {
+    TraceSpan span("solver", "initialSolve") ;
+    if (sliced_) solveInSlices(true) ;
+    else OsiGlpkSolverInterface::initialSolve() ;
+  }
+
+  /*! \brief Attach \p token to the object
+
+    glpk's simplex can't be interrupted, so from now on solves run
+    #sliceIters iterations at a time and look at the token in between (see
+    #solveInSlices). Clones share the token.
+  */
+  bool setCancelToken(const CancelToken &token) ;
   //@}
 
 
@@ -106,7 +128,8 @@ public:
   /// \name Methods returning info on how the solution process terminated
   //@{
   inline bool isAbandoned() const
-  { return (OsiGlpkSolverInterface::isAbandoned()) ; }
+  { return (OsiGlpkSolverInterface::isAbandoned() ||
+	    stopped_ == CancelToken::Cancelled) ; }
 
   inline bool isProvenOptimal() const
   { return (OsiGlpkSolverInterface::isProvenOptimal()) ; }
@@ -124,7 +147,8 @@ public:
   { return (OsiGlpkSolverInterface::isDualObjectiveLimitReached()) ; }
 
   inline bool isIterationLimitReached() const
-  { return (OsiGlpkSolverInterface::isIterationLimitReached()) ; }
+  { return (stopped_ != CancelToken::Cancelled &&
+	    OsiGlpkSolverInterface::isIterationLimitReached()) ; }
   //@}
 
 
@@ -258,7 +282,16 @@ public:
   { return (OsiGlpkSolverInterface::getObjValue()) ; }
 
   inline int getIterationCount() const
-  { return (OsiGlpkSolverInterface::getIterationCount()) ; }
+  { return (sliced_ ? iterations_ :
+	    OsiGlpkSolverInterface::getIterationCount()) ; }
+
+  /// The solution in one call, without passing back through Osi1API
+  inline int getSolutionBundle(SolutionView &view) const
+  { typedef OsiGlpkSolverInterface S ;
+    return (view.fill(S::getNumCols(),S::getNumRows(),S::getColSolution(),
+    		      S::getReducedCost(),S::getRowPrice(),
+		      S::getRowActivity(),S::getObjValue(),
+		      getIterationCount())) ; }
 
   inline std::vector<double*> getDualRays(int maxCnt, bool fullRay) const
   { return (OsiGlpkSolverInterface::getDualRays(maxCnt,fullRay)) ; }
@@ -805,6 +838,30 @@ public:
   						   outStatus,t,dx)) ; }
   //@}
 
+private:
+
+  /// Iterations in a slice of a solve with a CancelToken
+  static const int sliceIters = 100 ;
+
+  /*! \brief Solve, looking at the token between slices
+
+    Calls initialSolve (if \p initial) and then resolve, with the
+    iteration limit cut to #sliceIters, until the solve finishes, the
+    client's own limit is reached, or the token says to stop.
+  */
+  void solveInSlices(bool initial) ;
+
+  /// True once #setCancelToken is called
+  bool sliced_ ;
+  /// The token attached by #setCancelToken
+  CancelToken cancel_ ;
+  /// Why the last solve stopped early, if the token stopped it
+  CancelToken::Reason stopped_ ;
+  /// Iterations in the last solve, all slices together
+  int iterations_ ;
+  /// The plugin manager's log service
+  PluginLog log_ ;
+
 } ;
 
 }    // end namespace Osi2
@@ -0,0 +1,1578 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Osi1API_Remote.cpp
+    \brief Method definitions for Osi2Osi1API_Remote
+
+  Method definitions for Osi1API_Remote, an implementation of the Osi1 API
+  that forwards the solves to a remote node and answers the rest, or
+  refuses it, here.
+*/
+
+#include <cmath>
+
+#include "CoinError.hpp"
+#include "CoinFinite.hpp"
+#include "CoinPackedMatrix.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+
+#include "Osi2RemoteWire.hpp"
+#include "Osi2MpsReader.hpp"
+#include "Osi2RemoteShim.hpp"
+#include "Osi2Osi1API_Remote.hpp"
+
+namespace {
+
+/// The exception thrown by a method that isn't forwarded
+CoinError notSupported (const char *method)
+{
+    return (CoinError("Not supported by a remote object", method,
+                      "Osi1API_Remote")) ;
+}
+
+/// The data of a vector, or null if it's empty
+template <class T>
+const T *orNull (const std::vector<T> &vec)
+{
+    return ((vec.empty()) ? nullptr : &vec[0]) ;
+}
+
+/// True if an array of \p got entries from the node fits \p want
+inline bool fits (int64_t got, int want)
+{
+    return (got < 0 || got == want) ;
+}
+
+/// Row bounds for a row given as sense, right-hand side, and range
+void senseToBounds (char sense, double rhs, double range,
+                    double &lower, double &upper)
+{
+    const double inf = COIN_DBL_MAX ;
+    switch (sense) {
+        case 'E': lower = rhs ;       upper = rhs ; break ;
+        case 'L': lower = -inf ;      upper = rhs ; break ;
+        case 'G': lower = rhs ;       upper = inf ; break ;
+        case 'R': lower = rhs-range ; upper = rhs ; break ;
+        default:  lower = -inf ;      upper = inf ; break ;
+    }
+}
+
+/// The reverse of senseToBounds
+void boundsToSense (double lower, double upper,
+                    char &sense, double &rhs, double &range)
+{
+    const double inf = COIN_DBL_MAX ;
+    range = 0.0 ;
+    if (lower > -inf && upper < inf) {
+        rhs = upper ;
+        if (lower == upper) {
+            sense = 'E' ;
+        } else {
+            sense = 'R' ;
+            range = upper-lower ;
+        }
+    } else if (lower > -inf) {
+        sense = 'G' ;
+        rhs = lower ;
+    } else if (upper < inf) {
+        sense = 'L' ;
+        rhs = upper ;
+    } else {
+        sense = 'N' ;
+        rhs = 0.0 ;
+    }
+}
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+/*
+  The object starts with the empty model, which a node can load and solve
+  like any other.
+*/
+Osi1API_Remote::Osi1API_Remote (RemoteShim *shim, const std::string &apiName)
+    : RemoteLink(shim, apiName),
+      numCols_(0),
+      numRows_(0),
+      start_(1, 0),
+      objSense_(1.0),
+      objOffset_(0.0),
+      modelSent_(false),
+      modified_(false),
+      dataDirty_(false),
+      flags_(0),
+      objValue_(0.0),
+      iterations_(0),
+      appData_(nullptr)
+{
+    wirePackProblem(problem_, 0, 0, &start_[0], nullptr, nullptr, nullptr,
+                    nullptr, nullptr, nullptr, nullptr) ;
+}
+
+/*
+  The node's copy stays with the original; the copy sends the model, with
+  its changes, to a node of its own.
+*/
+Osi1API_Remote::Osi1API_Remote (const Osi1API_Remote &rhs)
+    : Osi1API(rhs),
+      RemoteLink(rhs),
+      numCols_(rhs.numCols_),
+      numRows_(rhs.numRows_),
+      start_(rhs.start_),
+      index_(rhs.index_),
+      value_(rhs.value_),
+      colLower_(rhs.colLower_),
+      colUpper_(rhs.colUpper_),
+      obj_(rhs.obj_),
+      rowLower_(rhs.rowLower_),
+      rowUpper_(rhs.rowUpper_),
+      integer_(rhs.integer_),
+      objSense_(rhs.objSense_),
+      objOffset_(rhs.objOffset_),
+      problem_(rhs.problem_),
+      modelSent_(false),
+      modified_(rhs.modified_),
+      dataDirty_(rhs.modified_),
+      flags_(rhs.flags_),
+      objValue_(rhs.objValue_),
+      iterations_(rhs.iterations_),
+      colSolution_(rhs.colSolution_),
+      rowPrice_(rhs.rowPrice_),
+      reducedCost_(rhs.reducedCost_),
+      rowActivity_(rhs.rowActivity_),
+      appData_(rhs.appData_)
+{ }
+
+Osi1API_Remote::~Osi1API_Remote ()
+{ }
+
+Osi1API_Remote *Osi1API_Remote::clone (bool copyData) const
+{
+    if (copyData) return (new Osi1API_Remote(*this)) ;
+    return (new Osi1API_Remote(shim_, apiName_)) ;
+}
+
+Osi1API_Remote *Osi1API_Remote::cloneLean (bool) const
+{
+    return (clone(true)) ;
+}
+
+void Osi1API_Remote::reset ()
+{
+    disconnect(false) ;
+    const int start = 0 ;
+    loadProblem(0, 0, &start, nullptr, nullptr, nullptr, nullptr, nullptr,
+                nullptr, nullptr) ;
+    objSense_ = 1.0 ;
+    objOffset_ = 0.0 ;
+    appData_ = nullptr ;
+}
+
+/*
+  Solve methods
+*/
+
+void Osi1API_Remote::initialSolve ()
+{
+    solve(false) ;
+}
+
+void Osi1API_Remote::resolve ()
+{
+    solve(true) ;
+}
+
+/*
+  If the node goes away, the model is loaded again elsewhere, with the
+  changes since, and the solve repeated. Every node gets one chance. A node
+  that has just loaded the model has no basis to resolve from.
+*/
+void Osi1API_Remote::solve (bool resolve)
+{
+    const char *failure = "no remote node would load the model" ;
+    for (int attempt = 0 ; attempt <= shim_->getNumNodes() ; attempt++) {
+        int64_t status = -1 ;
+        if (!isConnected() || !modelSent_) {
+            modelSent_ = false ;
+            if (sendModel(problem_, "") != 0) break ;
+            modelSent_ = true ;
+            dataDirty_ = modified_ ;
+            resolve = false ;
+        }
+        if (dataDirty_) {
+            WireWriter(request_).putInt(RemoteOsiSetData)
+                .putDoubles(&objSense_, 1)
+                .putDoubles(orNull(colLower_), colLower_.size())
+                .putDoubles(orNull(colUpper_), colUpper_.size())
+                .putDoubles(orNull(obj_), obj_.size())
+                .putDoubles(orNull(rowLower_), rowLower_.size())
+                .putDoubles(orNull(rowUpper_), rowUpper_.size()) ;
+            if (call(status) < 0) continue ;
+            if (status != 0) {
+                failure = "the node refused the bounds and objective" ;
+                break ;
+            }
+            dataDirty_ = false ;
+        }
+        WireWriter(request_).putInt(RemoteOsiSolve).putInt(resolve) ;
+        if (call(status) < 0) continue ;
+        if (status == 0 && takeSolveReply() == 0) return ;
+        failure = "bad reply from the node" ;
+        break ;
+    }
+    OSI2_PLUGIN_LOG(shim_->getLog(), 1) << "Solve failed; " << failure << "." ;
+    clearSolution() ;
+    flags_ = RemoteOsiAbandoned ;
+}
+
+/*
+  The node sized the arrays from its model, which should be ours; check
+  anyway. An array the node didn't have comes back null.
+*/
+int Osi1API_Remote::takeSolveReply ()
+{
+    WireReader in(reply_) ;
+    in.getInt() ;
+    const int64_t flags = in.getInt() ;
+    std::vector<double> objValue ;
+    in.getDoubles(objValue) ;
+    const int64_t iterations = in.getInt() ;
+    std::vector<double> colSolution ;
+    std::vector<double> rowPrice ;
+    std::vector<double> reducedCost ;
+    std::vector<double> rowActivity ;
+    const int64_t numColSolution = in.getDoubles(colSolution) ;
+    const int64_t numRowPrice = in.getDoubles(rowPrice) ;
+    const int64_t numReducedCost = in.getDoubles(reducedCost) ;
+    const int64_t numRowActivity = in.getDoubles(rowActivity) ;
+    if (!in.ok() || objValue.size() != 1 ||
+            !fits(numColSolution, numCols_) || !fits(numRowPrice, numRows_) ||
+            !fits(numReducedCost, numCols_) ||
+            !fits(numRowActivity, numRows_))
+        return (-1) ;
+    flags_ = static_cast<int>(flags) ;
+    objValue_ = objValue[0]-objOffset_ ;
+    iterations_ = static_cast<int>(iterations) ;
+    colSolution_.swap(colSolution) ;
+    rowPrice_.swap(rowPrice) ;
+    reducedCost_.swap(reducedCost) ;
+    rowActivity_.swap(rowActivity) ;
+    return (0) ;
+}
+
+void Osi1API_Remote::clearSolution ()
+{
+    flags_ = 0 ;
+    objValue_ = 0.0 ;
+    iterations_ = 0 ;
+    colSolution_.clear() ;
+    rowPrice_.clear() ;
+    reducedCost_.clear() ;
+    rowActivity_.clear() ;
+}
+
+/*
+  The node loads the model as it was packed; bounds and objective follow
+  separately if they've changed.
+*/
+void Osi1API_Remote::putLoadRequest (uint64_t hash)
+{
+    WireWriter(request_).putInt(RemoteLoadProblem)
+        .putInt(static_cast<int64_t>(hash)) ;
+}
+
+/*
+  Parameter set/get methods
+*/
+
+bool Osi1API_Remote::setIntParam (OsiIntParam, int)
+{
+    return (false) ;
+}
+
+bool Osi1API_Remote::setDblParam (OsiDblParam key, double value)
+{
+    if (key != OsiObjOffset) return (false) ;
+    objOffset_ = value ;
+    return (true) ;
+}
+
+bool Osi1API_Remote::setStrParam (OsiStrParam, const std::string &)
+{
+    return (false) ;
+}
+
+bool Osi1API_Remote::setHintParam (OsiHintParam, bool, OsiHintStrength,
+                                   void *)
+{
+    return (false) ;
+}
+
+bool Osi1API_Remote::getIntParam (OsiIntParam, int &) const
+{
+    return (false) ;
+}
+
+bool Osi1API_Remote::getDblParam (OsiDblParam key, double &value) const
+{
+    if (key != OsiObjOffset) return (false) ;
+    value = objOffset_ ;
+    return (true) ;
+}
+
+bool Osi1API_Remote::getStrParam (OsiStrParam, std::string &) const
+{
+    return (false) ;
+}
+
+bool Osi1API_Remote::getHintParam (OsiHintParam, bool &, OsiHintStrength &,
+                                   void *&) const
+{
+    return (false) ;
+}
+
+bool Osi1API_Remote::getHintParam (OsiHintParam, bool &,
+                                   OsiHintStrength &) const
+{
+    return (false) ;
+}
+
+bool Osi1API_Remote::getHintParam (OsiHintParam, bool &) const
+{
+    return (false) ;
+}
+
+void Osi1API_Remote::copyParameters (Osi1API &)
+{
+    throw notSupported("copyParameters") ;
+}
+
+double Osi1API_Remote::getIntegerTolerance () const
+{
+    throw notSupported("getIntegerTolerance") ;
+}
+
+/*
+  Methods returning info on how the solution process terminated
+*/
+
+bool Osi1API_Remote::isAbandoned () const
+{
+    return ((flags_&RemoteOsiAbandoned) != 0) ;
+}
+
+bool Osi1API_Remote::isProvenOptimal () const
+{
+    return ((flags_&RemoteOsiOptimal) != 0) ;
+}
+
+bool Osi1API_Remote::isProvenPrimalInfeasible () const
+{
+    return ((flags_&RemoteOsiPrimalInfeasible) != 0) ;
+}
+
+bool Osi1API_Remote::isProvenDualInfeasible () const
+{
+    return ((flags_&RemoteOsiDualInfeasible) != 0) ;
+}
+
+bool Osi1API_Remote::isPrimalObjectiveLimitReached () const
+{
+    return ((flags_&RemoteOsiPrimalObjLimit) != 0) ;
+}
+
+bool Osi1API_Remote::isDualObjectiveLimitReached () const
+{
+    return ((flags_&RemoteOsiDualObjLimit) != 0) ;
+}
+
+bool Osi1API_Remote::isIterationLimitReached () const
+{
+    return ((flags_&RemoteOsiIterationLimit) != 0) ;
+}
+
+/*
+  Warm start methods
+*/
+
+CoinWarmStart *Osi1API_Remote::getEmptyWarmStart () const
+{
+    throw notSupported("getEmptyWarmStart") ;
+}
+
+CoinWarmStart *Osi1API_Remote::getWarmStart () const
+{
+    throw notSupported("getWarmStart") ;
+}
+
+CoinWarmStart *Osi1API_Remote::getPointerToWarmStart (bool &)
+{
+    throw notSupported("getPointerToWarmStart") ;
+}
+
+bool Osi1API_Remote::setWarmStart (const CoinWarmStart *)
+{
+    return (false) ;
+}
+
+/*
+  Hot start methods. The caller puts the bounds back between hot starts, so
+  there's nothing to save.
+*/
+
+void Osi1API_Remote::markHotStart ()
+{ }
+
+void Osi1API_Remote::solveFromHotStart ()
+{
+    solve(true) ;
+}
+
+void Osi1API_Remote::unmarkHotStart ()
+{ }
+
+/*
+  Problem query methods
+*/
+
+int Osi1API_Remote::getNumCols () const
+{
+    return (numCols_) ;
+}
+
+int Osi1API_Remote::getNumRows () const
+{
+    return (numRows_) ;
+}
+
+int Osi1API_Remote::getNumElements () const
+{
+    return (start_[numCols_]) ;
+}
+
+int Osi1API_Remote::getNumIntegers () const
+{
+    int numIntegers = 0 ;
+    for (int j = 0 ; j < numCols_ ; j++) {
+        if (integer_[j]) numIntegers++ ;
+    }
+    return (numIntegers) ;
+}
+
+const double *Osi1API_Remote::getColLower () const
+{
+    return (orNull(colLower_)) ;
+}
+
+const double *Osi1API_Remote::getColUpper () const
+{
+    return (orNull(colUpper_)) ;
+}
+
+/*
+  The sense, right-hand side and range views are rebuilt from the bounds on
+  every call, since any setter may have changed them.
+*/
+const char *Osi1API_Remote::getRowSense () const
+{
+    rowSense_.resize(numRows_) ;
+    rhs_.resize(numRows_) ;
+    rowRange_.resize(numRows_) ;
+    for (int i = 0 ; i < numRows_ ; i++)
+        boundsToSense(rowLower_[i], rowUpper_[i], rowSense_[i], rhs_[i],
+                      rowRange_[i]) ;
+    return (orNull(rowSense_)) ;
+}
+
+const double *Osi1API_Remote::getRightHandSide () const
+{
+    getRowSense() ;
+    return (orNull(rhs_)) ;
+}
+
+const double *Osi1API_Remote::getRowRange () const
+{
+    getRowSense() ;
+    return (orNull(rowRange_)) ;
+}
+
+const double *Osi1API_Remote::getRowLower () const
+{
+    return (orNull(rowLower_)) ;
+}
+
+const double *Osi1API_Remote::getRowUpper () const
+{
+    return (orNull(rowUpper_)) ;
+}
+
+const double *Osi1API_Remote::getObjCoefficients () const
+{
+    return (orNull(obj_)) ;
+}
+
+double Osi1API_Remote::getObjSense () const
+{
+    return (objSense_) ;
+}
+
+bool Osi1API_Remote::isContinuous (int colIndex) const
+{
+    return (!integer_[colIndex]) ;
+}
+
+/*
+  As OsiSolverInterface: an integer column is binary if both bounds are 0
+  or 1.
+*/
+bool Osi1API_Remote::isBinary (int colIndex) const
+{
+    const double lower = colLower_[colIndex] ;
+    const double upper = colUpper_[colIndex] ;
+    return (integer_[colIndex] && (lower == 0.0 || lower == 1.0) &&
+            (upper == 0.0 || upper == 1.0)) ;
+}
+
+bool Osi1API_Remote::isInteger (int colIndex) const
+{
+    return (integer_[colIndex] != 0) ;
+}
+
+bool Osi1API_Remote::isIntegerNonBinary (int colIndex) const
+{
+    return (isInteger(colIndex) && !isBinary(colIndex)) ;
+}
+
+bool Osi1API_Remote::isFreeBinary (int colIndex) const
+{
+    return (integer_[colIndex] && colLower_[colIndex] == 0.0 &&
+            colUpper_[colIndex] == 1.0) ;
+}
+
+const char *Osi1API_Remote::getColType (bool) const
+{
+    colType_.resize(numCols_) ;
+    for (int j = 0 ; j < numCols_ ; j++) {
+        if (isContinuous(j))
+            colType_[j] = 0 ;
+        else
+            colType_[j] = isBinary(j) ? 1 : 2 ;
+    }
+    return (orNull(colType_)) ;
+}
+
+const CoinPackedMatrix *Osi1API_Remote::getMatrixByRow () const
+{
+    throw notSupported("getMatrixByRow") ;
+}
+
+const CoinPackedMatrix *Osi1API_Remote::getMatrixByCol () const
+{
+    throw notSupported("getMatrixByCol") ;
+}
+
+CoinPackedMatrix *Osi1API_Remote::getMutableMatrixByRow () const
+{
+    throw notSupported("getMutableMatrixByRow") ;
+}
+
+CoinPackedMatrix *Osi1API_Remote::getMutableMatrixByCol () const
+{
+    throw notSupported("getMutableMatrixByCol") ;
+}
+
+/*
+  MpsReader fills infinite bounds with COIN_DBL_MAX, so that's our infinity.
+*/
+double Osi1API_Remote::getInfinity () const
+{
+    return (COIN_DBL_MAX) ;
+}
+
+/*
+  Solution query methods
+*/
+
+const double *Osi1API_Remote::getColSolution () const
+{
+    return (orNull(colSolution_)) ;
+}
+
+const double *Osi1API_Remote::getStrictColSolution ()
+{
+    if (colSolution_.empty()) return (nullptr) ;
+    strictColSolution_ = colSolution_ ;
+    for (int j = 0 ; j < numCols_ ; j++) {
+        double &value = strictColSolution_[j] ;
+        if (value < colLower_[j])
+            value = colLower_[j] ;
+        else if (value > colUpper_[j])
+            value = colUpper_[j] ;
+    }
+    return (&strictColSolution_[0]) ;
+}
+
+const double *Osi1API_Remote::getRowPrice () const
+{
+    return (orNull(rowPrice_)) ;
+}
+
+const double *Osi1API_Remote::getReducedCost () const
+{
+    return (orNull(reducedCost_)) ;
+}
+
+const double *Osi1API_Remote::getRowActivity () const
+{
+    return (orNull(rowActivity_)) ;
+}
+
+double Osi1API_Remote::getObjValue () const
+{
+    return (objValue_) ;
+}
+
+int Osi1API_Remote::getIterationCount () const
+{
+    return (iterations_) ;
+}
+
+std::vector<double *> Osi1API_Remote::getDualRays (int, bool) const
+{
+    throw notSupported("getDualRays") ;
+}
+
+std::vector<double *> Osi1API_Remote::getPrimalRays (int) const
+{
+    throw notSupported("getPrimalRays") ;
+}
+
+OsiVectorInt Osi1API_Remote::getFractionalIndices (const double etol) const
+{
+    OsiVectorInt fractional ;
+    if (colSolution_.empty()) return (fractional) ;
+    for (int j = 0 ; j < numCols_ ; j++) {
+        if (!integer_[j]) continue ;
+        const double value = colSolution_[j] ;
+        if (std::fabs(value-std::floor(value+0.5)) > etol)
+            fractional.push_back(j) ;
+    }
+    return (fractional) ;
+}
+
+/*
+  Methods to modify the objective, bounds, and solution
+*/
+
+void Osi1API_Remote::setObjCoeff (int elementIndex, double elementValue)
+{
+    obj_[elementIndex] = elementValue ;
+    touch() ;
+}
+
+void Osi1API_Remote::setObjCoeffSet (const int *indexFirst,
+                                     const int *indexLast,
+                                     const double *coeffList)
+{
+    for (const int *index = indexFirst ; index != indexLast ; index++)
+        obj_[*index] = *coeffList++ ;
+    touch() ;
+}
+
+void Osi1API_Remote::setObjective (const double *array)
+{
+    obj_.assign(array, array+numCols_) ;
+    touch() ;
+}
+
+void Osi1API_Remote::setObjSense (double s)
+{
+    objSense_ = s ;
+    touch() ;
+}
+
+void Osi1API_Remote::setColLower (int elementIndex, double elementValue)
+{
+    colLower_[elementIndex] = elementValue ;
+    touch() ;
+}
+
+void Osi1API_Remote::setColLower (const double *array)
+{
+    colLower_.assign(array, array+numCols_) ;
+    touch() ;
+}
+
+void Osi1API_Remote::setColUpper (int elementIndex, double elementValue)
+{
+    colUpper_[elementIndex] = elementValue ;
+    touch() ;
+}
+
+void Osi1API_Remote::setColUpper (const double *array)
+{
+    colUpper_.assign(array, array+numCols_) ;
+    touch() ;
+}
+
+void Osi1API_Remote::setColBounds (int elementIndex, double lower,
+                                   double upper)
+{
+    colLower_[elementIndex] = lower ;
+    colUpper_[elementIndex] = upper ;
+    touch() ;
+}
+
+void Osi1API_Remote::setColSetBounds (const int *indexFirst,
+                                      const int *indexLast,
+                                      const double *boundList)
+{
+    for (const int *index = indexFirst ; index != indexLast ; index++) {
+        colLower_[*index] = *boundList++ ;
+        colUpper_[*index] = *boundList++ ;
+    }
+    touch() ;
+}
+
+void Osi1API_Remote::setRowLower (int elementIndex, double elementValue)
+{
+    rowLower_[elementIndex] = elementValue ;
+    touch() ;
+}
+
+void Osi1API_Remote::setRowUpper (int elementIndex, double elementValue)
+{
+    rowUpper_[elementIndex] = elementValue ;
+    touch() ;
+}
+
+void Osi1API_Remote::setRowBounds (int elementIndex, double lower,
+                                   double upper)
+{
+    rowLower_[elementIndex] = lower ;
+    rowUpper_[elementIndex] = upper ;
+    touch() ;
+}
+
+void Osi1API_Remote::setRowSetBounds (const int *indexFirst,
+                                      const int *indexLast,
+                                      const double *boundList)
+{
+    for (const int *index = indexFirst ; index != indexLast ; index++) {
+        rowLower_[*index] = *boundList++ ;
+        rowUpper_[*index] = *boundList++ ;
+    }
+    touch() ;
+}
+
+void Osi1API_Remote::setRowType (int index, char sense, double rightHandSide,
+                                 double range)
+{
+    senseToBounds(sense, rightHandSide, range, rowLower_[index],
+                  rowUpper_[index]) ;
+    touch() ;
+}
+
+void Osi1API_Remote::setRowSetTypes (const int *indexFirst,
+                                     const int *indexLast,
+                                     const char *senseList,
+                                     const double *rhsList,
+                                     const double *rangeList)
+{
+    for (const int *index = indexFirst ; index != indexLast ; index++) {
+        const double range = (rangeList != nullptr) ? *rangeList++ : 0.0 ;
+        senseToBounds(*senseList++, *rhsList++, range, rowLower_[*index],
+                      rowUpper_[*index]) ;
+    }
+    touch() ;
+}
+
+void Osi1API_Remote::setColSolution (const double *)
+{
+    throw notSupported("setColSolution") ;
+}
+
+void Osi1API_Remote::setRowPrice (const double *)
+{
+    throw notSupported("setRowPrice") ;
+}
+
+int Osi1API_Remote::reducedCostFix (double, bool)
+{
+    throw notSupported("reducedCostFix") ;
+}
+
+/*
+  Methods to set variable type. Integrality stays here; the node solves the
+  relaxation.
+*/
+
+void Osi1API_Remote::setContinuous (int index)
+{
+    integer_[index] = 0 ;
+}
+
+void Osi1API_Remote::setInteger (int index)
+{
+    integer_[index] = 1 ;
+}
+
+void Osi1API_Remote::setContinuous (const int *indices, int len)
+{
+    for (int k = 0 ; k < len ; k++) integer_[indices[k]] = 0 ;
+}
+
+void Osi1API_Remote::setInteger (const int *indices, int len)
+{
+    for (int k = 0 ; k < len ; k++) integer_[indices[k]] = 1 ;
+}
+
+/*
+  Methods for row and column names
+*/
+
+std::string Osi1API_Remote::dfltRowColName (char, int, unsigned) const
+{
+    throw notSupported("dfltRowColName") ;
+}
+
+std::string Osi1API_Remote::getObjName (unsigned) const
+{
+    throw notSupported("getObjName") ;
+}
+
+void Osi1API_Remote::setObjName (std::string)
+{
+    throw notSupported("setObjName") ;
+}
+
+std::string Osi1API_Remote::getRowName (int, unsigned) const
+{
+    throw notSupported("getRowName") ;
+}
+
+const OsiNameVec &Osi1API_Remote::getRowNames ()
+{
+    throw notSupported("getRowNames") ;
+}
+
+void Osi1API_Remote::setRowName (int, std::string)
+{
+    throw notSupported("setRowName") ;
+}
+
+void Osi1API_Remote::setRowNames (OsiNameVec &, int, int, int)
+{
+    throw notSupported("setRowNames") ;
+}
+
+void Osi1API_Remote::deleteRowNames (int, int)
+{
+    throw notSupported("deleteRowNames") ;
+}
+
+std::string Osi1API_Remote::getColName (int, unsigned) const
+{
+    throw notSupported("getColName") ;
+}
+
+const OsiNameVec &Osi1API_Remote::getColNames ()
+{
+    throw notSupported("getColNames") ;
+}
+
+void Osi1API_Remote::setColName (int, std::string)
+{
+    throw notSupported("setColName") ;
+}
+
+void Osi1API_Remote::setColNames (OsiNameVec &, int, int, int)
+{
+    throw notSupported("setColNames") ;
+}
+
+void Osi1API_Remote::deleteColNames (int, int)
+{
+    throw notSupported("deleteColNames") ;
+}
+
+void Osi1API_Remote::setRowColNames (const CoinMpsIO &)
+{
+    throw notSupported("setRowColNames") ;
+}
+
+void Osi1API_Remote::setRowColNames (CoinModel &)
+{
+    throw notSupported("setRowColNames") ;
+}
+
+void Osi1API_Remote::setRowColNames (CoinLpIO &)
+{
+    throw notSupported("setRowColNames") ;
+}
+
+/*
+  Methods to modify the constraint system
+*/
+
+void Osi1API_Remote::addCol (const CoinPackedVectorBase &, const double,
+                             const double, const double)
+{
+    throw notSupported("addCol") ;
+}
+
+void Osi1API_Remote::addCol (const CoinPackedVectorBase &, const double,
+                             const double, const double, std::string)
+{
+    throw notSupported("addCol") ;
+}
+
+void Osi1API_Remote::addCol (int, const int *, const double *, const double,
+                             const double, const double)
+{
+    throw notSupported("addCol") ;
+}
+
+void Osi1API_Remote::addCol (int, const int *, const double *, const double,
+                             const double, const double, std::string)
+{
+    throw notSupported("addCol") ;
+}
+
+void Osi1API_Remote::addCols (const int, const CoinPackedVectorBase *const *,
+                              const double *, const double *, const double *)
+{
+    throw notSupported("addCols") ;
+}
+
+void Osi1API_Remote::addCols (const int, const int *, const int *,
+                              const double *, const double *, const double *,
+                              const double *)
+{
+    throw notSupported("addCols") ;
+}
+
+void Osi1API_Remote::addCols (const CoinBuild &)
+{
+    throw notSupported("addCols") ;
+}
+
+int Osi1API_Remote::addCols (CoinModel &)
+{
+    throw notSupported("addCols") ;
+}
+
+void Osi1API_Remote::deleteCols (const int, const int *)
+{
+    throw notSupported("deleteCols") ;
+}
+
+void Osi1API_Remote::addRow (const CoinPackedVectorBase &, const double,
+                             const double)
+{
+    throw notSupported("addRow") ;
+}
+
+void Osi1API_Remote::addRow (const CoinPackedVectorBase &, const double,
+                             const double, std::string)
+{
+    throw notSupported("addRow") ;
+}
+
+void Osi1API_Remote::addRow (const CoinPackedVectorBase &, const char,
+                             const double, const double)
+{
+    throw notSupported("addRow") ;
+}
+
+void Osi1API_Remote::addRow (const CoinPackedVectorBase &, const char,
+                             const double, const double, std::string)
+{
+    throw notSupported("addRow") ;
+}
+
+void Osi1API_Remote::addRow (int, const int *, const double *, const double,
+                             const double)
+{
+    throw notSupported("addRow") ;
+}
+
+void Osi1API_Remote::addRows (const int, const CoinPackedVectorBase *const *,
+                              const double *, const double *)
+{
+    throw notSupported("addRows") ;
+}
+
+void Osi1API_Remote::addRows (const int, const CoinPackedVectorBase *const *,
+                              const char *, const double *, const double *)
+{
+    throw notSupported("addRows") ;
+}
+
+void Osi1API_Remote::addRows (const int, const int *, const int *,
+                              const double *, const double *, const double *)
+{
+    throw notSupported("addRows") ;
+}
+
+void Osi1API_Remote::addRows (const CoinBuild &)
+{
+    throw notSupported("addRows") ;
+}
+
+int Osi1API_Remote::addRows (CoinModel &)
+{
+    throw notSupported("addRows") ;
+}
+
+void Osi1API_Remote::deleteRows (const int, const int *)
+{
+    throw notSupported("deleteRows") ;
+}
+
+void Osi1API_Remote::replaceMatrixOptional (const CoinPackedMatrix &)
+{
+    throw notSupported("replaceMatrixOptional") ;
+}
+
+void Osi1API_Remote::replaceMatrix (const CoinPackedMatrix &)
+{
+    throw notSupported("replaceMatrix") ;
+}
+
+void Osi1API_Remote::saveBaseModel ()
+{
+    throw notSupported("saveBaseModel") ;
+}
+
+void Osi1API_Remote::restoreBaseModel (int)
+{
+    throw notSupported("restoreBaseModel") ;
+}
+
+void Osi1API_Remote::applyRowCuts (int, const OsiRowCut *)
+{
+    throw notSupported("applyRowCuts") ;
+}
+
+void Osi1API_Remote::applyRowCuts (int, const OsiRowCut **)
+{
+    throw notSupported("applyRowCuts") ;
+}
+
+void Osi1API_Remote::deleteBranchingInfo (int, const int *)
+{
+    throw notSupported("deleteBranchingInfo") ;
+}
+
+/*
+  Methods for problem input and output
+*/
+
+/*
+  The matrix may have gaps between its columns, so copy it out column by
+  column.
+*/
+void Osi1API_Remote::loadProblem (const CoinPackedMatrix &matrix,
+                                  const double *collb, const double *colub,
+                                  const double *obj, const double *rowlb,
+                                  const double *rowub)
+{
+    CoinPackedMatrix byCol ;
+    const CoinPackedMatrix *cols = &matrix ;
+    if (!matrix.isColOrdered()) {
+        byCol.reverseOrderedCopyOf(matrix) ;
+        cols = &byCol ;
+    }
+    const int numCols = cols->getNumCols() ;
+    const CoinBigIndex *starts = cols->getVectorStarts() ;
+    const int *lengths = cols->getVectorLengths() ;
+    const int *indices = cols->getIndices() ;
+    const double *elements = cols->getElements() ;
+    std::vector<int> start(1, 0) ;
+    std::vector<int> index ;
+    std::vector<double> value ;
+    for (int j = 0 ; j < numCols ; j++) {
+        const CoinBigIndex first = starts[j] ;
+        index.insert(index.end(), indices+first, indices+first+lengths[j]) ;
+        value.insert(value.end(), elements+first,
+                     elements+first+lengths[j]) ;
+        start.push_back(static_cast<int>(index.size())) ;
+    }
+    loadProblem(numCols, cols->getNumRows(), &start[0], orNull(index),
+                orNull(value), collb, colub, obj, rowlb, rowub) ;
+}
+
+void Osi1API_Remote::assignProblem (CoinPackedMatrix *&matrix,
+                                    double *&collb, double *&colub,
+                                    double *&obj, double *&rowlb,
+                                    double *&rowub)
+{
+    loadProblem(*matrix, collb, colub, obj, rowlb, rowub) ;
+    delete matrix ;
+    matrix = nullptr ;
+    delete [] collb ;
+    collb = nullptr ;
+    delete [] colub ;
+    colub = nullptr ;
+    delete [] obj ;
+    obj = nullptr ;
+    delete [] rowlb ;
+    rowlb = nullptr ;
+    delete [] rowub ;
+    rowub = nullptr ;
+}
+
+void Osi1API_Remote::loadProblem (const CoinPackedMatrix &matrix,
+                                  const double *collb, const double *colub,
+                                  const double *obj, const char *rowsen,
+                                  const double *rowrhs, const double *rowrng)
+{
+    const int numRows = matrix.getNumRows() ;
+    std::vector<double> rowLower(numRows) ;
+    std::vector<double> rowUpper(numRows) ;
+    for (int i = 0 ; i < numRows ; i++) {
+        senseToBounds((rowsen != nullptr) ? rowsen[i] : 'G',
+                      (rowrhs != nullptr) ? rowrhs[i] : 0.0,
+                      (rowrng != nullptr) ? rowrng[i] : 0.0,
+                      rowLower[i], rowUpper[i]) ;
+    }
+    loadProblem(matrix, collb, colub, obj, orNull(rowLower),
+                orNull(rowUpper)) ;
+}
+
+void Osi1API_Remote::assignProblem (CoinPackedMatrix *&matrix,
+                                    double *&collb, double *&colub,
+                                    double *&obj, char *&rowsen,
+                                    double *&rowrhs, double *&rowrng)
+{
+    loadProblem(*matrix, collb, colub, obj, rowsen, rowrhs, rowrng) ;
+    delete matrix ;
+    matrix = nullptr ;
+    delete [] collb ;
+    collb = nullptr ;
+    delete [] colub ;
+    colub = nullptr ;
+    delete [] obj ;
+    obj = nullptr ;
+    delete [] rowsen ;
+    rowsen = nullptr ;
+    delete [] rowrhs ;
+    rowrhs = nullptr ;
+    delete [] rowrng ;
+    rowrng = nullptr ;
+}
+
+/*
+  Missing arrays take the OsiSolverInterface defaults: columns in
+  [0, infinity), rows free, a zero objective. The copy here is complete, so
+  the node shares those defaults whatever its solver's are.
+*/
+void Osi1API_Remote::loadProblem (const int numcols, const int numrows,
+                                  const CoinBigIndex *start, const int *index,
+                                  const double *value, const double *collb,
+                                  const double *colub, const double *obj,
+                                  const double *rowlb, const double *rowub)
+{
+    if (numcols < 0 || numrows < 0 || start == nullptr)
+        throw CoinError("Bad problem size or column starts", "loadProblem",
+                        "Osi1API_Remote") ;
+    const double inf = COIN_DBL_MAX ;
+    const int numElements = start[numcols] ;
+    numCols_ = numcols ;
+    numRows_ = numrows ;
+    start_.assign(start, start+numcols+1) ;
+    if (numElements > 0) {
+        index_.assign(index, index+numElements) ;
+        value_.assign(value, value+numElements) ;
+    } else {
+        index_.clear() ;
+        value_.clear() ;
+    }
+    if (collb != nullptr)
+        colLower_.assign(collb, collb+numcols) ;
+    else
+        colLower_.assign(numcols, 0.0) ;
+    if (colub != nullptr)
+        colUpper_.assign(colub, colub+numcols) ;
+    else
+        colUpper_.assign(numcols, inf) ;
+    if (obj != nullptr)
+        obj_.assign(obj, obj+numcols) ;
+    else
+        obj_.assign(numcols, 0.0) ;
+    if (rowlb != nullptr)
+        rowLower_.assign(rowlb, rowlb+numrows) ;
+    else
+        rowLower_.assign(numrows, -inf) ;
+    if (rowub != nullptr)
+        rowUpper_.assign(rowub, rowub+numrows) ;
+    else
+        rowUpper_.assign(numrows, inf) ;
+    integer_.assign(numcols, 0) ;
+    wirePackProblem(problem_, numCols_, numRows_, &start_[0], orNull(index_),
+                    orNull(value_), orNull(colLower_), orNull(colUpper_),
+                    orNull(obj_), orNull(rowLower_), orNull(rowUpper_)) ;
+    modelSent_ = false ;
+    modified_ = false ;
+    dataDirty_ = false ;
+    clearSolution() ;
+}
+
+void Osi1API_Remote::loadProblem (const int numcols, const int numrows,
+                                  const CoinBigIndex *start, const int *index,
+                                  const double *value, const double *collb,
+                                  const double *colub, const double *obj,
+                                  const char *rowsen, const double *rowrhs,
+                                  const double *rowrng)
+{
+    std::vector<double> rowLower(numrows) ;
+    std::vector<double> rowUpper(numrows) ;
+    for (int i = 0 ; i < numrows ; i++) {
+        senseToBounds((rowsen != nullptr) ? rowsen[i] : 'G',
+                      (rowrhs != nullptr) ? rowrhs[i] : 0.0,
+                      (rowrng != nullptr) ? rowrng[i] : 0.0,
+                      rowLower[i], rowUpper[i]) ;
+    }
+    loadProblem(numcols, numrows, start, index, value, collb, colub, obj,
+                orNull(rowLower), orNull(rowUpper)) ;
+}
+
+int Osi1API_Remote::loadFromCoinModel (CoinModel &, bool)
+{
+    throw notSupported("loadFromCoinModel") ;
+}
+
+/*
+  As CoinMpsIO, the extension is added only to a name that has none.
+*/
+int Osi1API_Remote::readMps (const char *filename, const char *extension)
+{
+    std::string path = filename ;
+    const size_t slash = path.rfind('/') ;
+    const size_t dot = path.rfind('.') ;
+    if (extension != nullptr && *extension != '\0' &&
+            (dot == std::string::npos ||
+             (slash != std::string::npos && dot < slash)))
+        path = path+"."+extension ;
+    MpsReader reader ;
+    const int retval = reader.readFile(path) ;
+    if (retval != 0) {
+        OSI2_PLUGIN_LOG(shim_->getLog(), 1)
+            << "Failure to read " << path << ": " << reader.getError()
+            << "." ;
+        return (retval) ;
+    }
+    const int numCols = reader.getNumCols() ;
+    loadProblem(numCols, reader.getNumRows(), reader.getStarts(),
+                reader.getIndices(), reader.getValues(),
+                reader.getColLower(), reader.getColUpper(),
+                reader.getObjective(), reader.getRowLower(),
+                reader.getRowUpper()) ;
+    const char *integerInfo = reader.getIntegerInfo() ;
+    if (integerInfo != nullptr)
+        integer_.assign(integerInfo, integerInfo+numCols) ;
+    objOffset_ = reader.getObjOffset() ;
+    return (0) ;
+}
+
+int Osi1API_Remote::readMps (const char *, const char *, int &, CoinSet **&)
+{
+    throw notSupported("readMps") ;
+}
+
+int Osi1API_Remote::readGMPL (const char *, const char *)
+{
+    throw notSupported("readGMPL") ;
+}
+
+void Osi1API_Remote::writeMps (const char *, const char *, double) const
+{
+    throw notSupported("writeMps") ;
+}
+
+int Osi1API_Remote::writeMpsNative (const char *, const char **,
+                                    const char **, int, int, double, int,
+                                    const CoinSet *) const
+{
+    throw notSupported("writeMpsNative") ;
+}
+
+void Osi1API_Remote::writeLp (const char *, const char *, double, int, int,
+                              double, bool) const
+{
+    throw notSupported("writeLp") ;
+}
+
+void Osi1API_Remote::writeLp (FILE *, double, int, int, double, bool) const
+{
+    throw notSupported("writeLp") ;
+}
+
+int Osi1API_Remote::writeLpNative (const char *, char const *const *const,
+                                   char const *const *const, const double,
+                                   const int, const int, const double,
+                                   const bool) const
+{
+    throw notSupported("writeLpNative") ;
+}
+
+int Osi1API_Remote::writeLpNative (FILE *, char const *const *const,
+                                   char const *const *const, const double,
+                                   const int, const int, const double,
+                                   const bool) const
+{
+    throw notSupported("writeLpNative") ;
+}
+
+int Osi1API_Remote::readLp (const char *, const double)
+{
+    throw notSupported("readLp") ;
+}
+
+int Osi1API_Remote::readLp (FILE *, const double)
+{
+    throw notSupported("readLp") ;
+}
+
+/*
+  Setting/Accessing application data
+*/
+
+void Osi1API_Remote::setApplicationData (void *appData)
+{
+    appData_ = appData ;
+}
+
+void Osi1API_Remote::setAuxiliaryInfo (OsiAuxInfo *)
+{
+    throw notSupported("setAuxiliaryInfo") ;
+}
+
+void *Osi1API_Remote::getApplicationData () const
+{
+    return (appData_) ;
+}
+
+OsiAuxInfo *Osi1API_Remote::getAuxiliaryInfo () const
+{
+    throw notSupported("getAuxiliaryInfo") ;
+}
+
+/*
+  Message handling
+*/
+
+void Osi1API_Remote::passInMessageHandler (CoinMessageHandler *)
+{
+    throw notSupported("passInMessageHandler") ;
+}
+
+void Osi1API_Remote::setLanguage (CoinMessages::Language)
+{
+    throw notSupported("setLanguage") ;
+}
+
+CoinMessageHandler *Osi1API_Remote::messageHandler () const
+{
+    throw notSupported("messageHandler") ;
+}
+
+CoinMessages Osi1API_Remote::messages ()
+{
+    throw notSupported("messages") ;
+}
+
+CoinMessages *Osi1API_Remote::messagesPointer ()
+{
+    throw notSupported("messagesPointer") ;
+}
+
+bool Osi1API_Remote::defaultHandler () const
+{
+    throw notSupported("defaultHandler") ;
+}
+
+/*
+  Methods for dealing with discontinuities other than integers
+*/
+
+void Osi1API_Remote::findIntegers (bool)
+{
+    throw notSupported("findIntegers") ;
+}
+
+int Osi1API_Remote::findIntegersAndSOS (bool)
+{
+    throw notSupported("findIntegersAndSOS") ;
+}
+
+int Osi1API_Remote::numberObjects () const
+{
+    throw notSupported("numberObjects") ;
+}
+
+void Osi1API_Remote::setNumberObjects (int)
+{
+    throw notSupported("setNumberObjects") ;
+}
+
+OsiObject **Osi1API_Remote::objects () const
+{
+    throw notSupported("objects") ;
+}
+
+OsiObject *Osi1API_Remote::object (int) const
+{
+    throw notSupported("object") ;
+}
+
+OsiObject *Osi1API_Remote::modifiableObject (int) const
+{
+    throw notSupported("modifiableObject") ;
+}
+
+void Osi1API_Remote::deleteObjects ()
+{
+    throw notSupported("deleteObjects") ;
+}
+
+void Osi1API_Remote::addObjects (int, OsiObject **)
+{
+    throw notSupported("addObjects") ;
+}
+
+double Osi1API_Remote::forceFeasible ()
+{
+    throw notSupported("forceFeasible") ;
+}
+
+/*
+  Methods related to testing generated cuts
+*/
+
+void Osi1API_Remote::activateRowCutDebugger (const char *)
+{
+    throw notSupported("activateRowCutDebugger") ;
+}
+
+void Osi1API_Remote::activateRowCutDebugger (const double *, bool)
+{
+    throw notSupported("activateRowCutDebugger") ;
+}
+
+const OsiRowCutDebugger *Osi1API_Remote::getRowCutDebugger () const
+{
+    throw notSupported("getRowCutDebugger") ;
+}
+
+OsiRowCutDebugger *Osi1API_Remote::getRowCutDebuggerAlways () const
+{
+    throw notSupported("getRowCutDebuggerAlways") ;
+}
+
+/*
+  OSI Simplex Interface
+*/
+
+int Osi1API_Remote::canDoSimplexInterface () const
+{
+    return (0) ;
+}
+
+void Osi1API_Remote::enableFactorization () const
+{
+    throw notSupported("enableFactorization") ;
+}
+
+void Osi1API_Remote::disableFactorization () const
+{
+    throw notSupported("disableFactorization") ;
+}
+
+bool Osi1API_Remote::basisIsAvailable () const
+{
+    return (false) ;
+}
+
+void Osi1API_Remote::getBasisStatus (int *, int *) const
+{
+    throw notSupported("getBasisStatus") ;
+}
+
+int Osi1API_Remote::setBasisStatus (const int *, const int *)
+{
+    throw notSupported("setBasisStatus") ;
+}
+
+void Osi1API_Remote::getReducedGradient (double *, double *,
+                                         const double *) const
+{
+    throw notSupported("getReducedGradient") ;
+}
+
+void Osi1API_Remote::getBInvARow (int, double *, double *) const
+{
+    throw notSupported("getBInvARow") ;
+}
+
+void Osi1API_Remote::getBInvRow (int, double *) const
+{
+    throw notSupported("getBInvRow") ;
+}
+
+void Osi1API_Remote::getBInvACol (int, double *) const
+{
+    throw notSupported("getBInvACol") ;
+}
+
+void Osi1API_Remote::getBInvCol (int, double *) const
+{
+    throw notSupported("getBInvCol") ;
+}
+
+void Osi1API_Remote::getBasics (int *) const
+{
+    throw notSupported("getBasics") ;
+}
+
+void Osi1API_Remote::enableSimplexInterface (bool)
+{
+    throw notSupported("enableSimplexInterface") ;
+}
+
+void Osi1API_Remote::disableSimplexInterface ()
+{
+    throw notSupported("disableSimplexInterface") ;
+}
+
+int Osi1API_Remote::pivot (int, int, int)
+{
+    throw notSupported("pivot") ;
+}
+
+int Osi1API_Remote::primalPivotResult (int, int, int &, int &, double &,
+                                       CoinPackedVector *)
+{
+    throw notSupported("primalPivotResult") ;
+}
+
+int Osi1API_Remote::dualPivotResult (int &, int &, int, int, double &,
+                                     CoinPackedVector *)
+{
+    throw notSupported("dualPivotResult") ;
+}
+
+Osi1API::ApplyCutsReturnCode
+Osi1API_Remote::applyCutsPrivate (const OsiCuts &, double)
+{
+    throw notSupported("applyCutsPrivate") ;
+}
+
+}  // end namespace Osi2
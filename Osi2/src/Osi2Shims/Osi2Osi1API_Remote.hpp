@@ -0,0 +1,549 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2Osi1API_Remote.hpp
+    \brief Declarations for the remote implementation of Osi2::Osi1API
+*/
+#ifndef Osi2Osi1API_Remote_HPP
+#define Osi2Osi1API_Remote_HPP
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Osi2API.hpp"
+#include "Osi2Osi1API.hpp"
+#include "Osi2RemoteLink.hpp"
+
+namespace Osi2 {
+
+/*! \brief Osi1API on a remote node
+
+  Only a core of Osi1API is forwarded: loading a model (from arrays, a
+  CoinPackedMatrix, or an mps file), changing its bounds and objective,
+  initialSolve and resolve, the termination status and the solution.
+  Everything else throws CoinError, except for the methods whose return
+  value can already say no (parameters, setWarmStart, the simplex
+  interface).
+
+  The model is kept here as well as on the node. Queries of the model are
+  answered from that copy, and the solution comes back whole with each
+  solve and is answered from here too. mps files are read here and sent as
+  arrays. A change of bounds or objective is sent in one piece before the
+  next solve. Integrality is kept here for the queries; the node solves the
+  LP relaxation.
+
+  If the node stops answering, the object moves: the model goes to another
+  node with the current bounds and objective, and the solve is repeated
+  there from scratch. The node's basis is lost, so the first resolve after
+  a move is an initialSolve.
+*/
+class Osi1API_Remote : public Osi1API, private RemoteLink {
+
+public:
+
+    /// \name Constructors and destructors
+    //@{
+    /// Constructor; \p apiName is the API requested of the node
+    Osi1API_Remote(RemoteShim *shim, const std::string &apiName) ;
+
+    /// Copy constructor; the copy opens its own object when it solves
+    Osi1API_Remote(const Osi1API_Remote &rhs) ;
+
+    /// Destructor; destroys the object on the node
+    virtual ~Osi1API_Remote() ;
+
+    Osi1API_Remote *clone(bool copyData = true) const ;
+
+    /// There are no names to drop, so this is #clone
+    Osi1API_Remote *cloneLean(bool keepNames = false) const ;
+
+    /// Drop the model and the node's object
+    void reset() ;
+    //@}
+
+    /*! \name Solve methods
+
+      A solve that can't be done (no node will take the model) is reported
+      as abandoned.
+    */
+    //@{
+    void initialSolve() ;
+
+    void resolve() ;
+    //@}
+
+    /*! \name Parameter set/get methods
+
+      Only OsiObjOffset is supported, and it's kept here; the rest return
+      false.
+    */
+    //@{
+    bool setIntParam(OsiIntParam key, int value) ;
+    bool setDblParam(OsiDblParam key, double value) ;
+    bool setStrParam(OsiStrParam key, const std::string &value) ;
+    bool setHintParam(OsiHintParam key, bool yesNo = true,
+                      OsiHintStrength strength = OsiHintTry,
+                      void *otherInformation = nullptr) ;
+    bool getIntParam(OsiIntParam key, int &value) const ;
+    bool getDblParam(OsiDblParam key, double &value) const ;
+    bool getStrParam(OsiStrParam key, std::string &value) const ;
+    bool getHintParam(OsiHintParam key, bool &yesNo,
+                      OsiHintStrength &strength,
+                      void *&otherInformation) const ;
+    bool getHintParam(OsiHintParam key, bool &yesNo,
+                      OsiHintStrength &strength) const ;
+    bool getHintParam(OsiHintParam key, bool &yesNo) const ;
+    /// Not supported
+    void copyParameters(Osi1API &rhs) ;
+    /// Not supported
+    double getIntegerTolerance() const ;
+    //@}
+
+    /// \name Methods returning info on how the solution process terminated
+    //@{
+    bool isAbandoned() const ;
+    bool isProvenOptimal() const ;
+    bool isProvenPrimalInfeasible() const ;
+    bool isProvenDualInfeasible() const ;
+    bool isPrimalObjectiveLimitReached() const ;
+    bool isDualObjectiveLimitReached() const ;
+    bool isIterationLimitReached() const ;
+    //@}
+
+    /*! \name Warm start methods
+
+      Not supported; setWarmStart returns false. The node keeps its basis
+      from one solve to the next.
+    */
+    //@{
+    CoinWarmStart *getEmptyWarmStart() const ;
+    CoinWarmStart *getWarmStart() const ;
+    CoinWarmStart *getPointerToWarmStart(bool &mustDelete) ;
+    bool setWarmStart(const CoinWarmStart *warmstart) ;
+    //@}
+
+    /*! \name Hot start methods
+
+      A hot start is a resolve from the node's basis.
+    */
+    //@{
+    void markHotStart() ;
+    void solveFromHotStart() ;
+    void unmarkHotStart() ;
+    //@}
+
+    /*! \name Problem query methods
+
+      Answered from the copy of the model held here. The matrix queries are
+      not supported.
+    */
+    //@{
+    int getNumCols() const ;
+    int getNumRows() const ;
+    int getNumElements() const ;
+    int getNumIntegers() const ;
+    const double *getColLower() const ;
+    const double *getColUpper() const ;
+    const char *getRowSense() const ;
+    const double *getRightHandSide() const ;
+    const double *getRowRange() const ;
+    const double *getRowLower() const ;
+    const double *getRowUpper() const ;
+    const double *getObjCoefficients() const ;
+    double getObjSense() const ;
+    bool isContinuous(int colIndex) const ;
+    bool isBinary(int colIndex) const ;
+    bool isInteger(int colIndex) const ;
+    bool isIntegerNonBinary(int colIndex) const ;
+    bool isFreeBinary(int colIndex) const ;
+    const char *getColType(bool refresh = false) const ;
+    const CoinPackedMatrix *getMatrixByRow() const ;
+    const CoinPackedMatrix *getMatrixByCol() const ;
+    CoinPackedMatrix *getMutableMatrixByRow() const ;
+    CoinPackedMatrix *getMutableMatrixByCol() const ;
+    double getInfinity() const ;
+    //@}
+
+    /*! \name Solution query methods
+
+      The solution of the last solve, null before the first. Rays are not
+      supported.
+    */
+    //@{
+    const double *getColSolution() const ;
+    const double *getStrictColSolution() ;
+    const double *getRowPrice() const ;
+    const double *getReducedCost() const ;
+    const double *getRowActivity() const ;
+    double getObjValue() const ;
+    int getIterationCount() const ;
+    std::vector<double *> getDualRays(int maxNumRays,
+                                      bool fullRay = false) const ;
+    std::vector<double *> getPrimalRays(int maxNumRays) const ;
+    OsiVectorInt getFractionalIndices(const double etol = 1.e-05) const ;
+    //@}
+
+    /*! \name Methods to modify the objective, bounds, and solution
+
+      The changes are sent to the node before the next solve. Setting the
+      solution or the duals, and reduced cost fixing, are not supported.
+    */
+    //@{
+    void setObjCoeff(int elementIndex, double elementValue) ;
+    void setObjCoeffSet(const int *indexFirst, const int *indexLast,
+                        const double *coeffList) ;
+    void setObjective(const double *array) ;
+    void setObjSense(double s) ;
+    void setColLower(int elementIndex, double elementValue) ;
+    void setColLower(const double *array) ;
+    void setColUpper(int elementIndex, double elementValue) ;
+    void setColUpper(const double *array) ;
+    void setColBounds(int elementIndex, double lower, double upper) ;
+    void setColSetBounds(const int *indexFirst, const int *indexLast,
+                         const double *boundList) ;
+    void setRowLower(int elementIndex, double elementValue) ;
+    void setRowUpper(int elementIndex, double elementValue) ;
+    void setRowBounds(int elementIndex, double lower, double upper) ;
+    void setRowSetBounds(const int *indexFirst, const int *indexLast,
+                         const double *boundList) ;
+    void setRowType(int index, char sense, double rightHandSide,
+                    double range) ;
+    void setRowSetTypes(const int *indexFirst, const int *indexLast,
+                        const char *senseList, const double *rhsList,
+                        const double *rangeList) ;
+    void setColSolution(const double *colsol) ;
+    void setRowPrice(const double *rowprice) ;
+    int reducedCostFix(double gap, bool justInteger = true) ;
+    //@}
+
+    /// \name Methods to set variable type
+    //@{
+    void setContinuous(int index) ;
+    void setInteger(int index) ;
+    void setContinuous(const int *indices, int len) ;
+    void setInteger(const int *indices, int len) ;
+    //@}
+
+    /// \name Methods for row and column names (not supported)
+    //@{
+    std::string dfltRowColName(char rc, int ndx, unsigned digits = 7) const ;
+    std::string getObjName(unsigned maxLen =
+                               static_cast<unsigned>(std::string::npos)) const ;
+    void setObjName(std::string name) ;
+    std::string getRowName(int rowIndex, unsigned maxLen =
+                               static_cast<unsigned>(std::string::npos)) const ;
+    const OsiNameVec &getRowNames() ;
+    void setRowName(int ndx, std::string name) ;
+    void setRowNames(OsiNameVec &srcNames, int srcStart, int len,
+                     int tgtStart) ;
+    void deleteRowNames(int tgtStart, int len) ;
+    std::string getColName(int colIndex, unsigned maxLen =
+                               static_cast<unsigned>(std::string::npos)) const ;
+    const OsiNameVec &getColNames() ;
+    void setColName(int ndx, std::string name) ;
+    void setColNames(OsiNameVec &srcNames, int srcStart, int len,
+                     int tgtStart) ;
+    void deleteColNames(int tgtStart, int len) ;
+    void setRowColNames(const CoinMpsIO &mps) ;
+    void setRowColNames(CoinModel &mod) ;
+    void setRowColNames(CoinLpIO &mod) ;
+    //@}
+
+    /// \name Methods to modify the constraint system (not supported)
+    //@{
+    void addCol(const CoinPackedVectorBase &vec, const double collb,
+                const double colub, const double obj) ;
+    void addCol(const CoinPackedVectorBase &vec, const double collb,
+                const double colub, const double obj, std::string name) ;
+    void addCol(int numberElements, const int *rows, const double *elements,
+                const double collb, const double colub, const double obj) ;
+    void addCol(int numberElements, const int *rows, const double *elements,
+                const double collb, const double colub, const double obj,
+                std::string name) ;
+    void addCols(const int numcols, const CoinPackedVectorBase *const *cols,
+                 const double *collb, const double *colub,
+                 const double *obj) ;
+    void addCols(const int numcols, const int *columnStarts, const int *rows,
+                 const double *elements, const double *collb,
+                 const double *colub, const double *obj) ;
+    void addCols(const CoinBuild &buildObject) ;
+    int addCols(CoinModel &modelObject) ;
+    void deleteCols(const int num, const int *colIndices) ;
+    void addRow(const CoinPackedVectorBase &vec, const double rowlb,
+                const double rowub) ;
+    void addRow(const CoinPackedVectorBase &vec, const double rowlb,
+                const double rowub, std::string name) ;
+    void addRow(const CoinPackedVectorBase &vec, const char rowsen,
+                const double rowrhs, const double rowrng) ;
+    void addRow(const CoinPackedVectorBase &vec, const char rowsen,
+                const double rowrhs, const double rowrng, std::string name) ;
+    void addRow(int numberElements, const int *columns,
+                const double *element, const double rowlb,
+                const double rowub) ;
+    void addRows(const int numrows, const CoinPackedVectorBase *const *rows,
+                 const double *rowlb, const double *rowub) ;
+    void addRows(const int numrows, const CoinPackedVectorBase *const *rows,
+                 const char *rowsen, const double *rowrhs,
+                 const double *rowrng) ;
+    void addRows(const int numrows, const int *rowStarts, const int *columns,
+                 const double *element, const double *rowlb,
+                 const double *rowub) ;
+    void addRows(const CoinBuild &buildObject) ;
+    int addRows(CoinModel &modelObject) ;
+    void deleteRows(const int num, const int *rowIndices) ;
+    void replaceMatrixOptional(const CoinPackedMatrix &matrix) ;
+    void replaceMatrix(const CoinPackedMatrix &matrix) ;
+    void saveBaseModel() ;
+    void restoreBaseModel(int numberRows) ;
+    void applyRowCuts(int numberCuts, const OsiRowCut *cuts) ;
+    void applyRowCuts(int numberCuts, const OsiRowCut **cuts) ;
+    void deleteBranchingInfo(int numberDeleted, const int *which) ;
+    //@}
+
+    /*! \name Methods for problem input and output
+
+      The loads and readMps are supported; mps files are read with
+      MpsReader. The rest are not.
+    */
+    //@{
+    void loadProblem(const CoinPackedMatrix &matrix, const double *collb,
+                     const double *colub, const double *obj,
+                     const double *rowlb, const double *rowub) ;
+    void assignProblem(CoinPackedMatrix *&matrix, double *&collb,
+                       double *&colub, double *&obj, double *&rowlb,
+                       double *&rowub) ;
+    void loadProblem(const CoinPackedMatrix &matrix, const double *collb,
+                     const double *colub, const double *obj,
+                     const char *rowsen, const double *rowrhs,
+                     const double *rowrng) ;
+    void assignProblem(CoinPackedMatrix *&matrix, double *&collb,
+                       double *&colub, double *&obj, char *&rowsen,
+                       double *&rowrhs, double *&rowrng) ;
+    void loadProblem(const int numcols, const int numrows,
+                     const CoinBigIndex *start, const int *index,
+                     const double *value, const double *collb,
+                     const double *colub, const double *obj,
+                     const double *rowlb, const double *rowub) ;
+    void loadProblem(const int numcols, const int numrows,
+                     const CoinBigIndex *start, const int *index,
+                     const double *value, const double *collb,
+                     const double *colub, const double *obj,
+                     const char *rowsen, const double *rowrhs,
+                     const double *rowrng) ;
+    int loadFromCoinModel(CoinModel &modelObject,
+                          bool keepSolution = false) ;
+    /*! \brief Read an mps file
+
+      \p extension is added if \p filename has none. Returns 0 on success,
+      as MpsReader::readFile otherwise.
+    */
+    int readMps(const char *filename, const char *extension = "mps") ;
+    int readMps(const char *filename, const char *extension,
+                int &numberSets, CoinSet **&sets) ;
+    int readGMPL(const char *filename, const char *dataname = nullptr) ;
+    void writeMps(const char *filename, const char *extension = "mps",
+                  double objSense = 0.0) const ;
+    int writeMpsNative(const char *filename, const char **rowNames,
+                       const char **columnNames, int formatType = 0,
+                       int numberAcross = 2, double objSense = 0.0,
+                       int numberSOS = 0,
+                       const CoinSet *setInfo = nullptr) const ;
+    void writeLp(const char *filename, const char *extension = "lp",
+                 double epsilon = 1e-5, int numberAcross = 10,
+                 int decimals = 5, double objSense = 0.0,
+                 bool useRowNames = true) const ;
+    void writeLp(FILE *fp, double epsilon = 1e-5, int numberAcross = 10,
+                 int decimals = 5, double objSense = 0.0,
+                 bool useRowNames = true) const ;
+    int writeLpNative(const char *filename,
+                      char const *const *const rowNames,
+                      char const *const *const columnNames,
+                      const double epsilon = 1.0e-5,
+                      const int numberAcross = 10, const int decimals = 5,
+                      const double objSense = 0.0,
+                      const bool useRowNames = true) const ;
+    int writeLpNative(FILE *fp, char const *const *const rowNames,
+                      char const *const *const columnNames,
+                      const double epsilon = 1.0e-5,
+                      const int numberAcross = 10, const int decimals = 5,
+                      const double objSense = 0.0,
+                      const bool useRowNames = true) const ;
+    int readLp(const char *filename, const double epsilon = 1e-5) ;
+    int readLp(FILE *fp, const double epsilon = 1e-5) ;
+    //@}
+
+    /*! \name Setting/Accessing application data
+
+      Application data is kept here; auxiliary information is not
+      supported.
+    */
+    //@{
+    void setApplicationData(void *appData) ;
+    void setAuxiliaryInfo(OsiAuxInfo *auxiliaryInfo) ;
+    void *getApplicationData() const ;
+    OsiAuxInfo *getAuxiliaryInfo() const ;
+    //@}
+
+    /// \name Message handling (not supported)
+    //@{
+    void passInMessageHandler(CoinMessageHandler *handler) ;
+    void setLanguage(CoinMessages::Language language) ;
+    CoinMessageHandler *messageHandler() const ;
+    CoinMessages messages() ;
+    CoinMessages *messagesPointer() ;
+    bool defaultHandler() const ;
+    //@}
+
+    /*! \name Methods for dealing with discontinuities other than integers
+              (not supported)
+    */
+    //@{
+    void findIntegers(bool justCount) ;
+    int findIntegersAndSOS(bool justCount) ;
+    int numberObjects() const ;
+    void setNumberObjects(int number) ;
+    OsiObject **objects() const ;
+    OsiObject *object(int which) const ;
+    OsiObject *modifiableObject(int which) const ;
+    void deleteObjects() ;
+    void addObjects(int numberObjects, OsiObject **objects) ;
+    double forceFeasible() ;
+    //@}
+
+    /// \name Methods related to testing generated cuts (not supported)
+    //@{
+    void activateRowCutDebugger(const char *modelName) ;
+    void activateRowCutDebugger(const double *solution,
+                                bool enforceOptimality = true) ;
+    const OsiRowCutDebugger *getRowCutDebugger() const ;
+    OsiRowCutDebugger *getRowCutDebuggerAlways() const ;
+    //@}
+
+    /*! \name OSI Simplex Interface
+
+      Not supported; canDoSimplexInterface returns 0 and basisIsAvailable
+      false.
+    */
+    //@{
+    int canDoSimplexInterface() const ;
+    void enableFactorization() const ;
+    void disableFactorization() const ;
+    bool basisIsAvailable() const ;
+    void getBasisStatus(int *cstat, int *rstat) const ;
+    int setBasisStatus(const int *cstat, const int *rstat) ;
+    void getReducedGradient(double *columnReducedCosts, double *duals,
+                            const double *c) const ;
+    void getBInvARow(int row, double *z, double *slack = nullptr) const ;
+    void getBInvRow(int row, double *z) const ;
+    void getBInvACol(int col, double *vec) const ;
+    void getBInvCol(int col, double *vec) const ;
+    void getBasics(int *index) const ;
+    void enableSimplexInterface(bool doingPrimal) ;
+    void disableSimplexInterface() ;
+    int pivot(int colIn, int colOut, int outStatus) ;
+    int primalPivotResult(int colIn, int sign, int &colOut, int &outStatus,
+                          double &t, CoinPackedVector *dx) ;
+    int dualPivotResult(int &colIn, int &sign, int colOut, int outStatus,
+                        double &t, CoinPackedVector *dx) ;
+    //@}
+
+protected:
+
+    /// Not supported
+    ApplyCutsReturnCode applyCutsPrivate(const OsiCuts &cs,
+                                         double effectivenessLb = 0.0) ;
+
+private:
+
+    /// Assignment (not implemented)
+    Osi1API_Remote &operator=(const Osi1API_Remote &rhs) ;
+
+    /// Build in #request_ the request that loads model \p hash
+    void putLoadRequest(uint64_t hash) ;
+
+    /// Solve on the node; \p resolve chooses resolve over initialSolve
+    void solve(bool resolve) ;
+
+    /// Copy the results of a solve out of #reply_
+    int takeSolveReply() ;
+
+    /// Forget the solution of the last solve
+    void clearSolution() ;
+
+    /// Note a change of bounds or objective, to be sent before a solve
+    inline void touch () {
+        modified_ = true ;
+        dataDirty_ = true ;
+    }
+
+    /*! \name The model
+
+      Columns are held column-major, as loaded. #problem_ is the model as
+      last loaded, packed for the node; later changes of bounds and
+      objective are sent separately.
+    */
+    //@{
+    int numCols_ ;
+    int numRows_ ;
+    std::vector<int> start_ ;
+    std::vector<int> index_ ;
+    std::vector<double> value_ ;
+    std::vector<double> colLower_ ;
+    std::vector<double> colUpper_ ;
+    std::vector<double> obj_ ;
+    std::vector<double> rowLower_ ;
+    std::vector<double> rowUpper_ ;
+    std::vector<char> integer_ ;
+    double objSense_ ;
+    double objOffset_ ;
+    std::vector<char> problem_ ;
+    //@}
+
+    /*! \name State of the node's copy
+
+      #modelSent_ is false until #problem_ is loaded on the node; #modified_
+      says bounds or objective have changed since the load, #dataDirty_ that
+      the node hasn't seen the change.
+    */
+    //@{
+    bool modelSent_ ;
+    bool modified_ ;
+    bool dataDirty_ ;
+    //@}
+
+    /*! \name The solution of the last solve
+
+      #flags_ is made of RemoteOsiFlag.
+    */
+    //@{
+    int flags_ ;
+    double objValue_ ;
+    int iterations_ ;
+    std::vector<double> colSolution_ ;
+    std::vector<double> rowPrice_ ;
+    std::vector<double> reducedCost_ ;
+    std::vector<double> rowActivity_ ;
+    std::vector<double> strictColSolution_ ;
+    //@}
+
+    /// Row and column views built on demand from the bounds
+    //@{
+    mutable std::vector<char> rowSense_ ;
+    mutable std::vector<double> rhs_ ;
+    mutable std::vector<double> rowRange_ ;
+    mutable std::vector<char> colType_ ;
+    //@}
+
+    /// Application data
+    void *appData_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
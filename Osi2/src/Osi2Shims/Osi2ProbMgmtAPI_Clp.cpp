@@ -8,11 +8,13 @@
     \brief Method definitions for Osi2ProbMgmtAPI_Clp
 
   Method definitions for ProbMgmtAPI_Clp, an implementation of the
-  problem management API using the `light' clp shim that dynamically loads
-  methods on demand.
+  problem management API using the `light' clp shim, which calls clp through
+  a table of entry points bound when the shim is initialised.
 */
 
-#include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #include "ClpConfig.h"
 #include "Clp_C_Interface.h"
@@ -24,110 +26,432 @@
 #include "Osi2API.hpp"
 #include "Osi2ProbMgmtAPI.hpp"
 #include "Osi2ProbMgmtAPI_Clp.hpp"
-
-namespace {
-
-template <typename FuncType>
-FuncType loadFunc (Osi2::DynamicLibrary *lib, std::string funcName)
-{
-  std::string errStr ;
-  /*
-  FuncType func =
-      reinterpret_cast<FuncType>(lib->getSymbol(funcName,errStr)) ;
-
-  The code above is what should really happen. But ISO C++ forbids the
-  conversion of a pointer-to-object to a pointer-to-function and there's no
-  obvious way to suppress the warning with a compiler flag. On the other
-  hand, we are allowed to cast pointer-to-anything to size_t and get it back.
-  So we slip through a blind spot in the compiler's algorithm for generating
-  warnings.
-  */
-  size_t grossHack = 
-      reinterpret_cast<size_t>(lib->getSymbol(funcName,errStr)) ;
-  FuncType func = reinterpret_cast<FuncType>(grossHack) ;
-  if (func == nullptr) {
-    std::cout << "Apparent failure to find " << funcName << "." << std::endl ;
-    std::cout << errStr << std::endl ;
-  }
-  return (func) ;
-}
-
-}   // end unnamed file-local namespace
+#include "Osi2Trace.hpp"
 
 namespace Osi2 {
 
 /*
-  Capture a pointer to the underlying ClpSimplex object.
+  Capture a pointer to the underlying ClpSimplex object. The owner of the
+  memory charged is the object as the create function hands it out.
 */
-ProbMgmtAPI_Clp::ProbMgmtAPI_Clp (DynamicLibrary *libClp,
-                                  Clp_Simplex *clpSimplex)
-    : libClp_(libClp),
+ProbMgmtAPI_Clp::ProbMgmtAPI_Clp (const ClpCApi *clpApi,
+                                  Clp_Simplex *clpSimplex,
+                                  const PluginLog &log, const PluginMem &mem,
+                                  const PluginThreads &threads)
+    : clpApi_(clpApi),
       clpSimplex_(clpSimplex),
-      readMps_(nullptr),
-      initialSolve_(nullptr)
+      log_(log),
+      mem_(mem),
+      threads_(threads),
+      timeLimited_(false)
 {
+    model_.init(mem, static_cast<const API *>(this)) ;
 }
 
 ProbMgmtAPI_Clp::~ProbMgmtAPI_Clp ()
 {
-  typedef void (*ClpDeleteModelFunc)(Clp_Simplex *clp) ;
-  ClpDeleteModelFunc deleteModel =
-     loadFunc<ClpDeleteModelFunc>(libClp_,"Clp_deleteModel") ;
-  if (deleteModel != nullptr) {
-    deleteModel(clpSimplex_) ;
-    clpSimplex_ = nullptr ;
-    std::cout << "Osi1API_Clp object destroyed." << std::endl ;
-  }
+  clpApi_->deleteModel_(clpSimplex_) ;
+  clpSimplex_ = nullptr ;
+  OSI2_PLUGIN_LOG(log_, 5) << "ProbMgmtAPI_Clp object destroyed." ;
 }
 
 /*
-  Read a problem file in mps format.
+  Read a problem file in mps format. MpsReader needs Clp_loadProblem, and
+  Clp_copyNames if names are to be kept; failing those, or if MpsReader
+  can't cope and the file can be read again, clp reads it.
 */
 int ProbMgmtAPI_Clp::readMps (const char *filename, bool keepNames,
                               bool ignoreErrors)
 {
-    if (readMps_ == nullptr) {
-      ClpReadMpsFunc readMps =
-	loadFunc<ClpReadMpsFunc>(libClp_,"Clp_readMps") ;
-      readMps_ = readMps ;
-    }
-    int retval = -1 ;
-    if (readMps_ != nullptr) {
-	retval = readMps_(clpSimplex_, filename, keepNames, ignoreErrors) ;
-	if (retval) {
-	    std::cout
-		<< "Failure to read " << filename << ", error " << retval
-		<< "." << std::endl ;
-	} else {
-	    std::cout
-		<< "Read " << filename << " without error." << std::endl ;
-	}
+    TraceSpan span("solver", "readMps", filename) ;
+    if (clpApi_->loadProblem_ != nullptr &&
+            (!keepNames || clpApi_->copyNames_ != nullptr)) {
+        MpsReader reader ;
+        reader.setKeepNames(keepNames) ;
+        reader.setThreads(threads_) ;
+        if (reader.readFile(filename) == 0) {
+            if (reserveModel(reader.getNumRows(), reader.getNumCols(),
+                             reader.getNumElements()) < 0)
+                return (-1) ;
+            loadMps(reader, keepNames) ;
+            OSI2_PLUGIN_LOG(log_, 3)
+                << "Read " << filename << " without error, "
+                << reader.getNumRows() << " x " << reader.getNumCols()
+                << "." ;
+            return (0) ;
+        }
+        OSI2_PLUGIN_LOG(log_, 1) << reader.getError() ;
+        if (!reader.canRetry()) {
+            OSI2_PLUGIN_LOG(log_, 1) << "Failure to read " << filename << "." ;
+            return (-1) ;
+        }
+    }
+    int retval =
+        clpApi_->readMps_(clpSimplex_, filename, keepNames, ignoreErrors) ;
+    /*
+      Clp did the reading, so the size is known only now. The problem is
+      loaded whether or not the charge is accepted; a refusal is still a
+      failure to read.
+    */
+    if (retval == 0 && clpApi_->numberRows_ != nullptr &&
+            clpApi_->numberColumns_ != nullptr &&
+            clpApi_->getNumElements_ != nullptr &&
+            reserveModel(clpApi_->numberRows_(clpSimplex_),
+                         clpApi_->numberColumns_(clpSimplex_),
+                         clpApi_->getNumElements_(clpSimplex_)) < 0)
+        return (-1) ;
+    if (retval) {
+	OSI2_PLUGIN_LOG(log_, 1)
+	    << "Failure to read " << filename << ", error " << retval
+	    << "." ;
+    } else {
+	OSI2_PLUGIN_LOG(log_, 3)
+	    << "Read " << filename << " without error." ;
     }
     return (retval) ;
 }
 
 /*
-  Solve a problem
+  The offset, integer markers and problem name are the optional extras; a
+  libClp without the entry points for them just doesn't get them.
+*/
+void ProbMgmtAPI_Clp::loadMps (const MpsReader &reader, bool keepNames)
+{
+    clpApi_->loadProblem_(clpSimplex_, reader.getNumCols(),
+                          reader.getNumRows(), reader.getStarts(),
+                          reader.getIndices(), reader.getValues(),
+                          reader.getColLower(), reader.getColUpper(),
+                          reader.getObjective(), reader.getRowLower(),
+                          reader.getRowUpper()) ;
+    if (reader.getObjOffset() != 0.0 &&
+            clpApi_->setObjectiveOffset_ != nullptr)
+        clpApi_->setObjectiveOffset_(clpSimplex_, reader.getObjOffset()) ;
+    if (reader.getIntegerInfo() != nullptr &&
+            clpApi_->copyInteger_ != nullptr)
+        clpApi_->copyInteger_(clpSimplex_, reader.getIntegerInfo()) ;
+    const std::string &probName = reader.getProblemName() ;
+    if (!probName.empty() && clpApi_->setProblemName_ != nullptr) {
+        std::vector<char> name(probName.begin(), probName.end()) ;
+        name.push_back('\0') ;
+        clpApi_->setProblemName_(clpSimplex_, static_cast<int>(name.size()),
+                                 &name[0]) ;
+    }
+    if (keepNames) {
+        const std::vector<std::string> &rowNames = reader.getRowNames() ;
+        const std::vector<std::string> &colNames = reader.getColNames() ;
+        std::vector<const char *> rows(rowNames.size()+1, nullptr) ;
+        std::vector<const char *> cols(colNames.size()+1, nullptr) ;
+        for (size_t i = 0 ; i < rowNames.size() ; i++)
+            rows[i] = rowNames[i].c_str() ;
+        for (size_t j = 0 ; j < colNames.size() ; j++)
+            cols[j] = colNames[j].c_str() ;
+        clpApi_->copyNames_(clpSimplex_, &rows[0], &cols[0]) ;
+    }
+}
+
+/*
+  Load a problem from memory. Clp_loadProblem is optional in the table; an
+  old libClp may not have it.
+*/
+int ProbMgmtAPI_Clp::loadProblem (int numCols, int numRows, const int *start,
+                                  const int *index, const double *value,
+                                  const double *colLower,
+                                  const double *colUpper, const double *obj,
+                                  const double *rowLower,
+                                  const double *rowUpper)
+{
+    if (clpApi_->loadProblem_ == nullptr) {
+	OSI2_PLUGIN_LOG(log_, 1) << "This libClp can't load a problem from memory." ;
+	return (-1) ;
+    }
+    if (reserveModel(numRows, numCols, (numCols > 0) ? start[numCols] : 0) < 0)
+        return (-1) ;
+    clpApi_->loadProblem_(clpSimplex_, numCols, numRows, start, index, value,
+                          colLower, colUpper, obj, rowLower, rowUpper) ;
+    OSI2_PLUGIN_LOG(log_, 3)
+	<< "Loaded " << numRows << " x " << numCols << " problem." ;
+    return (0) ;
+}
+
+/*
+  The matrix is handed over as clp holds it, starts and lengths; the writer
+  packs it. Names come out one at a time through a buffer long enough for
+  the longest.
+*/
+int ProbMgmtAPI_Clp::writeSnapshot (const char *path)
+{
+    const ClpCApi &api = *clpApi_ ;
+    if (api.numberRows_ == nullptr || api.numberColumns_ == nullptr ||
+            api.getVectorStarts_ == nullptr || api.getVectorLengths_ == nullptr ||
+            api.getIndices_ == nullptr || api.getElements_ == nullptr ||
+            api.columnLower_ == nullptr || api.columnUpper_ == nullptr ||
+            api.objective_ == nullptr || api.rowLower_ == nullptr ||
+            api.rowUpper_ == nullptr) {
+        OSI2_PLUGIN_LOG(log_, 1) << "This libClp can't write a snapshot." ;
+        return (-1) ;
+    }
+    ModelSnapshot::Problem prob ;
+    prob.numCols_ = api.numberColumns_(clpSimplex_) ;
+    prob.numRows_ = api.numberRows_(clpSimplex_) ;
+    prob.start_ = api.getVectorStarts_(clpSimplex_) ;
+    prob.length_ = api.getVectorLengths_(clpSimplex_) ;
+    prob.index_ = api.getIndices_(clpSimplex_) ;
+    prob.value_ = api.getElements_(clpSimplex_) ;
+    prob.colLower_ = api.columnLower_(clpSimplex_) ;
+    prob.colUpper_ = api.columnUpper_(clpSimplex_) ;
+    prob.obj_ = api.objective_(clpSimplex_) ;
+    prob.rowLower_ = api.rowLower_(clpSimplex_) ;
+    prob.rowUpper_ = api.rowUpper_(clpSimplex_) ;
+    if (api.integerInformation_ != nullptr)
+        prob.integer_ = api.integerInformation_(clpSimplex_) ;
+    if (api.statusArray_ != nullptr)
+        prob.status_ = api.statusArray_(clpSimplex_) ;
+    if (api.objectiveOffset_ != nullptr)
+        prob.objOffset_ = api.objectiveOffset_(clpSimplex_) ;
+    if (api.optimizationDirection_ != nullptr)
+        prob.objSense_ = api.optimizationDirection_(clpSimplex_) ;
+
+    /*
+      The names are copied out of clp one at a time, into an arena that
+      goes when the snapshot's written.
+    */
+    ArenaScope scratch(mem_) ;
+    const int probNameLen = 256 ;
+    char *probName = scratch.allocArray<char>(probNameLen) ;
+    if (api.problemName_ != nullptr && probName != nullptr) {
+        probName[0] = '\0' ;
+        api.problemName_(clpSimplex_, probNameLen, probName) ;
+        prob.problemName_ = probName ;
+    }
+    const int nameLen = (api.lengthNames_ == nullptr) ? 0 :
+                        api.lengthNames_(clpSimplex_) ;
+    if (nameLen > 0 && api.rowName_ != nullptr &&
+            api.columnName_ != nullptr) {
+        std::vector<char> buf(nameLen+1) ;
+        const char **rows = scratch.allocArray<const char *>(prob.numRows_+1) ;
+        const char **cols = scratch.allocArray<const char *>(prob.numCols_+1) ;
+        bool haveMem = (rows != nullptr && cols != nullptr) ;
+        for (int i = 0 ; haveMem && i < prob.numRows_ ; i++) {
+            api.rowName_(clpSimplex_, i, &buf[0]) ;
+            haveMem = ((rows[i] = scratch.copy(&buf[0])) != nullptr) ;
+        }
+        for (int j = 0 ; haveMem && j < prob.numCols_ ; j++) {
+            api.columnName_(clpSimplex_, j, &buf[0]) ;
+            haveMem = ((cols[j] = scratch.copy(&buf[0])) != nullptr) ;
+        }
+        if (!haveMem) {
+            OSI2_PLUGIN_LOG(log_, 1)
+                << "No memory for the names in snapshot " << path << "." ;
+            return (-1) ;
+        }
+        rows[prob.numRows_] = nullptr ;
+        cols[prob.numCols_] = nullptr ;
+        prob.rowNames_ = rows ;
+        prob.colNames_ = cols ;
+    }
+
+    std::string err ;
+    if (ModelSnapshot::write(path, prob, err) != 0) {
+        OSI2_PLUGIN_LOG(log_, 1) << err ;
+        return (-1) ;
+    }
+    OSI2_PLUGIN_LOG(log_, 3)
+        << "Wrote snapshot " << path << ", " << prob.numRows_ << " x "
+        << prob.numCols_ << "." ;
+    return (0) ;
+}
+
+/*
+  Clp_loadProblem copies the arrays, so the snapshot can go as soon as the
+  problem is loaded. The basis goes in last; loading the problem discards
+  any status clp had.
+*/
+int ProbMgmtAPI_Clp::readSnapshot (const char *path)
+{
+    const ClpCApi &api = *clpApi_ ;
+    if (api.loadProblem_ == nullptr) {
+        OSI2_PLUGIN_LOG(log_, 1) << "This libClp can't load a problem from memory." ;
+        return (-1) ;
+    }
+    ModelSnapshot snap ;
+    if (snap.read(path) != 0) {
+        OSI2_PLUGIN_LOG(log_, 1) << snap.getError() ;
+        return (-1) ;
+    }
+    const ModelSnapshot::Problem &prob = snap.getProblem() ;
+    int64_t numElements = 0 ;
+    if (prob.length_ != nullptr) {
+        for (int j = 0 ; j < prob.numCols_ ; j++)
+            numElements += prob.length_[j] ;
+    } else if (prob.numCols_ > 0) {
+        numElements = prob.start_[prob.numCols_] ;
+    }
+    if (reserveModel(prob.numRows_, prob.numCols_, numElements) < 0)
+        return (-1) ;
+    api.loadProblem_(clpSimplex_, prob.numCols_, prob.numRows_, prob.start_,
+                     prob.index_, prob.value_, prob.colLower_,
+                     prob.colUpper_, prob.obj_, prob.rowLower_,
+                     prob.rowUpper_) ;
+    if (prob.objOffset_ != 0.0 && api.setObjectiveOffset_ != nullptr)
+        api.setObjectiveOffset_(clpSimplex_, prob.objOffset_) ;
+    if (api.setOptimizationDirection_ != nullptr)
+        api.setOptimizationDirection_(clpSimplex_, prob.objSense_) ;
+    if (prob.integer_ != nullptr && api.copyInteger_ != nullptr)
+        api.copyInteger_(clpSimplex_, prob.integer_) ;
+    if (prob.problemName_ != nullptr && api.setProblemName_ != nullptr) {
+        std::vector<char> name(prob.problemName_,
+                               prob.problemName_+std::strlen(prob.problemName_)+1) ;
+        api.setProblemName_(clpSimplex_, static_cast<int>(name.size()),
+                            &name[0]) ;
+    }
+    if (prob.rowNames_ != nullptr && prob.colNames_ != nullptr &&
+            api.copyNames_ != nullptr)
+        api.copyNames_(clpSimplex_, prob.rowNames_, prob.colNames_) ;
+    if (prob.status_ != nullptr && api.copyinStatus_ != nullptr)
+        api.copyinStatus_(clpSimplex_, prob.status_) ;
+    OSI2_PLUGIN_LOG(log_, 3)
+        << "Read snapshot " << path << ", " << prob.numRows_ << " x "
+        << prob.numCols_ << "." ;
+    return (0) ;
+}
+
+/*
+  The old problem's reservation goes back if the new one is refused; clp
+  keeps the old problem.
+*/
+int ProbMgmtAPI_Clp::reserveModel (int numRows, int numCols,
+                                   int64_t numElements)
+{
+    const int64_t bytes = PluginMem::modelBytes(numRows, numCols, numElements) ;
+    if (model_.set(bytes) >= 0) return (0) ;
+    OSI2_PLUGIN_LOG(log_, 1)
+        << "A " << numRows << " x " << numCols << " problem needs about "
+        << (bytes+1023)/1024 << " KB, over this plugin's memory limit." ;
+    return (-1) ;
+}
+
+bool ProbMgmtAPI_Clp::setCancelToken (const CancelToken &token)
+{
+    cancel_ = token ;
+    return (false) ;
+}
+
+/*
+  Solve a problem. A time limit left from an earlier deadline is taken off
+  again when the token no longer has one.
 */
 int ProbMgmtAPI_Clp::initialSolve ()
 {
-    if (initialSolve_ == nullptr) {
-	ClpInitialSolveFunc initialSolve =
-	    loadFunc<ClpInitialSolveFunc>(libClp_,"Clp_initialSolve") ;
-        initialSolve_ = initialSolve ;
-    }
-    int retval = -1 ;
-    if (initialSolve_ != nullptr) {
-	retval = initialSolve_(clpSimplex_) ;
-	if (retval < 0) {
-	    std::cout
-                << "Solve failed; error " << retval << "." << std::endl ;
-	} else {
-	    std::cout
-                << "Solved; return status " << retval << "." << std::endl ;
-	}
+    TraceSpan span("solver", "initialSolve") ;
+    const CancelToken::Reason reason = cancel_.getStopReason() ;
+    if (reason != CancelToken::None) {
+        OSI2_PLUGIN_LOG(log_, 3)
+            << "Solve not started; "
+            << ((reason == CancelToken::Cancelled) ?
+                    "cancelled." : "deadline passed.") ;
+        return ((reason == CancelToken::Cancelled) ? 5 : 3) ;
+    }
+    if (clpApi_->setMaximumSeconds_ != nullptr) {
+        const int left = cancel_.getMillisecsLeft() ;
+        if (left >= 0) {
+            clpApi_->setMaximumSeconds_(clpSimplex_, left/1000.0) ;
+            timeLimited_ = true ;
+        } else if (timeLimited_) {
+            clpApi_->setMaximumSeconds_(clpSimplex_, -1.0) ;
+            timeLimited_ = false ;
+        }
+    }
+    int retval = clpApi_->initialSolve_(clpSimplex_) ;
+    if (retval < 0) {
+	OSI2_PLUGIN_LOG(log_, 1)
+	    << "Solve failed; error " << retval << "." ;
+    } else {
+	OSI2_PLUGIN_LOG(log_, 3)
+	    << "Solved; return status " << retval << "." ;
     }
     return (retval) ;
 }
 
+/*
+  Clp counts a bound of 1e30 or more as infinite. The arrays from
+  Clp_rowLower and friends are clp's own, so the originals are copied
+  before the first change.
+*/
+int ProbMgmtAPI_Clp::resolveBatch (BatchKind kind, int numVariants,
+                                   const double *variants, int *statuses,
+                                   double *objValues, double *colSolutions)
+{
+    if (variants == nullptr || numVariants < 0 || statuses == nullptr ||
+            objValues == nullptr)
+        return (-1) ;
+    const ClpCApi &api = *clpApi_ ;
+    const bool rhs = (kind == BatchRhs) ;
+    const ClpCApi::SimplexFunc simplex = rhs ? api.dual_ : api.primal_ ;
+    if (simplex == nullptr || api.numberRows_ == nullptr ||
+            api.numberColumns_ == nullptr || api.status_ == nullptr ||
+            api.objectiveValue_ == nullptr ||
+            (colSolutions != nullptr && api.primalColumnSolution_ == nullptr) ||
+            (rhs && (api.rowLower_ == nullptr || api.rowUpper_ == nullptr ||
+                     api.chgRowLower_ == nullptr ||
+                     api.chgRowUpper_ == nullptr)) ||
+            (!rhs && (api.objective_ == nullptr ||
+                      api.chgObjCoefficients_ == nullptr))) {
+	OSI2_PLUGIN_LOG(log_, 1) << "This libClp can't re-solve a batch." ;
+	return (-1) ;
+    }
+    TraceSpan span("solver", "resolveBatch") ;
+    const int numRows = api.numberRows_(clpSimplex_) ;
+    const int numCols = api.numberColumns_(clpSimplex_) ;
+    const size_t len = rhs ? numRows : numCols ;
+    std::vector<double> savedLower, savedUpper, savedObj ;
+    std::vector<double> lower, upper ;
+    if (rhs) {
+        savedLower.assign(api.rowLower_(clpSimplex_),
+                          api.rowLower_(clpSimplex_)+numRows) ;
+        savedUpper.assign(api.rowUpper_(clpSimplex_),
+                          api.rowUpper_(clpSimplex_)+numRows) ;
+        lower.resize(numRows) ;
+        upper.resize(numRows) ;
+    } else {
+        savedObj.assign(api.objective_(clpSimplex_),
+                        api.objective_(clpSimplex_)+numCols) ;
+    }
+    int numOptimal = 0 ;
+    for (int v = 0 ; v < numVariants ; v++) {
+        const double *variant = variants+v*len ;
+        const CancelToken::Reason reason = cancel_.getStopReason() ;
+        if (reason != CancelToken::None) {
+            statuses[v] = (reason == CancelToken::Cancelled) ? 5 : 3 ;
+            objValues[v] = 0.0 ;
+            continue ;
+        }
+        if (rhs && numRows > 0) {
+            rhsToRowBounds(numRows, &savedLower[0], &savedUpper[0], variant,
+                           1.0e30, &lower[0], &upper[0]) ;
+            api.chgRowLower_(clpSimplex_, &lower[0]) ;
+            api.chgRowUpper_(clpSimplex_, &upper[0]) ;
+        } else if (!rhs) {
+            api.chgObjCoefficients_(clpSimplex_, variant) ;
+        }
+        simplex(clpSimplex_, 0) ;
+        statuses[v] = api.status_(clpSimplex_) ;
+        objValues[v] = api.objectiveValue_(clpSimplex_) ;
+        if (statuses[v] == 0) numOptimal++ ;
+        if (colSolutions != nullptr && numCols > 0)
+            std::memcpy(colSolutions+v*static_cast<size_t>(numCols),
+                        api.primalColumnSolution_(clpSimplex_),
+                        numCols*sizeof(double)) ;
+    }
+    if (rhs && numRows > 0) {
+        api.chgRowLower_(clpSimplex_, &savedLower[0]) ;
+        api.chgRowUpper_(clpSimplex_, &savedUpper[0]) ;
+    } else if (!rhs && numCols > 0) {
+        api.chgObjCoefficients_(clpSimplex_, &savedObj[0]) ;
+    }
+    OSI2_PLUGIN_LOG(log_, 3)
+	<< "Re-solved " << numVariants << " variants; " << numOptimal
+	<< " optimal." ;
+    return (numOptimal) ;
+}
+
 }
@@ -10,7 +10,11 @@
 #ifndef Osi2ProbMgmtAPI_Clp_HPP
 #define Osi2ProbMgmtAPI_Clp_HPP
 
-#include "Osi2DynamicLibrary.hpp"
+#include "Osi2ClpCApi.hpp"
+#include "Osi2MpsReader.hpp"
+#include "Osi2ModelSnapshot.hpp"
+#include "Osi2PluginLog.hpp"
+#include "Osi2PluginMem.hpp"
 
 #include "Osi2API.hpp"
 #include "Osi2ProbMgmtAPI.hpp"
@@ -25,41 +29,114 @@ namespace Osi2 {
 class ProbMgmtAPI_Clp : public ProbMgmtAPI {
 
 public:
-    /// Constructor with ClpSimplex object
-    ProbMgmtAPI_Clp(DynamicLibrary *libClp, Clp_Simplex *clpSimplex) ;
+    /*! \brief Constructor with ClpSimplex object
+
+      \p clpApi is the shim's table of clp entry points (see
+      ClpShim::getClpApi); it must outlive the object. Messages go to
+      \p log (see ClpShim::getLog), and the memory the problem needs is
+      charged through \p mem (see ClpShim::getMem). MpsReader parses in
+      the thread pool \p threads (see ClpShim::getThreads).
+    */
+    ProbMgmtAPI_Clp(const ClpCApi *clpApi, Clp_Simplex *clpSimplex,
+                    const PluginLog &log, const PluginMem &mem,
+                    const PluginThreads &threads) ;
 
     /// Destructor
     virtual ~ProbMgmtAPI_Clp() ;
 
-    /// Read an mps file from the given filename
+    /*! \brief Read an mps file from the given filename
+
+      The file is read with MpsReader, which maps plain files, decompresses
+      gzip and zstd, takes pipes and \c /dev/fd/N, and parses COLUMNS in
+      parallel. What MpsReader can't handle goes to Clp_readMps, unless the
+      input was a stream that's already been consumed.
+    */
     int readMps(const char *filename, bool keepNames = false,
                 bool ignoreErrors = false) ;
 
+    /*! \brief Load a problem from column-major arrays
+
+      The arrays go straight to Clp_loadProblem; see ProbMgmtAPI::loadProblem.
+    */
+    int loadProblem(int numCols, int numRows, const int *start,
+                    const int *index, const double *value,
+                    const double *colLower, const double *colUpper,
+                    const double *obj, const double *rowLower,
+                    const double *rowUpper) ;
+
+    /*! \brief Write the problem to a binary snapshot
+
+      Needs the matrix and bound accessors of the C interface. Names are
+      written if clp has them, and the basis if clp has a status array.
+    */
+    int writeSnapshot(const char *path) ;
+
+    /*! \brief Load the problem in a binary snapshot
+
+      The mapped arrays go straight to Clp_loadProblem; the extras (offset,
+      integrality, names, basis) need their optional entry points.
+    */
+    int readSnapshot(const char *path) ;
+
     /*! \brief Solve an lp
 
-      See ClpModel::status() for the meaning of the return value.
+      See ClpModel::status() for the meaning of the return value. If the
+      CancelToken says to stop before the solve starts, returns 5
+      (cancelled) or 3 (deadline passed) without solving.
     */
     int initialSolve() ;
 
+    /*! \brief Re-solve under a batch of right-hand sides or objectives
+
+      Right-hand sides are re-solved by the dual simplex and objectives by
+      the primal, each from where the last left clp's basis. Needs the
+      bound, objective and solution accessors of the C interface, the
+      matching Clp_chg* entry, and Clp_dual or Clp_primal. The CancelToken
+      is looked at before each variant; those not started get the status
+      #initialSolve would return.
+    */
+    int resolveBatch(BatchKind kind, int numVariants, const double *variants,
+                     int *statuses, double *objValues,
+                     double *colSolutions = 0) ;
+
+    /*! \brief Attach \p token to the object
+
+      The C interface has no way to stop a solve part way, so the token is
+      looked at before each solve starts, and the time left to its deadline
+      becomes clp's time limit (Clp_setMaximumSeconds, which counts cpu
+      time). Returns false: a cancel doesn't reach a solve that's running.
+    */
+    bool setCancelToken(const CancelToken &token) ;
+
 private:
+    /// Load the problem read by \p reader into clp
+    void loadMps(const MpsReader &reader, bool keepNames) ;
+
+    /*! \brief Reserve memory for a problem of the given size
+
+      Replaces the reservation for the problem held now. Returns -1, with a
+      message, if the charge is refused; 0 otherwise.
+    */
+    int reserveModel(int numRows, int numCols, int64_t numElements) ;
+
   /*! \name Dynamic object management information */
   //@{
-    /// Dynamic library handle
-    DynamicLibrary *libClp_ ;
+    /// The clp C interface, shared with the shim and its other objects
+    const ClpCApi *clpApi_ ;
     /// Clp object
     Clp_Simplex *clpSimplex_ ;
-  //@}
-
-  /*! \name Lazy symbol load
-
-    Methods in the Clp C Interface are looked up as needed and cached. In
-    general, there's a typedef and field for each method.
-  */
-  //@{
-    typedef  int (*ClpReadMpsFunc)(Clp_Simplex*, const char*, int, int) ;
-    ClpReadMpsFunc readMps_ ;
-    typedef  int (*ClpInitialSolveFunc)(Clp_Simplex*) ;
-    ClpInitialSolveFunc initialSolve_ ;
+    /// The plugin manager's log service
+    PluginLog log_ ;
+    /// The plugin manager's memory services
+    PluginMem mem_ ;
+    /// The plugin manager's thread pool
+    PluginThreads threads_ ;
+    /// Memory charged for the problem, an estimate (PluginMem::modelBytes)
+    MemReservation model_ ;
+    /// The token attached by #setCancelToken
+    CancelToken cancel_ ;
+    /// True if the last solve was given a time limit from #cancel_
+    bool timeLimited_ ;
   //@}
 
 } ;
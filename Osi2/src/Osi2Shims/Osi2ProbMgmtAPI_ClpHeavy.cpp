@@ -12,7 +12,9 @@
   libraries and allows direct access to clp objects.
 */
 
-#include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #include "ClpConfig.h"
 #include "Osi2ClpShim.hpp"
@@ -24,6 +26,10 @@
 #include "Osi2API.hpp"
 #include "Osi2ProbMgmtAPI.hpp"
 #include "Osi2ProbMgmtAPI_ClpHeavy.hpp"
+#include "Osi2ClpCancelHandler.hpp"
+#include "Osi2MpsReader.hpp"
+#include "Osi2ModelSnapshot.hpp"
+#include "Osi2Trace.hpp"
 
 namespace Osi2 {
 
@@ -31,53 +37,319 @@ namespace Osi2 {
 /*
   Capture a pointer to the underlying ClpSimplex object.
 */
-ProbMgmtAPI_ClpHeavy::ProbMgmtAPI_ClpHeavy (ClpSimplex *clpSimplex)
-    : clpSimplex_(clpSimplex)
+ProbMgmtAPI_ClpHeavy::ProbMgmtAPI_ClpHeavy (ClpSimplex *clpSimplex,
+                                            const PluginLog &log,
+                                            const PluginMem &mem,
+                                            const PluginThreads &threads)
+    : clpSimplex_(clpSimplex),
+      log_(log),
+      threads_(threads)
 {
+    model_.init(mem, static_cast<const API *>(this)) ;
 }
 
 ProbMgmtAPI_ClpHeavy::~ProbMgmtAPI_ClpHeavy ()
 {
   delete clpSimplex_ ;
-  std::cout << "ProbMgmtAPI_Clp object destroyed." << std::endl ;
+  OSI2_PLUGIN_LOG(log_, 5) << "ProbMgmtAPI_ClpHeavy object destroyed." ;
 }
 
 /*
-  Read a problem file in mps format.
+  Read a problem file in mps format. MpsReader does the reading; if it
+  can't cope, and the file can be read again, clp reads it.
 */
 int ProbMgmtAPI_ClpHeavy::readMps (const char *filename, bool keepNames,
                               bool ignoreErrors)
 {
+    TraceSpan span("solver", "readMps", filename) ;
+    MpsReader reader ;
+    reader.setKeepNames(keepNames) ;
+    reader.setThreads(threads_) ;
+    if (reader.readFile(filename) == 0) {
+        if (reserveModel(reader.getNumRows(), reader.getNumCols(),
+                         reader.getNumElements()) < 0)
+            return (-1) ;
+        clpSimplex_->loadProblem(reader.getNumCols(), reader.getNumRows(),
+                                 reader.getStarts(), reader.getIndices(),
+                                 reader.getValues(), reader.getColLower(),
+                                 reader.getColUpper(), reader.getObjective(),
+                                 reader.getRowLower(), reader.getRowUpper()) ;
+        clpSimplex_->setObjectiveOffset(reader.getObjOffset()) ;
+        if (reader.getIntegerInfo() != nullptr)
+            clpSimplex_->copyInteger(reader.getIntegerInfo()) ;
+        clpSimplex_->setStrParam(ClpProbName, reader.getProblemName()) ;
+        if (keepNames)
+            clpSimplex_->copyNames(reader.getRowNames(), reader.getColNames()) ;
+        OSI2_PLUGIN_LOG(log_, 3)
+            << "Read " << filename << " without error, "
+            << reader.getNumRows() << " x " << reader.getNumCols() << "." ;
+        return (0) ;
+    }
+    OSI2_PLUGIN_LOG(log_, 1) << reader.getError() ;
+    if (!reader.canRetry()) {
+        OSI2_PLUGIN_LOG(log_, 1) << "Failure to read " << filename << "." ;
+        return (-1) ;
+    }
+
     int retval = clpSimplex_->readMps(filename, keepNames, ignoreErrors) ;
+    /*
+      Clp did the reading, so the size is known only now. The problem is
+      loaded whether or not the charge is accepted; a refusal is still a
+      failure to read.
+    */
+    if (retval == 0 &&
+            reserveModel(clpSimplex_->getNumRows(), clpSimplex_->getNumCols(),
+                         clpSimplex_->getNumElements()) < 0)
+        return (-1) ;
 
     if (retval) {
-        std::cout
-                << "Failure to read " << filename << ", error " << retval
-                << "." << std::endl ;
+        OSI2_PLUGIN_LOG(log_, 1)
+            << "Failure to read " << filename << ", error " << retval << "." ;
     } else {
-        std::cout
-                << "Read " << filename << " without error." << std::endl ;
+        OSI2_PLUGIN_LOG(log_, 3) << "Read " << filename << " without error." ;
     }
 
     return (retval) ;
 }
 
+/*
+  Load a problem from memory.
+*/
+int ProbMgmtAPI_ClpHeavy::loadProblem (int numCols, int numRows,
+                                       const int *start, const int *index,
+                                       const double *value,
+                                       const double *colLower,
+                                       const double *colUpper,
+                                       const double *obj,
+                                       const double *rowLower,
+                                       const double *rowUpper)
+{
+    if (reserveModel(numRows, numCols, (numCols > 0) ? start[numCols] : 0) < 0)
+        return (-1) ;
+    clpSimplex_->loadProblem(numCols, numRows, start, index, value,
+                             colLower, colUpper, obj, rowLower, rowUpper) ;
+    OSI2_PLUGIN_LOG(log_, 3)
+        << "Loaded " << numRows << " x " << numCols << " problem." ;
+    return (0) ;
+}
+
+/*
+  The matrix goes out as clp holds it, starts and lengths; the writer packs
+  it.
+*/
+int ProbMgmtAPI_ClpHeavy::writeSnapshot (const char *path)
+{
+    return (writeClpSnapshot(clpSimplex_, path, log_)) ;
+}
+
+int ProbMgmtAPI_ClpHeavy::writeClpSnapshot (ClpSimplex *clp,
+                                            const char *path,
+                                            const PluginLog &log)
+{
+    ModelSnapshot::Problem prob ;
+    prob.numCols_ = clp->getNumCols() ;
+    prob.numRows_ = clp->getNumRows() ;
+    const CoinPackedMatrix *matrix = clp->matrix() ;
+    if (matrix != nullptr) {
+        prob.start_ = matrix->getVectorStarts() ;
+        prob.length_ = matrix->getVectorLengths() ;
+        prob.index_ = matrix->getIndices() ;
+        prob.value_ = matrix->getElements() ;
+    }
+    prob.colLower_ = clp->columnLower() ;
+    prob.colUpper_ = clp->columnUpper() ;
+    prob.obj_ = clp->objective() ;
+    prob.rowLower_ = clp->rowLower() ;
+    prob.rowUpper_ = clp->rowUpper() ;
+    prob.integer_ = clp->integerInformation() ;
+    prob.status_ = clp->statusArray() ;
+    prob.objOffset_ = clp->objectiveOffset() ;
+    prob.objSense_ = clp->optimizationDirection() ;
+    const std::string probName = clp->problemName() ;
+    prob.problemName_ = probName.c_str() ;
+
+    std::vector<std::string> rowNames, colNames ;
+    std::vector<const char *> rows, cols ;
+    if (clp->lengthNames() > 0) {
+        rowNames.resize(prob.numRows_) ;
+        for (int i = 0 ; i < prob.numRows_ ; i++)
+            rowNames[i] = clp->rowName(i) ;
+        colNames.resize(prob.numCols_) ;
+        for (int j = 0 ; j < prob.numCols_ ; j++)
+            colNames[j] = clp->columnName(j) ;
+        rows.resize(rowNames.size()+1) ;
+        cols.resize(colNames.size()+1) ;
+        for (size_t i = 0 ; i < rowNames.size() ; i++)
+            rows[i] = rowNames[i].c_str() ;
+        for (size_t j = 0 ; j < colNames.size() ; j++)
+            cols[j] = colNames[j].c_str() ;
+        prob.rowNames_ = &rows[0] ;
+        prob.colNames_ = &cols[0] ;
+    }
+
+    std::string err ;
+    if (ModelSnapshot::write(path, prob, err) != 0) {
+        OSI2_PLUGIN_LOG(log, 1) << err ;
+        return (-1) ;
+    }
+    OSI2_PLUGIN_LOG(log, 3)
+        << "Wrote snapshot " << path << ", " << prob.numRows_ << " x "
+        << prob.numCols_ << "." ;
+    return (0) ;
+}
+
+/*
+  loadProblem copies the arrays, so the snapshot can go as soon as the
+  problem is loaded. The basis goes in last; loading the problem discards
+  any status clp had.
+*/
+int ProbMgmtAPI_ClpHeavy::readSnapshot (const char *path)
+{
+    ModelSnapshot snap ;
+    if (snap.read(path) != 0) {
+        OSI2_PLUGIN_LOG(log_, 1) << snap.getError() ;
+        return (-1) ;
+    }
+    const ModelSnapshot::Problem &prob = snap.getProblem() ;
+    if (reserveModel(prob.numRows_, prob.numCols_,
+                     (prob.numCols_ > 0) ? prob.start_[prob.numCols_] : 0) < 0)
+        return (-1) ;
+    clpSimplex_->loadProblem(prob.numCols_, prob.numRows_, prob.start_,
+                             prob.index_, prob.value_, prob.colLower_,
+                             prob.colUpper_, prob.obj_, prob.rowLower_,
+                             prob.rowUpper_) ;
+    clpSimplex_->setObjectiveOffset(prob.objOffset_) ;
+    clpSimplex_->setOptimizationDirection(prob.objSense_) ;
+    if (prob.integer_ != nullptr) clpSimplex_->copyInteger(prob.integer_) ;
+    if (prob.problemName_ != nullptr)
+        clpSimplex_->setStrParam(ClpProbName, prob.problemName_) ;
+    if (prob.rowNames_ != nullptr && prob.colNames_ != nullptr)
+        clpSimplex_->copyNames(prob.rowNames_, prob.colNames_) ;
+    if (prob.status_ != nullptr) clpSimplex_->copyinStatus(prob.status_) ;
+    OSI2_PLUGIN_LOG(log_, 3)
+        << "Read snapshot " << path << ", " << prob.numRows_ << " x "
+        << prob.numCols_ << "." ;
+    return (0) ;
+}
+
+/*
+  As ProbMgmtAPI_Clp::reserveModel: the old problem's reservation goes
+  back if the new one is refused. Where the charge comes before the load,
+  clp keeps the old problem; after ClpSimplex::readMps it already holds the
+  new one.
+*/
+int ProbMgmtAPI_ClpHeavy::reserveModel (int numRows, int numCols,
+                                        int64_t numElements)
+{
+    const int64_t bytes = PluginMem::modelBytes(numRows, numCols, numElements) ;
+    if (model_.set(bytes) >= 0) return (0) ;
+    OSI2_PLUGIN_LOG(log_, 1)
+        << "A " << numRows << " x " << numCols << " problem needs about "
+        << (bytes+1023)/1024 << " KB, over this plugin's memory limit." ;
+    return (-1) ;
+}
+
+bool ProbMgmtAPI_ClpHeavy::setCancelToken (const CancelToken &token)
+{
+    cancel_ = token ;
+    ClpCancelHandler handler(token) ;
+    clpSimplex_->passInEventHandler(&handler) ;
+    return (true) ;
+}
+
 /*
   Solve a problem.
 */
 int ProbMgmtAPI_ClpHeavy::initialSolve ()
 {
+    TraceSpan span("solver", "initialSolve") ;
     int retval = clpSimplex_->initialSolve() ;
+    if (ClpCancelHandler::stopReason(clpSimplex_, cancel_) ==
+            CancelToken::DeadlineExpired)
+        retval = 3 ;
 
     if (retval < 0) {
-        std::cout
-                << "Solve failed; error " << retval << "." << std::endl ;
+        OSI2_PLUGIN_LOG(log_, 1) << "Solve failed; error " << retval << "." ;
     } else {
-        std::cout
-                << "Solved; return status " << retval << "." << std::endl ;
+        OSI2_PLUGIN_LOG(log_, 3) << "Solved; return status " << retval << "." ;
     }
 
     return (retval) ;
 }
 
+/*
+  ClpSimplex's setRowBounds and setObjectiveCoefficient keep the work
+  areas in step when they're being kept; the whole-array chg* methods
+  would make clp start over. For the startFinishOptions of dual and
+  primal: 1 keeps the work areas and factorization at the end of a solve,
+  2 takes up the factorization kept by the one before.
+*/
+int ProbMgmtAPI_ClpHeavy::resolveBatch (BatchKind kind, int numVariants,
+                                        const double *variants,
+                                        int *statuses, double *objValues,
+                                        double *colSolutions)
+{
+    if (variants == nullptr || numVariants < 0 || statuses == nullptr ||
+            objValues == nullptr)
+        return (-1) ;
+    TraceSpan span("solver", "resolveBatch") ;
+    const bool rhs = (kind == BatchRhs) ;
+    const int numRows = clpSimplex_->numberRows() ;
+    const int numCols = clpSimplex_->numberColumns() ;
+    const size_t len = rhs ? numRows : numCols ;
+    std::vector<double> savedLower, savedUpper, savedObj ;
+    std::vector<double> lower(numRows), upper(numRows) ;
+    if (rhs) {
+        savedLower.assign(clpSimplex_->rowLower(),
+                          clpSimplex_->rowLower()+numRows) ;
+        savedUpper.assign(clpSimplex_->rowUpper(),
+                          clpSimplex_->rowUpper()+numRows) ;
+    } else {
+        savedObj.assign(clpSimplex_->objective(),
+                        clpSimplex_->objective()+numCols) ;
+    }
+    int numOptimal = 0 ;
+    for (int v = 0 ; v < numVariants ; v++) {
+        const double *variant = variants+v*len ;
+        if (rhs && numRows > 0) {
+            rhsToRowBounds(numRows, &savedLower[0], &savedUpper[0], variant,
+                           1.0e30, &lower[0], &upper[0]) ;
+            const double *rowLower = clpSimplex_->rowLower() ;
+            const double *rowUpper = clpSimplex_->rowUpper() ;
+            for (int i = 0 ; i < numRows ; i++) {
+                if (lower[i] != rowLower[i] || upper[i] != rowUpper[i])
+                    clpSimplex_->setRowBounds(i, lower[i], upper[i]) ;
+            }
+        } else if (!rhs) {
+            const double *obj = clpSimplex_->objective() ;
+            for (int j = 0 ; j < numCols ; j++) {
+                if (variant[j] != obj[j])
+                    clpSimplex_->setObjectiveCoefficient(j, variant[j]) ;
+            }
+        }
+        const int options = ((v < numVariants-1) ? 1 : 0)|((v > 0) ? 2 : 0) ;
+        if (rhs)
+            clpSimplex_->dual(0, options) ;
+        else
+            clpSimplex_->primal(0, options) ;
+        statuses[v] = clpSimplex_->status() ;
+        if (ClpCancelHandler::stopReason(clpSimplex_, cancel_) ==
+                CancelToken::DeadlineExpired)
+            statuses[v] = 3 ;
+        objValues[v] = clpSimplex_->objectiveValue() ;
+        if (statuses[v] == 0) numOptimal++ ;
+        if (colSolutions != nullptr && numCols > 0)
+            std::memcpy(colSolutions+v*static_cast<size_t>(numCols),
+                        clpSimplex_->primalColumnSolution(),
+                        numCols*sizeof(double)) ;
+    }
+    if (rhs) {
+        for (int i = 0 ; i < numRows ; i++)
+            clpSimplex_->setRowBounds(i, savedLower[i], savedUpper[i]) ;
+    } else if (numCols > 0) {
+        clpSimplex_->chgObjCoefficients(&savedObj[0]) ;
+    }
+    return (numOptimal) ;
+}
+
 }
@@ -15,6 +15,9 @@
 
 #include "Osi2API.hpp"
 #include "Osi2ProbMgmtAPI.hpp"
+#include "Osi2PluginLog.hpp"
+#include "Osi2PluginMem.hpp"
+#include "Osi2PluginThreads.hpp"
 
 /*! \brief Proof of concept API.
 
@@ -26,27 +29,99 @@ namespace Osi2 {
 class ProbMgmtAPI_ClpHeavy : public ProbMgmtAPI {
 
 public:
-    /// Constructor with ClpSimplex object
-    ProbMgmtAPI_ClpHeavy(ClpSimplex *clpSimplex) ;
+    /*! \brief Constructor with ClpSimplex object
+
+      Messages go to \p log (see ClpHeavyShim::getLog). Clp allocates for
+      itself; an estimate of what it needs for each problem is charged
+      through \p mem. MpsReader parses in the thread pool \p threads.
+    */
+    ProbMgmtAPI_ClpHeavy(ClpSimplex *clpSimplex, const PluginLog &log,
+                         const PluginMem &mem, const PluginThreads &threads) ;
 
     /// Destructor
     virtual ~ProbMgmtAPI_ClpHeavy() ;
 
-    /// Read an mps file from the given filename
+    /*! \brief Read an mps file from the given filename
+
+      As ProbMgmtAPI_Clp::readMps: MpsReader first, then
+      ClpSimplex::readMps for what it can't handle.
+    */
     int readMps(const char *filename, bool keepNames = false,
                 bool ignoreErrors = false) ;
 
+    /*! \brief Load a problem from column-major arrays
+
+      The arrays go straight to ClpSimplex::loadProblem; see
+      ProbMgmtAPI::loadProblem.
+    */
+    int loadProblem(int numCols, int numRows, const int *start,
+                    const int *index, const double *value,
+                    const double *colLower, const double *colUpper,
+                    const double *obj, const double *rowLower,
+                    const double *rowUpper) ;
+
+    /*! \brief Write the problem to a binary snapshot
+
+      Names are written if clp has them, and the basis if it has a status
+      array.
+    */
+    int writeSnapshot(const char *path) ;
+
+    /*! \brief Write the problem in \p clp to a binary snapshot
+
+      The work of #writeSnapshot, shared with Osi1API_ClpHeavy; messages go
+      to \p log.
+    */
+    static int writeClpSnapshot(ClpSimplex *clp, const char *path,
+                                const PluginLog &log) ;
+
+    /*! \brief Load the problem in a binary snapshot
+
+      The mapped arrays go straight to ClpSimplex::loadProblem.
+    */
+    int readSnapshot(const char *path) ;
+
     /*! \brief Solve an lp
 
-      See ClpModel::status() for the meaning of the return value.
+      See ClpModel::status() for the meaning of the return value; a solve
+      the CancelToken stopped for its deadline returns 3 rather than 5.
     */
     int initialSolve() ;
 
+    /*! \brief Re-solve under a batch of right-hand sides or objectives
+
+      Right-hand sides are re-solved by the dual simplex and objectives by
+      the primal. Clp is told to keep its work areas and factorization from
+      one variant to the next, and only the bounds or costs that differ
+      are changed, so each solve starts from the last one's factorization.
+    */
+    int resolveBatch(BatchKind kind, int numVariants, const double *variants,
+                     int *statuses, double *objValues,
+                     double *colSolutions = 0) ;
+
+    /*! \brief Attach \p token to the object
+
+      As Osi1API_ClpHeavy::setCancelToken: the token becomes the clp
+      model's event handler and is looked at on every simplex iteration.
+    */
+    bool setCancelToken(const CancelToken &token) ;
+
 private:
+    /// Reserve memory for a problem of the given size; -1 if refused
+    int reserveModel(int numRows, int numCols, int64_t numElements) ;
+
   /*! \name Dynamic object management information */
   //@{
     /// Clp object
     ClpSimplex *clpSimplex_ ;
+    /// The plugin manager's log service
+    PluginLog log_ ;
+    /// The plugin manager's thread pool
+    PluginThreads threads_ ;
+    /// Memory charged for the problem, an estimate (PluginMem::modelBytes)
+    MemReservation model_ ;
+    /// The token attached by #setCancelToken
+    CancelToken cancel_ ;
   //@}
 
 } ;
@@ -0,0 +1,290 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ProbMgmtAPI_Glpk.cpp
+    \brief Method definitions for Osi2ProbMgmtAPI_Glpk
+
+  Method definitions for ProbMgmtAPI_Glpk, an implementation of the
+  problem management API using the `light' glpk shim, which calls glpk
+  through a table of entry points bound when libglpk is loaded.
+*/
+
+#include <string>
+#include <vector>
+
+#include "Osi2GlpkShim.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+
+#include "Osi2API.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
+#include "Osi2ModelSnapshot.hpp"
+#include "Osi2ProbMgmtAPI_Glpk.hpp"
+#include "Osi2Trace.hpp"
+
+namespace Osi2 {
+
+namespace {
+
+/// Bounds at or beyond this are infinite
+const double glpkInfinity = 1.0e30 ;
+
+/// Set the bounds of row or column \p k (1-based) through \p setBnds
+inline void setBounds (GlpkCApi::SetBndsFunc setBnds, GlpkProb *prob, int k,
+                       double lower, double upper)
+{
+    const bool hasLower = (lower > -glpkInfinity) ;
+    const bool hasUpper = (upper < glpkInfinity) ;
+    int type ;
+    if (hasLower && hasUpper)
+        type = (lower == upper) ? GlpkConst::boundFixed :
+               GlpkConst::boundDouble ;
+    else if (hasLower)
+        type = GlpkConst::boundLower ;
+    else if (hasUpper)
+        type = GlpkConst::boundUpper ;
+    else
+        type = GlpkConst::boundFree ;
+    setBnds(prob, k, type, hasLower ? lower : 0.0, hasUpper ? upper : 0.0) ;
+}
+
+}   // end unnamed file-local namespace
+
+/*
+  Capture a pointer to the underlying glpk problem object.
+*/
+ProbMgmtAPI_Glpk::ProbMgmtAPI_Glpk (const GlpkCApi *glpkApi, GlpkProb *prob,
+                                    const PluginLog &log)
+    : glpkApi_(glpkApi),
+      prob_(prob),
+      log_(log)
+{
+}
+
+ProbMgmtAPI_Glpk::~ProbMgmtAPI_Glpk ()
+{
+  glpkApi_->deleteProb_(prob_) ;
+  prob_ = nullptr ;
+  OSI2_PLUGIN_LOG(log_, 5) << "ProbMgmtAPI_Glpk object destroyed." ;
+}
+
+/*
+  Read a problem file in mps format. If MpsReader can't cope and the file
+  can be read again, glpk reads it. glpk has no `ignore errors' mode.
+*/
+int ProbMgmtAPI_Glpk::readMps (const char *filename, bool keepNames,
+                               bool ignoreErrors)
+{
+    TraceSpan span("solver", "readMps", filename) ;
+    MpsReader reader ;
+    reader.setKeepNames(keepNames) ;
+    if (reader.readFile(filename) == 0) {
+        load(reader.getNumCols(), reader.getNumRows(), reader.getStarts(),
+             nullptr, reader.getIndices(), reader.getValues(),
+             reader.getColLower(), reader.getColUpper(),
+             reader.getObjective(), reader.getRowLower(),
+             reader.getRowUpper(), reader.getObjOffset(),
+             reader.getIntegerInfo()) ;
+        if (keepNames) loadNames(reader) ;
+        OSI2_PLUGIN_LOG(log_, 3)
+            << "Read " << filename << " without error, "
+            << reader.getNumRows() << " x " << reader.getNumCols()
+            << "." ;
+        return (0) ;
+    }
+    OSI2_PLUGIN_LOG(log_, 1) << reader.getError() ;
+    if (!reader.canRetry()) {
+        OSI2_PLUGIN_LOG(log_, 1) << "Failure to read " << filename << "." ;
+        return (-1) ;
+    }
+    int retval =
+        glpkApi_->readMps_(prob_, GlpkConst::freeMps, nullptr, filename) ;
+    if (retval) {
+	OSI2_PLUGIN_LOG(log_, 1)
+	    << "Failure to read " << filename << ", error " << retval
+	    << "." ;
+    } else {
+	OSI2_PLUGIN_LOG(log_, 3)
+	    << "Read " << filename << " without error." ;
+    }
+    return (retval) ;
+}
+
+/*
+  Names are optional extras; a libglpk without the entry points for them
+  just doesn't get them.
+*/
+void ProbMgmtAPI_Glpk::loadNames (const MpsReader &reader)
+{
+    const GlpkCApi &api = *glpkApi_ ;
+    const std::string &probName = reader.getProblemName() ;
+    if (!probName.empty() && api.setProbName_ != nullptr)
+        api.setProbName_(prob_, probName.c_str()) ;
+    const std::vector<std::string> &rowNames = reader.getRowNames() ;
+    if (api.setRowName_ != nullptr) {
+        for (size_t i = 0 ; i < rowNames.size() ; i++)
+            api.setRowName_(prob_, static_cast<int>(i)+1,
+                            rowNames[i].c_str()) ;
+    }
+    const std::vector<std::string> &colNames = reader.getColNames() ;
+    if (api.setColName_ != nullptr) {
+        for (size_t j = 0 ; j < colNames.size() ; j++)
+            api.setColName_(prob_, static_cast<int>(j)+1,
+                            colNames[j].c_str()) ;
+    }
+}
+
+/*
+  glpk counts rows and columns from 1, and wants each column's row indices
+  and coefficients from element 1 of its arrays; one pair of buffers, as
+  long as the longest column, does for all.
+
+  glpk treats a bad argument as fatal, so the counts given to
+  glp_add_rows and glp_add_cols must be positive.
+*/
+void ProbMgmtAPI_Glpk::load (int numCols, int numRows, const int *start,
+                             const int *length, const int *index,
+                             const double *value, const double *colLower,
+                             const double *colUpper, const double *obj,
+                             const double *rowLower, const double *rowUpper,
+                             double objOffset, const char *integer)
+{
+    const GlpkCApi &api = *glpkApi_ ;
+    api.eraseProb_(prob_) ;
+    if (numRows > 0) api.addRows_(prob_, numRows) ;
+    if (numCols > 0) api.addCols_(prob_, numCols) ;
+
+    for (int i = 0 ; i < numRows ; i++)
+        setBounds(api.setRowBnds_, prob_, i+1,
+                  (rowLower == nullptr) ? -glpkInfinity : rowLower[i],
+                  (rowUpper == nullptr) ? glpkInfinity : rowUpper[i]) ;
+    std::vector<int> ndx(1) ;
+    std::vector<double> coeff(1) ;
+    for (int j = 0 ; j < numCols ; j++) {
+        setBounds(api.setColBnds_, prob_, j+1,
+                  (colLower == nullptr) ? 0.0 : colLower[j],
+                  (colUpper == nullptr) ? glpkInfinity : colUpper[j]) ;
+        if (obj != nullptr && obj[j] != 0.0)
+            api.setObjCoef_(prob_, j+1, obj[j]) ;
+        if (integer != nullptr && integer[j] != 0 &&
+                api.setColKind_ != nullptr)
+            api.setColKind_(prob_, j+1, GlpkConst::integerVar) ;
+        const int len = (length == nullptr) ? start[j+1]-start[j] : length[j] ;
+        if (len <= 0) continue ;
+        if (ndx.size() < static_cast<size_t>(len)+1) {
+            ndx.resize(len+1) ;
+            coeff.resize(len+1) ;
+        }
+        for (int k = 0 ; k < len ; k++) {
+            ndx[k+1] = index[start[j]+k]+1 ;
+            coeff[k+1] = value[start[j]+k] ;
+        }
+        api.setMatCol_(prob_, j+1, len, &ndx[0], &coeff[0]) ;
+    }
+    /*
+      glpk's objective constant is added; the mps offset is subtracted.
+    */
+    if (objOffset != 0.0) api.setObjCoef_(prob_, 0, -objOffset) ;
+}
+
+int ProbMgmtAPI_Glpk::loadProblem (int numCols, int numRows,
+                                   const int *start, const int *index,
+                                   const double *value,
+                                   const double *colLower,
+                                   const double *colUpper, const double *obj,
+                                   const double *rowLower,
+                                   const double *rowUpper)
+{
+    load(numCols, numRows, start, nullptr, index, value, colLower, colUpper,
+         obj, rowLower, rowUpper, 0.0, nullptr) ;
+    OSI2_PLUGIN_LOG(log_, 3)
+	<< "Loaded " << numRows << " x " << numCols << " problem." ;
+    return (0) ;
+}
+
+/*
+  load copies the arrays, so the snapshot can go as soon as the problem is
+  loaded.
+*/
+int ProbMgmtAPI_Glpk::readSnapshot (const char *path)
+{
+    ModelSnapshot snap ;
+    if (snap.read(path) != 0) {
+        OSI2_PLUGIN_LOG(log_, 1) << snap.getError() ;
+        return (-1) ;
+    }
+    const ModelSnapshot::Problem &prob = snap.getProblem() ;
+    load(prob.numCols_, prob.numRows_, prob.start_, prob.length_,
+         prob.index_, prob.value_, prob.colLower_, prob.colUpper_,
+         prob.obj_, prob.rowLower_, prob.rowUpper_, prob.objOffset_,
+         prob.integer_) ;
+    if (glpkApi_->setObjDir_ != nullptr)
+        glpkApi_->setObjDir_(prob_, (prob.objSense_ < 0) ?
+                             GlpkConst::maximise : GlpkConst::minimise) ;
+    if (prob.problemName_ != nullptr && glpkApi_->setProbName_ != nullptr)
+        glpkApi_->setProbName_(prob_, prob.problemName_) ;
+    OSI2_PLUGIN_LOG(log_, 3)
+        << "Read snapshot " << path << ", " << prob.numRows_ << " x "
+        << prob.numCols_ << "." ;
+    return (0) ;
+}
+
+bool ProbMgmtAPI_Glpk::setCancelToken (const CancelToken &token)
+{
+    cancel_ = token ;
+    return (false) ;
+}
+
+/*
+  Solve a problem, and translate glpk's answer into clp's status codes.
+*/
+int ProbMgmtAPI_Glpk::initialSolve ()
+{
+    TraceSpan span("solver", "initialSolve") ;
+    const CancelToken::Reason reason = cancel_.getStopReason() ;
+    if (reason != CancelToken::None) {
+        OSI2_PLUGIN_LOG(log_, 3)
+            << "Solve not started; "
+            << ((reason == CancelToken::Cancelled) ?
+                    "cancelled." : "deadline passed.") ;
+        return ((reason == CancelToken::Cancelled) ? 5 : 3) ;
+    }
+    const int failure = glpkApi_->simplex_(prob_, nullptr) ;
+    int retval ;
+    if (failure == GlpkConst::iterationLimit ||
+            failure == GlpkConst::timeLimit) {
+        retval = 3 ;
+    } else if (failure != 0) {
+        retval = 4 ;
+    } else {
+        switch (glpkApi_->getStatus_(prob_)) {
+        case GlpkConst::optimal:
+            retval = 0 ;
+            break ;
+        case GlpkConst::infeasible:
+        case GlpkConst::noFeasible:
+            retval = 1 ;
+            break ;
+        case GlpkConst::unbounded:
+            retval = 2 ;
+            break ;
+        default:
+            retval = 3 ;
+            break ;
+        }
+    }
+    if (failure != 0) {
+	OSI2_PLUGIN_LOG(log_, 1)
+	    << "Solve failed; glpk error " << failure << "." ;
+    } else {
+	OSI2_PLUGIN_LOG(log_, 3)
+	    << "Solved; return status " << retval << "." ;
+    }
+    return (retval) ;
+}
+
+}
@@ -0,0 +1,118 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ProbMgmtAPI_Glpk.hpp
+    \brief Declarations for glpk implementation of Osi2::ProbMgmtAPI
+*/
+#ifndef Osi2ProbMgmtAPI_Glpk_HPP
+#define Osi2ProbMgmtAPI_Glpk_HPP
+
+#include <string>
+#include <vector>
+
+#include "Osi2GlpkCApi.hpp"
+#include "Osi2MpsReader.hpp"
+#include "Osi2PluginLog.hpp"
+
+#include "Osi2API.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
+
+namespace Osi2 {
+
+/*! \brief Problem management through the glpk C interface
+
+  Capable of loading and solving a problem, like ProbMgmtAPI_Clp. Bounds
+  of magnitude 1e30 or more are taken as infinite.
+*/
+class ProbMgmtAPI_Glpk : public ProbMgmtAPI {
+
+public:
+    /*! \brief Constructor with a glpk problem object
+
+      \p glpkApi is the shim's table of glpk entry points (see
+      GlpkShim::getGlpkApi); it must outlive the object. The object takes
+      ownership of \p prob. Messages go to \p log (see GlpkShim::getLog).
+    */
+    ProbMgmtAPI_Glpk(const GlpkCApi *glpkApi, GlpkProb *prob,
+                     const PluginLog &log) ;
+
+    /// Destructor
+    virtual ~ProbMgmtAPI_Glpk() ;
+
+    /*! \brief Read an mps file from the given filename
+
+      The file is read with MpsReader, as for ProbMgmtAPI_Clp. What
+      MpsReader can't handle goes to glp_read_mps (free format), unless the
+      input was a stream that's already been consumed.
+    */
+    int readMps(const char *filename, bool keepNames = false,
+                bool ignoreErrors = false) ;
+
+    /// Load a problem from column-major arrays; see ProbMgmtAPI::loadProblem
+    int loadProblem(int numCols, int numRows, const int *start,
+                    const int *index, const double *value,
+                    const double *colLower, const double *colUpper,
+                    const double *obj, const double *rowLower,
+                    const double *rowUpper) ;
+
+    /*! \brief Load the problem in a binary snapshot
+
+      The problem, offset and integrality are loaded; glpk has no use for
+      the clp basis a snapshot may hold.
+    */
+    int readSnapshot(const char *path) ;
+
+    /*! \brief Solve an lp with glp_simplex
+
+      Returns the status as ProbMgmtAPI_Clp does (ClpModel::status()): 0
+      optimal, 1 primal infeasible, 2 dual infeasible (unbounded), 3
+      stopped on a limit, 4 stopped on error. If the CancelToken says to
+      stop before the solve starts, returns 5 (cancelled) or 3 (deadline
+      passed) without solving.
+    */
+    int initialSolve() ;
+
+    /*! \brief Attach \p token to the object
+
+      glp_simplex can't be stopped part way, so the token is looked at
+      before each solve starts. Returns false.
+    */
+    bool setCancelToken(const CancelToken &token) ;
+
+private:
+    /*! \brief Replace the problem with the one given
+
+      Columns run from <tt>start[j]</tt> for <tt>length[j]</tt> entries;
+      if \p length is null, to <tt>start[j+1]</tt>. Null bound and
+      objective arrays take the ProbMgmtAPI::loadProblem defaults.
+    */
+    void load(int numCols, int numRows, const int *start, const int *length,
+              const int *index, const double *value,
+              const double *colLower, const double *colUpper,
+              const double *obj, const double *rowLower,
+              const double *rowUpper, double objOffset,
+              const char *integer) ;
+
+    /// Set the names of the problem, rows and columns read by \p reader
+    void loadNames(const MpsReader &reader) ;
+
+  /*! \name Dynamic object management information */
+  //@{
+    /// The glpk C interface, shared with the shim and its other objects
+    const GlpkCApi *glpkApi_ ;
+    /// glpk problem object
+    GlpkProb *prob_ ;
+    /// The plugin manager's log service
+    PluginLog log_ ;
+    /// The token attached by #setCancelToken
+    CancelToken cancel_ ;
+  //@}
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
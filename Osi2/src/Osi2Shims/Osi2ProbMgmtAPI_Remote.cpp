@@ -0,0 +1,246 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ProbMgmtAPI_Remote.cpp
+    \brief Method definitions for Osi2ProbMgmtAPI_Remote
+
+  Method definitions for ProbMgmtAPI_Remote, an implementation of the
+  problem management API that forwards the work to a remote node.
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+
+#include "Osi2RemoteWire.hpp"
+#include "Osi2MpsReader.hpp"
+#include "Osi2RemoteShim.hpp"
+#include "Osi2ProbMgmtAPI_Remote.hpp"
+
+namespace {
+
+/*
+  The node must see how the file is compressed, and it can only tell from
+  the name.
+*/
+std::string compressionSuffix (const std::string &filename)
+{
+    const char *suffixes[] = { ".gz", ".bz2" } ;
+    for (size_t i = 0 ; i < sizeof(suffixes)/sizeof(suffixes[0]) ; i++) {
+        const std::string suffix = suffixes[i] ;
+        if (filename.size() > suffix.size() &&
+                filename.compare(filename.size()-suffix.size(),
+                                 suffix.size(), suffix) == 0)
+            return (suffix) ;
+    }
+    return ("") ;
+}
+
+bool readFile (const std::string &filename, std::vector<char> &content)
+{
+    std::ifstream file(filename.c_str(), std::ios::in|std::ios::binary) ;
+    if (!file) return (false) ;
+    content.assign(std::istreambuf_iterator<char>(file),
+                   std::istreambuf_iterator<char>()) ;
+    return (!file.bad()) ;
+}
+
+}   // end unnamed file-local namespace
+
+namespace Osi2 {
+
+ProbMgmtAPI_Remote::ProbMgmtAPI_Remote (RemoteShim *shim,
+                                        const std::string &apiName)
+    : RemoteLink(shim, apiName),
+      haveModel_(false),
+      keepNames_(false),
+      ignoreErrors_(false),
+      numRows_(-1),
+      numCols_(-1)
+{ }
+
+ProbMgmtAPI_Remote::~ProbMgmtAPI_Remote ()
+{ }
+
+int ProbMgmtAPI_Remote::readMps (const char *filename, bool keepNames,
+                                 bool ignoreErrors)
+{
+    filename_ = filename ;
+    keepNames_ = keepNames ;
+    ignoreErrors_ = ignoreErrors ;
+    problem_.clear() ;
+    numRows_ = -1 ;
+    numCols_ = -1 ;
+    const int retval = loadModel() ;
+    haveModel_ = (retval == 0) ;
+    if (retval) {
+        OSI2_PLUGIN_LOG(shim_->getLog(), 1)
+            << "Failure to read " << filename << ", error " << retval << "." ;
+    }
+    return (retval) ;
+}
+
+/*
+  The arrays are packed once here and kept, so that the object can move
+  without the caller's arrays.
+*/
+int ProbMgmtAPI_Remote::loadProblem (int numCols, int numRows,
+                                     const int *start, const int *index,
+                                     const double *value,
+                                     const double *colLower,
+                                     const double *colUpper,
+                                     const double *obj,
+                                     const double *rowLower,
+                                     const double *rowUpper)
+{
+    haveModel_ = false ;
+    if (numCols < 0 || numRows < 0 || start == nullptr) return (-1) ;
+    filename_.clear() ;
+    wirePackProblem(problem_, numCols, numRows, start, index, value,
+                    colLower, colUpper, obj, rowLower, rowUpper) ;
+    numRows_ = numRows ;
+    numCols_ = numCols ;
+    const int retval = loadModel() ;
+    haveModel_ = (retval == 0) ;
+    if (retval) {
+        OSI2_PLUGIN_LOG(shim_->getLog(), 1)
+            << "Failure to load problem, error " << retval << "." ;
+    }
+    return (retval) ;
+}
+
+/*
+  If the node goes away, the model is read again elsewhere and the solve
+  repeated. Every node gets one chance.
+*/
+int ProbMgmtAPI_Remote::initialSolve ()
+{
+    if (!haveModel_) return (-1) ;
+    for (int attempt = 0 ; attempt <= shim_->getNumNodes() ; attempt++) {
+        if (!isConnected() && loadModel() != 0) break ;
+        WireWriter(request_).putInt(RemoteInitialSolve) ;
+        int64_t status = -1 ;
+        if (call(status) == 0) return (static_cast<int>(status)) ;
+    }
+    OSI2_PLUGIN_LOG(shim_->getLog(), 1)
+        << "Solve failed; no remote node available." ;
+    return (-1) ;
+}
+
+/*
+  As initialSolve, but a node that has to load the model solves it once
+  before the batch.
+*/
+int ProbMgmtAPI_Remote::resolveBatch (BatchKind kind, int numVariants,
+                                      const double *variants, int *statuses,
+                                      double *objValues,
+                                      double *colSolutions)
+{
+    if (!haveModel_ || numVariants <= 0 || variants == nullptr ||
+            statuses == nullptr || objValues == nullptr ||
+            (kind != BatchRhs && kind != BatchObjective))
+        return (-1) ;
+    if (numCols_ < 0 && findSize() != 0) return (-1) ;
+    const size_t len = (kind == BatchRhs) ? numRows_ : numCols_ ;
+    for (int attempt = 0 ; attempt <= shim_->getNumNodes() ; attempt++) {
+        int64_t status = -1 ;
+        if (!isConnected()) {
+            if (loadModel() != 0) break ;
+            WireWriter(request_).putInt(RemoteInitialSolve) ;
+            if (call(status) < 0) continue ;
+        }
+        WireWriter(request_).putInt(RemoteResolveBatch)
+            .putInt(kind).putInt(numVariants)
+            .putInt(numRows_).putInt(numCols_)
+            .putDoubles(variants, numVariants*len)
+            .putInt(colSolutions != nullptr) ;
+        if (call(status) < 0) continue ;
+        if (status < 0) return (static_cast<int>(status)) ;
+        if (takeBatchReply(numVariants, statuses, objValues,
+                           colSolutions) < 0) {
+            OSI2_PLUGIN_LOG(shim_->getLog(), 1)
+                << "Bad reply to a batch from the remote node." ;
+            return (-1) ;
+        }
+        return (static_cast<int>(status)) ;
+    }
+    OSI2_PLUGIN_LOG(shim_->getLog(), 1)
+        << "Batch failed; no remote node available." ;
+    return (-1) ;
+}
+
+/*
+  A model read from a file travels as the file.
+*/
+int ProbMgmtAPI_Remote::loadModel ()
+{
+    if (filename_.empty()) return (sendModel(problem_, "")) ;
+    std::vector<char> content ;
+    if (!readFile(filename_, content)) return (-1) ;
+    return (sendModel(content, compressionSuffix(filename_))) ;
+}
+
+void ProbMgmtAPI_Remote::putLoadRequest (uint64_t hash)
+{
+    if (filename_.empty()) {
+        WireWriter(request_).putInt(RemoteLoadProblem)
+            .putInt(static_cast<int64_t>(hash)) ;
+    } else {
+        WireWriter(request_).putInt(RemoteReadMps)
+            .putInt(static_cast<int64_t>(hash))
+            .putInt(keepNames_).putInt(ignoreErrors_) ;
+    }
+}
+
+/*
+  Only the node holds the model, and the API has no way to ask its size, so
+  read the file again here. This happens once per model.
+*/
+int ProbMgmtAPI_Remote::findSize ()
+{
+    MpsReader reader ;
+    if (reader.readFile(filename_) != 0) {
+        OSI2_PLUGIN_LOG(shim_->getLog(), 1)
+            << "Failure to read " << filename_ << " for its size." ;
+        return (-1) ;
+    }
+    numRows_ = reader.getNumRows() ;
+    numCols_ = reader.getNumCols() ;
+    return (0) ;
+}
+
+/*
+  The node sized the arrays from what we sent, but check them anyway before
+  copying into the caller's.
+*/
+int ProbMgmtAPI_Remote::takeBatchReply (int numVariants, int *statuses,
+                                        double *objValues,
+                                        double *colSolutions)
+{
+    WireReader in(reply_) ;
+    in.getInt() ;
+    std::vector<int> gotStatuses ;
+    std::vector<double> gotObjValues ;
+    std::vector<double> gotSolutions ;
+    const int64_t numSolutions = static_cast<int64_t>(numVariants)*numCols_ ;
+    if (in.getInts(gotStatuses) != numVariants ||
+            in.getDoubles(gotObjValues) != numVariants)
+        return (-1) ;
+    const int64_t gotLen = in.getDoubles(gotSolutions) ;
+    if (!in.ok()) return (-1) ;
+    std::copy(gotStatuses.begin(), gotStatuses.end(), statuses) ;
+    std::copy(gotObjValues.begin(), gotObjValues.end(), objValues) ;
+    if (colSolutions != nullptr) {
+        if (std::max<int64_t>(gotLen, 0) != numSolutions) return (-1) ;
+        std::copy(gotSolutions.begin(), gotSolutions.end(), colSolutions) ;
+    }
+    return (0) ;
+}
+
+}  // end namespace Osi2
@@ -0,0 +1,115 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2ProbMgmtAPI_Remote.hpp
+    \brief Declarations for the remote implementation of Osi2::ProbMgmtAPI
+*/
+#ifndef Osi2ProbMgmtAPI_Remote_HPP
+#define Osi2ProbMgmtAPI_Remote_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Osi2API.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
+#include "Osi2RemoteLink.hpp"
+
+namespace Osi2 {
+
+/*! \brief ProbMgmtAPI on a remote node
+
+  The object lives on a node chosen by the shim when the model is read.
+  readMps reads the file here and sends its content to the node only if the
+  node doesn't already hold it; loadProblem packs the arrays and sends them
+  the same way, so the same arrays go to a node once. If the node stops
+  answering, the object moves: the model is read again on another node and
+  the call is repeated. A batch that moves is solved once first, so it
+  starts from the model as loaded rather than from where the lost node had
+  got to.
+*/
+class ProbMgmtAPI_Remote : public ProbMgmtAPI, private RemoteLink {
+
+public:
+    /// Constructor; \p apiName is the API requested of the node
+    ProbMgmtAPI_Remote(RemoteShim *shim, const std::string &apiName) ;
+
+    /// Destructor; destroys the object on the node
+    virtual ~ProbMgmtAPI_Remote() ;
+
+    /// Read an mps file from the given filename
+    int readMps(const char *filename, bool keepNames = false,
+                bool ignoreErrors = false) ;
+
+    /// Load a problem from arrays in memory
+    int loadProblem(int numCols, int numRows, const int *start,
+                    const int *index, const double *value,
+                    const double *colLower, const double *colUpper,
+                    const double *obj, const double *rowLower,
+                    const double *rowUpper) ;
+
+    /*! \brief Solve an lp
+
+      See ClpModel::status() for the meaning of the return value.
+    */
+    int initialSolve() ;
+
+    /*! \brief Re-solve under each of a batch of right-hand sides or
+               objectives
+
+      Only the variants are sent; the node already holds the model. For a
+      model read from a file, the first batch reads the file here as well,
+      to learn the size of the model.
+    */
+    int resolveBatch(BatchKind kind, int numVariants,
+                     const double *variants, int *statuses,
+                     double *objValues, double *colSolutions = 0) ;
+
+private:
+
+    /// Copy constructor (not implemented)
+    ProbMgmtAPI_Remote(const ProbMgmtAPI_Remote &rhs) ;
+    /// Assignment (not implemented)
+    ProbMgmtAPI_Remote &operator=(const ProbMgmtAPI_Remote &rhs) ;
+
+    /*! \brief Read the model on a node, connecting to one if need be
+
+      Returns the node's readMps (or loadProblem) status, or -1 if no node
+      could be reached.
+    */
+    int loadModel() ;
+
+    /// Build in #request_ the request that loads model \p hash
+    void putLoadRequest(uint64_t hash) ;
+
+    /// Learn #numRows_ and #numCols_ of a model read from a file
+    int findSize() ;
+
+    /// Copy the results of a batch out of #reply_
+    int takeBatchReply(int numVariants, int *statuses, double *objValues,
+                       double *colSolutions) ;
+
+    /*! \name The model
+
+      Remembered so the object can be rebuilt on another node. A model
+      loaded from arrays is kept packed in #problem_; #filename_ is then
+      empty. The size is -1 until known.
+    */
+    //@{
+    bool haveModel_ ;
+    std::string filename_ ;
+    bool keepNames_ ;
+    bool ignoreErrors_ ;
+    std::vector<char> problem_ ;
+    int numRows_ ;
+    int numCols_ ;
+    //@}
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,135 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RemoteLink.cpp
+    \brief Method definitions for Osi2::RemoteLink
+*/
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+
+#include "Osi2RemoteWire.hpp"
+#include "Osi2RemoteShim.hpp"
+#include "Osi2RemoteLink.hpp"
+
+namespace Osi2 {
+
+RemoteLink::RemoteLink (RemoteShim *shim, const std::string &apiName)
+    : shim_(shim),
+      apiName_(apiName),
+      sock_(-1),
+      node_(-1)
+{ }
+
+RemoteLink::RemoteLink (const RemoteLink &rhs)
+    : shim_(rhs.shim_),
+      apiName_(rhs.apiName_),
+      sock_(-1),
+      node_(-1)
+{ }
+
+/*
+  Closing the connection destroys the object on the node.
+*/
+RemoteLink::~RemoteLink ()
+{
+    disconnect(false) ;
+}
+
+/*
+  Ask for the model by hash; send the content only if the node doesn't have
+  it. A node that stops answering is left out and we start over on another.
+*/
+int RemoteLink::sendModel (const std::vector<char> &content,
+                           const std::string &suffix)
+{
+    const char *data = content.empty() ? "" : &content[0] ;
+    const uint64_t hash = contentHash(data, content.size()) ;
+    std::vector<bool> excluded(shim_->getNumNodes(), false) ;
+    for (;;) {
+        if (sock_ < 0 && connect(hash, excluded) < 0) return (-1) ;
+        const int node = node_ ;
+        int64_t status = -1 ;
+        putLoadRequest(hash) ;
+        if (call(status) < 0) {
+            excluded[node] = true ;
+            continue ;
+        }
+        if (status == remoteUnknownModel) {
+            WireWriter(request_).putInt(RemotePutModel)
+                .putInt(static_cast<int64_t>(hash))
+                .putStr(suffix)
+                .putBytes(data, content.size()) ;
+            if (call(status) < 0) {
+                excluded[node] = true ;
+                continue ;
+            }
+            if (status < 0) return (-1) ;
+            putLoadRequest(hash) ;
+            if (call(status) < 0) {
+                excluded[node] = true ;
+                continue ;
+            }
+        }
+        if (status != remoteUnknownModel) shim_->noteModel(node, hash) ;
+        return (static_cast<int>(status)) ;
+    }
+}
+
+int RemoteLink::connect (uint64_t hash, std::vector<bool> &excluded)
+{
+    std::string host ;
+    int port = 0 ;
+    int node ;
+    while ((node = shim_->pickNode(hash, excluded, host, port)) >= 0) {
+        excluded[node] = true ;
+        std::string errStr ;
+        const int sock = wireConnect(host, port, errStr) ;
+        if (sock < 0) {
+            OSI2_PLUGIN_LOG(shim_->getLog(), 1) << errStr << "." ;
+            shim_->releaseNode(node, true) ;
+            continue ;
+        }
+        sock_ = sock ;
+        node_ = node ;
+        WireWriter(request_).putInt(RemoteOpen)
+            .putInt(remoteWireVersion).putStr(apiName_) ;
+        int64_t status = -1 ;
+        if (call(status) < 0) continue ;
+        if (status == 0) return (0) ;
+        OSI2_PLUGIN_LOG(shim_->getLog(), 1)
+            << "Node " << host << ":" << port << " cannot supply "
+            << apiName_ << "." ;
+        disconnect(true) ;
+    }
+    return (-1) ;
+}
+
+void RemoteLink::disconnect (bool failed)
+{
+    if (sock_ < 0) return ;
+    wireClose(sock_) ;
+    shim_->releaseNode(node_, failed) ;
+    sock_ = -1 ;
+    node_ = -1 ;
+}
+
+int RemoteLink::call (int64_t &status)
+{
+    if (wireSend(sock_, request_) < 0 || wireRecv(sock_, reply_) < 0) {
+        disconnect(true) ;
+        return (-1) ;
+    }
+    WireReader in(reply_) ;
+    status = in.getInt() ;
+    if (!in.ok()) {
+        disconnect(true) ;
+        return (-1) ;
+    }
+    return (0) ;
+}
+
+}  // end namespace Osi2
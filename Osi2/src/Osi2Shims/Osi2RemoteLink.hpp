@@ -0,0 +1,103 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RemoteLink.hpp
+    \brief Declarations for Osi2::RemoteLink, the connection behind a remote
+           object
+*/
+#ifndef Osi2RemoteLink_HPP
+#define Osi2RemoteLink_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Osi2 {
+
+class RemoteShim ;
+
+/*! \brief The connection between a remote object and its node
+
+  Common to the objects of RemoteShim. It picks a node, opens the object
+  there, sends a model only if the node doesn't already hold it, and drops
+  a node that stops answering. The object supplies the request that loads
+  a model (#putLoadRequest) and builds its other requests in #request_.
+*/
+class RemoteLink {
+
+protected:
+
+    /// Constructor; \p apiName is the API requested of the node
+    RemoteLink(RemoteShim *shim, const std::string &apiName) ;
+
+    /*! \brief Copy constructor
+
+      The copy has no connection; it opens its own when it first needs one.
+    */
+    RemoteLink(const RemoteLink &rhs) ;
+
+    /// Destructor; destroys the object on the node
+    virtual ~RemoteLink() ;
+
+    /*! \brief Load a model on a node, connecting to one if need be
+
+      \p content is the model as it travels (see RemotePutModel), and
+      \p suffix tells the node how it's compressed. A node that stops
+      answering is left out and another tried. Returns the status of the
+      load request, or -1 if no node could be reached.
+    */
+    int sendModel(const std::vector<char> &content,
+                  const std::string &suffix) ;
+
+    /// Build in #request_ the request that loads model \p hash
+    virtual void putLoadRequest(uint64_t hash) = 0 ;
+
+    /*! \brief Open an object on a node suited to model \p hash
+
+      Nodes that have already failed this call (\p excluded) are passed
+      over. Returns 0 on success, -1 if no node would take the object.
+    */
+    int connect(uint64_t hash, std::vector<bool> &excluded) ;
+
+    /// Drop the connection; \p failed says the node is at fault
+    void disconnect(bool failed) ;
+
+    /*! \brief Send #request_ and wait for the status
+
+      Returns 0 with the status in \p status; -1 if the node has gone, in
+      which case the connection is dropped.
+    */
+    int call(int64_t &status) ;
+
+    /// True if there's a node holding the object
+    inline bool isConnected () const {
+        return (sock_ >= 0) ;
+    }
+
+    /// The shim that made us
+    RemoteShim *shim_ ;
+    /// API requested of the node
+    std::string apiName_ ;
+
+    /// Buffers, kept to avoid reallocation on every call
+    std::vector<char> request_ ;
+    std::vector<char> reply_ ;
+
+private:
+
+    /// Assignment (not implemented)
+    RemoteLink &operator=(const RemoteLink &rhs) ;
+
+    /// Connection to the node holding the object; -1 if none
+    int sock_ ;
+    /// Index of that node in the shim's pool
+    int node_ ;
+
+} ;
+
+}  // end namespace Osi2
+
+#endif
@@ -0,0 +1,224 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RemoteShim.cpp
+    \brief Method definitions for RemoteShim.
+
+  This shim hands the work to solver nodes elsewhere on the network. It
+  doesn't load a solver library.
+*/
+
+#include <cstdlib>
+
+#include "Osi2RemoteShim.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2RemoteWire.hpp"
+
+#include "Osi2ProbMgmtAPI_Remote.hpp"
+#include "Osi2Osi1API_Remote.hpp"
+
+using namespace Osi2 ;
+
+/*
+  Default constructor.
+*/
+RemoteShim::RemoteShim ()
+    : ourID_(0)
+{ }
+
+void RemoteShim::addNode (const std::string &host, int port)
+{
+    Node node ;
+    node.host_ = host ;
+    node.port_ = port ;
+    node.load_ = 0 ;
+    node.failed_ = false ;
+    ScopedLock lock(mutex_) ;
+    nodes_.push_back(node) ;
+}
+
+/*
+  Nodes that failed last time are considered only if there's nothing else.
+  Among the rest, a node that holds the model wins if it's within one object
+  of the least busy node; sending a model costs more than a little waiting.
+*/
+int RemoteShim::pickNode (uint64_t hash, const std::vector<bool> &excluded,
+                          std::string &host, int &port)
+{
+    ScopedLock lock(mutex_) ;
+    const int numNodes = static_cast<int>(nodes_.size()) ;
+    bool anyHealthy = false ;
+    for (int i = 0 ; i < numNodes ; i++) {
+        if (!excluded[i] && !nodes_[i].failed_) anyHealthy = true ;
+    }
+    int leastBusy = -1 ;
+    int holder = -1 ;
+    for (int i = 0 ; i < numNodes ; i++) {
+        const Node &node = nodes_[i] ;
+        if (excluded[i] || (anyHealthy && node.failed_)) continue ;
+        if (leastBusy < 0 || node.load_ < nodes_[leastBusy].load_)
+            leastBusy = i ;
+        if (node.models_.count(hash) != 0 &&
+                (holder < 0 || node.load_ < nodes_[holder].load_))
+            holder = i ;
+    }
+    int chosen = leastBusy ;
+    if (holder >= 0 && nodes_[holder].load_ <= nodes_[leastBusy].load_+1)
+        chosen = holder ;
+    if (chosen < 0) return (-1) ;
+    Node &node = nodes_[chosen] ;
+    node.load_++ ;
+    host = node.host_ ;
+    port = node.port_ ;
+    return (chosen) ;
+}
+
+/*
+  A failed node may have lost its cache, too.
+*/
+void RemoteShim::releaseNode (int node, bool failed)
+{
+    ScopedLock lock(mutex_) ;
+    Node &target = nodes_[node] ;
+    target.load_-- ;
+    target.failed_ = failed ;
+    if (failed) target.models_.clear() ;
+}
+
+void RemoteShim::noteModel (int node, uint64_t hash)
+{
+    ScopedLock lock(mutex_) ;
+    nodes_[node].models_.insert(hash) ;
+}
+
+/*! \brief Object factory
+
+  Create objects to satisfy the Osi2 API specified as the \p objectType
+  member of \p params.
+*/
+void *RemoteShim::create (const ObjectParams *params)
+{
+    std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
+    RemoteShim *shim = static_cast<RemoteShim*>(params->ctrlObj_) ;
+
+    if (what == "ProbMgmt") {
+        ProbMgmtAPI *probMgmt = new ProbMgmtAPI_Remote(shim, what) ;
+        return (probMgmt) ;
+    } else if (what == "Osi1") {
+        Osi1API *osi = new Osi1API_Remote(shim, what) ;
+        return (osi) ;
+    }
+    OSI2_PLUGIN_LOG(shim->getLog(), 1)
+            << "Remote create: unrecognised type " << what << "." ;
+    return (nullptr) ;
+}
+
+/*! \brief Capability check
+
+  The same list of APIs recognised by #create, but nothing is created.
+*/
+int32_t RemoteShim::canCreate (const ObjectParams *params)
+{
+    std::string what = reinterpret_cast<const char *>(params->apiStr_) ;
+
+    return (what == "ProbMgmt" || what == "Osi1") ;
+}
+
+/*! \brief Object destructor
+
+  RemoteShim only hands out C++ objects that are derived from Osi2::API;
+  deleting one closes its connection, which destroys the object on the node.
+*/
+int32_t RemoteShim::destroy (void *victim, const ObjectParams *objParms)
+{
+    API *api = static_cast<API *>(victim) ;
+    delete api ;
+
+    return (0) ;
+}
+
+
+/*
+  Plugin initialisation method. Build the pool of nodes from the
+  environment, then register. A shim with no nodes has nothing to offer and
+  fails to initialise.
+*/
+extern "C"
+ExitFunc initPlugin (PlatformServices *services)
+{
+    PluginLog log ;
+    log.init(services) ;
+    OSI2_PLUGIN_LOG(log, 4) << "Executing RemoteShim::initPlugin." ;
+    if (!wireIsSupported()) {
+        OSI2_PLUGIN_LOG(log, 1)
+                << "Remote solvers are not supported on this platform." ;
+        return (nullptr) ;
+    }
+    const char *spec = std::getenv("OSI2_REMOTE_NODES") ;
+    std::vector<std::pair<std::string, int> > nodes ;
+    if (spec == nullptr ||
+            !parseNodeList(spec, RemoteShim::dfltPort, nodes) ||
+            nodes.empty()) {
+        OSI2_PLUGIN_LOG(log, 1)
+                << "OSI2_REMOTE_NODES must list at least one node as "
+                << "host:port." ;
+        return (nullptr) ;
+    }
+    RemoteShim *shim = new RemoteShim() ;
+    shim->setPluginID(services->pluginID_) ;
+    shim->setLog(log) ;
+    for (size_t i = 0 ; i < nodes.size() ; i++)
+        shim->addNode(nodes[i].first, nodes[i].second) ;
+    services->ctrlObj_ = static_cast<PluginState *>(shim) ;
+
+    RegisterParams reginfo ;
+    reginfo.ctrlObj_ = static_cast<PluginState *>(shim) ;
+    reginfo.version_.major_ = 1 ;
+    reginfo.version_.minor_ = remoteWireVersion ;
+    reginfo.lang_ = Plugin_CPP ;
+    reginfo.pluginID_ = shim->getPluginID() ;
+    reginfo.createFunc_ = RemoteShim::create ;
+    reginfo.destroyFunc_ = RemoteShim::destroy ;
+    reginfo.capabilityFunc_ = RemoteShim::canCreate ;
+    reginfo.bulkCreateFunc_ = nullptr ;
+    /*
+      What a remote object can solve is up to the node at the other end, so
+      claim nothing; the cost of a connection keeps a local library ahead
+      when the client asks for nothing in particular.
+    */
+    reginfo.caps_.problems_ = 0 ;
+    reginfo.caps_.props_ = 0 ;
+    reginfo.caps_.createCost_ = 1000 ;
+    reginfo.caps_.solveCost_ = 0 ;
+    const char *apis[] = { "ProbMgmt", "Osi1" } ;
+    for (size_t i = 0 ; i < sizeof(apis)/sizeof(apis[0]) ; i++) {
+        int retval =
+            services->registerObject_(
+                reinterpret_cast<const unsigned char*>(apis[i]), &reginfo) ;
+        if (retval < 0) {
+            OSI2_PLUGIN_LOG(log, 1)
+                    << "Apparent failure to register " << apis[i]
+                    << " plugin." ;
+            services->ctrlObj_ = nullptr ;
+            delete shim ;
+            return (nullptr) ;
+        }
+    }
+
+    return (cleanupPlugin) ;
+}
+
+/*
+  Plugin cleanup method. The library is about to be unloaded, taking the
+  objects' code with it, so the shim's state can go too.
+*/
+extern "C" int32_t cleanupPlugin (const PlatformServices *services)
+{
+    delete static_cast<RemoteShim *>(services->ctrlObj_) ;
+    return (0) ;
+}
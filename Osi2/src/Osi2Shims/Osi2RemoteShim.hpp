@@ -0,0 +1,175 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+*/
+/*! \file Osi2RemoteShim.hpp
+    \brief Declarations for Osi2::RemoteShim.
+
+  This shim doesn't solve anything itself. It hands the work to solver nodes
+  elsewhere on the network (see Osi2::RemoteNode).
+*/
+
+#ifndef Osi2RemoteShim_H
+#define Osi2RemoteShim_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "Osi2Plugin.hpp"
+#include "Osi2PluginLog.hpp"
+#include "Osi2Threads.hpp"
+
+namespace Osi2 {
+
+/*! \brief Shim for remote solver nodes
+
+  Supplies ProbMgmtAPI and Osi1API objects whose work is done on a pool of
+  remote nodes. The nodes are named by the environment variable
+  \c OSI2_REMOTE_NODES when the shim is initialised: a list of \c host:port
+  (#dfltPort if the port is omitted), separated by commas or spaces. The
+  client code is unchanged; it asks for a ProbMgmt or Osi1 object and gets
+  one. An Osi1 object forwards only a core of the API; see Osi1API_Remote.
+
+  Each object is placed on a node when it first needs one: a ProbMgmt
+  object when it reads its model, an Osi1 object when it first solves. A
+  node that already holds the model (see RemoteNode) is preferred, unless
+  it's busier than the least busy node by more than one object; otherwise
+  the least busy node gets the object. A node that can't be reached is
+  passed over.
+*/
+
+class RemoteShim {
+
+public:
+
+    /// Port used for a node given without one
+    static const int dfltPort = 7170 ;
+
+    /// Default constructor
+    RemoteShim() ;
+
+    /*! \brief Object factory
+
+      Create objects to satisfy the Osi2 API specified as the \p objectType
+      member of \p params.
+    */
+    static void *create (const ObjectParams *params) ;
+
+    /*! \brief Object destructor
+
+      Destroys objects created by this shim.
+    */
+    static int32_t destroy (void *victim, const ObjectParams *params) ;
+
+    /*! \brief Capability check
+
+      Returns nonzero if #create can supply the API specified in \p params.
+    */
+    static int32_t canCreate (const ObjectParams *params) ;
+
+    /// Set our unique ID (supplied by the plugin manager)
+    inline void setPluginID (PluginUniqueID id) {
+        ourID_ = id ;
+    }
+    /// Get our unique ID
+    inline PluginUniqueID getPluginID () const {
+        return (ourID_) ;
+    }
+    /// Set the plugin manager's log service
+    inline void setLog (const PluginLog &log) {
+        log_ = log ;
+    }
+    /// The plugin manager's log service
+    inline const PluginLog &getLog () const {
+        return (log_) ;
+    }
+
+    /// \name Nodes
+    //@{
+    /// Add a node to the pool
+    void addNode(const std::string &host, int port) ;
+
+    /// Number of nodes in the pool
+    inline int getNumNodes () const {
+        return (static_cast<int>(nodes_.size())) ;
+    }
+
+    /*! \brief Choose a node for an object that will read model \p hash
+
+      Nodes with \p excluded set are not considered. The chosen node is
+      charged with one more object until #releaseNode. Returns the index of
+      the node, with its address in \p host and \p port, or -1 if there's no
+      node left to choose.
+    */
+    int pickNode(uint64_t hash, const std::vector<bool> &excluded,
+                 std::string &host, int &port) ;
+
+    /*! \brief An object leaves node \p node
+
+      If \p failed, the node couldn't be reached or stopped answering; it's
+      passed over until it is the only choice left.
+    */
+    void releaseNode(int node, bool failed) ;
+
+    /// Note that node \p node now holds model \p hash
+    void noteModel(int node, uint64_t hash) ;
+    //@}
+
+private:
+
+    /// Our registration ID from the plugin manager
+    PluginUniqueID ourID_ ;
+
+    /// The plugin manager's log service
+    PluginLog log_ ;
+
+    /// One remote node
+    struct Node {
+        std::string host_ ;
+        int port_ ;
+        /// Objects placed on the node now
+        int load_ ;
+        /// True if the node failed the last time it was used
+        bool failed_ ;
+        /// Models the node is known to hold
+        std::set<uint64_t> models_ ;
+    } ;
+
+    /// The pool
+    std::vector<Node> nodes_ ;
+
+    /// Guards #nodes_
+    Mutex mutex_ ;
+
+} ;
+
+/*! \brief Plugin initialisation method
+    \relates RemoteShim
+
+  Given a parameter specifying the plugin manager's registration method,
+  constructs a registration parameter object and calls the registration
+  method.
+
+  This method needs to have C linkage so it can be easily loaded with
+  DynamicLibrary::getSymbol.
+*/
+extern "C"
+ExitFunc initPlugin (PlatformServices *services) ;
+
+/*! \brief Plugin cleanup method
+    \relates RemoteShim
+
+  This method handles any necessary cleanup prior to unloading the method. It
+  will be passed to the plugin manager and invoked just before the plugin
+  manager unloads the plugin.
+*/
+extern "C"
+int32_t cleanupPlugin (const PlatformServices *services) ;
+
+}  // end namespace Osi2
+
+#endif		// Osi2RemoteShim_H
@@ -0,0 +1,646 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+
+  Microbenchmarks for the OSI2 plugin framework. Built and run by `make
+  bench'; not part of the unit test.
+
+  Each benchmark is run with an increasing number of iterations until it
+  has run for at least the minimum time (--min_time, default 0.5 s), and the
+  time per iteration of the last run is reported. The report goes to the
+  console as a table and, with --json=FILE, to FILE in the JSON format of
+  Google Benchmark, so that its comparison tools can be used to track
+  regressions between releases. --filter=STRING runs only the benchmarks
+  whose names contain STRING.
+*/
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+
+#include "CoinTime.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2PluginManager.hpp"
+#include "Osi2ObjectAdapter.hpp"
+#include "Osi2PerfStats.hpp"
+#include "Osi2Threads.hpp"
+
+#include "Osi2ControlAPI_Imp.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
+#include "Osi2Osi1API.hpp"
+
+#ifdef COIN_HAS_OSICLP
+#include "OsiClpSolverInterface.hpp"
+#endif
+
+using namespace Osi2 ;
+
+namespace {
+
+const char *const lightShim = "libOsi2ClpShim.so" ;
+
+/*
+  The state handed to a benchmark: the number of iterations to run, and
+  the timer. A benchmark does its setup, calls startTimer, runs the
+  iterations, calls stopTimer, and cleans up. If it can't run, it says why
+  with skip.
+*/
+class BenchState {
+public:
+    BenchState (int iterations, int threadIndex)
+        : iterations_(iterations),
+          threadIndex_(threadIndex),
+          start_(0),
+          stop_(0),
+          cpuStart_(0.0),
+          cpuTime_(0.0),
+          items_(0)
+    { }
+    inline int iterations () const {
+        return (iterations_) ;
+    }
+    inline int threadIndex () const {
+        return (threadIndex_) ;
+    }
+    inline void startTimer () {
+        cpuStart_ = CoinCpuTime() ;
+        start_ = PerfStats::now() ;
+    }
+    inline void stopTimer () {
+        stop_ = PerfStats::now() ;
+        cpuTime_ = CoinCpuTime() - cpuStart_ ;
+    }
+    /// Record that the benchmark can't run, and why
+    inline void skip (const std::string &why) {
+        if (skipped_.empty()) skipped_ = why ;
+    }
+    /// Items processed in all; reported as a rate if nonzero
+    inline void setItemsProcessed (double items) {
+        items_ = items ;
+    }
+    int iterations_ ;
+    int threadIndex_ ;
+    uint64_t start_ ;
+    uint64_t stop_ ;
+    double cpuStart_ ;
+    double cpuTime_ ;
+    double items_ ;
+    std::string skipped_ ;
+} ;
+
+typedef void (*BenchFunc)(BenchState &state) ;
+
+/// A registered benchmark
+struct Bench {
+    std::string name_ ;
+    BenchFunc func_ ;
+    int threads_ ;
+} ;
+
+/// The result of a benchmark
+struct BenchResult {
+    std::string name_ ;
+    int iterations_ ;
+    double realNs_ ;
+    double cpuNs_ ;
+    double itemsPerSec_ ;
+    std::string skipped_ ;
+} ;
+
+std::vector<Bench> &allBenches ()
+{
+    static std::vector<Bench> benches ;
+    return (benches) ;
+}
+
+void registerBench (const std::string &name, BenchFunc func, int threads = 1)
+{
+    Bench bench ;
+    bench.name_ = name ;
+    bench.func_ = func ;
+    bench.threads_ = threads ;
+    allBenches().push_back(bench) ;
+}
+
+/*
+  Quiet, so that message output isn't what's measured.
+*/
+void quiet ()
+{
+    PluginManager::getInstance().setLogLvl(0) ;
+}
+
+/*
+  Load the light shim through the bare plugin manager. Returns its unique
+  ID, or null (and skips the benchmark) if it won't load.
+*/
+PluginUniqueID loadLight (BenchState &state)
+{
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    PluginUniqueID libID = nullptr ;
+    int retval = plugMgr.loadOneLib(lightShim, nullptr, &libID) ;
+    if (retval < 0 || libID == nullptr) {
+        state.skip(std::string("cannot load ") + lightShim) ;
+        return (nullptr) ;
+    }
+    return (libID) ;
+}
+
+/*
+  A two column, one row problem for the dispatch benchmarks.
+*/
+struct TinyLP {
+    TinyLP () {
+        start_[0] = 0 ;
+        start_[1] = 1 ;
+        start_[2] = 2 ;
+        index_[0] = 0 ;
+        index_[1] = 0 ;
+        value_[0] = 1.0 ;
+        value_[1] = 1.0 ;
+        colLower_[0] = colLower_[1] = 0.0 ;
+        colUpper_[0] = colUpper_[1] = 1.0 ;
+        obj_[0] = -1.0 ;
+        obj_[1] = -2.0 ;
+        rowLower_[0] = 0.0 ;
+        rowUpper_[0] = 1.5 ;
+    }
+    int start_[3] ;
+    int index_[2] ;
+    double value_[2] ;
+    double colLower_[2] ;
+    double colUpper_[2] ;
+    double obj_[2] ;
+    double rowLower_[1] ;
+    double rowUpper_[1] ;
+} ;
+
+// ---------------------------------------------------------------------
+// The benchmarks
+// ---------------------------------------------------------------------
+
+/*
+  Load and unload the light shim.
+*/
+void benchLoadUnload (BenchState &state)
+{
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    state.startTimer() ;
+    for (int i = 0 ; i < state.iterations() ; i++) {
+        if (plugMgr.loadOneLib(lightShim) < 0) {
+            state.skip(std::string("cannot load ") + lightShim) ;
+            break ;
+        }
+        plugMgr.unloadOneLib(lightShim) ;
+    }
+    state.stopTimer() ;
+}
+
+/*
+  Create and destroy one object per iteration through the API handle.
+  After the first request a wildcard supply is promoted to an exact match,
+  so the wildcard benchmark measures the steady state.
+*/
+void createDestroy (BenchState &state, const char *apiName)
+{
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    PluginUniqueID libID = loadLight(state) ;
+    if (libID == nullptr) return ;
+    const APIHandle api = plugMgr.getAPIHandle(apiName) ;
+    DummyAdapter adapter ;
+    state.startTimer() ;
+    for (int i = 0 ; i < state.iterations() ; i++) {
+        PluginUniqueID objLib = 0 ;
+        void *obj = plugMgr.createObject(api, objLib, adapter) ;
+        if (obj == nullptr || plugMgr.destroyObject(api, objLib, obj) < 0) {
+            state.skip(std::string("cannot create ") + apiName) ;
+            break ;
+        }
+    }
+    state.stopTimer() ;
+    state.setItemsProcessed(state.iterations()) ;
+}
+
+void benchCreateExact (BenchState &state)
+{
+    createDestroy(state, "ProbMgmt") ;
+}
+
+void benchCreateWildcard (BenchState &state)
+{
+    createDestroy(state, "WildProbMgmt") ;
+}
+
+/*
+  Ask for an API no plugin supplies. The wildcard plugin declines, and the
+  decline is cached, so this is the cost of a miss.
+*/
+void benchCreateDeclined (BenchState &state)
+{
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    if (loadLight(state) == nullptr) return ;
+    const APIHandle api = plugMgr.getAPIHandle("NoSuchAPI") ;
+    DummyAdapter adapter ;
+    state.startTimer() ;
+    for (int i = 0 ; i < state.iterations() ; i++) {
+        PluginUniqueID objLib = 0 ;
+        if (plugMgr.createObject(api, objLib, adapter) != nullptr) {
+            state.skip("NoSuchAPI was supplied") ;
+            break ;
+        }
+    }
+    state.stopTimer() ;
+}
+
+/*
+  Create and destroy through the control API, restricted to one library by
+  its short name.
+*/
+void benchCreateShortName (BenchState &state)
+{
+    ControlAPI_Imp ctrlAPI ;
+    ctrlAPI.setLogLvl(0) ;
+    if (ctrlAPI.load("clp") < 0) {
+        state.skip("cannot load clp") ;
+        return ;
+    }
+    const std::string shortName = "clp" ;
+    state.startTimer() ;
+    for (int i = 0 ; i < state.iterations() ; i++) {
+        API *obj = nullptr ;
+        if (ctrlAPI.createObject(obj, "ProbMgmt", &shortName) != 0 ||
+                ctrlAPI.destroyObject(obj) < 0) {
+            state.skip("cannot create ProbMgmt") ;
+            break ;
+        }
+    }
+    state.stopTimer() ;
+    state.setItemsProcessed(state.iterations()) ;
+}
+
+/*
+  Concurrent creation. Every thread runs the exact match loop; the library
+  is loaded once, before the threads start (see runBench).
+*/
+void benchCreateConcurrent (BenchState &state)
+{
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    const APIHandle api = plugMgr.getAPIHandle("ProbMgmt") ;
+    DummyAdapter adapter ;
+    state.startTimer() ;
+    for (int i = 0 ; i < state.iterations() ; i++) {
+        PluginUniqueID objLib = 0 ;
+        void *obj = plugMgr.createObject(api, objLib, adapter) ;
+        if (obj == nullptr || plugMgr.destroyObject(api, objLib, obj) < 0) {
+            state.skip("cannot create ProbMgmt") ;
+            break ;
+        }
+    }
+    state.stopTimer() ;
+    state.setItemsProcessed(state.iterations()) ;
+}
+
+/*
+  Per-call dispatch: load a tiny problem over and over through the light
+  shim's ProbMgmt API, which calls libClp through its C interface.
+*/
+void benchDispatchProbMgmt (BenchState &state)
+{
+    ControlAPI_Imp ctrlAPI ;
+    ctrlAPI.setLogLvl(0) ;
+    ProbMgmtAPI *clp = nullptr ;
+    if (ctrlAPI.load("clp") < 0 ||
+            ctrlAPI.createObject(clp, "ProbMgmt") != 0) {
+        state.skip("cannot create ProbMgmt (clp)") ;
+        return ;
+    }
+    TinyLP lp ;
+    state.startTimer() ;
+    for (int i = 0 ; i < state.iterations() ; i++) {
+        if (clp->loadProblem(2, 1, lp.start_, lp.index_, lp.value_,
+                             lp.colLower_, lp.colUpper_, lp.obj_,
+                             lp.rowLower_, lp.rowUpper_) != 0) {
+            state.skip("this libClp can't load from memory") ;
+            break ;
+        }
+    }
+    state.stopTimer() ;
+    API *obj = clp ;
+    ctrlAPI.destroyObject(obj) ;
+}
+
+/*
+  The same through the heavy shim's Osi1 API, and a call that does almost
+  nothing, to isolate the cost of the call itself.
+*/
+void dispatchOsi1 (BenchState &state, bool load)
+{
+    ControlAPI_Imp ctrlAPI ;
+    ctrlAPI.setLogLvl(0) ;
+    Osi1API *osi = nullptr ;
+    if (ctrlAPI.load("clpHeavy") < 0 ||
+            ctrlAPI.createObject(osi, "Osi1") != 0) {
+        state.skip("cannot create Osi1 (clpHeavy)") ;
+        return ;
+    }
+    TinyLP lp ;
+    osi->loadProblem(2, 1, lp.start_, lp.index_, lp.value_, lp.colLower_,
+                     lp.colUpper_, lp.obj_, lp.rowLower_, lp.rowUpper_) ;
+    state.startTimer() ;
+    for (int i = 0 ; i < state.iterations() ; i++) {
+        if (load) {
+            osi->loadProblem(2, 1, lp.start_, lp.index_, lp.value_,
+                             lp.colLower_, lp.colUpper_, lp.obj_,
+                             lp.rowLower_, lp.rowUpper_) ;
+        } else {
+            osi->setObjCoeff(i&1, -1.0) ;
+        }
+    }
+    state.stopTimer() ;
+    API *obj = osi ;
+    ctrlAPI.destroyObject(obj) ;
+}
+
+void benchDispatchOsi1Load (BenchState &state)
+{
+    dispatchOsi1(state, true) ;
+}
+
+void benchDispatchOsi1Call (BenchState &state)
+{
+    dispatchOsi1(state, false) ;
+}
+
+#ifdef COIN_HAS_OSICLP
+/*
+  The baseline: OsiClpSolverInterface called directly.
+*/
+void dispatchDirect (BenchState &state, bool load)
+{
+    OsiClpSolverInterface osi ;
+    osi.messageHandler()->setLogLevel(0) ;
+    TinyLP lp ;
+    osi.loadProblem(2, 1, lp.start_, lp.index_, lp.value_, lp.colLower_,
+                    lp.colUpper_, lp.obj_, lp.rowLower_, lp.rowUpper_) ;
+    OsiSolverInterface *si = &osi ;
+    state.startTimer() ;
+    for (int i = 0 ; i < state.iterations() ; i++) {
+        if (load) {
+            si->loadProblem(2, 1, lp.start_, lp.index_, lp.value_,
+                            lp.colLower_, lp.colUpper_, lp.obj_,
+                            lp.rowLower_, lp.rowUpper_) ;
+        } else {
+            si->setObjCoeff(i&1, -1.0) ;
+        }
+    }
+    state.stopTimer() ;
+}
+
+void benchDispatchDirectLoad (BenchState &state)
+{
+    dispatchDirect(state, true) ;
+}
+
+void benchDispatchDirectCall (BenchState &state)
+{
+    dispatchDirect(state, false) ;
+}
+#endif
+
+// ---------------------------------------------------------------------
+// The runner
+// ---------------------------------------------------------------------
+
+struct ThreadArgs {
+    BenchFunc func_ ;
+    BenchState *state_ ;
+} ;
+
+void *benchThread (void *arg)
+{
+    ThreadArgs *args = static_cast<ThreadArgs *>(arg) ;
+    args->func_(*args->state_) ;
+    return (nullptr) ;
+}
+
+/*
+  Run \p bench once with \p iterations per thread. Real time is from the
+  first thread's start to the last thread's stop.
+*/
+void runOnce (const Bench &bench, int iterations, BenchResult &result)
+{
+    std::vector<BenchState> states ;
+    for (int t = 0 ; t < bench.threads_ ; t++)
+        states.push_back(BenchState(iterations, t)) ;
+    uint64_t start = 0 ;
+    uint64_t stop = 0 ;
+    double cpu = 0.0 ;
+    double items = 0.0 ;
+    if (bench.threads_ == 1) {
+        bench.func_(states[0]) ;
+    } else {
+        /*
+          The concurrent benchmarks share one load of the library; loading
+          is itself exclusive.
+        */
+        BenchState loader(1, 0) ;
+        if (loadLight(loader) == nullptr) {
+            result.skipped_ = loader.skipped_ ;
+            return ;
+        }
+        std::vector<ThreadArgs> args(bench.threads_) ;
+        std::vector<ThreadHandle> threads(bench.threads_) ;
+        for (int t = 0 ; t < bench.threads_ ; t++) {
+            args[t].func_ = bench.func_ ;
+            args[t].state_ = &states[t] ;
+            startThread(threads[t], benchThread, &args[t]) ;
+        }
+        for (int t = 0 ; t < bench.threads_ ; t++) joinThread(threads[t]) ;
+    }
+    for (int t = 0 ; t < bench.threads_ ; t++) {
+        const BenchState &state = states[t] ;
+        if (!state.skipped_.empty()) result.skipped_ = state.skipped_ ;
+        if (t == 0 || state.start_ < start) start = state.start_ ;
+        if (state.stop_ > stop) stop = state.stop_ ;
+        cpu += state.cpuTime_ ;
+        items += state.items_ ;
+    }
+    PluginManager::getInstance().shutdown() ;
+    const double realSecs = (stop > start) ? (stop - start)*1.0e-9 : 0.0 ;
+    result.iterations_ = iterations ;
+    result.realNs_ = realSecs*1.0e9/iterations ;
+    /*
+      CoinCpuTime is process time, so each thread's reading includes the
+      others. Take it once.
+    */
+    if (bench.threads_ > 1) cpu /= bench.threads_ ;
+    result.cpuNs_ = cpu*1.0e9/iterations ;
+    result.itemsPerSec_ = (items > 0 && realSecs > 0) ? items/realSecs : 0.0 ;
+}
+
+/*
+  As Google Benchmark: grow the iteration count until a run takes at least
+  the minimum time.
+*/
+BenchResult runBench (const Bench &bench, double minTime)
+{
+    BenchResult result ;
+    result.name_ = bench.name_ ;
+    result.iterations_ = 0 ;
+    result.realNs_ = 0.0 ;
+    result.cpuNs_ = 0.0 ;
+    result.itemsPerSec_ = 0.0 ;
+    int iterations = 1 ;
+    const int maxIterations = 1000000000 ;
+    for (;;) {
+        runOnce(bench, iterations, result) ;
+        if (!result.skipped_.empty()) break ;
+        const double secs = result.realNs_*iterations*1.0e-9 ;
+        if (secs >= minTime || iterations >= maxIterations) break ;
+        double factor = (secs > 0.0) ? 1.4*minTime/secs : 10.0 ;
+        if (factor > 10.0) factor = 10.0 ;
+        if (factor < 2.0) factor = 2.0 ;
+        const double next = iterations*factor ;
+        iterations = (next > maxIterations) ? maxIterations :
+                     static_cast<int>(next) ;
+    }
+    return (result) ;
+}
+
+void writeJSON (std::ostream &os, const std::vector<BenchResult> &results)
+{
+    char date[64] ;
+    std::time_t now = std::time(nullptr) ;
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S",
+                  std::localtime(&now)) ;
+    os << "{\n  \"context\": {\n    \"date\": " ;
+    PerfStats::writeJSONString(os, date) ;
+    os << ",\n    \"num_cpus\": " << numProcessors()
+       << ",\n    \"library_build_type\": " ;
+#   ifdef NDEBUG
+    PerfStats::writeJSONString(os, "release") ;
+#   else
+    PerfStats::writeJSONString(os, "debug") ;
+#   endif
+    os << "\n  },\n  \"benchmarks\": [" ;
+    for (size_t i = 0 ; i < results.size() ; i++) {
+        const BenchResult &result = results[i] ;
+        os << ((i > 0) ? "," : "") << "\n    {\n      \"name\": " ;
+        PerfStats::writeJSONString(os, result.name_) ;
+        os << ",\n      \"run_name\": " ;
+        PerfStats::writeJSONString(os, result.name_) ;
+        os << ",\n      \"run_type\": \"iteration\"" ;
+        if (!result.skipped_.empty()) {
+            os << ",\n      \"error_occurred\": true,\n      \"error_message\": " ;
+            PerfStats::writeJSONString(os, result.skipped_) ;
+        }
+        os << std::setprecision(6)
+           << ",\n      \"iterations\": " << result.iterations_
+           << ",\n      \"real_time\": " << result.realNs_
+           << ",\n      \"cpu_time\": " << result.cpuNs_
+           << ",\n      \"time_unit\": \"ns\"" ;
+        if (result.itemsPerSec_ > 0.0)
+            os << ",\n      \"items_per_second\": " << result.itemsPerSec_ ;
+        os << "\n    }" ;
+    }
+    os << "\n  ]\n}\n" ;
+}
+
+}   // end unnamed file-local namespace
+
+int main (int argC, char *argV[])
+{
+    double minTime = 0.5 ;
+    std::string filter ;
+    std::string jsonPath ;
+    for (int i = 1 ; i < argC ; i++) {
+        const std::string arg = argV[i] ;
+        if (arg.compare(0, 11, "--min_time=") == 0) {
+            minTime = std::atof(arg.c_str()+11) ;
+        } else if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = arg.substr(9) ;
+        } else if (arg.compare(0, 7, "--json=") == 0) {
+            jsonPath = arg.substr(7) ;
+        } else {
+            std::cerr
+              << "usage: " << argV[0]
+              << " [--filter=STRING] [--min_time=SECS] [--json=FILE]"
+              << std::endl ;
+            return (1) ;
+        }
+    }
+    quiet() ;
+
+    registerBench("PluginManager/loadUnload", benchLoadUnload) ;
+    registerBench("PluginManager/createDestroy/exact", benchCreateExact) ;
+    registerBench("PluginManager/createDestroy/wildcard",
+                  benchCreateWildcard) ;
+    registerBench("PluginManager/create/declined", benchCreateDeclined) ;
+    registerBench("ControlAPI/createDestroy/shortName", benchCreateShortName) ;
+    const int maxThreads = numProcessors() ;
+    for (int threads = 2 ; threads <= 8 ; threads *= 2) {
+        std::ostringstream name ;
+        name << "PluginManager/createDestroy/exact/threads:" << threads ;
+        registerBench(name.str(), benchCreateConcurrent, threads) ;
+        if (threads >= maxThreads) break ;
+    }
+    registerBench("Dispatch/ProbMgmtAPI_Clp/loadProblem",
+                  benchDispatchProbMgmt) ;
+    registerBench("Dispatch/Osi1API_ClpHeavy/loadProblem",
+                  benchDispatchOsi1Load) ;
+    registerBench("Dispatch/Osi1API_ClpHeavy/setObjCoeff",
+                  benchDispatchOsi1Call) ;
+#   ifdef COIN_HAS_OSICLP
+    registerBench("Dispatch/OsiClpSolverInterface/loadProblem",
+                  benchDispatchDirectLoad) ;
+    registerBench("Dispatch/OsiClpSolverInterface/setObjCoeff",
+                  benchDispatchDirectCall) ;
+#   endif
+
+    std::vector<BenchResult> results ;
+    std::cout
+      << std::left << std::setw(52) << "Benchmark" << std::right
+      << std::setw(14) << "Time (ns)" << std::setw(14) << "CPU (ns)"
+      << std::setw(12) << "Iterations" << std::endl ;
+    const std::vector<Bench> &benches = allBenches() ;
+    for (size_t i = 0 ; i < benches.size() ; i++) {
+        if (!filter.empty() &&
+                benches[i].name_.find(filter) == std::string::npos)
+            continue ;
+        BenchResult result = runBench(benches[i], minTime) ;
+        std::cout << std::left << std::setw(52) << result.name_ << std::right ;
+        if (!result.skipped_.empty()) {
+            std::cout << "  skipped: " << result.skipped_ << std::endl ;
+        } else {
+            std::cout
+              << std::fixed << std::setprecision(1)
+              << std::setw(14) << result.realNs_
+              << std::setw(14) << result.cpuNs_
+              << std::setw(12) << result.iterations_ ;
+            if (result.itemsPerSec_ > 0.0)
+                std::cout
+                  << std::setprecision(0) << "  " << result.itemsPerSec_
+                  << " items/s" ;
+            std::cout << std::endl ;
+        }
+        results.push_back(result) ;
+    }
+    if (!jsonPath.empty()) {
+        std::ofstream json(jsonPath.c_str()) ;
+        writeJSON(json, results) ;
+        if (!json) {
+            std::cerr << "Cannot write " << jsonPath << "." << std::endl ;
+            return (1) ;
+        }
+    }
+    return (0) ;
+}
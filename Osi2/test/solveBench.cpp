@@ -0,0 +1,466 @@
+/*
+  Copyright 2011 Lou Hafer, Matt Saltzman
+  This code is licensed under the terms of the Eclipse Public License (EPL)
+
+  $Id$
+
+  End-to-end solver benchmark. Built and run by `make solvebench'; not part
+  of the unit test.
+
+  Every instance in the list is read and solved by every shim, through
+  ControlAPI, and the read time, solve time, simplex iterations, and peak
+  resident set size of each run are recorded. Each run is made in a child
+  process of its own, so that the peak RSS is that of the one run and a
+  shim that crashes costs only its own result.
+
+  The results are written as a table and, with --out=FILE, to FILE in the
+  same tab-separated form read by --baseline. Given a baseline, each run is
+  compared with the baseline run of the same shim and instance, and a run
+  that's slower, iterates more, or uses more memory than the baseline by
+  more than the threshold (--threshold, default 0.25, i.e. 25%) is a
+  regression. Times under --min_secs (default 0.05 s) are noise and aren't
+  compared. A change of status is a regression too. The exit status is the
+  number of regressions.
+
+  The shim offers the Osi1 API if it can, ProbMgmt otherwise; through
+  ProbMgmt there's no iteration count or objective. Osi1API has no
+  branch-and-bound, so for a MIP it's the LP relaxation that's solved.
+
+  Usage:
+    solveBench [--dir=DIR] [--list=FILE] [--shims=a,b,...] [--out=FILE]
+	       [--baseline=FILE] [--threshold=FRAC] [--min_secs=SECS]
+	       [instance ...]
+  Instances are paths relative to DIR; the list file holds one per line,
+  with # starting a comment.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "CoinTime.hpp"
+
+#include "Osi2Config.h"
+#include "Osi2nullptr.hpp"
+#include "Osi2PluginManager.hpp"
+#include "Osi2ControlAPI_Imp.hpp"
+#include "Osi2ProbMgmtAPI.hpp"
+#include "Osi2Osi1API.hpp"
+
+using namespace Osi2 ;
+
+namespace {
+
+/// The result of one shim on one instance
+struct RunResult {
+    RunResult ()
+        : status_("crash"),
+          readSecs_(0.0),
+          solveSecs_(0.0),
+          iterations_(-1),
+          peakRssKB_(-1),
+          objective_(0.0),
+          hasObjective_(false)
+    { }
+    std::string shim_ ;
+    std::string instance_ ;
+    /// ok, noshim, noobject, readfail, solvefail, crash
+    std::string status_ ;
+    double readSecs_ ;
+    double solveSecs_ ;
+    int iterations_ ;
+    long peakRssKB_ ;
+    double objective_ ;
+    bool hasObjective_ ;
+} ;
+
+typedef std::pair<std::string, std::string> RunKey ;
+typedef std::map<RunKey, RunResult> ResultMap ;
+
+/*
+  Do one run; called in the child. Everything but the peak RSS is filled
+  in.
+*/
+void runOne (const std::string &shim, const std::string &path,
+             RunResult &result)
+{
+    PluginManager::getInstance().setLogLvl(0) ;
+    ControlAPI_Imp ctrlAPI ;
+    ctrlAPI.setLogLvl(0) ;
+    if (ctrlAPI.load(shim) < 0) {
+        result.status_ = "noshim" ;
+        return ;
+    }
+    Osi1API *osi = nullptr ;
+    ProbMgmtAPI *probMgmt = nullptr ;
+    if (ctrlAPI.createObject(osi, "Osi1") != 0 &&
+            ctrlAPI.createObject(probMgmt, "ProbMgmt") != 0) {
+        result.status_ = "noobject" ;
+        return ;
+    }
+    double start = CoinWallclockTime() ;
+    int errs = (osi != nullptr) ? osi->readMps(path.c_str(), "") :
+               probMgmt->readMps(path.c_str(), false) ;
+    result.readSecs_ = CoinWallclockTime() - start ;
+    if (errs != 0) {
+        result.status_ = "readfail" ;
+        return ;
+    }
+    start = CoinWallclockTime() ;
+    int retval = 0 ;
+    if (osi != nullptr) {
+        osi->initialSolve() ;
+        if (!osi->isProvenOptimal()) retval = -1 ;
+    } else {
+        retval = probMgmt->initialSolve() ;
+    }
+    result.solveSecs_ = CoinWallclockTime() - start ;
+    result.status_ = (retval < 0) ? "solvefail" : "ok" ;
+    if (osi != nullptr) {
+        result.iterations_ = osi->getIterationCount() ;
+        if (retval >= 0) {
+            result.objective_ = osi->getObjValue() ;
+            result.hasObjective_ = true ;
+        }
+    }
+    API *obj = (osi != nullptr) ? static_cast<API *>(osi) :
+               static_cast<API *>(probMgmt) ;
+    ctrlAPI.destroyObject(obj) ;
+}
+
+/// One result as a line of the results file
+std::string formatResult (const RunResult &result)
+{
+    std::ostringstream line ;
+    line << std::setprecision(6)
+         << result.shim_ << '\t' << result.instance_ << '\t'
+         << result.status_ << '\t' << result.readSecs_ << '\t'
+         << result.solveSecs_ << '\t' << result.iterations_ << '\t'
+         << result.peakRssKB_ << '\t' ;
+    if (result.hasObjective_) {
+        line << std::setprecision(12) << result.objective_ ;
+    } else {
+        line << '-' ;
+    }
+    return (line.str()) ;
+}
+
+/// Parse a line of the results file; false if it isn't one
+bool parseResult (const std::string &line, RunResult &result)
+{
+    if (line.empty() || line[0] == '#') return (false) ;
+    std::istringstream fields(line) ;
+    std::string objective ;
+    fields >> result.shim_ >> result.instance_ >> result.status_
+           >> result.readSecs_ >> result.solveSecs_ >> result.iterations_
+           >> result.peakRssKB_ >> objective ;
+    if (!fields && !fields.eof()) return (false) ;
+    result.hasObjective_ = (!objective.empty() && objective != "-") ;
+    if (result.hasObjective_)
+        result.objective_ = std::atof(objective.c_str()) ;
+    return (true) ;
+}
+
+const char *const resultHeader =
+    "# shim\tinstance\tstatus\tread_s\tsolve_s\titerations\tpeak_rss_kb"
+    "\tobjective" ;
+
+/*
+  Run one shim on one instance in a child process. The child writes its
+  result down a pipe; the peak RSS comes from wait4.
+*/
+RunResult runInChild (const std::string &shim, const std::string &instance,
+                      const std::string &path)
+{
+    RunResult result ;
+    result.shim_ = shim ;
+    result.instance_ = instance ;
+    int fds[2] ;
+    if (::pipe(fds) != 0) return (result) ;
+    std::fflush(nullptr) ;
+    const pid_t pid = ::fork() ;
+    if (pid < 0) {
+        ::close(fds[0]) ;
+        ::close(fds[1]) ;
+        return (result) ;
+    }
+    if (pid == 0) {
+        ::close(fds[0]) ;
+        runOne(shim, path, result) ;
+        const std::string line = formatResult(result) + "\n" ;
+        ssize_t written = ::write(fds[1], line.data(), line.size()) ;
+        ::_exit((written == static_cast<ssize_t>(line.size())) ? 0 : 1) ;
+    }
+    ::close(fds[1]) ;
+    std::string line ;
+    char buf[512] ;
+    ssize_t got ;
+    while ((got = ::read(fds[0], buf, sizeof(buf))) > 0)
+        line.append(buf, got) ;
+    ::close(fds[0]) ;
+    int status = 0 ;
+    struct rusage usage ;
+    if (::wait4(pid, &status, 0, &usage) == pid) {
+        RunResult reported ;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+                parseResult(line.substr(0, line.find('\n')), reported))
+            result = reported ;
+        // Linux reports kilobytes
+        result.peakRssKB_ = usage.ru_maxrss ;
+    }
+    return (result) ;
+}
+
+/// Split \p str at commas
+std::vector<std::string> splitList (const std::string &str)
+{
+    std::vector<std::string> items ;
+    std::string::size_type begin = 0 ;
+    while (begin <= str.size()) {
+        std::string::size_type end = str.find(',', begin) ;
+        if (end == std::string::npos) end = str.size() ;
+        if (end > begin) items.push_back(str.substr(begin, end-begin)) ;
+        begin = end+1 ;
+    }
+    return (items) ;
+}
+
+/// Read the instance list in \p path; false if it can't be read
+bool readList (const std::string &path, std::vector<std::string> &instances)
+{
+    std::ifstream list(path.c_str()) ;
+    if (!list) return (false) ;
+    std::string line ;
+    while (std::getline(list, line)) {
+        std::string::size_type hash = line.find('#') ;
+        if (hash != std::string::npos) line.erase(hash) ;
+        std::istringstream words(line) ;
+        std::string instance ;
+        if (words >> instance) instances.push_back(instance) ;
+    }
+    return (true) ;
+}
+
+/// True if \p now exceeds \p base by more than the fraction \p threshold
+inline bool exceeds (double now, double base, double threshold)
+{
+    return (now > base*(1.0+threshold)) ;
+}
+
+/*
+  Compare \p result with its baseline. Reports and counts the regressions.
+*/
+int compare (const RunResult &result, const RunResult &base,
+             double threshold, double minSecs)
+{
+    std::vector<std::string> why ;
+    std::ostringstream msg ;
+    msg << std::setprecision(3) ;
+    if (result.status_ != base.status_) {
+        why.push_back("status " + base.status_ + " -> " + result.status_) ;
+    } else if (result.status_ == "ok") {
+        if (result.solveSecs_ >= minSecs &&
+                exceeds(result.solveSecs_, base.solveSecs_, threshold)) {
+            msg.str("") ;
+            msg << "solve " << base.solveSecs_ << " -> "
+                << result.solveSecs_ << " s" ;
+            why.push_back(msg.str()) ;
+        }
+        if (result.readSecs_ >= minSecs &&
+                exceeds(result.readSecs_, base.readSecs_, threshold)) {
+            msg.str("") ;
+            msg << "read " << base.readSecs_ << " -> "
+                << result.readSecs_ << " s" ;
+            why.push_back(msg.str()) ;
+        }
+        if (base.iterations_ >= 0 &&
+                exceeds(result.iterations_, base.iterations_, threshold)) {
+            msg.str("") ;
+            msg << "iterations " << base.iterations_ << " -> "
+                << result.iterations_ ;
+            why.push_back(msg.str()) ;
+        }
+        if (base.peakRssKB_ > 0 &&
+                exceeds(result.peakRssKB_, base.peakRssKB_, threshold)) {
+            msg.str("") ;
+            msg << "peak RSS " << base.peakRssKB_ << " -> "
+                << result.peakRssKB_ << " KB" ;
+            why.push_back(msg.str()) ;
+        }
+        if (base.hasObjective_ && result.hasObjective_ &&
+                std::fabs(result.objective_-base.objective_) >
+                1.0e-6*(1.0+std::fabs(base.objective_))) {
+            msg.str("") ;
+            msg << std::setprecision(12) << "objective "
+                << base.objective_ << " -> " << result.objective_ ;
+            why.push_back(msg.str()) ;
+        }
+    }
+    for (size_t i = 0 ; i < why.size() ; i++) {
+        std::cout
+          << "REGRESSION " << result.shim_ << " " << result.instance_
+          << ": " << why[i] << std::endl ;
+    }
+    return (static_cast<int>(why.size())) ;
+}
+
+}   // end unnamed file-local namespace
+
+int main (int argC, char *argV[])
+{
+    std::string dir = "../../Data/Sample" ;
+    std::string listPath ;
+    std::string outPath ;
+    std::string baselinePath ;
+    double threshold = 0.25 ;
+    double minSecs = 0.05 ;
+    std::vector<std::string> shims ;
+    shims.push_back("clp") ;
+    shims.push_back("clpHeavy") ;
+#   ifdef COIN_HAS_OSIGLPK
+    shims.push_back("glpkHeavy") ;
+#   endif
+    std::vector<std::string> instances ;
+    for (int i = 1 ; i < argC ; i++) {
+        const std::string arg = argV[i] ;
+        if (arg.compare(0, 6, "--dir=") == 0) {
+            dir = arg.substr(6) ;
+        } else if (arg.compare(0, 7, "--list=") == 0) {
+            listPath = arg.substr(7) ;
+        } else if (arg.compare(0, 8, "--shims=") == 0) {
+            shims = splitList(arg.substr(8)) ;
+        } else if (arg.compare(0, 6, "--out=") == 0) {
+            outPath = arg.substr(6) ;
+        } else if (arg.compare(0, 11, "--baseline=") == 0) {
+            baselinePath = arg.substr(11) ;
+        } else if (arg.compare(0, 12, "--threshold=") == 0) {
+            threshold = std::atof(arg.c_str()+12) ;
+        } else if (arg.compare(0, 11, "--min_secs=") == 0) {
+            minSecs = std::atof(arg.c_str()+11) ;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Unknown option " << arg << "." << std::endl ;
+            return (-1) ;
+        } else {
+            instances.push_back(arg) ;
+        }
+    }
+    if (!listPath.empty() && !readList(listPath, instances)) {
+        std::cerr << "Cannot read " << listPath << "." << std::endl ;
+        return (-1) ;
+    }
+    if (instances.empty()) instances.push_back("brandy.mps") ;
+    /*
+      Load the baseline, if there is one.
+    */
+    ResultMap baseline ;
+    if (!baselinePath.empty()) {
+        std::ifstream file(baselinePath.c_str()) ;
+        if (!file) {
+            std::cerr << "Cannot read " << baselinePath << "." << std::endl ;
+            return (-1) ;
+        }
+        std::string line ;
+        while (std::getline(file, line)) {
+            RunResult base ;
+            if (parseResult(line, base))
+                baseline[RunKey(base.shim_, base.instance_)] = base ;
+        }
+    }
+    /*
+      Run everything, instance by instance so that the shims are compared
+      side by side.
+    */
+    std::vector<RunResult> results ;
+    std::cout
+      << std::left << std::setw(12) << "shim" << std::setw(24) << "instance"
+      << std::setw(10) << "status" << std::right << std::setw(10) << "read s"
+      << std::setw(10) << "solve s" << std::setw(8) << "iters"
+      << std::setw(12) << "peak KB" << "  objective" << std::endl ;
+    for (size_t i = 0 ; i < instances.size() ; i++) {
+        const std::string path = dir + "/" + instances[i] ;
+        for (size_t s = 0 ; s < shims.size() ; s++) {
+            RunResult result = runInChild(shims[s], instances[i], path) ;
+            std::cout
+              << std::left << std::setw(12) << result.shim_
+              << std::setw(24) << result.instance_
+              << std::setw(10) << result.status_ << std::right
+              << std::fixed << std::setprecision(3)
+              << std::setw(10) << result.readSecs_
+              << std::setw(10) << result.solveSecs_
+              << std::setw(8) << result.iterations_
+              << std::setw(12) << result.peakRssKB_ ;
+            if (result.hasObjective_)
+                std::cout
+                  << "  " << std::scientific << std::setprecision(8)
+                  << result.objective_ ;
+            std::cout << std::endl ;
+            results.push_back(result) ;
+        }
+    }
+    /*
+      Per shim, the total solve time over the instances every shim solved,
+      to choose a default.
+    */
+    std::map<std::string, int> numOk ;
+    for (size_t r = 0 ; r < results.size() ; r++)
+        if (results[r].status_ == "ok") numOk[results[r].instance_]++ ;
+    std::map<std::string, double> totalSolve ;
+    int numCommon = 0 ;
+    for (size_t r = 0 ; r < results.size() ; r++) {
+        const RunResult &result = results[r] ;
+        if (numOk[result.instance_] != static_cast<int>(shims.size()))
+            continue ;
+        totalSolve[result.shim_] += result.solveSecs_ ;
+        if (result.shim_ == shims[0]) numCommon++ ;
+    }
+    std::cout
+      << std::endl << "Total solve time over the " << numCommon
+      << " instances solved by every shim:" << std::endl ;
+    for (size_t s = 0 ; s < shims.size() ; s++)
+        std::cout
+          << "  " << std::left << std::setw(12) << shims[s] << std::right
+          << std::fixed << std::setprecision(3) << totalSolve[shims[s]]
+          << " s" << std::endl ;
+    /*
+      Save the results and compare with the baseline.
+    */
+    if (!outPath.empty()) {
+        std::ofstream out(outPath.c_str()) ;
+        out << resultHeader << "\n" ;
+        for (size_t r = 0 ; r < results.size() ; r++)
+            out << formatResult(results[r]) << "\n" ;
+        if (!out) {
+            std::cerr << "Cannot write " << outPath << "." << std::endl ;
+            return (-1) ;
+        }
+    }
+    int regressions = 0 ;
+    if (!baselinePath.empty()) {
+        int compared = 0 ;
+        for (size_t r = 0 ; r < results.size() ; r++) {
+            const RunResult &result = results[r] ;
+            ResultMap::const_iterator base =
+                baseline.find(RunKey(result.shim_, result.instance_)) ;
+            if (base == baseline.end()) continue ;
+            compared++ ;
+            regressions += compare(result, base->second, threshold, minSecs) ;
+        }
+        std::cout
+          << std::endl << compared << " runs compared with " << baselinePath
+          << "; " << regressions << " regressions." << std::endl ;
+    }
+
+    return ((regressions > 125) ? 125 : regressions) ;
+}
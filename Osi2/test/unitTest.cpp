@@ -7,29 +7,735 @@
   This file contains the unit test for the OSI2 PluginManager and OSI2 APIs.
 */
 
+#include <new>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <sstream>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
 #include "CoinHelperFunctions.hpp"
+#include "CoinWarmStartBasis.hpp"
+#include "CoinFinite.hpp"
 
 
 #include "Osi2Config.h"
 #include "Osi2nullptr.hpp"
 #include "Osi2PluginManager.hpp"
 #include "Osi2DynamicLibrary.hpp"
+#include "Osi2PluginMem.hpp"
+#include "Osi2PluginThreads.hpp"
 #include "Osi2ObjectAdapter.hpp"
 
 #include "Osi2ControlAPI_Imp.hpp"
+#include "Osi2RemoteNode.hpp"
+#include "Osi2SolverDaemon.hpp"
+#include "Osi2DaemonClient.hpp"
 #include "Osi2ProbMgmtAPI.hpp"
 #include "Osi2Osi1API.hpp"
+#include "Osi2MpsReader.hpp"
+#include "Osi2CutPool.hpp"
+#include "Osi2ModelDelta.hpp"
+#include "Osi2BatchResolve.hpp"
+#include "Osi2LogSink.hpp"
+#include "Osi2Trace.hpp"
+#include "Osi2DirCache.hpp"
+#include "Osi2SolveHistory.hpp"
+#include "Osi2Numa.hpp"
+#include "Osi2ModelSnapshot.hpp"
+#include "Osi2ModelCache.hpp"
+#include "Osi2WarmStartCache.hpp"
+#include "Osi2Kernels.hpp"
+#include "Osi2Presolve.hpp"
 
 using namespace Osi2 ;
 
+/*
+  Count heap allocations, so that we can check that the object creation
+  path doesn't allocate. Replacing the global operator new replaces it for
+  the plugin libraries, too.
+*/
+namespace {
+volatile int numAllocs = 0 ;
+}
+
+void *operator new (size_t size) throw (std::bad_alloc)
+{
+    __sync_add_and_fetch(&numAllocs, 1) ;
+    void *block = std::malloc(size ? size : 1) ;
+    if (block == nullptr) throw std::bad_alloc() ;
+    return (block) ;
+}
+
+void operator delete (void *block) throw ()
+{
+    std::free(block) ;
+}
+
+namespace Osi2 {
+
+/// An API for testApiTraits, whose objects come from a C plugin
+class CTypedAPI : public API {
+public:
+    virtual int value() const = 0 ;
+} ;
+
+OSI2_API_TRAITS(CTypedAPI, "CTypedTest", ApiID_User)
+
+}  // end namespace Osi2
+
 namespace {
 
+/*
+  Worker for the concurrent creation test. Repeatedly creates and destroys
+  ProbMgmt objects through the API handle and counts failures.
+*/
+struct CreateWorkerArgs {
+    APIHandle api_ ;
+    int reps_ ;
+    int failures_ ;
+} ;
+
+void *createWorker (void *arg)
+{
+    CreateWorkerArgs *args = static_cast<CreateWorkerArgs *>(arg) ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    DummyAdapter dummy ;
+    for (int i = 0 ; i < args->reps_ ; i++) {
+        PluginUniqueID libID = 0 ;
+        void *obj = plugMgr.createObject(args->api_, libID, dummy) ;
+        if (obj == nullptr || plugMgr.destroyObject(args->api_, libID, obj) < 0)
+            args->failures_++ ;
+    }
+    return (nullptr) ;
+}
+
+/*
+  A trivial API for the allocation test. The create and destroy functions
+  allocate nothing, so any allocation counted belongs to the framework.
+*/
+class AllocTestAPI : public API { } ;
+
+AllocTestAPI allocTestObj ;
+
+void *allocTestCreate (const ObjectParams *)
+{
+    return (&allocTestObj) ;
+}
+
+int32_t allocTestDestroy (void *, const ObjectParams *)
+{
+    return (0) ;
+}
+
+/*
+  Check that, once warmed up, a create/destroy cycle performs no heap
+  allocations outside the plugin's own factory: by handle and by name
+  through the PluginManager, and through a ControlAPI_Imp. The test API is
+  registered on behalf of the library \p libID, which must be loaded.
+*/
+int testAllocations (PluginUniqueID libID)
+{
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+
+    RegisterParams reginfo ;
+    reginfo.version_ = plugMgr.getPlatformServices().version_ ;
+    reginfo.pluginID_ = libID ;
+    reginfo.lang_ = Plugin_CPP ;
+    reginfo.ctrlObj_ = nullptr ;
+    reginfo.createFunc_ = allocTestCreate ;
+    reginfo.destroyFunc_ = allocTestDestroy ;
+    reginfo.capabilityFunc_ = nullptr ;
+    reginfo.bulkCreateFunc_ = nullptr ;
+    reginfo.caps_ = PluginCaps() ;
+    const CharString *apiStr =
+        reinterpret_cast<const CharString *>("AllocTest") ;
+    if (plugMgr.getPlatformServices().registerObject_(apiStr, &reginfo) != 0) {
+        std::cout
+	  << "Apparent failure to register AllocTest API." << std::endl ;
+        return (1) ;
+    }
+    const std::string name = "AllocTest" ;
+    APIHandle api = plugMgr.getAPIHandle(name) ;
+    ControlAPI_Imp ctrlAPI ;
+    int oldLogLvl = plugMgr.getLogLvl() ;
+    plugMgr.setLogLvl(0) ;
+    ctrlAPI.setLogLvl(0) ;
+    DummyAdapter dummy ;
+    const int reps = 100 ;
+    for (int pass = 0 ; pass < 3 ; pass++) {
+        /*
+          Run one cycle to warm up, then count.
+        */
+        int allocs = 0 ;
+        int failures = 0 ;
+        for (int i = 0 ; i <= reps ; i++) {
+            if (i == 1) allocs = numAllocs ;
+            PluginUniqueID id = 0 ;
+            if (pass == 0) {
+                void *obj = plugMgr.createObject(api, id, dummy) ;
+                if (obj == nullptr || plugMgr.destroyObject(api, id, obj) < 0)
+                    failures++ ;
+            } else if (pass == 1) {
+                void *obj = plugMgr.createObject(name, id, dummy) ;
+                if (obj == nullptr || plugMgr.destroyObject(name, id, obj) < 0)
+                    failures++ ;
+            } else {
+                API *obj = nullptr ;
+                if (ctrlAPI.createObject(obj, name) < 0 ||
+                        ctrlAPI.destroyObject(obj) < 0)
+                    failures++ ;
+            }
+        }
+        allocs = numAllocs-allocs ;
+        if (failures != 0 || allocs != 0) {
+            errcnt++ ;
+            std::cout
+	      << "Allocation test " << pass << ": " << failures
+	      << " failed create/destroy cycles, " << allocs
+	      << " allocations in " << reps << " cycles." << std::endl ;
+        }
+    }
+    plugMgr.setLogLvl(oldLogLvl) ;
+
+    return (errcnt) ;
+}
+
+/*
+  Choosing a library by what it declared. The CapsTest API is registered on
+  behalf of the library \p libID, which must be loaded, with a descriptor
+  cheap enough to beat any wildcard registration the library made.
+*/
+int testSelectLib (PluginUniqueID libID)
+{
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+
+    RegisterParams reginfo ;
+    reginfo.version_ = plugMgr.getPlatformServices().version_ ;
+    reginfo.pluginID_ = libID ;
+    reginfo.lang_ = Plugin_CPP ;
+    reginfo.ctrlObj_ = nullptr ;
+    reginfo.createFunc_ = allocTestCreate ;
+    reginfo.destroyFunc_ = allocTestDestroy ;
+    reginfo.capabilityFunc_ = nullptr ;
+    reginfo.bulkCreateFunc_ = nullptr ;
+    reginfo.caps_.problems_ = PluginProb_LP|PluginProb_MIP ;
+    reginfo.caps_.props_ = PluginProp_ThreadSafe ;
+    reginfo.caps_.createCost_ = 0 ;
+    reginfo.caps_.solveCost_ = 50 ;
+    const CharString *apiStr =
+        reinterpret_cast<const CharString *>("CapsTest") ;
+    if (plugMgr.getPlatformServices().registerObject_(apiStr, &reginfo) != 0) {
+        std::cout
+	  << "Apparent failure to register CapsTest API." << std::endl ;
+        return (1) ;
+    }
+    /*
+      Each request and whether the CapsTest registration should satisfy it.
+    */
+    struct { uint32_t problems_ ; uint32_t props_ ; bool ok_ ; } reqs[] = {
+        { 0, 0, true },
+        { PluginProb_LP, 0, true },
+        { PluginProb_LP|PluginProb_MIP, PluginProp_ThreadSafe, true },
+        { PluginProb_QP, 0, false },
+        { PluginProb_LP, PluginProp_ThreadSafe|PluginProp_LoadInMemory, false }
+    } ;
+    const int numReqs = sizeof(reqs)/sizeof(reqs[0]) ;
+    for (int i = 0 ; i < numReqs ; i++) {
+        PluginCaps need = PluginCaps() ;
+        need.problems_ = reqs[i].problems_ ;
+        need.props_ = reqs[i].props_ ;
+        PluginUniqueID chosen = plugMgr.selectLib("CapsTest", need) ;
+        if ((chosen == libID) != reqs[i].ok_) {
+            errcnt++ ;
+            std::cout
+	      << "Library selection, request " << i << ": chose " << chosen
+	      << ", expected " << (reqs[i].ok_ ? "the CapsTest library" : "none")
+	      << "." << std::endl ;
+        }
+    }
+    /*
+      And the library chosen must be able to make the object.
+    */
+    PluginCaps need = PluginCaps() ;
+    need.problems_ = PluginProb_MIP ;
+    PluginUniqueID chosen = plugMgr.selectLib("CapsTest", need) ;
+    DummyAdapter dummy ;
+    void *obj = plugMgr.createObject("CapsTest", chosen, dummy) ;
+    if (obj == nullptr || plugMgr.destroyObject("CapsTest", chosen, obj) < 0) {
+        errcnt++ ;
+        std::cout
+	  << "Apparent failure to create a CapsTest object from the library "
+	  << "selected." << std::endl ;
+    }
+
+    return (errcnt) ;
+}
+
+/*
+  A C plugin for the typed adapters: its objects are plain structs, and
+  its "function table" is a struct found through the object.
+*/
+struct CTypedTable {
+    int (*value_)(const void *object) ;
+} ;
+
+struct CTypedObj {
+    const CTypedTable *table_ ;
+    int value_ ;
+} ;
+
+int cTypedValue (const void *object)
+{
+    return (static_cast<const CTypedObj *>(object)->value_) ;
+}
+
+const CTypedTable cTypedTable = { cTypedValue } ;
+CTypedObj cTypedObjs[2] = { { &cTypedTable, 1 }, { &cTypedTable, 2 } } ;
+int cTypedNext = 0 ;
+int cTypedBinds = 0 ;
+
+void *cTypedCreate (const ObjectParams *)
+{
+    CTypedObj *obj = &cTypedObjs[cTypedNext] ;
+    cTypedNext = 1-cTypedNext ;
+    return (obj) ;
+}
+
+int32_t cTypedDestroy (void *, const ObjectParams *)
+{
+    return (0) ;
+}
+
+/// The wrapper, for a CObjectAdapter
+class CTypedWrapper : public CTypedAPI {
+public:
+    typedef CTypedTable Table ;
+    CTypedWrapper () : object_(0), table_(0) { }
+    static const Table *bindTable (void *object)
+    {
+        cTypedBinds++ ;
+        return (static_cast<CTypedObj *>(object)->table_) ;
+    }
+    void attach (void *object, const Table *table, DestroyFunc)
+    {
+        object_ = object ;
+        table_ = table ;
+    }
+    void *detach ()
+    {
+        void *object = object_ ;
+        object_ = 0 ;
+        return (object) ;
+    }
+    virtual int value () const { return (table_->value_(object_)) ; }
+private:
+    void *object_ ;
+    const Table *table_ ;
+} ;
+
+/*
+  Typed access by ApiTraits: the typed handle agrees with the one by name,
+  the typed create works for a C++ plugin (\p haveProbMgmt says whether a
+  ProbMgmt plugin is loaded), and a CObjectAdapter binds the C plugin's
+  table once and, once warmed up, adapts without allocating. The C plugin
+  is registered on behalf of the library \p libID.
+*/
+int testApiTraits (PluginUniqueID libID, bool haveProbMgmt)
+{
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+
+    if (plugMgr.getAPIHandle<ProbMgmtAPI>() !=
+            plugMgr.getAPIHandle(std::string("ProbMgmt")) ||
+            std::string(ApiTraits<Osi1API>::name()) != "Osi1") {
+        errcnt++ ;
+        std::cout << "Typed API handle or name is wrong." << std::endl ;
+    }
+    if (haveProbMgmt) {
+        PluginUniqueID id = 0 ;
+        ProbMgmtAPI *obj = plugMgr.createObject<ProbMgmtAPI>(id) ;
+        if (obj == nullptr || plugMgr.destroyObject(id, obj) < 0) {
+            errcnt++ ;
+            std::cout
+	      << "Apparent failure of typed ProbMgmt create/destroy."
+	      << std::endl ;
+        }
+    }
+
+    RegisterParams reginfo ;
+    reginfo.version_ = plugMgr.getPlatformServices().version_ ;
+    reginfo.pluginID_ = libID ;
+    reginfo.lang_ = Plugin_C ;
+    reginfo.ctrlObj_ = nullptr ;
+    reginfo.createFunc_ = cTypedCreate ;
+    reginfo.destroyFunc_ = cTypedDestroy ;
+    reginfo.capabilityFunc_ = nullptr ;
+    reginfo.bulkCreateFunc_ = nullptr ;
+    reginfo.caps_ = PluginCaps() ;
+    const CharString *apiStr =
+        reinterpret_cast<const CharString *>(ApiTraits<CTypedAPI>::name()) ;
+    if (plugMgr.getPlatformServices().registerObject_(apiStr, &reginfo) != 0) {
+        std::cout
+	  << "Apparent failure to register CTypedTest API." << std::endl ;
+        return (errcnt+1) ;
+    }
+    CObjectAdapter<CTypedWrapper, CTypedAPI> adapter ;
+    int oldLogLvl = plugMgr.getLogLvl() ;
+    plugMgr.setLogLvl(0) ;
+    const int reps = 100 ;
+    int failures = 0 ;
+    int allocs = 0 ;
+    for (int i = 0 ; i < reps ; i++) {
+        const int before = numAllocs ;
+        PluginUniqueID id = 0 ;
+        CTypedAPI *obj = plugMgr.createObject<CTypedAPI>(id, adapter) ;
+        if (obj == nullptr || obj->value() != 1+(i%2)) {
+            failures++ ;
+            continue ;
+        }
+        void *cObj = adapter.release(obj) ;
+        if (plugMgr.destroyObject(plugMgr.getAPIHandle<CTypedAPI>(),
+                                  id, cObj) < 0)
+            failures++ ;
+        if (i > 0) allocs += numAllocs-before ;
+    }
+    plugMgr.setLogLvl(oldLogLvl) ;
+    if (failures != 0 || cTypedBinds != 1 || allocs != 0) {
+        errcnt++ ;
+        std::cout
+	  << "Typed C plugin objects: " << failures << " failures, "
+	  << cTypedBinds << " table binds, " << allocs
+	  << " allocations after warm-up." << std::endl ;
+    }
+
+    return (errcnt) ;
+}
+
+/*
+  Memory charged to the library \p libID counts against its limits: over
+  the soft limit the AllocTest API (registered by testAllocations) can't be
+  created, and a charge past the hard limit is refused. An object's memory
+  goes when the object is destroyed.
+*/
+int testMemLimits (PluginUniqueID libID)
+{
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    const PlatformServices &services = plugMgr.getPlatformServices() ;
+    if (services.version_.minor_ < 3 || services.chargeMem_ == nullptr) {
+        std::cout
+	  << "PluginManager doesn't offer memory accounting." << std::endl ;
+        return (1) ;
+    }
+    int oldLogLvl = plugMgr.getLogLvl() ;
+    plugMgr.setLogLvl(0) ;
+    MemAccount::Usage before ;
+    plugMgr.getMemUsage(libID, before) ;
+    const int64_t base = before.current_ ;
+    plugMgr.setMemLimits(libID, base+1000, base+2000) ;
+    const std::string name = "AllocTest" ;
+    DummyAdapter dummy ;
+    PluginUniqueID id = 0 ;
+    void *obj = plugMgr.createObject(name, id, dummy) ;
+    if (obj == nullptr ||
+            services.chargeMem_(libID, obj, 1500) != 1 ||
+            plugMgr.getObjMemUsage(libID, obj) != 1500) {
+        errcnt++ ;
+        std::cout << "Memory charge over the soft limit went wrong." << std::endl ;
+    }
+    PluginUniqueID id2 = 0 ;
+    if (plugMgr.createObject(name, id2, dummy) != nullptr) {
+        errcnt++ ;
+        std::cout << "Object created over the soft memory limit." << std::endl ;
+    }
+    if (services.chargeMem_(libID, obj, 1000) != -1) {
+        errcnt++ ;
+        std::cout << "Charge past the hard memory limit accepted." << std::endl ;
+    }
+    if (obj != nullptr) plugMgr.destroyObject(name, id, obj) ;
+    MemAccount::Usage after ;
+    plugMgr.getMemUsage(libID, after) ;
+    if (after.current_ != base || after.peak_ < base+1500 ||
+            after.numRefused_ != before.numRefused_+1) {
+        errcnt++ ;
+        std::cout
+	  << "Memory account wrong after destroy: " << after.current_
+	  << " bytes held, " << after.numRefused_ << " refused." << std::endl ;
+    }
+    plugMgr.setMemLimits(libID, 0, 0) ;
+    plugMgr.setLogLvl(oldLogLvl) ;
+
+    return (errcnt) ;
+}
+
+/*
+  Blocks from an object's arena are aligned and packed into shared chunks,
+  a big one gets a chunk of its own, and the lot goes when the object is
+  destroyed, charge and all, leaving the chunk as a spare. An ArenaScope
+  releases its arena as it goes, and a library at its hard limit gets no
+  more chunks.
+*/
+int testArena (PluginUniqueID libID)
+{
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    PlatformServices services = plugMgr.getPlatformServices() ;
+    if (services.version_.minor_ < 4 || services.arenaAlloc_ == nullptr) {
+        std::cout << "PluginManager doesn't offer arenas." << std::endl ;
+        return (1) ;
+    }
+    services.pluginID_ = libID ;
+    ArenaPool &pool = static_cast<DynamicLibrary *>(libID)->getArenaPool() ;
+    int oldLogLvl = plugMgr.getLogLvl() ;
+    plugMgr.setLogLvl(0) ;
+    const std::string name = "AllocTest" ;
+    DummyAdapter dummy ;
+    PluginUniqueID id = 0 ;
+    void *obj = plugMgr.createObject(name, id, dummy) ;
+    char *first = static_cast<char *>(services.arenaAlloc_(libID, obj, 100)) ;
+    char *second = static_cast<char *>(services.arenaAlloc_(libID, obj, 8)) ;
+    if (obj == nullptr || first == nullptr || second == nullptr ||
+            reinterpret_cast<size_t>(first)%ArenaPool::align != 0 ||
+            second != first+112 ||
+            plugMgr.getObjMemUsage(libID, obj) !=
+                static_cast<int64_t>(ArenaPool::chunkSize)) {
+        errcnt++ ;
+        std::cout << "Arena allocation went wrong." << std::endl ;
+    }
+    char *big =
+        static_cast<char *>(services.arenaAlloc_(libID, obj, 100000)) ;
+    char *third = static_cast<char *>(services.arenaAlloc_(libID, obj, 8)) ;
+    if (big == nullptr || third != second+16 ||
+            plugMgr.getObjMemUsage(libID, obj) <
+                static_cast<int64_t>(ArenaPool::chunkSize)+100000) {
+        errcnt++ ;
+        std::cout << "Big arena block went wrong." << std::endl ;
+    }
+    if (big != nullptr) std::memset(big, 0, 100000) ;
+    ArenaPool::Stats before ;
+    pool.getStats(before) ;
+    if (obj != nullptr) plugMgr.destroyObject(name, id, obj) ;
+    ArenaPool::Stats after ;
+    pool.getStats(after) ;
+    if (pool.hasArena(obj) || plugMgr.getObjMemUsage(libID, obj) != 0 ||
+            after.numArenas_ != before.numArenas_-1 ||
+            (before.numSpare_ < ArenaPool::maxSpare &&
+             after.numSpare_ != before.numSpare_+1)) {
+        errcnt++ ;
+        std::cout << "Arena not released with its object." << std::endl ;
+    }
+    PluginMem mem ;
+    mem.init(&services) ;
+    size_t scope = 0 ;
+    {
+        ArenaScope scratch(mem) ;
+        scope = reinterpret_cast<size_t>(&scratch) ;
+        const char *copy = scratch.copy("arena") ;
+        if (copy == nullptr || std::strcmp(copy, "arena") != 0 ||
+                !pool.hasArena(&scratch)) {
+            errcnt++ ;
+            std::cout << "ArenaScope allocation went wrong." << std::endl ;
+        }
+    }
+    if (pool.hasArena(reinterpret_cast<const void *>(scope))) {
+        errcnt++ ;
+        std::cout << "ArenaScope didn't release its arena." << std::endl ;
+    }
+    MemAccount::Usage usage ;
+    plugMgr.getMemUsage(libID, usage) ;
+    plugMgr.setMemLimits(libID, 0, usage.current_+1000) ;
+    if (mem.arenaAlloc(&usage, 8) != nullptr) {
+        errcnt++ ;
+        std::cout << "Arena chunk taken past the hard limit." << std::endl ;
+    }
+    plugMgr.setMemLimits(libID, 0, 0) ;
+    plugMgr.setLogLvl(oldLogLvl) ;
+
+    return (errcnt) ;
+}
+
+/*
+  Check the performance statistics for the library at \p shimPath: every
+  object created has been destroyed, and at least \p minCycles exact match
+  create/destroy cycles (performed in several threads) were counted. Then
+  check that the statistics make it into the JSON dump.
+*/
+int testPerfStats (const std::string &shimPath, uint64_t minCycles)
+{
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+
+    std::vector<PerfStats::LibStats> stats ;
+    plugMgr.getPerfStats(stats) ;
+    const PerfStats::LibStats *shimStats = nullptr ;
+    for (size_t i = 0 ; i < stats.size() ; i++)
+        if (stats[i].libPath_ == shimPath) shimStats = &stats[i] ;
+    if (shimStats == nullptr) {
+        std::cout
+	  << "No performance statistics for " << shimPath << "." << std::endl ;
+        return (1) ;
+    }
+    const PerfStats::Counter &creates = shimStats->ops_[PerfStats::CreateExact] ;
+    const PerfStats::Counter &destroys =
+        shimStats->ops_[PerfStats::DestroyObject] ;
+    uint64_t histTotal = 0 ;
+    for (int b = 0 ; b < PerfStats::numBuckets ; b++)
+        histTotal += creates.hist_[b] ;
+    if (creates.calls_ < minCycles || destroys.calls_ < minCycles ||
+            histTotal != creates.calls_ ||
+            shimStats->ops_[PerfStats::LoadLib].calls_ == 0 ||
+            shimStats->ops_[PerfStats::InitPlugin].calls_ == 0 ||
+            shimStats->liveObjects_ != 0) {
+        errcnt++ ;
+        std::cout
+	  << "Inconsistent performance statistics for " << shimPath
+	  << ": " << creates.calls_ << " creates, " << destroys.calls_
+	  << " destroys, " << shimStats->liveObjects_ << " live objects."
+	  << std::endl ;
+    }
+
+    ControlAPI_Imp ctrlAPI ;
+    std::ostringstream json ;
+    if (ctrlAPI.dumpPerfStats(json) != 0 ||
+            json.str().find("\"" + shimPath + "\"") == std::string::npos ||
+            json.str().find("\"createExact\"") == std::string::npos) {
+        errcnt++ ;
+        std::cout
+	  << "Apparent failure to dump performance statistics." << std::endl ;
+    }
+
+    return (errcnt) ;
+}
+
+/*
+  Load \p libName as a pool of isolated copies and check that requests for
+  objects are spread over the copies, then unload the pool.
+*/
+int testLibPool (const std::string &libName)
+{
+    const int numCopies = 3 ;
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+
+    PluginUniqueID poolID = nullptr ;
+    int retval = plugMgr.loadLibPool(libName, nullptr, numCopies, &poolID) ;
+    if (retval != 0 || plugMgr.getPoolSize(poolID) != numCopies) {
+        std::cout
+	  << "Apparent failure to load " << numCopies << " copies of "
+	  << libName << "; error code " << retval << "." << std::endl ;
+        if (retval == 0) plugMgr.unloadOneLib(libName) ;
+        return (1) ;
+    }
+    DummyAdapter adapter ;
+    std::vector<PluginUniqueID> libIDs(numCopies) ;
+    std::vector<API *> objects(numCopies) ;
+    for (int i = 0 ; i < numCopies ; i++) {
+        libIDs[i] = poolID ;
+        objects[i] = static_cast<API *>(
+            plugMgr.createObject("ProbMgmt", libIDs[i], adapter)) ;
+        if (objects[i] == nullptr) errcnt++ ;
+    }
+    std::vector<PluginUniqueID> distinct = libIDs ;
+    std::sort(distinct.begin(), distinct.end()) ;
+    if (std::unique(distinct.begin(), distinct.end()) != distinct.end()) {
+        errcnt++ ;
+        std::cout
+	  << "Objects were not spread over the copies of " << libName << "."
+	  << std::endl ;
+    }
+    /*
+      Each copy has its own heap; an object must go back to the copy that
+      created it.
+    */
+    for (int i = 0 ; i < numCopies ; i++) {
+        if (objects[i] == nullptr) continue ;
+        if (plugMgr.destroyObject("ProbMgmt", libIDs[i], objects[i]) < 0)
+            errcnt++ ;
+    }
+    if (plugMgr.unloadOneLib(libName) != 0 ||
+            plugMgr.getPoolSize(poolID) != 0) {
+        errcnt++ ;
+        std::cout
+	  << "Apparent failure to unload copies of " << libName << "."
+	  << std::endl ;
+    }
+
+    return (errcnt) ;
+}
+
+/*
+  Load \p libName, hold an object from it, and reload the library in place.
+  New objects must come from the new version; the old version must stay
+  open until the object it created is destroyed.
+*/
+int testReload (const std::string &libName)
+{
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+
+    PluginUniqueID oldID = nullptr ;
+    if (plugMgr.loadOneLib(libName, nullptr, &oldID) != 0) {
+        std::cout
+	  << "Apparent failure to load " << libName << "." << std::endl ;
+        return (1) ;
+    }
+    DummyAdapter adapter ;
+    PluginUniqueID heldID = 0 ;
+    API *held = static_cast<API *>(
+        plugMgr.createObject("ProbMgmt", heldID, adapter)) ;
+    PluginUniqueID newID = nullptr ;
+    int retval = plugMgr.reloadOneLib(libName, nullptr, nullptr, &newID) ;
+    if (held == nullptr || heldID != oldID || retval != 0 ||
+            newID == oldID || plugMgr.getNumRetiring() != 1) {
+        std::cout
+	  << "Apparent failure to reload " << libName << "; error code "
+	  << retval << "." << std::endl ;
+        errcnt++ ;
+    }
+    PluginUniqueID freshID = 0 ;
+    API *fresh = static_cast<API *>(
+        plugMgr.createObject("ProbMgmt", freshID, adapter)) ;
+    if (fresh == nullptr || freshID != newID) {
+        std::cout
+	  << "New objects do not come from the reloaded " << libName << "."
+	  << std::endl ;
+        errcnt++ ;
+    }
+    if (fresh != nullptr &&
+            plugMgr.destroyObject("ProbMgmt", freshID, fresh) < 0)
+        errcnt++ ;
+    if (held != nullptr &&
+            plugMgr.destroyObject("ProbMgmt", heldID, held) < 0)
+        errcnt++ ;
+    if (plugMgr.getNumRetiring() != 0) {
+        std::cout
+	  << "Old version of " << libName << " still open." << std::endl ;
+        errcnt++ ;
+    }
+    if (plugMgr.unloadOneLib(libName) != 0) errcnt++ ;
+
+    return (errcnt) ;
+}
+
 /*
   Test the bare PluginManager API:
     * Initialise the PluginManager.
     * Load a plugin library.
     * Create ProbMgmt objects: exact match and wild card. Also check that
       we fail correctly for a nonexistent object.
+    * Create and destroy ProbMgmt objects from several threads at once.
+    * Check the performance statistics.
+    * Check that creating and destroying objects doesn't allocate.
+    * Load the library as a pool of isolated copies, and reload it in place,
+      if the platform allows.
 
   The test is (sort of) clp-specific, but only in the sense that the test clp
   plugin will return a ProbMgmt object via the wildcard mechanism when asked
@@ -71,6 +777,7 @@ int testPluginManager (const std::string libName)
     PluginUniqueID libID = 0 ;
     ProbMgmtAPI *clp =
       static_cast<ProbMgmtAPI *>(plugMgr.createObject("ProbMgmt",libID,dummy)) ;
+    PluginUniqueID shimID = libID ;
     if (clp == nullptr) {
         errcnt++ ;
         std::cout
@@ -85,6 +792,76 @@ int testPluginManager (const std::string libName)
         }
         clp = nullptr ;
     }
+    /*
+      Repeat, using an interned API handle.
+    */
+    APIHandle probMgmt = plugMgr.getAPIHandle("ProbMgmt") ;
+    if (probMgmt < 0 || plugMgr.getAPIName(probMgmt) != "ProbMgmt") {
+        errcnt++ ;
+        std::cout
+	  << "Apparent failure to intern API name ProbMgmt." << std::endl ;
+    } else {
+        libID = 0 ;
+        clp = static_cast<ProbMgmtAPI *>(plugMgr.createObject(probMgmt,
+                                         libID, dummy)) ;
+        if (clp == nullptr) {
+            errcnt++ ;
+            std::cout
+	      << "Apparent failure to create a ProbMgmt object by handle."
+	      << std::endl ;
+        } else {
+            int retval = plugMgr.destroyObject(probMgmt, libID, clp) ;
+            if (retval < 0) {
+                errcnt++ ;
+                std::cout
+		  << "Apparent failure to destroy a ProbMgmt object by handle."
+		  << std::endl ;
+            }
+            clp = nullptr ;
+        }
+    }
+    /*
+      Create and destroy objects from several threads at once. Turn the log
+      level down first, or we'll drown in messages.
+    */
+    if (probMgmt >= 0) {
+        const int numThreads = 4 ;
+        pthread_t threads[numThreads] ;
+        CreateWorkerArgs args[numThreads] ;
+        int oldLogLvl = plugMgr.getLogLvl() ;
+        plugMgr.setLogLvl(0) ;
+        for (int i = 0 ; i < numThreads ; i++) {
+            args[i].api_ = probMgmt ;
+            args[i].reps_ = 100 ;
+            args[i].failures_ = 0 ;
+            pthread_create(&threads[i], nullptr, createWorker, &args[i]) ;
+        }
+        int failures = 0 ;
+        for (int i = 0 ; i < numThreads ; i++) {
+            pthread_join(threads[i], nullptr) ;
+            failures += args[i].failures_ ;
+        }
+        plugMgr.setLogLvl(oldLogLvl) ;
+        if (failures != 0) {
+            errcnt++ ;
+            std::cout
+	      << "Apparent failure of concurrent object creation; "
+	      << failures << " failed create/destroy pairs." << std::endl ;
+        } else {
+            errcnt += testPerfStats(shimPath, numThreads*args[0].reps_) ;
+        }
+    }
+    /*
+      Check that the create/destroy path doesn't allocate.
+    */
+    if (shimID != 0) errcnt += testAllocations(shimID) ;
+    /*
+      And that memory charged to the library counts against its limits.
+    */
+    if (shimID != 0) errcnt += testMemLimits(shimID) ;
+    if (shimID != 0) errcnt += testArena(shimID) ;
+    if (shimID != 0) errcnt += testSelectLib(shimID) ;
+    if (shimID != 0) errcnt += testApiTraits(shimID, probMgmt >= 0) ;
     /*
       Ask for a nonexistent API and check that we (correctly) fail to provide
       one.
@@ -102,6 +879,19 @@ int testPluginManager (const std::string libName)
 	  << "Eh? We shouldn't be able to create a BogusAPI object!"
 	  << std::endl ;
     }
+    /*
+      Ask again. This time the wildcard plugin's refusal should come from the
+      plugin manager's negative result cache, but the answer must be the same.
+    */
+    libID = 0 ;
+    bogus =
+      static_cast<ProbMgmtAPI *>(plugMgr.createObject("BogusAPI",libID,dummy)) ;
+    if (bogus != nullptr) {
+        errcnt++ ;
+        std::cout
+	  << "Eh? A second request created a BogusAPI object!"
+	  << std::endl ;
+    }
     /*
       Check that we can create an object through the wildcard mechanism.
     */
@@ -132,6 +922,14 @@ int testPluginManager (const std::string libName)
         std::cout
                 << "Error code is " << retval << "." << std::endl ;
     }
+    /*
+      Where the platform supports it, try the library as a pool of isolated
+      copies, and reload it in place.
+    */
+    if (DynamicLibrary::isolationSupported()) {
+        errcnt += testLibPool(libName) ;
+        errcnt += testReload(libName) ;
+    }
     /*
       Shut down the plugin manager. This will call the plugin library exit
       functions and unload the libraries.
@@ -215,6 +1013,100 @@ int testControlAPI (const std::string &shortName,
 	o2->initialSolve() ;
 	if (o2->isProvenOptimal())
 	  std::cout << "Solved to optimality." << std::endl ;
+	/*
+	  Take the solution in one call and compare with the separate
+	  queries; then check that buffers too small are refused.
+	*/
+	SolutionBuffer solBuf ;
+	SolutionView &sol = solBuf.view(o2->getNumCols(),o2->getNumRows()) ;
+	if (o2->getSolutionBundle(sol) != 0 ||
+	    sol.objValue_ != o2->getObjValue() ||
+	    (sol.numCols_ > 0 &&
+	     sol.colSolution_[0] != o2->getColSolution()[0]) ||
+	    (sol.numRows_ > 0 &&
+	     sol.rowPrice_[sol.numRows_-1] !=
+	         o2->getRowPrice()[sol.numRows_-1])) {
+	    errcnt++ ;
+	    std::cout
+		<< "Apparent failure to take the solution bundle." << std::endl ;
+	}
+	SolutionView noRoom ;
+	if (o2->getNumCols() > 0 && o2->getSolutionBundle(noRoom) != -1) {
+	    errcnt++ ;
+	    std::cout
+		<< "Solution bundle overran its buffers." << std::endl ;
+	}
+	/*
+	  Strong branching on the first few columns, on two workers. Tighter
+	  bounds can't improve the objective.
+	*/
+	if (o2->isProvenOptimal()) {
+	  std::vector<BranchCandidate> cands ;
+	  const double *x = o2->getColSolution() ;
+	  for (int j = 0 ; j < 4 && j < o2->getNumCols() ; j++)
+	    cands.push_back(BranchCandidate(j,floor(x[j]),ceil(x[j]))) ;
+	  std::vector<BranchResult> branches ;
+	  const double z = o2->getObjValue() ;
+	  if (ctrlAPI.strongBranch(o2,cands,100,branches,2) != 0 ||
+	      branches.size() != cands.size()) {
+	    errcnt++ ;
+	    std::cout << "Apparent failure to strong branch." << std::endl ;
+	  } else {
+	    for (size_t k = 0 ; k < branches.size() ; k++) {
+	      const BranchOutcome &down = branches[k].down_ ;
+	      if (down.status_ == BranchOutcome::NotEvaluated ||
+		  (down.status_ == BranchOutcome::Optimal &&
+		   down.objValue_ < z-1.0e-6*(1.0+fabs(z)))) {
+		errcnt++ ;
+		std::cout
+		    << "Bad strong branching outcome, column " << cands[k].col_
+		    << "." << std::endl ;
+	      }
+	    }
+	  }
+	  if (o2->getObjValue() != z) {
+	    errcnt++ ;
+	    std::cout
+		<< "Strong branching changed the object." << std::endl ;
+	  }
+	  /*
+	    A lean clone solves to the same objective.
+	  */
+	  Osi1API *lean = o2->cloneLean() ;
+	  lean->initialSolve() ;
+	  if (lean->getNumCols() != o2->getNumCols() ||
+	      !lean->isProvenOptimal() ||
+	      fabs(lean->getObjValue()-z) > 1.0e-6*(1.0+fabs(z))) {
+	    errcnt++ ;
+	    std::cout
+		<< "Lean clone doesn't match its original." << std::endl ;
+	  }
+	  if (ctrlAPI.destroyObject(lean) < 0) {
+	    errcnt++ ;
+	    std::cout
+		<< "Apparent failure to destroy a lean clone." << std::endl ;
+	  }
+	}
+	/*
+	  Solve again through the warm start cache. The first solve fills the
+	  cache; a clone of the same model should then start warm.
+	*/
+	ctrlAPI.enableWarmStartCache() ;
+	ctrlAPI.initialSolveCached(o2) ;
+	Osi1API *o3 = o2->clone() ;
+	if (o2->isProvenOptimal() && ctrlAPI.initialSolveCached(o3) != 1) {
+	    errcnt++ ;
+	    std::cout
+		<< "Apparent failure to warm start from the cache." << std::endl ;
+	}
+	ctrlAPI.disableWarmStartCache() ;
+	apiObj = o3 ;
+        retval = ctrlAPI.destroyObject(apiObj) ;
+        if (retval < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure to destroy an Osi1 object." << std::endl ;
+        }
 	apiObj = o2 ;
         retval = ctrlAPI.destroyObject(apiObj) ;
         if (retval < 0) {
@@ -223,6 +1115,31 @@ int testControlAPI (const std::string &shortName,
 		<< "Apparent failure to destroy an Osi1 object." << std::endl ;
         }
     }
+    /*
+      Create a ProbMgmt object through the typed createObject, then ask for
+      a ProbMgmt object as an Osi1 object, which should fail and leave
+      nothing behind.
+    */
+    ProbMgmtAPI *typedPm = nullptr ;
+    retval = ctrlAPI.createObject(typedPm, "ProbMgmt") ;
+    if (retval < 0 || typedPm == nullptr) {
+        errcnt++ ;
+        std::cout
+	    << "Apparent failure to create a typed ProbMgmt object."
+	    << std::endl ;
+    } else if (ctrlAPI.destroyObject(typedPm) < 0 || typedPm != nullptr) {
+        errcnt++ ;
+        std::cout
+	    << "Apparent failure to destroy a typed ProbMgmt object."
+	    << std::endl ;
+    }
+    Osi1API *wrongType = nullptr ;
+    retval = ctrlAPI.createObject(wrongType, "ProbMgmt") ;
+    if (retval != -1 || wrongType != nullptr) {
+        errcnt++ ;
+        std::cout
+	    << "ProbMgmt object accepted as an Osi1 object." << std::endl ;
+    }
     /*
       Create a restricted ProbMgmt object, invoke a nontrivial method,
       and destroy the object.
@@ -245,6 +1162,178 @@ int testControlAPI (const std::string &shortName,
                     << std::endl ;
         }
     }
+    /*
+      Create a batch of restricted ProbMgmt objects, one for each of a pool
+      of workers, and destroy them together.
+    */
+    std::vector<API *> batch ;
+    const int batchSize = 4 ;
+    retval = ctrlAPI.createObjects(batch, "ProbMgmt", batchSize, &shortName) ;
+    if (retval != 0 || batch.size() != static_cast<size_t>(batchSize)) {
+        errcnt++ ;
+        std::cout
+                << "Apparent failure to create a batch of " << batchSize
+                << " ProbMgmt objects; got " << batch.size() << "."
+                << std::endl ;
+    }
+    for (size_t i = 0 ; i < batch.size() ; i++) {
+        if (dynamic_cast<ProbMgmtAPI *>(batch[i]) == nullptr) {
+            errcnt++ ;
+            std::cout
+                    << "Batch object " << i << " is not a ProbMgmt object."
+                    << std::endl ;
+        }
+    }
+    retval = ctrlAPI.destroyObjects(batch) ;
+    if (retval != 0 || !batch.empty()) {
+        errcnt++ ;
+        std::cout
+                << "Apparent failure to destroy a batch of ProbMgmt objects."
+                << std::endl ;
+    }
+    /*
+      Solve a restricted ProbMgmt object in the background and wait for it.
+    */
+    apiObj = nullptr ;
+    retval = ctrlAPI.createObject(apiObj, "ProbMgmt", &shortName) ;
+    if (retval != 0) {
+        errcnt++ ;
+        std::cout
+                << "Apparent failure to create a ProbMgmt object to solve "
+                << "asynchronously." << std::endl ;
+    } else {
+        ProbMgmtAPI *clp = dynamic_cast<ProbMgmtAPI *>(apiObj) ;
+        std::string asyncPath = dfltSampleDir+"/brandy.mps" ;
+        clp->readMps(asyncPath.c_str(), true) ;
+        SolveFuture solve = ctrlAPI.initialSolveAsync(clp) ;
+        if (!solve.isValid() || !solve.wait() ||
+                solve.getState() != SolveFuture::Done) {
+            errcnt++ ;
+            std::cout
+                    << "Apparent failure of an asynchronous solve." << std::endl ;
+        } else {
+            std::cout
+                    << "Asynchronous solve status " << solve.getStatus() << "."
+                    << std::endl ;
+        }
+        if (ctrlAPI.destroyObject(apiObj) < 0) {
+            errcnt++ ;
+            std::cout
+                    << "Apparent failure to destroy a ProbMgmt object."
+                    << std::endl ;
+        }
+    }
+    /*
+      Load a small lp from arrays, once keeping the arrays and once handing
+      them over, and solve it.
+        max x0 + x1 s.t. x0 + 2x1 <= 4, 3x0 + x1 <= 6, x >= 0
+    */
+    apiObj = nullptr ;
+    retval = ctrlAPI.createObject(apiObj, "ProbMgmt", &shortName) ;
+    if (retval != 0) {
+        errcnt++ ;
+        std::cout
+                << "Apparent failure to create a ProbMgmt object to load "
+                << "from memory." << std::endl ;
+    } else {
+        ProbMgmtAPI *clp = dynamic_cast<ProbMgmtAPI *>(apiObj) ;
+        const int start[] = { 0, 2, 4 } ;
+        const int index[] = { 0, 1, 0, 1 } ;
+        const double value[] = { 1.0, 3.0, 2.0, 1.0 } ;
+        const double obj[] = { -1.0, -1.0 } ;
+        const double rowUpper[] = { 4.0, 6.0 } ;
+        if (clp->loadProblem(2, 2, start, index, value, nullptr, nullptr, obj,
+                             nullptr, rowUpper) != 0) {
+            errcnt++ ;
+            std::cout
+                    << "Apparent failure to load a problem from memory."
+                    << std::endl ;
+        } else {
+            clp->initialSolve() ;
+        }
+        int *ownStart = new int[3] ;
+        int *ownIndex = new int[4] ;
+        double *ownValue = new double[4] ;
+        double *ownObj = new double[2] ;
+        double *ownRowUpper = new double[2] ;
+        std::copy(start, start+3, ownStart) ;
+        std::copy(index, index+4, ownIndex) ;
+        std::copy(value, value+4, ownValue) ;
+        std::copy(obj, obj+2, ownObj) ;
+        std::copy(rowUpper, rowUpper+2, ownRowUpper) ;
+        double *ownColLower = nullptr ;
+        double *ownColUpper = nullptr ;
+        double *ownRowLower = nullptr ;
+        if (clp->assignProblem(2, 2, ownStart, ownIndex, ownValue, ownColLower,
+                               ownColUpper, ownObj, ownRowLower,
+                               ownRowUpper) != 0 ||
+                ownStart != nullptr || ownValue != nullptr) {
+            errcnt++ ;
+            std::cout
+                    << "Apparent failure to assign a problem." << std::endl ;
+        } else {
+            clp->initialSolve() ;
+        }
+        /*
+          Snapshot the problem and load it back.
+        */
+        std::ostringstream snapPath ;
+        snapPath << "/tmp/osi2snapshot-test." << getpid() ;
+        if (clp->writeSnapshot(snapPath.str().c_str()) != 0 ||
+                clp->readSnapshot(snapPath.str().c_str()) != 0) {
+            errcnt++ ;
+            std::cout
+                    << "Apparent failure to round-trip a snapshot."
+                    << std::endl ;
+        } else {
+            clp->initialSolve() ;
+        }
+        unlink(snapPath.str().c_str()) ;
+        if (ctrlAPI.destroyObject(apiObj) < 0) {
+            errcnt++ ;
+            std::cout
+                    << "Apparent failure to destroy a ProbMgmt object."
+                    << std::endl ;
+        }
+    }
+    /*
+      Race two objects from the shim, and a library that isn't known, on
+      one problem. One of the two should win; the stranger doesn't run.
+    */
+    std::vector<std::string> entrants ;
+    entrants.push_back(shortName) ;
+    entrants.push_back(shortName) ;
+    entrants.push_back("noSuchShim") ;
+    std::vector<RaceEntry> entries ;
+    apiObj = nullptr ;
+    const std::string racePath = dfltSampleDir+"/brandy.mps" ;
+    retval = ctrlAPI.race(apiObj, entries, racePath, entrants) ;
+    if (retval < 0 || retval > 1 || apiObj == nullptr) {
+        errcnt++ ;
+        std::cout
+                << "Apparent failure to race two ProbMgmt objects; "
+                << "winner " << retval << "." << std::endl ;
+    } else {
+        for (size_t i = 0 ; i < entries.size() ; i++) {
+            std::cout
+                    << "  " << entries[i].shortName_ << ": outcome "
+                    << entries[i].outcome_ << ", read "
+                    << entries[i].readTime_ << " s, solve "
+                    << entries[i].solveTime_ << " s." << std::endl ;
+        }
+        if (entries.size() != 3 ||
+                entries[retval].outcome_ != RaceEntry::Solved ||
+                entries[2].outcome_ != RaceEntry::NotRun) {
+            errcnt++ ;
+            std::cout << "Unexpected race entries." << std::endl ;
+        }
+        if (ctrlAPI.destroyObject(apiObj) < 0) {
+            errcnt++ ;
+            std::cout
+                    << "Apparent failure to destroy the winner of a race."
+                    << std::endl ;
+        }
+    }
     /*
       Unload the shims.
     */
@@ -262,28 +1351,2164 @@ int testControlAPI (const std::string &shortName,
 } // end unnamed file-local namespace
 
 
-int main(int argC, char* argV[])
+/*
+  Load \p libName in worker processes through the control API, use a
+  hosted ProbMgmt object, and unload.
+*/
+int testPluginHost (const std::string &libName,
+		    const std::string &dfltSampleDir)
 {
+    int errcnt = 0 ;
+    ControlAPI_Imp ctrlAPI ;
+    const std::string shortName = "hosted" ;
+    int retval = ctrlAPI.loadHosted(shortName, libName, nullptr, 2) ;
+    if (retval != 0) {
+        std::cout
+	    << "Apparent failure to load " << libName << " in workers."
+	    << std::endl ;
+        return (1) ;
+    }
+    API *apiObj = nullptr ;
+    retval = ctrlAPI.createObject(apiObj, "ProbMgmt", &shortName) ;
+    ProbMgmtAPI *clp = dynamic_cast<ProbMgmtAPI *>(apiObj) ;
+    if (retval != 0 || clp == nullptr) {
+        errcnt++ ;
+        std::cout
+	    << "Apparent failure to create a hosted ProbMgmt object."
+	    << std::endl ;
+    } else {
+	std::string exmip1Path = dfltSampleDir+"/brandy.mps" ;
+        if (clp->readMps(exmip1Path.c_str(), true) < 0 ||
+                clp->initialSolve() < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure of a hosted ProbMgmt object." << std::endl ;
+        }
+        if (ctrlAPI.destroyObject(apiObj) < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure to destroy a hosted ProbMgmt object."
+		<< std::endl ;
+        }
+    }
+    if (ctrlAPI.unload(shortName) != 0) {
+        errcnt++ ;
+        std::cout
+	    << "Apparent failure to unload hosted " << libName << "."
+	    << std::endl ;
+    }
+    return (errcnt) ;
+}
 
-    std::cout << "START UNIT TEST" << std::endl ;
-
-    std::string dfltSampleDir = "../../Data/Sample" ;
+/*
+  Serve \p libName from a node in this process, load the remote shim with
+  that node as its pool, and use two remote ProbMgmt objects on the same
+  model. The model should be sent to the node once.
+*/
+int testRemoteShim (const std::string &libName,
+		    const std::string &dfltSampleDir)
+{
+    int errcnt = 0 ;
+    RemoteNode node ;
+    std::string errStr ;
+    if (node.start(libName, nullptr, 0, errStr) != 0) {
+        std::cout
+	    << "Apparent failure to start a node for " << libName << ": "
+	    << errStr << "." << std::endl ;
+        return (1) ;
+    }
+    std::ostringstream nodeSpec ;
+    nodeSpec << "localhost:" << node.getPort() ;
+    setenv("OSI2_REMOTE_NODES", nodeSpec.str().c_str(), 1) ;
+    ControlAPI_Imp ctrlAPI ;
+    const std::string shortName = "remote" ;
+    if (ctrlAPI.load(shortName, "libOsi2RemoteShim.so") < 0) {
+        std::cout << "Apparent failure to load the remote shim." << std::endl ;
+        return (1) ;
+    }
+    std::string exmip1Path = dfltSampleDir+"/brandy.mps" ;
+    for (int i = 0 ; i < 2 ; i++) {
+        API *apiObj = nullptr ;
+        int retval = ctrlAPI.createObject(apiObj, "ProbMgmt", &shortName) ;
+        ProbMgmtAPI *remote = dynamic_cast<ProbMgmtAPI *>(apiObj) ;
+        if (retval != 0 || remote == nullptr) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure to create a remote ProbMgmt object."
+		<< std::endl ;
+            continue ;
+        }
+        if (remote->readMps(exmip1Path.c_str(), true) != 0 ||
+                remote->initialSolve() < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure of a remote ProbMgmt object." << std::endl ;
+        }
+        if (ctrlAPI.destroyObject(apiObj) < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure to destroy a remote ProbMgmt object."
+		<< std::endl ;
+        }
+    }
+    if (node.getNumReceived() != 1) {
+        errcnt++ ;
+        std::cout
+	    << "Node received " << node.getNumReceived()
+	    << " models; expected 1." << std::endl ;
+    }
     /*
-      Test the bare PluginManager. There's no sense proceeding to the API
-      tests if the PluginManager isn't working.
+      The same arrays loaded twice should travel once. Then a batch of two
+      right-hand sides on the last object.
     */
-    std::cout << "Testing bare PluginManager." << std::endl ;
-    int retval = testPluginManager("libOsi2ClpShim.so") ;
-    std::cout
-      << "End test of bare PluginManager, " << retval << " errors."
-      << std::endl << std::endl ;
-    if (retval != 0) {
+    const int start[] = { 0, 2, 4 } ;
+    const int index[] = { 0, 1, 0, 1 } ;
+    const double value[] = { 1.0, 3.0, 2.0, 1.0 } ;
+    const double obj[] = { -1.0, -1.0 } ;
+    const double rowUpper[] = { 4.0, 6.0 } ;
+    const double rhs[] = { 4.0, 6.0, 2.0, 3.0 } ;
+    for (int i = 0 ; i < 2 ; i++) {
+        API *apiObj = nullptr ;
+        int retval = ctrlAPI.createObject(apiObj, "ProbMgmt", &shortName) ;
+        ProbMgmtAPI *remote = dynamic_cast<ProbMgmtAPI *>(apiObj) ;
+        if (retval != 0 || remote == nullptr) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure to create a remote ProbMgmt object."
+		<< std::endl ;
+            continue ;
+        }
+        if (remote->loadProblem(2, 2, start, index, value, nullptr, nullptr,
+                                obj, nullptr, rowUpper) != 0 ||
+                remote->initialSolve() < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure to load a problem on a remote node."
+		<< std::endl ;
+        } else if (i == 1) {
+            int statuses[2] ;
+            double objValues[2] ;
+            if (remote->resolveBatch(BatchRhs, 2, rhs, statuses,
+                                     objValues) != 2) {
+                errcnt++ ;
+                std::cout
+		    << "Apparent failure of a remote batch." << std::endl ;
+            }
+        }
+        if (ctrlAPI.destroyObject(apiObj) < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure to destroy a remote ProbMgmt object."
+		<< std::endl ;
+        }
+    }
+    if (node.getNumReceived() != 2) {
+        errcnt++ ;
         std::cout
-	  << "Aborting unitTest; errors in PluginManager." << std::endl ;
-        return (retval) ;
+	    << "Node received " << node.getNumReceived()
+	    << " models; expected 2." << std::endl ;
+    }
+    if (ctrlAPI.unload(shortName) != 0) {
+        errcnt++ ;
+        std::cout << "Apparent failure to unload the remote shim." << std::endl ;
+    }
+    node.stop() ;
+    return (errcnt) ;
+}
+
+/*
+  Serve \p libName from a node in this process and use a remote Osi1 object
+  on a small problem: load, solve, change a bound, resolve.
+*/
+int testRemoteOsi1 (const std::string &libName)
+{
+    int errcnt = 0 ;
+    RemoteNode node ;
+    std::string errStr ;
+    if (node.start(libName, nullptr, 0, errStr) != 0) {
+        std::cout
+	    << "Apparent failure to start a node for " << libName << ": "
+	    << errStr << "." << std::endl ;
+        return (1) ;
+    }
+    std::ostringstream nodeSpec ;
+    nodeSpec << "localhost:" << node.getPort() ;
+    setenv("OSI2_REMOTE_NODES", nodeSpec.str().c_str(), 1) ;
+    ControlAPI_Imp ctrlAPI ;
+    const std::string shortName = "remote" ;
+    if (ctrlAPI.load(shortName, "libOsi2RemoteShim.so") < 0) {
+        std::cout << "Apparent failure to load the remote shim." << std::endl ;
+        node.stop() ;
+        return (1) ;
+    }
+    API *apiObj = nullptr ;
+    int retval = ctrlAPI.createObject(apiObj, "Osi1", &shortName) ;
+    Osi1API *remote = dynamic_cast<Osi1API *>(apiObj) ;
+    if (retval != 0 || remote == nullptr) {
+        errcnt++ ;
+        std::cout
+	    << "Apparent failure to create a remote Osi1 object." << std::endl ;
+    } else {
+        /*
+          max x+y s.t. x+2y <= 4, 3x+y <= 6 has its optimum at (1.6,1.2).
+          Fixing x at 1 moves it to (1,1.5).
+        */
+        const int start[] = { 0, 2, 4 } ;
+        const int index[] = { 0, 1, 0, 1 } ;
+        const double value[] = { 1.0, 3.0, 2.0, 1.0 } ;
+        const double obj[] = { -1.0, -1.0 } ;
+        const double rowUpper[] = { 4.0, 6.0 } ;
+        remote->loadProblem(2, 2, start, index, value, nullptr, nullptr,
+                            obj, nullptr, rowUpper) ;
+        remote->initialSolve() ;
+        const double *x = remote->getColSolution() ;
+        if (!remote->isProvenOptimal() || x == nullptr ||
+                std::fabs(x[0]-1.6) > 1.0e-6 || std::fabs(x[1]-1.2) > 1.0e-6) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure of a remote initialSolve." << std::endl ;
+        }
+        remote->setColLower(0, 1.0) ;
+        remote->setColUpper(0, 1.0) ;
+        remote->resolve() ;
+        x = remote->getColSolution() ;
+        if (!remote->isProvenOptimal() || x == nullptr ||
+                std::fabs(x[1]-1.5) > 1.0e-6 ||
+                std::fabs(remote->getObjValue()+2.5) > 1.0e-6) {
+            errcnt++ ;
+            std::cout << "Apparent failure of a remote resolve." << std::endl ;
+        }
+        if (ctrlAPI.destroyObject(apiObj) < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure to destroy a remote Osi1 object."
+		<< std::endl ;
+        }
+    }
+    if (ctrlAPI.unload(shortName) != 0) {
+        errcnt++ ;
+        std::cout << "Apparent failure to unload the remote shim." << std::endl ;
+    }
+    node.stop() ;
+    return (errcnt) ;
+}
+
+/*
+  Run the same job through the solver daemon twice. The second job should
+  find the model resident.
+*/
+int testSolverDaemon (const std::string &libName,
+		      const std::string &dfltSampleDir)
+{
+    int errcnt = 0 ;
+    SolverDaemon daemon ;
+    std::ostringstream socketPath ;
+    socketPath << "/tmp/osi2daemon-test." << getpid() ;
+    std::string errStr ;
+    if (daemon.start(socketPath.str(), errStr) != 0) {
+        std::cout
+	    << "Apparent failure to start the solver daemon: " << errStr
+	    << "." << std::endl ;
+        return (1) ;
+    }
+    DaemonClient client ;
+    if (client.connect(socketPath.str(), errStr) != 0) {
+        std::cout
+	    << "Apparent failure to connect to the solver daemon: " << errStr
+	    << "." << std::endl ;
+        return (1) ;
+    }
+    std::string exmip1Path = dfltSampleDir+"/brandy.mps" ;
+    for (int i = 0 ; i < 2 ; i++) {
+        int solveStatus = -1 ;
+        bool resident = false ;
+        if (client.solve("clp", libName, exmip1Path, true, solveStatus,
+                         errStr, &resident) != 0 || solveStatus < 0) {
+            errcnt++ ;
+            std::cout
+		<< "Apparent failure of a daemon job: " << errStr << "."
+		<< std::endl ;
+        } else if (resident != (i > 0)) {
+            errcnt++ ;
+            std::cout
+		<< "Job " << i << " found the model "
+		<< (resident ? "resident" : "absent") << "." << std::endl ;
+        }
+    }
+    int solveStatus = -1 ;
+    if (client.solve("clp", libName, dfltSampleDir+"/nonexistent.mps",
+                     true, solveStatus, errStr) == 0) {
+        errcnt++ ;
+        std::cout << "Daemon solved a nonexistent model." << std::endl ;
+    }
+    int numJobs = 0 ;
+    int numHits = 0 ;
+    int numResident = 0 ;
+    if (client.getStats(numJobs, numHits, numResident) != 0 ||
+            numJobs != 2 || numHits != 1 || numResident != 1) {
+        errcnt++ ;
+        std::cout
+	    << "Daemon reports " << numJobs << " jobs, " << numHits
+	    << " hits, " << numResident << " resident; expected 2, 1, 1."
+	    << std::endl ;
+    }
+    client.disconnect() ;
+    daemon.stop() ;
+    if (daemon.getControlAPI().unload("clp") != 0) {
+        errcnt++ ;
+        std::cout << "Apparent failure to unload the daemon's shim." << std::endl ;
+    }
+    return (errcnt) ;
+}
+
+/*
+  Read \p sampleDir/brandy.mps with the MPS reader, once with a single
+  thread and once with the COLUMNS section cut into many small pieces, and
+  check that the two reads agree.
+*/
+int testMpsReader (const std::string &sampleDir)
+{
+    std::string path = sampleDir+"/brandy.mps" ;
+    MpsReader serial ;
+    serial.setNumThreads(1) ;
+    serial.setKeepNames(true) ;
+    MpsReader parallel ;
+    parallel.setNumThreads(4) ;
+    parallel.setChunkSize(64) ;
+    parallel.setKeepNames(true) ;
+    if (serial.readFile(path) != 0 || parallel.readFile(path) != 0) {
+        std::cout
+	  << "Apparent failure to read " << path << ": "
+	  << serial.getError() << parallel.getError() << std::endl ;
+        return (1) ;
+    }
+    const int n = serial.getNumCols() ;
+    const int m = serial.getNumRows() ;
+    const int nz = serial.getNumElements() ;
+    bool same = (n > 0 && m > 0 && parallel.getNumCols() == n &&
+                 parallel.getNumRows() == m &&
+                 parallel.getNumElements() == nz) ;
+    if (same) {
+        same =
+          std::equal(serial.getStarts(),serial.getStarts()+n+1,
+                     parallel.getStarts()) &&
+          std::equal(serial.getIndices(),serial.getIndices()+nz,
+                     parallel.getIndices()) &&
+          std::equal(serial.getValues(),serial.getValues()+nz,
+                     parallel.getValues()) &&
+          std::equal(serial.getColUpper(),serial.getColUpper()+n,
+                     parallel.getColUpper()) &&
+          std::equal(serial.getRowLower(),serial.getRowLower()+m,
+                     parallel.getRowLower()) &&
+          serial.getColNames() == parallel.getColNames() &&
+          serial.getRowNames() == parallel.getRowNames() ;
+    }
+    if (!same) {
+        std::cout
+	  << "Serial and parallel reads of " << path << " differ."
+	  << std::endl ;
+        return (1) ;
+    }
+    return (0) ;
+}
+
+/*
+  Just enough of a solver for CutPool: rows and their activities, and a
+  count of the calls that change them.
+*/
+struct CutPoolSolver {
+    CutPoolSolver () : addCalls_(0), deleteCalls_(0) { }
+    int getNumRows () const { return (static_cast<int>(lb_.size())) ; }
+    const double *getRowActivity () const
+    { return (act_.empty() ? nullptr : &act_[0]) ; }
+    void setRowBounds (int i, double lb, double ub)
+    { lb_[i] = lb ; ub_[i] = ub ; }
+    void addRows (int num, const int *starts, const int *, const double *,
+                  const double *lb, const double *ub)
+    {
+        addCalls_++ ;
+        for (int i = 0 ; i < num ; i++) {
+            lb_.push_back(lb[i]) ;
+            ub_.push_back(ub[i]) ;
+            act_.push_back(lb[i]) ;
+            len_.push_back(starts[i+1]-starts[i]) ;
+        }
+    }
+    void deleteRows (int num, const int *rows)
+    {
+        deleteCalls_++ ;
+        for (int k = num-1 ; k >= 0 ; k--) {
+            lb_.erase(lb_.begin()+rows[k]) ;
+            ub_.erase(ub_.begin()+rows[k]) ;
+            act_.erase(act_.begin()+rows[k]) ;
+            len_.erase(len_.begin()+rows[k]) ;
+        }
+    }
+    std::vector<double> lb_, ub_, act_ ;
+    std::vector<int> len_ ;
+    int addCalls_, deleteCalls_ ;
+} ;
+
+/*
+  Duplicates (scaled or not), dominated and tightened cuts, batched
+  application, and ageing out of slack cuts.
+*/
+int testCutPool ()
+{
+    int errcnt = 0 ;
+    CutPool pool ;
+    CutPoolSolver solver ;
+    const int ind[] = { 3, 1, 7 } ;
+    const double el[] = { 2.0, -1.0, 4.0 } ;
+    const double twice[] = { 4.0, -2.0, 8.0 } ;
+    const int other[] = { 2, 5 } ;
+    const double ones[] = { 1.0, 1.0 } ;
+    const int repeated[] = { 2, 2 } ;
+    if (pool.addRow(3,ind,el,-1.0e31,8.0) != CutPool::Added ||
+        pool.addRow(3,ind,twice,-1.0e31,16.0) != CutPool::Duplicate ||
+        pool.addRow(3,ind,el,-1.0e31,10.0) != CutPool::Dominated ||
+        pool.addRow(3,ind,el,-1.0e31,6.0) != CutPool::Tightened ||
+        pool.addRow(2,other,ones,1.0,1.0e31) != CutPool::Added ||
+        pool.addRow(2,repeated,ones,1.0,2.0) != CutPool::Inconsistent ||
+        pool.addRow(2,other,ones,3.0,2.0) != CutPool::Infeasible) {
+        errcnt++ ;
+        std::cout << "CutPool misjudged a cut." << std::endl ;
+    }
+    if (pool.apply(&solver) != 2 || solver.addCalls_ != 1 ||
+        solver.getNumRows() != 2 || solver.lb_[0] != -1.5 ||
+        solver.len_[1] != 2 || pool.getNumPending() != 0) {
+        errcnt++ ;
+        std::cout << "CutPool failed to apply its cuts." << std::endl ;
     }
     /*
-      Now let's try the Osi2 control API.
+      Tighten an applied cut, then leave the first slack and the second
+      tight until the first ages out.
+    */
+    if (pool.addRow(3,ind,el,-1.0e31,4.0) != CutPool::Tightened ||
+        pool.apply(&solver) != 0 || solver.lb_[0] != -1.0) {
+        errcnt++ ;
+        std::cout << "CutPool failed to tighten a cut." << std::endl ;
+    }
+    solver.act_[0] = 0.0 ;
+    int deleted = 0 ;
+    for (int i = 0 ; i <= pool.getMaxAge() ; i++)
+        deleted += pool.age(&solver) ;
+    if (deleted != 1 || solver.deleteCalls_ != 1 ||
+        solver.getNumRows() != 1 || pool.getNumInSolver() != 1 ||
+        solver.len_[0] != 2) {
+        errcnt++ ;
+        std::cout << "CutPool failed to age out a slack cut." << std::endl ;
+    }
+    if (pool.getNumIneffective() != 2 || pool.getNumInconsistent() != 1 ||
+        pool.getNumInfeasible() != 1 || pool.getNumApplied() != 2 ||
+        pool.getNumAgedOut() != 1) {
+        errcnt++ ;
+        std::cout << "CutPool counts are wrong." << std::endl ;
+    }
+    /*
+      At x = 0.5, x0+x4 <= 1 holds and x0+x6 >= 3 doesn't.
+    */
+    const int held[] = { 0, 4 } ;
+    const int cutOff[] = { 0, 6 } ;
+    const double x[] = { 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5 } ;
+    pool.addRow(2,held,ones,-1.0e31,1.0) ;
+    pool.addRow(2,cutOff,ones,3.0,1.0e31) ;
+    if (pool.dropSatisfied(x) != 1 || pool.getNumPending() != 1 ||
+        pool.getNumIneffective() != 3 || pool.getNumInSolver() != 1) {
+        errcnt++ ;
+        std::cout << "CutPool kept a cut the solution satisfies." << std::endl ;
+    }
+    return (errcnt) ;
+}
+
+/*
+  A packed matrix with no gaps, as a ModelDelta sees one.
+*/
+struct DeltaMatrix {
+    const int *getVectorStarts () const { return (&starts_[0]) ; }
+    const int *getVectorLengths () const { return (&lengths_[0]) ; }
+    const int *getIndices () const
+    { return (minor_.empty() ? nullptr : &minor_[0]) ; }
+    const double *getElements () const
+    { return (els_.empty() ? nullptr : &els_[0]) ; }
+    std::vector<int> starts_, lengths_, minor_ ;
+    std::vector<double> els_ ;
+} ;
+
+/*
+  Just enough of a solver to take a ModelDelta: a dense matrix, bounds,
+  objective and integrality, and a count of the calls made.
+*/
+struct DeltaSolver {
+    DeltaSolver () : calls_(0) { }
+    int getNumRows () const { return (static_cast<int>(rlb_.size())) ; }
+    int getNumCols () const { return (static_cast<int>(clb_.size())) ; }
+    const double *getRowLower () const { return (&rlb_[0]) ; }
+    const double *getRowUpper () const { return (&rub_[0]) ; }
+    const double *getColLower () const { return (&clb_[0]) ; }
+    const double *getColUpper () const { return (&cub_[0]) ; }
+    const double *getObjCoefficients () const { return (&obj_[0]) ; }
+    bool isInteger (int j) const { return (int_[j]) ; }
+    const DeltaMatrix *getMatrixByRow () const { return (pack(true)) ; }
+    const DeltaMatrix *getMatrixByCol () const { return (pack(false)) ; }
+    void setRowSetBounds (const int *first, const int *last,
+                          const double *bounds)
+    {
+        calls_++ ;
+        for ( ; first != last ; first++, bounds += 2) {
+            rlb_[*first] = bounds[0] ;
+            rub_[*first] = bounds[1] ;
+        }
+    }
+    void setColSetBounds (const int *first, const int *last,
+                          const double *bounds)
+    {
+        calls_++ ;
+        for ( ; first != last ; first++, bounds += 2) {
+            clb_[*first] = bounds[0] ;
+            cub_[*first] = bounds[1] ;
+        }
+    }
+    void setObjCoeffSet (const int *first, const int *last,
+                         const double *coeffs)
+    {
+        calls_++ ;
+        for ( ; first != last ; first++) obj_[*first] = *coeffs++ ;
+    }
+    void setInteger (const int *indices, int len)
+    {
+        calls_++ ;
+        for (int k = 0 ; k < len ; k++) int_[indices[k]] = true ;
+    }
+    void addRows (int num, const int *starts, const int *cols,
+                  const double *els, const double *lb, const double *ub)
+    {
+        calls_++ ;
+        for (int i = 0 ; i < num ; i++) {
+            a_.push_back(std::vector<double>(getNumCols(), 0.0)) ;
+            for (int k = starts[i] ; k < starts[i+1] ; k++)
+                a_.back()[cols[k]] = els[k] ;
+            rlb_.push_back(lb[i]) ;
+            rub_.push_back(ub[i]) ;
+        }
+    }
+    void addCols (int num, const int *starts, const int *rows,
+                  const double *els, const double *lb, const double *ub,
+                  const double *obj)
+    {
+        calls_++ ;
+        for (int j = 0 ; j < num ; j++) {
+            for (int i = 0 ; i < getNumRows() ; i++) a_[i].push_back(0.0) ;
+            for (int k = starts[j] ; k < starts[j+1] ; k++)
+                a_[rows[k]].back() = els[k] ;
+            clb_.push_back(lb[j]) ;
+            cub_.push_back(ub[j]) ;
+            obj_.push_back(obj[j]) ;
+            int_.push_back(false) ;
+        }
+    }
+    void deleteRows (int num, const int *rows)
+    {
+        calls_++ ;
+        for (int k = num-1 ; k >= 0 ; k--) {
+            a_.erase(a_.begin()+rows[k]) ;
+            rlb_.erase(rlb_.begin()+rows[k]) ;
+            rub_.erase(rub_.begin()+rows[k]) ;
+        }
+    }
+    void deleteCols (int num, const int *cols)
+    {
+        calls_++ ;
+        for (int k = num-1 ; k >= 0 ; k--) {
+            for (int i = 0 ; i < getNumRows() ; i++)
+                a_[i].erase(a_[i].begin()+cols[k]) ;
+            clb_.erase(clb_.begin()+cols[k]) ;
+            cub_.erase(cub_.begin()+cols[k]) ;
+            obj_.erase(obj_.begin()+cols[k]) ;
+            int_.erase(int_.begin()+cols[k]) ;
+        }
+    }
+    const DeltaMatrix *pack (bool byRow) const
+    {
+        const int major = byRow ? getNumRows() : getNumCols() ;
+        const int minor = byRow ? getNumCols() : getNumRows() ;
+        mtx_ = DeltaMatrix() ;
+        for (int p = 0 ; p < major ; p++) {
+            mtx_.starts_.push_back(static_cast<int>(mtx_.minor_.size())) ;
+            for (int q = 0 ; q < minor ; q++) {
+                const double el = byRow ? a_[p][q] : a_[q][p] ;
+                if (el == 0.0) continue ;
+                mtx_.minor_.push_back(q) ;
+                mtx_.els_.push_back(el) ;
+            }
+            mtx_.lengths_.push_back(
+                static_cast<int>(mtx_.minor_.size())-mtx_.starts_.back()) ;
+        }
+        return (&mtx_) ;
+    }
+    /*
+      The model with rows known by their lower bound and columns by their
+      objective coefficient, so it can be compared whatever the order.
+    */
+    std::map<std::pair<double,double>, double> canonical () const
+    {
+        std::map<std::pair<double,double>, double> model ;
+        for (int j = 0 ; j < getNumCols() ; j++) {
+            model[std::make_pair(1.0e9, obj_[j])] =
+                cub_[j]+(int_[j] ? 1000.0 : 0.0) ;
+            for (int i = 0 ; i < getNumRows() ; i++) {
+                if (a_[i][j] != 0.0)
+                    model[std::make_pair(rlb_[i], obj_[j])] = a_[i][j] ;
+            }
+        }
+        for (int i = 0 ; i < getNumRows() ; i++)
+            model[std::make_pair(rlb_[i], 1.0e9)] = rub_[i] ;
+        return (model) ;
+    }
+    std::vector<std::vector<double> > a_ ;
+    std::vector<double> rlb_, rub_, clb_, cub_, obj_ ;
+    std::vector<bool> int_ ;
+    mutable DeltaMatrix mtx_ ;
+    int calls_ ;
+} ;
+
+/*
+  A batch of bound changes, adds and deletes, made in place and undone.
+*/
+int testModelDelta ()
+{
+    int errcnt = 0 ;
+    DeltaSolver solver ;
+    const int starts[] = { 0, 2, 4, 6 } ;
+    const int cols[] = { 0, 1, 1, 2, 0, 2 } ;
+    const double els[] = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 } ;
+    const double rlb[] = { 1.0, 2.0, 3.0 } ;
+    const double rub[] = { 10.0, 20.0, 30.0 } ;
+    const double clb[] = { 0.0, 0.0, 0.0 } ;
+    const double cub[] = { 1.0, 2.0, 3.0 } ;
+    const double obj[] = { 11.0, 12.0, 13.0 } ;
+    const int noStarts[] = { 0, 0, 0, 0 } ;
+    solver.addCols(3,noStarts,nullptr,nullptr,clb,cub,obj) ;
+    solver.addRows(3,starts,cols,els,rlb,rub) ;
+    solver.int_[1] = true ;
+    solver.calls_ = 0 ;
+    const std::map<std::pair<double,double>, double> before =
+        solver.canonical() ;
+
+    ModelDelta delta ;
+    for (int k = 0 ; k < 10000 ; k++)
+        delta.setRowBounds(k%3, rlb[k%3], rub[k%3]+k) ;
+    const int newStarts[] = { 0, 2 } ;
+    const int newRows[] = { 0, 1 } ;
+    const double newEls[] = { 7.0, 8.0 } ;
+    const double newBounds[] = { 0.0 } ;
+    const double newUb[] = { 4.0 } ;
+    const double newObj[] = { 14.0 } ;
+    const int row0[] = { 0 } ;
+    const int col1[] = { 1, 1 } ;
+    delta.deleteRows(1,row0) ;
+    delta.addCols(1,newStarts,newRows,newEls,newBounds,newUb,newObj) ;
+    delta.deleteCols(2,col1) ;
+    delta.setColBounds(1,0.0,2.5) ;
+    delta.setObjCoeff(2,15.0) ;
+    ModelDelta undo ;
+    if (delta.getNumEdits() != 6 || delta.apply(&solver,&undo) != 6 ||
+        solver.getNumRows() != 2 || solver.getNumCols() != 3 ||
+        solver.calls_ != 6 || solver.rub_[1] != 30.0+9998 ||
+        solver.cub_[1] != 2.5 || solver.obj_[2] != 15.0 ||
+        solver.a_[0][2] != 7.0 || solver.a_[1][2] != 8.0) {
+        errcnt++ ;
+        std::cout << "ModelDelta failed to apply a batch." << std::endl ;
+    }
+    ModelDelta redo ;
+    undo.apply(&solver,&redo) ;
+    if (solver.getNumRows() != 3 || solver.getNumCols() != 3 ||
+        solver.canonical() != before) {
+        errcnt++ ;
+        std::cout << "ModelDelta failed to undo a batch." << std::endl ;
+    }
+    redo.apply(&solver) ;
+    if (solver.getNumRows() != 2 || solver.getNumCols() != 3 ||
+        solver.obj_[2] != 15.0 || solver.rub_[1] != 30.0+9998) {
+        errcnt++ ;
+        std::cout << "ModelDelta failed to redo a batch." << std::endl ;
+    }
+    return (errcnt) ;
+}
+
+/*
+  Enough more of a solver for a scenario run: a "solve" puts every column
+  at its lower bound and is optimal unless some column's bounds cross.
+*/
+struct ScenarioSolver : public DeltaSolver {
+    ScenarioSolver () : optimal_(false), objValue_(0.0), warmSets_(0) { }
+    CoinWarmStart *getWarmStart () const { return (new CoinWarmStartBasis()) ; }
+    bool setWarmStart (const CoinWarmStart *)
+    {
+        warmSets_++ ;
+        return (true) ;
+    }
+    void resolve ()
+    {
+        optimal_ = true ;
+        objValue_ = 0.0 ;
+        for (int j = 0 ; j < getNumCols() ; j++) {
+            if (clb_[j] > cub_[j]) optimal_ = false ;
+            objValue_ += obj_[j]*clb_[j] ;
+        }
+        x_ = clb_ ;
+    }
+    bool isProvenOptimal () const { return (optimal_) ; }
+    bool isProvenPrimalInfeasible () const { return (!optimal_) ; }
+    bool isDualObjectiveLimitReached () const { return (false) ; }
+    double getObjValue () const { return (objValue_) ; }
+    int getIterationCount () const { return (1) ; }
+    const double *getColSolution () const { return (&x_[0]) ; }
+    bool optimal_ ;
+    double objValue_ ;
+    std::vector<double> x_ ;
+    int warmSets_ ;
+} ;
+
+/*
+  Each scenario raises one column's lower bound; the last crosses its
+  bounds. Solved in forked workers, the scenarios leave the object in the
+  parent untouched.
+*/
+int testScenarios ()
+{
+    int errcnt = 0 ;
+    ScenarioSolver solver ;
+    const double clb[] = { 0.0, 0.0, 0.0 } ;
+    const double cub[] = { 1.0, 2.0, 3.0 } ;
+    const double obj[] = { 11.0, 12.0, 13.0 } ;
+    const int noStarts[] = { 0, 0, 0, 0 } ;
+    solver.addCols(3,noStarts,nullptr,nullptr,clb,cub,obj) ;
+    solver.calls_ = 0 ;
+
+    const int numScenarios = 7 ;
+    std::vector<ModelDelta> scenarios(numScenarios) ;
+    for (int k = 0 ; k < numScenarios-1 ; k++)
+        scenarios[k].setColBounds(k%3, 1.0, cub[k%3]) ;
+    scenarios[numScenarios-1].setColBounds(2, 5.0, cub[2]) ;
+
+    ControlAPI_Imp ctrlAPI ;
+    std::vector<ScenarioResult> results ;
+    const int notRun = ctrlAPI.runScenarios(&solver,scenarios,results,3,true) ;
+    if (notRun != 0 || static_cast<int>(results.size()) != numScenarios) {
+        errcnt++ ;
+        std::cout
+	  << "Scenario run left " << notRun << " scenarios unsolved."
+	  << std::endl ;
+    } else {
+        for (int k = 0 ; k < numScenarios ; k++) {
+            const ScenarioResult &result = results[k] ;
+            const bool last = (k == numScenarios-1) ;
+            const double z = last ? 5.0*obj[2] : obj[k%3] ;
+            if (result.status_ != (last ? ScenarioResult::Infeasible :
+                                          ScenarioResult::Optimal) ||
+                    result.objValue_ != z || result.colSolution_.size() != 3 ||
+                    result.colSolution_[last ? 2 : k%3] != (last ? 5.0 : 1.0)) {
+                errcnt++ ;
+                std::cout
+		  << "Wrong result for scenario " << k << "." << std::endl ;
+            }
+        }
+    }
+#   ifndef WIN32
+    if (solver.calls_ != 0 || solver.warmSets_ != 0) {
+        errcnt++ ;
+        std::cout
+	  << "Scenarios were solved in the parent, not in workers."
+	  << std::endl ;
+    }
+#   endif
+    for (int j = 0 ; j < 3 ; j++) {
+        if (solver.clb_[j] != clb[j]) {
+            errcnt++ ;
+            std::cout
+	      << "Scenario run changed the base model." << std::endl ;
+            break ;
+        }
+    }
+    if (ctrlAPI.runScenarios(&solver,std::vector<ModelDelta>(),results) != 0 ||
+            !results.empty()) {
+        errcnt++ ;
+        std::cout << "Empty scenario run went wrong." << std::endl ;
+    }
+
+    return (errcnt) ;
+}
+
+/*
+  A scenario solver with rows that matter, for a batch resolve: a solve is
+  infeasible if some row's lower bound is over 50, and the row duals are
+  the row lower bounds. Each solve's row upper bounds are kept.
+*/
+struct BatchSolver : public ScenarioSolver {
+    void resolve ()
+    {
+        ScenarioSolver::resolve() ;
+        for (int i = 0 ; i < getNumRows() ; i++) {
+            if (rlb_[i] > 50.0) optimal_ = false ;
+        }
+        y_ = rlb_ ;
+        seenUpper_.push_back(rub_) ;
+    }
+    void setObjective (const double *obj)
+    {
+        calls_++ ;
+        obj_.assign(obj, obj+getNumCols()) ;
+    }
+    const double *getRowPrice () const { return (&y_[0]) ; }
+    bool isProvenDualInfeasible () const { return (false) ; }
+    bool isAbandoned () const { return (false) ; }
+    double getInfinity () const { return (1.0e30) ; }
+    std::vector<double> y_ ;
+    std::vector<std::vector<double> > seenUpper_ ;
+} ;
+
+/*
+  Right-hand sides land on the right bound for each kind of row, a
+  variant after an infeasible one starts from the last optimal basis, and
+  the model is put back afterwards. Then a batch of objectives.
+*/
+int testBatchResolve ()
+{
+    int errcnt = 0 ;
+    BatchSolver solver ;
+    const double inf = solver.getInfinity() ;
+    const double clb[] = { 1.0, 1.0, 1.0 } ;
+    const double cub[] = { 2.0, 2.0, 2.0 } ;
+    const double obj[] = { 1.0, 1.0, 1.0 } ;
+    const int noStarts[] = { 0, 0, 0, 0 } ;
+    solver.addCols(3,noStarts,nullptr,nullptr,clb,cub,obj) ;
+    const int starts[] = { 0, 1, 2, 3 } ;
+    const int cols[] = { 0, 1, 2 } ;
+    const double els[] = { 1.0, 1.0, 1.0 } ;
+    // A <= row, a >= row, and a ranged row of range 3
+    const double rlb[] = { -inf, 2.0, 1.0 } ;
+    const double rub[] = { 10.0, inf, 4.0 } ;
+    solver.addRows(3,starts,cols,els,rlb,rub) ;
+
+    const double rhs[] = { 5.0, 6.0, 8.0,
+                           5.0, 60.0, 8.0,
+                           7.0, 3.0, 9.0 } ;
+    BatchResult results ;
+    int numOptimal = resolveBatchOf(&solver,BatchRhs,3,rhs,results,true) ;
+    if (numOptimal != 2 || results.numVariants_ != 3 ||
+            results.status_[0] != 0 || results.status_[1] != 1 ||
+            results.status_[2] != 0 || solver.warmSets_ != 1) {
+        errcnt++ ;
+        std::cout
+	  << "Batch of right-hand sides: " << numOptimal << " optimal, "
+	  << solver.warmSets_ << " bases restored." << std::endl ;
+    } else {
+        const double *y = results.rowPrice(2) ;
+        const std::vector<double> &ub = solver.seenUpper_[2] ;
+        if (y[0] != -inf || y[1] != 3.0 || y[2] != 6.0 ||
+                ub[0] != 7.0 || ub[1] != inf || ub[2] != 9.0 ||
+                results.colSolution(2)[1] != 1.0) {
+            errcnt++ ;
+            std::cout
+	      << "Right-hand sides went to the wrong row bounds." << std::endl ;
+        }
+    }
+    for (int i = 0 ; i < 3 ; i++) {
+        if (solver.rlb_[i] != rlb[i] || solver.rub_[i] != rub[i]) {
+            errcnt++ ;
+            std::cout
+	      << "Batch resolve didn't restore the row bounds." << std::endl ;
+            break ;
+        }
+    }
+
+    const double objs[] = { 1.0, 2.0, 3.0,
+                            0.0, 0.0, -1.0 } ;
+    numOptimal = resolveBatchOf(&solver,BatchObjective,2,objs,results,false) ;
+    if (numOptimal != 2 || results.objValue_[0] != 6.0 ||
+            results.objValue_[1] != -1.0 || !results.rowPrice_.empty() ||
+            solver.obj_[2] != obj[2]) {
+        errcnt++ ;
+        std::cout << "Batch of objectives went wrong." << std::endl ;
+    }
+    if (resolveBatchOf(&solver,BatchRhs,1,nullptr,results,false) != -1) {
+        errcnt++ ;
+        std::cout << "Batch resolve accepted no variants." << std::endl ;
+    }
+
+    return (errcnt) ;
+}
+
+/*
+  Messages delivered by a LogSink, as "thread seq" pairs, with a count of
+  those out of order for their thread.
+*/
+struct LogRecorder {
+    LogRecorder () : numDelivered_(0), outOfOrder_(0), longest_(0) { }
+    static void deliver (void *ctx, int, const char *text)
+    {
+        LogRecorder *rec = static_cast<LogRecorder *>(ctx) ;
+        int thread = 0 ;
+        int seq = 0 ;
+        std::istringstream in(text) ;
+        in >> thread >> seq ;
+        if (seq != rec->next_[thread]) rec->outOfOrder_++ ;
+        rec->next_[thread] = seq+1 ;
+        rec->numDelivered_++ ;
+        rec->longest_ = std::max(rec->longest_,
+                                 static_cast<int>(std::strlen(text))) ;
+    }
+    std::map<int,int> next_ ;
+    int numDelivered_ ;
+    int outOfOrder_ ;
+    int longest_ ;
+} ;
+
+struct LogPosterArgs {
+    LogSink *sink_ ;
+    int thread_ ;
+    int reps_ ;
+} ;
+
+void *logPoster (void *arg)
+{
+    LogPosterArgs *args = static_cast<LogPosterArgs *>(arg) ;
+    for (int i = 0 ; i < args->reps_ ; i++) {
+        std::ostringstream text ;
+        text << args->thread_ << " " << i ;
+        args->sink_->post(3,text.str().c_str()) ;
+    }
+    return (nullptr) ;
+}
+
+/*
+  Several threads post at once; each thread's messages must arrive whole
+  and in order. No thread posts more than a ring holds, so none may be
+  dropped. Then the plugin
+  manager's end: the level plugins see follows setLogLvl.
+*/
+int testLogSink ()
+{
+    int errcnt = 0 ;
+    const int numThreads = 4 ;
+    const int reps = LogSink::ringSize ;
+    LogRecorder rec ;
+    std::vector<LogPosterArgs> args(numThreads) ;
+    std::vector<pthread_t> threads(numThreads) ;
+    {
+        LogSink sink(LogRecorder::deliver,&rec) ;
+        for (int k = 0 ; k < numThreads ; k++) {
+            args[k].sink_ = &sink ;
+            args[k].thread_ = k ;
+            args[k].reps_ = reps ;
+            rec.next_[k] = 0 ;
+            pthread_create(&threads[k],nullptr,logPoster,&args[k]) ;
+        }
+        for (int k = 0 ; k < numThreads ; k++) pthread_join(threads[k],nullptr) ;
+        sink.flush() ;
+        if (rec.numDelivered_ != numThreads*reps || sink.getNumDropped() != 0) {
+            errcnt++ ;
+            std::cout
+                << "LogSink delivered " << rec.numDelivered_ << " of "
+                << numThreads*reps << " messages." << std::endl ;
+        }
+        const std::string longMsg(2*LogSink::maxMsgLen,'x') ;
+        sink.post(3,("99 0 "+longMsg).c_str()) ;
+    }
+    if (rec.outOfOrder_ != 0) {
+        errcnt++ ;
+        std::cout << "LogSink delivered messages out of order." << std::endl ;
+    }
+    if (rec.longest_ != LogSink::maxMsgLen-1) {
+        errcnt++ ;
+        std::cout << "LogSink failed to truncate a long message." << std::endl ;
+    }
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    const int oldLvl = plugMgr.getLogLvl() ;
+    const PlatformServices &services = plugMgr.getPlatformServices() ;
+    plugMgr.setLogLvl(2) ;
+    if (services.log_ == nullptr || services.logLevel_ == nullptr ||
+        *services.logLevel_ != 2 || services.version_.minor_ < 2) {
+        errcnt++ ;
+        std::cout << "PluginManager doesn't offer its log service." << std::endl ;
+    }
+    plugMgr.setLogLvl(oldLvl) ;
+    return (errcnt) ;
+}
+
+/*
+  Spans are recorded only while tracing is enabled, and come out as
+  complete events with their details escaped. The plugin manager traces
+  loadOneLib and DynamicLibrary::load whether or not the library loads.
+*/
+int testTrace ()
+{
+    int errcnt = 0 ;
+    Trace::clear() ;
+    {
+        TraceSpan span("test","ignored") ;
+    }
+    if (Trace::getNumEvents() != 0) {
+        errcnt++ ;
+        std::cout << "Trace recorded a span while disabled." << std::endl ;
+    }
+    Trace::setEnabled(true) ;
+    {
+        TraceSpan outer("test","outer","say \"hi\"") ;
+        TraceSpan inner("test","inner") ;
+    }
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    const int oldLvl = plugMgr.getLogLvl() ;
+    plugMgr.setLogLvl(0) ;
+    plugMgr.loadOneLib("libOsi2NoSuchShim.so") ;
+    plugMgr.setLogLvl(oldLvl) ;
+    Trace::setEnabled(false) ;
+    std::ostringstream json ;
+    Trace::writeJSON(json) ;
+    const std::string text = json.str() ;
+    if (Trace::getNumEvents() != 4 ||
+        text.find("\"name\":\"outer\"") == std::string::npos ||
+        text.find("\"detail\":\"say \\\"hi\\\"\"") == std::string::npos ||
+        text.find("\"name\":\"loadOneLib\"") == std::string::npos ||
+        text.find("\"name\":\"DynamicLibrary::load\"") == std::string::npos ||
+        text.find("\"ph\":\"X\"") == std::string::npos) {
+        errcnt++ ;
+        std::cout << "Trace output is wrong:" << std::endl << text << std::endl ;
+    }
+    Trace::clear() ;
+    return (errcnt) ;
+}
+
+/*
+  Write \p text to the file \p path, replacing what's there.
+*/
+void writeFile (const std::string &path, const char *text)
+{
+    int fd = open(path.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644) ;
+    if (fd < 0) return ;
+    ssize_t len = write(fd,text,std::strlen(text)) ;
+    (void) len ;
+    close(fd) ;
+}
+
+/*
+  Additions and rewrites in a cached directory are reported as changes; a
+  file that comes and goes between looks is not. With a watch, none of it
+  costs another full listing. The plugin manager reports a manifest's
+  change as its library's.
+*/
+int testDirCache ()
+{
+    int errcnt = 0 ;
+    std::ostringstream dirName ;
+    dirName << "/tmp/osi2dircache-test." << getpid() ;
+    const std::string dir = dirName.str() ;
+    mkdir(dir.c_str(),0755) ;
+    writeFile(dir+"/a.so","a") ;
+    DirCache cache ;
+    DirCache::EntryMap entries ;
+    std::vector<std::string> changed ;
+    std::string errStr ;
+    if (cache.list(dir,entries,errStr) != 0 || entries.size() != 1 ||
+        !entries["a.so"].isFile_ || entries["a.so"].size_ != 1) {
+        errcnt++ ;
+        std::cout << "DirCache listed " << dir << " wrongly." << std::endl ;
+    }
+    cache.takeChanges(dir,changed,errStr) ;
+    writeFile(dir+"/b.so","b") ;
+    writeFile(dir+"/a.so","aa") ;
+    unlink((dir+"/b.so").c_str()) ;
+    writeFile(dir+"/c.so","c") ;
+    changed.clear() ;
+    cache.takeChanges(dir,changed,errStr) ;
+    if (changed.size() != 2 || changed[0] != "a.so" || changed[1] != "c.so") {
+        errcnt++ ;
+        std::cout << "DirCache reported " << changed.size()
+                  << " changes, expected 2." << std::endl ;
+    }
+    if (cache.isWatched(dir) && cache.getNumFullScans() != 1) {
+        errcnt++ ;
+        std::cout << "DirCache listed a watched directory "
+                  << cache.getNumFullScans() << " times." << std::endl ;
+    }
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    std::vector<std::string> libs ;
+    plugMgr.getPluginDirChanges(dir,libs) ;
+    writeFile(dir+"/c.so.manifest","") ;
+    writeFile(dir+"/notes.txt","") ;
+    plugMgr.getPluginDirChanges(dir,libs) ;
+    if (libs.size() != 1 || libs[0] != "c.so") {
+        errcnt++ ;
+        std::cout << "PluginManager reported " << libs.size()
+                  << " changed libraries, expected 1." << std::endl ;
+    }
+    const char *names[] = { "a.so", "c.so", "c.so.manifest", "notes.txt" } ;
+    for (int i = 0 ; i < 4 ; i++) unlink((dir+"/"+names[i]).c_str()) ;
+    rmdir(dir.c_str()) ;
+    return (errcnt) ;
+}
+
+/*
+  Thread pool tasks: count, and count again in nested tasks that wait for
+  tasks of their own.
+*/
+volatile int poolCount = 0 ;
+
+void countTask (void *)
+{
+    atomicAdd(&poolCount, 1) ;
+}
+
+void nestedTask (void *arg)
+{
+    const PluginThreads &threads = *static_cast<const PluginThreads *>(arg) ;
+    TaskGroup group ;
+    group.pending_ = 0 ;
+    for (int i = 0 ; i < 8 ; i++) threads.submit(countTask, nullptr, &group) ;
+    threads.wait(&group) ;
+}
+
+/*
+  A plugin's view of the thread pool: found once through invokeService_,
+  then used directly. Tasks that wait for their own tasks don't deadlock
+  the pool, a pool of no workers runs everything in the caller, and an
+  unknown service is refused. MpsReader gives the same answer in the pool
+  as in a thread of its own.
+*/
+int testThreadPool (const std::string &sampleDir)
+{
+    int errcnt = 0 ;
+    PluginManager &plugMgr = PluginManager::getInstance() ;
+    PlatformServices &services = plugMgr.getPlatformServices() ;
+    ThreadPool &pool = plugMgr.getThreadPool() ;
+    pool.setNumThreads(3) ;
+    PluginThreads threads ;
+    threads.init(&services) ;
+    if (!threads.enabled() || threads.getNumThreads() != 3) {
+        std::cout << "Thread pool service not found." << std::endl ;
+        return (1) ;
+    }
+    const int numTasks = 16 ;
+    std::vector<void *> args(numTasks, static_cast<void *>(&threads)) ;
+    poolCount = 0 ;
+    threads.run(nestedTask, &args[0], numTasks) ;
+    if (poolCount != 8*numTasks) {
+        errcnt++ ;
+        std::cout << "Thread pool ran " << poolCount << " tasks, expected "
+                  << 8*numTasks << "." << std::endl ;
+    }
+    ThreadPool::Stats stats ;
+    pool.getStats(stats) ;
+    if (stats.numThreads_ != 3 || stats.numRun_ < numTasks-1) {
+        errcnt++ ;
+        std::cout << "Thread pool ran " << stats.numRun_ << " tasks in "
+                  << stats.numThreads_ << " threads." << std::endl ;
+    }
+    pool.setNumThreads(0) ;
+    PluginThreads inline0 ;
+    inline0.init(&services) ;
+    poolCount = 0 ;
+    TaskGroup group ;
+    group.pending_ = 0 ;
+    inline0.submit(countTask, nullptr, &group) ;
+    if (inline0.getNumThreads() != 0 || poolCount != 1 || group.pending_ != 0) {
+        errcnt++ ;
+        std::cout << "Thread pool of no workers didn't run a task inline."
+                  << std::endl ;
+    }
+    pool.setNumThreads(3) ;
+    int oldLogLvl = plugMgr.getLogLvl() ;
+    plugMgr.setLogLvl(0) ;
+    int dummy = 0 ;
+    const CharString *bogus = reinterpret_cast<const CharString *>("NoSuch") ;
+    if (services.invokeService_(bogus, &dummy) != -1) {
+        errcnt++ ;
+        std::cout << "Unknown service wasn't refused." << std::endl ;
+    }
+    plugMgr.setLogLvl(oldLogLvl) ;
+    std::string path = sampleDir+"/brandy.mps" ;
+    MpsReader serial ;
+    serial.setNumThreads(1) ;
+    MpsReader pooled ;
+    pooled.setThreads(threads) ;
+    pooled.setChunkSize(64) ;
+    if (serial.readFile(path) != 0 || pooled.readFile(path) != 0 ||
+        serial.getNumElements() != pooled.getNumElements() ||
+        !std::equal(serial.getValues(),
+                    serial.getValues()+serial.getNumElements(),
+                    pooled.getValues())) {
+        errcnt++ ;
+        std::cout << "MpsReader in the thread pool read " << path
+                  << " differently." << std::endl ;
+    }
+    pool.setNumThreads(-1) ;
+    return (errcnt) ;
+}
+
+/*
+  Copies of a token share one request; cancellation wins over the deadline,
+  and a deadline can be taken off again.
+*/
+int testCancelToken ()
+{
+    int errcnt = 0 ;
+    CancelToken token ;
+    CancelToken copy(token) ;
+    CancelToken other ;
+    if (token.shouldStop() || token.getMillisecsLeft() != -1 ||
+        !copy.sameAs(token) || other.sameAs(token)) {
+        errcnt++ ;
+        std::cout << "New CancelToken isn't clear." << std::endl ;
+    }
+    copy.setDeadline(60000) ;
+    const int left = token.getMillisecsLeft() ;
+    if (left <= 0 || left > 60000 || token.isExpired()) {
+        errcnt++ ;
+        std::cout << "CancelToken deadline " << left
+                  << " ms away, expected 60000." << std::endl ;
+    }
+    copy.setDeadline(0) ;
+    if (token.getStopReason() != CancelToken::DeadlineExpired ||
+        token.getMillisecsLeft() != 0) {
+        errcnt++ ;
+        std::cout << "CancelToken deadline didn't pass." << std::endl ;
+    }
+    copy.setDeadline(-1) ;
+    if (token.shouldStop()) {
+        errcnt++ ;
+        std::cout << "CancelToken deadline wasn't removed." << std::endl ;
+    }
+    copy.setDeadline(0) ;
+    token.cancel() ;
+    other = copy ;
+    if (other.getStopReason() != CancelToken::Cancelled ||
+        !other.isCancelled()) {
+        errcnt++ ;
+        std::cout << "Cancelled CancelToken doesn't say so." << std::endl ;
+    }
+    return (errcnt) ;
+}
+
+/*
+  The solve history tries each library once, then sticks with the fastest
+  apart from the odd random pick; a library that gives up is charged for
+  it. Records survive in the history file, and a file that isn't a history
+  is refused.
+*/
+int testSolveHistory ()
+{
+    int errcnt = 0 ;
+    SolveHistory::Features lp = { 100, 200, 1000, 0 } ;
+    SolveHistory::Features mip = lp ;
+    mip.numIntegers_ = 150 ;
+    if (SolveHistory::classOf(lp) == SolveHistory::classOf(mip)) {
+        errcnt++ ;
+        std::cout << "SolveHistory puts LP and MIP in one class." << std::endl ;
+    }
+    SolveHistory history ;
+    history.setExploration(0.0) ;
+    std::vector<std::string> libs ;
+    libs.push_back("slow") ;
+    libs.push_back("fast") ;
+    bool explored = false ;
+    int pick = history.choose(lp, libs, &explored) ;
+    history.record(lp, libs[pick], 1.0) ;
+    int second = history.choose(lp, libs, &explored) ;
+    history.record(lp, libs[second], 0.1) ;
+    if (pick != 0 || second != 1 || !explored) {
+        errcnt++ ;
+        std::cout << "SolveHistory didn't try each library first." << std::endl ;
+    }
+    pick = history.choose(lp, libs, &explored) ;
+    if (pick != 1 || explored) {
+        errcnt++ ;
+        std::cout << "SolveHistory chose " << pick << ", expected 1."
+                  << std::endl ;
+    }
+    if (history.choose(mip, libs) != 0) {
+        errcnt++ ;
+        std::cout << "SolveHistory applied LP times to a MIP." << std::endl ;
+    }
+    history.record(lp, "fast", 0.1, false) ;
+    if (history.choose(lp, libs) != 0) {
+        errcnt++ ;
+        std::cout << "SolveHistory ignored a failed solve." << std::endl ;
+    }
+    history.setExploration(1.0) ;
+    history.setSeed(12345) ;
+    int picks[2] = { 0, 0 } ;
+    for (int i = 0 ; i < 100 ; i++) picks[history.choose(lp, libs)]++ ;
+    if (picks[0] == 0 || picks[1] == 0) {
+        errcnt++ ;
+        std::cout << "SolveHistory never explored." << std::endl ;
+    }
+    /*
+      Persistence.
+    */
+    std::ostringstream fileName ;
+    fileName << "/tmp/osi2history-test." << getpid() ;
+    const std::string path = fileName.str() ;
+    unlink(path.c_str()) ;
+    if (history.setFile(path) != 0) {
+        errcnt++ ;
+        std::cout << "SolveHistory can't use " << path << "." << std::endl ;
+    }
+    history.record(mip, "fast", 2.0) ;
+    SolveHistory reread ;
+    double meanSecs = 0.0 ;
+    if (reread.setFile(path) != 0 ||
+        reread.getRecord(mip, "fast", meanSecs) != 1 || meanSecs != 2.0 ||
+        reread.getRecord(lp, "fast", meanSecs) != 2) {
+        errcnt++ ;
+        std::cout << "SolveHistory records didn't survive in " << path << "."
+                  << std::endl ;
+    }
+    writeFile(path, "not a history\n") ;
+    if (reread.setFile(path) == 0) {
+        errcnt++ ;
+        std::cout << "SolveHistory accepted a file that isn't a history."
+                  << std::endl ;
+    }
+    unlink(path.c_str()) ;
+    /*
+      Through a control API: without a history nothing is recorded.
+    */
+    ControlAPI_Imp ctrlAPI ;
+    ctrlAPI.setLogLvl(0) ;
+    if (ctrlAPI.recordSolve(nullptr, lp, 1.0, true) != -1 ||
+        ctrlAPI.enableSolveHistory() != 0 ||
+        ctrlAPI.getSolveHistory() == nullptr ||
+        ctrlAPI.recordSolve(nullptr, lp, 1.0, true) != -3) {
+        errcnt++ ;
+        std::cout << "ControlAPI solve history misbehaves." << std::endl ;
+    }
+    ctrlAPI.disableSolveHistory() ;
+    return (errcnt) ;
+}
+
+/*
+  A job that notes the node it ran on.
+*/
+struct NodeJob : public AsyncJob {
+    explicit NodeJob (volatile int *node) : node_(node) { }
+    int run ()
+    {
+        *node_ = numaCurrentNode() ;
+        return (0) ;
+    }
+    volatile int *node_ ;
+} ;
+
+/*
+  A thread that pins itself to node 0 and notes where it ends up.
+*/
+void *bindMain (void *arg)
+{
+    int *result = static_cast<int *>(arg) ;
+    result[0] = numaBindThread(0) ? 1 : 0 ;
+    result[1] = numaCurrentNode() ;
+    return (nullptr) ;
+}
+
+/*
+  A made-up topology of two nodes, numbered 0 and 2 by the system, reads
+  back as nodes 0 and 1. The machine's own topology places a thread where
+  it was asked, pages that can be moved are moved, and the solve pool runs
+  jobs queued for a node, for any node, and for a node it doesn't have.
+  A replica of a snapshot holds the same problem in memory of its own.
+*/
+int testNuma ()
+{
+    int errcnt = 0 ;
+    std::ostringstream dirName ;
+    dirName << "/tmp/osi2numa-test." << getpid() ;
+    const std::string dir = dirName.str() ;
+    mkdir(dir.c_str(),0755) ;
+    mkdir((dir+"/node0").c_str(),0755) ;
+    mkdir((dir+"/node2").c_str(),0755) ;
+    writeFile(dir+"/online","0,2\n") ;
+    writeFile(dir+"/node0/cpulist","0-1,4\n") ;
+    writeFile(dir+"/node2/cpulist","2-3,5-7\n") ;
+    NumaTopology fake ;
+    if (fake.load(dir) != 2 || fake.getCpus(0).size() != 3 ||
+            fake.getCpus(1).size() != 5 || fake.getNodeOfCpu(4) != 0 ||
+            fake.getNodeOfCpu(6) != 1 || fake.getSystemNode(1) != 2 ||
+            !fake.getCpus(2).empty()) {
+        errcnt++ ;
+        std::cout << "NumaTopology read " << dir << " wrongly." << std::endl ;
+    }
+    writeFile(dir+"/node2/cpulist","3-2\n") ;
+    if (fake.load(dir) != -1 || fake.getNumNodes() != 1) {
+        errcnt++ ;
+        std::cout << "NumaTopology took a bad cpu list." << std::endl ;
+    }
+    unlink((dir+"/node0/cpulist").c_str()) ;
+    unlink((dir+"/node2/cpulist").c_str()) ;
+    unlink((dir+"/online").c_str()) ;
+    rmdir((dir+"/node0").c_str()) ;
+    rmdir((dir+"/node2").c_str()) ;
+    rmdir(dir.c_str()) ;
+
+    const NumaTopology &machine = NumaTopology::system() ;
+    const int numNodes = machine.getNumNodes() ;
+    std::cout << "  " << numNodes << " NUMA nodes." << std::endl ;
+    if (numaBindThread(numNodes) || numaCurrentNode() < 0 ||
+            numaCurrentNode() >= numNodes) {
+        errcnt++ ;
+        std::cout << "NUMA placement of the calling thread is off." << std::endl ;
+    }
+    int bound[2] = { 0, -1 } ;
+    ThreadHandle thread ;
+    if (startThread(thread,bindMain,bound)) {
+        joinThread(thread) ;
+        if (bound[0] == 1 && bound[1] != 0) {
+            errcnt++ ;
+            std::cout << "Thread pinned to node 0 ran on node " << bound[1]
+                      << "." << std::endl ;
+        }
+    }
+    std::vector<double> block(4*4096,1.0) ;
+    const long moved = numaMigrate(&block[0],block.size()*sizeof(double),0) ;
+    const int where = numaNodeOf(&block[0]) ;
+    if (moved == 0 || (moved > 0 && where != 0)) {
+        errcnt++ ;
+        std::cout << "Moved " << moved << " pages to node 0; the block is on "
+                  << where << "." << std::endl ;
+    }
+
+    volatile int nodes[3] = { -2, -2, -2 } ;
+    {
+        SolvePool pool ;
+        if (pool.start(2,true) != 2) {
+            errcnt++ ;
+            std::cout << "SolvePool didn't start placed threads." << std::endl ;
+        }
+        SolveFuture onNode = pool.submit(new NodeJob(&nodes[0]),0) ;
+        SolveFuture anyNode = pool.submit(new NodeJob(&nodes[1])) ;
+        SolveFuture noNode = pool.submit(new NodeJob(&nodes[2]),numNodes+5) ;
+        if (!onNode.wait() || !anyNode.wait() || !noNode.wait() ||
+                nodes[0] < 0 || nodes[1] < 0 || nodes[2] < 0) {
+            errcnt++ ;
+            std::cout << "SolvePool didn't run jobs queued by node."
+                      << std::endl ;
+        }
+    }
+    ControlAPI_Imp ctrlAPI ;
+    if (ctrlAPI.getNumaNode(3) != -1 ||
+            ctrlAPI.setNumaPlacement(true) != numNodes ||
+            !ctrlAPI.getNumaPlacement() ||
+            ctrlAPI.getNumaNode(numNodes+1) != 1%numNodes) {
+        errcnt++ ;
+        std::cout << "ControlAPI NUMA placement is off." << std::endl ;
+    }
+
+    const int starts[] = { 0, 1, 2 } ;
+    const int rows[] = { 0, 0 } ;
+    const double els[] = { 1.0, 2.0 } ;
+    const double clb[] = { 0.0, 0.0 } ;
+    const double cub[] = { 1.0, 3.0 } ;
+    const double obj[] = { -1.0, -1.0 } ;
+    const double rlb[] = { -1.0e30 } ;
+    const double rub[] = { 4.0 } ;
+    ModelSnapshot::Problem prob ;
+    prob.numCols_ = 2 ;
+    prob.numRows_ = 1 ;
+    prob.start_ = starts ;
+    prob.index_ = rows ;
+    prob.value_ = els ;
+    prob.colLower_ = clb ;
+    prob.colUpper_ = cub ;
+    prob.obj_ = obj ;
+    prob.rowLower_ = rlb ;
+    prob.rowUpper_ = rub ;
+    std::ostringstream snapPath ;
+    snapPath << "/tmp/osi2numa-snapshot." << getpid() ;
+    std::string errStr ;
+    ModelSnapshot shared ;
+    ModelSnapshot local ;
+    if (local.replicate(shared) != -1) {
+        errcnt++ ;
+        std::cout << "Replicated an empty snapshot." << std::endl ;
+    }
+    if (ModelSnapshot::write(snapPath.str(),prob,errStr) != 0 ||
+            shared.read(snapPath.str()) != 0 || local.replicate(shared) != 0) {
+        errcnt++ ;
+        std::cout << "Couldn't replicate a snapshot: " << errStr
+                  << shared.getError() << local.getError() << std::endl ;
+    } else {
+        const ModelSnapshot::Problem &copy = local.getProblem() ;
+        if (copy.numCols_ != 2 || copy.value_ == shared.getProblem().value_ ||
+                copy.value_[1] != 2.0 || copy.colUpper_[1] != 3.0 ||
+                copy.rowUpper_[0] != 4.0) {
+            errcnt++ ;
+            std::cout << "Snapshot replica differs." << std::endl ;
+        }
+    }
+    unlink(snapPath.str().c_str()) ;
+
+    return (errcnt) ;
+}
+
+/*
+  Every kernel the build and the processor have, against plain loops, at
+  lengths that leave each vector width a tail.
+*/
+int testKernels ()
+{
+    int errcnt = 0 ;
+    const KernelIsa original = getKernelIsa() ;
+    const int maxLen = 21 ;
+    std::vector<double> vals(maxLen), x(2*maxLen) ;
+    std::vector<int> ind(maxLen) ;
+    for (int k = 0 ; k < maxLen ; k++) {
+        vals[k] = ((k%3 == 0) ? -1.0 : 1.0)*(k+1)*0.25 ;
+        ind[k] = (7*k+3)%(2*maxLen) ;
+    }
+    for (int k = 0 ; k < 2*maxLen ; k++) x[k] = 1.0/(k+1) ;
+    const KernelIsa isas[] = {
+        KernelScalar, KernelNeon, KernelAvx2, KernelAvx512
+    } ;
+    for (int i = 0 ; i < 4 ; i++) {
+        if (!setKernelIsa(isas[i])) continue ;
+        std::cout << "  kernels: " << kernelIsaName(isas[i]) << std::endl ;
+        for (int len = 0 ; len <= maxLen ; len++) {
+            double largest = 0.0 ;
+            double dot = 0.0 ;
+            for (int k = 0 ; k < len ; k++) {
+                largest = std::max(largest,std::fabs(vals[k])) ;
+                dot += vals[k]*x[ind[k]] ;
+            }
+            std::vector<double> scaled(vals.begin(),vals.begin()+len) ;
+            kernelScale(len,len ? &scaled[0] : nullptr,-2.0) ;
+            bool scaledOk = true ;
+            for (int k = 0 ; k < len ; k++)
+                scaledOk = scaledOk && (scaled[k] == -2.0*vals[k]) ;
+            std::vector<double> clamped(vals.begin(),vals.begin()+len) ;
+            int over = 0 ;
+            for (int k = 0 ; k < len ; k++)
+                if (std::fabs(vals[k]) > 2.0) over++ ;
+            const int changed =
+                kernelClampInfinite(len,len ? &clamped[0] : nullptr,2.0) ;
+            bool clampedOk = (changed == over) ;
+            for (int k = 0 ; k < len ; k++) {
+                const double want = std::max(-2.0,std::min(2.0,vals[k])) ;
+                clampedOk = clampedOk && (clamped[k] == want) ;
+            }
+            const double got =
+                kernelSparseDot(len,&ind[0],&vals[0],&x[0]) ;
+            /*
+              ind repeats every six entries, so the wider axpys see
+              blocks that name an entry twice.
+            */
+            std::vector<double> axpy(x), wantAxpy(x) ;
+            kernelSparseAxpy(len,&ind[0],&vals[0],-3.0,&axpy[0]) ;
+            for (int k = 0 ; k < len ; k++)
+                wantAxpy[ind[k]] += vals[k]*-3.0 ;
+            if (kernelMaxAbs(len,&vals[0]) != largest || !scaledOk ||
+                    !clampedOk || axpy != wantAxpy ||
+                    std::fabs(got-dot) > 1.0e-12*(1.0+std::fabs(dot))) {
+                errcnt++ ;
+                std::cout << "Kernels (" << kernelIsaName(isas[i])
+                          << ") wrong at length " << len << "." << std::endl ;
+            }
+        }
+        /*
+          A 3x4 matrix by row and by column.
+        */
+        const int rowStarts[] = { 0, 2, 2, 5 } ;
+        const int rowInd[] = { 0, 3, 0, 1, 2 } ;
+        const double rowEl[] = { 1.0, 2.0, -1.0, 3.0, 0.5 } ;
+        const int colStarts[] = { 0, 2, 3, 4, 5 } ;
+        const int colInd[] = { 0, 2, 2, 2, 0 } ;
+        const double colEl[] = { 1.0, -1.0, 3.0, 0.5, 2.0 } ;
+        const double xs[] = { 1.0, 2.0, 4.0, 0.0 } ;
+        double byRow[3], byCol[3] ;
+        kernelRowTimes(3,rowStarts,rowInd,rowEl,xs,byRow) ;
+        kernelColTimes(4,colStarts,colInd,colEl,xs,3,byCol) ;
+        for (int r = 0 ; r < 3 ; r++) {
+            const double want = (r == 0) ? 1.0 : ((r == 1) ? 0.0 : 7.0) ;
+            if (byRow[r] != want || byCol[r] != want) {
+                errcnt++ ;
+                std::cout << "Kernels (" << kernelIsaName(isas[i])
+                          << ") got row " << r << " activity " << byRow[r]
+                          << ", " << byCol[r] << "." << std::endl ;
+            }
+        }
+    }
+    setKernelIsa(original) ;
+    if (!kernelIsaSupported(KernelScalar) || getKernelIsa() != original) {
+        errcnt++ ;
+        std::cout << "Kernel choice not restored." << std::endl ;
+    }
+    return (errcnt) ;
+}
+
+/*
+  A basis stored in a directory comes back once the memory copy is gone;
+  a file cut short, or with a status that isn't one, is a miss.
+*/
+int testWarmStartCache ()
+{
+    int errcnt = 0 ;
+    std::ostringstream dirName ;
+    dirName << "/tmp/osi2warmstart-test." << getpid() ;
+    const std::string dir = dirName.str() ;
+    mkdir(dir.c_str(),0755) ;
+    WarmStartCache cache ;
+    if (cache.setDirectory(dir) != 0) {
+        std::cout << "WarmStartCache refused " << dir << "." << std::endl ;
+        rmdir(dir.c_str()) ;
+        return (1) ;
+    }
+    const uint64_t key = 0x1234 ;
+    CoinWarmStartBasis basis ;
+    basis.setSize(2,1) ;
+    basis.setStructStatus(0,CoinWarmStartBasis::basic) ;
+    basis.setArtifStatus(0,CoinWarmStartBasis::atLowerBound) ;
+    cache.store(key,basis) ;
+    cache.clear() ;
+    CoinWarmStartBasis *found = cache.lookup(key,2,1) ;
+    if (found == nullptr) {
+        errcnt++ ;
+        std::cout << "WarmStartCache lost a basis on file." << std::endl ;
+    }
+    delete found ;
+    const std::string path = dir+"/0000000000001234.wsb" ;
+    std::vector<char> content ;
+    std::FILE *file = std::fopen(path.c_str(),"rb") ;
+    if (file != nullptr) {
+        char c ;
+        while (std::fread(&c,1,1,file) == 1) content.push_back(c) ;
+        std::fclose(file) ;
+    }
+    for (int bad = 0 ; bad < 2 && !content.empty() ; bad++) {
+        std::vector<char> corrupt(content) ;
+        if (bad == 0)
+            corrupt.pop_back() ;
+        else
+            corrupt.back() = 7 ;
+        file = std::fopen(path.c_str(),"wb") ;
+        if (file == nullptr) break ;
+        std::fwrite(&corrupt[0],1,corrupt.size(),file) ;
+        std::fclose(file) ;
+        cache.clear() ;
+        found = cache.lookup(key,2,1) ;
+        if (found != nullptr) {
+            errcnt++ ;
+            std::cout
+                << "WarmStartCache took a basis file "
+                << ((bad == 0) ? "cut short." : "with a bad status.")
+                << std::endl ;
+        }
+        delete found ;
+    }
+    unlink(path.c_str()) ;
+    rmdir(dir.c_str()) ;
+    return (errcnt) ;
+}
+
+/*
+  Load targets for a shared model: one with a loadProblem that returns a
+  status, as ProbMgmtAPI has, and one with a loadProblem that returns
+  nothing and integer columns to mark, as Osi1API has.
+*/
+struct StatusLoader {
+    StatusLoader () : numCols_(-1) { }
+    int loadProblem (int numCols, int numRows, const int *start,
+                     const int *index, const double *value,
+                     const double *colLower, const double *colUpper,
+                     const double *obj, const double *rowLower,
+                     const double *rowUpper)
+    {
+        numCols_ = numCols ;
+        return ((numRows > 0 && start[numCols] > 0) ? 0 : -1) ;
+    }
+    int readMps (const char *) { return (-7) ; }
+    int numCols_ ;
+} ;
+
+struct VoidLoader {
+    VoidLoader () : numElements_(-1) { }
+    void loadProblem (const int numCols, const int numRows,
+                      const CoinBigIndex *start, const int *index,
+                      const double *value, const double *colLower,
+                      const double *colUpper, const double *obj,
+                      const double *rowLower, const double *rowUpper)
+    {
+        numElements_ = start[numCols] ;
+    }
+    void loadProblem (const int numCols, const int numRows,
+                      const CoinBigIndex *start, const int *index,
+                      const double *value, const double *colLower,
+                      const double *colUpper, const double *obj,
+                      const char *rowSense, const double *rowRhs,
+                      const double *rowRange)
+    {
+        numElements_ = -2 ;
+    }
+    void setInteger (const int *cols, int len)
+    {
+        integers_.assign(cols, cols+len) ;
+    }
+    int numElements_ ;
+    std::vector<int> integers_ ;
+} ;
+
+/*
+  A file is read once while it's unchanged, a copy of it under another
+  name comes back as the same model, and a model built from arrays that
+  match is interned to it. A changed file is read again. Models no one
+  holds are trimmed. A shared model loads through either kind of
+  loadProblem, and the control API reads through its cache.
+*/
+int testModelCache ()
+{
+    int errcnt = 0 ;
+    const char *mps =
+        "NAME          TINY\n"
+        "ROWS\n"
+        " N  COST\n"
+        " L  LIM\n"
+        "COLUMNS\n"
+        "    MARKER    'MARKER'    'INTORG'\n"
+        "    X         COST      -1.0   LIM       1.0\n"
+        "    MARKER    'MARKER'    'INTEND'\n"
+        "    Y         COST      -2.0   LIM       3.0\n"
+        "RHS\n"
+        "    RHS       LIM       4.0\n"
+        "BOUNDS\n"
+        " UP BND       X         1.0\n"
+        " UP BND       Y         1.0\n"
+        "ENDATA\n" ;
+    std::ostringstream base ;
+    base << "/tmp/osi2modelcache-test." << getpid() ;
+    const std::string path = base.str()+".mps" ;
+    const std::string copyPath = base.str()+"-copy.mps" ;
+    writeFile(path,mps) ;
+    writeFile(copyPath,mps) ;
+    ModelCache cache ;
+    SharedModel first ;
+    SharedModel again ;
+    SharedModel copy ;
+    std::string errStr ;
+    if (cache.readMps(path,first,errStr) != 0 ||
+            cache.readMps(path,again,errStr) != 0 ||
+            cache.readMps(copyPath,copy,errStr) != 0) {
+        errcnt++ ;
+        std::cout << "ModelCache couldn't read " << path << ": " << errStr
+                  << std::endl ;
+        unlink(path.c_str()) ;
+        unlink(copyPath.c_str()) ;
+        return (errcnt) ;
+    }
+    if (!first.sameAs(again) || !first.sameAs(copy) ||
+            cache.getNumModels() != 1 || cache.getHits() != 2 ||
+            cache.getMisses() != 1 || first.getNumCols() != 2 ||
+            first.getNumRows() != 1 || first.getIntegerInfo() == nullptr ||
+            first.getStructureKey() !=
+                ModelHash::structure(2,1,first.getStarts(),nullptr,
+                                     first.getIndices())) {
+        errcnt++ ;
+        std::cout << "ModelCache kept " << cache.getNumModels()
+                  << " models for one file, " << cache.getHits()
+                  << " hits." << std::endl ;
+    }
+    SharedModel built =
+        SharedModel::make(first.getNumCols(),first.getNumRows(),
+                          first.getStarts(),first.getIndices(),
+                          first.getValues(),first.getColLower(),
+                          first.getColUpper(),first.getObjective(),
+                          first.getRowLower(),first.getRowUpper(),
+                          first.getIntegerInfo(),first.getObjOffset()) ;
+    if (built.sameAs(first) || !built.equals(first) ||
+            !cache.intern(built).sameAs(first)) {
+        errcnt++ ;
+        std::cout << "ModelCache didn't intern an equal model." << std::endl ;
+    }
+    std::string changed(mps) ;
+    changed.replace(changed.find("4.0"),3,"5.0") ;
+    writeFile(path,changed.c_str()) ;
+    struct timeval times[2] ;
+    times[0].tv_sec = times[1].tv_sec = 1000000000 ;
+    times[0].tv_usec = times[1].tv_usec = 0 ;
+    utimes(path.c_str(),times) ;
+    SharedModel reread ;
+    if (cache.readMps(path,reread,errStr) != 0 || reread.sameAs(first) ||
+            reread.getRowUpper()[0] != 5.0 ||
+            reread.getStructureKey() != first.getStructureKey() ||
+            cache.getNumModels() != 2) {
+        errcnt++ ;
+        std::cout << "ModelCache didn't see " << path << " change."
+                  << std::endl ;
+    }
+    /*
+      Change it back, keeping the size and the second of the mtime; then
+      replace it by a rename, keeping the whole mtime. Both must be seen.
+    */
+    writeFile(path,mps) ;
+    times[0].tv_usec = times[1].tv_usec = 500000 ;
+    utimes(path.c_str(),times) ;
+    SharedModel restored ;
+    if (cache.readMps(path,restored,errStr) != 0 ||
+            !restored.sameAs(first)) {
+        errcnt++ ;
+        std::cout << "ModelCache didn't see " << path
+                  << " change within a second." << std::endl ;
+    }
+    const std::string newPath = base.str()+"-new.mps" ;
+    writeFile(newPath,changed.c_str()) ;
+    utimes(newPath.c_str(),times) ;
+    rename(newPath.c_str(),path.c_str()) ;
+    if (cache.readMps(path,restored,errStr) != 0 ||
+            restored.getRowUpper()[0] != 5.0) {
+        errcnt++ ;
+        std::cout << "ModelCache didn't see " << path << " replaced."
+                  << std::endl ;
+    }
+    restored.reset() ;
+    reread.reset() ;
+    cache.trim() ;
+    if (cache.getNumModels() != 1 || first.getUseCount() != 5) {
+        errcnt++ ;
+        std::cout << "ModelCache trimmed to " << cache.getNumModels()
+                  << " models; the first has " << first.getUseCount()
+                  << " handles." << std::endl ;
+    }
+
+    StatusLoader statusLoader ;
+    VoidLoader voidLoader ;
+    ControlAPI_Imp ctrlAPI ;
+    if (ctrlAPI.loadModel(&statusLoader,first) != 0 ||
+            statusLoader.numCols_ != 2 ||
+            ctrlAPI.loadModel(&voidLoader,first) != 0 ||
+            voidLoader.numElements_ != 2 ||
+            voidLoader.integers_.size() != 1 || voidLoader.integers_[0] != 0 ||
+            ctrlAPI.loadModel(&statusLoader,SharedModel()) != -1) {
+        errcnt++ ;
+        std::cout << "Shared model didn't load." << std::endl ;
+    }
+    SharedModel viaCtrl ;
+    if (ctrlAPI.readMpsShared(&statusLoader,copyPath,&viaCtrl) != -7 ||
+            viaCtrl.isValid()) {
+        errcnt++ ;
+        std::cout << "ControlAPI used a model cache it doesn't have."
+                  << std::endl ;
+    }
+    ctrlAPI.enableModelCache() ;
+    statusLoader.numCols_ = -1 ;
+    if (ctrlAPI.getModelCache() == nullptr ||
+            ctrlAPI.readMpsShared(&statusLoader,copyPath,&viaCtrl) != 0 ||
+            statusLoader.numCols_ != 2 || !viaCtrl.equals(first) ||
+            ctrlAPI.getModelCache()->getMisses() != 1) {
+        errcnt++ ;
+        std::cout << "ControlAPI didn't read through its model cache."
+                  << std::endl ;
+    }
+    ctrlAPI.disableModelCache() ;
+    if (!viaCtrl.isValid() || viaCtrl.getNumElements() != 2) {
+        errcnt++ ;
+        std::cout << "Shared model went with the cache." << std::endl ;
+    }
+    unlink(path.c_str()) ;
+    unlink(copyPath.c_str()) ;
+
+    return (errcnt) ;
+}
+
+/*
+  A solver that hands back the optimum of the first reduced problem in
+  testPresolve, whatever it's given.
+*/
+struct PresolvedSolver {
+    PresolvedSolver () : numCols_(-1), numRows_(-1), rowUpper0_(0.0) { }
+    void loadProblem (const int numCols, const int numRows,
+                      const CoinBigIndex *start, const int *index,
+                      const double *value, const double *colLower,
+                      const double *colUpper, const double *obj,
+                      const double *rowLower, const double *rowUpper)
+    {
+        numCols_ = numCols ;
+        numRows_ = numRows ;
+        rowUpper0_ = rowUpper[0] ;
+    }
+    void setInteger (const int *, int) { }
+    void initialSolve ()
+    {
+        const double x[2] = { 0.0, 3.0 } ;
+        const double d[2] = { 1.0, 0.0 } ;
+        colSolution_.assign(x, x+2) ;
+        reducedCost_.assign(d, d+2) ;
+        rowPrice_.assign(1, -2.0) ;
+    }
+    const double *getColSolution () const { return (&colSolution_[0]) ; }
+    const double *getReducedCost () const { return (&reducedCost_[0]) ; }
+    const double *getRowPrice () const { return (&rowPrice_[0]) ; }
+    double getObjValue () const { return (-6.0) ; }
+    int getIterationCount () const { return (1) ; }
+    int numCols_ ;
+    int numRows_ ;
+    double rowUpper0_ ;
+    std::vector<double> colSolution_ ;
+    std::vector<double> reducedCost_ ;
+    std::vector<double> rowPrice_ ;
+} ;
+
+/*
+  Three columns, the last fixed at 1, and three rows: one kept, one left
+  with a single coefficient, one left empty. Presolve leaves two columns
+  and one row, and postsolve gives back the full solution with its duals.
+  A new objective finds the presolve in the cache, and postsolve prices
+  the singleton row; unfixing the column doesn't. An empty row that can't
+  hold shows the model infeasible. The control API presolves, solves and
+  postsolves in one call.
+*/
+int testPresolve ()
+{
+    int errcnt = 0 ;
+    const double inf = COIN_DBL_MAX ;
+    const int start[] = { 0, 1, 3, 5 } ;
+    const int index[] = { 0, 0, 1, 0, 2 } ;
+    const double value[] = { 1.0, 1.0, 2.0, 1.0, 1.0 } ;
+    double colLower[] = { 0.0, 0.0, 1.0 } ;
+    const double colUpper[] = { 10.0, 10.0, 1.0 } ;
+    const double obj[] = { -1.0, -2.0, 3.0 } ;
+    const double rowLower[] = { -inf, 1.0, 0.0 } ;
+    const double rowUpper[] = { 4.0, inf, 2.0 } ;
+    const SharedModel model =
+        SharedModel::make(3,3,start,index,value,colLower,colUpper,obj,
+                          rowLower,rowUpper,nullptr,0.0) ;
+    PresolveCache cache ;
+    PresolvedProblem problem ;
+    const Presolve &presolve = problem.getPresolve() ;
+    if (cache.presolve(model,problem) != 0 || presolve.getNumCols() != 2 ||
+            presolve.getNumRows() != 1 || presolve.getNumFixed() != 1 ||
+            presolve.getNumEmptyRows() != 1 ||
+            presolve.getNumSingletonRows() != 1 ||
+            problem.getNumElements() != 2 ||
+            problem.getRowUpper()[0] != 3.0 ||
+            problem.getColLower()[1] != 0.5 ||
+            problem.getFixedObjective() != 3.0) {
+        errcnt++ ;
+        std::cout << "Presolve kept " << presolve.getNumCols()
+                  << " columns and " << presolve.getNumRows() << " rows."
+                  << std::endl ;
+        return (errcnt) ;
+    }
+    SolutionBuffer solBuf ;
+    SolutionView &sol = solBuf.view(3,3) ;
+    const double x[] = { 0.0, 3.0 } ;
+    const double d[] = { 1.0, 0.0 } ;
+    const double y[] = { -2.0 } ;
+    if (problem.postsolve(model,x,d,y,-6.0,1,sol) != 0 ||
+            sol.colSolution_[1] != 3.0 || sol.colSolution_[2] != 1.0 ||
+            sol.rowActivity_[0] != 4.0 || sol.rowActivity_[1] != 6.0 ||
+            sol.rowActivity_[2] != 1.0 || sol.rowPrice_[0] != -2.0 ||
+            sol.rowPrice_[1] != 0.0 || sol.reducedCost_[2] != 5.0 ||
+            sol.objValue_ != -3.0) {
+        errcnt++ ;
+        std::cout << "Postsolve gave objective " << sol.objValue_
+                  << ", reduced cost " << sol.reducedCost_[2]
+                  << " for the fixed column." << std::endl ;
+    }
+    const double newObj[] = { 1.0, 1.0, 0.0 } ;
+    const SharedModel repriced =
+        SharedModel::make(3,3,start,index,value,colLower,colUpper,newObj,
+                          rowLower,rowUpper,nullptr,0.0) ;
+    PresolvedProblem again ;
+    const double x2[] = { 0.0, 0.5 } ;
+    const double d2[] = { 1.0, 1.0 } ;
+    if (cache.presolve(repriced,again) != 0 || cache.getHits() != 1 ||
+            cache.getNumPresolves() != 1 ||
+            again.getObjective()[1] != 1.0 ||
+            again.postsolve(repriced,x2,d2,nullptr,0.5,1,sol) != 0 ||
+            sol.rowPrice_[1] != 0.5 || sol.reducedCost_[1] != 0.0 ||
+            sol.reducedCost_[0] != 1.0) {
+        errcnt++ ;
+        std::cout << "Presolve cache had " << cache.getHits()
+                  << " hits; singleton row price " << sol.rowPrice_[1]
+                  << "." << std::endl ;
+    }
+    colLower[2] = 0.0 ;
+    const SharedModel unfixed =
+        SharedModel::make(3,3,start,index,value,colLower,colUpper,obj,
+                          rowLower,rowUpper,nullptr,0.0) ;
+    colLower[2] = 1.0 ;
+    PresolvedProblem other ;
+    if (cache.presolve(unfixed,other) != 0 || cache.getMisses() != 2 ||
+            cache.getNumPresolves() != 2 ||
+            other.getPresolve().getNumCols() != 3 ||
+            other.getPresolve().suits(model)) {
+        errcnt++ ;
+        std::cout << "Presolve cache reused a presolve with other columns "
+                  << "fixed." << std::endl ;
+    }
+    const double badLower[] = { -inf, 1.0, 2.0 } ;
+    const double badUpper[] = { 4.0, inf, 3.0 } ;
+    const SharedModel infeasible =
+        SharedModel::make(3,3,start,index,value,colLower,colUpper,obj,
+                          badLower,badUpper,nullptr,0.0) ;
+    PresolvedProblem none ;
+    if (cache.presolve(infeasible,none) != 1 || cache.getHits() != 2) {
+        errcnt++ ;
+        std::cout << "Presolve didn't see an empty row that can't hold."
+                  << std::endl ;
+    }
+    other = PresolvedProblem() ;
+    none = PresolvedProblem() ;
+    cache.trim() ;
+    if (cache.getNumPresolves() != 1) {
+        errcnt++ ;
+        std::cout << "Presolve cache trimmed to " << cache.getNumPresolves()
+                  << " presolves." << std::endl ;
+    }
+
+    ControlAPI_Imp ctrlAPI ;
+    PresolvedSolver solver ;
+    SolutionView &full = solBuf.view(3,3) ;
+    if (ctrlAPI.initialSolvePresolved(&solver,model,full) != 0 ||
+            solver.numCols_ != 2 || solver.rowUpper0_ != 3.0 ||
+            full.objValue_ != -3.0 || full.colSolution_[2] != 1.0) {
+        errcnt++ ;
+        std::cout << "ControlAPI didn't presolve and postsolve." << std::endl ;
+    }
+    ctrlAPI.enablePresolveCache() ;
+    SolutionView small ;
+    if (ctrlAPI.getPresolveCache() == nullptr ||
+            ctrlAPI.initialSolvePresolved(&solver,model,full) != 0 ||
+            ctrlAPI.initialSolvePresolved(&solver,repriced,small) != -1 ||
+            ctrlAPI.getPresolveCache()->getHits() != 1 ||
+            ctrlAPI.initialSolvePresolved(&solver,infeasible,full) != 1 ||
+            ctrlAPI.initialSolvePresolved(&solver,SharedModel(),full) != -1) {
+        errcnt++ ;
+        std::cout << "ControlAPI didn't presolve through its cache."
+                  << std::endl ;
+    }
+    ctrlAPI.disablePresolveCache() ;
+
+    return (errcnt) ;
+}
+
+int main(int argC, char* argV[])
+{
+
+    std::cout << "START UNIT TEST" << std::endl ;
+
+    std::string dfltSampleDir = "../../Data/Sample" ;
+    /*
+      Test the bare PluginManager. There's no sense proceeding to the API
+      tests if the PluginManager isn't working.
+    */
+    std::cout << "Testing bare PluginManager." << std::endl ;
+    int retval = testPluginManager("libOsi2ClpShim.so") ;
+    std::cout
+      << "End test of bare PluginManager, " << retval << " errors."
+      << std::endl << std::endl ;
+    if (retval != 0) {
+        std::cout
+	  << "Aborting unitTest; errors in PluginManager." << std::endl ;
+        return (retval) ;
+    }
+    /*
+      The MPS reader the shims use.
+    */
+    std::cout << "Testing MpsReader." << std::endl ;
+    int totalErrs = testMpsReader(dfltSampleDir) ;
+    std::cout
+      << "End test of MpsReader, " << totalErrs << " errors."
+      << std::endl << std::endl ;
+    std::cout << "Testing CutPool." << std::endl ;
+    retval = testCutPool() ;
+    std::cout
+      << "End test of CutPool, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing ModelDelta." << std::endl ;
+    retval = testModelDelta() ;
+    std::cout
+      << "End test of ModelDelta, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing ScenarioRunner." << std::endl ;
+    retval = testScenarios() ;
+    std::cout
+      << "End test of ScenarioRunner, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing BatchResolve." << std::endl ;
+    retval = testBatchResolve() ;
+    std::cout
+      << "End test of BatchResolve, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing LogSink." << std::endl ;
+    retval = testLogSink() ;
+    std::cout
+      << "End test of LogSink, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing Trace." << std::endl ;
+    retval = testTrace() ;
+    std::cout
+      << "End test of Trace, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing DirCache." << std::endl ;
+    retval = testDirCache() ;
+    std::cout
+      << "End test of DirCache, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing CancelToken." << std::endl ;
+    retval = testCancelToken() ;
+    std::cout
+      << "End test of CancelToken, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing ThreadPool." << std::endl ;
+    retval = testThreadPool(dfltSampleDir) ;
+    std::cout
+      << "End test of ThreadPool, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing SolveHistory." << std::endl ;
+    retval = testSolveHistory() ;
+    std::cout
+      << "End test of SolveHistory, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing Kernels." << std::endl ;
+    retval = testKernels() ;
+    std::cout
+      << "End test of Kernels, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing ModelCache." << std::endl ;
+    retval = testModelCache() ;
+    std::cout
+      << "End test of ModelCache, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing WarmStartCache." << std::endl ;
+    retval = testWarmStartCache() ;
+    std::cout
+      << "End test of WarmStartCache, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing Presolve." << std::endl ;
+    retval = testPresolve() ;
+    std::cout
+      << "End test of Presolve, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    std::cout << "Testing Numa." << std::endl ;
+    retval = testNuma() ;
+    std::cout
+      << "End test of Numa, " << retval << " errors."
+      << std::endl << std::endl ;
+    totalErrs += retval ;
+    /*
+      Now let's try the Osi2 control API.
     */
     typedef std::pair<std::string,int> TestVec ;
     std::vector<TestVec> solvers ;
@@ -293,7 +3518,6 @@ int main(int argC, char* argV[])
     solvers.push_back(TestVec("glpkHeavy",2)) ;
 #   endif
     std::vector<TestVec>::const_iterator iter ;
-    int totalErrs = 0 ;
     for (iter = solvers.begin() ; iter != solvers.end() ; iter++) {
       std::string solverName = iter->first ;
       std::cout
@@ -305,6 +3529,45 @@ int main(int argC, char* argV[])
 	  << std::endl << std::endl ;
       totalErrs += retval-(iter->second) ;
     }
+    /*
+      And the same solver, out of process.
+    */
+    if (PluginHost::isSupported()) {
+      std::cout << "Testing hosted ControlAPI (clp)." << std::endl ;
+      retval = testPluginHost("libOsi2ClpShim.so",dfltSampleDir) ;
+      std::cout
+          << "End test of hosted ControlAPI (clp), " << retval << " errors."
+	  << std::endl << std::endl ;
+      totalErrs += retval ;
+    }
+    /*
+      And again, on a remote node.
+    */
+    if (RemoteNode::isSupported()) {
+      std::cout << "Testing remote ControlAPI (clp)." << std::endl ;
+      retval = testRemoteShim("libOsi2ClpShim.so",dfltSampleDir) ;
+      std::cout
+          << "End test of remote ControlAPI (clp), " << retval << " errors."
+	  << std::endl << std::endl ;
+      totalErrs += retval ;
+      std::cout << "Testing remote Osi1 (clpHeavy)." << std::endl ;
+      retval = testRemoteOsi1("libOsi2ClpHeavyShim.so") ;
+      std::cout
+          << "End test of remote Osi1 (clpHeavy), " << retval << " errors."
+	  << std::endl << std::endl ;
+      totalErrs += retval ;
+    }
+    /*
+      And through the solver daemon.
+    */
+    if (SolverDaemon::isSupported()) {
+      std::cout << "Testing solver daemon (clp)." << std::endl ;
+      retval = testSolverDaemon("libOsi2ClpShim.so",dfltSampleDir) ;
+      std::cout
+          << "End test of solver daemon (clp), " << retval << " errors."
+	  << std::endl << std::endl ;
+      totalErrs += retval ;
+    }
     /*
       Shut down the plugin manager. This will call the plugin library exit
       functions and unload the libraries.